@@ -0,0 +1,46 @@
+/** @file
+  Common header of the RPi5D ACPI tables.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RPI5D_ACPI_TABLES_H_
+#define RPI5D_ACPI_TABLES_H_
+
+#include <IndustryStandard/Acpi63.h>
+#include "../Include/Platform/RPi5D.h"
+
+//
+// OEM fields, as in the DefinitionBlock of Dsdt.asl
+//
+#define RPI5D_ACPI_OEM_ID            { 'R', 'P', 'I', '5', ' ', ' ' }
+#define RPI5D_ACPI_OEM_TABLE_ID      SIGNATURE_64 ('R', 'P', 'I', '5', 'D', ' ', ' ', ' ')
+#define RPI5D_ACPI_OEM_REVISION      0x00000001
+#define RPI5D_ACPI_CREATOR_ID        SIGNATURE_32 ('R', 'P', 'I', '5')
+#define RPI5D_ACPI_CREATOR_REVISION  0x00000001
+
+#define RPI5D_ACPI_HEADER(Signature, Type, Revision)  \
+  {                                                   \
+    Signature,                                        \
+    sizeof (Type),                                    \
+    Revision,                                         \
+    0,                                                \
+    RPI5D_ACPI_OEM_ID,                                \
+    RPI5D_ACPI_OEM_TABLE_ID,                          \
+    RPI5D_ACPI_OEM_REVISION,                          \
+    RPI5D_ACPI_CREATOR_ID,                            \
+    RPI5D_ACPI_CREATOR_REVISION                       \
+  }
+
+//
+// GIC-600: distributor, one 128KB redistributor frame per core, ITS
+//
+#define RPI5D_GICD_BASE              0x107C400000
+#define RPI5D_GICR_BASE              0x107C600000
+#define RPI5D_GICR_STRIDE            0x20000
+#define RPI5D_GICR_SIZE              0x02000000
+#define RPI5D_GIC_ITS_BASE           0x107C800000
+
+#endif
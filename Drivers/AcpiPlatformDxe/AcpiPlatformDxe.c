@@ -0,0 +1,188 @@
+/** @file
+  Installs the RPi5D ACPI tables.
+
+  The tables are the RAW sections of the AcpiTables FREEFORM file. Before
+  the DSDT is installed, the MEM0 resource it takes from RPi5D.h is set
+  to the DRAM described by the resource HOBs, which PrePi sized from the
+  firmware device tree.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <IndustryStandard/Acpi.h>
+#include <IndustryStandard/AcpiAml.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DxeServicesLib.h>
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/AcpiTable.h>
+#include "../../Include/Platform/RPi5D.h"
+
+//
+// FREEFORM file of AcpiTables/AcpiTables.inf
+//
+#define ACPI_PLATFORM_TABLES_FILE_GUID \
+  { 0x9e8f1f9a, 0x7a3f, 0x4e8f, { 0x8d, 0x1e, 0x2f, 0x3a, 0x4b, 0x5c, 0x6e, 0x5f } }
+
+//
+// Name (MEM0, Buffer ...) in AML: NameOp, the name, BufferOp. The QWord
+// memory descriptor follows within the buffer's package length and size.
+//
+#define ACPI_PLATFORM_MEM0_PREFIX_SIZE  6
+#define ACPI_PLATFORM_MEM0_SEARCH       8
+
+STATIC CONST EFI_GUID  mAcpiPlatformTablesFileGuid = ACPI_PLATFORM_TABLES_FILE_GUID;
+STATIC CONST UINT8     mAcpiPlatformMem0Prefix[ACPI_PLATFORM_MEM0_PREFIX_SIZE] = {
+  AML_NAME_OP, 'M', 'E', 'M', '0', AML_BUFFER_OP
+};
+
+/**
+  End of DRAM, from the system memory resource HOBs.
+
+  @return Address just past the highest system memory, or 0 if none.
+**/
+STATIC
+UINT64
+AcpiPlatformDramEnd (
+  VOID
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINT64                End;
+
+  End = 0;
+  for (Hob.Raw = GetHobList ();
+       (Hob.Raw = GetNextHob (EFI_HOB_TYPE_RESOURCE_DESCRIPTOR, Hob.Raw)) != NULL;
+       Hob.Raw = GET_NEXT_HOB (Hob))
+  {
+    if (Hob.ResourceDescriptor->ResourceType == EFI_RESOURCE_SYSTEM_MEMORY) {
+      End = MAX (End, Hob.ResourceDescriptor->PhysicalStart + Hob.ResourceDescriptor->ResourceLength);
+    }
+  }
+
+  return End;
+}
+
+/**
+  Set the MEM0 resource of the DSDT to the DRAM fitted.
+
+  @param  Dsdt          DSDT, not yet installed.
+
+  @retval EFI_SUCCESS   MEM0 patched.
+  @retval EFI_NOT_FOUND The DSDT has no MEM0 QWord memory descriptor, or
+                        there is no system memory HOB.
+**/
+STATIC
+EFI_STATUS
+AcpiPlatformPatchMem0 (
+  IN OUT EFI_ACPI_DESCRIPTION_HEADER  *Dsdt
+  )
+{
+  UINT8                                    *Aml;
+  UINT8                                    *End;
+  UINT8                                    *Search;
+  EFI_ACPI_QWORD_ADDRESS_SPACE_DESCRIPTOR  *Memory;
+  UINT64                                   DramEnd;
+
+  DramEnd = AcpiPlatformDramEnd ();
+  if (DramEnd <= RPI5D_SYSTEM_MEMORY_BASE) {
+    return EFI_NOT_FOUND;
+  }
+
+  Aml = (UINT8 *)(Dsdt + 1);
+  End = (UINT8 *)Dsdt + Dsdt->Length - sizeof (*Memory);
+  for ( ; Aml + ACPI_PLATFORM_MEM0_PREFIX_SIZE <= End; Aml++) {
+    if (CompareMem (Aml, mAcpiPlatformMem0Prefix, ACPI_PLATFORM_MEM0_PREFIX_SIZE) != 0) {
+      continue;
+    }
+
+    for (Search = Aml + ACPI_PLATFORM_MEM0_PREFIX_SIZE;
+         (Search <= End) && (Search < Aml + ACPI_PLATFORM_MEM0_PREFIX_SIZE + ACPI_PLATFORM_MEM0_SEARCH);
+         Search++)
+    {
+      Memory = (EFI_ACPI_QWORD_ADDRESS_SPACE_DESCRIPTOR *)Search;
+      if ((Memory->Header.Header.Byte == ACPI_QWORD_ADDRESS_SPACE_DESCRIPTOR) &&
+          (Memory->Header.Length == sizeof (*Memory) - sizeof (ACPI_LARGE_RESOURCE_HEADER)) &&
+          (Memory->ResType == ACPI_ADDRESS_SPACE_TYPE_MEM))
+      {
+        Memory->AddrRangeMin = RPI5D_SYSTEM_MEMORY_BASE;
+        Memory->AddrRangeMax = DramEnd - 1;
+        Memory->AddrLen      = DramEnd - RPI5D_SYSTEM_MEMORY_BASE;
+        return EFI_SUCCESS;
+      }
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Install every table of the AcpiTables file, patching the DSDT first.
+
+  @param  ImageHandle   Image handle of this driver.
+  @param  SystemTable   EFI system table.
+
+  @retval EFI_SUCCESS   Tables installed.
+  @retval others        No table file, or a table was rejected.
+**/
+EFI_STATUS
+EFIAPI
+AcpiPlatformDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                   Status;
+  EFI_ACPI_TABLE_PROTOCOL      *AcpiTable;
+  EFI_ACPI_DESCRIPTION_HEADER  *Table;
+  UINTN                        Size;
+  UINTN                        Instance;
+  UINTN                        Key;
+
+  Status = gBS->LocateProtocol (&gEfiAcpiTableProtocolGuid, NULL, (VOID **)&AcpiTable);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (Instance = 0; ; Instance++) {
+    Status = GetSectionFromAnyFv (&mAcpiPlatformTablesFileGuid, EFI_SECTION_RAW, Instance, (VOID **)&Table, &Size);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    if ((Size < sizeof (*Table)) || (Table->Length > Size)) {
+      DEBUG ((DEBUG_ERROR, "[ACPI] Section %d is not an ACPI table\n", Instance));
+      FreePool (Table);
+      continue;
+    }
+
+    if (Table->Signature == EFI_ACPI_6_3_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE) {
+      if (EFI_ERROR (AcpiPlatformPatchMem0 (Table))) {
+        DEBUG ((DEBUG_WARN, "[ACPI] DSDT MEM0 left at its built-in size\n"));
+      }
+    }
+
+    //
+    // The table is copied and its checksum recomputed
+    //
+    Status = AcpiTable->InstallAcpiTable (AcpiTable, Table, Table->Length, &Key);
+    FreePool (Table);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[ACPI] Installing table %d failed: %r\n", Instance, Status));
+      return Status;
+    }
+  }
+
+  if (Instance == 0) {
+    DEBUG ((DEBUG_ERROR, "[ACPI] No ACPI tables in the firmware volume\n"));
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,532 @@
+/** @file
+  BCM2712 PCIe Root Complex Driver for Raspberry Pi 5 D-step
+
+  Brings up the external PCIe port (pcie1, the M.2 / FPC connector),
+  trains the link at the fastest speed both ends support, assigns the
+  memory BARs of the device on the link and installs the PCI root bridge
+  I/O protocol for it.
+
+  The link speed target is programmed before PERST# is released, so a
+  Gen3 device trains straight to Gen3; a retrain is only issued when the
+  link still comes up slower than both ends allow. Every wait is bounded
+  by a deadline, so an empty slot costs PCIE_LINK_TIMEOUT once.
+
+  No MCFG table is published. The controller has no ECAM: everything
+  past the root port is reached through one 4KB window, and generic ECAM
+  accesses to other functions would land on controller registers. An OS
+  needs its own brcmstb driver for this port.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Bcm2712PcieDxe.h"
+
+STATIC PCIE_PRIVATE_DATA  mPcie;
+
+STATIC PCIE_DEVICE_PATH  mPcieDevicePath = {
+  {
+    {
+      ACPI_DEVICE_PATH,
+      ACPI_DP,
+      {
+        (UINT8)(sizeof (ACPI_HID_DEVICE_PATH)),
+        (UINT8)(sizeof (ACPI_HID_DEVICE_PATH) >> 8)
+      }
+    },
+    EISA_PNP_ID (0x0A08),
+    0
+  },
+  {
+    END_DEVICE_PATH_TYPE,
+    END_ENTIRE_DEVICE_PATH_SUBTYPE,
+    {
+      END_DEVICE_PATH_LENGTH,
+      0
+    }
+  }
+};
+
+/**
+  Reset the bridge and PHY and program the address windows, leaving
+  PERST# asserted.
+
+  @param  Private       Root complex.
+  @param  TargetGen     Link speed to advertise.
+**/
+STATIC
+VOID
+PcieSetupBridge (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              TargetGen
+  )
+{
+  UINTN   Base;
+  UINT64  MemLimit;
+  UINT32  BaseMb;
+  UINT32  LimitMb;
+  UINT8   Cap;
+
+  Base = Private->Base;
+
+  //
+  // Hold the bridge in reset with PERST# asserted, then release the
+  // bridge and power up the SerDes.
+  //
+  PlatformMmioWrite32 (Base + PCIE_MISC_PCIE_CTRL, PlatformMmioRead32 (Base + PCIE_MISC_PCIE_CTRL) & ~PCIE_MISC_PCIE_CTRL_PERSTB);
+  PlatformMmioWrite32 (Base + PCIE_RGR1_SW_INIT_1, PlatformMmioRead32 (Base + PCIE_RGR1_SW_INIT_1) | PCIE_RGR1_SW_INIT_1_INIT);
+  MicroSecondDelay (PCIE_PERST_HOLD);
+  PlatformMmioWrite32 (Base + PCIE_RGR1_SW_INIT_1, PlatformMmioRead32 (Base + PCIE_RGR1_SW_INIT_1) & ~PCIE_RGR1_SW_INIT_1_INIT);
+  PlatformMmioWrite32 (Base + PCIE_MISC_HARD_PCIE_HARD_DEBUG, PlatformMmioRead32 (Base + PCIE_MISC_HARD_PCIE_HARD_DEBUG) & ~PCIE_HARD_DEBUG_SERDES_IDDQ);
+  MicroSecondDelay (PCIE_PERST_HOLD);
+
+  //
+  // Let the bridge master the system bus, and have reads of absent
+  // functions complete with all ones rather than an abort.
+  //
+  PlatformMmioWrite32 (
+    Base + PCIE_MISC_MISC_CTRL,
+    (PlatformMmioRead32 (Base + PCIE_MISC_MISC_CTRL) & ~PCIE_MISC_CTRL_SCB0_SIZE_MASK) |
+    PCIE_MISC_CTRL_SCB_ACCESS_EN | PCIE_MISC_CTRL_CFG_READ_UR_MODE |
+    (PCIE_INBOUND_SIZE << PCIE_MISC_CTRL_SCB0_SIZE_SHIFT)
+    );
+
+  //
+  // Inbound: bus addresses from RPI5D_PCIE_DMA_OFFSET reach DRAM from 0.
+  // BAR1 and BAR3 stay closed.
+  //
+  PlatformMmioWrite32 (Base + PCIE_MISC_RC_BAR2_CONFIG_LO, (UINT32)RPI5D_PCIE_DMA_OFFSET | PCIE_INBOUND_SIZE);
+  PlatformMmioWrite32 (Base + PCIE_MISC_RC_BAR2_CONFIG_HI, (UINT32)RShiftU64 (RPI5D_PCIE_DMA_OFFSET, 32));
+  PlatformMmioWrite32 (Base + PCIE_MISC_RC_BAR1_CONFIG_LO, 0);
+  PlatformMmioWrite32 (Base + PCIE_MISC_RC_BAR3_CONFIG_LO, 0);
+
+  //
+  // Outbound: the CPU window at RPI5D_PCIE_MEM_BASE becomes bus
+  // addresses from RPI5D_PCIE_MEM_BUS_BASE. Base and limit are in MB.
+  //
+  MemLimit = RPI5D_PCIE_MEM_BASE + RPI5D_PCIE_MEM_SIZE - 1;
+  BaseMb   = (UINT32)RShiftU64 (RPI5D_PCIE_MEM_BASE, 20);
+  LimitMb  = (UINT32)RShiftU64 (MemLimit, 20);
+  PlatformMmioWrite32 (Base + PCIE_MISC_CPU_2_PCIE_MEM_WIN0_LO, (UINT32)RPI5D_PCIE_MEM_BUS_BASE);
+  PlatformMmioWrite32 (Base + PCIE_MISC_CPU_2_PCIE_MEM_WIN0_HI, (UINT32)RShiftU64 (RPI5D_PCIE_MEM_BUS_BASE, 32));
+  PlatformMmioWrite32 (
+    Base + PCIE_MISC_CPU_2_PCIE_MEM_WIN0_BASE_LIMIT,
+    ((LimitMb & 0xFFF) << 20) | ((BaseMb & 0xFFF) << 4)
+    );
+  PlatformMmioWrite32 (Base + PCIE_MISC_CPU_2_PCIE_MEM_WIN0_BASE_HI, BaseMb >> 12);
+  PlatformMmioWrite32 (Base + PCIE_MISC_CPU_2_PCIE_MEM_WIN0_LIMIT_HI, LimitMb >> 12);
+
+  //
+  // The root port comes out of reset with a non-bridge class code.
+  //
+  PlatformMmioWrite32 (
+    Base + PCIE_RC_CFG_PRIV1_ID_VAL3,
+    (PlatformMmioRead32 (Base + PCIE_RC_CFG_PRIV1_ID_VAL3) & 0xFF000000) |
+    (PCI_CLASS_BRIDGE << 16) | (PCI_CLASS_BRIDGE_P2P << 8)
+    );
+
+  //
+  // Advertise the target speed in Link Capabilities and ask for it in
+  // Link Control 2, so the first training already goes for it.
+  //
+  PlatformMmioWrite32 (
+    Base + PCIE_RC_CFG_PRIV1_LINK_CAPABILITY,
+    (PlatformMmioRead32 (Base + PCIE_RC_CFG_PRIV1_LINK_CAPABILITY) & ~PCIE_LINK_CAPABILITY_SPEED_MASK) | TargetGen
+    );
+  Cap = PcieFindCapability (Private, PCIE_ROOT_BUS, 0, 0, EFI_PCI_CAPABILITY_ID_PCIEXP);
+  if (Cap != 0) {
+    PcieConfigWrite32 (
+      Private,
+      PCIE_ROOT_BUS,
+      0,
+      0,
+      Cap + PCIE_CAP_LINK_CONTROL2,
+      (PcieConfigRead32 (Private, PCIE_ROOT_BUS, 0, 0, Cap + PCIE_CAP_LINK_CONTROL2) & ~PCIE_LINK_SPEED_MASK) | TargetGen
+      );
+  }
+}
+
+/**
+  Record the negotiated speed and width of the link.
+
+  @param  Private       Root complex.
+  @param  Cap           PCI Express capability of the root port.
+**/
+STATIC
+VOID
+PcieReadLinkStatus (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Cap
+  )
+{
+  UINT32  Link;
+
+  Link               = PcieConfigRead32 (Private, PCIE_ROOT_BUS, 0, 0, Cap + PCIE_CAP_LINK_CONTROL);
+  Private->LinkSpeed = (UINT8)((Link >> PCIE_LINK_STATUS_SPEED_SHIFT) & PCIE_LINK_SPEED_MASK);
+  Private->LinkWidth = (UINT8)((Link >> PCIE_LINK_STATUS_WIDTH_SHIFT) & PCIE_LINK_STATUS_WIDTH_MASK);
+}
+
+/**
+  Release PERST# and wait for the data link layer, then retrain if the
+  link came up slower than both ends allow.
+
+  @param  Private       Root complex.
+  @param  TargetGen     Fastest speed the root port may use.
+
+  @retval EFI_SUCCESS   The link is up.
+  @retval EFI_TIMEOUT   Nothing trained within PCIE_LINK_TIMEOUT.
+**/
+STATIC
+EFI_STATUS
+PcieTrainLink (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              TargetGen
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Elapsed;
+  UINT8       Cap;
+  UINT8       DeviceCap;
+  UINT8       DeviceGen;
+  UINTN       LinkControl;
+
+  PlatformMmioWrite32 (
+    Private->Base + PCIE_MISC_PCIE_CTRL,
+    PlatformMmioRead32 (Private->Base + PCIE_MISC_PCIE_CTRL) | PCIE_MISC_PCIE_CTRL_PERSTB
+    );
+
+  Status = PlatformWaitMmio32 (
+             Private->Base + PCIE_MISC_PCIE_STATUS,
+             PCIE_MISC_PCIE_STATUS_PHYLINKUP | PCIE_MISC_PCIE_STATUS_DL_ACTIVE,
+             PCIE_MISC_PCIE_STATUS_PHYLINKUP | PCIE_MISC_PCIE_STATUS_DL_ACTIVE,
+             PCIE_LINK_TIMEOUT,
+             &Elapsed
+             );
+  if (EFI_ERROR (Status)) {
+    return EFI_TIMEOUT;
+  }
+
+  Private->LinkUp = TRUE;
+  DEBUG ((DEBUG_INFO, "[PCIE] Link up after %lu us\n", Elapsed));
+
+  Cap = PcieFindCapability (Private, PCIE_ROOT_BUS, 0, 0, EFI_PCI_CAPABILITY_ID_PCIEXP);
+  if (Cap == 0) {
+    return EFI_SUCCESS;
+  }
+
+  PcieReadLinkStatus (Private, Cap);
+  if (Private->LinkSpeed >= TargetGen) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // The device is only visible once the root port has bus numbers;
+  // give it bus 1 for the look at its Link Capabilities.
+  //
+  PcieConfigWrite32 (
+    Private,
+    PCIE_ROOT_BUS,
+    0,
+    0,
+    PCI_BRIDGE_PRIMARY_BUS_REGISTER_OFFSET,
+    (PCIE_SECONDARY_BUS << 16) | (PCIE_SECONDARY_BUS << 8) | PCIE_ROOT_BUS
+    );
+  Private->SubordinateBus = PCIE_SECONDARY_BUS;
+
+  DeviceCap = PcieFindCapability (Private, PCIE_SECONDARY_BUS, 0, 0, EFI_PCI_CAPABILITY_ID_PCIEXP);
+  if (DeviceCap == 0) {
+    return EFI_SUCCESS;
+  }
+
+  DeviceGen = (UINT8)(PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, 0, DeviceCap + PCIE_CAP_LINK_CAPABILITY) & PCIE_LINK_SPEED_MASK);
+  if (MIN (DeviceGen, TargetGen) <= Private->LinkSpeed) {
+    return EFI_SUCCESS;
+  }
+
+  DEBUG ((DEBUG_INFO, "[PCIE] Link at Gen%d, device supports Gen%d; retraining\n", Private->LinkSpeed, DeviceGen));
+
+  //
+  // The root port's configuration space is plain MMIO, so the Link
+  // Training bit can be polled like any other register.
+  //
+  LinkControl = PcieConfigAddress (Private, PCIE_ROOT_BUS, 0, 0, Cap + PCIE_CAP_LINK_CONTROL);
+  PlatformMmioWrite32 (LinkControl, PlatformMmioRead32 (LinkControl) | PCIE_LINK_CONTROL_RETRAIN);
+  Status = PlatformWaitMmio32 (LinkControl, PCIE_LINK_STATUS_TRAINING, 0, PCIE_RETRAIN_TIMEOUT, &Elapsed);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[PCIE] Retrain did not finish within %d us\n", PCIE_RETRAIN_TIMEOUT));
+  }
+
+  //
+  // Retraining may take the data link down for a moment.
+  //
+  PlatformWaitMmio32 (
+    Private->Base + PCIE_MISC_PCIE_STATUS,
+    PCIE_MISC_PCIE_STATUS_DL_ACTIVE,
+    PCIE_MISC_PCIE_STATUS_DL_ACTIVE,
+    PCIE_LINK_TIMEOUT,
+    &Elapsed
+    );
+  PcieReadLinkStatus (Private, Cap);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Size and assign the memory BARs of one function. I/O BARs are left
+  unassigned: the window has no I/O space.
+
+  @param  Private       Root complex.
+  @param  Function      Function number on bus 1, device 0.
+  @param  BarCount      Number of BARs of its header type.
+**/
+STATIC
+VOID
+PcieAssignBars (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Function,
+  IN UINTN              BarCount
+  )
+{
+  UINTN   Bar;
+  UINTN   Index;
+  UINT32  Offset;
+  UINT32  Original;
+  UINT32  Mask;
+  UINT32  UpperMask;
+  UINT64  Size;
+  UINT64  Address;
+  BOOLEAN Is64Bit;
+
+  for (Bar = 0; Bar < BarCount; Bar++) {
+    Index    = Bar;
+    Offset   = PCI_BASE_ADDRESSREG_OFFSET + (UINT32)Bar * 4;
+    Original = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset);
+    PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset, MAX_UINT32);
+    Mask = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset);
+    PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset, Original);
+
+    if ((Mask == 0) || ((Mask & BIT0) != 0)) {
+      continue;
+    }
+
+    Is64Bit   = (BOOLEAN)((Mask & 0x6) == 0x4);
+    UpperMask = MAX_UINT32;
+    if (Is64Bit) {
+      PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset + 4, MAX_UINT32);
+      UpperMask = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset + 4);
+    }
+
+    Size    = ~(LShiftU64 (UpperMask, 32) | (Mask & ~0xFU)) + 1;
+    Address = ALIGN_VALUE (Private->MemNext, Size);
+    if ((Size == 0) || (Address + Size > RPI5D_PCIE_MEM_BUS_BASE + RPI5D_PCIE_MEM_SIZE)) {
+      DEBUG ((DEBUG_ERROR, "[PCIE] 01:00.%d BAR%d: 0x%lx bytes do not fit\n", Function, Index, Size));
+      Bar += Is64Bit ? 1 : 0;
+      continue;
+    }
+
+    PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset, (UINT32)Address);
+    if (Is64Bit) {
+      PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, Offset + 4, (UINT32)RShiftU64 (Address, 32));
+      Bar++;
+    }
+
+    DEBUG ((DEBUG_INFO, "[PCIE] 01:00.%d BAR%d: 0x%lx bytes at 0x%lx\n", Function, Index, Size, Address));
+    Private->MemNext = Address + Size;
+  }
+}
+
+/**
+  Give the root port its bus numbers and window, then assign resources
+  to the functions of the device on the link.
+
+  @param  Private       Root complex.
+**/
+STATIC
+VOID
+PcieEnumerate (
+  IN PCIE_PRIVATE_DATA  *Private
+  )
+{
+  UINT8   Function;
+  UINT32  Id;
+  UINT32  Header;
+  UINT32  Command;
+  UINT64  Limit;
+
+  PcieConfigWrite32 (
+    Private,
+    PCIE_ROOT_BUS,
+    0,
+    0,
+    PCI_BRIDGE_PRIMARY_BUS_REGISTER_OFFSET,
+    (PCIE_SECONDARY_BUS << 16) | (PCIE_SECONDARY_BUS << 8) | PCIE_ROOT_BUS
+    );
+  Private->SubordinateBus = PCIE_SECONDARY_BUS;
+  Private->MemNext        = RPI5D_PCIE_MEM_BUS_BASE;
+
+  for (Function = 0; Function < PCIE_MAX_FUNCTIONS; Function++) {
+    Id = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, PCI_VENDOR_ID_OFFSET);
+    if ((UINT16)Id == 0xFFFF) {
+      if (Function == 0) {
+        break;
+      }
+
+      continue;
+    }
+
+    Header = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, PCI_CACHELINE_SIZE_OFFSET);
+    DEBUG ((DEBUG_INFO, "[PCIE] 01:00.%d %04x:%04x class %06x\n", Function, (UINT16)Id, Id >> 16, PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, PCI_REVISION_ID_OFFSET) >> 8));
+
+    Command = PcieConfigRead32 (Private, PCIE_SECONDARY_BUS, 0, Function, PCI_COMMAND_OFFSET);
+    PcieConfigWrite32 (Private, PCIE_SECONDARY_BUS, 0, Function, PCI_COMMAND_OFFSET, Command & ~(UINT32)(EFI_PCI_COMMAND_MEMORY_SPACE | EFI_PCI_COMMAND_BUS_MASTER));
+
+    PcieAssignBars (Private, Function, ((Header >> 16) & HEADER_LAYOUT_CODE) == HEADER_TYPE_DEVICE ? PCI_MAX_BAR : 2);
+
+    PcieConfigWrite32 (
+      Private,
+      PCIE_SECONDARY_BUS,
+      0,
+      Function,
+      PCI_COMMAND_OFFSET,
+      (Command & 0xFFFF) | EFI_PCI_COMMAND_MEMORY_SPACE | EFI_PCI_COMMAND_BUS_MASTER
+      );
+
+    if ((Function == 0) && ((Header & (HEADER_TYPE_MULTI_FUNCTION << 16)) == 0)) {
+      break;
+    }
+  }
+
+  //
+  // Open the root port's memory window over what was assigned, keep its
+  // prefetchable window closed and let it forward both ways.
+  //
+  Limit = MAX (Private->MemNext, RPI5D_PCIE_MEM_BUS_BASE + SIZE_1MB) - 1;
+  PcieConfigWrite32 (
+    Private,
+    PCIE_ROOT_BUS,
+    0,
+    0,
+    OFFSET_OF (PCI_TYPE01, Bridge.MemoryBase),
+    ((UINT32)Limit & 0xFFF00000) | ((UINT32)RPI5D_PCIE_MEM_BUS_BASE >> 16)
+    );
+  PcieConfigWrite32 (Private, PCIE_ROOT_BUS, 0, 0, OFFSET_OF (PCI_TYPE01, Bridge.PrefetchableMemoryBase), 0x0000FFF0);
+  PcieConfigWrite32 (
+    Private,
+    PCIE_ROOT_BUS,
+    0,
+    0,
+    PCI_COMMAND_OFFSET,
+    PcieConfigRead32 (Private, PCIE_ROOT_BUS, 0, 0, PCI_COMMAND_OFFSET) | EFI_PCI_COMMAND_MEMORY_SPACE | EFI_PCI_COMMAND_BUS_MASTER
+    );
+}
+
+/**
+  Leave the configuration window on bus 1, device 0, function 0, the
+  device on the link.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Root complex.
+**/
+STATIC
+VOID
+EFIAPI
+PcieExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  PCIE_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  PcieConfigAddress (Private, PCIE_SECONDARY_BUS, 0, 0, 0);
+}
+
+/**
+  Driver entry point.
+
+  @param  ImageHandle   EFI_HANDLE.
+  @param  SystemTable   EFI_SYSTEM_TABLE.
+
+  @retval EFI_SUCCESS   The root bridge is installed.
+  @retval EFI_NOT_FOUND No device answered on the link.
+**/
+EFI_STATUS
+EFIAPI
+Bcm2712PcieDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS         Status;
+  PCIE_PRIVATE_DATA  *Private;
+  UINT8              TargetGen;
+  UINT32             Revision;
+
+  DEBUG ((DEBUG_INFO, "\n[PCIE] ========================================\n"));
+  DEBUG ((DEBUG_INFO, "[PCIE] BCM2712 PCIe Root Complex Driver\n"));
+  DEBUG ((DEBUG_INFO, "[PCIE] ========================================\n"));
+
+  Private                 = &mPcie;
+  Private->Signature      = PCIE_PRIVATE_SIGNATURE;
+  Private->Base           = RPI5D_PCIE_BASE;
+  Private->CfgIndex       = MAX_UINT32;
+  Private->SubordinateBus = PCIE_ROOT_BUS;
+
+  Revision  = PlatformMmioRead32 (Private->Base + PCIE_MISC_REVISION);
+  TargetGen = (UINT8)MIN (PlatformMmioRead32 (Private->Base + PCIE_RC_CFG_PRIV1_LINK_CAPABILITY) & PCIE_LINK_CAPABILITY_SPEED_MASK, PCIE_MAX_GEN);
+  if (TargetGen == 0) {
+    TargetGen = PCIE_MAX_GEN;
+  }
+
+  DEBUG ((DEBUG_INFO, "[PCIE] Base address:     0x%016lx\n", (UINT64)Private->Base));
+  DEBUG ((DEBUG_INFO, "[PCIE] Revision:         0x%08x\n", Revision));
+  DEBUG ((DEBUG_INFO, "[PCIE] Target speed:     Gen%d\n", TargetGen));
+
+  PcieSetupBridge (Private, TargetGen);
+
+  Status = PcieTrainLink (Private, TargetGen);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "[PCIE] No link within %d us; slot empty\n", PCIE_LINK_TIMEOUT));
+    PlatformMmioWrite32 (
+      Private->Base + PCIE_MISC_PCIE_CTRL,
+      PlatformMmioRead32 (Private->Base + PCIE_MISC_PCIE_CTRL) & ~PCIE_MISC_PCIE_CTRL_PERSTB
+      );
+    PlatformMmioWrite32 (
+      Private->Base + PCIE_MISC_HARD_PCIE_HARD_DEBUG,
+      PlatformMmioRead32 (Private->Base + PCIE_MISC_HARD_PCIE_HARD_DEBUG) | PCIE_HARD_DEBUG_SERDES_IDDQ
+      );
+    return EFI_NOT_FOUND;
+  }
+
+  DEBUG ((DEBUG_INFO, "[PCIE] Link:             Gen%d x%d\n", Private->LinkSpeed, Private->LinkWidth));
+
+  PcieEnumerate (Private);
+  PcieInitRootBridgeIo (Private);
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Private->Handle,
+                  &gEfiDevicePathProtocolGuid,
+                  &mPcieDevicePath,
+                  &gEfiPciRootBridgeIoProtocolGuid,
+                  &Private->RootBridgeIo,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[PCIE] Protocol install failed: %r\n", Status));
+    return Status;
+  }
+
+  gBS->CreateEvent (
+         EVT_SIGNAL_EXIT_BOOT_SERVICES,
+         TPL_NOTIFY,
+         PcieExitBootServices,
+         Private,
+         &Private->ExitBootServicesEvent
+         );
+
+  DEBUG ((DEBUG_INFO, "[PCIE] Initialization complete\n"));
+  DEBUG ((DEBUG_INFO, "[PCIE] ========================================\n\n"));
+
+  return EFI_SUCCESS;
+}
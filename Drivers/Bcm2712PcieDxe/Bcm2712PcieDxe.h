@@ -0,0 +1,246 @@
+/** @file
+  BCM2712 PCIe root complex driver for Raspberry Pi 5 D-step
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BCM2712_PCIE_DXE_H_
+#define BCM2712_PCIE_DXE_H_
+
+#include <Uefi.h>
+#include <IndustryStandard/Acpi.h>
+#include <IndustryStandard/Pci.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/DevicePath.h>
+#include <Protocol/PciRootBridgeIo.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+#include "../../Include/Platform/RPi5D.h"
+
+//
+// Root complex registers. The root port's own configuration space is at
+// offset 0; that of the function selected by PCIE_EXT_CFG_INDEX (bus,
+// device and function in ECAM layout) is mapped at PCIE_EXT_CFG_DATA.
+//
+#define PCIE_RC_CFG_PRIV1_ID_VAL3         0x043C
+#define PCIE_RC_CFG_PRIV1_LINK_CAPABILITY 0x04DC
+#define PCIE_MISC_MISC_CTRL               0x4008
+#define PCIE_MISC_CPU_2_PCIE_MEM_WIN0_LO  0x400C
+#define PCIE_MISC_CPU_2_PCIE_MEM_WIN0_HI  0x4010
+#define PCIE_MISC_RC_BAR1_CONFIG_LO       0x402C
+#define PCIE_MISC_RC_BAR2_CONFIG_LO       0x4034
+#define PCIE_MISC_RC_BAR2_CONFIG_HI       0x4038
+#define PCIE_MISC_RC_BAR3_CONFIG_LO       0x403C
+#define PCIE_MISC_PCIE_CTRL               0x4064
+#define PCIE_MISC_PCIE_STATUS             0x4068
+#define PCIE_MISC_REVISION                0x406C
+#define PCIE_MISC_CPU_2_PCIE_MEM_WIN0_BASE_LIMIT  0x4070
+#define PCIE_MISC_CPU_2_PCIE_MEM_WIN0_BASE_HI     0x4080
+#define PCIE_MISC_CPU_2_PCIE_MEM_WIN0_LIMIT_HI    0x4084
+#define PCIE_MISC_HARD_PCIE_HARD_DEBUG    0x4204
+#define PCIE_EXT_CFG_DATA                 0x8000
+#define PCIE_EXT_CFG_INDEX                0x9000
+#define PCIE_RGR1_SW_INIT_1               0x9210
+
+#define PCIE_MISC_CTRL_SCB_ACCESS_EN      BIT12
+#define PCIE_MISC_CTRL_CFG_READ_UR_MODE   BIT13
+#define PCIE_MISC_CTRL_SCB0_SIZE_SHIFT    27
+#define PCIE_MISC_CTRL_SCB0_SIZE_MASK     (0x1FU << PCIE_MISC_CTRL_SCB0_SIZE_SHIFT)
+#define PCIE_MISC_PCIE_CTRL_PERSTB        BIT2
+#define PCIE_MISC_PCIE_STATUS_PHYLINKUP   BIT4
+#define PCIE_MISC_PCIE_STATUS_DL_ACTIVE   BIT5
+#define PCIE_MISC_PCIE_STATUS_PORT        BIT7
+#define PCIE_HARD_DEBUG_SERDES_IDDQ       BIT27
+#define PCIE_RGR1_SW_INIT_1_INIT          BIT1
+#define PCIE_LINK_CAPABILITY_SPEED_MASK   0xF
+
+//
+// Size of the inbound window and of SCB0, encoded as log2 (size) - 15.
+// All of DRAM the BCM2712 can address; bus addresses carry
+// RPI5D_PCIE_DMA_OFFSET.
+//
+#define PCIE_INBOUND_SIZE                 (36 - 15)   // 64GB
+
+//
+// PCI Express capability registers and fields used here
+//
+#define PCIE_CAP_LINK_CAPABILITY          0x0C
+#define PCIE_CAP_LINK_CONTROL             0x10    // Link Status in the upper half
+#define PCIE_CAP_LINK_CONTROL2            0x30
+#define PCIE_LINK_SPEED_MASK              0xF
+#define PCIE_LINK_CONTROL_RETRAIN         BIT5
+#define PCIE_LINK_STATUS_TRAINING         BIT27   // of the Link Control dword
+#define PCIE_LINK_STATUS_SPEED_SHIFT      16
+#define PCIE_LINK_STATUS_WIDTH_SHIFT      20
+#define PCIE_LINK_STATUS_WIDTH_MASK       0x3F
+
+//
+// Fastest link the root port is allowed to train to. The controller is
+// Gen3 capable; build with -DPCIE_MAX_GEN=2 to hold slower links back.
+//
+#ifndef PCIE_MAX_GEN
+#define PCIE_MAX_GEN  3
+#endif
+
+//
+// Bounds of the link waits, in microseconds. PERST# stays asserted for
+// PCIE_PERST_HOLD; the link then has PCIE_LINK_TIMEOUT to come up, and a
+// retrain PCIE_RETRAIN_TIMEOUT to finish.
+//
+#define PCIE_PERST_HOLD       100
+#define PCIE_LINK_TIMEOUT     100000
+#define PCIE_RETRAIN_TIMEOUT  50000
+
+//
+// Buses below the root port. Only the device directly on the link is
+// enumerated; bridges below it are left unconfigured.
+//
+#define PCIE_ROOT_BUS         0
+#define PCIE_SECONDARY_BUS    1
+#define PCIE_MAX_FUNCTIONS    8
+
+//
+// Address of a function in the ECAM layout, as PCIE_EXT_CFG_INDEX takes it
+//
+#define PCIE_ECAM_OFFSET(Bus, Device, Function) \
+  (((UINT32)(Bus) << 20) | ((UINT32)(Device) << 15) | ((UINT32)(Function) << 12))
+
+//
+// Root bridge device path: PNP0A08, UID 0
+//
+typedef struct {
+  ACPI_HID_DEVICE_PATH        Acpi;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} PCIE_DEVICE_PATH;
+
+//
+// Resource descriptors returned by Configuration
+//
+#pragma pack (1)
+typedef struct {
+  EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR    Bus;
+  EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR    Mem;
+  EFI_ACPI_END_TAG_DESCRIPTOR          End;
+} PCIE_RESOURCES;
+#pragma pack ()
+
+//
+// DMA mapping handed out by Map
+//
+typedef struct {
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION    Operation;
+  VOID                                         *HostAddress;
+  UINTN                                        NumberOfBytes;
+} PCIE_MAPPING;
+
+//
+// Private context of the root complex
+//
+typedef struct {
+  UINT32                             Signature;
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL    RootBridgeIo;
+  EFI_HANDLE                         Handle;
+  UINTN                              Base;
+  UINT32                             CfgIndex;      // function PCIE_EXT_CFG_DATA shows
+  BOOLEAN                            LinkUp;
+  UINT8                              LinkSpeed;     // negotiated Gen
+  UINT8                              LinkWidth;
+  UINT8                              SubordinateBus;
+  UINT64                             MemNext;       // next free bus address
+  PCIE_RESOURCES                     Resources;
+  EFI_EVENT                          ExitBootServicesEvent;
+} PCIE_PRIVATE_DATA;
+
+#define PCIE_PRIVATE_SIGNATURE  SIGNATURE_32('P', 'C', 'I', 'E')
+#define PCIE_PRIVATE_FROM_THIS(a) \
+  CR (a, PCIE_PRIVATE_DATA, RootBridgeIo, PCIE_PRIVATE_SIGNATURE)
+
+//
+// PcieConfig.c
+//
+
+/**
+  Return the CPU address of a configuration register, selecting the
+  function in PCIE_EXT_CFG_INDEX if needed.
+
+  @param  Private       Root complex.
+  @param  Bus           Bus number.
+  @param  Device        Device number.
+  @param  Function      Function number.
+  @param  Register      Register offset, below 4KB.
+
+  @return CPU address, or 0 if no function can sit at that address.
+**/
+UINTN
+PcieConfigAddress (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register
+  );
+
+/**
+  Read a 32-bit configuration register.
+
+  @return Register value, all ones if no function is there.
+**/
+UINT32
+PcieConfigRead32 (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register
+  );
+
+/**
+  Write a 32-bit configuration register.
+**/
+VOID
+PcieConfigWrite32 (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register,
+  IN UINT32             Value
+  );
+
+/**
+  Find a capability in the standard capability list of a function.
+
+  @return Offset of the capability, or 0 if the function has none.
+**/
+UINT8
+PcieFindCapability (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT8              CapabilityId
+  );
+
+//
+// PcieRootBridgeIo.c
+//
+
+/**
+  Fill in the root bridge I/O protocol of a root complex.
+
+  @param  Private       Root complex.
+**/
+VOID
+PcieInitRootBridgeIo (
+  IN PCIE_PRIVATE_DATA  *Private
+  );
+
+#endif
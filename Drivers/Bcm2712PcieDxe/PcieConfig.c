@@ -0,0 +1,168 @@
+/** @file
+  BCM2712 PCIe configuration space access.
+
+  The root port's configuration space is plain MMIO at the start of the
+  register block. Any other function is reached through a 4KB window
+  whose target is set in PCIE_EXT_CFG_INDEX; the index is only rewritten
+  when the target changes, so consecutive accesses to one function, as
+  enumeration and drivers make them, are single loads and stores.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Bcm2712PcieDxe.h"
+
+/**
+  Return the CPU address of a configuration register, selecting the
+  function in PCIE_EXT_CFG_INDEX if needed.
+
+  @param  Private       Root complex.
+  @param  Bus           Bus number.
+  @param  Device        Device number.
+  @param  Function      Function number.
+  @param  Register      Register offset, below 4KB.
+
+  @return CPU address, or 0 if no function can sit at that address.
+**/
+UINTN
+PcieConfigAddress (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register
+  )
+{
+  UINT32  Index;
+
+  if (Bus == PCIE_ROOT_BUS) {
+    return ((Device == 0) && (Function == 0)) ? Private->Base + Register : 0;
+  }
+
+  //
+  // Nothing answers below the root port while the link is down, and on
+  // the secondary bus only device 0 exists: touching anything else would
+  // end in an unsupported request.
+  //
+  if (!Private->LinkUp || (Bus > Private->SubordinateBus) ||
+      ((Bus == PCIE_SECONDARY_BUS) && (Device != 0)))
+  {
+    return 0;
+  }
+
+  Index = PCIE_ECAM_OFFSET (Bus, Device, Function);
+  if (Index != Private->CfgIndex) {
+    PlatformMmioWrite32 (Private->Base + PCIE_EXT_CFG_INDEX, Index);
+    Private->CfgIndex = Index;
+  }
+
+  return Private->Base + PCIE_EXT_CFG_DATA + Register;
+}
+
+/**
+  Read a 32-bit configuration register.
+
+  @param  Private       Root complex.
+  @param  Bus           Bus number.
+  @param  Device        Device number.
+  @param  Function      Function number.
+  @param  Register      Register offset, dword aligned.
+
+  @return Register value, all ones if no function is there.
+**/
+UINT32
+PcieConfigRead32 (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register
+  )
+{
+  UINTN  Address;
+
+  Address = PcieConfigAddress (Private, Bus, Device, Function, Register);
+  if (Address == 0) {
+    return MAX_UINT32;
+  }
+
+  return PlatformMmioRead32 (Address);
+}
+
+/**
+  Write a 32-bit configuration register. Writes to absent functions are
+  dropped.
+
+  @param  Private       Root complex.
+  @param  Bus           Bus number.
+  @param  Device        Device number.
+  @param  Function      Function number.
+  @param  Register      Register offset, dword aligned.
+  @param  Value         Value to write.
+**/
+VOID
+PcieConfigWrite32 (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT32             Register,
+  IN UINT32             Value
+  )
+{
+  UINTN  Address;
+
+  Address = PcieConfigAddress (Private, Bus, Device, Function, Register);
+  if (Address != 0) {
+    PlatformMmioWrite32 (Address, Value);
+  }
+}
+
+/**
+  Find a capability in the standard capability list of a function.
+
+  @param  Private       Root complex.
+  @param  Bus           Bus number.
+  @param  Device        Device number.
+  @param  Function      Function number.
+  @param  CapabilityId  EFI_PCI_CAPABILITY_ID_*.
+
+  @return Offset of the capability, or 0 if the function has none.
+**/
+UINT8
+PcieFindCapability (
+  IN PCIE_PRIVATE_DATA  *Private,
+  IN UINT8              Bus,
+  IN UINT8              Device,
+  IN UINT8              Function,
+  IN UINT8              CapabilityId
+  )
+{
+  UINT32  Header;
+  UINT8   Offset;
+  UINTN   Hops;
+
+  Header = PcieConfigRead32 (Private, Bus, Device, Function, PCI_COMMAND_OFFSET);
+  if ((Header == MAX_UINT32) || ((Header & (EFI_PCI_STATUS_CAPABILITY << 16)) == 0)) {
+    return 0;
+  }
+
+  Offset = (UINT8)PcieConfigRead32 (Private, Bus, Device, Function, PCI_CAPBILITY_POINTER_OFFSET);
+
+  //
+  // 48 entries fit between 0x40 and 0x100; more means a loop.
+  //
+  for (Hops = 0; (Offset >= 0x40) && (Hops < 48); Hops++) {
+    Offset &= ~0x3;
+    Header  = PcieConfigRead32 (Private, Bus, Device, Function, Offset);
+    if ((UINT8)Header == CapabilityId) {
+      return Offset;
+    }
+
+    Offset = (UINT8)(Header >> 8);
+  }
+
+  return 0;
+}
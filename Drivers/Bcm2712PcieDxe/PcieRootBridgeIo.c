@@ -0,0 +1,725 @@
+/** @file
+  PCI root bridge I/O protocol of the BCM2712 PCIe root complex.
+
+  Memory accesses go straight to the outbound window; the bridge has no
+  I/O space. DMA buffers stay cacheable: Map and Unmap clean or
+  invalidate them as the direction requires, and device addresses carry
+  RPI5D_PCIE_DMA_OFFSET, where the inbound window starts.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Bcm2712PcieDxe.h"
+
+/**
+  Check the width and buffer of a memory or configuration access.
+
+  @param  Width         Access width and stepping.
+  @param  Count         Number of accesses.
+  @param  Buffer        Caller buffer.
+
+  @retval EFI_SUCCESS            The access can be made.
+  @retval EFI_INVALID_PARAMETER  Width or Buffer is not valid.
+**/
+STATIC
+EFI_STATUS
+PcieCheckAccess (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN UINTN                                  Count,
+  IN VOID                                   *Buffer
+  )
+{
+  if ((Buffer == NULL) || ((UINT32)Width >= EfiPciWidthMaximum)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Make Count accesses of one width between an MMIO address and a buffer.
+
+  @param  Write         TRUE to store to the device.
+  @param  Width         Access width and stepping.
+  @param  Address       CPU address of the first access.
+  @param  Count         Number of accesses.
+  @param  Buffer        Caller buffer.
+**/
+STATIC
+VOID
+PcieMmioTransfer (
+  IN     BOOLEAN                                Write,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINTN                                  Address,
+  IN     UINTN                                  Count,
+  IN OUT UINT8                                  *Buffer
+  )
+{
+  UINTN  Size;
+  UINTN  AddressStep;
+  UINTN  BufferStep;
+
+  Size        = (UINTN)1 << (Width & 0x03);
+  AddressStep = (Width >= EfiPciWidthFifoUint8 && Width <= EfiPciWidthFifoUint64) ? 0 : Size;
+  BufferStep  = (Width >= EfiPciWidthFillUint8 && Width <= EfiPciWidthFillUint64) ? 0 : Size;
+
+  //
+  // 32-bit runs are the common case (device registers, configuration
+  // dumps) and take the batched path: one barrier for the whole run.
+  //
+  if ((Size == 4) && (AddressStep == 4) && (BufferStep == 4) && (((UINTN)Buffer & 3) == 0)) {
+    if (Write) {
+      PlatformMmioWriteBlock32 (Address, Count, (UINT32 *)Buffer);
+    } else {
+      PlatformMmioReadBlock32 (Address, Count, (UINT32 *)Buffer);
+    }
+
+    return;
+  }
+
+  for ( ; Count > 0; Count--, Address += AddressStep, Buffer += BufferStep) {
+    switch (Size) {
+      case 1:
+        if (Write) {
+          MemoryFence ();
+          *(volatile UINT8 *)Address = *Buffer;
+        } else {
+          *Buffer = *(volatile UINT8 *)Address;
+          MemoryFence ();
+        }
+
+        break;
+      case 2:
+        if (Write) {
+          MemoryFence ();
+          *(volatile UINT16 *)Address = ReadUnaligned16 ((UINT16 *)Buffer);
+        } else {
+          WriteUnaligned16 ((UINT16 *)Buffer, *(volatile UINT16 *)Address);
+          MemoryFence ();
+        }
+
+        break;
+      case 4:
+        if (Write) {
+          PlatformMmioWrite32 (Address, ReadUnaligned32 ((UINT32 *)Buffer));
+        } else {
+          WriteUnaligned32 ((UINT32 *)Buffer, PlatformMmioRead32 (Address));
+        }
+
+        break;
+      default:
+        if (Write) {
+          PlatformMmioWrite64 (Address, ReadUnaligned64 ((UINT64 *)Buffer));
+        } else {
+          WriteUnaligned64 ((UINT64 *)Buffer, PlatformMmioRead64 (Address));
+        }
+
+        break;
+    }
+  }
+}
+
+/**
+  Translate a bus address range in the memory window to a CPU address.
+
+  @param  Address       Bus address.
+  @param  Length        Bytes accessed.
+  @param  CpuAddress    CPU address.
+
+  @retval EFI_SUCCESS            Address is inside the window.
+  @retval EFI_INVALID_PARAMETER  It is not.
+**/
+STATIC
+EFI_STATUS
+PcieMemToCpu (
+  IN  UINT64  Address,
+  IN  UINT64  Length,
+  OUT UINTN   *CpuAddress
+  )
+{
+  if ((Address < RPI5D_PCIE_MEM_BUS_BASE) ||
+      (Length > RPI5D_PCIE_MEM_SIZE) ||
+      (Address - RPI5D_PCIE_MEM_BUS_BASE > RPI5D_PCIE_MEM_SIZE - Length))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *CpuAddress = (UINTN)(Address - RPI5D_PCIE_MEM_BUS_BASE + RPI5D_PCIE_MEM_BASE);
+  return EFI_SUCCESS;
+}
+
+/**
+  Length in bytes covered by Count accesses of Width.
+**/
+STATIC
+UINT64
+PcieAccessLength (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN UINTN                                  Count
+  )
+{
+  if ((Width >= EfiPciWidthFifoUint8) && (Width <= EfiPciWidthFifoUint64)) {
+    Count = 1;
+  }
+
+  return MultU64x32 (Count, 1 << (Width & 0x03));
+}
+
+/**
+  Poll a memory location until (*Address & Mask) == Value or Delay
+  100 ns units have passed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PciePollMem (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN  UINT64                                 Address,
+  IN  UINT64                                 Mask,
+  IN  UINT64                                 Value,
+  IN  UINT64                                 Delay,
+  OUT UINT64                                 *Result
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CpuAddress;
+  UINT64      Elapsed;
+
+  if ((Result == NULL) || ((UINT32)Width > EfiPciWidthUint64)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = PcieMemToCpu (Address, PcieAccessLength (Width, 1), &CpuAddress);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Width == EfiPciWidthUint32) {
+    Status  = PlatformWaitMmio32 (CpuAddress, (UINT32)Mask, (UINT32)Value, DivU64x32 (Delay + 9, 10), &Elapsed);
+    *Result = PlatformMmioRead32 (CpuAddress);
+    return Status;
+  }
+
+  Elapsed = 0;
+  for ( ; ; ) {
+    *Result = 0;
+    PcieMmioTransfer (FALSE, Width, CpuAddress, 1, (UINT8 *)Result);
+    if ((*Result & Mask) == Value) {
+      return EFI_SUCCESS;
+    }
+
+    if (Elapsed >= Delay) {
+      return EFI_TIMEOUT;
+    }
+
+    MicroSecondDelay (1);
+    Elapsed += 10;
+  }
+}
+
+/**
+  The bridge has no I/O space.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PciePollIo (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN  UINT64                                 Address,
+  IN  UINT64                                 Mask,
+  IN  UINT64                                 Value,
+  IN  UINT64                                 Delay,
+  OUT UINT64                                 *Result
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Read memory space through the outbound window.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieMemRead (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CpuAddress;
+
+  Status = PcieCheckAccess (Width, Count, Buffer);
+  if (!EFI_ERROR (Status)) {
+    Status = PcieMemToCpu (Address, PcieAccessLength (Width, Count), &CpuAddress);
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  PcieMmioTransfer (FALSE, Width, CpuAddress, Count, Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Write memory space through the outbound window.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieMemWrite (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CpuAddress;
+
+  Status = PcieCheckAccess (Width, Count, Buffer);
+  if (!EFI_ERROR (Status)) {
+    Status = PcieMemToCpu (Address, PcieAccessLength (Width, Count), &CpuAddress);
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  PcieMmioTransfer (TRUE, Width, CpuAddress, Count, Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  The bridge has no I/O space.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieIoAccess (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Access configuration space. Each run stays inside one function, so the
+  window is selected once and the run is made with plain loads or
+  stores.
+
+  @param  Write         TRUE to store to the device.
+**/
+STATIC
+EFI_STATUS
+PcieConfigAccess (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     BOOLEAN                                Write,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  EFI_STATUS                                   Status;
+  PCIE_PRIVATE_DATA                            *Private;
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_PCI_ADDRESS  *Pci;
+  UINT32                                       Register;
+  UINTN                                        CpuAddress;
+  UINT64                                       Length;
+
+  Status = PcieCheckAccess (Width, Count, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Private  = PCIE_PRIVATE_FROM_THIS (This);
+  Pci      = (EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_PCI_ADDRESS *)&Address;
+  Register = (Pci->ExtendedRegister != 0) ? Pci->ExtendedRegister : Pci->Register;
+  Length   = PcieAccessLength (Width, Count);
+  if ((Pci->Device > PCI_MAX_DEVICE) || (Pci->Function > PCI_MAX_FUNC) ||
+      (Register + Length > SIZE_4KB))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CpuAddress = PcieConfigAddress (Private, Pci->Bus, Pci->Device, Pci->Function, Register);
+  if (CpuAddress == 0) {
+    if (!Write) {
+      SetMem (Buffer, (UINTN)Length, 0xFF);
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  PcieMmioTransfer (Write, Width, CpuAddress, Count, Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Read configuration space.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PciePciRead (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  return PcieConfigAccess (This, FALSE, Width, Address, Count, Buffer);
+}
+
+/**
+  Write configuration space.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PciePciWrite (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT64                                 Address,
+  IN     UINTN                                  Count,
+  IN OUT VOID                                   *Buffer
+  )
+{
+  return PcieConfigAccess (This, TRUE, Width, Address, Count, Buffer);
+}
+
+/**
+  Copy one region of memory space to another.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieCopyMem (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL        *This,
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_WIDTH  Width,
+  IN UINT64                                 DestAddress,
+  IN UINT64                                 SrcAddress,
+  IN UINTN                                  Count
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Dest;
+  UINTN       Src;
+  UINT64      Length;
+  UINTN       Size;
+  UINTN       Index;
+  UINTN       Offset;
+  UINT64      Value;
+
+  if ((UINT32)Width > EfiPciWidthUint64) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Length = PcieAccessLength (Width, Count);
+  Status = PcieMemToCpu (DestAddress, Length, &Dest);
+  if (!EFI_ERROR (Status)) {
+    Status = PcieMemToCpu (SrcAddress, Length, &Src);
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Copy backwards when the destination overlaps the end of the source.
+  //
+  Size = (UINTN)1 << (Width & 0x03);
+  for (Index = 0; Index < Count; Index++) {
+    Offset = ((Dest > Src) && (Dest < Src + Length)) ? (Count - 1 - Index) * Size : Index * Size;
+    Value  = 0;
+    PcieMmioTransfer (FALSE, Width, Src + Offset, 1, (UINT8 *)&Value);
+    PcieMmioTransfer (TRUE, Width, Dest + Offset, 1, (UINT8 *)&Value);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Make a buffer available to a bus master.
+
+  The device address is the host address seen through the inbound
+  window. Nothing is copied: data the device reads is cleaned to memory
+  now, and lines covering data it writes are cleaned and invalidated so
+  no dirty line can be evicted over the transfer.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieMap (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL            *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION  Operation,
+  IN     VOID                                       *HostAddress,
+  IN OUT UINTN                                      *NumberOfBytes,
+  OUT    EFI_PHYSICAL_ADDRESS                       *DeviceAddress,
+  OUT    VOID                                       **Mapping
+  )
+{
+  PCIE_MAPPING  *Map;
+
+  if ((HostAddress == NULL) || (NumberOfBytes == NULL) || (DeviceAddress == NULL) ||
+      (Mapping == NULL) || ((UINT32)Operation >= EfiPciOperationMaximum))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Map = AllocatePool (sizeof (PCIE_MAPPING));
+  if (Map == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Map->Operation     = Operation;
+  Map->HostAddress   = HostAddress;
+  Map->NumberOfBytes = *NumberOfBytes;
+
+  switch (Operation) {
+    case EfiPciOperationBusMasterRead:
+    case EfiPciOperationBusMasterRead64:
+      WriteBackDataCacheRange (HostAddress, *NumberOfBytes);
+      break;
+    default:
+      WriteBackInvalidateDataCacheRange (HostAddress, *NumberOfBytes);
+      break;
+  }
+
+  *DeviceAddress = (UINTN)HostAddress + RPI5D_PCIE_DMA_OFFSET;
+  *Mapping       = Map;
+  return EFI_SUCCESS;
+}
+
+/**
+  End a bus master transfer. Lines the device wrote are invalidated, so
+  the CPU sees the data rather than what it had cached, including lines
+  it speculatively fetched during the transfer.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieUnmap (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN VOID                             *Mapping
+  )
+{
+  PCIE_MAPPING  *Map;
+
+  if (Mapping == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Map = Mapping;
+  if ((Map->Operation == EfiPciOperationBusMasterWrite) ||
+      (Map->Operation == EfiPciOperationBusMasterWrite64))
+  {
+    InvalidateDataCacheRange (Map->HostAddress, Map->NumberOfBytes);
+  }
+
+  FreePool (Map);
+  return EFI_SUCCESS;
+}
+
+/**
+  Allocate pages for a common buffer. Any memory is reachable through
+  the inbound window.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieAllocateBuffer (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN  EFI_ALLOCATE_TYPE                Type,
+  IN  EFI_MEMORY_TYPE                  MemoryType,
+  IN  UINTN                            Pages,
+  OUT VOID                             **HostAddress,
+  IN  UINT64                           Attributes
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  Address;
+
+  if (HostAddress == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((MemoryType != EfiBootServicesData) && (MemoryType != EfiRuntimeServicesData)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Attributes & ~(EFI_PCI_ATTRIBUTE_MEMORY_WRITE_COMBINE | EFI_PCI_ATTRIBUTE_MEMORY_CACHED |
+                      EFI_PCI_ATTRIBUTE_DUAL_ADDRESS_CYCLE)) != 0)
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = gBS->AllocatePages (AllocateAnyPages, MemoryType, Pages, &Address);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *HostAddress = (VOID *)(UINTN)Address;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free a common buffer.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieFreeBuffer (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN UINTN                            Pages,
+  IN VOID                             *HostAddress
+  )
+{
+  return gBS->FreePages ((EFI_PHYSICAL_ADDRESS)(UINTN)HostAddress, Pages);
+}
+
+/**
+  Posted writes are completed by the barrier of every access.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieFlush (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This
+  )
+{
+  PlatformMmioBarrier ();
+  return EFI_SUCCESS;
+}
+
+/**
+  Report the attributes the root bridge supports.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieGetAttributes (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  OUT UINT64                           *Supported OPTIONAL,
+  OUT UINT64                           *Attributes OPTIONAL
+  )
+{
+  if ((Supported == NULL) && (Attributes == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Supported != NULL) {
+    *Supported = EFI_PCI_ATTRIBUTE_DUAL_ADDRESS_CYCLE;
+  }
+
+  if (Attributes != NULL) {
+    *Attributes = EFI_PCI_ATTRIBUTE_DUAL_ADDRESS_CYCLE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  No attribute can be changed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieSetAttributes (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN     UINT64                           Attributes,
+  IN OUT UINT64                           *ResourceBase OPTIONAL,
+  IN OUT UINT64                           *ResourceLength OPTIONAL
+  )
+{
+  return ((Attributes & ~EFI_PCI_ATTRIBUTE_DUAL_ADDRESS_CYCLE) == 0) ? EFI_SUCCESS : EFI_UNSUPPORTED;
+}
+
+/**
+  Return the bus range and memory window of the root bridge.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PcieConfiguration (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  OUT VOID                             **Resources
+  )
+{
+  PCIE_PRIVATE_DATA  *Private;
+
+  Private    = PCIE_PRIVATE_FROM_THIS (This);
+  *Resources = &Private->Resources;
+  return EFI_SUCCESS;
+}
+
+/**
+  Fill in the root bridge I/O protocol of a root complex.
+
+  @param  Private       Root complex.
+**/
+VOID
+PcieInitRootBridgeIo (
+  IN PCIE_PRIVATE_DATA  *Private
+  )
+{
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL    *Io;
+  EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR  *Desc;
+
+  Io                   = &Private->RootBridgeIo;
+  Io->ParentHandle     = NULL;
+  Io->PollMem          = PciePollMem;
+  Io->PollIo           = PciePollIo;
+  Io->Mem.Read         = PcieMemRead;
+  Io->Mem.Write        = PcieMemWrite;
+  Io->Io.Read          = PcieIoAccess;
+  Io->Io.Write         = PcieIoAccess;
+  Io->Pci.Read         = PciePciRead;
+  Io->Pci.Write        = PciePciWrite;
+  Io->CopyMem          = PcieCopyMem;
+  Io->Map              = PcieMap;
+  Io->Unmap            = PcieUnmap;
+  Io->AllocateBuffer   = PcieAllocateBuffer;
+  Io->FreeBuffer       = PcieFreeBuffer;
+  Io->Flush            = PcieFlush;
+  Io->GetAttributes    = PcieGetAttributes;
+  Io->SetAttributes    = PcieSetAttributes;
+  Io->Configuration    = PcieConfiguration;
+  Io->SegmentNumber    = 0;
+
+  Desc                        = &Private->Resources.Bus;
+  Desc->Desc                  = ACPI_ADDRESS_SPACE_DESCRIPTOR;
+  Desc->Len                   = sizeof (EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR) - 3;
+  Desc->ResType               = ACPI_ADDRESS_SPACE_TYPE_BUS;
+  Desc->AddrRangeMin          = PCIE_ROOT_BUS;
+  Desc->AddrRangeMax          = Private->SubordinateBus;
+  Desc->AddrLen               = Private->SubordinateBus - PCIE_ROOT_BUS + 1;
+
+  Desc                        = &Private->Resources.Mem;
+  Desc->Desc                  = ACPI_ADDRESS_SPACE_DESCRIPTOR;
+  Desc->Len                   = sizeof (EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR) - 3;
+  Desc->ResType               = ACPI_ADDRESS_SPACE_TYPE_MEM;
+  Desc->AddrSpaceGranularity  = 32;
+  Desc->AddrRangeMin          = RPI5D_PCIE_MEM_BUS_BASE;
+  Desc->AddrRangeMax          = RPI5D_PCIE_MEM_BUS_BASE + RPI5D_PCIE_MEM_SIZE - 1;
+  Desc->AddrTranslationOffset = RPI5D_PCIE_MEM_BASE - RPI5D_PCIE_MEM_BUS_BASE;
+  Desc->AddrLen               = RPI5D_PCIE_MEM_SIZE;
+
+  Private->Resources.End.Desc     = ACPI_END_TAG_DESCRIPTOR;
+  Private->Resources.End.Checksum = 0;
+}
@@ -0,0 +1,115 @@
+/** @file
+  Drains the RPi5D DEBUG log ring to the console UART.
+
+  DXE drivers log into the RAM ring of RamDebugLib. This driver owns the
+  events that empty it: a periodic timer at TPL_CALLBACK that tops up the
+  PL011 transmit FIFO without waiting on it, and an ExitBootServices
+  notification that writes out what is left and switches logging to
+  synchronous for the rest of boot services. It is APRIORI in the FV,
+  so it also creates the ring and publishes its configuration table.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include "../../Include/Library/PlatformDebugLogLib.h"
+
+//
+// The FIFO holds about 2.8 ms of output at 115200 baud.
+//
+#define DEBUG_LOG_DRAIN_INTERVAL  EFI_TIMER_PERIOD_MILLISECONDS (2)
+
+STATIC EFI_EVENT  mDrainTimer;
+STATIC EFI_EVENT  mExitBootServicesEvent;
+
+/**
+  Top up the UART transmit FIFO from the ring.
+
+  @param  Event         Drain timer.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+DebugLogDrainNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DebugLogDrain (FALSE);
+}
+
+/**
+  Write out the rest of the ring before the OS takes the UART.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+DebugLogExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  gBS->SetTimer (mDrainTimer, TimerCancel, 0);
+  DebugLogSynchronous ();
+}
+
+/**
+  Start draining the log ring.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The drain events are set up.
+  @retval others        Events could not be created.
+**/
+EFI_STATUS
+EFIAPI
+DebugLogDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  DebugLogDrainNotify,
+                  NULL,
+                  &mDrainTimer
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  DebugLogExitBootServices,
+                  NULL,
+                  &mExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (mDrainTimer);
+    return Status;
+  }
+
+  Status = gBS->SetTimer (mDrainTimer, TimerPeriodic, DEBUG_LOG_DRAIN_INTERVAL);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (mExitBootServicesEvent);
+    gBS->CloseEvent (mDrainTimer);
+    return Status;
+  }
+
+  DEBUG ((DEBUG_INFO, "DebugLogDxe: DEBUG output is buffered in RAM\n"));
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,273 @@
+/** @file
+ *  Blt engine of the RPi5D GOP.
+ *
+ *  Rectangles are clipped against the screen and moved row by row, or as
+ *  a single run when the rows are contiguous, in the shadow framebuffer
+ *  when there is one. Rows are copied with CopyMem, which the DXE
+ *  BaseMemoryLibOptDxe of RPi5D.dsc does with 16-byte load/store pairs
+ *  for any alignment of the source.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include "DisplayDxe.h"
+
+#define DISPLAY_PIXEL_SIZE  sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+
+/**
+  Copy a run of pixels. Overlapping runs are copied as if through an
+  intermediate buffer.
+
+  @param  Destination   Destination, 4-byte aligned.
+  @param  Source        Source, 4-byte aligned.
+  @param  Count         Number of pixels.
+**/
+VOID
+DisplayCopyPixels (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Count
+  )
+{
+  CopyMem (Destination, Source, Count * DISPLAY_PIXEL_SIZE);
+}
+
+/**
+  Fill a run of pixels with one color, 64 bytes per iteration.
+
+  @param  Destination   Destination, 4-byte aligned.
+  @param  Color         Pixel value.
+  @param  Count         Number of pixels.
+**/
+VOID
+DisplayFillPixels (
+  OUT VOID    *Destination,
+  IN  UINT32  Color,
+  IN  UINTN   Count
+  )
+{
+  UINT32  *Dst32;
+  UINT64  *Dst64;
+  UINT64  Pattern;
+
+  Dst32 = Destination;
+  if ((((UINTN)Dst32 & 0x7) != 0) && (Count > 0)) {
+    *Dst32++ = Color;
+    Count--;
+  }
+
+  Pattern = LShiftU64 (Color, 32) | Color;
+  Dst64   = (UINT64 *)Dst32;
+  for ( ; Count >= 16; Count -= 16) {
+    Dst64[0] = Pattern;
+    Dst64[1] = Pattern;
+    Dst64[2] = Pattern;
+    Dst64[3] = Pattern;
+    Dst64[4] = Pattern;
+    Dst64[5] = Pattern;
+    Dst64[6] = Pattern;
+    Dst64[7] = Pattern;
+    Dst64   += 8;
+  }
+
+  for ( ; Count >= 2; Count -= 2) {
+    *Dst64++ = Pattern;
+  }
+
+  if (Count != 0) {
+    *(UINT32 *)Dst64 = Color;
+  }
+}
+
+/**
+  Clip a rectangle at (X, Y) against the screen.
+
+  @param  Info          Current mode.
+  @param  X             Left edge.
+  @param  Y             Top edge.
+  @param  Width         Width, reduced to what fits on screen.
+  @param  Height        Height, reduced to what fits on screen.
+
+  @retval TRUE          Rectangle starts on screen.
+  @retval FALSE         Rectangle lies entirely off screen.
+**/
+STATIC
+BOOLEAN
+DisplayClip (
+  IN     EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info,
+  IN     UINTN                                 X,
+  IN     UINTN                                 Y,
+  IN OUT UINTN                                 *Width,
+  IN OUT UINTN                                 *Height
+  )
+{
+  if ((X >= Info->HorizontalResolution) || (Y >= Info->VerticalResolution)) {
+    return FALSE;
+  }
+
+  *Width  = MIN (*Width, Info->HorizontalResolution - X);
+  *Height = MIN (*Height, Info->VerticalResolution - Y);
+  return TRUE;
+}
+
+/**
+  Blt a rectangle of pixels on the graphics screen.
+
+  Rectangles hanging off the right or bottom edge are clipped to the
+  screen; one that starts off screen is rejected.
+
+  @param  This          GOP instance.
+  @param  BltBuffer     Buffer containing data to blit into video buffer.
+  @param  BltOperation  Operation to perform on BltBuffer and video memory.
+  @param  SourceX       X coordinate of the source.
+  @param  SourceY       Y coordinate of the source.
+  @param  DestinationX  X coordinate of the destination.
+  @param  DestinationY  Y coordinate of the destination.
+  @param  Width         Width of the rectangle, in pixels.
+  @param  Height        Height of the rectangle, in pixels.
+  @param  Delta         Bytes per row of BltBuffer, 0 for Width pixels.
+
+  @retval EFI_SUCCESS             The Blt operation completed.
+  @retval EFI_INVALID_PARAMETER   BltOperation, the rectangle or
+                                  BltBuffer is not valid.
+**/
+EFI_STATUS
+EFIAPI
+DisplayBlt (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL       *This,
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BltBuffer  OPTIONAL,
+  IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION  BltOperation,
+  IN UINTN                              SourceX,
+  IN UINTN                              SourceY,
+  IN UINTN                              DestinationX,
+  IN UINTN                              DestinationY,
+  IN UINTN                              Width,
+  IN UINTN                              Height,
+  IN UINTN                              Delta      OPTIONAL
+  )
+{
+  EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *Frame;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *Video;
+  UINT8                                 *Buffer;
+  UINTN                                 Stride;
+  UINTN                                 Row;
+  EFI_TPL                               OldTpl;
+
+  if (((UINTN)BltOperation >= EfiGraphicsOutputBltOperationMax) || (Width == 0) || (Height == 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((BltOperation != EfiBltVideoToVideo) && (BltBuffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Delta == 0) {
+    Delta = Width * DISPLAY_PIXEL_SIZE;
+  }
+
+  Info   = This->Mode->Info;
+  Frame  = DisplayDrawBuffer (This->Mode);
+  Stride = Info->PixelsPerScanLine;
+
+  switch (BltOperation) {
+  case EfiBltVideoFill:
+  case EfiBltBufferToVideo:
+    if (!DisplayClip (Info, DestinationX, DestinationY, &Width, &Height)) {
+      return EFI_INVALID_PARAMETER;
+    }
+    break;
+
+  case EfiBltVideoToBltBuffer:
+    if (!DisplayClip (Info, SourceX, SourceY, &Width, &Height)) {
+      return EFI_INVALID_PARAMETER;
+    }
+    break;
+
+  default:
+    if (!DisplayClip (Info, SourceX, SourceY, &Width, &Height) ||
+        !DisplayClip (Info, DestinationX, DestinationY, &Width, &Height))
+    {
+      return EFI_INVALID_PARAMETER;
+    }
+    break;
+  }
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+
+  switch (BltOperation) {
+  case EfiBltVideoFill:
+    Video = Frame + DestinationY * Stride + DestinationX;
+    if (Width == Stride) {
+      DisplayFillPixels (Video, *(UINT32 *)BltBuffer, Width * Height);
+      break;
+    }
+    for (Row = 0; Row < Height; Row++, Video += Stride) {
+      DisplayFillPixels (Video, *(UINT32 *)BltBuffer, Width);
+    }
+    break;
+
+  case EfiBltBufferToVideo:
+    Video  = Frame + DestinationY * Stride + DestinationX;
+    Buffer = (UINT8 *)BltBuffer + SourceY * Delta + SourceX * DISPLAY_PIXEL_SIZE;
+    if ((Width == Stride) && (Delta == Stride * DISPLAY_PIXEL_SIZE)) {
+      DisplayCopyPixels (Video, Buffer, Width * Height);
+      break;
+    }
+    for (Row = 0; Row < Height; Row++, Video += Stride, Buffer += Delta) {
+      DisplayCopyPixels (Video, Buffer, Width);
+    }
+    break;
+
+  case EfiBltVideoToBltBuffer:
+    Video  = Frame + SourceY * Stride + SourceX;
+    Buffer = (UINT8 *)BltBuffer + DestinationY * Delta + DestinationX * DISPLAY_PIXEL_SIZE;
+    if ((Width == Stride) && (Delta == Stride * DISPLAY_PIXEL_SIZE)) {
+      DisplayCopyPixels (Buffer, Video, Width * Height);
+      break;
+    }
+    for (Row = 0; Row < Height; Row++, Video += Stride, Buffer += Delta) {
+      DisplayCopyPixels (Buffer, Video, Width);
+    }
+    break;
+
+  default:
+    //
+    // Full-width rows are one run; otherwise rows go bottom up when the
+    // rectangle moves down so that no source row is overwritten first.
+    //
+    if (Width == Stride) {
+      DisplayCopyPixels (
+        Frame + DestinationY * Stride,
+        Frame + SourceY * Stride,
+        Width * Height
+        );
+    } else if (DestinationY > SourceY) {
+      for (Row = Height; Row > 0; Row--) {
+        DisplayCopyPixels (
+          Frame + (DestinationY + Row - 1) * Stride + DestinationX,
+          Frame + (SourceY + Row - 1) * Stride + SourceX,
+          Width
+          );
+      }
+    } else {
+      for (Row = 0; Row < Height; Row++) {
+        DisplayCopyPixels (
+          Frame + (DestinationY + Row) * Stride + DestinationX,
+          Frame + (SourceY + Row) * Stride + SourceX,
+          Width
+          );
+      }
+    }
+    break;
+  }
+
+  if (BltOperation != EfiBltVideoToBltBuffer) {
+    DisplayShadowMarkDirty (DestinationX, DestinationY, Width, Height);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,855 @@
+/** @file
+ *  Text console of the RPi5D GOP.
+ *
+ *  The font is rendered once, in the current colours, into an atlas of
+ *  ready-made 8x16 pixel cells. OutputString composes every run of
+ *  characters on a row from the atlas and draws it with one Blt; a
+ *  scroll is one VideoToVideo move of the text area plus one fill of the
+ *  freed row. A copy of the screen contents lets the cursor be erased by
+ *  redrawing its cell.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include "DisplayDxe.h"
+
+#define DISPLAY_TEXT_MODES     3
+#define DISPLAY_CURSOR_HEIGHT  2
+
+typedef struct {
+  UINTN    Columns;
+  UINTN    Rows;
+} DISPLAY_TEXT_MODE;
+
+STATIC CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  mConsoleColors[16] = {
+  { 0x00, 0x00, 0x00, 0x00 },   // EFI_BLACK
+  { 0x98, 0x00, 0x00, 0x00 },   // EFI_BLUE
+  { 0x00, 0x98, 0x00, 0x00 },   // EFI_GREEN
+  { 0x98, 0x98, 0x00, 0x00 },   // EFI_CYAN
+  { 0x00, 0x00, 0x98, 0x00 },   // EFI_RED
+  { 0x98, 0x00, 0x98, 0x00 },   // EFI_MAGENTA
+  { 0x00, 0x65, 0x98, 0x00 },   // EFI_BROWN
+  { 0x98, 0x98, 0x98, 0x00 },   // EFI_LIGHTGRAY
+  { 0x30, 0x30, 0x30, 0x00 },   // EFI_DARKGRAY
+  { 0xFF, 0x00, 0x00, 0x00 },   // EFI_LIGHTBLUE
+  { 0x00, 0xFF, 0x00, 0x00 },   // EFI_LIGHTGREEN
+  { 0xFF, 0xFF, 0x00, 0x00 },   // EFI_LIGHTCYAN
+  { 0x00, 0x00, 0xFF, 0x00 },   // EFI_LIGHTRED
+  { 0xFF, 0x00, 0xFF, 0x00 },   // EFI_LIGHTMAGENTA
+  { 0x00, 0xFF, 0xFF, 0x00 },   // EFI_YELLOW
+  { 0xFF, 0xFF, 0xFF, 0x00 }    // EFI_WHITE
+};
+
+STATIC EFI_GRAPHICS_OUTPUT_PROTOCOL   *mConsoleGop;
+STATIC DISPLAY_TEXT_MODE              mTextModes[DISPLAY_TEXT_MODES];
+STATIC EFI_SIMPLE_TEXT_OUTPUT_MODE    mTextMode;
+STATIC UINTN                          mColumns;
+STATIC UINTN                          mRows;
+STATIC UINTN                          mOriginX;
+STATIC UINTN                          mOriginY;
+STATIC CHAR16                         *mCells;
+STATIC UINT8                          *mCellAttributes;
+STATIC EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *mLine;
+STATIC EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *mAtlas;
+STATIC INT32                          mAtlasAttribute = -1;
+
+/**
+  Map a character to its glyph.
+
+  @param  Char          UCS-2 character.
+
+  @return Glyph index, or DISPLAY_FONT_GLYPHS if the font lacks it.
+**/
+STATIC
+UINTN
+DisplayConsoleGlyph (
+  IN CHAR16  Char
+  )
+{
+  if ((Char >= L' ') && (Char <= L'~')) {
+    return Char - L' ';
+  }
+
+  switch (Char) {
+    case BLOCKELEMENT_FULL_BLOCK:
+      return DISPLAY_GLYPH_FULL_BLOCK;
+    case BLOCKELEMENT_LIGHT_SHADE:
+      return DISPLAY_GLYPH_LIGHT_SHADE;
+    case BOXDRAW_HORIZONTAL:
+    case BOXDRAW_DOUBLE_HORIZONTAL:
+      return DISPLAY_GLYPH_HORIZONTAL;
+    case BOXDRAW_VERTICAL:
+    case BOXDRAW_DOUBLE_VERTICAL:
+      return DISPLAY_GLYPH_VERTICAL;
+    case ARROW_UP:
+    case GEOMETRICSHAPE_UP_TRIANGLE:
+      return L'^' - L' ';
+    case ARROW_DOWN:
+    case GEOMETRICSHAPE_DOWN_TRIANGLE:
+      return L'v' - L' ';
+    case ARROW_LEFT:
+    case GEOMETRICSHAPE_LEFT_TRIANGLE:
+      return L'<' - L' ';
+    case ARROW_RIGHT:
+    case GEOMETRICSHAPE_RIGHT_TRIANGLE:
+      return L'>' - L' ';
+    default:
+      break;
+  }
+
+  if ((Char >= BOXDRAW_HORIZONTAL) && (Char <= BOXDRAW_DOUBLE_VERTICAL_HORIZONTAL)) {
+    return DISPLAY_GLYPH_BOX;
+  }
+
+  return DISPLAY_FONT_GLYPHS;
+}
+
+/**
+  Render one glyph cell from the font.
+
+  @param  Destination   Top left pixel of the cell.
+  @param  Pitch         Pixels per row of Destination.
+  @param  Glyph         Glyph index.
+  @param  Attribute     EFI text attribute giving the colours.
+**/
+STATIC
+VOID
+DisplayConsoleRenderGlyph (
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Destination,
+  IN  UINTN                          Pitch,
+  IN  UINTN                          Glyph,
+  IN  UINTN                          Attribute
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Foreground;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background;
+  UINT8                          Bits;
+  UINTN                          Row;
+  UINTN                          Column;
+
+  Foreground = mConsoleColors[Attribute & 0x0F];
+  Background = mConsoleColors[(Attribute >> 4) & 0x07];
+
+  for (Row = 0; Row < DISPLAY_FONT_ROWS; Row++, Destination += 2 * Pitch) {
+    Bits = gDisplayFont[Glyph][Row];
+    for (Column = 0; Column < DISPLAY_GLYPH_WIDTH; Column++) {
+      Destination[Column] = ((Bits >> Column) & 1) != 0 ? Foreground : Background;
+    }
+
+    DisplayCopyPixels (Destination + Pitch, Destination, DISPLAY_GLYPH_WIDTH);
+  }
+}
+
+/**
+  Render the whole font into the atlas in the current colours.
+**/
+STATIC
+VOID
+DisplayConsoleBuildAtlas (
+  VOID
+  )
+{
+  UINTN  Glyph;
+
+  for (Glyph = 0; Glyph < DISPLAY_FONT_GLYPHS; Glyph++) {
+    DisplayConsoleRenderGlyph (
+      mAtlas + Glyph * DISPLAY_GLYPH_PIXELS,
+      DISPLAY_GLYPH_WIDTH,
+      Glyph,
+      mTextMode.Attribute
+      );
+  }
+
+  mAtlasAttribute = mTextMode.Attribute;
+}
+
+/**
+  Draw a run of cells of one row, as recorded in the screen copy, with a
+  single Blt.
+
+  @param  Column        First column.
+  @param  Row           Row.
+  @param  Count         Number of cells.
+**/
+STATIC
+VOID
+DisplayConsoleDrawCells (
+  IN UINTN  Column,
+  IN UINTN  Row,
+  IN UINTN  Count
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *Cell;
+  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Glyph;
+  UINTN                                Pitch;
+  UINTN                                Index;
+  UINTN                                GlyphIndex;
+  UINTN                                Line;
+
+  if (Count == 0) {
+    return;
+  }
+
+  Pitch = Count * DISPLAY_GLYPH_WIDTH;
+  for (Index = 0; Index < Count; Index++) {
+    GlyphIndex = DisplayConsoleGlyph (mCells[Row * mColumns + Column + Index]);
+    if (GlyphIndex == DISPLAY_FONT_GLYPHS) {
+      GlyphIndex = L'?' - L' ';
+    }
+
+    Cell = mLine + Index * DISPLAY_GLYPH_WIDTH;
+    if (mCellAttributes[Row * mColumns + Column + Index] != mAtlasAttribute) {
+      DisplayConsoleRenderGlyph (Cell, Pitch, GlyphIndex, mCellAttributes[Row * mColumns + Column + Index]);
+      continue;
+    }
+
+    Glyph = mAtlas + GlyphIndex * DISPLAY_GLYPH_PIXELS;
+    for (Line = 0; Line < DISPLAY_GLYPH_HEIGHT; Line++, Cell += Pitch, Glyph += DISPLAY_GLYPH_WIDTH) {
+      DisplayCopyPixels (Cell, Glyph, DISPLAY_GLYPH_WIDTH);
+    }
+  }
+
+  DisplayBlt (
+    mConsoleGop,
+    mLine,
+    EfiBltBufferToVideo,
+    0,
+    0,
+    mOriginX + Column * DISPLAY_GLYPH_WIDTH,
+    mOriginY + Row * DISPLAY_GLYPH_HEIGHT,
+    Pitch,
+    DISPLAY_GLYPH_HEIGHT,
+    Pitch * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+    );
+}
+
+/**
+  Fill a rectangle of cells with the background colour of Attribute.
+
+  @param  Column        First column.
+  @param  Row           First row.
+  @param  Columns       Width in cells.
+  @param  Rows          Height in cells.
+  @param  Attribute     EFI text attribute.
+**/
+STATIC
+VOID
+DisplayConsoleFill (
+  IN UINTN  Column,
+  IN UINTN  Row,
+  IN UINTN  Columns,
+  IN UINTN  Rows,
+  IN UINTN  Attribute
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background;
+
+  Background = mConsoleColors[(Attribute >> 4) & 0x07];
+  DisplayBlt (
+    mConsoleGop,
+    &Background,
+    EfiBltVideoFill,
+    0,
+    0,
+    mOriginX + Column * DISPLAY_GLYPH_WIDTH,
+    mOriginY + Row * DISPLAY_GLYPH_HEIGHT,
+    Columns * DISPLAY_GLYPH_WIDTH,
+    Rows * DISPLAY_GLYPH_HEIGHT,
+    0
+    );
+}
+
+/**
+  Draw or erase the cursor, an underline in the foreground colour.
+
+  @param  Show          TRUE to draw it, FALSE to restore the cell.
+**/
+STATIC
+VOID
+DisplayConsoleCursor (
+  IN BOOLEAN  Show
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Foreground;
+  UINTN                          Column;
+  UINTN                          Row;
+
+  Column = (UINTN)mTextMode.CursorColumn;
+  Row    = (UINTN)mTextMode.CursorRow;
+  if (!mTextMode.CursorVisible || (Column >= mColumns) || (Row >= mRows)) {
+    return;
+  }
+
+  if (!Show) {
+    DisplayConsoleDrawCells (Column, Row, 1);
+    return;
+  }
+
+  Foreground = mConsoleColors[mTextMode.Attribute & 0x0F];
+  DisplayBlt (
+    mConsoleGop,
+    &Foreground,
+    EfiBltVideoFill,
+    0,
+    0,
+    mOriginX + Column * DISPLAY_GLYPH_WIDTH,
+    mOriginY + (Row + 1) * DISPLAY_GLYPH_HEIGHT - DISPLAY_CURSOR_HEIGHT,
+    DISPLAY_GLYPH_WIDTH,
+    DISPLAY_CURSOR_HEIGHT,
+    0
+    );
+}
+
+/**
+  Scroll the text area up by one row.
+**/
+STATIC
+VOID
+DisplayConsoleScroll (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  CopyMem (mCells, mCells + mColumns, (mRows - 1) * mColumns * sizeof (*mCells));
+  CopyMem (mCellAttributes, mCellAttributes + mColumns, (mRows - 1) * mColumns);
+  for (Index = (mRows - 1) * mColumns; Index < mRows * mColumns; Index++) {
+    mCells[Index]          = L' ';
+    mCellAttributes[Index] = (UINT8)mTextMode.Attribute;
+  }
+
+  DisplayBlt (
+    mConsoleGop,
+    NULL,
+    EfiBltVideoToVideo,
+    mOriginX,
+    mOriginY + DISPLAY_GLYPH_HEIGHT,
+    mOriginX,
+    mOriginY,
+    mColumns * DISPLAY_GLYPH_WIDTH,
+    (mRows - 1) * DISPLAY_GLYPH_HEIGHT,
+    0
+    );
+  DisplayConsoleFill (0, mRows - 1, mColumns, 1, mTextMode.Attribute);
+}
+
+/**
+  Blank the text area in the current attribute and home the cursor.
+**/
+STATIC
+VOID
+DisplayConsoleClear (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mRows * mColumns; Index++) {
+    mCells[Index]          = L' ';
+    mCellAttributes[Index] = (UINT8)mTextMode.Attribute;
+  }
+
+  DisplayConsoleFill (0, 0, mColumns, mRows, mTextMode.Attribute);
+  mTextMode.CursorColumn = 0;
+  mTextMode.CursorRow    = 0;
+  DisplayConsoleCursor (TRUE);
+}
+
+/**
+  Switch to a text mode: reallocate the screen copy and line buffer,
+  centre the text area and clear the screen.
+
+  @param  ModeNumber    Valid text mode.
+
+  @retval EFI_SUCCESS           Mode set.
+  @retval EFI_OUT_OF_RESOURCES  No memory; the console is unusable.
+**/
+STATIC
+EFI_STATUS
+DisplayConsoleSetTextMode (
+  IN UINTN  ModeNumber
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Black;
+  UINTN                          Cells;
+
+  if (mCells != NULL) {
+    FreePool (mCells);
+    FreePool (mCellAttributes);
+    FreePool (mLine);
+  }
+
+  mColumns        = mTextModes[ModeNumber].Columns;
+  mRows           = mTextModes[ModeNumber].Rows;
+  Cells           = mColumns * mRows;
+  mCells          = AllocatePool (Cells * sizeof (*mCells));
+  mCellAttributes = AllocatePool (Cells);
+  mLine           = AllocatePool (mColumns * DISPLAY_GLYPH_PIXELS * sizeof (*mLine));
+  if ((mCells == NULL) || (mCellAttributes == NULL) || (mLine == NULL)) {
+    if (mCells != NULL) {
+      FreePool (mCells);
+    }
+    if (mCellAttributes != NULL) {
+      FreePool (mCellAttributes);
+    }
+    if (mLine != NULL) {
+      FreePool (mLine);
+    }
+    mCells   = NULL;
+    mColumns = 0;
+    mRows    = 0;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mOriginX = (mConsoleGop->Mode->Info->HorizontalResolution - mColumns * DISPLAY_GLYPH_WIDTH) / 2;
+  mOriginY = (mConsoleGop->Mode->Info->VerticalResolution - mRows * DISPLAY_GLYPH_HEIGHT) / 2;
+
+  ZeroMem (&Black, sizeof (Black));
+  DisplayBlt (
+    mConsoleGop,
+    &Black,
+    EfiBltVideoFill,
+    0,
+    0,
+    0,
+    0,
+    mConsoleGop->Mode->Info->HorizontalResolution,
+    mConsoleGop->Mode->Info->VerticalResolution,
+    0
+    );
+
+  mTextMode.Mode = (INT32)ModeNumber;
+  DisplayConsoleClear ();
+  return EFI_SUCCESS;
+}
+
+/**
+  Reset the console: default colours and a clear screen.
+
+  @param  This                  Console instance.
+  @param  ExtendedVerification  Not used.
+
+  @retval EFI_SUCCESS           Console reset.
+  @retval EFI_DEVICE_ERROR      The console has no text mode.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleReset (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN BOOLEAN                          ExtendedVerification
+  )
+{
+  This->SetAttribute (This, EFI_TEXT_ATTR (EFI_LIGHTGRAY, EFI_BACKGROUND_BLACK));
+  return This->ClearScreen (This);
+}
+
+/**
+  Write a string at the cursor, wrapping at the right edge and scrolling
+  at the bottom.
+
+  @param  This          Console instance.
+  @param  String        NUL-terminated string.
+
+  @retval EFI_SUCCESS       String written.
+  @retval EFI_DEVICE_ERROR  The console has no text mode.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleOutputString (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN CHAR16                           *String
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Column;
+  UINTN    Row;
+  UINTN    RunStart;
+  BOOLEAN  NewLine;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+
+  if (mCells == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (mAtlasAttribute != mTextMode.Attribute) {
+    DisplayConsoleBuildAtlas ();
+  }
+
+  DisplayConsoleCursor (FALSE);
+
+  Column   = (UINTN)mTextMode.CursorColumn;
+  Row      = (UINTN)mTextMode.CursorRow;
+  RunStart = Column;
+
+  for ( ; *String != CHAR_NULL; String++) {
+    NewLine = FALSE;
+
+    switch (*String) {
+      case CHAR_BACKSPACE:
+        DisplayConsoleDrawCells (RunStart, Row, Column - RunStart);
+        if (Column > 0) {
+          Column--;
+        }
+        break;
+
+      case CHAR_LINEFEED:
+        DisplayConsoleDrawCells (RunStart, Row, Column - RunStart);
+        NewLine = TRUE;
+        break;
+
+      case CHAR_CARRIAGE_RETURN:
+        DisplayConsoleDrawCells (RunStart, Row, Column - RunStart);
+        Column = 0;
+        break;
+
+      default:
+        mCells[Row * mColumns + Column]          = *String;
+        mCellAttributes[Row * mColumns + Column] = (UINT8)mTextMode.Attribute;
+        if (++Column < mColumns) {
+          continue;
+        }
+
+        DisplayConsoleDrawCells (RunStart, Row, Column - RunStart);
+        Column  = 0;
+        NewLine = TRUE;
+        break;
+    }
+
+    if (NewLine) {
+      if (Row + 1 < mRows) {
+        Row++;
+      } else {
+        DisplayConsoleScroll ();
+      }
+    }
+
+    RunStart = Column;
+  }
+
+  DisplayConsoleDrawCells (RunStart, Row, Column - RunStart);
+
+  mTextMode.CursorColumn = (INT32)Column;
+  mTextMode.CursorRow    = (INT32)Row;
+  DisplayConsoleCursor (TRUE);
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Check that every character of a string can be displayed.
+
+  @param  This          Console instance.
+  @param  String        NUL-terminated string.
+
+  @retval EFI_SUCCESS       All characters have a glyph.
+  @retval EFI_UNSUPPORTED   Some character has none.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleTestString (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN CHAR16                           *String
+  )
+{
+  for ( ; *String != CHAR_NULL; String++) {
+    switch (*String) {
+      case CHAR_BACKSPACE:
+      case CHAR_LINEFEED:
+      case CHAR_CARRIAGE_RETURN:
+        break;
+
+      default:
+        if (DisplayConsoleGlyph (*String) == DISPLAY_FONT_GLYPHS) {
+          return EFI_UNSUPPORTED;
+        }
+        break;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the geometry of a text mode.
+
+  @param  This          Console instance.
+  @param  ModeNumber    Text mode.
+  @param  Columns       Columns of the mode.
+  @param  Rows          Rows of the mode.
+
+  @retval EFI_SUCCESS       Mode described.
+  @retval EFI_UNSUPPORTED   No such mode.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleQueryMode (
+  IN  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN  UINTN                            ModeNumber,
+  OUT UINTN                            *Columns,
+  OUT UINTN                            *Rows
+  )
+{
+  if ((ModeNumber >= (UINTN)mTextMode.MaxMode) || (mTextModes[ModeNumber].Columns == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Columns = mTextModes[ModeNumber].Columns;
+  *Rows    = mTextModes[ModeNumber].Rows;
+  return EFI_SUCCESS;
+}
+
+/**
+  Switch to a text mode and clear the screen.
+
+  @param  This          Console instance.
+  @param  ModeNumber    Text mode.
+
+  @retval EFI_SUCCESS       Mode set.
+  @retval EFI_UNSUPPORTED   No such mode.
+  @retval EFI_DEVICE_ERROR  Buffers for the mode could not be allocated.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleSetMode (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN UINTN                            ModeNumber
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+
+  if ((ModeNumber >= (UINTN)mTextMode.MaxMode) || (mTextModes[ModeNumber].Columns == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+  Status = DisplayConsoleSetTextMode (ModeNumber);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+/**
+  Set the colours of subsequent output. The atlas is rebuilt on the next
+  OutputString.
+
+  @param  This          Console instance.
+  @param  Attribute     EFI text attribute.
+
+  @retval EFI_SUCCESS       Attribute set.
+  @retval EFI_UNSUPPORTED   Attribute out of range.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleSetAttribute (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN UINTN                            Attribute
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if ((Attribute & ~(UINTN)0x7F) != 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+  DisplayConsoleCursor (FALSE);
+  mTextMode.Attribute = (INT32)Attribute;
+  DisplayConsoleCursor (TRUE);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Clear the screen to the current background colour.
+
+  @param  This          Console instance.
+
+  @retval EFI_SUCCESS       Screen cleared.
+  @retval EFI_DEVICE_ERROR  The console has no text mode.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleClearScreen (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+  if (mCells == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  DisplayConsoleClear ();
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Move the cursor.
+
+  @param  This          Console instance.
+  @param  Column        New column.
+  @param  Row           New row.
+
+  @retval EFI_SUCCESS       Cursor moved.
+  @retval EFI_UNSUPPORTED   Position outside the text area.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleSetCursorPosition (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN UINTN                            Column,
+  IN UINTN                            Row
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+  if ((Column >= mColumns) || (Row >= mRows)) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_UNSUPPORTED;
+  }
+
+  DisplayConsoleCursor (FALSE);
+  mTextMode.CursorColumn = (INT32)Column;
+  mTextMode.CursorRow    = (INT32)Row;
+  DisplayConsoleCursor (TRUE);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Show or hide the cursor.
+
+  @param  This          Console instance.
+  @param  Visible       TRUE to show it.
+
+  @retval EFI_SUCCESS   Cursor updated.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+DisplayConsoleEnableCursor (
+  IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This,
+  IN BOOLEAN                          Visible
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+  DisplayConsoleCursor (FALSE);
+  mTextMode.CursorVisible = Visible;
+  DisplayConsoleCursor (TRUE);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  mTextOut = {
+  DisplayConsoleReset,
+  DisplayConsoleOutputString,
+  DisplayConsoleTestString,
+  DisplayConsoleQueryMode,
+  DisplayConsoleSetMode,
+  DisplayConsoleSetAttribute,
+  DisplayConsoleClearScreen,
+  DisplayConsoleSetCursorPosition,
+  DisplayConsoleEnableCursor,
+  &mTextMode
+};
+
+/**
+  Rebuild the text modes for the current GOP mode and switch to the
+  largest one. Called after every GOP mode change.
+**/
+VOID
+DisplayConsoleModeChanged (
+  VOID
+  )
+{
+  UINTN    Columns;
+  UINTN    Rows;
+  EFI_TPL  OldTpl;
+
+  if (mConsoleGop == NULL) {
+    return;
+  }
+
+  OldTpl  = gBS->RaiseTPL (DISPLAY_TPL);
+  Columns = mConsoleGop->Mode->Info->HorizontalResolution / DISPLAY_GLYPH_WIDTH;
+  Rows    = mConsoleGop->Mode->Info->VerticalResolution / DISPLAY_GLYPH_HEIGHT;
+
+  //
+  // Mode 0 is 80x25 and mode 1 80x50 or nothing, as the UEFI spec
+  // requires; mode 2 is the whole screen when it is larger.
+  //
+  ZeroMem (mTextModes, sizeof (mTextModes));
+  mTextModes[0].Columns = MIN (Columns, 80);
+  mTextModes[0].Rows    = MIN (Rows, 25);
+  if ((Columns >= 80) && (Rows >= 50)) {
+    mTextModes[1].Columns = 80;
+    mTextModes[1].Rows    = 50;
+  }
+
+  mTextMode.MaxMode = 2;
+  if (((Columns != mTextModes[0].Columns) || (Rows != mTextModes[0].Rows)) &&
+      ((Columns != 80) || (Rows != 50)))
+  {
+    mTextModes[2].Columns = Columns;
+    mTextModes[2].Rows    = Rows;
+    mTextMode.MaxMode     = 3;
+  }
+
+  DisplayConsoleSetTextMode (mTextModes[2].Columns != 0 ? 2 : (mTextModes[1].Columns != 0 ? 1 : 0));
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Create the console on top of a GOP whose mode is already set.
+
+  @param  Gop           Display to draw on.
+
+  @return Console protocol, or NULL if out of memory.
+**/
+EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *
+DisplayConsoleInit (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL  *Gop
+  )
+{
+  mAtlas = AllocatePool (DISPLAY_FONT_GLYPHS * DISPLAY_GLYPH_PIXELS * sizeof (*mAtlas));
+  if (mAtlas == NULL) {
+    return NULL;
+  }
+
+  mConsoleGop             = Gop;
+  mTextMode.Attribute     = EFI_TEXT_ATTR (EFI_LIGHTGRAY, EFI_BACKGROUND_BLACK);
+  mTextMode.CursorVisible = TRUE;
+  DisplayConsoleModeChanged ();
+
+  if (mCells == NULL) {
+    FreePool (mAtlas);
+    mAtlas      = NULL;
+    mConsoleGop = NULL;
+    return NULL;
+  }
+
+  return &mTextOut;
+}
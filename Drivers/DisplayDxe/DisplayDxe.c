@@ -6,15 +6,7 @@
  *
  **/
 
-#include <Uefi.h>
-#include <Protocol/GraphicsOutput.h>
-#include <Protocol/DevicePath.h>
-#include <Library/DebugLib.h>
-#include <Library/UefiBootServicesTableLib.h>
-#include <Library/UefiDriverEntryPoint.h>
-#include <Library/BaseMemoryLib.h>
-#include <Library/MemoryAllocationLib.h>
-#include <Library/DevicePathLib.h>
+#include "DisplayDxe.h"
 
 typedef struct {
   VENDOR_DEVICE_PATH          Vendor;
@@ -48,23 +40,42 @@ STATIC EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE mMode;
 STATIC EFI_GRAPHICS_OUTPUT_MODE_INFORMATION mModeInfo;
 
 /**
-  Dummy QueryMode function.
+  Return information about a mode.
+
+  The caller owns and frees the returned buffer, so it is a pool copy of
+  the prebuilt mode table entry; the driver itself reads the table.
+
+  @param  This          GOP instance.
+  @param  ModeNumber    Mode to describe.
+  @param  SizeOfInfo    Size of Info.
+  @param  Info          Callee-allocated mode information.
+
+  @retval EFI_SUCCESS            Mode described.
+  @retval EFI_INVALID_PARAMETER  Bad arguments or no such mode.
+  @retval EFI_OUT_OF_RESOURCES   No memory for Info.
 **/
 EFI_STATUS
 EFIAPI
-DummyQueryMode (
+DisplayQueryMode (
   IN EFI_GRAPHICS_OUTPUT_PROTOCOL          *This,
   IN UINT32                                ModeNumber,
   OUT UINTN                                *SizeOfInfo,
   OUT EFI_GRAPHICS_OUTPUT_MODE_INFORMATION **Info
   )
 {
-  if (ModeNumber != 0) {
-    return EFI_UNSUPPORTED;
+  CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *ModeInfo;
+
+  if ((SizeOfInfo == NULL) || (Info == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ModeInfo = DisplayGetMode (ModeNumber);
+  if (ModeInfo == NULL) {
+    return EFI_INVALID_PARAMETER;
   }
 
   *SizeOfInfo = sizeof (EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
-  *Info = AllocateCopyPool (*SizeOfInfo, &mModeInfo);
+  *Info = AllocateCopyPool (*SizeOfInfo, ModeInfo);
   if (*Info == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -73,53 +84,29 @@ DummyQueryMode (
 }
 
 /**
-  Dummy SetMode function.
+  Switch to another mode of the mode table.
+
+  @param  This          GOP instance.
+  @param  ModeNumber    Mode to set.
+
+  @retval EFI_SUCCESS       Mode set and screen cleared.
+  @retval EFI_UNSUPPORTED   No such mode.
 **/
 EFI_STATUS
 EFIAPI
-DummySetMode (
+DisplaySetMode (
   IN EFI_GRAPHICS_OUTPUT_PROTOCOL  *This,
   IN UINT32                        ModeNumber
   )
 {
-  if (ModeNumber != 0) {
-    return EFI_UNSUPPORTED;
-  }
-
-  return EFI_SUCCESS;
-}
+  EFI_STATUS  Status;
 
-/**
-  Dummy Blt function.
-**/
-EFI_STATUS
-EFIAPI
-DummyBlt (
-  IN EFI_GRAPHICS_OUTPUT_PROTOCOL      *This,
-  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer,
-  IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
-  IN UINTN                             SourceX,
-  IN UINTN                             SourceY,
-  IN UINTN                             DestinationX,
-  IN UINTN                             DestinationY,
-  IN UINTN                             Width,
-  IN UINTN                             Height,
-  IN UINTN                             Delta
-  )
-{
-  // 簡單 framebuffer 填色測試
-  if (BltOperation == EfiBltVideoFill) {
-    UINT32 *Fb = (UINT32 *)(UINTN)mMode.FrameBufferBase;
-    UINT32 Color = *(UINT32 *)BltBuffer;
-    UINTN  Pixels = mModeInfo.HorizontalResolution * mModeInfo.VerticalResolution;
-    UINTN  i;
-    
-    for (i = 0; i < Pixels; i++) {
-      Fb[i] = Color;
-    }
+  Status = DisplayApplyMode (&mMode, ModeNumber);
+  if (!EFI_ERROR (Status)) {
+    DisplayConsoleModeChanged ();
   }
-  
-  return EFI_SUCCESS;
+
+  return Status;
 }
 
 /**
@@ -132,31 +119,28 @@ InitializeDisplayDxe (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
-  EFI_STATUS  Status;
-  EFI_HANDLE  Handle = NULL;
+  EFI_STATUS                       Status;
+  EFI_HANDLE                       Handle = NULL;
+  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *TextOut;
 
   DEBUG ((DEBUG_INFO, "RPi5D DisplayDxe: Initializing\n"));
 
-  // 設定顯示模式 - 1920x1080 32bpp
-  mModeInfo.Version = 0;
-  mModeInfo.HorizontalResolution = 1920;
-  mModeInfo.VerticalResolution = 1080;
-  mModeInfo.PixelFormat = PixelBlueGreenRedReserved8BitPerColor;
-  mModeInfo.PixelsPerScanLine = 1920;
-
-  // RPi5 D 版 framebuffer 位址
-  // 注意：實際位址需要從 DTB 讀取，這裡先用 0x3b000000 測試
-  mMode.MaxMode = 1;
-  mMode.Mode = 0;
+  // 從 DTB 取得 framebuffer 並建立模式表
   mMode.Info = &mModeInfo;
-  mMode.SizeOfInfo = sizeof (EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
-  mMode.FrameBufferBase = 0x3b000000;
-  mMode.FrameBufferSize = 1920 * 1080 * 4;
+  Status = DisplayInitModes (&mMode);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = DisplayApplyMode (&mMode, DISPLAY_BOOT_MODE < mMode.MaxMode ? DISPLAY_BOOT_MODE : 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   // 設定 GOP 協議
-  mGop.QueryMode = DummyQueryMode;
-  mGop.SetMode = DummySetMode;
-  mGop.Blt = DummyBlt;
+  mGop.QueryMode = DisplayQueryMode;
+  mGop.SetMode = DisplaySetMode;
+  mGop.Blt = DisplayBlt;
   mGop.Mode = &mMode;
 
   // 安裝協議
@@ -176,5 +160,26 @@ InitializeDisplayDxe (
           mModeInfo.HorizontalResolution,
           mModeInfo.VerticalResolution));
 
+  // 文字主控台
+  TextOut = DisplayConsoleInit (&mGop);
+  if (TextOut == NULL) {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: No text console\n"));
+  } else {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Handle,
+                    &gEfiSimpleTextOutProtocolGuid, TextOut,
+                    NULL
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: Failed to install text console: %r\n", Status));
+    }
+  }
+
+  // 開機畫面
+  Status = DisplayLogoShow (&mGop);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: No boot logo: %r\n", Status));
+  }
+
   return EFI_SUCCESS;
 }
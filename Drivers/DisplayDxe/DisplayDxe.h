@@ -0,0 +1,195 @@
+/** @file
+ *  GOP driver for Raspberry Pi 5 D-step
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#ifndef DISPLAY_DXE_H_
+#define DISPLAY_DXE_H_
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include <Protocol/DevicePath.h>
+#include <Protocol/SimpleTextOut.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiDriverEntryPoint.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/DevicePathLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/UefiLib.h>
+#include <Library/DxeServicesLib.h>
+#include <Library/BaseLib.h>
+#include <Library/HobLib.h>
+#include <Guid/Fdt.h>
+#include <libfdt.h>
+
+#include "DisplayLogo.h"
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Platform/RPi5D.h"
+
+//
+// Blt runs at this TPL so that a console and a logo draw never interleave
+// inside one operation.
+//
+#define DISPLAY_TPL  TPL_NOTIFY
+
+//
+// Shadow framebuffer: rectangles tracked between flushes, and how often
+// the flush timer runs. Build with -DDISPLAY_NO_SHADOW to have Blt draw
+// straight into the scan-out buffer.
+//
+#define DISPLAY_DIRTY_RECTS     8
+#define DISPLAY_FLUSH_INTERVAL  EFI_TIMER_PERIOD_MILLISECONDS (20)
+
+//
+// Framebuffer assumed when the device tree does not describe one, the
+// number of mode table entries, and the mode set at load time. Build with
+// -DDISPLAY_BOOT_MODE=<n> to start in a smaller mode.
+//
+#define DISPLAY_DEFAULT_BASE    RPI5D_FRAMEBUFFER_BASE
+#define DISPLAY_DEFAULT_WIDTH   1920
+#define DISPLAY_DEFAULT_HEIGHT  1080
+#define DISPLAY_MAX_MODES       6
+
+#ifndef DISPLAY_BOOT_MODE
+#define DISPLAY_BOOT_MODE  0
+#endif
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS    Base;
+  UINTN                   Size;
+  UINT32                  Width;
+  UINT32                  Height;
+  UINT32                  Stride;     // in pixels
+} DISPLAY_FRAMEBUFFER;
+
+//
+// Console: 8x8 font glyphs doubled vertically into 8x16 cells. Glyphs
+// 0x20-0x7E are printable ASCII; the rest are listed in DisplayFont.c.
+//
+#define DISPLAY_FONT_GLYPHS    100
+#define DISPLAY_FONT_ROWS      8
+#define DISPLAY_GLYPH_WIDTH    8
+#define DISPLAY_GLYPH_HEIGHT   16
+#define DISPLAY_GLYPH_PIXELS   (DISPLAY_GLYPH_WIDTH * DISPLAY_GLYPH_HEIGHT)
+
+#define DISPLAY_GLYPH_FULL_BLOCK   95
+#define DISPLAY_GLYPH_LIGHT_SHADE  96
+#define DISPLAY_GLYPH_HORIZONTAL   97
+#define DISPLAY_GLYPH_VERTICAL     98
+#define DISPLAY_GLYPH_BOX          99
+
+extern CONST UINT8  gDisplayFont[DISPLAY_FONT_GLYPHS][DISPLAY_FONT_ROWS];
+
+//
+// Boot logo: the FREEFORM file holding it (see RPi5D.fdf), and the rows
+// decoded per Blt.
+//
+#define DISPLAY_LOGO_FILE_GUID \
+  { 0x7b2e4c1a, 0x9d3f, 0x4e86, { 0xb5, 0xa1, 0x3c, 0x8f, 0x0d, 0x6e, 0x2a, 0x94 } }
+
+#define DISPLAY_LOGO_BAND  16
+
+//
+// DisplayBlt.c
+//
+VOID
+DisplayCopyPixels (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Count
+  );
+
+VOID
+DisplayFillPixels (
+  OUT VOID    *Destination,
+  IN  UINT32  Color,
+  IN  UINTN   Count
+  );
+
+EFI_STATUS
+EFIAPI
+DisplayBlt (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL       *This,
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BltBuffer  OPTIONAL,
+  IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION  BltOperation,
+  IN UINTN                              SourceX,
+  IN UINTN                              SourceY,
+  IN UINTN                              DestinationX,
+  IN UINTN                              DestinationY,
+  IN UINTN                              Width,
+  IN UINTN                              Height,
+  IN UINTN                              Delta      OPTIONAL
+  );
+
+//
+// DisplayShadow.c
+//
+EFI_GRAPHICS_OUTPUT_BLT_PIXEL *
+DisplayDrawBuffer (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  );
+
+VOID
+DisplayShadowMarkDirty (
+  IN UINTN  X,
+  IN UINTN  Y,
+  IN UINTN  Width,
+  IN UINTN  Height
+  );
+
+VOID
+DisplayShadowFlush (
+  VOID
+  );
+
+EFI_STATUS
+DisplayShadowInit (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  );
+
+//
+// DisplayMode.c
+//
+EFI_STATUS
+DisplayInitModes (
+  IN OUT EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  );
+
+CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *
+DisplayGetMode (
+  IN UINT32  ModeNumber
+  );
+
+EFI_STATUS
+DisplayApplyMode (
+  IN OUT EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode,
+  IN     UINT32                             ModeNumber
+  );
+
+//
+// DisplayConsole.c
+//
+EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *
+DisplayConsoleInit (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL  *Gop
+  );
+
+VOID
+DisplayConsoleModeChanged (
+  VOID
+  );
+
+//
+// DisplayLogo.c
+//
+EFI_STATUS
+DisplayLogoShow (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL  *Gop
+  );
+
+#endif
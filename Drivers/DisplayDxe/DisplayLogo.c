@@ -0,0 +1,105 @@
+/** @file
+ *  Boot logo of the RPi5D GOP.
+ *
+ *  The logo is a DisplayLogo.h image in a FREEFORM file of the firmware
+ *  volume. It is decoded a band of rows at a time and each band goes to
+ *  the screen with one Blt, centred on the screen in its background
+ *  colour.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include "DisplayDxe.h"
+
+STATIC CONST EFI_GUID  mDisplayLogoFileGuid = DISPLAY_LOGO_FILE_GUID;
+
+/**
+  Draw the boot logo from the firmware volume.
+
+  @param  Gop           Display to draw on.
+
+  @retval EFI_SUCCESS           Logo drawn.
+  @retval EFI_NOT_FOUND         No logo in the firmware volume.
+  @retval EFI_VOLUME_CORRUPTED  The logo does not decode.
+  @retval EFI_BAD_BUFFER_SIZE   The logo is larger than the screen.
+  @retval EFI_OUT_OF_RESOURCES  No memory for a band of rows.
+**/
+EFI_STATUS
+DisplayLogoShow (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL  *Gop
+  )
+{
+  EFI_STATUS                     Status;
+  VOID                           *Image;
+  UINTN                          Size;
+  DISPLAY_LOGO_DECODER           Decoder;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background;
+  UINT32                         *Band;
+  UINTN                          ScreenWidth;
+  UINTN                          ScreenHeight;
+  UINTN                          X;
+  UINTN                          Y;
+  UINTN                          Rows;
+
+  Status = GetSectionFromAnyFv (&mDisplayLogoFileGuid, EFI_SECTION_RAW, 0, &Image, &Size);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Band   = NULL;
+  Status = DisplayLogoDecodeInit (&Decoder, Image, Size);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  ScreenWidth  = Gop->Mode->Info->HorizontalResolution;
+  ScreenHeight = Gop->Mode->Info->VerticalResolution;
+  if ((Decoder.Width > ScreenWidth) || (Decoder.Height > ScreenHeight)) {
+    Status = EFI_BAD_BUFFER_SIZE;
+    goto Done;
+  }
+
+  Band = AllocatePool (Decoder.Width * DISPLAY_LOGO_BAND * sizeof (*Band));
+  if (Band == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  CopyMem (&Background, &((DISPLAY_LOGO_HEADER *)Image)->Background, sizeof (Background));
+  DisplayBlt (Gop, &Background, EfiBltVideoFill, 0, 0, 0, 0, ScreenWidth, ScreenHeight, 0);
+
+  X = (ScreenWidth - Decoder.Width) / 2;
+  Y = (ScreenHeight - Decoder.Height) / 2;
+  while (Decoder.Row < Decoder.Height) {
+    Rows   = MIN (DISPLAY_LOGO_BAND, Decoder.Height - Decoder.Row);
+    Status = DisplayLogoDecodeRows (&Decoder, Band, Rows);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    DisplayBlt (
+      Gop,
+      (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)Band,
+      EfiBltBufferToVideo,
+      0,
+      0,
+      X,
+      Y + Decoder.Row - Rows,
+      Decoder.Width,
+      Rows,
+      Decoder.Width * sizeof (*Band)
+      );
+  }
+
+  DisplayShadowFlush ();
+
+Done:
+  if (Band != NULL) {
+    FreePool (Band);
+  }
+
+  FreePool (Image);
+  return Status;
+}
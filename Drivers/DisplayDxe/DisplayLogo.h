@@ -0,0 +1,65 @@
+/** @file
+ *  Run-length encoded boot logo format of the RPi5D GOP.
+ *
+ *  A DISPLAY_LOGO_HEADER followed by a stream of packets covering the
+ *  image in row order. Each packet starts with a control byte:
+ *
+ *    0x00-0x7F   literal: (n + 1) pixels follow, 3 bytes each (B, G, R)
+ *    0x80-0xFF   run: one pixel (B, G, R) repeated (n - 0x80 + 2) times
+ *
+ *  Packets may cross row boundaries. Logo/LogoEncode.py produces the
+ *  format from a BMP.
+ *
+ *  Only Base.h types are used, so the decoder also builds on the host for
+ *  Logo/LogoBench.c.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#ifndef DISPLAY_LOGO_H_
+#define DISPLAY_LOGO_H_
+
+#define DISPLAY_LOGO_SIGNATURE  SIGNATURE_32 ('R', 'P', 'L', 'G')
+
+#define DISPLAY_LOGO_LITERAL_MAX  0x80
+#define DISPLAY_LOGO_RUN          0x80
+#define DISPLAY_LOGO_RUN_MIN      2
+
+#pragma pack (1)
+typedef struct {
+  UINT32    Signature;
+  UINT16    Width;
+  UINT16    Height;
+  UINT32    Background;       // B, G, R, 0: colour of the rest of the screen
+  UINT32    DataSize;         // bytes of packets after the header
+} DISPLAY_LOGO_HEADER;
+#pragma pack ()
+
+typedef struct {
+  CONST UINT8    *Data;
+  CONST UINT8    *End;
+  UINT32         Width;
+  UINT32         Height;
+  UINT32         Row;
+  UINT32         Pending;     // pixels left in the current packet
+  BOOLEAN        Literal;
+  UINT32         Color;       // pixel of the current run
+} DISPLAY_LOGO_DECODER;
+
+RETURN_STATUS
+DisplayLogoDecodeInit (
+  OUT DISPLAY_LOGO_DECODER  *Decoder,
+  IN  CONST VOID            *Image,
+  IN  UINTN                 Size
+  );
+
+RETURN_STATUS
+DisplayLogoDecodeRows (
+  IN OUT DISPLAY_LOGO_DECODER  *Decoder,
+  OUT    UINT32                *Pixels,
+  IN     UINTN                 Rows
+  );
+
+#endif
@@ -0,0 +1,142 @@
+/** @file
+ *  Streaming decoder of the RPi5D boot logo.
+ *
+ *  Rows are produced a band at a time into a caller buffer; the decoder
+ *  keeps the packet it stopped in, so no full-size bitmap ever exists.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#ifndef DISPLAY_LOGO_HOST
+#include <Base.h>
+#endif
+
+#include "DisplayLogo.h"
+
+/**
+  Check a logo image and start decoding it.
+
+  @param  Decoder       Decoder state.
+  @param  Image         DISPLAY_LOGO_HEADER and packets.
+  @param  Size          Size of Image.
+
+  @retval RETURN_SUCCESS            Decoder ready at row 0.
+  @retval RETURN_VOLUME_CORRUPTED   Not a logo, or truncated.
+**/
+RETURN_STATUS
+DisplayLogoDecodeInit (
+  OUT DISPLAY_LOGO_DECODER  *Decoder,
+  IN  CONST VOID            *Image,
+  IN  UINTN                 Size
+  )
+{
+  CONST DISPLAY_LOGO_HEADER  *Header;
+
+  Header = Image;
+  if ((Size < sizeof (*Header)) || (Header->Signature != DISPLAY_LOGO_SIGNATURE) ||
+      (Header->Width == 0) || (Header->Height == 0) ||
+      (Header->DataSize > Size - sizeof (*Header)))
+  {
+    return RETURN_VOLUME_CORRUPTED;
+  }
+
+  Decoder->Data    = (CONST UINT8 *)(Header + 1);
+  Decoder->End     = Decoder->Data + Header->DataSize;
+  Decoder->Width   = Header->Width;
+  Decoder->Height  = Header->Height;
+  Decoder->Row     = 0;
+  Decoder->Pending = 0;
+  Decoder->Literal = FALSE;
+  Decoder->Color   = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decode the next rows of the logo.
+
+  @param  Decoder       Decoder state.
+  @param  Pixels        Width * Rows pixels, B, G, R, 0 each.
+  @param  Rows          Rows wanted; fewer are produced at the bottom.
+
+  @retval RETURN_SUCCESS            Rows decoded.
+  @retval RETURN_VOLUME_CORRUPTED   The packets end early or overflow.
+**/
+RETURN_STATUS
+DisplayLogoDecodeRows (
+  IN OUT DISPLAY_LOGO_DECODER  *Decoder,
+  OUT    UINT32                *Pixels,
+  IN     UINTN                 Rows
+  )
+{
+  CONST UINT8  *Data;
+  UINT32       *Last;
+  UINT32       Count;
+  UINT32       Color;
+  UINT8        Control;
+
+  if (Rows > Decoder->Height - Decoder->Row) {
+    Rows = Decoder->Height - Decoder->Row;
+  }
+
+  Data  = Decoder->Data;
+  Last  = Pixels + Rows * Decoder->Width;
+  Count = Decoder->Pending;
+
+  while (Pixels < Last) {
+    if (Count == 0) {
+      if (Data >= Decoder->End) {
+        return RETURN_VOLUME_CORRUPTED;
+      }
+
+      Control          = *Data++;
+      Decoder->Literal = (BOOLEAN)(Control < DISPLAY_LOGO_RUN);
+      if (Decoder->Literal) {
+        Count = Control + 1;
+        if ((UINTN)(Decoder->End - Data) < Count * 3) {
+          return RETURN_VOLUME_CORRUPTED;
+        }
+      } else {
+        if (Decoder->End - Data < 3) {
+          return RETURN_VOLUME_CORRUPTED;
+        }
+
+        Count          = Control - DISPLAY_LOGO_RUN + DISPLAY_LOGO_RUN_MIN;
+        Decoder->Color = Data[0] | ((UINT32)Data[1] << 8) | ((UINT32)Data[2] << 16);
+        Data          += 3;
+      }
+    }
+
+    if (Count > (UINT32)(Last - Pixels)) {
+      Decoder->Pending = Count - (UINT32)(Last - Pixels);
+      Count            = (UINT32)(Last - Pixels);
+    } else {
+      Decoder->Pending = 0;
+    }
+
+    if (Decoder->Literal) {
+      for ( ; Count > 0; Count--, Data += 3) {
+        *Pixels++ = Data[0] | ((UINT32)Data[1] << 8) | ((UINT32)Data[2] << 16);
+      }
+    } else {
+      Color = Decoder->Color;
+      for ( ; Count >= 4; Count -= 4, Pixels += 4) {
+        Pixels[0] = Color;
+        Pixels[1] = Color;
+        Pixels[2] = Color;
+        Pixels[3] = Color;
+      }
+
+      for ( ; Count > 0; Count--) {
+        *Pixels++ = Color;
+      }
+    }
+
+    Count = Decoder->Pending;
+  }
+
+  Decoder->Data  = Data;
+  Decoder->Row  += (UINT32)Rows;
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,387 @@
+/** @file
+ *  Framebuffer discovery and mode table of the RPi5D GOP.
+ *
+ *  The VideoCore firmware allocates the framebuffer. MemoryInitPeiLib
+ *  claims it through the mailbox and keeps its geometry in the VideoCore
+ *  properties HOB; the device tree the firmware hands over also describes
+ *  it, as a simple-framebuffer node. Its resolution becomes mode 0; the smaller modes of the table are windows
+ *  centred in the same scan-out buffer, so clearing and drawing them
+ *  costs only their own area.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include "DisplayDxe.h"
+
+typedef struct {
+  UINT32    Width;
+  UINT32    Height;
+} DISPLAY_RESOLUTION;
+
+STATIC CONST EFI_GUID  mDisplayVideoCoreGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+
+//
+// Smaller modes offered below the firmware resolution
+//
+STATIC CONST DISPLAY_RESOLUTION  mDisplayResolutions[] = {
+  { 1920, 1080 },
+  { 1280, 720  },
+  { 1024, 768  },
+  { 800,  600  },
+  { 640,  480  }
+};
+
+STATIC DISPLAY_FRAMEBUFFER                   mFramebuffer;
+STATIC EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  mModes[DISPLAY_MAX_MODES];
+
+/**
+  Read a cell-encoded number from a device tree property.
+
+  @param  Cells         First cell.
+  @param  Count         Number of 32-bit cells, 1 or 2.
+
+  @return Value of the cells.
+**/
+STATIC
+UINT64
+DisplayReadCells (
+  IN CONST UINT32  *Cells,
+  IN INT32         Count
+  )
+{
+  UINT64  Value;
+
+  Value = 0;
+  while (Count-- > 0) {
+    Value = LShiftU64 (Value, 32) | fdt32_to_cpu (ReadUnaligned32 (Cells++));
+  }
+
+  return Value;
+}
+
+/**
+  Read a single-cell property of a device tree node.
+
+  @param  Fdt           Device tree.
+  @param  Node          Node offset.
+  @param  Name          Property name.
+  @param  Value         Property value.
+
+  @retval TRUE          Property present.
+  @retval FALSE         Property missing or malformed.
+**/
+STATIC
+BOOLEAN
+DisplayReadProperty (
+  IN  CONST VOID   *Fdt,
+  IN  INT32        Node,
+  IN  CONST CHAR8  *Name,
+  OUT UINT32       *Value
+  )
+{
+  CONST UINT32  *Prop;
+  INT32         Length;
+
+  Prop = fdt_getprop (Fdt, Node, Name, &Length);
+  if ((Prop == NULL) || (Length != sizeof (UINT32))) {
+    return FALSE;
+  }
+
+  *Value = fdt32_to_cpu (ReadUnaligned32 (Prop));
+  return TRUE;
+}
+
+/**
+  Take the framebuffer from the VideoCore properties HOB.
+
+  @param  Framebuffer   Framebuffer found.
+
+  @retval EFI_SUCCESS       Framebuffer reported by the VideoCore firmware.
+  @retval EFI_NOT_FOUND     No HOB, or the firmware reported no framebuffer.
+  @retval EFI_UNSUPPORTED   The framebuffer is not 32 bits per pixel.
+**/
+STATIC
+EFI_STATUS
+DisplayFramebufferFromFirmware (
+  OUT DISPLAY_FRAMEBUFFER  *Framebuffer
+  )
+{
+  VOID                        *Hob;
+  CONST VIDEOCORE_PROPERTIES  *Properties;
+
+  Hob = GetFirstGuidHob (&mDisplayVideoCoreGuid);
+  if (Hob == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Properties = GET_GUID_HOB_DATA (Hob);
+  if ((Properties->FramebufferSize == 0) || (Properties->FramebufferWidth == 0) ||
+      (Properties->FramebufferHeight == 0))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  if (Properties->FramebufferDepth != 32) {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: Unsupported framebuffer depth %d\n", Properties->FramebufferDepth));
+    return EFI_UNSUPPORTED;
+  }
+
+  Framebuffer->Base   = Properties->FramebufferBase;
+  Framebuffer->Size   = Properties->FramebufferSize;
+  Framebuffer->Width  = Properties->FramebufferWidth;
+  Framebuffer->Height = Properties->FramebufferHeight;
+  Framebuffer->Stride = Properties->FramebufferPitch / sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+
+  if ((Framebuffer->Stride < Framebuffer->Width) ||
+      (Framebuffer->Size < (UINTN)Properties->FramebufferPitch * Framebuffer->Height))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Look for the framebuffer in the device tree installed by the firmware.
+
+  @param  Framebuffer   Framebuffer found.
+
+  @retval EFI_SUCCESS       Framebuffer described by the device tree.
+  @retval EFI_NOT_FOUND     No device tree, or no usable framebuffer node.
+  @retval EFI_UNSUPPORTED   The framebuffer is not 32-bit xRGB.
+**/
+STATIC
+EFI_STATUS
+DisplayFramebufferFromFdt (
+  OUT DISPLAY_FRAMEBUFFER  *Framebuffer
+  )
+{
+  VOID          *Fdt;
+  CONST CHAR8   *Format;
+  CONST CHAR8   *Okay;
+  CONST UINT32  *Reg;
+  INT32         Node;
+  INT32         Parent;
+  INT32         AddressCells;
+  INT32         SizeCells;
+  INT32         Length;
+  UINT32        Stride;
+
+  if (EFI_ERROR (EfiGetSystemConfigurationTable (&gFdtTableGuid, &Fdt)) || (fdt_check_header (Fdt) != 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  for (Node = fdt_node_offset_by_compatible (Fdt, -1, "simple-framebuffer");
+       Node >= 0;
+       Node = fdt_node_offset_by_compatible (Fdt, Node, "simple-framebuffer"))
+  {
+    Okay = fdt_getprop (Fdt, Node, "status", &Length);
+    if ((Okay == NULL) || (AsciiStrCmp (Okay, "okay") == 0)) {
+      break;
+    }
+  }
+  if (Node < 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  Parent       = fdt_parent_offset (Fdt, Node);
+  AddressCells = fdt_address_cells (Fdt, Parent);
+  SizeCells    = fdt_size_cells (Fdt, Parent);
+  Reg          = fdt_getprop (Fdt, Node, "reg", &Length);
+  if ((Reg == NULL) || (AddressCells < 1) || (AddressCells > 2) || (SizeCells < 1) || (SizeCells > 2) ||
+      (Length < (AddressCells + SizeCells) * (INT32)sizeof (UINT32)))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  if (!DisplayReadProperty (Fdt, Node, "width", &Framebuffer->Width) ||
+      !DisplayReadProperty (Fdt, Node, "height", &Framebuffer->Height) ||
+      !DisplayReadProperty (Fdt, Node, "stride", &Stride))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // a8r8g8b8 is B, G, R, A in memory: the GOP Blt pixel layout.
+  //
+  Format = fdt_getprop (Fdt, Node, "format", &Length);
+  if ((Format == NULL) ||
+      ((AsciiStrCmp (Format, "a8r8g8b8") != 0) && (AsciiStrCmp (Format, "x8r8g8b8") != 0)))
+  {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: Unsupported framebuffer format %a\n", Format == NULL ? "?" : Format));
+    return EFI_UNSUPPORTED;
+  }
+
+  Framebuffer->Base   = DisplayReadCells (Reg, AddressCells);
+  Framebuffer->Size   = (UINTN)DisplayReadCells (Reg + AddressCells, SizeCells);
+  Framebuffer->Stride = Stride / sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+
+  if ((Framebuffer->Width == 0) || (Framebuffer->Height == 0) ||
+      ((Stride % sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0) ||
+      (Framebuffer->Stride < Framebuffer->Width) ||
+      (Framebuffer->Size < (UINTN)Stride * Framebuffer->Height))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the framebuffer and build the mode table: the firmware resolution
+  first, then every smaller entry of mDisplayResolutions.
+
+  The VideoCore properties are tried first, then the device tree; without
+  either the fixed DISPLAY_DEFAULT_* framebuffer is assumed.
+
+  @param  Mode          GOP mode; MaxMode is filled in.
+
+  @retval EFI_SUCCESS   Mode table ready.
+**/
+EFI_STATUS
+DisplayInitModes (
+  IN OUT EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Count;
+  UINTN       Index;
+
+  Status = DisplayFramebufferFromFirmware (&mFramebuffer);
+  if (EFI_ERROR (Status)) {
+    Status = DisplayFramebufferFromFdt (&mFramebuffer);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: Framebuffer not reported by the firmware (%r), using defaults\n", Status));
+    mFramebuffer.Base   = DISPLAY_DEFAULT_BASE;
+    mFramebuffer.Width  = DISPLAY_DEFAULT_WIDTH;
+    mFramebuffer.Height = DISPLAY_DEFAULT_HEIGHT;
+    mFramebuffer.Stride = DISPLAY_DEFAULT_WIDTH;
+    mFramebuffer.Size   = DISPLAY_DEFAULT_WIDTH * DISPLAY_DEFAULT_HEIGHT * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  }
+
+  DEBUG ((DEBUG_INFO, "RPi5D DisplayDxe: Framebuffer 0x%lx, %dx%d, stride %d\n",
+          mFramebuffer.Base, mFramebuffer.Width, mFramebuffer.Height, mFramebuffer.Stride));
+
+  ZeroMem (mModes, sizeof (mModes));
+  mModes[0].HorizontalResolution = mFramebuffer.Width;
+  mModes[0].VerticalResolution   = mFramebuffer.Height;
+  Count                          = 1;
+
+  for (Index = 0; (Index < ARRAY_SIZE (mDisplayResolutions)) && (Count < DISPLAY_MAX_MODES); Index++) {
+    if ((mDisplayResolutions[Index].Width > mFramebuffer.Width) ||
+        (mDisplayResolutions[Index].Height > mFramebuffer.Height) ||
+        ((mDisplayResolutions[Index].Width == mFramebuffer.Width) &&
+         (mDisplayResolutions[Index].Height == mFramebuffer.Height)))
+    {
+      continue;
+    }
+
+    mModes[Count].HorizontalResolution = mDisplayResolutions[Index].Width;
+    mModes[Count].VerticalResolution   = mDisplayResolutions[Index].Height;
+    Count++;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    mModes[Index].Version           = 0;
+    mModes[Index].PixelFormat       = PixelBlueGreenRedReserved8BitPerColor;
+    mModes[Index].PixelsPerScanLine = mFramebuffer.Stride;
+  }
+
+  Mode->MaxMode    = Count;
+  Mode->SizeOfInfo = sizeof (EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the description of a mode.
+
+  @param  ModeNumber    Mode number.
+
+  @return Mode information, or NULL if there is no such mode.
+**/
+CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *
+DisplayGetMode (
+  IN UINT32  ModeNumber
+  )
+{
+  if ((ModeNumber >= DISPLAY_MAX_MODES) || (mModes[ModeNumber].HorizontalResolution == 0)) {
+    return NULL;
+  }
+
+  return &mModes[ModeNumber];
+}
+
+/**
+  Switch to a mode: blank the scan-out buffer, place the mode window in
+  it and give it a fresh shadow. If no shadow can be set up, Blt falls
+  back to drawing into the scan-out buffer. Runs at DISPLAY_TPL, so no
+  Blt or shadow flush sees the geometry half updated.
+
+  @param  Mode          GOP mode, updated for the new mode.
+  @param  ModeNumber    Mode number.
+
+  @retval EFI_SUCCESS       Mode set.
+  @retval EFI_UNSUPPORTED   No such mode.
+**/
+EFI_STATUS
+DisplayApplyMode (
+  IN OUT EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode,
+  IN     UINT32                             ModeNumber
+  )
+{
+  CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info;
+  EFI_STATUS                                  Status;
+  UINTN                                       Offset;
+  UINTN                                       Pixels;
+  VOID                                        *Frame;
+  EFI_TPL                                     OldTpl;
+
+  Info = DisplayGetMode (ModeNumber);
+  if (Info == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+
+  //
+  // Blank the whole scan-out buffer so nothing of a larger previous mode
+  // is left around the new window.
+  //
+  Frame  = (VOID *)(UINTN)mFramebuffer.Base;
+  Pixels = mFramebuffer.Stride * mFramebuffer.Height;
+  DisplayFillPixels (Frame, 0, Pixels);
+  WriteBackDataCacheRange (Frame, Pixels * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+
+  Offset = ((mFramebuffer.Height - Info->VerticalResolution) / 2) * mFramebuffer.Stride +
+           (mFramebuffer.Width - Info->HorizontalResolution) / 2;
+
+  CopyMem (Mode->Info, Info, sizeof (*Info));
+  Mode->Mode            = ModeNumber;
+  Mode->FrameBufferBase = mFramebuffer.Base + Offset * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  Mode->FrameBufferSize = ((Info->VerticalResolution - 1) * mFramebuffer.Stride + Info->HorizontalResolution) *
+                          sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+
+#ifndef DISPLAY_NO_SHADOW
+  //
+  // Without a shadow Blt draws straight into the scan-out buffer, as in a
+  // -DDISPLAY_NO_SHADOW build, so the mode is still usable.
+  //
+  Status = DisplayShadowInit (Mode);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "RPi5D DisplayDxe: No shadow framebuffer, drawing directly: %r\n", Status));
+    Status = EFI_SUCCESS;
+  }
+#else
+  Status = EFI_SUCCESS;
+#endif
+
+  gBS->RestoreTPL (OldTpl);
+
+  DEBUG ((DEBUG_INFO, "RPi5D DisplayDxe: Mode %d, %dx%d at 0x%lx\n",
+          ModeNumber, Info->HorizontalResolution, Info->VerticalResolution, Mode->FrameBufferBase));
+  return Status;
+}
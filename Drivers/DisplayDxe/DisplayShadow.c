@@ -0,0 +1,273 @@
+/** @file
+ *  Shadow framebuffer of the RPi5D GOP.
+ *
+ *  Blt draws into a cached copy of the framebuffer and records the
+ *  rectangles it touched. They are copied to the scan-out buffer and
+ *  cleaned from the data cache by a periodic timer, on demand, and one
+ *  last time at ExitBootServices, after which the OS owns the real
+ *  framebuffer. Reads back and console scrolls hit cached memory.
+ *
+ *  Only Blt keeps the two in step: anything written straight to
+ *  FrameBufferBase is overwritten by the next flush of that area.
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include "DisplayDxe.h"
+
+typedef struct {
+  UINTN    Left;
+  UINTN    Top;
+  UINTN    Right;
+  UINTN    Bottom;
+} DISPLAY_RECT;
+
+STATIC EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *mShadowMode;
+STATIC EFI_GRAPHICS_OUTPUT_BLT_PIXEL      *mShadow;
+STATIC UINTN                              mShadowPages;
+STATIC DISPLAY_RECT                       mDirty[DISPLAY_DIRTY_RECTS];
+STATIC UINTN                              mDirtyCount;
+STATIC EFI_EVENT                          mFlushTimer;
+STATIC EFI_EVENT                          mExitBootServicesEvent;
+
+/**
+  Return the buffer Blt draws into: the shadow when there is one, the
+  scan-out buffer otherwise.
+
+  @param  Mode          Current GOP mode.
+
+  @return First pixel of the draw buffer.
+**/
+EFI_GRAPHICS_OUTPUT_BLT_PIXEL *
+DisplayDrawBuffer (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  )
+{
+  if (mShadow != NULL) {
+    return mShadow;
+  }
+
+  return (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)(UINTN)Mode->FrameBufferBase;
+}
+
+/**
+  Record a rectangle of the shadow as changed. Overlapping and touching
+  rectangles are merged; when the list is full everything collapses into
+  its bounding box.
+
+  @param  X             Left edge.
+  @param  Y             Top edge.
+  @param  Width         Width in pixels.
+  @param  Height        Height in pixels.
+**/
+VOID
+DisplayShadowMarkDirty (
+  IN UINTN  X,
+  IN UINTN  Y,
+  IN UINTN  Width,
+  IN UINTN  Height
+  )
+{
+  DISPLAY_RECT  Rect;
+  DISPLAY_RECT  *Dirty;
+  UINTN         Index;
+
+  if ((mShadow == NULL) || (Width == 0) || (Height == 0)) {
+    return;
+  }
+
+  Rect.Left   = X;
+  Rect.Top    = Y;
+  Rect.Right  = X + Width;
+  Rect.Bottom = Y + Height;
+
+  for (Index = 0; Index < mDirtyCount; Index++) {
+    Dirty = &mDirty[Index];
+    if ((Rect.Left <= Dirty->Right) && (Dirty->Left <= Rect.Right) &&
+        (Rect.Top <= Dirty->Bottom) && (Dirty->Top <= Rect.Bottom))
+    {
+      Dirty->Left   = MIN (Dirty->Left, Rect.Left);
+      Dirty->Top    = MIN (Dirty->Top, Rect.Top);
+      Dirty->Right  = MAX (Dirty->Right, Rect.Right);
+      Dirty->Bottom = MAX (Dirty->Bottom, Rect.Bottom);
+      return;
+    }
+  }
+
+  if (mDirtyCount < DISPLAY_DIRTY_RECTS) {
+    mDirty[mDirtyCount++] = Rect;
+    return;
+  }
+
+  for (Index = 1; Index < mDirtyCount; Index++) {
+    mDirty[0].Left   = MIN (mDirty[0].Left, mDirty[Index].Left);
+    mDirty[0].Top    = MIN (mDirty[0].Top, mDirty[Index].Top);
+    mDirty[0].Right  = MAX (mDirty[0].Right, mDirty[Index].Right);
+    mDirty[0].Bottom = MAX (mDirty[0].Bottom, mDirty[Index].Bottom);
+  }
+  mDirty[0].Left   = MIN (mDirty[0].Left, Rect.Left);
+  mDirty[0].Top    = MIN (mDirty[0].Top, Rect.Top);
+  mDirty[0].Right  = MAX (mDirty[0].Right, Rect.Right);
+  mDirty[0].Bottom = MAX (mDirty[0].Bottom, Rect.Bottom);
+  mDirtyCount      = 1;
+}
+
+/**
+  Copy the dirty rectangles of the shadow to the scan-out buffer and
+  clean them from the data cache so the display controller sees them.
+**/
+VOID
+DisplayShadowFlush (
+  VOID
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Frame;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Video;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Shadow;
+  DISPLAY_RECT                   *Dirty;
+  EFI_TPL                        OldTpl;
+  UINTN                          Stride;
+  UINTN                          Width;
+  UINTN                          Index;
+  UINTN                          Row;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+
+  if (mShadow != NULL) {
+    Frame  = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)(UINTN)mShadowMode->FrameBufferBase;
+    Stride = mShadowMode->Info->PixelsPerScanLine;
+
+    for (Index = 0; Index < mDirtyCount; Index++) {
+      Dirty  = &mDirty[Index];
+      Width  = Dirty->Right - Dirty->Left;
+      Video  = Frame + Dirty->Top * Stride + Dirty->Left;
+      Shadow = mShadow + Dirty->Top * Stride + Dirty->Left;
+
+      if (Width == Stride) {
+        DisplayCopyPixels (Video, Shadow, Width * (Dirty->Bottom - Dirty->Top));
+        WriteBackDataCacheRange (Video, Width * (Dirty->Bottom - Dirty->Top) * sizeof (*Video));
+        continue;
+      }
+
+      for (Row = Dirty->Top; Row < Dirty->Bottom; Row++, Video += Stride, Shadow += Stride) {
+        DisplayCopyPixels (Video, Shadow, Width);
+        WriteBackDataCacheRange (Video, Width * sizeof (*Video));
+      }
+    }
+
+    mDirtyCount = 0;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Periodic flush.
+
+  @param  Event         Flush timer.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+DisplayShadowFlushNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  if (mDirtyCount != 0) {
+    DisplayShadowFlush ();
+  }
+}
+
+/**
+  Hand the framebuffer over to the OS with everything drawn so far.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+DisplayShadowExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DisplayShadowFlush ();
+  mShadow = NULL;
+}
+
+/**
+  Set up the shadow of the current mode, replacing the shadow of any
+  previous mode. The shadow starts out as a copy of the framebuffer.
+
+  @param  Mode          Current GOP mode.
+
+  @retval EFI_SUCCESS           Blt draws into the shadow.
+  @retval EFI_OUT_OF_RESOURCES  No memory; Blt draws into the framebuffer.
+  @retval others                Flush events could not be created.
+**/
+EFI_STATUS
+DisplayShadowInit (
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE  *Mode
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+
+  OldTpl = gBS->RaiseTPL (DISPLAY_TPL);
+
+  if (mShadow != NULL) {
+    FreePages (mShadow, mShadowPages);
+    mShadow = NULL;
+  }
+  mDirtyCount = 0;
+  mShadowMode = Mode;
+
+  Status = EFI_SUCCESS;
+  if (mFlushTimer == NULL) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    DISPLAY_TPL,
+                    DisplayShadowFlushNotify,
+                    NULL,
+                    &mFlushTimer
+                    );
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->CreateEvent (
+                      EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                      TPL_NOTIFY,
+                      DisplayShadowExitBootServices,
+                      NULL,
+                      &mExitBootServicesEvent
+                      );
+      if (EFI_ERROR (Status)) {
+        gBS->CloseEvent (mFlushTimer);
+        mFlushTimer = NULL;
+      }
+    }
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->SetTimer (mFlushTimer, TimerPeriodic, DISPLAY_FLUSH_INTERVAL);
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    mShadowPages = EFI_SIZE_TO_PAGES (Mode->FrameBufferSize);
+    mShadow      = AllocatePages (mShadowPages);
+    if (mShadow == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    } else {
+      DisplayCopyPixels (
+        mShadow,
+        (VOID *)(UINTN)Mode->FrameBufferBase,
+        Mode->FrameBufferSize / sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+        );
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
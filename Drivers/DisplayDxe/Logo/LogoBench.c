@@ -0,0 +1,135 @@
+/** @file
+ *  Host benchmark of the boot logo decoder.
+ *
+ *  Builds the firmware decoder unchanged and times full decodes of an
+ *  encoded logo, a band of DISPLAY_LOGO_BAND rows at a time as
+ *  DisplayLogoShow does:
+ *
+ *    cc -O2 -o LogoBench LogoBench.c && ./LogoBench Logo.rle
+ *
+ *  Copyright (c) 2026, TW045261
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DISPLAY_LOGO_HOST
+
+typedef uint8_t    UINT8;
+typedef uint16_t   UINT16;
+typedef uint32_t   UINT32;
+typedef uint64_t   UINT64;
+typedef size_t     UINTN;
+typedef UINTN      RETURN_STATUS;
+typedef UINT8      BOOLEAN;
+
+#define CONST                    const
+#define VOID                     void
+#define IN
+#define OUT
+#define TRUE                     ((BOOLEAN)1)
+#define FALSE                    ((BOOLEAN)0)
+#define RETURN_SUCCESS           0
+#define RETURN_VOLUME_CORRUPTED  ((RETURN_STATUS)1 << (sizeof (UINTN) * 8 - 1) | 10)
+#define SIGNATURE_32(A, B, C, D) \
+  ((UINT32)(A) | ((UINT32)(B) << 8) | ((UINT32)(C) << 16) | ((UINT32)(D) << 24))
+
+#include "../DisplayLogoDecode.c"
+
+#define DISPLAY_LOGO_BAND  16
+#define BENCH_SECONDS      1.0
+
+static double
+Now (
+  void
+  )
+{
+  struct timespec  Time;
+
+  clock_gettime (CLOCK_MONOTONIC, &Time);
+  return Time.tv_sec + Time.tv_nsec / 1e9;
+}
+
+int
+main (
+  int   Argc,
+  char  **Argv
+  )
+{
+  FILE                  *File;
+  UINT8                 *Image;
+  UINT32                *Band;
+  long                  Size;
+  DISPLAY_LOGO_DECODER  Decoder;
+  UINT64                Checksum;
+  UINTN                 Index;
+  unsigned long         Decodes;
+  double                Start;
+  double                Elapsed;
+
+  if (Argc != 2) {
+    fprintf (stderr, "usage: %s logo.rle\n", Argv[0]);
+    return 2;
+  }
+
+  File = fopen (Argv[1], "rb");
+  if (File == NULL) {
+    perror (Argv[1]);
+    return 1;
+  }
+
+  fseek (File, 0, SEEK_END);
+  Size = ftell (File);
+  rewind (File);
+  Image = malloc (Size);
+  if ((Image == NULL) || (fread (Image, 1, Size, File) != (size_t)Size)) {
+    fprintf (stderr, "%s: read failed\n", Argv[1]);
+    return 1;
+  }
+
+  fclose (File);
+
+  if (DisplayLogoDecodeInit (&Decoder, Image, Size) != RETURN_SUCCESS) {
+    fprintf (stderr, "%s: not a logo\n", Argv[1]);
+    return 1;
+  }
+
+  Band     = malloc (Decoder.Width * DISPLAY_LOGO_BAND * sizeof (*Band));
+  Checksum = 0;
+  Decodes  = 0;
+  Start    = Now ();
+  do {
+    DisplayLogoDecodeInit (&Decoder, Image, Size);
+    while (Decoder.Row < Decoder.Height) {
+      if (DisplayLogoDecodeRows (&Decoder, Band, DISPLAY_LOGO_BAND) != RETURN_SUCCESS) {
+        fprintf (stderr, "%s: corrupt at row %u\n", Argv[1], Decoder.Row);
+        return 1;
+      }
+
+      for (Index = 0; Index < Decoder.Width; Index++) {
+        Checksum += Band[Index];
+      }
+    }
+
+    Decodes++;
+    Elapsed = Now () - Start;
+  } while (Elapsed < BENCH_SECONDS);
+
+  printf (
+    "%ux%u, %ld bytes: %.1f us per decode, %.0f Mpixel/s (checksum %llx)\n",
+    Decoder.Width,
+    Decoder.Height,
+    Size,
+    Elapsed * 1e6 / Decodes,
+    (double)Decodes * Decoder.Width * Decoder.Height / Elapsed / 1e6,
+    (unsigned long long)Checksum
+    );
+
+  free (Band);
+  free (Image);
+  return 0;
+}
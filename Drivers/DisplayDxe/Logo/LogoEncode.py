@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+## @file
+#  Convert a BMP into the run-length encoded boot logo of DisplayDxe.
+#
+#  The format is described in DisplayLogo.h. Example:
+#
+#    LogoEncode.py Logo.bmp Logo.rle
+#
+#  Copyright (c) 2026, TW045261
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import argparse
+import struct
+import sys
+
+LOGO_SIGNATURE = struct.unpack('<I', b'RPLG')[0]
+LITERAL_MAX = 0x80
+RUN = 0x80
+RUN_MIN = 2
+RUN_MAX = 0x7F + RUN_MIN
+
+
+def read_bmp(path):
+    """Return (width, height, rows) with rows top-down, pixels as (B, G, R)."""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[0:2] != b'BM':
+        sys.exit('%s: not a BMP' % path)
+
+    offset, = struct.unpack_from('<I', data, 10)
+    width, height, planes, bpp, compression = struct.unpack_from('<iiHHI', data, 18)
+    if bpp not in (24, 32) or compression not in (0, 3):
+        sys.exit('%s: only uncompressed 24 and 32-bit BMPs are supported' % path)
+
+    top_down = height < 0
+    height = abs(height)
+    step = bpp // 8
+    stride = (width * step + 3) & ~3
+
+    rows = []
+    for y in range(height):
+        base = offset + y * stride
+        rows.append([tuple(data[base + x * step:base + x * step + 3]) for x in range(width)])
+
+    if not top_down:
+        rows.reverse()
+
+    return width, height, rows
+
+
+def encode(pixels):
+    """Encode a flat pixel list into literal and run packets."""
+    out = bytearray()
+    literal = []
+    i = 0
+
+    def flush():
+        while literal:
+            chunk = literal[:LITERAL_MAX]
+            del literal[:LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            for pixel in chunk:
+                out.extend(pixel)
+
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < RUN_MAX and pixels[i + run] == pixels[i]:
+            run += 1
+
+        if run >= RUN_MIN:
+            flush()
+            out.append(RUN + run - RUN_MIN)
+            out.extend(pixels[i])
+        else:
+            literal.append(pixels[i])
+
+        i += run
+
+    flush()
+    return bytes(out)
+
+
+def decode(data, width, height):
+    """Reference decoder, used to check the encoder output."""
+    pixels = []
+    i = 0
+    while len(pixels) < width * height:
+        control = data[i]
+        i += 1
+        if control < RUN:
+            for _ in range(control + 1):
+                pixels.append(tuple(data[i:i + 3]))
+                i += 3
+        else:
+            pixels.extend([tuple(data[i:i + 3])] * (control - RUN + RUN_MIN))
+            i += 3
+
+    return pixels[:width * height]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode a BMP as a DisplayDxe boot logo.')
+    parser.add_argument('input', help='24 or 32-bit BMP')
+    parser.add_argument('output', help='encoded logo')
+    parser.add_argument('--background', metavar='RRGGBB',
+                        help='screen colour around the logo (default: top left pixel)')
+    args = parser.parse_args()
+
+    width, height, rows = read_bmp(args.input)
+    if width > 0xFFFF or height > 0xFFFF:
+        sys.exit('%s: too large' % args.input)
+
+    pixels = [pixel for row in rows for pixel in row]
+    if args.background:
+        # 0x00RRGGBB is B, G, R, 0 in little-endian memory
+        background = int(args.background, 16) & 0xFFFFFF
+    else:
+        b, g, r = pixels[0]
+        background = b | g << 8 | r << 16
+
+    data = encode(pixels)
+    if decode(data, width, height) != pixels:
+        sys.exit('internal error: encoded logo does not decode back')
+
+    with open(args.output, 'wb') as f:
+        f.write(struct.pack('<IHHII', LOGO_SIGNATURE, width, height, background, len(data)))
+        f.write(data)
+
+    print('%s: %dx%d, %d bytes (%.1f%% of BGRA)' %
+          (args.output, width, height, len(data) + 16, 100.0 * (len(data) + 16) / (width * height * 4)))
+
+
+if __name__ == '__main__':
+    main()
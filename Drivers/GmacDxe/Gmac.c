@@ -0,0 +1,744 @@
+/** @file
+  Ethernet MAC engine of GmacDxe.
+
+  The MAC is polled: its interrupts stay masked. Both rings and the
+  receive buffers are allocated once. A frame to send is gathered by the
+  MAC straight from the caller's fragments; a received frame is copied
+  once, from its receive buffer into the caller's buffer, and the buffer
+  goes back to the MAC. The only MMIO read on the data path is GMAC_TBQP,
+  read when the transmit frames known to be done run out.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Gmac.h"
+
+typedef struct {
+  GMAC_DEVICE  *Gmac;
+  EFI_STATUS   Status;
+} GMAC_PHY_WAIT;
+
+STATIC
+UINT64
+GmacDmaAddress (
+  IN GMAC_DEVICE  *Gmac,
+  IN VOID         *Buffer
+  )
+{
+  return (UINT64)(UINTN)Buffer + Gmac->DmaOffset;
+}
+
+/**
+  Clean Count transmit descriptors from Index, wrapping at the end of
+  the ring.
+**/
+STATIC
+VOID
+GmacCleanTx (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       Index,
+  IN UINT32       Count
+  )
+{
+  UINT32  Run;
+
+  Run = MIN (Count, GMAC_TX_DESCRIPTORS - Index);
+  WriteBackDataCacheRange (&Gmac->TxRing[Index], Run * sizeof (GMAC_DESCRIPTOR));
+  if (Run < Count) {
+    WriteBackDataCacheRange (&Gmac->TxRing[0], (Count - Run) * sizeof (GMAC_DESCRIPTOR));
+  }
+}
+
+STATIC
+EFI_STATUS
+GmacMdioRead (
+  IN  GMAC_DEVICE  *Gmac,
+  IN  UINT8        Register,
+  OUT UINT16       *Value
+  )
+{
+  EFI_STATUS  Status;
+
+  PlatformMmioWrite32 (Gmac->Base + GMAC_MAN, GMAC_MAN_READ (Gmac->PhyAddress, Register));
+  Status = PlatformWaitMmio32 (Gmac->Base + GMAC_NSR, GMAC_NSR_IDLE, GMAC_NSR_IDLE, GMAC_MDIO_TIMEOUT, NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *Value = (UINT16)(PlatformMmioRead32 (Gmac->Base + GMAC_MAN) & GMAC_MAN_DATA);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+GmacMdioWrite (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT8        Register,
+  IN UINT16       Value
+  )
+{
+  PlatformMmioWrite32 (Gmac->Base + GMAC_MAN, GMAC_MAN_WRITE (Gmac->PhyAddress, Register) | Value);
+  return PlatformWaitMmio32 (Gmac->Base + GMAC_NSR, GMAC_NSR_IDLE, GMAC_NSR_IDLE, GMAC_MDIO_TIMEOUT, NULL);
+}
+
+/**
+  Wait condition: the PHY has left reset, or MDIO failed.
+
+  @param  Context       GMAC_PHY_WAIT.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+GmacPhyResetDone (
+  IN VOID  *Context
+  )
+{
+  GMAC_PHY_WAIT  *Wait;
+  UINT16         Bmcr;
+
+  Wait         = Context;
+  Wait->Status = GmacMdioRead (Wait->Gmac, MII_BMCR, &Bmcr);
+  return EFI_ERROR (Wait->Status) || ((Bmcr & MII_BMCR_RESET) == 0);
+}
+
+EFI_STATUS
+GmacInit (
+  IN OUT GMAC_DEVICE  *Gmac
+  )
+{
+  UINT64  RxRing;
+  UINT64  TxRing;
+  UINT64  Buffer;
+  UINT32  Index;
+
+  //
+  // Receive, transmit and interrupts off, status cleared. Turning
+  // receive and transmit off also puts the MAC back at the start of
+  // each ring.
+  //
+  Gmac->Ncr = GMAC_NCR_MPE;
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_IDR, GMAC_INT_ALL);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_TSR, GMAC_TSR_ALL);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_RSR, GMAC_RSR_ALL);
+  PlatformMmioRead32 (Gmac->Base + GMAC_ISR);
+
+  if ((PlatformMmioRead32 (Gmac->Base + GMAC_DCFG6) & GMAC_DCFG6_DAW64) == 0) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] MAC 0x%08x has no 64-bit DMA\n", PlatformMmioRead32 (Gmac->Base + GMAC_MID)));
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Gmac->Dma == NULL) {
+    Gmac->Dma = AllocateAlignedPages (EFI_SIZE_TO_PAGES (GMAC_DMA_SIZE), GMAC_DMA_ALIGNMENT);
+    if (Gmac->Dma == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Gmac->RxRing    = (GMAC_DESCRIPTOR *)(Gmac->Dma + GMAC_RX_RING_OFFSET);
+    Gmac->TxRing    = (GMAC_DESCRIPTOR *)(Gmac->Dma + GMAC_TX_RING_OFFSET);
+    Gmac->RxBuffers = Gmac->Dma + GMAC_RX_BUFFER_OFFSET;
+    Gmac->TxFrames  = (GMAC_TX_FRAME *)(Gmac->Dma + GMAC_TX_FRAME_OFFSET);
+  }
+
+  //
+  // Every receive buffer belongs to the MAC; every transmit descriptor
+  // to the CPU.
+  //
+  for (Index = 0; Index < GMAC_RX_DESCRIPTORS; Index++) {
+    Buffer                             = GmacDmaAddress (Gmac, Gmac->RxBuffers + Index * GMAC_RX_BUFFER_SIZE);
+    Gmac->RxRing[Index].Address        = (UINT32)Buffer;
+    Gmac->RxRing[Index].Control        = 0;
+    Gmac->RxRing[Index].AddressHigh    = (UINT32)RShiftU64 (Buffer, 32);
+    Gmac->RxRing[Index].Reserved       = 0;
+  }
+
+  for (Index = 0; Index < GMAC_TX_DESCRIPTORS; Index++) {
+    Gmac->TxRing[Index].Address     = 0;
+    Gmac->TxRing[Index].Control     = GMAC_TX_USED;
+    Gmac->TxRing[Index].AddressHigh = 0;
+    Gmac->TxRing[Index].Reserved    = 0;
+  }
+
+  Gmac->RxRing[GMAC_RX_DESCRIPTORS - 1].Address |= GMAC_RX_WRAP;
+  Gmac->TxRing[GMAC_TX_DESCRIPTORS - 1].Control |= GMAC_TX_WRAP;
+  ZeroMem (Gmac->TxFrames, GMAC_TX_DESCRIPTORS * sizeof (GMAC_TX_FRAME));
+  WriteBackInvalidateDataCacheRange (Gmac->Dma, GMAC_TX_FRAME_OFFSET);
+
+  Gmac->RxNext     = 0;
+  Gmac->TxHead     = 0;
+  Gmac->TxTail     = 0;
+  Gmac->TxPending  = 0;
+  Gmac->TxHardware = 0;
+
+  //
+  // The filter and link bits are kept across a reinit.
+  //
+  Gmac->Ncfgr = (Gmac->Ncfgr & (GMAC_NCFGR_LINK_MASK | GMAC_NCFGR_CAF | GMAC_NCFGR_NBC | GMAC_NCFGR_MTIHEN)) |
+                GMAC_NCFGR_RFCS | GMAC_NCFGR_CLK_DIV96 | GMAC_NCFGR_DBW64;
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCFGR, Gmac->Ncfgr);
+  PlatformMmioWrite32 (
+    Gmac->Base + GMAC_DMACFG,
+    GMAC_DMACFG_INCR16 | GMAC_DMACFG_RXBMS_FULL | GMAC_DMACFG_TXPBMS | GMAC_DMACFG_RXBS (GMAC_RX_BUFFER_SIZE) | GMAC_DMACFG_ADDR64
+    );
+
+  RxRing = GmacDmaAddress (Gmac, Gmac->RxRing);
+  TxRing = GmacDmaAddress (Gmac, Gmac->TxRing);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_RBQPH, (UINT32)RShiftU64 (RxRing, 32));
+  PlatformMmioWrite32 (Gmac->Base + GMAC_RBQP, (UINT32)RxRing);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_TBQPH, (UINT32)RShiftU64 (TxRing, 32));
+  PlatformMmioWrite32 (Gmac->Base + GMAC_TBQP, (UINT32)TxRing);
+
+  GmacSetAddress (Gmac, Gmac->MacAddress);
+  return EFI_SUCCESS;
+}
+
+VOID
+GmacEnable (
+  IN GMAC_DEVICE  *Gmac,
+  IN BOOLEAN      Enable
+  )
+{
+  if (Enable) {
+    Gmac->Ncr |= GMAC_NCR_RE | GMAC_NCR_TE;
+    PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr);
+    return;
+  }
+
+  Gmac->Ncr &= ~(GMAC_NCR_RE | GMAC_NCR_TE);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr);
+  if (EFI_ERROR (PlatformWaitMmio32 (Gmac->Base + GMAC_TSR, GMAC_TSR_TGO, 0, GMAC_TX_STOP_TIMEOUT, NULL))) {
+    DEBUG ((DEBUG_WARN, "[GMAC] Transmit did not stop\n"));
+  }
+
+  //
+  // Whatever the MAC has not sent is dropped; GmacReclaim hands every
+  // frame back.
+  //
+  Gmac->TxHardware = Gmac->TxHead;
+}
+
+EFI_STATUS
+GmacPhyInit (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  EFI_STATUS     Status;
+  UINT16         Id1;
+  UINT16         Id2;
+  GMAC_PHY_WAIT  Wait;
+
+  Status = GmacMdioRead (Gmac, MII_PHYID1, &Id1);
+  if (!EFI_ERROR (Status)) {
+    Status = GmacMdioRead (Gmac, MII_PHYID2, &Id2);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] MDIO timeout\n"));
+    return Status;
+  }
+
+  if (((Id1 == 0xFFFF) && (Id2 == 0xFFFF)) || ((Id1 == 0) && (Id2 == 0))) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] No PHY at address %d\n", Gmac->PhyAddress));
+    return EFI_NOT_FOUND;
+  }
+
+  DEBUG ((DEBUG_INFO, "[GMAC] PHY %d: ID %04x:%04x\n", Gmac->PhyAddress, Id1, Id2));
+
+  Wait.Gmac   = Gmac;
+  Wait.Status = GmacMdioWrite (Gmac, MII_BMCR, MII_BMCR_RESET);
+  if (!EFI_ERROR (Wait.Status)) {
+    Status = PlatformWaitCondition (GmacPhyResetDone, &Wait, GMAC_PHY_RESET_TIMEOUT, NULL);
+  }
+
+  if (EFI_ERROR (Wait.Status) || EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] PHY reset timeout\n"));
+    return EFI_TIMEOUT;
+  }
+
+  //
+  // Advertise every speed and duplex and let the link come up in the
+  // background; GmacUpdateLink follows it.
+  //
+  Status = GmacMdioWrite (Gmac, MII_ANAR, MII_AN_ALL | MII_AN_SELECTOR);
+  if (!EFI_ERROR (Status)) {
+    Status = GmacMdioWrite (Gmac, MII_GBCR, MII_GBCR_1000FD);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = GmacMdioWrite (Gmac, MII_BMCR, MII_BMCR_ANENABLE | MII_BMCR_ANRESTART);
+  }
+
+  Gmac->LinkUp = FALSE;
+  return Status;
+}
+
+BOOLEAN
+GmacUpdateLink (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  UINT16  Bmsr;
+  UINT16  Gbcr;
+  UINT16  Gbsr;
+  UINT16  Anar;
+  UINT16  Anlpar;
+  UINT16  Common;
+  UINT32  Ncfgr;
+
+  //
+  // The link bit latches low; the second read is the current state. A
+  // link that stayed up cannot have renegotiated.
+  //
+  if (EFI_ERROR (GmacMdioRead (Gmac, MII_BMSR, &Bmsr)) || EFI_ERROR (GmacMdioRead (Gmac, MII_BMSR, &Bmsr)) ||
+      ((Bmsr & (MII_BMSR_LINK | MII_BMSR_ANCOMPLETE)) != (MII_BMSR_LINK | MII_BMSR_ANCOMPLETE)))
+  {
+    if (Gmac->LinkUp) {
+      DEBUG ((DEBUG_INFO, "[GMAC] Link down\n"));
+    }
+
+    Gmac->LinkUp = FALSE;
+    return FALSE;
+  }
+
+  if (Gmac->LinkUp) {
+    return TRUE;
+  }
+
+  if (EFI_ERROR (GmacMdioRead (Gmac, MII_GBCR, &Gbcr)) || EFI_ERROR (GmacMdioRead (Gmac, MII_GBSR, &Gbsr)) ||
+      EFI_ERROR (GmacMdioRead (Gmac, MII_ANAR, &Anar)) || EFI_ERROR (GmacMdioRead (Gmac, MII_ANLPAR, &Anlpar)))
+  {
+    return FALSE;
+  }
+
+  Common = Anar & Anlpar;
+  if (((Gbcr & MII_GBCR_1000FD) != 0) && ((Gbsr & MII_GBSR_1000FD) != 0)) {
+    Gmac->Speed      = 1000;
+    Gmac->FullDuplex = TRUE;
+  } else if ((Common & (MII_AN_100FD | MII_AN_100HD)) != 0) {
+    Gmac->Speed      = 100;
+    Gmac->FullDuplex = (Common & MII_AN_100FD) != 0;
+  } else {
+    Gmac->Speed      = 10;
+    Gmac->FullDuplex = (Common & MII_AN_10FD) != 0;
+  }
+
+  Ncfgr = Gmac->Ncfgr & ~GMAC_NCFGR_LINK_MASK;
+  if (Gmac->Speed == 1000) {
+    Ncfgr |= GMAC_NCFGR_GBE;
+  } else if (Gmac->Speed == 100) {
+    Ncfgr |= GMAC_NCFGR_SPD;
+  }
+
+  if (Gmac->FullDuplex) {
+    Ncfgr |= GMAC_NCFGR_FD;
+  }
+
+  if (Ncfgr != Gmac->Ncfgr) {
+    Gmac->Ncfgr = Ncfgr;
+    PlatformMmioWrite32 (Gmac->Base + GMAC_NCFGR, Ncfgr);
+  }
+
+  DEBUG ((DEBUG_INFO, "[GMAC] Link up, %d Mb/s %a duplex\n", Gmac->Speed, Gmac->FullDuplex ? "full" : "half"));
+  Gmac->LinkUp = TRUE;
+  return TRUE;
+}
+
+VOID
+GmacSetAddress (
+  IN GMAC_DEVICE  *Gmac,
+  IN CONST UINT8  *Address
+  )
+{
+  if (Address != Gmac->MacAddress) {
+    CopyMem (Gmac->MacAddress, Address, GMAC_ADDRESS_SIZE);
+  }
+
+  //
+  // Writing the bottom half disables the match until the top is
+  // written.
+  //
+  PlatformMmioWrite32 (
+    Gmac->Base + GMAC_SA1B,
+    Address[0] | ((UINT32)Address[1] << 8) | ((UINT32)Address[2] << 16) | ((UINT32)Address[3] << 24)
+    );
+  PlatformMmioWrite32 (Gmac->Base + GMAC_SA1T, Address[4] | ((UINT32)Address[5] << 8));
+}
+
+/**
+  Bit of the multicast hash an address selects: bit N of the index is
+  the XOR of address bits N, N + 6, ... N + 42, counting from the least
+  significant bit of the first byte.
+**/
+STATIC
+UINT32
+GmacHashIndex (
+  IN CONST UINT8  *Address
+  )
+{
+  UINT32  Index;
+  UINT32  Bit;
+
+  Index = 0;
+  for (Bit = 0; Bit < GMAC_ADDRESS_SIZE * 8; Bit++) {
+    Index ^= ((Address[Bit / 8] >> (Bit % 8)) & 1) << (Bit % 6);
+  }
+
+  return Index;
+}
+
+VOID
+GmacSetFilter (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       Filter,
+  IN CONST UINT8  (*Multicast)[GMAC_ADDRESS_SIZE],
+  IN UINTN        Count
+  )
+{
+  UINT64  Hash;
+  UINTN   Index;
+
+  Hash = 0;
+  if ((Filter & GMAC_FILTER_ALL_MULTICAST) != 0) {
+    Hash = MAX_UINT64;
+  } else if ((Filter & GMAC_FILTER_MULTICAST) != 0) {
+    for (Index = 0; Index < Count; Index++) {
+      Hash |= LShiftU64 (1, GmacHashIndex (Multicast[Index]));
+    }
+  }
+
+  Gmac->Ncfgr &= ~(GMAC_NCFGR_CAF | GMAC_NCFGR_NBC | GMAC_NCFGR_MTIHEN);
+  if ((Filter & GMAC_FILTER_PROMISCUOUS) != 0) {
+    Gmac->Ncfgr |= GMAC_NCFGR_CAF;
+  }
+
+  if ((Filter & GMAC_FILTER_BROADCAST) == 0) {
+    Gmac->Ncfgr |= GMAC_NCFGR_NBC;
+  }
+
+  if (Hash != 0) {
+    Gmac->Ncfgr |= GMAC_NCFGR_MTIHEN;
+  }
+
+  PlatformMmioWrite32 (Gmac->Base + GMAC_HRB, (UINT32)Hash);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_HRT, (UINT32)RShiftU64 (Hash, 32));
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCFGR, Gmac->Ncfgr);
+}
+
+EFI_STATUS
+GmacTransmit (
+  IN GMAC_DEVICE          *Gmac,
+  IN CONST GMAC_FRAGMENT  *Fragments,
+  IN UINTN                Count,
+  IN VOID                 *Token
+  )
+{
+  UINT32           Descriptors;
+  UINT32           Length;
+  UINT32           Used;
+  UINT32           First;
+  UINT32           Index;
+  UINT32           Remaining;
+  UINTN            Fragment;
+  UINT64           Address;
+  GMAC_DESCRIPTOR  *Descriptor;
+
+  Descriptors = 0;
+  Length      = 0;
+  for (Fragment = 0; Fragment < Count; Fragment++) {
+    if (Fragments[Fragment].Length != 0) {
+      Descriptors++;
+      Length += Fragments[Fragment].Length;
+      if (Length > GMAC_MAX_FRAME) {
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  if ((Descriptors == 0) || (Descriptors > GMAC_MAX_FRAGMENTS)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // One descriptor stays free so that the MAC always stops on a used
+  // one after the last frame.
+  //
+  Used = (Gmac->TxHead + GMAC_TX_DESCRIPTORS - Gmac->TxTail) % GMAC_TX_DESCRIPTORS;
+  if (Descriptors > GMAC_TX_DESCRIPTORS - 1 - Used) {
+    return EFI_NOT_READY;
+  }
+
+  First     = Gmac->TxHead;
+  Index     = First;
+  Remaining = Descriptors;
+  for (Fragment = 0; Fragment < Count; Fragment++) {
+    if (Fragments[Fragment].Length == 0) {
+      continue;
+    }
+
+    WriteBackDataCacheRange (Fragments[Fragment].Data, Fragments[Fragment].Length);
+    Address                 = GmacDmaAddress (Gmac, Fragments[Fragment].Data);
+    Descriptor              = &Gmac->TxRing[Index];
+    Descriptor->Address     = (UINT32)Address;
+    Descriptor->AddressHigh = (UINT32)RShiftU64 (Address, 32);
+    Descriptor->Control     = Fragments[Fragment].Length;
+    if (Index == GMAC_TX_DESCRIPTORS - 1) {
+      Descriptor->Control |= GMAC_TX_WRAP;
+    }
+
+    if (--Remaining == 0) {
+      Descriptor->Control |= GMAC_TX_LAST;
+    }
+
+    if (Index == First) {
+      Descriptor->Control |= GMAC_TX_USED;
+    }
+
+    Index = (Index + 1) % GMAC_TX_DESCRIPTORS;
+  }
+
+  //
+  // The first descriptor is handed over last, so the MAC never starts
+  // on a frame that is not all in memory.
+  //
+  GmacCleanTx (Gmac, First, Descriptors);
+  Gmac->TxRing[First].Control &= ~GMAC_TX_USED;
+  GmacCleanTx (Gmac, First, 1);
+
+  Gmac->TxFrames[First].Token       = Token;
+  Gmac->TxFrames[First].Descriptors = Descriptors;
+  Gmac->TxHead                      = Index;
+  Gmac->TxPending++;
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr | GMAC_NCR_TSTART);
+  return EFI_SUCCESS;
+}
+
+/**
+  Stop transmit after an error and treat every frame in flight as sent.
+  The MAC restarts at the start of the ring, so the frames are moved to
+  its end, one descriptor each, for GmacReclaim to hand back.
+**/
+STATIC
+VOID
+GmacTxRecover (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       Tsr
+  )
+{
+  VOID    *Tokens[GMAC_TX_DESCRIPTORS];
+  UINT32  Count;
+  UINT32  Index;
+
+  DEBUG ((DEBUG_WARN, "[GMAC] Transmit error, status 0x%x, %d frames dropped\n", Tsr, Gmac->TxPending));
+  Gmac->TxErrors++;
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr & ~GMAC_NCR_TE);
+  PlatformWaitMmio32 (Gmac->Base + GMAC_TSR, GMAC_TSR_TGO, 0, GMAC_TX_STOP_TIMEOUT, NULL);
+  PlatformMmioWrite32 (Gmac->Base + GMAC_TSR, GMAC_TSR_ALL);
+
+  Count = 0;
+  for (Index = Gmac->TxTail; Count < Gmac->TxPending; Index = (Index + Gmac->TxFrames[Index].Descriptors) % GMAC_TX_DESCRIPTORS) {
+    Tokens[Count++] = Gmac->TxFrames[Index].Token;
+  }
+
+  ZeroMem (Gmac->TxFrames, GMAC_TX_DESCRIPTORS * sizeof (GMAC_TX_FRAME));
+  for (Index = 0; Index < GMAC_TX_DESCRIPTORS; Index++) {
+    Gmac->TxRing[Index].Control = GMAC_TX_USED;
+  }
+
+  Gmac->TxRing[GMAC_TX_DESCRIPTORS - 1].Control |= GMAC_TX_WRAP;
+  WriteBackDataCacheRange (Gmac->TxRing, GMAC_TX_DESCRIPTORS * sizeof (GMAC_DESCRIPTOR));
+
+  for (Index = 0; Index < Count; Index++) {
+    Gmac->TxFrames[GMAC_TX_DESCRIPTORS - Count + Index].Token       = Tokens[Index];
+    Gmac->TxFrames[GMAC_TX_DESCRIPTORS - Count + Index].Descriptors = 1;
+  }
+
+  Gmac->TxTail     = (GMAC_TX_DESCRIPTORS - Count) % GMAC_TX_DESCRIPTORS;
+  Gmac->TxHead     = 0;
+  Gmac->TxHardware = 0;
+  PlatformMmioWrite32 (Gmac->Base + GMAC_TBQP, (UINT32)GmacDmaAddress (Gmac, Gmac->TxRing));
+  PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr);
+}
+
+/**
+  @return Descriptors from the oldest frame in flight to the one the
+          MAC is at.
+**/
+STATIC
+UINT32
+GmacTxDone (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  return (Gmac->TxHardware + GMAC_TX_DESCRIPTORS - Gmac->TxTail) % GMAC_TX_DESCRIPTORS;
+}
+
+VOID *
+GmacReclaim (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  GMAC_TX_FRAME  *Frame;
+  UINT32         Previous;
+  UINT32         Offset;
+  UINT32         Tsr;
+  UINT32         Index;
+  VOID           *Token;
+
+  if (Gmac->TxPending == 0) {
+    return NULL;
+  }
+
+  Frame = &Gmac->TxFrames[Gmac->TxTail];
+  if (GmacTxDone (Gmac) < Frame->Descriptors) {
+    Previous = Gmac->TxHardware;
+    Offset   = PlatformMmioRead32 (Gmac->Base + GMAC_TBQP) - (UINT32)GmacDmaAddress (Gmac, Gmac->TxRing);
+    if (Offset / sizeof (GMAC_DESCRIPTOR) < GMAC_TX_DESCRIPTORS) {
+      Gmac->TxHardware = Offset / sizeof (GMAC_DESCRIPTOR);
+    }
+
+    //
+    // The MAC reads a frame only once it is all in memory, so it is at
+    // the tail, inside the frames in flight, or at the head once idle.
+    //
+    if (GmacTxDone (Gmac) > (Gmac->TxHead + GMAC_TX_DESCRIPTORS - Gmac->TxTail) % GMAC_TX_DESCRIPTORS) {
+      Gmac->TxHardware = Previous;
+    }
+
+    if (GmacTxDone (Gmac) < Frame->Descriptors) {
+      //
+      // No progress since the last look: the MAC has stopped on an
+      // error, or went idle before it saw the last TSTART.
+      //
+      if (Gmac->TxHardware == Previous) {
+        Tsr = PlatformMmioRead32 (Gmac->Base + GMAC_TSR);
+        if ((Tsr & GMAC_TSR_ERRORS) != 0) {
+          GmacTxRecover (Gmac, Tsr);
+          Frame = &Gmac->TxFrames[Gmac->TxTail];
+        } else if ((Tsr & GMAC_TSR_TGO) == 0) {
+          PlatformMmioWrite32 (Gmac->Base + GMAC_NCR, Gmac->Ncr | GMAC_NCR_TSTART);
+        }
+      }
+
+      if (GmacTxDone (Gmac) < Frame->Descriptors) {
+        return NULL;
+      }
+    }
+  }
+
+  //
+  // Give the descriptors back to the CPU; the MAC has passed them.
+  //
+  for (Index = 0; Index < Frame->Descriptors; Index++) {
+    Gmac->TxRing[(Gmac->TxTail + Index) % GMAC_TX_DESCRIPTORS].Control = GMAC_TX_USED;
+  }
+
+  Gmac->TxRing[GMAC_TX_DESCRIPTORS - 1].Control |= GMAC_TX_WRAP;
+  GmacCleanTx (Gmac, Gmac->TxTail, Frame->Descriptors);
+
+  Token        = Frame->Token;
+  Gmac->TxTail = (Gmac->TxTail + Frame->Descriptors) % GMAC_TX_DESCRIPTORS;
+  Gmac->TxPending--;
+  Frame->Token       = NULL;
+  Frame->Descriptors = 0;
+  return Token;
+}
+
+/**
+  Move past the current receive descriptor. When that completes a cache
+  line, the line goes back to the MAC in one write.
+**/
+STATIC
+VOID
+GmacRxRelease (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  UINT32  First;
+  UINT32  Index;
+
+  Gmac->RxNext = (Gmac->RxNext + 1) % GMAC_RX_DESCRIPTORS;
+  if ((Gmac->RxNext % GMAC_DESCRIPTORS_PER_LINE) != 0) {
+    return;
+  }
+
+  First = (Gmac->RxNext + GMAC_RX_DESCRIPTORS - GMAC_DESCRIPTORS_PER_LINE) % GMAC_RX_DESCRIPTORS;
+  for (Index = First; Index < First + GMAC_DESCRIPTORS_PER_LINE; Index++) {
+    Gmac->RxRing[Index].Address &= ~GMAC_RX_USED;
+    Gmac->RxRing[Index].Control  = 0;
+  }
+
+  WriteBackDataCacheRange (&Gmac->RxRing[First], GMAC_CACHE_LINE_SIZE);
+}
+
+/**
+  @return The current receive descriptor, fresh from memory.
+**/
+STATIC
+GMAC_DESCRIPTOR *
+GmacRxDescriptor (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  GMAC_DESCRIPTOR  *Descriptor;
+
+  Descriptor = &Gmac->RxRing[Gmac->RxNext];
+  InvalidateDataCacheRange (
+    Descriptor - (Gmac->RxNext % GMAC_DESCRIPTORS_PER_LINE),
+    GMAC_CACHE_LINE_SIZE
+    );
+  return Descriptor;
+}
+
+EFI_STATUS
+GmacReceive (
+  IN     GMAC_DEVICE  *Gmac,
+  OUT    VOID         *Buffer,
+  IN OUT UINTN        *Size
+  )
+{
+  GMAC_DESCRIPTOR  *Descriptor;
+  UINT32           Control;
+  UINT32           Length;
+  UINT8            *Data;
+
+  for ( ; ;) {
+    Descriptor = GmacRxDescriptor (Gmac);
+    if ((Descriptor->Address & GMAC_RX_USED) == 0) {
+      return EFI_NOT_READY;
+    }
+
+    //
+    // Every frame the MAC accepts fits a buffer; pieces of anything
+    // else are dropped.
+    //
+    Control = Descriptor->Control;
+    if ((Control & (GMAC_RX_SOF | GMAC_RX_EOF)) == (GMAC_RX_SOF | GMAC_RX_EOF)) {
+      break;
+    }
+
+    GmacRxRelease (Gmac);
+  }
+
+  Length = GMAC_RX_LENGTH (Control);
+  if (*Size < Length) {
+    *Size = Length;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  Data = Gmac->RxBuffers + Gmac->RxNext * GMAC_RX_BUFFER_SIZE;
+  InvalidateDataCacheRange (Data, Length);
+  CopyMem (Buffer, Data, Length);
+  *Size = Length;
+  GmacRxRelease (Gmac);
+  return EFI_SUCCESS;
+}
+
+BOOLEAN
+GmacRxPending (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  return (GmacRxDescriptor (Gmac)->Address & GMAC_RX_USED) != 0;
+}
@@ -0,0 +1,390 @@
+/** @file
+  Ethernet MAC engine of GmacDxe
+
+  The RP1 Ethernet block is a Cadence GEM driving an RGMII PHY. This
+  header holds its registers, DMA descriptors, the clause 22 PHY
+  registers and the state of the descriptor rings, shared by the
+  engine (Gmac.c) and the Simple Network glue. The engine only uses
+  PlatformMmioLib, PlatformWaitLib and base libraries, so
+  Host/GmacLoopbackTest.c builds it unchanged against a software MAC.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef GMAC_H_
+#define GMAC_H_
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+
+//
+// MAC registers
+//
+#define GMAC_NCR                  0x000   // network control
+#define GMAC_NCFGR                0x004   // network configuration
+#define GMAC_NSR                  0x008   // network status
+#define GMAC_DMACFG               0x010
+#define GMAC_TSR                  0x014   // transmit status; write 1 to clear
+#define GMAC_RBQP                 0x018   // receive ring, low 32 bits
+#define GMAC_TBQP                 0x01C   // transmit ring, low 32 bits; reads the descriptor in use
+#define GMAC_RSR                  0x020   // receive status; write 1 to clear
+#define GMAC_ISR                  0x024
+#define GMAC_IDR                  0x02C
+#define GMAC_MAN                  0x034   // PHY maintenance
+#define GMAC_HRB                  0x080   // multicast hash, bits 31:0
+#define GMAC_HRT                  0x084   // multicast hash, bits 63:32
+#define GMAC_SA1B                 0x088   // station address, bytes 0-3
+#define GMAC_SA1T                 0x08C   // station address, bytes 4-5
+#define GMAC_MID                  0x0FC
+#define GMAC_DCFG6                0x294
+#define GMAC_TBQPH                0x4C8   // transmit ring, high 32 bits
+#define GMAC_RBQPH                0x4D4   // receive ring, high 32 bits
+
+#define GMAC_NCR_RE               BIT2
+#define GMAC_NCR_TE               BIT3
+#define GMAC_NCR_MPE              BIT4    // MDIO enable
+#define GMAC_NCR_CLRSTAT          BIT5
+#define GMAC_NCR_TSTART           BIT9
+
+#define GMAC_NCFGR_SPD            BIT0    // 100 Mb/s
+#define GMAC_NCFGR_FD             BIT1
+#define GMAC_NCFGR_CAF            BIT4    // copy all frames
+#define GMAC_NCFGR_NBC            BIT5    // no broadcast
+#define GMAC_NCFGR_MTIHEN         BIT6    // multicast hash
+#define GMAC_NCFGR_GBE            BIT10   // 1000 Mb/s
+#define GMAC_NCFGR_RFCS           BIT17   // strip the FCS
+#define GMAC_NCFGR_CLK_DIV96      (5 << 18)   // MDC under 2.5 MHz
+#define GMAC_NCFGR_DBW64          (1 << 21)
+#define GMAC_NCFGR_LINK_MASK      (GMAC_NCFGR_SPD | GMAC_NCFGR_FD | GMAC_NCFGR_GBE)
+
+#define GMAC_NSR_IDLE             BIT2    // MDIO idle
+
+#define GMAC_DMACFG_INCR16        0x10
+#define GMAC_DMACFG_RXBMS_FULL    (3 << 8)
+#define GMAC_DMACFG_TXPBMS        BIT10
+#define GMAC_DMACFG_RXBS(Size)    (((Size) / 64) << 16)
+#define GMAC_DMACFG_ADDR64        BIT30
+
+#define GMAC_TSR_TGO              BIT3
+#define GMAC_TSR_ERRORS           (BIT2 | BIT4 | BIT6)   // retry limit, AHB error, underrun
+#define GMAC_TSR_ALL              0x1FF
+#define GMAC_RSR_ALL              0x0F
+#define GMAC_INT_ALL              0xFFFFFFFF
+
+#define GMAC_MAN_READ(Phy, Reg)   (BIT30 | (2 << 28) | ((UINT32)(Phy) << 23) | ((UINT32)(Reg) << 18) | (2 << 16))
+#define GMAC_MAN_WRITE(Phy, Reg)  (BIT30 | (1 << 28) | ((UINT32)(Phy) << 23) | ((UINT32)(Reg) << 18) | (2 << 16))
+#define GMAC_MAN_DATA             0xFFFF
+
+#define GMAC_DCFG6_DAW64          BIT23   // 64-bit DMA addressing present
+
+//
+// DMA descriptor for 64-bit addressing. The MAC reads the rings from
+// memory it does not snoop, so both are kept cacheable and maintained
+// by line (GMAC_DESCRIPTORS_PER_LINE descriptors):
+//  - receive descriptors are handed back a whole line at a time, once
+//    every descriptor of the line has been consumed, so the CPU never
+//    writes a line the MAC may be filling;
+//  - the MAC's write-back to a transmitted frame may be lost when the
+//    CPU cleans a neighbouring descriptor, so transmit completion is
+//    taken from GMAC_TBQP, never from the descriptors.
+//
+typedef struct {
+  UINT32    Address;                  // bits 31:2 of the buffer, receive ownership and wrap
+  UINT32    Control;
+  UINT32    AddressHigh;
+  UINT32    Reserved;
+} GMAC_DESCRIPTOR;
+
+#define GMAC_RX_USED              BIT0    // frame received; the CPU owns the descriptor
+#define GMAC_RX_WRAP              BIT1
+#define GMAC_RX_LENGTH(Control)   ((Control) & 0x1FFF)
+#define GMAC_RX_SOF               BIT14
+#define GMAC_RX_EOF               BIT15
+
+#define GMAC_TX_LENGTH_MAX        0x3FFF
+#define GMAC_TX_LAST              BIT15
+#define GMAC_TX_WRAP              BIT30
+#define GMAC_TX_USED              BIT31   // the MAC stops here
+
+#define GMAC_CACHE_LINE_SIZE      64
+#define GMAC_DESCRIPTORS_PER_LINE (GMAC_CACHE_LINE_SIZE / sizeof (GMAC_DESCRIPTOR))
+
+//
+// Ring sizes. 1024 receive buffers hold 12 ms of full-size frames at
+// 1 Gb/s, more than the upper layers leave between polls.
+//
+#define GMAC_RX_DESCRIPTORS       1024
+#define GMAC_TX_DESCRIPTORS       256
+#define GMAC_RX_BUFFER_SIZE       1536
+#define GMAC_MAX_FRAGMENTS        8
+
+//
+// Frames, without the FCS the MAC adds and strips
+//
+#define GMAC_ADDRESS_SIZE         6
+#define GMAC_HEADER_SIZE          14
+#define GMAC_MIN_FRAME            60
+#define GMAC_MAX_FRAME            1514
+
+//
+// One allocation holds, in order: the receive ring, the transmit ring,
+// the receive buffers and the CPU-only record of each transmit frame.
+// It is aligned to 64 KB so that neither ring crosses a 4 GB boundary,
+// which the single high-address register of each ring cannot express.
+//
+typedef struct {
+  VOID      *Token;                   // caller's handle, returned by GmacReclaim
+  UINT32    Descriptors;              // descriptors of the frame starting here
+} GMAC_TX_FRAME;
+
+#define GMAC_RX_RING_OFFSET       0
+#define GMAC_TX_RING_OFFSET       (GMAC_RX_RING_OFFSET + GMAC_RX_DESCRIPTORS * sizeof (GMAC_DESCRIPTOR))
+#define GMAC_RX_BUFFER_OFFSET     (GMAC_TX_RING_OFFSET + GMAC_TX_DESCRIPTORS * sizeof (GMAC_DESCRIPTOR))
+#define GMAC_TX_FRAME_OFFSET      (GMAC_RX_BUFFER_OFFSET + GMAC_RX_DESCRIPTORS * GMAC_RX_BUFFER_SIZE)
+#define GMAC_DMA_SIZE             (GMAC_TX_FRAME_OFFSET + GMAC_TX_DESCRIPTORS * sizeof (GMAC_TX_FRAME))
+#define GMAC_DMA_ALIGNMENT        SIZE_64KB
+
+//
+// Timeouts in microseconds
+//
+#define GMAC_MDIO_TIMEOUT         1000
+#define GMAC_PHY_RESET_TIMEOUT    500000
+#define GMAC_TX_STOP_TIMEOUT      10000
+
+//
+// Clause 22 PHY registers
+//
+#define MII_BMCR                  0x00
+#define MII_BMSR                  0x01
+#define MII_PHYID1                0x02
+#define MII_PHYID2                0x03
+#define MII_ANAR                  0x04
+#define MII_ANLPAR                0x05
+#define MII_GBCR                  0x09    // 1000BASE-T control
+#define MII_GBSR                  0x0A    // 1000BASE-T status
+
+#define MII_BMCR_RESET            BIT15
+#define MII_BMCR_ANENABLE         BIT12
+#define MII_BMCR_ANRESTART        BIT9
+#define MII_BMSR_LINK             BIT2    // latched low
+#define MII_BMSR_ANCOMPLETE       BIT5
+#define MII_AN_SELECTOR           0x0001
+#define MII_AN_10HD               BIT5
+#define MII_AN_10FD               BIT6
+#define MII_AN_100HD              BIT7
+#define MII_AN_100FD              BIT8
+#define MII_AN_ALL                (MII_AN_10HD | MII_AN_10FD | MII_AN_100HD | MII_AN_100FD)
+#define MII_GBCR_1000FD           BIT9
+#define MII_GBSR_1000FD           BIT11   // partner, MII_GBCR_1000FD << 2
+
+//
+// Receive filter of GmacSetFilter. Frames to the station address are
+// always received.
+//
+#define GMAC_FILTER_BROADCAST     BIT0
+#define GMAC_FILTER_MULTICAST     BIT1    // the addresses given
+#define GMAC_FILTER_ALL_MULTICAST BIT2
+#define GMAC_FILTER_PROMISCUOUS   BIT3
+
+//
+// One piece of a frame to transmit. Length 0 pieces are skipped.
+//
+typedef struct {
+  VOID      *Data;
+  UINT32    Length;
+} GMAC_FRAGMENT;
+
+typedef struct {
+  //
+  // Set by the caller before GmacInit
+  //
+  UINTN            Base;
+  UINT8            PhyAddress;
+  UINT64           DmaOffset;           // bus address of CPU address 0
+
+  //
+  // Rings, allocated by the first GmacInit
+  //
+  UINT8            *Dma;
+  GMAC_DESCRIPTOR  *RxRing;
+  GMAC_DESCRIPTOR  *TxRing;
+  UINT8            *RxBuffers;
+  GMAC_TX_FRAME    *TxFrames;
+  UINT32           RxNext;              // next descriptor to receive from
+  UINT32           TxHead;              // next free descriptor
+  UINT32           TxTail;              // first descriptor of the oldest frame in flight
+  UINT32           TxPending;           // frames in flight
+  UINT32           TxHardware;          // descriptor GMAC_TBQP last read
+  UINT32           Ncr;                 // GMAC_NCR as last written
+  UINT32           Ncfgr;
+
+  //
+  // Station and link
+  //
+  UINT8            MacAddress[GMAC_ADDRESS_SIZE];
+  BOOLEAN          LinkUp;
+  UINT32           Speed;               // Mb/s
+  BOOLEAN          FullDuplex;
+  UINT64           TxErrors;
+} GMAC_DEVICE;
+
+/**
+  Quiesce the MAC and set it up with empty rings, receive and transmit
+  off. Allocates the rings on first use.
+
+  @param  Gmac          MAC with Base, PhyAddress, DmaOffset and
+                        MacAddress set.
+
+  @retval EFI_SUCCESS           The MAC is set up.
+  @retval EFI_UNSUPPORTED       The MAC has no 64-bit DMA addressing.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the rings.
+**/
+EFI_STATUS
+GmacInit (
+  IN OUT GMAC_DEVICE  *Gmac
+  );
+
+/**
+  Start or stop receive and transmit. Stopping drops the frames received
+  but not yet taken and ends the frames in flight, which GmacReclaim
+  then returns whether sent or not; GmacInit is needed before starting
+  again.
+
+  @param  Gmac          MAC.
+  @param  Enable        TRUE to start.
+**/
+VOID
+GmacEnable (
+  IN GMAC_DEVICE  *Gmac,
+  IN BOOLEAN      Enable
+  );
+
+/**
+  Reset the PHY and start auto-negotiation of every speed it supports.
+
+  @param  Gmac          MAC.
+
+  @retval EFI_SUCCESS       Auto-negotiation started.
+  @retval EFI_NOT_FOUND     No PHY answers at Gmac->PhyAddress.
+  @retval EFI_TIMEOUT       The PHY or MDIO did not respond.
+**/
+EFI_STATUS
+GmacPhyInit (
+  IN GMAC_DEVICE  *Gmac
+  );
+
+/**
+  Read the link state from the PHY and set the MAC to the negotiated
+  speed and duplex.
+
+  @param  Gmac          MAC.
+
+  @return Gmac->LinkUp.
+**/
+BOOLEAN
+GmacUpdateLink (
+  IN GMAC_DEVICE  *Gmac
+  );
+
+/**
+  Program the station address.
+
+  @param  Gmac          MAC.
+  @param  Address       New station address.
+**/
+VOID
+GmacSetAddress (
+  IN GMAC_DEVICE  *Gmac,
+  IN CONST UINT8  *Address
+  );
+
+/**
+  Program the receive filter.
+
+  @param  Gmac          MAC.
+  @param  Filter        GMAC_FILTER_* bits.
+  @param  Multicast     Addresses for GMAC_FILTER_MULTICAST.
+  @param  Count         Number of Multicast addresses.
+**/
+VOID
+GmacSetFilter (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       Filter,
+  IN CONST UINT8  (*Multicast)[GMAC_ADDRESS_SIZE],
+  IN UINTN        Count
+  );
+
+/**
+  Queue a frame, gathered by the MAC straight from the fragments. The
+  fragments must stay untouched until GmacReclaim returns Token.
+
+  @param  Gmac          MAC.
+  @param  Fragments     Pieces of the frame, in order.
+  @param  Count         Number of Fragments.
+  @param  Token         Returned by GmacReclaim once the frame is sent.
+
+  @retval EFI_SUCCESS            The frame is queued.
+  @retval EFI_NOT_READY          The transmit ring is full.
+  @retval EFI_INVALID_PARAMETER  The frame is empty, too long or has
+                                 too many fragments.
+**/
+EFI_STATUS
+GmacTransmit (
+  IN GMAC_DEVICE          *Gmac,
+  IN CONST GMAC_FRAGMENT  *Fragments,
+  IN UINTN                Count,
+  IN VOID                 *Token
+  );
+
+/**
+  Retire the oldest transmitted frame.
+
+  @param  Gmac          MAC.
+
+  @return Token of the frame, or NULL if none has completed.
+**/
+VOID *
+GmacReclaim (
+  IN GMAC_DEVICE  *Gmac
+  );
+
+/**
+  Take the next received frame, copied once from its receive buffer
+  into Buffer.
+
+  @param  Gmac          MAC.
+  @param  Buffer        Where to copy the frame.
+  @param  Size          On input the size of Buffer, on output the size
+                        of the frame.
+
+  @retval EFI_SUCCESS           The frame is in Buffer.
+  @retval EFI_NOT_READY         No frame has been received.
+  @retval EFI_BUFFER_TOO_SMALL  Buffer is too small; the frame is kept.
+**/
+EFI_STATUS
+GmacReceive (
+  IN     GMAC_DEVICE  *Gmac,
+  OUT    VOID         *Buffer,
+  IN OUT UINTN        *Size
+  );
+
+/**
+  @param  Gmac          MAC.
+
+  @retval TRUE          GmacReceive has a frame to return.
+**/
+BOOLEAN
+GmacRxPending (
+  IN GMAC_DEVICE  *Gmac
+  );
+
+#endif
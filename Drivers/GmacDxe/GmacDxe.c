@@ -0,0 +1,265 @@
+/** @file
+  Ethernet driver for Raspberry Pi 5 D-step
+
+  The RP1 Ethernet MAC is brought out of reset once at load and
+  published as Simple Network; the MAC and PHY are only started when the
+  network stack initializes the interface. The station address comes
+  from the VideoCore firmware.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "GmacDxe.h"
+
+STATIC CONST EFI_GUID  mVideoCorePropertiesGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+
+STATIC CONST GMAC_DEVICE_PATH  mGmacDevicePathTemplate = {
+  {
+    {
+      HARDWARE_DEVICE_PATH,
+      HW_VENDOR_DP,
+      { (UINT8)sizeof (VENDOR_DEVICE_PATH), (UINT8)(sizeof (VENDOR_DEVICE_PATH) >> 8) }
+    },
+    GMAC_DEVICE_PATH_GUID
+  },
+  {
+    {
+      MESSAGING_DEVICE_PATH,
+      MSG_MAC_ADDR_DP,
+      { (UINT8)sizeof (MAC_ADDR_DEVICE_PATH), (UINT8)(sizeof (MAC_ADDR_DEVICE_PATH) >> 8) }
+    },
+    { { 0 } },
+    GMAC_IFTYPE_ETHERNET
+  },
+  {
+    END_DEVICE_PATH_TYPE,
+    END_ENTIRE_DEVICE_PATH_SUBTYPE,
+    { (UINT8)sizeof (EFI_DEVICE_PATH_PROTOCOL), 0 }
+  }
+};
+
+/**
+  Station address from the VideoCore firmware. Without one, a locally
+  administered address is made from the board serial number.
+
+  @param  Address       Receives the address.
+**/
+STATIC
+VOID
+GmacGetMacAddress (
+  OUT UINT8  *Address
+  )
+{
+  VOID                  *Hob;
+  VIDEOCORE_PROPERTIES  *Properties;
+  UINT64                Serial;
+  UINTN                 Index;
+
+  Serial = 0;
+  Hob    = GetFirstGuidHob (&mVideoCorePropertiesGuid);
+  if (Hob != NULL) {
+    Properties = GET_GUID_HOB_DATA (Hob);
+    if ((Properties->MacAddress[0] & 0x01) == 0) {
+      for (Index = 0; Index < GMAC_ADDRESS_SIZE; Index++) {
+        if (Properties->MacAddress[Index] != 0) {
+          CopyMem (Address, Properties->MacAddress, GMAC_ADDRESS_SIZE);
+          return;
+        }
+      }
+    }
+
+    Serial = Properties->BoardSerial;
+  }
+
+  DEBUG ((DEBUG_WARN, "[GMAC] No MAC address from the firmware\n"));
+  Address[0] = 0x02;
+  Address[1] = 0x00;
+  for (Index = 2; Index < GMAC_ADDRESS_SIZE; Index++) {
+    Address[Index] = (UINT8)RShiftU64 (Serial, (UINTN)(GMAC_ADDRESS_SIZE - 1 - Index) * 8);
+  }
+}
+
+/**
+  Follow the PHY link while the interface is initialized.
+
+  @param  Event         Periodic timer.
+  @param  Context       Driver private data.
+**/
+STATIC
+VOID
+EFIAPI
+GmacLinkPoll (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  if (Private->Mode.State == EfiSimpleNetworkInitialized) {
+    GmacSnpUpdateLink (Private);
+  }
+}
+
+/**
+  Stop the MAC so that it no longer writes to memory the OS owns.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Driver private data.
+**/
+STATIC
+VOID
+EFIAPI
+GmacExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  if (Private->Mode.State == EfiSimpleNetworkInitialized) {
+    GmacEnable (&Private->Gmac, FALSE);
+  }
+}
+
+/**
+  Entry point of the Ethernet driver.
+
+  @param  ImageHandle   EFI_HANDLE.
+  @param  SystemTable   EFI_SYSTEM_TABLE.
+
+  @retval EFI_SUCCESS   Driver initialized successfully.
+  @retval others        RP1 or the MAC could not be set up.
+**/
+EFI_STATUS
+EFIAPI
+GmacDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS         Status;
+  GMAC_PRIVATE_DATA  *Private;
+
+  Private = AllocateZeroPool (sizeof (GMAC_PRIVATE_DATA));
+  if (Private == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gBS->LocateProtocol (&gRp1ProtocolGuid, NULL, (VOID **)&Private->Rp1);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] RP1 protocol not found: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
+  if (Private->Rp1->BlockBase[Rp1BlockGmac] == 0) {
+    FreePool (Private);
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = Private->Rp1->EnableClock (Private->Rp1, Rp1BlockGmac);
+  if (!EFI_ERROR (Status)) {
+    Status = Private->Rp1->Reset (Private->Rp1, Rp1BlockGmac);
+    if (EFI_ERROR (Status)) {
+      Private->Rp1->DisableClock (Private->Rp1, Rp1BlockGmac);
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] Clock enable failed: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
+  Private->Signature       = GMAC_PRIVATE_SIGNATURE;
+  Private->Gmac.Base       = (UINTN)Private->Rp1->BlockBase[Rp1BlockGmac];
+  Private->Gmac.PhyAddress = GMAC_PHY_ADDRESS;
+  Private->Gmac.DmaOffset  = RPI5D_PCIE_DMA_OFFSET;
+  GmacGetMacAddress (Private->Gmac.MacAddress);
+
+  CopyMem (&Private->DevicePath, &mGmacDevicePathTemplate, sizeof (GMAC_DEVICE_PATH));
+  CopyMem (&Private->DevicePath.Mac.MacAddress, Private->Gmac.MacAddress, GMAC_ADDRESS_SIZE);
+
+  //
+  // Allocate the rings now, with the MAC quiet, so that a failure is
+  // found at load rather than by the network stack.
+  //
+  Status = GmacInit (&Private->Gmac);
+  if (!EFI_ERROR (Status)) {
+    Status = GmacSnpInit (Private);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    GMAC_TPL,
+                    GmacLinkPoll,
+                    Private,
+                    &Private->LinkEvent
+                    );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (Private->LinkEvent, TimerPeriodic, GMAC_LINK_POLL_PERIOD);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (
+                    EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                    TPL_CALLBACK,
+                    GmacExitBootServices,
+                    Private,
+                    &Private->ExitBootServicesEvent
+                    );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Private->Handle,
+                    &gEfiSimpleNetworkProtocolGuid, &Private->Snp,
+                    &gEfiDevicePathProtocolGuid, &Private->DevicePath,
+                    NULL
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] Driver setup failed: %r\n", Status));
+    if (Private->ExitBootServicesEvent != NULL) {
+      gBS->CloseEvent (Private->ExitBootServicesEvent);
+    }
+
+    if (Private->LinkEvent != NULL) {
+      gBS->CloseEvent (Private->LinkEvent);
+    }
+
+    if (Private->Snp.WaitForPacket != NULL) {
+      gBS->CloseEvent (Private->Snp.WaitForPacket);
+    }
+
+    if (Private->Gmac.Dma != NULL) {
+      FreeAlignedPages (Private->Gmac.Dma, EFI_SIZE_TO_PAGES (GMAC_DMA_SIZE));
+    }
+
+    Private->Rp1->DisableClock (Private->Rp1, Rp1BlockGmac);
+    FreePool (Private);
+    return Status;
+  }
+
+  gBS->ConnectController (Private->Handle, NULL, NULL, TRUE);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "[GMAC] Driver loaded, MAC %02x:%02x:%02x:%02x:%02x:%02x\n",
+    Private->Gmac.MacAddress[0],
+    Private->Gmac.MacAddress[1],
+    Private->Gmac.MacAddress[2],
+    Private->Gmac.MacAddress[3],
+    Private->Gmac.MacAddress[4],
+    Private->Gmac.MacAddress[5]
+    ));
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/** @file
+  Ethernet driver for Raspberry Pi 5 D-step
+
+  Drives the RP1 Ethernet MAC and publishes Simple Network on it for the
+  network stack and network boot.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef GMAC_DXE_H_
+#define GMAC_DXE_H_
+
+#include "Gmac.h"
+#include <Library/DevicePathLib.h>
+#include <Library/HobLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/DevicePath.h>
+#include <Protocol/SimpleNetwork.h>
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Platform/RPi5D.h"
+#include "../../Include/Protocol/Rp1.h"
+
+//
+// Simple Network calls are serialized at this TPL.
+//
+#define GMAC_TPL                    TPL_CALLBACK
+
+//
+// PHY on the MDIO bus of the MAC, and how often its link is polled, in
+// 100 ns units.
+//
+#define GMAC_PHY_ADDRESS            1
+#define GMAC_LINK_POLL_PERIOD       10000000
+
+//
+// Multicast addresses a receive filter may hold.
+//
+#define GMAC_MAX_MCAST_FILTERS      16
+
+//
+// ARP hardware type of Ethernet, for the mode and device path
+//
+#define GMAC_IFTYPE_ETHERNET        0x01
+
+//
+// Vendor device path node of the controller
+//
+#define GMAC_DEVICE_PATH_GUID \
+  { 0x3b7a4c0e, 0x51d2, 0x4f86, { 0x9a, 0x1d, 0x6e, 0x0b, 0xc4, 0x73, 0x28, 0xf5 } }
+
+#pragma pack(1)
+typedef struct {
+  VENDOR_DEVICE_PATH          Vendor;
+  MAC_ADDR_DEVICE_PATH        Mac;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} GMAC_DEVICE_PATH;
+#pragma pack()
+
+//
+// Driver private data
+//
+typedef struct {
+  UINT32                         Signature;
+  EFI_HANDLE                     Handle;
+  RP1_PROTOCOL                   *Rp1;
+  GMAC_DEVICE                    Gmac;
+  EFI_SIMPLE_NETWORK_PROTOCOL    Snp;
+  EFI_SIMPLE_NETWORK_MODE        Mode;
+  GMAC_DEVICE_PATH               DevicePath;
+  EFI_EVENT                      LinkEvent;
+  EFI_EVENT                      ExitBootServicesEvent;
+
+  //
+  // Transmit buffers sent but not yet returned by GetStatus, oldest
+  // first.
+  //
+  VOID                           *Recycled[GMAC_TX_DESCRIPTORS];
+  UINT32                         RecycledHead;
+  UINT32                         RecycledCount;
+} GMAC_PRIVATE_DATA;
+
+#define GMAC_PRIVATE_SIGNATURE  SIGNATURE_32 ('G', 'M', 'A', 'C')
+#define GMAC_PRIVATE_FROM_SNP(a) \
+  CR (a, GMAC_PRIVATE_DATA, Snp, GMAC_PRIVATE_SIGNATURE)
+
+/**
+  Fill in the Simple Network protocol and its mode for a stopped
+  interface.
+
+  @param  Private       Driver private data with the station address in
+                        Gmac.MacAddress.
+
+  @retval EFI_SUCCESS   Done.
+  @retval others        The WaitForPacket event could not be created.
+**/
+EFI_STATUS
+GmacSnpInit (
+  IN GMAC_PRIVATE_DATA  *Private
+  );
+
+/**
+  Take the link state from the PHY into the mode.
+
+  @param  Private       Driver private data of an initialized interface.
+**/
+VOID
+GmacSnpUpdateLink (
+  IN GMAC_PRIVATE_DATA  *Private
+  );
+
+/**
+  Stop the MAC and queue the buffers it held for GetStatus.
+
+  @param  Private       Driver private data of an initialized interface.
+**/
+VOID
+GmacSnpStop (
+  IN GMAC_PRIVATE_DATA  *Private
+  );
+
+#endif
@@ -0,0 +1,704 @@
+/** @file
+  Simple Network protocol of GmacDxe.
+
+  Transmit hands the caller's buffer to the MAC as is; it comes back
+  through GetStatus once the MAC has sent it. Receive copies the frame
+  once, from the receive ring into the caller's buffer.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "GmacDxe.h"
+
+/**
+  Check that the interface is in the state a call needs.
+
+  @param  Private       Driver private data.
+  @param  State         State needed.
+
+  @retval EFI_SUCCESS       The interface is in State.
+  @retval EFI_NOT_STARTED   The interface is stopped.
+  @retval EFI_DEVICE_ERROR  The interface is in another state.
+**/
+STATIC
+EFI_STATUS
+GmacSnpCheckState (
+  IN GMAC_PRIVATE_DATA         *Private,
+  IN EFI_SIMPLE_NETWORK_STATE  State
+  )
+{
+  if (Private->Mode.State == State) {
+    return EFI_SUCCESS;
+  }
+
+  return (Private->Mode.State == EfiSimpleNetworkStopped) ? EFI_NOT_STARTED : EFI_DEVICE_ERROR;
+}
+
+/**
+  Move the transmit buffers the MAC is done with to the queue of
+  GetStatus.
+
+  @param  Private       Driver private data.
+**/
+STATIC
+VOID
+GmacSnpReclaim (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  VOID  *Buffer;
+
+  for (Buffer = GmacReclaim (&Private->Gmac); Buffer != NULL; Buffer = GmacReclaim (&Private->Gmac)) {
+    Private->Recycled[(Private->RecycledHead + Private->RecycledCount) % GMAC_TX_DESCRIPTORS] = Buffer;
+    Private->RecycledCount++;
+  }
+}
+
+VOID
+GmacSnpStop (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  GmacEnable (&Private->Gmac, FALSE);
+  GmacSnpReclaim (Private);
+}
+
+VOID
+GmacSnpUpdateLink (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  Private->Mode.MediaPresent = GmacUpdateLink (&Private->Gmac);
+}
+
+/**
+  Program the receive filter of the mode into the MAC.
+
+  @param  Private       Driver private data.
+**/
+STATIC
+VOID
+GmacSnpSetFilter (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  UINT32  Setting;
+  UINT32  Filter;
+  UINT8   Multicast[GMAC_MAX_MCAST_FILTERS][GMAC_ADDRESS_SIZE];
+  UINTN   Index;
+
+  Setting = Private->Mode.ReceiveFilterSetting;
+  Filter  = 0;
+  if ((Setting & EFI_SIMPLE_NETWORK_RECEIVE_BROADCAST) != 0) {
+    Filter |= GMAC_FILTER_BROADCAST;
+  }
+
+  if ((Setting & EFI_SIMPLE_NETWORK_RECEIVE_MULTICAST) != 0) {
+    Filter |= GMAC_FILTER_MULTICAST;
+  }
+
+  if ((Setting & EFI_SIMPLE_NETWORK_RECEIVE_PROMISCUOUS_MULTICAST) != 0) {
+    Filter |= GMAC_FILTER_ALL_MULTICAST;
+  }
+
+  if ((Setting & EFI_SIMPLE_NETWORK_RECEIVE_PROMISCUOUS) != 0) {
+    Filter |= GMAC_FILTER_PROMISCUOUS;
+  }
+
+  for (Index = 0; Index < Private->Mode.MCastFilterCount; Index++) {
+    CopyMem (Multicast[Index], &Private->Mode.MCastFilter[Index], GMAC_ADDRESS_SIZE);
+  }
+
+  GmacSetFilter (&Private->Gmac, Filter, (CONST UINT8 (*)[GMAC_ADDRESS_SIZE])Multicast, Private->Mode.MCastFilterCount);
+}
+
+/**
+  Set the MAC up with empty rings and start it.
+
+  @param  Private       Driver private data.
+
+  @retval EFI_SUCCESS       Running.
+  @retval EFI_DEVICE_ERROR  The MAC or PHY failed.
+**/
+STATIC
+EFI_STATUS
+GmacSnpStart (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = GmacInit (&Private->Gmac);
+  if (!EFI_ERROR (Status)) {
+    Status = GmacPhyInit (&Private->Gmac);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[GMAC] Initialize failed: %r\n", Status));
+    return EFI_DEVICE_ERROR;
+  }
+
+  GmacSnpSetFilter (Private);
+  GmacEnable (&Private->Gmac, TRUE);
+  GmacSnpUpdateLink (Private);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpStartInterface (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  if (Private->Mode.State == EfiSimpleNetworkStopped) {
+    Private->Mode.State = EfiSimpleNetworkStarted;
+    Status              = EFI_SUCCESS;
+  } else {
+    Status = EFI_ALREADY_STARTED;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpStopInterface (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkStarted);
+  if (!EFI_ERROR (Status)) {
+    Private->Mode.State = EfiSimpleNetworkStopped;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpInitialize (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN UINTN                        ExtraRxBufferSize OPTIONAL,
+  IN UINTN                        ExtraTxBufferSize OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkStarted);
+  if (!EFI_ERROR (Status)) {
+    Private->RecycledHead  = 0;
+    Private->RecycledCount = 0;
+    Status                 = GmacSnpStart (Private);
+    if (!EFI_ERROR (Status)) {
+      Private->Mode.State = EfiSimpleNetworkInitialized;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpReset (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN BOOLEAN                      ExtendedVerification
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (!EFI_ERROR (Status)) {
+    GmacSnpStop (Private);
+    Status = GmacSnpStart (Private);
+    if (EFI_ERROR (Status)) {
+      Private->Mode.State = EfiSimpleNetworkStarted;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpShutdown (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (!EFI_ERROR (Status)) {
+    GmacSnpStop (Private);
+    Private->Mode.State        = EfiSimpleNetworkStarted;
+    Private->Mode.MediaPresent = FALSE;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpReceiveFilters (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN UINT32                       Enable,
+  IN UINT32                       Disable,
+  IN BOOLEAN                      ResetMCastFilter,
+  IN UINTN                        MCastFilterCnt OPTIONAL,
+  IN EFI_MAC_ADDRESS              *MCastFilter OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA        *Private;
+  EFI_SIMPLE_NETWORK_MODE  *Mode;
+  EFI_TPL                  OldTpl;
+  EFI_STATUS               Status;
+  UINTN                    Index;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  Mode    = &Private->Mode;
+  if ((((Enable | Disable) & ~Mode->ReceiveFilterMask) != 0) ||
+      (!ResetMCastFilter && (MCastFilterCnt != 0) &&
+       ((MCastFilterCnt > Mode->MaxMCastFilterCount) || (MCastFilter == NULL))))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; !ResetMCastFilter && (Index < MCastFilterCnt); Index++) {
+    if ((MCastFilter[Index].Addr[0] & 0x01) == 0) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  OldTpl = gBS->RaiseTPL (GMAC_TPL);
+  Status = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (!EFI_ERROR (Status)) {
+    Mode->ReceiveFilterSetting = (Mode->ReceiveFilterSetting | Enable) & ~Disable;
+    if (ResetMCastFilter) {
+      Mode->MCastFilterCount = 0;
+    } else if (MCastFilterCnt != 0) {
+      CopyMem (Mode->MCastFilter, MCastFilter, MCastFilterCnt * sizeof (EFI_MAC_ADDRESS));
+      Mode->MCastFilterCount = (UINT32)MCastFilterCnt;
+    }
+
+    GmacSnpSetFilter (Private);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpStationAddress (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN BOOLEAN                      Reset,
+  IN EFI_MAC_ADDRESS              *New OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if ((This == NULL) || (!Reset && (New == NULL))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (&Private->Mode.CurrentAddress, Reset ? &Private->Mode.PermanentAddress : New, sizeof (EFI_MAC_ADDRESS));
+    GmacSetAddress (&Private->Gmac, Private->Mode.CurrentAddress.Addr);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpStatistics (
+  IN     EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN     BOOLEAN                      Reset,
+  IN OUT UINTN                        *StatisticsSize OPTIONAL,
+  OUT    EFI_NETWORK_STATISTICS       *StatisticsTable OPTIONAL
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpMCastIpToMac (
+  IN  EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN  BOOLEAN                      IPv6,
+  IN  EFI_IP_ADDRESS               *IP,
+  OUT EFI_MAC_ADDRESS              *MAC
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_STATUS         Status;
+
+  if ((This == NULL) || (IP == NULL) || (MAC == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // RFC 1112: 01:00:5E and the low 23 bits of the group. RFC 2464:
+  // 33:33 and the low 32 bits.
+  //
+  ZeroMem (MAC, sizeof (EFI_MAC_ADDRESS));
+  if (IPv6) {
+    MAC->Addr[0] = 0x33;
+    MAC->Addr[1] = 0x33;
+    CopyMem (&MAC->Addr[2], &IP->v6.Addr[12], 4);
+  } else {
+    if ((IP->v4.Addr[0] & 0xF0) != 0xE0) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    MAC->Addr[0] = 0x01;
+    MAC->Addr[1] = 0x00;
+    MAC->Addr[2] = 0x5E;
+    MAC->Addr[3] = IP->v4.Addr[1] & 0x7F;
+    MAC->Addr[4] = IP->v4.Addr[2];
+    MAC->Addr[5] = IP->v4.Addr[3];
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpNvData (
+  IN     EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN     BOOLEAN                      ReadWrite,
+  IN     UINTN                        Offset,
+  IN     UINTN                        BufferSize,
+  IN OUT VOID                         *Buffer
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpGetStatus (
+  IN  EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  OUT UINT32                       *InterruptStatus OPTIONAL,
+  OUT VOID                         **TxBuf OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (EFI_ERROR (Status)) {
+    gBS->RestoreTPL (OldTpl);
+    return Status;
+  }
+
+  GmacSnpReclaim (Private);
+  if (InterruptStatus != NULL) {
+    *InterruptStatus = 0;
+    if (GmacRxPending (&Private->Gmac)) {
+      *InterruptStatus |= EFI_SIMPLE_NETWORK_RECEIVE_INTERRUPT;
+    }
+
+    if (Private->RecycledCount != 0) {
+      *InterruptStatus |= EFI_SIMPLE_NETWORK_TRANSMIT_INTERRUPT;
+    }
+  }
+
+  if (TxBuf != NULL) {
+    *TxBuf = NULL;
+    if (Private->RecycledCount != 0) {
+      *TxBuf                = Private->Recycled[Private->RecycledHead];
+      Private->RecycledHead = (Private->RecycledHead + 1) % GMAC_TX_DESCRIPTORS;
+      Private->RecycledCount--;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpTransmit (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  IN UINTN                        HeaderSize,
+  IN UINTN                        BufferSize,
+  IN VOID                         *Buffer,
+  IN EFI_MAC_ADDRESS              *SrcAddr OPTIONAL,
+  IN EFI_MAC_ADDRESS              *DestAddr OPTIONAL,
+  IN UINT16                       *Protocol OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+  UINT8              *Frame;
+  GMAC_FRAGMENT      Fragment;
+
+  if ((This == NULL) || (Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  if (HeaderSize != 0) {
+    if ((HeaderSize != Private->Mode.MediaHeaderSize) || (DestAddr == NULL) || (Protocol == NULL)) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  if (BufferSize < Private->Mode.MediaHeaderSize) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  if (BufferSize > Private->Mode.MediaHeaderSize + Private->Mode.MaxPacketSize) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl = gBS->RaiseTPL (GMAC_TPL);
+  Status = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (EFI_ERROR (Status)) {
+    gBS->RestoreTPL (OldTpl);
+    return Status;
+  }
+
+  //
+  // Every buffer sent must fit the GetStatus queue until it is taken.
+  //
+  GmacSnpReclaim (Private);
+  if (Private->RecycledCount + Private->Gmac.TxPending >= GMAC_TX_DESCRIPTORS) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_NOT_READY;
+  }
+
+  if (HeaderSize != 0) {
+    Frame = Buffer;
+    CopyMem (Frame, DestAddr, GMAC_ADDRESS_SIZE);
+    CopyMem (Frame + GMAC_ADDRESS_SIZE, (SrcAddr != NULL) ? SrcAddr : &Private->Mode.CurrentAddress, GMAC_ADDRESS_SIZE);
+    Frame[2 * GMAC_ADDRESS_SIZE]     = (UINT8)(*Protocol >> 8);
+    Frame[2 * GMAC_ADDRESS_SIZE + 1] = (UINT8)*Protocol;
+  }
+
+  Fragment.Data   = Buffer;
+  Fragment.Length = (UINT32)BufferSize;
+  Status          = GmacTransmit (&Private->Gmac, &Fragment, 1, Buffer);
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GmacSnpReceive (
+  IN     EFI_SIMPLE_NETWORK_PROTOCOL  *This,
+  OUT    UINTN                        *HeaderSize OPTIONAL,
+  IN OUT UINTN                        *BufferSize,
+  OUT    VOID                         *Buffer,
+  OUT    EFI_MAC_ADDRESS              *SrcAddr OPTIONAL,
+  OUT    EFI_MAC_ADDRESS              *DestAddr OPTIONAL,
+  OUT    UINT16                       *Protocol OPTIONAL
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+  UINT8              *Frame;
+
+  if ((This == NULL) || (BufferSize == NULL) || (Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = GMAC_PRIVATE_FROM_SNP (This);
+  OldTpl  = gBS->RaiseTPL (GMAC_TPL);
+  Status  = GmacSnpCheckState (Private, EfiSimpleNetworkInitialized);
+  if (!EFI_ERROR (Status)) {
+    Status = GmacReceive (&Private->Gmac, Buffer, BufferSize);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Frame = Buffer;
+  if (HeaderSize != NULL) {
+    *HeaderSize = Private->Mode.MediaHeaderSize;
+  }
+
+  if (DestAddr != NULL) {
+    ZeroMem (DestAddr, sizeof (EFI_MAC_ADDRESS));
+    CopyMem (DestAddr, Frame, GMAC_ADDRESS_SIZE);
+  }
+
+  if (SrcAddr != NULL) {
+    ZeroMem (SrcAddr, sizeof (EFI_MAC_ADDRESS));
+    CopyMem (SrcAddr, Frame + GMAC_ADDRESS_SIZE, GMAC_ADDRESS_SIZE);
+  }
+
+  if (Protocol != NULL) {
+    *Protocol = (UINT16)((Frame[2 * GMAC_ADDRESS_SIZE] << 8) | Frame[2 * GMAC_ADDRESS_SIZE + 1]);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Signal WaitForPacket while a frame is waiting. Runs at GMAC_TPL, so
+  never inside another call.
+
+  @param  Event         WaitForPacket.
+  @param  Context       Driver private data.
+**/
+STATIC
+VOID
+EFIAPI
+GmacSnpWaitForPacket (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  GMAC_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  if ((Private->Mode.State == EfiSimpleNetworkInitialized) && GmacRxPending (&Private->Gmac)) {
+    gBS->SignalEvent (Event);
+  }
+}
+
+EFI_STATUS
+GmacSnpInit (
+  IN GMAC_PRIVATE_DATA  *Private
+  )
+{
+  EFI_SIMPLE_NETWORK_PROTOCOL  *Snp;
+  EFI_SIMPLE_NETWORK_MODE      *Mode;
+
+  Mode                        = &Private->Mode;
+  Mode->State                 = EfiSimpleNetworkStopped;
+  Mode->HwAddressSize         = GMAC_ADDRESS_SIZE;
+  Mode->MediaHeaderSize       = GMAC_HEADER_SIZE;
+  Mode->MaxPacketSize         = GMAC_MAX_FRAME - GMAC_HEADER_SIZE;
+  Mode->ReceiveFilterMask     = EFI_SIMPLE_NETWORK_RECEIVE_UNICAST |
+                                EFI_SIMPLE_NETWORK_RECEIVE_MULTICAST |
+                                EFI_SIMPLE_NETWORK_RECEIVE_BROADCAST |
+                                EFI_SIMPLE_NETWORK_RECEIVE_PROMISCUOUS |
+                                EFI_SIMPLE_NETWORK_RECEIVE_PROMISCUOUS_MULTICAST;
+  Mode->ReceiveFilterSetting  = EFI_SIMPLE_NETWORK_RECEIVE_UNICAST;
+  Mode->MaxMCastFilterCount   = GMAC_MAX_MCAST_FILTERS;
+  Mode->IfType                = GMAC_IFTYPE_ETHERNET;
+  Mode->MacAddressChangeable  = TRUE;
+  Mode->MultipleTxSupported   = TRUE;
+  Mode->MediaPresentSupported = TRUE;
+  CopyMem (&Mode->CurrentAddress, Private->Gmac.MacAddress, GMAC_ADDRESS_SIZE);
+  CopyMem (&Mode->PermanentAddress, Private->Gmac.MacAddress, GMAC_ADDRESS_SIZE);
+  SetMem (&Mode->BroadcastAddress, GMAC_ADDRESS_SIZE, 0xFF);
+
+  Snp                 = &Private->Snp;
+  Snp->Revision       = EFI_SIMPLE_NETWORK_PROTOCOL_REVISION;
+  Snp->Start          = GmacSnpStartInterface;
+  Snp->Stop           = GmacSnpStopInterface;
+  Snp->Initialize     = GmacSnpInitialize;
+  Snp->Reset          = GmacSnpReset;
+  Snp->Shutdown       = GmacSnpShutdown;
+  Snp->ReceiveFilters = GmacSnpReceiveFilters;
+  Snp->StationAddress = GmacSnpStationAddress;
+  Snp->Statistics     = GmacSnpStatistics;
+  Snp->MCastIpToMac   = GmacSnpMCastIpToMac;
+  Snp->NvData         = GmacSnpNvData;
+  Snp->GetStatus      = GmacSnpGetStatus;
+  Snp->Transmit       = GmacSnpTransmit;
+  Snp->Receive        = GmacSnpReceive;
+  Snp->Mode           = Mode;
+
+  return gBS->CreateEvent (
+                EVT_NOTIFY_WAIT,
+                GMAC_TPL,
+                GmacSnpWaitForPacket,
+                Private,
+                &Snp->WaitForPacket
+                );
+}
@@ -0,0 +1,1518 @@
+/** @file
+  Host test of the GmacDxe engine against a software MAC.
+
+  Gmac.c is built unchanged on top of a model of the MAC, looped back
+  on itself, and of the PHY and link partner behind it. The model keeps
+  its own copy of the memory it reaches by DMA; the cache maintenance
+  stand-ins move whole lines between that copy and the memory the engine
+  uses, so a line the engine fails to clean or invalidate, or cleans
+  over a descriptor the MAC owns, shows up as lost or corrupt frames or
+  as a protocol violation. Each test checks the frames that come back,
+  the copies made, where the MAC gathered transmit data from, and the
+  CPU time per frame against the time the frames take on the wire.
+
+    cd Drivers/GmacDxe
+    cc -O2 -IHost -I../../Host -o GmacLoopbackTest Gmac.c Host/GmacLoopbackTest.c ../../Host/HostTest.c
+    ./GmacLoopbackTest
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HostTest.h"
+
+#include "../Gmac.h"
+
+#define MODEL_BASE            0x1F00100000ULL
+#define MODEL_DMA_OFFSET      0x1000000000ULL
+#define MODEL_PHY             1
+#define MODEL_LINE            64
+#define MODEL_REGIONS         4
+#define MODEL_MAX_DESCRIPTORS 4096
+#define MODEL_ETHER_TYPE      0x88B5
+
+//
+// CPU cost of the engine, in nanoseconds: a register read crosses PCIe
+// to RP1 and back, a write is posted.
+//
+#define MODEL_MMIO_READ_NS    1000
+#define MODEL_MMIO_WRITE_NS   150
+#define MODEL_LINE_NS         2
+#define MODEL_COPY_BYTES_NS   4       // bytes copied per nanosecond
+
+//
+// Preamble, FCS and inter-frame gap around every frame on the wire
+//
+#define MODEL_WIRE_OVERHEAD   (8 + 4 + 12)
+
+//
+// Transmit buffers of the test, in memory the MAC can reach
+//
+#define ARENA_SLOT_SIZE       2048
+#define ARENA_SLOTS           512
+
+typedef struct {
+  UINT8    *Cpu;                      // memory the engine uses
+  UINT8    *Dram;                     // memory the MAC sees
+  UINTN    Size;
+} MODEL_REGION;
+
+typedef struct {
+  //
+  // Memory
+  //
+  MODEL_REGION    Regions[MODEL_REGIONS];
+
+  //
+  // MAC
+  //
+  UINT32          Ncr;
+  UINT32          Ncfgr;
+  UINT32          Dmacfg;
+  UINT32          Tsr;
+  UINT32          Hrb;
+  UINT32          Hrt;
+  UINT32          Sa1b;
+  UINT32          Sa1t;
+  UINT32          Man;
+  UINT32          RbqpHigh;
+  UINT32          TbqpHigh;
+  UINT64          RxBase;
+  UINT64          TxBase;
+  UINT32          RxIndex;
+  UINT32          TxIndex;
+  BOOLEAN         TxGo;
+  BOOLEAN         Defer;              // transmit only in ModelRun
+  BOOLEAN         TxFail;             // next frame stops on an AHB error
+  BOOLEAN         NoDaw64;
+  UINT64          TxFragments[GMAC_MAX_FRAGMENTS];
+  UINT32          TxFragmentCount;
+
+  //
+  // PHY and link partner
+  //
+  BOOLEAN         PhyPresent;
+  UINT16          Phy[32];
+  UINT32          PhyResetReads;
+  BOOLEAN         LinkLatchedLow;
+  BOOLEAN         AnStarted;
+  UINT16          PartnerAnar;
+  BOOLEAN         PartnerGigabit;
+
+  //
+  // Statistics
+  //
+  UINT64          Sent;
+  UINT64          Received;
+  UINT64          RxDropped;          // no free receive buffer
+  UINT64          Filtered;
+  UINT64          MmioReads;
+  UINT64          MmioWrites;
+  UINT64          Lines;
+  UINT64          Copied;
+  UINT64          WireNs;
+  UINT64          WaitNs;             // time the engine spent waiting
+  UINT64          Allocations;
+  UINT64          Violations;
+} MODEL;
+
+STATIC MODEL  mModel;
+STATIC UINT8  *mArena;
+
+STATIC CONST UINT8  mStation[GMAC_ADDRESS_SIZE]   = { 0xD8, 0x3A, 0xDD, 0x12, 0x34, 0x56 };
+STATIC CONST UINT8  mOther[GMAC_ADDRESS_SIZE]     = { 0xD8, 0x3A, 0xDD, 0x12, 0x34, 0x57 };
+STATIC CONST UINT8  mBroadcast[GMAC_ADDRESS_SIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+STATIC CONST UINT8  mMdns[GMAC_ADDRESS_SIZE]      = { 0x01, 0x00, 0x5E, 0x00, 0x00, 0xFB };
+
+STATIC
+VOID
+ModelViolation (
+  IN CONST char  *Message
+  )
+{
+  printf ("  model: %s\n", Message);
+  mModel.Violations++;
+}
+
+//
+// Memory: the engine's view and the MAC's
+//
+
+STATIC
+MODEL_REGION *
+ModelRegion (
+  IN CONST VOID  *Address,
+  IN UINTN       Length
+  )
+{
+  UINTN  Index;
+  UINT8  *Byte;
+
+  Byte = (UINT8 *)Address;
+  for (Index = 0; Index < MODEL_REGIONS; Index++) {
+    if ((mModel.Regions[Index].Cpu != NULL) && (Byte >= mModel.Regions[Index].Cpu) &&
+        (Byte + Length <= mModel.Regions[Index].Cpu + mModel.Regions[Index].Size))
+    {
+      return &mModel.Regions[Index];
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+VOID
+ModelAddRegion (
+  IN UINT8  *Cpu,
+  IN UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MODEL_REGIONS; Index++) {
+    if (mModel.Regions[Index].Cpu == NULL) {
+      //
+      // Start the two views different, so that memory the MAC reads
+      // without a clean is caught.
+      //
+      memset (Cpu, 0xA5, Size);
+      mModel.Regions[Index].Cpu  = Cpu;
+      mModel.Regions[Index].Dram = malloc (Size);
+      mModel.Regions[Index].Size = Size;
+      memset (mModel.Regions[Index].Dram, 0x5A, Size);
+      return;
+    }
+  }
+}
+
+STATIC
+VOID
+ModelRemoveRegion (
+  IN UINT8  *Cpu
+  )
+{
+  MODEL_REGION  *Region;
+
+  Region = ModelRegion (Cpu, 1);
+  if (Region != NULL) {
+    free (Region->Dram);
+    memset (Region, 0, sizeof (*Region));
+  }
+}
+
+/**
+  @return The MAC's view of Length bytes at bus address Address, or NULL.
+**/
+STATIC
+UINT8 *
+ModelDram (
+  IN UINT64  Address,
+  IN UINTN   Length
+  )
+{
+  UINT8         *Cpu;
+  MODEL_REGION  *Region;
+
+  Cpu    = (UINT8 *)(UINTN)(Address - MODEL_DMA_OFFSET);
+  Region = ModelRegion (Cpu, Length);
+  if ((Address < MODEL_DMA_OFFSET) || (Region == NULL)) {
+    ModelViolation ("DMA outside memory given to the MAC");
+    return NULL;
+  }
+
+  return Region->Dram + (Cpu - Region->Cpu);
+}
+
+typedef enum {
+  CacheClean,
+  CacheInvalidate,
+  CacheCleanInvalidate
+} MODEL_CACHE_OP;
+
+STATIC
+VOID
+ModelCache (
+  IN VOID            *Address,
+  IN UINTN           Length,
+  IN MODEL_CACHE_OP  Op
+  )
+{
+  UINT8            *Line;
+  UINT8            *End;
+  MODEL_REGION     *Region;
+  UINT8            *RxRing;
+  GMAC_DESCRIPTOR  *Dram;
+  UINTN            Index;
+
+  Line = (UINT8 *)((UINTN)Address & ~(UINTN)(MODEL_LINE - 1));
+  End  = (UINT8 *)Address + Length;
+  for ( ; Line < End; Line += MODEL_LINE) {
+    mModel.Lines++;
+    Region = ModelRegion (Line, MODEL_LINE);
+    if (Region == NULL) {
+      continue;
+    }
+
+    //
+    // A receive line cleaned while the MAC may write one of its
+    // descriptors loses that write.
+    //
+    RxRing = (UINT8 *)(UINTN)(mModel.RxBase - MODEL_DMA_OFFSET);
+    if ((Op != CacheInvalidate) && ((mModel.Ncr & GMAC_NCR_RE) != 0) && (mModel.RxBase != 0) &&
+        (Line >= RxRing) && (Line < RxRing + GMAC_RX_DESCRIPTORS * sizeof (GMAC_DESCRIPTOR)))
+    {
+      Dram = (GMAC_DESCRIPTOR *)(Region->Dram + (Line - Region->Cpu));
+      for (Index = 0; Index < MODEL_LINE / sizeof (GMAC_DESCRIPTOR); Index++) {
+        if ((Dram[Index].Address & GMAC_RX_USED) == 0) {
+          ModelViolation ("receive line cleaned while the MAC owns a descriptor in it");
+          break;
+        }
+      }
+    }
+
+    if (Op == CacheInvalidate) {
+      memcpy (Line, Region->Dram + (Line - Region->Cpu), MODEL_LINE);
+    } else {
+      memcpy (Region->Dram + (Line - Region->Cpu), Line, MODEL_LINE);
+    }
+  }
+}
+
+VOID *
+WriteBackDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  ModelCache (Address, Length, CacheClean);
+  return Address;
+}
+
+VOID *
+InvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  ModelCache (Address, Length, CacheInvalidate);
+  return Address;
+}
+
+VOID *
+WriteBackInvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  ModelCache (Address, Length, CacheCleanInvalidate);
+  return Address;
+}
+
+VOID *
+CopyMem (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Length
+  )
+{
+  mModel.Copied += Length;
+  return memmove (Destination, Source, Length);
+}
+
+VOID *
+AllocateAlignedPages (
+  IN UINTN  Pages,
+  IN UINTN  Alignment
+  )
+{
+  UINT8  *Buffer;
+
+  Alignment = MAX (Alignment, EFI_PAGE_SIZE);
+  Buffer    = aligned_alloc (Alignment, ALIGN_VALUE (Pages * EFI_PAGE_SIZE, Alignment));
+  if (Buffer != NULL) {
+    ModelAddRegion (Buffer, Pages * EFI_PAGE_SIZE);
+    mModel.Allocations++;
+  }
+
+  return Buffer;
+}
+
+VOID
+FreeAlignedPages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  )
+{
+  ModelRemoveRegion (Buffer);
+  free (Buffer);
+}
+
+UINT64
+HostModelTime (
+  VOID
+  )
+{
+  return mModel.WaitNs;
+}
+
+VOID
+HostModelDelay (
+  IN UINT64  Nanoseconds
+  )
+{
+  mModel.WaitNs += Nanoseconds;
+}
+
+//
+// PHY and link partner
+//
+
+STATIC
+BOOLEAN
+ModelLinkUp (
+  VOID
+  )
+{
+  return mModel.AnStarted && (mModel.PartnerAnar != 0);
+}
+
+STATIC
+VOID
+ModelPhyReset (
+  VOID
+  )
+{
+  memset (mModel.Phy, 0, sizeof (mModel.Phy));
+  mModel.Phy[MII_BMCR]  = MII_BMCR_ANENABLE;
+  mModel.Phy[MII_ANAR]  = MII_AN_SELECTOR;
+  mModel.AnStarted      = FALSE;
+  mModel.LinkLatchedLow = TRUE;
+}
+
+STATIC
+UINT16
+ModelPhyRead (
+  IN UINT32  Register
+  )
+{
+  UINT16  Bmsr;
+
+  switch (Register) {
+    case MII_BMCR:
+      if ((mModel.PhyResetReads != 0) && (--mModel.PhyResetReads == 0)) {
+        mModel.Phy[MII_BMCR] &= ~MII_BMCR_RESET;
+      }
+
+      return mModel.Phy[MII_BMCR];
+
+    case MII_BMSR:
+      Bmsr = 0x7909;
+      if (ModelLinkUp ()) {
+        Bmsr |= MII_BMSR_ANCOMPLETE;
+        if (!mModel.LinkLatchedLow) {
+          Bmsr |= MII_BMSR_LINK;
+        }
+      }
+
+      mModel.LinkLatchedLow = FALSE;
+      return Bmsr;
+
+    case MII_PHYID1:
+      return 0x600D;
+
+    case MII_PHYID2:
+      return 0x84A2;
+
+    case MII_ANLPAR:
+      return ModelLinkUp () ? (mModel.PartnerAnar | MII_AN_SELECTOR | BIT14) : 0;
+
+    case MII_GBSR:
+      return (ModelLinkUp () && mModel.PartnerGigabit) ? MII_GBSR_1000FD : 0;
+
+    default:
+      return mModel.Phy[Register];
+  }
+}
+
+STATIC
+VOID
+ModelPhyWrite (
+  IN UINT32  Register,
+  IN UINT16  Value
+  )
+{
+  if (Register != MII_BMCR) {
+    mModel.Phy[Register] = Value;
+    return;
+  }
+
+  if ((Value & MII_BMCR_RESET) != 0) {
+    ModelPhyReset ();
+    mModel.Phy[MII_BMCR] |= MII_BMCR_RESET;
+    mModel.PhyResetReads  = 3;
+    return;
+  }
+
+  mModel.Phy[MII_BMCR] = Value & ~MII_BMCR_ANRESTART;
+  if ((Value & (MII_BMCR_ANENABLE | MII_BMCR_ANRESTART)) == (MII_BMCR_ANENABLE | MII_BMCR_ANRESTART)) {
+    mModel.AnStarted = TRUE;
+  }
+}
+
+STATIC
+VOID
+ModelMdio (
+  IN UINT32  Value
+  )
+{
+  UINT32  Phy;
+  UINT32  Register;
+  UINT32  Op;
+
+  Phy      = (Value >> 23) & 0x1F;
+  Register = (Value >> 18) & 0x1F;
+  Op       = (Value >> 28) & 3;
+  if (((Value & BIT30) == 0) || (((Value >> 16) & 3) != 2) || ((mModel.Ncr & GMAC_NCR_MPE) == 0)) {
+    ModelViolation ("bad MDIO frame");
+    return;
+  }
+
+  if (Op == 2) {
+    mModel.Man = (Value & 0xFFFF0000) |
+                 ((mModel.PhyPresent && (Phy == MODEL_PHY)) ? ModelPhyRead (Register) : 0xFFFF);
+  } else if ((Op == 1) && mModel.PhyPresent && (Phy == MODEL_PHY)) {
+    ModelPhyWrite (Register, (UINT16)Value);
+  }
+}
+
+/**
+  @return Link speed the MAC must be set to, 0 if the link is down.
+**/
+STATIC
+UINT32
+ModelLinkNcfgr (
+  VOID
+  )
+{
+  UINT16  Common;
+
+  Common = mModel.Phy[MII_ANAR] & mModel.PartnerAnar;
+  if (((mModel.Phy[MII_GBCR] & MII_GBCR_1000FD) != 0) && mModel.PartnerGigabit) {
+    return GMAC_NCFGR_GBE | GMAC_NCFGR_FD;
+  }
+
+  if ((Common & MII_AN_100FD) != 0) {
+    return GMAC_NCFGR_SPD | GMAC_NCFGR_FD;
+  }
+
+  if ((Common & MII_AN_100HD) != 0) {
+    return GMAC_NCFGR_SPD;
+  }
+
+  return ((Common & MII_AN_10FD) != 0) ? GMAC_NCFGR_FD : 0;
+}
+
+//
+// MAC
+//
+
+STATIC
+VOID
+ModelReadDescriptor (
+  IN  UINT64           Ring,
+  IN  UINT32           Index,
+  OUT GMAC_DESCRIPTOR  *Descriptor
+  )
+{
+  UINT8  *Dram;
+
+  Dram = ModelDram (Ring + Index * sizeof (GMAC_DESCRIPTOR), sizeof (GMAC_DESCRIPTOR));
+  if (Dram == NULL) {
+    memset (Descriptor, 0xFF, sizeof (*Descriptor));
+    return;
+  }
+
+  memcpy (Descriptor, Dram, sizeof (*Descriptor));
+}
+
+STATIC
+VOID
+ModelWriteDescriptor (
+  IN UINT64                 Ring,
+  IN UINT32                 Index,
+  IN CONST GMAC_DESCRIPTOR  *Descriptor
+  )
+{
+  UINT8  *Dram;
+
+  Dram = ModelDram (Ring + Index * sizeof (GMAC_DESCRIPTOR), sizeof (GMAC_DESCRIPTOR));
+  if (Dram != NULL) {
+    memcpy (Dram, Descriptor, sizeof (*Descriptor));
+  }
+}
+
+/**
+  @return Bit of the multicast hash the address selects, computed bit
+          by bit of the index as the MAC documentation gives it.
+**/
+STATIC
+UINT32
+ModelHash (
+  IN CONST UINT8  *Address
+  )
+{
+  UINT32  Index;
+  UINT32  Bit;
+  UINT32  Word;
+  UINT32  Value;
+
+  Index = 0;
+  for (Bit = 0; Bit < 6; Bit++) {
+    Value = 0;
+    for (Word = 0; Word < 8; Word++) {
+      Value ^= (Address[(Word * 6 + Bit) / 8] >> ((Word * 6 + Bit) % 8)) & 1;
+    }
+
+    Index |= Value << Bit;
+  }
+
+  return Index;
+}
+
+STATIC
+BOOLEAN
+ModelAccept (
+  IN CONST UINT8  *Frame
+  )
+{
+  UINT8   Station[GMAC_ADDRESS_SIZE];
+  UINT32  Hash;
+
+  if ((mModel.Ncfgr & GMAC_NCFGR_CAF) != 0) {
+    return TRUE;
+  }
+
+  if (memcmp (Frame, mBroadcast, GMAC_ADDRESS_SIZE) == 0) {
+    return (mModel.Ncfgr & GMAC_NCFGR_NBC) == 0;
+  }
+
+  if ((Frame[0] & 1) != 0) {
+    if ((mModel.Ncfgr & GMAC_NCFGR_MTIHEN) == 0) {
+      return FALSE;
+    }
+
+    Hash = ModelHash (Frame);
+    return (((Hash < 32) ? (mModel.Hrb >> Hash) : (mModel.Hrt >> (Hash - 32))) & 1) != 0;
+  }
+
+  Station[0] = (UINT8)mModel.Sa1b;
+  Station[1] = (UINT8)(mModel.Sa1b >> 8);
+  Station[2] = (UINT8)(mModel.Sa1b >> 16);
+  Station[3] = (UINT8)(mModel.Sa1b >> 24);
+  Station[4] = (UINT8)mModel.Sa1t;
+  Station[5] = (UINT8)(mModel.Sa1t >> 8);
+  return memcmp (Frame, Station, GMAC_ADDRESS_SIZE) == 0;
+}
+
+STATIC
+VOID
+ModelRxFrame (
+  IN CONST UINT8  *Data,
+  IN UINT32       Length
+  )
+{
+  UINT8            Frame[GMAC_MAX_FRAME + 4];
+  GMAC_DESCRIPTOR  Descriptor;
+  UINT8            *Dram;
+
+  if ((mModel.Ncr & GMAC_NCR_RE) == 0) {
+    return;
+  }
+
+  if (!ModelAccept (Data)) {
+    mModel.Filtered++;
+    return;
+  }
+
+  memset (Frame, 0, sizeof (Frame));
+  memcpy (Frame, Data, Length);
+  Length = MAX (Length, GMAC_MIN_FRAME);
+  if ((mModel.Ncfgr & GMAC_NCFGR_RFCS) == 0) {
+    Length += 4;
+  }
+
+  ModelReadDescriptor (mModel.RxBase, mModel.RxIndex, &Descriptor);
+  if ((Descriptor.Address & GMAC_RX_USED) != 0) {
+    mModel.RxDropped++;
+    return;
+  }
+
+  if (Length > ((mModel.Dmacfg >> 16) & 0xFF) * 64) {
+    ModelViolation ("frame larger than a receive buffer");
+    return;
+  }
+
+  Dram = ModelDram ((Descriptor.Address & ~3U) | ((UINT64)Descriptor.AddressHigh << 32), Length);
+  if (Dram != NULL) {
+    memcpy (Dram, Frame, Length);
+  }
+
+  Descriptor.Control  = Length | GMAC_RX_SOF | GMAC_RX_EOF;
+  Descriptor.Address |= GMAC_RX_USED;
+  ModelWriteDescriptor (mModel.RxBase, mModel.RxIndex, &Descriptor);
+  mModel.RxIndex = ((Descriptor.Address & GMAC_RX_WRAP) != 0) ? 0 : mModel.RxIndex + 1;
+  mModel.Received++;
+}
+
+/**
+  Send the frame at the transmit pointer and loop it back.
+
+  @retval TRUE          A frame was sent.
+**/
+STATIC
+BOOLEAN
+ModelTxFrame (
+  VOID
+  )
+{
+  UINT8            Frame[GMAC_MAX_FRAME];
+  GMAC_DESCRIPTOR  Descriptor;
+  UINT32           Index;
+  UINT32           Length;
+  UINT32           Piece;
+  UINT32           Count;
+  UINT64           Address;
+  UINT8            *Dram;
+
+  ModelReadDescriptor (mModel.TxBase, mModel.TxIndex, &Descriptor);
+  if ((Descriptor.Control & GMAC_TX_USED) != 0) {
+    mModel.TxGo = FALSE;
+    return FALSE;
+  }
+
+  if (mModel.TxFail) {
+    mModel.TxFail = FALSE;
+    mModel.Tsr   |= BIT4;
+    mModel.TxGo   = FALSE;
+    return FALSE;
+  }
+
+  if ((mModel.Ncfgr & GMAC_NCFGR_LINK_MASK) != ModelLinkNcfgr ()) {
+    ModelViolation ("MAC speed or duplex differs from the link");
+  }
+
+  Index  = mModel.TxIndex;
+  Length = 0;
+  for (Count = 0; ; Count++) {
+    ModelReadDescriptor (mModel.TxBase, Index, &Descriptor);
+    if ((Count > 0) && ((Descriptor.Control & GMAC_TX_USED) != 0)) {
+      ModelViolation ("used descriptor inside a frame");
+      mModel.Tsr  |= BIT6;
+      mModel.TxGo  = FALSE;
+      return FALSE;
+    }
+
+    Piece   = Descriptor.Control & GMAC_TX_LENGTH_MAX;
+    Address = Descriptor.Address | ((UINT64)Descriptor.AddressHigh << 32);
+    if ((Length + Piece > sizeof (Frame)) || (Count >= GMAC_MAX_FRAGMENTS) || (Index >= MODEL_MAX_DESCRIPTORS)) {
+      ModelViolation ("runaway transmit frame");
+      mModel.TxGo = FALSE;
+      return FALSE;
+    }
+
+    Dram = ModelDram (Address, Piece);
+    if (Dram != NULL) {
+      memcpy (Frame + Length, Dram, Piece);
+    }
+
+    mModel.TxFragments[Count] = Address;
+    Length                   += Piece;
+    Index                     = ((Descriptor.Control & GMAC_TX_WRAP) != 0) ? 0 : Index + 1;
+    if ((Descriptor.Control & GMAC_TX_LAST) != 0) {
+      break;
+    }
+  }
+
+  //
+  // The MAC marks the first descriptor of the frame used.
+  //
+  ModelReadDescriptor (mModel.TxBase, mModel.TxIndex, &Descriptor);
+  Descriptor.Control |= GMAC_TX_USED;
+  ModelWriteDescriptor (mModel.TxBase, mModel.TxIndex, &Descriptor);
+
+  mModel.TxIndex         = Index;
+  mModel.TxFragmentCount = Count + 1;
+  mModel.Sent++;
+  mModel.WireNs += (UINT64)(MAX (Length, GMAC_MIN_FRAME) + MODEL_WIRE_OVERHEAD) * 8 *
+                   (((mModel.Ncfgr & GMAC_NCFGR_GBE) != 0) ? 1 : (((mModel.Ncfgr & GMAC_NCFGR_SPD) != 0) ? 10 : 100));
+  ModelRxFrame (Frame, Length);
+  return TRUE;
+}
+
+/**
+  Let the MAC send up to Frames frames.
+**/
+STATIC
+VOID
+ModelRun (
+  IN UINTN  Frames
+  )
+{
+  while (mModel.TxGo && (Frames-- != 0) && ModelTxFrame ()) {
+  }
+}
+
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  )
+{
+  mModel.MmioReads++;
+  switch (Address - MODEL_BASE) {
+    case GMAC_NCR:
+      return mModel.Ncr;
+
+    case GMAC_NCFGR:
+      return mModel.Ncfgr;
+
+    case GMAC_NSR:
+      return GMAC_NSR_IDLE;
+
+    case GMAC_DMACFG:
+      return mModel.Dmacfg;
+
+    case GMAC_TSR:
+      return mModel.Tsr | (mModel.TxGo ? GMAC_TSR_TGO : 0);
+
+    case GMAC_RBQP:
+      return (UINT32)(mModel.RxBase + mModel.RxIndex * sizeof (GMAC_DESCRIPTOR));
+
+    case GMAC_TBQP:
+      return (UINT32)(mModel.TxBase + mModel.TxIndex * sizeof (GMAC_DESCRIPTOR));
+
+    case GMAC_MAN:
+      return mModel.Man;
+
+    case GMAC_HRB:
+      return mModel.Hrb;
+
+    case GMAC_HRT:
+      return mModel.Hrt;
+
+    case GMAC_SA1B:
+      return mModel.Sa1b;
+
+    case GMAC_SA1T:
+      return mModel.Sa1t;
+
+    case GMAC_MID:
+      return 0x00070109;
+
+    case GMAC_DCFG6:
+      return mModel.NoDaw64 ? 0 : GMAC_DCFG6_DAW64;
+
+    case GMAC_RBQPH:
+      return mModel.RbqpHigh;
+
+    case GMAC_TBQPH:
+      return mModel.TbqpHigh;
+
+    default:
+      return 0;
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  UINT32  Old;
+
+  mModel.MmioWrites++;
+  switch (Address - MODEL_BASE) {
+    case GMAC_NCR:
+      Old        = mModel.Ncr;
+      mModel.Ncr = Value & ~GMAC_NCR_TSTART;
+      if (((Old & GMAC_NCR_RE) != 0) && ((Value & GMAC_NCR_RE) == 0)) {
+        mModel.RxIndex = 0;
+      }
+
+      if (((Old & GMAC_NCR_TE) != 0) && ((Value & GMAC_NCR_TE) == 0)) {
+        mModel.TxIndex = 0;
+        mModel.TxGo    = FALSE;
+      }
+
+      if (((Value & GMAC_NCR_RE) != 0) && ((Old & GMAC_NCR_RE) == 0) &&
+          (((mModel.Dmacfg & GMAC_DMACFG_ADDR64) == 0) || (mModel.RxBase == 0)))
+      {
+        ModelViolation ("receive enabled without a 64-bit ring");
+      }
+
+      if (((Value & GMAC_NCR_TSTART) != 0) && ((Value & GMAC_NCR_TE) != 0) && ((mModel.Tsr & GMAC_TSR_ERRORS) == 0)) {
+        mModel.TxGo = TRUE;
+        if (!mModel.Defer) {
+          ModelRun (MAX_UINT32);
+        }
+      }
+
+      break;
+
+    case GMAC_NCFGR:
+      mModel.Ncfgr = Value;
+      break;
+
+    case GMAC_DMACFG:
+      mModel.Dmacfg = Value;
+      break;
+
+    case GMAC_TSR:
+      mModel.Tsr &= ~Value;
+      break;
+
+    case GMAC_RBQP:
+      if ((mModel.Ncr & GMAC_NCR_RE) != 0) {
+        ModelViolation ("receive ring moved while receiving");
+      }
+
+      mModel.RxBase  = ((UINT64)mModel.RbqpHigh << 32) | Value;
+      mModel.RxIndex = 0;
+      break;
+
+    case GMAC_TBQP:
+      if ((mModel.Ncr & GMAC_NCR_TE) != 0) {
+        ModelViolation ("transmit ring moved while transmitting");
+      }
+
+      mModel.TxBase  = ((UINT64)mModel.TbqpHigh << 32) | Value;
+      mModel.TxIndex = 0;
+      break;
+
+    case GMAC_RBQPH:
+      mModel.RbqpHigh = Value;
+      break;
+
+    case GMAC_TBQPH:
+      mModel.TbqpHigh = Value;
+      break;
+
+    case GMAC_MAN:
+      ModelMdio (Value);
+      break;
+
+    case GMAC_HRB:
+      mModel.Hrb = Value;
+      break;
+
+    case GMAC_HRT:
+      mModel.Hrt = Value;
+      break;
+
+    case GMAC_SA1B:
+      mModel.Sa1b = Value;
+      break;
+
+    case GMAC_SA1T:
+      mModel.Sa1t = Value;
+      break;
+
+    default:
+      break;
+  }
+}
+
+//
+// Frames
+//
+
+/**
+  Build frame Sequence in its arena slot and queue it.
+
+  @param  Gmac          MAC.
+  @param  Destination   Destination address.
+  @param  Sequence      Frame number, also in the payload.
+  @param  Length        Frame length.
+  @param  Pieces        Fragments to split it into: the header, then
+                        the payload in equal parts.
+
+  @return GmacTransmit status.
+**/
+STATIC
+EFI_STATUS
+SendFrame (
+  IN GMAC_DEVICE  *Gmac,
+  IN CONST UINT8  *Destination,
+  IN UINT32       Sequence,
+  IN UINT32       Length,
+  IN UINTN        Pieces
+  )
+{
+  UINT8          *Frame;
+  GMAC_FRAGMENT  Fragments[GMAC_MAX_FRAGMENTS + 1];
+  UINT32         Offset;
+  UINT32         Index;
+
+  Frame = mArena + (Sequence % ARENA_SLOTS) * ARENA_SLOT_SIZE;
+  memcpy (Frame, Destination, GMAC_ADDRESS_SIZE);
+  memcpy (Frame + GMAC_ADDRESS_SIZE, mStation, GMAC_ADDRESS_SIZE);
+  Frame[12] = (UINT8)(MODEL_ETHER_TYPE >> 8);
+  Frame[13] = (UINT8)MODEL_ETHER_TYPE;
+  memcpy (Frame + GMAC_HEADER_SIZE, &Sequence, sizeof (Sequence));
+  for (Index = GMAC_HEADER_SIZE + sizeof (Sequence); Index < Length; Index++) {
+    Frame[Index] = (UINT8)(Sequence * 7 + Index);
+  }
+
+  if (Pieces == 1) {
+    Fragments[0].Data   = Frame;
+    Fragments[0].Length = Length;
+  } else {
+    Fragments[0].Data   = Frame;
+    Fragments[0].Length = GMAC_HEADER_SIZE;
+    Offset              = GMAC_HEADER_SIZE;
+    for (Index = 1; Index < Pieces; Index++) {
+      Fragments[Index].Data   = Frame + Offset;
+      Fragments[Index].Length = (Index == Pieces - 1) ? Length - Offset : (Length - GMAC_HEADER_SIZE) / (Pieces - 1);
+      Offset                 += Fragments[Index].Length;
+    }
+  }
+
+  return GmacTransmit (Gmac, Fragments, Pieces, Frame);
+}
+
+/**
+  @return TRUE if Buffer holds frame Sequence of Length bytes, padded
+          to the minimum frame size.
+**/
+STATIC
+BOOLEAN
+CheckFrame (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Size,
+  IN UINT32       Sequence,
+  IN UINT32       Length
+  )
+{
+  UINT32  Index;
+  UINT32  Received;
+
+  if (Size != MAX (Length, GMAC_MIN_FRAME)) {
+    return FALSE;
+  }
+
+  memcpy (&Received, Buffer + GMAC_HEADER_SIZE, sizeof (Received));
+  if ((memcmp (Buffer + GMAC_ADDRESS_SIZE, mStation, GMAC_ADDRESS_SIZE) != 0) || (Received != Sequence)) {
+    return FALSE;
+  }
+
+  for (Index = GMAC_HEADER_SIZE + sizeof (Sequence); Index < Size; Index++) {
+    if (Buffer[Index] != ((Index < Length) ? (UINT8)(Sequence * 7 + Index) : 0)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Take back every frame the MAC is done with.
+
+  @return Frames reclaimed, or MAX_UINT32 if one came back out of order.
+**/
+STATIC
+UINT32
+ReclaimAll (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       FirstSequence
+  )
+{
+  UINT32  Count;
+  VOID    *Token;
+
+  for (Count = 0; (Token = GmacReclaim (Gmac)) != NULL; Count++) {
+    if (Token != mArena + ((FirstSequence + Count) % ARENA_SLOTS) * ARENA_SLOT_SIZE) {
+      return MAX_UINT32;
+    }
+  }
+
+  return Count;
+}
+
+/**
+  Receive every waiting frame and check it against the frames sent.
+
+  @return Frames received in order, or MAX_UINT32 on a bad frame.
+**/
+STATIC
+UINT32
+ReceiveAll (
+  IN GMAC_DEVICE  *Gmac,
+  IN UINT32       FirstSequence,
+  IN UINT32       Length
+  )
+{
+  UINT8   Buffer[GMAC_MAX_FRAME];
+  UINTN   Size;
+  UINT32  Count;
+
+  for (Count = 0; ; Count++) {
+    Size = sizeof (Buffer);
+    if (GmacReceive (Gmac, Buffer, &Size) != EFI_SUCCESS) {
+      return Count;
+    }
+
+    if (!CheckFrame (Buffer, Size, FirstSequence + Count, Length)) {
+      return MAX_UINT32;
+    }
+  }
+}
+
+//
+// Tests
+//
+
+typedef struct {
+  CONST char    *Name;
+  BOOLEAN       PartnerGigabit;
+  UINT16        PartnerAnar;
+  UINT32        Speed;                // expected
+  BOOLEAN       FullDuplex;
+} SCENARIO;
+
+STATIC CONST SCENARIO  mGigabit = { "1000BASE-T full duplex", TRUE, MII_AN_ALL, 1000, TRUE };
+
+STATIC
+VOID
+ModelReset (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MODEL_REGIONS; Index++) {
+    free (mModel.Regions[Index].Dram);
+  }
+
+  free (mArena);
+  memset (&mModel, 0, sizeof (mModel));
+  mModel.PhyPresent     = TRUE;
+  mModel.PartnerAnar    = Scenario->PartnerAnar;
+  mModel.PartnerGigabit = Scenario->PartnerGigabit;
+  ModelPhyReset ();
+
+  mArena = aligned_alloc (EFI_PAGE_SIZE, ARENA_SLOTS * ARENA_SLOT_SIZE);
+  ModelAddRegion (mArena, ARENA_SLOTS * ARENA_SLOT_SIZE);
+}
+
+/**
+  Set the MAC up as the Simple Network glue does and bring the link up.
+**/
+STATIC
+BOOLEAN
+StartMac (
+  IN  CONST SCENARIO  *Scenario,
+  OUT GMAC_DEVICE     *Gmac
+  )
+{
+  ModelReset (Scenario);
+  memset (Gmac, 0, sizeof (*Gmac));
+  Gmac->Base       = MODEL_BASE;
+  Gmac->PhyAddress = MODEL_PHY;
+  Gmac->DmaOffset  = MODEL_DMA_OFFSET;
+  memcpy (Gmac->MacAddress, mStation, GMAC_ADDRESS_SIZE);
+
+  CHECK (GmacInit (Gmac) == EFI_SUCCESS, "MAC set up");
+  CHECK (GmacPhyInit (Gmac) == EFI_SUCCESS, "PHY set up");
+  GmacSetFilter (Gmac, GMAC_FILTER_BROADCAST, NULL, 0);
+  GmacEnable (Gmac, TRUE);
+  CHECK (GmacUpdateLink (Gmac), "link up");
+  CHECK ((Gmac->Speed == Scenario->Speed) && (Gmac->FullDuplex == Scenario->FullDuplex), "negotiated speed");
+  CHECK ((mModel.Ncfgr & GMAC_NCFGR_LINK_MASK) == ModelLinkNcfgr (), "MAC at the link speed");
+  return mFailures == 0;
+}
+
+STATIC
+VOID
+StopMac (
+  IN GMAC_DEVICE  *Gmac
+  )
+{
+  CHECK (mModel.Allocations == 1, "rings allocated once");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+  GmacEnable (Gmac, FALSE);
+  FreeAlignedPages (Gmac->Dma, EFI_SIZE_TO_PAGES (GMAC_DMA_SIZE));
+}
+
+STATIC
+VOID
+TestRoundTrip (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  STATIC CONST UINT32  Lengths[] = { 42, 60, 61, 64, 100, 1000, 1513, 1514 };
+  GMAC_DEVICE          Gmac;
+  UINT32               Sequence;
+  UINTN                Length;
+  UINTN                Pieces;
+  UINTN                Index;
+
+  printf ("Round trip, %s\n", Scenario->Name);
+  if (!StartMac (Scenario, &Gmac)) {
+    return;
+  }
+
+  Sequence = 0;
+  for (Length = 0; Length < sizeof (Lengths) / sizeof (Lengths[0]); Length++) {
+    for (Pieces = 1; Pieces <= 3; Pieces++) {
+      mModel.Copied = 0;
+      CHECK (SendFrame (&Gmac, mStation, Sequence, Lengths[Length], Pieces) == EFI_SUCCESS, "frame queued");
+      CHECK (ReceiveAll (&Gmac, Sequence, Lengths[Length]) == 1, "frame back intact");
+      CHECK (mModel.Copied == MAX (Lengths[Length], GMAC_MIN_FRAME), "one copy of the received frame");
+      CHECK (mModel.TxFragmentCount == Pieces, "one descriptor per fragment");
+      for (Index = 0; Index < Pieces; Index++) {
+        CHECK (
+          mModel.TxFragments[Index] == (UINT64)(UINTN)(mArena + (Sequence % ARENA_SLOTS) * ARENA_SLOT_SIZE) + MODEL_DMA_OFFSET +
+          ((Index == 0) ? 0 : GMAC_HEADER_SIZE + (Index - 1) * ((Lengths[Length] - GMAC_HEADER_SIZE) / (Pieces - 1))),
+          "MAC reads the caller's fragments in place"
+          );
+      }
+
+      CHECK (ReclaimAll (&Gmac, Sequence) == 1, "frame reclaimed");
+      Sequence++;
+    }
+  }
+
+  CHECK (SendFrame (&Gmac, mStation, Sequence, GMAC_MAX_FRAME + 1, 1) == EFI_INVALID_PARAMETER, "oversized frame refused");
+  CHECK (SendFrame (&Gmac, mStation, Sequence, 1200, GMAC_MAX_FRAGMENTS + 1) == EFI_INVALID_PARAMETER, "too many fragments refused");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestLineRate (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+  UINT32       Sequence;
+  UINT32       Batch;
+  UINT32       Index;
+  UINT32       Frames;
+  UINT64       Bytes;
+  UINT64       CpuNs;
+
+  printf ("Line rate, 1514-byte frames\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  Frames            = 20000;
+  Batch             = 125;
+  mModel.MmioReads  = 0;
+  mModel.MmioWrites = 0;
+  mModel.Lines      = 0;
+  mModel.Copied     = 0;
+  mModel.WireNs     = 0;
+  Bytes             = 0;
+  for (Sequence = 0; Sequence < Frames; Sequence += Batch) {
+    for (Index = 0; Index < Batch; Index++) {
+      CHECK (SendFrame (&Gmac, mStation, Sequence + Index, GMAC_MAX_FRAME, 2) == EFI_SUCCESS, "frame queued");
+    }
+
+    CHECK (ReceiveAll (&Gmac, Sequence, GMAC_MAX_FRAME) == Batch, "batch back intact");
+    CHECK (ReclaimAll (&Gmac, Sequence) == Batch, "batch reclaimed");
+    Bytes += (UINT64)Batch * GMAC_MAX_FRAME;
+  }
+
+  CpuNs = mModel.MmioReads * MODEL_MMIO_READ_NS + mModel.MmioWrites * MODEL_MMIO_WRITE_NS +
+          mModel.Lines * MODEL_LINE_NS + mModel.Copied / MODEL_COPY_BYTES_NS;
+  printf (
+    "  %u frames: wire %llu us, CPU %llu us; per frame %.3f MMIO reads, %.2f writes, %.1f lines, %.0f bytes copied\n",
+    Frames,
+    (unsigned long long)(mModel.WireNs / 1000),
+    (unsigned long long)(CpuNs / 1000),
+    (double)mModel.MmioReads / Frames,
+    (double)mModel.MmioWrites / Frames,
+    (double)mModel.Lines / Frames,
+    (double)mModel.Copied / Frames
+    );
+  CHECK (mModel.RxDropped == 0, "no frame dropped");
+  CHECK (mModel.Copied == Bytes, "received bytes copied once");
+  CHECK (mModel.MmioReads * 100 <= Frames, "register reads amortized over the batch");
+  CHECK (CpuNs * 4 <= mModel.WireNs, "CPU keeps up with the wire");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestRxOverflow (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+  UINT32       Sequence;
+  UINT32       Index;
+
+  printf ("Receive ring full\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  //
+  // Fill the receive ring without taking anything, then some more.
+  //
+  for (Sequence = 0; Sequence < GMAC_RX_DESCRIPTORS + 100; Sequence += 100) {
+    for (Index = 0; Index < 100; Index++) {
+      CHECK (SendFrame (&Gmac, mStation, Sequence + Index, 200, 1) == EFI_SUCCESS, "frame queued");
+    }
+
+    CHECK (ReclaimAll (&Gmac, Sequence) == 100, "batch reclaimed");
+  }
+
+  CHECK (mModel.RxDropped == Sequence - GMAC_RX_DESCRIPTORS, "frames beyond the ring dropped");
+  CHECK (ReceiveAll (&Gmac, 0, 200) == GMAC_RX_DESCRIPTORS, "ring drained in order");
+
+  //
+  // Everything was handed back: a second lap goes through whole.
+  //
+  for (Index = 0; Index < 3; Index++) {
+    for (Sequence = 0; Sequence < 500; Sequence++) {
+      CHECK (SendFrame (&Gmac, mStation, Sequence, 300, 1) == EFI_SUCCESS, "frame queued");
+      if ((Sequence % 100) == 99) {
+        CHECK (ReclaimAll (&Gmac, Sequence - 99) == 100, "batch reclaimed");
+      }
+    }
+
+    CHECK (ReceiveAll (&Gmac, 0, 300) == 500, "next lap intact");
+  }
+
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestFilter (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+  UINT8        Group[2][GMAC_ADDRESS_SIZE];
+  UINT8        Other[GMAC_ADDRESS_SIZE];
+
+  printf ("Receive filter\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  //
+  // A group address hashing to another bit than the mDNS one
+  //
+  memcpy (Other, mMdns, GMAC_ADDRESS_SIZE);
+  do {
+    Other[5]++;
+  } while (ModelHash (Other) == ModelHash (mMdns));
+
+  SendFrame (&Gmac, mOther, 0, 100, 1);
+  SendFrame (&Gmac, mMdns, 1, 100, 1);
+  SendFrame (&Gmac, mBroadcast, 2, 100, 1);
+  CHECK (ReclaimAll (&Gmac, 0) == 3, "frames reclaimed");
+  CHECK (ReceiveAll (&Gmac, 2, 100) == 1, "only broadcast received");
+
+  memcpy (Group[0], Other, GMAC_ADDRESS_SIZE);
+  Group[0][0] ^= 0x02;
+  memcpy (Group[1], mMdns, GMAC_ADDRESS_SIZE);
+  GmacSetFilter (&Gmac, GMAC_FILTER_MULTICAST, (CONST UINT8 (*)[GMAC_ADDRESS_SIZE])Group, 2);
+  SendFrame (&Gmac, mBroadcast, 3, 100, 1);
+  SendFrame (&Gmac, Other, 4, 100, 1);
+  SendFrame (&Gmac, mMdns, 5, 100, 1);
+  CHECK (ReclaimAll (&Gmac, 3) == 3, "frames reclaimed");
+  CHECK (ReceiveAll (&Gmac, 5, 100) == 1 || ModelHash (Group[0]) == ModelHash (Other), "only the group received");
+
+  GmacSetFilter (&Gmac, GMAC_FILTER_ALL_MULTICAST, NULL, 0);
+  SendFrame (&Gmac, Other, 6, 100, 1);
+  CHECK (ReclaimAll (&Gmac, 6) == 1, "frame reclaimed");
+  CHECK (ReceiveAll (&Gmac, 6, 100) == 1, "any group received");
+
+  GmacSetFilter (&Gmac, GMAC_FILTER_PROMISCUOUS, NULL, 0);
+  SendFrame (&Gmac, mOther, 7, 100, 1);
+  CHECK (ReclaimAll (&Gmac, 7) == 1, "frame reclaimed");
+  CHECK (ReceiveAll (&Gmac, 7, 100) == 1, "other station received");
+
+  GmacSetFilter (&Gmac, GMAC_FILTER_BROADCAST, NULL, 0);
+  GmacSetAddress (&Gmac, mOther);
+  SendFrame (&Gmac, mOther, 8, 100, 1);
+  SendFrame (&Gmac, mStation, 9, 100, 1);
+  CHECK (ReclaimAll (&Gmac, 8) == 2, "frames reclaimed");
+  CHECK (ReceiveAll (&Gmac, 8, 100) == 1, "new station address received");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestSmallBuffer (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+  UINT8        Buffer[GMAC_MAX_FRAME];
+  UINTN        Size;
+
+  printf ("Receive buffer too small\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  SendFrame (&Gmac, mStation, 0, 1000, 1);
+  SendFrame (&Gmac, mStation, 1, 1000, 1);
+  Size = 100;
+  CHECK (GmacReceive (&Gmac, Buffer, &Size) == EFI_BUFFER_TOO_SMALL, "too small reported");
+  CHECK (Size == 1000, "size needed returned");
+  CHECK (ReceiveAll (&Gmac, 0, 1000) == 2, "frame kept");
+  Size = sizeof (Buffer);
+  CHECK (GmacReceive (&Gmac, Buffer, &Size) == EFI_NOT_READY, "nothing left");
+  CHECK (!GmacRxPending (&Gmac), "nothing pending");
+  CHECK (ReclaimAll (&Gmac, 0) == 2, "frames reclaimed");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestTxRing (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+  UINT32       Sequence;
+  UINT32       Received;
+
+  printf ("Transmit ring full, then an error\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  //
+  // The MAC holds back: the ring fills to one short of its size.
+  //
+  mModel.Defer = TRUE;
+  for (Sequence = 0; SendFrame (&Gmac, mStation, Sequence, 100, 1) == EFI_SUCCESS; Sequence++) {
+  }
+
+  CHECK (Sequence == GMAC_TX_DESCRIPTORS - 1, "ring full one short of its size");
+  CHECK (SendFrame (&Gmac, mStation, Sequence, 100, 1) == EFI_NOT_READY, "full ring refuses");
+  CHECK (GmacReclaim (&Gmac) == NULL, "nothing sent yet");
+  ModelRun (100);
+  CHECK (ReclaimAll (&Gmac, 0) == 100, "sent frames reclaimed");
+  CHECK (SendFrame (&Gmac, mStation, Sequence, 100, 3) == EFI_SUCCESS, "room again");
+  ModelRun (MAX_UINT32);
+  CHECK (ReclaimAll (&Gmac, 100) == Sequence + 1 - 100, "rest reclaimed");
+  CHECK (ReceiveAll (&Gmac, 0, 100) == Sequence + 1, "frames back");
+
+  //
+  // An AHB error stops transmit on the first of three frames: they are
+  // all handed back, and transmit goes on from the start of the ring.
+  //
+  Sequence++;
+  mModel.TxFail = TRUE;
+  SendFrame (&Gmac, mStation, Sequence, 100, 1);
+  SendFrame (&Gmac, mStation, Sequence + 1, 100, 2);
+  SendFrame (&Gmac, mStation, Sequence + 2, 100, 3);
+  ModelRun (MAX_UINT32);
+  CHECK (ReclaimAll (&Gmac, Sequence) == 3, "frames in flight handed back");
+  CHECK (Gmac.TxErrors == 1, "error counted");
+  CHECK (mModel.TxIndex == 0, "transmit restarted at the ring start");
+
+  mModel.Defer = FALSE;
+  Sequence    += 3;
+  for (Received = 0; Received < 300; Received++) {
+    CHECK (SendFrame (&Gmac, mStation, Sequence + Received, 500, 2) == EFI_SUCCESS, "frame queued");
+    CHECK (ReclaimAll (&Gmac, Sequence + Received) == 1, "frame reclaimed");
+  }
+
+  CHECK (ReceiveAll (&Gmac, Sequence, 500) == 300, "traffic resumes");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestRestart (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+
+  printf ("Stop with frames in flight, restart\n");
+  if (!StartMac (&mGigabit, &Gmac)) {
+    return;
+  }
+
+  mModel.Defer = TRUE;
+  SendFrame (&Gmac, mStation, 0, 100, 1);
+  SendFrame (&Gmac, mStation, 1, 100, 1);
+  GmacEnable (&Gmac, FALSE);
+  CHECK (ReclaimAll (&Gmac, 0) == 2, "frames in flight handed back");
+
+  mModel.Defer = FALSE;
+  CHECK (GmacInit (&Gmac) == EFI_SUCCESS, "MAC set up again");
+  GmacEnable (&Gmac, TRUE);
+  SendFrame (&Gmac, mStation, 2, 100, 1);
+  CHECK (ReceiveAll (&Gmac, 2, 100) == 1, "frame back after restart");
+  CHECK (ReclaimAll (&Gmac, 2) == 1, "frame reclaimed");
+  StopMac (&Gmac);
+}
+
+STATIC
+VOID
+TestNoPhy (
+  VOID
+  )
+{
+  GMAC_DEVICE  Gmac;
+
+  printf ("No PHY, no 64-bit DMA\n");
+  ModelReset (&mGigabit);
+  mModel.PhyPresent = FALSE;
+  memset (&Gmac, 0, sizeof (Gmac));
+  Gmac.Base       = MODEL_BASE;
+  Gmac.PhyAddress = MODEL_PHY;
+  Gmac.DmaOffset  = MODEL_DMA_OFFSET;
+  CHECK (GmacInit (&Gmac) == EFI_SUCCESS, "MAC set up");
+  CHECK (GmacPhyInit (&Gmac) == EFI_NOT_FOUND, "missing PHY reported");
+  FreeAlignedPages (Gmac.Dma, 0);
+
+  mModel.NoDaw64 = TRUE;
+  memset (&Gmac, 0, sizeof (Gmac));
+  Gmac.Base = MODEL_BASE;
+  CHECK (GmacInit (&Gmac) == EFI_UNSUPPORTED, "32-bit MAC refused");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+}
+
+int
+main (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenarios[] = {
+    { "1000BASE-T full duplex",  TRUE,  MII_AN_ALL,                                           1000, TRUE  },
+    { "100BASE-TX full duplex",  FALSE, MII_AN_ALL,                                           100,  TRUE  },
+    { "100BASE-TX half duplex",  FALSE, MII_AN_100HD | MII_AN_10FD | MII_AN_10HD,             100,  FALSE },
+    { "10BASE-T full duplex",    FALSE, MII_AN_10FD | MII_AN_10HD,                            10,   TRUE  },
+  };
+  UINTN                  Index;
+
+  for (Index = 0; Index < sizeof (Scenarios) / sizeof (Scenarios[0]); Index++) {
+    TestRoundTrip (&Scenarios[Index]);
+  }
+
+  TestLineRate ();
+  TestRxOverflow ();
+  TestFilter ();
+  TestSmallBuffer ();
+  TestTxRing ();
+  TestRestart ();
+  TestNoPhy ();
+
+  return HostTestResult ();
+}
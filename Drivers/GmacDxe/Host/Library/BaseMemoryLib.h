@@ -0,0 +1,25 @@
+/** @file
+  Host stand-in for BaseMemoryLib: the test counts the bytes the engine
+  copies.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_BASE_MEMORY_LIB_H_
+#define HOST_BASE_MEMORY_LIB_H_
+
+#include <string.h>
+
+#define ZeroMem(Buffer, Length)         memset ((Buffer), 0, (Length))
+#define SetMem(Buffer, Length, Value)   memset ((Buffer), (Value), (Length))
+
+VOID *
+CopyMem (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Length
+  );
+
+#endif
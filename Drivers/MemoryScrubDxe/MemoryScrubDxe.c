@@ -0,0 +1,398 @@
+/** @file
+  Clears free DRAM across all cores before the OS is started.
+
+  At ReadyToBoot every free range of the UEFI memory map is allocated,
+  cut into stripes and handed to the RPi5D work queue, so all four cores
+  clear memory at once with DC ZVA. The ranges are then freed again.
+  The driver is only in the image when the platform is built with
+  -DMEMORY_SCRUB. Add -DMEMORY_SCRUB_PATTERN_TEST to have each stripe
+  pattern tested before it is cleared; failing ranges are taken out of
+  the memory map as EfiUnusableMemory and listed in a configuration
+  table.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/ArmLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include "../../Include/Guid/MemoryTestResult.h"
+#include "../../Include/Library/MemoryScrubLib.h"
+#include "../../Include/Platform/RPi5D.h"
+#include "../../Include/Protocol/RPi5DWorkQueue.h"
+
+//
+// Work item size: small enough to balance the cores, large enough that
+// queueing costs nothing next to clearing.
+//
+#define SCRUB_STRIPE_SIZE  SIZE_32MB
+
+//
+// Descriptors the map may gain between sizing and allocating
+//
+#define SCRUB_MAP_SLACK  8
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS  Base;
+  UINT64                Length;
+  UINT64                Ticks;
+  UINTN                 Core;
+  UINTN                 FailStart;
+  UINTN                 FailEnd;
+} SCRUB_STRIPE;
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS  Base;
+  UINTN                 Pages;
+} SCRUB_RANGE;
+
+STATIC EFI_GUID   mWorkQueueGuid = RPI5D_WORK_QUEUE_PROTOCOL_GUID;
+STATIC EFI_EVENT  mReadyToBootEvent;
+
+#ifdef MEMORY_SCRUB_PATTERN_TEST
+STATIC EFI_GUID  mMemoryTestResultGuid = RPI5D_MEMORY_TEST_RESULT_GUID;
+#endif
+
+/**
+  Work item: clear, or test and clear, one stripe. Runs on any core.
+
+  @param  Argument      The SCRUB_STRIPE.
+**/
+STATIC
+VOID
+EFIAPI
+ScrubStripe (
+  IN OUT VOID  *Argument
+  )
+{
+  SCRUB_STRIPE  *Stripe;
+  UINT64        Start;
+
+  Stripe       = Argument;
+  Stripe->Core = RPI5D_CORE_POSITION (ArmReadMpidr ());
+  Start        = GetPerformanceCounter ();
+
+#ifdef MEMORY_SCRUB_PATTERN_TEST
+  MemoryScrubTest ((VOID *)(UINTN)Stripe->Base, (UINTN)Stripe->Length, &Stripe->FailStart, &Stripe->FailEnd);
+#else
+  MemoryScrubZero ((VOID *)(UINTN)Stripe->Base, (UINTN)Stripe->Length);
+#endif
+
+  Stripe->Ticks = GetPerformanceCounter () - Start;
+}
+
+/**
+  Read the UEFI memory map into a pool buffer with room to spare.
+
+  @param  MapSize         Size of the map read.
+  @param  DescriptorSize  Size of one descriptor.
+
+  @return The map, or NULL without memory.
+**/
+STATIC
+EFI_MEMORY_DESCRIPTOR *
+ScrubGetMemoryMap (
+  OUT UINTN  *MapSize,
+  OUT UINTN  *DescriptorSize
+  )
+{
+  EFI_MEMORY_DESCRIPTOR  *Map;
+  EFI_STATUS             Status;
+  UINTN                  MapKey;
+  UINT32                 Version;
+
+  *MapSize = 0;
+  Map      = NULL;
+  Status   = gBS->GetMemoryMap (MapSize, NULL, &MapKey, DescriptorSize, &Version);
+  while (Status == EFI_BUFFER_TOO_SMALL) {
+    *MapSize += SCRUB_MAP_SLACK * *DescriptorSize;
+    Map       = AllocatePool (*MapSize);
+    if (Map == NULL) {
+      return NULL;
+    }
+
+    Status = gBS->GetMemoryMap (MapSize, Map, &MapKey, DescriptorSize, &Version);
+    if (EFI_ERROR (Status)) {
+      FreePool (Map);
+      Map = NULL;
+    }
+  }
+
+  return Map;
+}
+
+/**
+  Report the clearing rate of each core and of the whole run.
+
+  @param  Stripes       Finished stripes.
+  @param  Count         Number of stripes.
+  @param  Elapsed       Wall clock time of the run, in performance
+                        counter ticks.
+**/
+STATIC
+VOID
+ScrubReport (
+  IN SCRUB_STRIPE  *Stripes,
+  IN UINTN         Count,
+  IN UINT64        Elapsed
+  )
+{
+  UINT64  Bytes[RPI5D_CORE_COUNT];
+  UINT64  Ticks[RPI5D_CORE_COUNT];
+  UINT64  Total;
+  UINT64  Ns;
+  UINTN   Index;
+
+  ZeroMem (Bytes, sizeof (Bytes));
+  ZeroMem (Ticks, sizeof (Ticks));
+  Total = 0;
+  for (Index = 0; Index < Count; Index++) {
+    Bytes[Stripes[Index].Core] += Stripes[Index].Length;
+    Ticks[Stripes[Index].Core] += Stripes[Index].Ticks;
+    Total                      += Stripes[Index].Length;
+  }
+
+  //
+  // Bytes per nanosecond is GB/s; two decimals.
+  //
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    Ns = GetTimeInNanoSecond (Ticks[Index]);
+    if (Ns != 0) {
+      DEBUG ((
+        DEBUG_INFO,
+        "RPi5D MemoryScrub: Core %u cleared %Lu MB at %Lu.%02Lu GB/s\n",
+        (UINT32)Index,
+        RShiftU64 (Bytes[Index], 20),
+        DivU64x64Remainder (Bytes[Index], Ns, NULL),
+        DivU64x64Remainder (MultU64x32 (Bytes[Index], 100), Ns, NULL) % 100
+        ));
+    }
+  }
+
+  Ns = MAX (GetTimeInNanoSecond (Elapsed), 1);
+  DEBUG ((
+    DEBUG_INFO,
+    "RPi5D MemoryScrub: %Lu MB in %Lu ms, %Lu.%02Lu GB/s\n",
+    RShiftU64 (Total, 20),
+    DivU64x32 (Ns, 1000000),
+    DivU64x64Remainder (Total, Ns, NULL),
+    DivU64x64Remainder (MultU64x32 (Total, 100), Ns, NULL) % 100
+    ));
+}
+
+#ifdef MEMORY_SCRUB_PATTERN_TEST
+
+/**
+  Take failing ranges out of the memory map and publish them.
+
+  @param  Stripes       Tested stripes.
+  @param  Count         Number of stripes.
+**/
+STATIC
+VOID
+ScrubPublishFailures (
+  IN SCRUB_STRIPE  *Stripes,
+  IN UINTN         Count
+  )
+{
+  MEMORY_TEST_RESULT    *Result;
+  EFI_PHYSICAL_ADDRESS  Base;
+  EFI_PHYSICAL_ADDRESS  End;
+  UINTN                 Failed;
+  UINTN                 Index;
+  UINT64                Tested;
+
+  Failed = 0;
+  Tested = 0;
+  for (Index = 0; Index < Count; Index++) {
+    Tested += Stripes[Index].Length;
+    if (Stripes[Index].FailEnd != 0) {
+      Failed++;
+    }
+  }
+
+  Result = AllocateRuntimeZeroPool (sizeof (*Result) + Failed * sizeof (Result->Failures[0]));
+  if (Result == NULL) {
+    return;
+  }
+
+  Result->Signature   = MEMORY_TEST_RESULT_SIGNATURE;
+  Result->BytesTested = Tested;
+
+  for (Index = 0; Index < Count; Index++) {
+    if (Stripes[Index].FailEnd == 0) {
+      continue;
+    }
+
+    Base = (Stripes[Index].Base + Stripes[Index].FailStart) & ~(UINT64)EFI_PAGE_MASK;
+    End  = ALIGN_VALUE (Stripes[Index].Base + Stripes[Index].FailEnd, EFI_PAGE_SIZE);
+    DEBUG ((DEBUG_ERROR, "RPi5D MemoryScrub: Pattern test failed at 0x%lx-0x%lx\n", Base, End - 1));
+
+    Result->Failures[Result->Count].Base   = Base;
+    Result->Failures[Result->Count].Length = End - Base;
+    Result->Count++;
+
+    gBS->AllocatePages (AllocateAddress, EfiUnusableMemory, EFI_SIZE_TO_PAGES (End - Base), &Base);
+  }
+
+  gBS->InstallConfigurationTable (&mMemoryTestResultGuid, Result);
+}
+
+#endif
+
+/**
+  Clear all free DRAM with every core.
+
+  @param  Event         ReadyToBoot event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+ScrubReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  RPI5D_WORK_QUEUE_PROTOCOL  *WorkQueue;
+  EFI_MEMORY_DESCRIPTOR      *Map;
+  EFI_MEMORY_DESCRIPTOR      *Descriptor;
+  SCRUB_STRIPE               *Stripes;
+  SCRUB_RANGE                *Ranges;
+  UINTN                      MapSize;
+  UINTN                      DescriptorSize;
+  UINTN                      MaxStripes;
+  UINTN                      MaxRanges;
+  UINTN                      StripeCount;
+  UINTN                      RangeCount;
+  UINTN                      Index;
+  UINT64                     Offset;
+  UINT64                     Start;
+  EFI_STATUS                 Status;
+
+  gBS->CloseEvent (Event);
+
+  if (EFI_ERROR (gBS->LocateProtocol (&mWorkQueueGuid, NULL, (VOID **)&WorkQueue))) {
+    WorkQueue = NULL;
+  }
+
+  //
+  // Size the stripe table from a first look at the map, with room for
+  // the ranges the table allocations themselves split.
+  //
+  Map = ScrubGetMemoryMap (&MapSize, &DescriptorSize);
+  if (Map == NULL) {
+    return;
+  }
+
+  MaxStripes = SCRUB_MAP_SLACK;
+  for (Index = 0; Index < MapSize / DescriptorSize; Index++) {
+    Descriptor = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)Map + Index * DescriptorSize);
+    if (Descriptor->Type == EfiConventionalMemory) {
+      MaxStripes += (UINTN)DivU64x32 (EFI_PAGES_TO_SIZE (Descriptor->NumberOfPages) + SCRUB_STRIPE_SIZE - 1, SCRUB_STRIPE_SIZE);
+    }
+  }
+
+  MaxRanges = MapSize / DescriptorSize + SCRUB_MAP_SLACK;
+  Stripes   = AllocateZeroPool (MaxStripes * sizeof (*Stripes));
+  Ranges    = AllocateZeroPool (MaxRanges * sizeof (*Ranges));
+  FreePool (Map);
+  Map = ScrubGetMemoryMap (&MapSize, &DescriptorSize);
+  if ((Stripes == NULL) || (Ranges == NULL) || (Map == NULL)) {
+    goto Done;
+  }
+
+  //
+  // Own every free range before touching it, then cut it up.
+  //
+  StripeCount = 0;
+  RangeCount  = 0;
+  for (Index = 0; Index < MapSize / DescriptorSize; Index++) {
+    Descriptor = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)Map + Index * DescriptorSize);
+    if ((Descriptor->Type != EfiConventionalMemory) || (RangeCount == MaxRanges) ||
+        (StripeCount + DivU64x32 (EFI_PAGES_TO_SIZE (Descriptor->NumberOfPages) + SCRUB_STRIPE_SIZE - 1, SCRUB_STRIPE_SIZE) > MaxStripes))
+    {
+      continue;
+    }
+
+    Ranges[RangeCount].Base  = Descriptor->PhysicalStart;
+    Ranges[RangeCount].Pages = (UINTN)Descriptor->NumberOfPages;
+    Status                   = gBS->AllocatePages (
+                                      AllocateAddress,
+                                      EfiBootServicesData,
+                                      Ranges[RangeCount].Pages,
+                                      &Ranges[RangeCount].Base
+                                      );
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    for (Offset = 0; Offset < EFI_PAGES_TO_SIZE (Ranges[RangeCount].Pages); Offset += SCRUB_STRIPE_SIZE) {
+      Stripes[StripeCount].Base   = Ranges[RangeCount].Base + Offset;
+      Stripes[StripeCount].Length = MIN (SCRUB_STRIPE_SIZE, EFI_PAGES_TO_SIZE (Ranges[RangeCount].Pages) - Offset);
+      StripeCount++;
+    }
+
+    RangeCount++;
+  }
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < StripeCount; Index++) {
+    if ((WorkQueue == NULL) || EFI_ERROR (WorkQueue->Submit (WorkQueue, ScrubStripe, &Stripes[Index]))) {
+      ScrubStripe (&Stripes[Index]);
+    }
+  }
+
+  if (WorkQueue != NULL) {
+    WorkQueue->Wait (WorkQueue);
+  }
+
+  ScrubReport (Stripes, StripeCount, GetPerformanceCounter () - Start);
+
+  for (Index = 0; Index < RangeCount; Index++) {
+    gBS->FreePages (Ranges[Index].Base, Ranges[Index].Pages);
+  }
+
+#ifdef MEMORY_SCRUB_PATTERN_TEST
+  ScrubPublishFailures (Stripes, StripeCount);
+#endif
+
+Done:
+  if (Map != NULL) {
+    FreePool (Map);
+  }
+
+  if (Ranges != NULL) {
+    FreePool (Ranges);
+  }
+
+  if (Stripes != NULL) {
+    FreePool (Stripes);
+  }
+}
+
+/**
+  Arrange for free DRAM to be cleared at ReadyToBoot.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The ReadyToBoot event is registered.
+**/
+EFI_STATUS
+EFIAPI
+MemoryScrubDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  return EfiCreateEventReadyToBootEx (TPL_CALLBACK, ScrubReadyToBoot, NULL, &mReadyToBootEvent);
+}
@@ -0,0 +1,581 @@
+/** @file
+  PSCI based MP services of RPi5D.
+
+  The three secondary Cortex-A76 cores are started with PSCI CPU_ON at
+  load time. They enter with the boot core's translation tables, so they
+  see the same memory map, and then wait in WFE for work: a procedure of
+  StartupAllAPs or StartupThisAP, or items of the RPi5D work queue. At
+  ExitBootServices they power themselves off with PSCI CPU_OFF, so the
+  OS can start them again.
+
+  Only the blocking forms of StartupAllAPs and StartupThisAP are offered,
+  and timeouts are not enforced: a core cannot be stopped in the middle
+  of a procedure. The boot core cannot be switched and cores cannot be
+  disabled.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MpServicesDxe.h"
+
+//
+// How long a core may take to reach MpApMain after CPU_ON, and to power
+// off after ExitBootServices.
+//
+#define MP_AP_START_TIMEOUT_US  100000
+#define MP_AP_STOP_TIMEOUT_US   10000
+
+#define PSCI_AFFINITY_INFO_OFF  1
+
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, StackTop) == MP_AP_STACK_TOP, "MP_AP_STACK_TOP");
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, Mair) == MP_AP_MAIR, "MP_AP_MAIR");
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, Tcr) == MP_AP_TCR, "MP_AP_TCR");
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, Ttbr0) == MP_AP_TTBR0, "MP_AP_TTBR0");
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, Sctlr) == MP_AP_SCTLR, "MP_AP_SCTLR");
+STATIC_ASSERT (OFFSET_OF (MP_AP_CONTEXT, Vbar) == MP_AP_VBAR, "MP_AP_VBAR");
+
+MP_AP_CONTEXT     mMpContexts[RPI5D_CORE_COUNT];
+UINTN             mMpBootCore;
+volatile BOOLEAN  mMpStop;
+
+STATIC EFI_EVENT  mExitBootServicesEvent;
+
+/**
+  Whether a procedure may be started on a core.
+
+  @param  ProcessorNumber  Core position.
+
+  @retval EFI_SUCCESS            The core is idle.
+  @retval EFI_NOT_FOUND          No such core.
+  @retval EFI_INVALID_PARAMETER  The core is the boot core.
+  @retval EFI_NOT_READY          The core is busy.
+  @retval EFI_DEVICE_ERROR       The core did not start.
+**/
+STATIC
+EFI_STATUS
+MpCheckAp (
+  IN UINTN  ProcessorNumber
+  )
+{
+  if (ProcessorNumber >= RPI5D_CORE_COUNT) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (ProcessorNumber == mMpBootCore) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mMpContexts[ProcessorNumber].State != MpApIdle) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (mMpContexts[ProcessorNumber].Procedure != NULL) {
+    return EFI_NOT_READY;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Hand a procedure to an idle core.
+
+  @param  ProcessorNumber  Core position.
+  @param  Procedure        Function to run.
+  @param  Argument         Its argument.
+**/
+STATIC
+VOID
+MpDispatch (
+  IN UINTN             ProcessorNumber,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  mMpContexts[ProcessorNumber].Argument = Argument;
+  MemoryFence ();
+  mMpContexts[ProcessorNumber].Procedure = Procedure;
+  ArmDataSynchronizationBarrier ();
+  ArmCallSEV ();
+}
+
+/**
+  Wait until a core has returned from its procedure.
+
+  @param  ProcessorNumber  Core position.
+**/
+STATIC
+VOID
+MpWaitAp (
+  IN UINTN  ProcessorNumber
+  )
+{
+  while (mMpContexts[ProcessorNumber].Procedure != NULL) {
+    CpuPause ();
+  }
+
+  MemoryFence ();
+}
+
+/**
+  Return the number of cores, and how many of them are running.
+
+  @param  This                     The MP services protocol.
+  @param  NumberOfProcessors       All cores.
+  @param  NumberOfEnabledProcessors  The boot core and the started cores.
+
+  @retval EFI_SUCCESS            Counts returned.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpGetNumberOfProcessors (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *NumberOfProcessors,
+  OUT UINTN                     *NumberOfEnabledProcessors
+  )
+{
+  if ((NumberOfProcessors == NULL) || (NumberOfEnabledProcessors == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (RPI5D_CORE_POSITION (ArmReadMpidr ()) != mMpBootCore) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  *NumberOfProcessors        = RPI5D_CORE_COUNT;
+  *NumberOfEnabledProcessors = mMpWorkQueue.Workers;
+  return EFI_SUCCESS;
+}
+
+/**
+  Describe one core.
+
+  @param  This                  The MP services protocol.
+  @param  ProcessorNumber       Core position, with CPU_V2_EXTENDED_TOPOLOGY
+                                to fill in ExtendedInformation too.
+  @param  ProcessorInfoBuffer   Description of the core.
+
+  @retval EFI_SUCCESS            Description returned.
+  @retval EFI_INVALID_PARAMETER  ProcessorInfoBuffer is NULL.
+  @retval EFI_NOT_FOUND          No such core.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpGetProcessorInfo (
+  IN  EFI_MP_SERVICES_PROTOCOL   *This,
+  IN  UINTN                      ProcessorNumber,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfoBuffer
+  )
+{
+  UINTN  Position;
+
+  if (ProcessorInfoBuffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (RPI5D_CORE_POSITION (ArmReadMpidr ()) != mMpBootCore) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Position = ProcessorNumber & ~(UINTN)CPU_V2_EXTENDED_TOPOLOGY;
+  if (Position >= RPI5D_CORE_COUNT) {
+    return EFI_NOT_FOUND;
+  }
+
+  ProcessorInfoBuffer->ProcessorId = mMpContexts[Position].MpId;
+  ProcessorInfoBuffer->StatusFlag  = PROCESSOR_HEALTH_STATUS_BIT;
+  if (Position == mMpBootCore) {
+    ProcessorInfoBuffer->StatusFlag |= PROCESSOR_AS_BSP_BIT | PROCESSOR_ENABLED_BIT;
+  } else if (mMpContexts[Position].State == MpApIdle) {
+    ProcessorInfoBuffer->StatusFlag |= PROCESSOR_ENABLED_BIT;
+  }
+
+  ProcessorInfoBuffer->Location.Package = 0;
+  ProcessorInfoBuffer->Location.Core    = (UINT32)Position;
+  ProcessorInfoBuffer->Location.Thread  = 0;
+
+  if ((ProcessorNumber & CPU_V2_EXTENDED_TOPOLOGY) != 0) {
+    ZeroMem (&ProcessorInfoBuffer->ExtendedInformation, sizeof (ProcessorInfoBuffer->ExtendedInformation));
+    ProcessorInfoBuffer->ExtendedInformation.Location2.Core = (UINT32)Position;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run a procedure on every started secondary core, at once or one after
+  the other, and wait for it to finish.
+
+  @param  This                    The MP services protocol.
+  @param  Procedure               Function to run.
+  @param  SingleThread            TRUE to run it on one core at a time.
+  @param  WaitEvent               Must be NULL: only blocking mode is offered.
+  @param  TimeoutInMicroSeconds   Not enforced.
+  @param  ProcedureArgument       Argument of Procedure.
+  @param  FailedCpuList           Set to NULL: a started core does not fail.
+
+  @retval EFI_SUCCESS            Every core ran the procedure.
+  @retval EFI_UNSUPPORTED        WaitEvent is not NULL.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core.
+  @retval EFI_NOT_STARTED        No secondary core is running.
+  @retval EFI_NOT_READY          A secondary core is busy.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpStartupAllAPs (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  BOOLEAN                   SingleThread,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroSeconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT UINTN                     **FailedCpuList         OPTIONAL
+  )
+{
+  UINTN       Index;
+  UINTN       Started;
+  EFI_STATUS  Status;
+
+  if (FailedCpuList != NULL) {
+    *FailedCpuList = NULL;
+  }
+
+  if (WaitEvent != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (RPI5D_CORE_POSITION (ArmReadMpidr ()) != mMpBootCore) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Started = 0;
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    Status = MpCheckAp (Index);
+    if (Status == EFI_NOT_READY) {
+      return EFI_NOT_READY;
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Started++;
+    }
+  }
+
+  if (Started == 0) {
+    return EFI_NOT_STARTED;
+  }
+
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    if (!EFI_ERROR (MpCheckAp (Index))) {
+      MpDispatch (Index, Procedure, ProcedureArgument);
+      if (SingleThread) {
+        MpWaitAp (Index);
+      }
+    }
+  }
+
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    if ((Index != mMpBootCore) && (mMpContexts[Index].State == MpApIdle)) {
+      MpWaitAp (Index);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run a procedure on one secondary core and wait for it to finish.
+
+  @param  This                    The MP services protocol.
+  @param  Procedure               Function to run.
+  @param  ProcessorNumber         Core position.
+  @param  WaitEvent               Must be NULL: only blocking mode is offered.
+  @param  TimeoutInMicroSeconds   Not enforced.
+  @param  ProcedureArgument       Argument of Procedure.
+  @param  Finished                Not used in blocking mode.
+
+  @retval EFI_SUCCESS            The core ran the procedure.
+  @retval EFI_UNSUPPORTED        WaitEvent is not NULL.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL or the core is the boot core.
+  @retval EFI_NOT_FOUND          No such core.
+  @retval EFI_NOT_READY          The core is busy.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core, or the core did
+                                 not start.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpStartupThisAP (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  UINTN                     ProcessorNumber,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroseconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT BOOLEAN                   *Finished               OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+
+  if (WaitEvent != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (RPI5D_CORE_POSITION (ArmReadMpidr ()) != mMpBootCore) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = MpCheckAp (ProcessorNumber);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  MpDispatch (ProcessorNumber, Procedure, ProcedureArgument);
+  MpWaitAp (ProcessorNumber);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Switching the boot core is not supported.
+
+  @retval EFI_UNSUPPORTED   Always.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpSwitchBSP (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  IN UINTN                     ProcessorNumber,
+  IN BOOLEAN                   EnableOldBSP
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Disabling cores is not supported.
+
+  @retval EFI_UNSUPPORTED   Always.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpEnableDisableAP (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  IN UINTN                     ProcessorNumber,
+  IN BOOLEAN                   EnableAP,
+  IN UINT32                    *HealthFlag OPTIONAL
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Return the position of the calling core.
+
+  @param  This              The MP services protocol.
+  @param  ProcessorNumber   Position of the calling core.
+
+  @retval EFI_SUCCESS            Position returned.
+  @retval EFI_INVALID_PARAMETER  ProcessorNumber is NULL.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpWhoAmI (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *ProcessorNumber
+  )
+{
+  if (ProcessorNumber == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *ProcessorNumber = RPI5D_CORE_POSITION (ArmReadMpidr ());
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_MP_SERVICES_PROTOCOL  mMpServices = {
+  MpGetNumberOfProcessors,
+  MpGetProcessorInfo,
+  MpStartupAllAPs,
+  MpStartupThisAP,
+  MpSwitchBSP,
+  MpEnableDisableAP,
+  MpWhoAmI
+};
+
+/**
+  Power a secondary core on and wait for it to reach MpApMain.
+
+  @param  Position      Core position.
+
+  @retval EFI_SUCCESS           The core is waiting for work.
+  @retval EFI_OUT_OF_RESOURCES  No memory for its stack.
+  @retval EFI_DEVICE_ERROR      PSCI refused, or the core did not arrive.
+**/
+STATIC
+EFI_STATUS
+MpStartAp (
+  IN UINTN  Position
+  )
+{
+  MP_AP_CONTEXT  *Context;
+  VOID           *Stack;
+  ARM_SMC_ARGS   Args;
+  UINTN          Waited;
+
+  Context = &mMpContexts[Position];
+  Stack   = AllocatePages (EFI_SIZE_TO_PAGES (MP_AP_STACK_SIZE));
+  if (Stack == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Context->StackTop = (UINTN)Stack + MP_AP_STACK_SIZE;
+  MpSaveTranslationRegime (Context);
+  WriteBackDataCacheRange (Context, sizeof (*Context));
+
+  ZeroMem (&Args, sizeof (Args));
+  Args.Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
+  Args.Arg1 = (UINTN)Context->MpId;
+  Args.Arg2 = (UINTN)MpApEntry;
+  Args.Arg3 = (UINTN)Context;
+  ArmCallSmc (&Args);
+  if (Args.Arg0 != ARM_SMC_PSCI_RET_SUCCESS) {
+    DEBUG ((DEBUG_ERROR, "RPi5D MpServices: CPU_ON of core %u failed (%d)\n", (UINT32)Position, (INT32)Args.Arg0));
+    FreePages (Stack, EFI_SIZE_TO_PAGES (MP_AP_STACK_SIZE));
+    return EFI_DEVICE_ERROR;
+  }
+
+  for (Waited = 0; Context->State != MpApIdle; Waited += 10) {
+    if (Waited >= MP_AP_START_TIMEOUT_US) {
+      DEBUG ((DEBUG_ERROR, "RPi5D MpServices: Core %u did not start\n", (UINT32)Position));
+      return EFI_DEVICE_ERROR;
+    }
+
+    MicroSecondDelay (10);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Power the secondary cores off so the OS can start them with PSCI.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+MpExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  ARM_SMC_ARGS  Args;
+  UINTN         Index;
+  UINTN         Waited;
+
+  mMpStop = TRUE;
+  ArmDataSynchronizationBarrier ();
+  ArmCallSEV ();
+
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    if ((Index == mMpBootCore) || (mMpContexts[Index].State == MpApOff)) {
+      continue;
+    }
+
+    for (Waited = 0; Waited < MP_AP_STOP_TIMEOUT_US; Waited += 10) {
+      ZeroMem (&Args, sizeof (Args));
+      Args.Arg0 = ARM_SMC_ID_PSCI_AFFINITY_INFO_AARCH64;
+      Args.Arg1 = (UINTN)mMpContexts[Index].MpId;
+      ArmCallSmc (&Args);
+      if (Args.Arg0 == PSCI_AFFINITY_INFO_OFF) {
+        break;
+      }
+
+      MicroSecondDelay (10);
+    }
+
+    mMpContexts[Index].State = MpApOff;
+  }
+}
+
+/**
+  Start the secondary cores and install the MP services and work queue
+  protocols.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   Protocols installed, with or without secondary cores.
+  @retval other         The protocols could not be installed.
+**/
+EFI_STATUS
+EFIAPI
+MpServicesDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  STATIC EFI_GUID  WorkQueueGuid = RPI5D_WORK_QUEUE_PROTOCOL_GUID;
+  EFI_STATUS       Status;
+  UINT64           MpId;
+  UINTN            Index;
+
+  MpId        = ArmReadMpidr ();
+  mMpBootCore = RPI5D_CORE_POSITION (MpId);
+
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    mMpContexts[Index].MpId = (MpId & RPI5D_MPIDR_AFFINITY & ~(UINT64)RPI5D_MPIDR_CORE_MASK) |
+                              LShiftU64 (Index, RPI5D_MPIDR_CORE_SHIFT);
+    mMpContexts[Index].State = MpApOff;
+  }
+
+  mMpContexts[mMpBootCore].State = MpApIdle;
+
+  for (Index = 0; Index < RPI5D_CORE_COUNT; Index++) {
+    if ((Index != mMpBootCore) && !EFI_ERROR (MpStartAp (Index))) {
+      mMpWorkQueue.Workers++;
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "RPi5D MpServices: %u of %u cores running\n", (UINT32)mMpWorkQueue.Workers, RPI5D_CORE_COUNT));
+
+  if (mMpWorkQueue.Workers > 1) {
+    Status = gBS->CreateEvent (
+                    EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                    TPL_NOTIFY,
+                    MpExitBootServices,
+                    NULL,
+                    &mExitBootServicesEvent
+                    );
+    ASSERT_EFI_ERROR (Status);
+  }
+
+  return gBS->InstallMultipleProtocolInterfaces (
+                &ImageHandle,
+                &gEfiMpServiceProtocolGuid,
+                &mMpServices,
+                &WorkQueueGuid,
+                &mMpWorkQueue,
+                NULL
+                );
+}
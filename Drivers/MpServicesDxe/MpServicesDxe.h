@@ -0,0 +1,137 @@
+/** @file
+  PSCI based MP services of RPi5D.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MP_SERVICES_DXE_H_
+#define MP_SERVICES_DXE_H_
+
+#include <Uefi.h>
+#include <IndustryStandard/ArmStdSmc.h>
+#include <Protocol/MpService.h>
+#include <Library/ArmLib.h>
+#include <Library/ArmSmcLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include "../../Include/Platform/RPi5D.h"
+#include "../../Include/Protocol/RPi5DWorkQueue.h"
+
+//
+// Stack of each secondary core
+//
+#define MP_AP_STACK_SIZE  SIZE_16KB
+
+//
+// Work items in flight; a power of two.
+//
+#define MP_WORK_QUEUE_SIZE  64
+
+typedef enum {
+  MpApOff,          // not started, or failed to start
+  MpApIdle,         // waiting for work
+  MpApStopping      // ExitBootServices: about to call PSCI CPU_OFF
+} MP_AP_STATE;
+
+//
+// Per-core context, handed to PSCI CPU_ON. The first fields are read by
+// MpApEntry with the MMU off and must stay in step with the MP_AP_*
+// offsets of AArch64/MpEntry.S.
+//
+typedef struct {
+  UINT64                       StackTop;
+  UINT64                       Mair;
+  UINT64                       Tcr;
+  UINT64                       Ttbr0;
+  UINT64                       Sctlr;
+  UINT64                       Vbar;
+  UINT64                       MpId;
+  volatile UINT32              State;
+  //
+  // StartupAllAPs and StartupThisAP: set Argument, then Procedure; the
+  // core clears Procedure when it returns.
+  //
+  volatile EFI_AP_PROCEDURE    Procedure;
+  VOID *volatile               Argument;
+} MP_AP_CONTEXT;
+
+#define MP_AP_STACK_TOP  0x00
+#define MP_AP_MAIR       0x08
+#define MP_AP_TCR        0x10
+#define MP_AP_TTBR0      0x18
+#define MP_AP_SCTLR      0x20
+#define MP_AP_VBAR       0x28
+
+//
+// MpServicesDxe.c
+//
+extern MP_AP_CONTEXT     mMpContexts[RPI5D_CORE_COUNT];
+extern UINTN             mMpBootCore;
+extern volatile BOOLEAN  mMpStop;
+
+//
+// AArch64/MpEntry.S
+//
+
+/**
+  Entry point of a secondary core started by PSCI CPU_ON: load the boot
+  core's translation regime and vectors, switch to the core's stack and
+  run MpApMain. x0 is the MP_AP_CONTEXT.
+**/
+VOID
+EFIAPI
+MpApEntry (
+  VOID
+  );
+
+/**
+  Record the translation regime and vectors of the running core in the
+  MMU fields of Context.
+
+  @param  Context       Context of a core about to be started.
+**/
+VOID
+EFIAPI
+MpSaveTranslationRegime (
+  OUT MP_AP_CONTEXT  *Context
+  );
+
+//
+// MpWorkQueue.c
+//
+
+extern RPI5D_WORK_QUEUE_PROTOCOL  mMpWorkQueue;
+
+/**
+  Claim and run one queued work item.
+
+  @retval TRUE          An item was run.
+  @retval FALSE         The queue was empty.
+**/
+BOOLEAN
+MpWorkQueueRunOne (
+  VOID
+  );
+
+/**
+  Main loop of a secondary core: run its StartupAllAPs or StartupThisAP
+  procedure, then queued work, and sleep in WFE when there is neither.
+  At ExitBootServices the core powers itself off.
+
+  @param  Context       Context of this core.
+**/
+VOID
+EFIAPI
+MpApMain (
+  IN MP_AP_CONTEXT  *Context
+  );
+
+#endif
@@ -0,0 +1,188 @@
+/** @file
+  Lock-free work queue run by the RPi5D secondary cores.
+
+  The boot core is the only producer: it fills a slot and then publishes
+  it by advancing mQueueHead. Every core is a consumer: it copies the slot
+  at mQueueTail and claims it by moving mQueueTail on with a compare and
+  exchange; a core that loses the race drops its copy and tries again.
+  Slots are reused only once mQueueTail has passed them, so a claimed
+  copy is never overwritten. mQueueDone counts items that have returned.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MpServicesDxe.h"
+
+typedef struct {
+  EFI_AP_PROCEDURE    Procedure;
+  VOID                *Argument;
+} MP_WORK_ITEM;
+
+STATIC MP_WORK_ITEM     mQueue[MP_WORK_QUEUE_SIZE];
+STATIC volatile UINT32  mQueueHead;
+STATIC volatile UINT32  mQueueTail;
+STATIC volatile UINT32  mQueueDone;
+
+/**
+  Claim and run one queued work item.
+
+  @retval TRUE          An item was run.
+  @retval FALSE         The queue was empty.
+**/
+BOOLEAN
+MpWorkQueueRunOne (
+  VOID
+  )
+{
+  MP_WORK_ITEM  Item;
+  UINT32        Tail;
+
+  do {
+    Tail = mQueueTail;
+    MemoryFence ();
+    if (Tail == mQueueHead) {
+      return FALSE;
+    }
+
+    //
+    // Read the slot only after seeing it published; without the fence
+    // the slot load may be satisfied before the head load.
+    //
+    MemoryFence ();
+    Item = mQueue[Tail & (MP_WORK_QUEUE_SIZE - 1)];
+  } while (InterlockedCompareExchange32 (&mQueueTail, Tail, Tail + 1) != Tail);
+
+  Item.Procedure (Item.Argument);
+
+  MemoryFence ();
+  InterlockedIncrement (&mQueueDone);
+  return TRUE;
+}
+
+/**
+  Queue one work item. Only the boot core submits. When the queue is
+  full the boot core runs queued items until there is room.
+
+  @param  This          The work queue.
+  @param  Procedure     Function to run on some core.
+  @param  Argument      Its argument.
+
+  @retval EFI_SUCCESS            The item is queued.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MpWorkQueueSubmit (
+  IN RPI5D_WORK_QUEUE_PROTOCOL  *This,
+  IN EFI_AP_PROCEDURE           Procedure,
+  IN VOID                       *Argument
+  )
+{
+  UINT32  Head;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (RPI5D_CORE_POSITION (ArmReadMpidr ()) != mMpBootCore) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Head = mQueueHead;
+  while (Head - mQueueTail == MP_WORK_QUEUE_SIZE) {
+    MpWorkQueueRunOne ();
+  }
+
+  mQueue[Head & (MP_WORK_QUEUE_SIZE - 1)].Procedure = Procedure;
+  mQueue[Head & (MP_WORK_QUEUE_SIZE - 1)].Argument  = Argument;
+  MemoryFence ();
+  mQueueHead = Head + 1;
+  ArmDataSynchronizationBarrier ();
+  ArmCallSEV ();
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run queued items on the boot core too, and return once every item
+  submitted so far has finished.
+
+  @param  This          The work queue.
+**/
+STATIC
+VOID
+EFIAPI
+MpWorkQueueWait (
+  IN RPI5D_WORK_QUEUE_PROTOCOL  *This
+  )
+{
+  while (MpWorkQueueRunOne ()) {
+  }
+
+  while (mQueueDone != mQueueHead) {
+    CpuPause ();
+  }
+
+  MemoryFence ();
+}
+
+RPI5D_WORK_QUEUE_PROTOCOL  mMpWorkQueue = {
+  1,
+  MpWorkQueueSubmit,
+  MpWorkQueueWait
+};
+
+/**
+  Main loop of a secondary core: run its StartupAllAPs or StartupThisAP
+  procedure, then queued work, and sleep in WFE when there is neither.
+  At ExitBootServices the core powers itself off.
+
+  @param  Context       Context of this core.
+**/
+VOID
+EFIAPI
+MpApMain (
+  IN MP_AP_CONTEXT  *Context
+  )
+{
+  EFI_AP_PROCEDURE  Procedure;
+  ARM_SMC_ARGS      Args;
+
+  Context->State = MpApIdle;
+  ArmDataSynchronizationBarrier ();
+  ArmCallSEV ();
+
+  for ( ; ; ) {
+    Procedure = Context->Procedure;
+    if (Procedure != NULL) {
+      MemoryFence ();
+      Procedure (Context->Argument);
+      MemoryFence ();
+      Context->Procedure = NULL;
+      ArmDataSynchronizationBarrier ();
+      ArmCallSEV ();
+      continue;
+    }
+
+    if (MpWorkQueueRunOne ()) {
+      continue;
+    }
+
+    if (mMpStop) {
+      break;
+    }
+
+    ArmCallWFE ();
+  }
+
+  Context->State = MpApStopping;
+  ArmDataSynchronizationBarrier ();
+
+  ZeroMem (&Args, sizeof (Args));
+  Args.Arg0 = ARM_SMC_ID_PSCI_CPU_OFF;
+  ArmCallSmc (&Args);
+}
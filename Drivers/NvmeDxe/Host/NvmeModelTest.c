@@ -0,0 +1,1011 @@
+/** @file
+  Host test of the NvmeDxe queue engine against a software controller.
+
+  NvmeController.c and NvmeQueue.c are built unchanged on top of a model
+  of an NVMe controller: registers, admin and I/O queue pairs fetched on
+  doorbell writes, PRP and SGL data pointers, and a namespace held in
+  memory. Each scenario configures the model (transfer size, SGL
+  support, queue depth, queues granted) and checks the data that lands
+  on the disk and back, the doorbell writes per command, and that every
+  slot and mapping is returned.
+
+    cd Drivers/NvmeDxe
+    cc -O2 -IHost -I../../Host -o NvmeModelTest NvmeController.c NvmeQueue.c Host/NvmeModelTest.c ../../Host/HostTest.c
+    ./NvmeModelTest
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HostTest.h"
+
+#include "../NvmeHc.h"
+
+#define MODEL_BASE        0x100000000ULL
+#define MODEL_QUEUES      16
+#define MODEL_PENDING     1024
+
+//
+// Status codes the model completes with
+//
+#define SC_INVALID_OPCODE  0x01
+#define SC_INVALID_FIELD   0x02
+#define SC_INTERNAL        0x06
+#define SC_LBA_RANGE       0x80
+
+typedef struct {
+  BOOLEAN    Valid;
+  UINT64     Base;
+  UINT16     Size;
+  UINT16     Head;
+  UINT16     Tail;
+  UINT8      Phase;
+  UINT16     CqId;
+} MODEL_RING;
+
+typedef struct {
+  UINT16      CqId;
+  NVME_CQE    Entry;
+} MODEL_PENDING_CQE;
+
+typedef struct {
+  //
+  // Configuration
+  //
+  UINT16               Mqes;
+  UINT8                Mdts;
+  UINT32               Sgls;
+  UINT32               MaxQueues;
+  UINT8                BlockShift;
+  UINT64               Blocks;
+  BOOLEAN              Hold;              // keep completions until ModelRelease
+  UINT64               FailLba;           // a read or write covering it fails
+
+  //
+  // Registers and queues
+  //
+  UINT32               Cc;
+  UINT32               Csts;
+  UINT32               Aqa;
+  UINT64               Asq;
+  UINT64               Acq;
+  UINT32               Granted;
+  MODEL_RING           Sq[MODEL_QUEUES + 1];
+  MODEL_RING           Cq[MODEL_QUEUES + 1];
+  UINT8                *Disk;
+  MODEL_PENDING_CQE    Pending[MODEL_PENDING];
+  UINTN                PendingCount;
+
+  //
+  // Counters
+  //
+  UINT64               IoDoorbells;       // SQ tail writes on I/O queues
+  UINT64               IoCqDoorbells;     // CQ head writes on I/O queues
+  UINT64               IoCommands;
+  UINT64               SglCommands;
+  UINT64               PrpCommands;
+  UINT64               PrpListCommands;
+  UINT64               Flushes;
+  UINT64               Violations;        // protocol errors by the host
+  UINT64               Maps;
+  UINT64               Unmaps;
+  UINT64               Ticks;
+} MODEL;
+
+STATIC MODEL  mModel;
+
+STATIC
+VOID
+ModelViolation (
+  IN CONST char  *Message
+  )
+{
+  printf ("  model: %s\n", Message);
+  mModel.Violations++;
+}
+
+//
+// Services of the platform the engine runs on
+//
+
+//
+// Every read of the clock moves it on by a microsecond, so the engine's
+// deadline loops end without waiting.
+//
+UINT64
+HostModelTime (
+  VOID
+  )
+{
+  return mModel.Ticks++ * 1000;
+}
+
+VOID
+HostModelDelay (
+  IN UINT64  Nanoseconds
+  )
+{
+  mModel.Ticks += Nanoseconds / 1000;
+}
+
+VOID *
+WriteBackDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+InvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+STATIC
+EFI_STATUS
+HostMap (
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL            *This,
+  IN     EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION  Operation,
+  IN     VOID                                       *HostAddress,
+  IN OUT UINTN                                      *NumberOfBytes,
+  OUT    EFI_PHYSICAL_ADDRESS                       *DeviceAddress,
+  OUT    VOID                                       **Mapping
+  )
+{
+  *DeviceAddress = (UINTN)HostAddress;
+  *Mapping       = HostAddress;
+  mModel.Maps++;
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+HostUnmap (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN VOID                             *Mapping
+  )
+{
+  mModel.Unmaps++;
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+HostAllocateBuffer (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN  EFI_ALLOCATE_TYPE                Type,
+  IN  EFI_MEMORY_TYPE                  MemoryType,
+  IN  UINTN                            Pages,
+  OUT VOID                             **HostAddress,
+  IN  UINT64                           Attributes
+  )
+{
+  *HostAddress = aligned_alloc (EFI_PAGE_SIZE, EFI_PAGES_TO_SIZE (Pages));
+  return (*HostAddress == NULL) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+HostFreeBuffer (
+  IN EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+  IN UINTN                            Pages,
+  IN VOID                             *HostAddress
+  )
+{
+  free (HostAddress);
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  mRootBridgeIo = {
+  HostMap,
+  HostUnmap,
+  HostAllocateBuffer,
+  HostFreeBuffer
+};
+
+//
+// Controller model
+//
+
+STATIC
+VOID
+ModelPost (
+  IN UINT16    CqId,
+  IN NVME_CQE  *Entry
+  )
+{
+  MODEL_RING  *Cq;
+
+  Cq = &mModel.Cq[CqId];
+  if ((UINT16)((Cq->Tail + 1) % Cq->Size) == Cq->Head) {
+    ModelViolation ("completion queue overflow");
+    return;
+  }
+
+  Entry->Status = (UINT16)((Entry->Status & ~NVME_CQE_PHASE) | Cq->Phase);
+  memcpy ((NVME_CQE *)(UINTN)Cq->Base + Cq->Tail, Entry, sizeof (NVME_CQE));
+  Cq->Tail++;
+  if (Cq->Tail == Cq->Size) {
+    Cq->Tail   = 0;
+    Cq->Phase ^= 1;
+  }
+}
+
+STATIC
+VOID
+ModelRelease (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mModel.PendingCount; Index++) {
+    ModelPost (mModel.Pending[Index].CqId, &mModel.Pending[Index].Entry);
+  }
+
+  mModel.PendingCount = 0;
+}
+
+STATIC
+VOID
+ModelCopy (
+  IN UINT8    *Memory,
+  IN UINT8    *Device,
+  IN UINTN    Bytes,
+  IN BOOLEAN  ToDevice
+  )
+{
+  if (ToDevice) {
+    memcpy (Device, Memory, Bytes);
+  } else {
+    memcpy (Memory, Device, Bytes);
+  }
+}
+
+/**
+  Move command data between memory and Device, following the command's
+  SGL data block or PRPs.
+
+  @return TRUE when the data pointer was valid.
+**/
+STATIC
+BOOLEAN
+ModelTransfer (
+  IN NVME_SQE  *Command,
+  IN UINT8     *Device,
+  IN UINTN     Bytes,
+  IN BOOLEAN   ToDevice,
+  IN BOOLEAN   Admin
+  )
+{
+  NVME_SGL_DESCRIPTOR  *Sgl;
+  UINT64               *List;
+  UINTN                Chunk;
+  UINT64               Entry;
+
+  if ((Command->Flags & NVME_FLAGS_PSDT_MASK) == NVME_FLAGS_PSDT_SGL) {
+    Sgl = (NVME_SGL_DESCRIPTOR *)Command->Dptr;
+    if (Admin || ((mModel.Sgls & NVME_SGLS_SUPPORTED_MASK) == 0)) {
+      ModelViolation ("SGL where only PRPs are allowed");
+      return FALSE;
+    }
+
+    if ((Sgl->Identifier != NVME_SGL_DATA_BLOCK) || (Sgl->Length != Bytes) || ((Sgl->Address & 3) != 0)) {
+      ModelViolation ("bad SGL data block descriptor");
+      return FALSE;
+    }
+
+    mModel.SglCommands++;
+    ModelCopy ((UINT8 *)(UINTN)Sgl->Address, Device, Bytes, ToDevice);
+    return TRUE;
+  }
+
+  if ((Command->Flags & NVME_FLAGS_PSDT_MASK) != 0) {
+    ModelViolation ("reserved PSDT");
+    return FALSE;
+  }
+
+  if ((Command->Dptr[0] & 3) != 0) {
+    ModelViolation ("PRP1 not dword aligned");
+    return FALSE;
+  }
+
+  mModel.PrpCommands += Admin ? 0 : 1;
+  Chunk = MIN (Bytes, NVME_PAGE_SIZE - (UINTN)(Command->Dptr[0] & (NVME_PAGE_SIZE - 1)));
+  ModelCopy ((UINT8 *)(UINTN)Command->Dptr[0], Device, Chunk, ToDevice);
+  Device += Chunk;
+  Bytes  -= Chunk;
+  if (Bytes == 0) {
+    return TRUE;
+  }
+
+  if (Bytes <= NVME_PAGE_SIZE) {
+    if ((Command->Dptr[1] & (NVME_PAGE_SIZE - 1)) != 0) {
+      ModelViolation ("PRP2 not page aligned");
+      return FALSE;
+    }
+
+    ModelCopy ((UINT8 *)(UINTN)Command->Dptr[1], Device, Bytes, ToDevice);
+    return TRUE;
+  }
+
+  if (Admin) {
+    ModelViolation ("PRP list on an admin command");
+    return FALSE;
+  }
+
+  mModel.PrpListCommands++;
+  List = (UINT64 *)(UINTN)Command->Dptr[1];
+  while (Bytes > 0) {
+    Entry = *List;
+    if (((((UINTN)List) & (NVME_PAGE_SIZE - 1)) == NVME_PAGE_SIZE - sizeof (UINT64)) && (Bytes > NVME_PAGE_SIZE)) {
+      List = (UINT64 *)(UINTN)Entry;
+      continue;
+    }
+
+    if ((Entry & (NVME_PAGE_SIZE - 1)) != 0) {
+      ModelViolation ("PRP list entry not page aligned");
+      return FALSE;
+    }
+
+    Chunk = MIN (Bytes, NVME_PAGE_SIZE);
+    ModelCopy ((UINT8 *)(UINTN)Entry, Device, Chunk, ToDevice);
+    Device += Chunk;
+    Bytes  -= Chunk;
+    List++;
+  }
+
+  return TRUE;
+}
+
+STATIC
+UINT16
+ModelAdmin (
+  IN  NVME_SQE  *Command,
+  OUT UINT32    *Dw0
+  )
+{
+  NVME_IDENTIFY_CONTROLLER  Controller;
+  NVME_IDENTIFY_NAMESPACE   Namespace;
+  UINT16                    QueueId;
+  UINT16                    Size;
+  UINT32                    Wanted;
+
+  switch (Command->Opcode) {
+    case NVME_ADMIN_IDENTIFY:
+      if (Command->Cdw10 == NVME_CNS_CONTROLLER) {
+        memset (&Controller, 0, sizeof (Controller));
+        memcpy (Controller.Mn, "Model NVMe", 10);
+        Controller.Mdts = mModel.Mdts;
+        Controller.Nn   = 2;
+        Controller.Vwc  = 1;
+        Controller.Sgls = mModel.Sgls;
+        return ModelTransfer (Command, (UINT8 *)&Controller, sizeof (Controller), FALSE, TRUE) ? 0 : SC_INVALID_FIELD;
+      }
+
+      //
+      // Namespace 1 is the disk; namespace 2 is formatted with metadata.
+      //
+      memset (&Namespace, 0, sizeof (Namespace));
+      if ((Command->Nsid == 1) || (Command->Nsid == 2)) {
+        Namespace.Nsze           = mModel.Blocks;
+        Namespace.Ncap           = mModel.Blocks;
+        Namespace.Eui64          = 0x0011223344556677ULL;
+        Namespace.Lbaf[0].Lbads  = mModel.BlockShift;
+        Namespace.Lbaf[0].Ms     = (Command->Nsid == 2) ? 8 : 0;
+      }
+
+      return ModelTransfer (Command, (UINT8 *)&Namespace, sizeof (Namespace), FALSE, TRUE) ? 0 : SC_INVALID_FIELD;
+
+    case NVME_ADMIN_SET_FEATURES:
+      if ((Command->Cdw10 & 0xFF) != NVME_FEATURE_QUEUES) {
+        return SC_INVALID_FIELD;
+      }
+
+      Wanted         = MIN ((Command->Cdw11 & 0xFFFF), (Command->Cdw11 >> 16)) + 1;
+      mModel.Granted = MIN (Wanted, mModel.MaxQueues);
+      *Dw0           = ((mModel.Granted - 1) << 16) | (mModel.Granted - 1);
+      return 0;
+
+    case NVME_ADMIN_CREATE_IO_CQ:
+    case NVME_ADMIN_CREATE_IO_SQ:
+      QueueId = (UINT16)Command->Cdw10;
+      Size    = (UINT16)((Command->Cdw10 >> 16) + 1);
+      if ((QueueId == 0) || (QueueId > mModel.Granted) || (Size > mModel.Mqes + 1) || ((Command->Cdw11 & BIT0) == 0)) {
+        ModelViolation ("bad queue creation");
+        return SC_INVALID_FIELD;
+      }
+
+      if ((Command->Dptr[0] & (NVME_PAGE_SIZE - 1)) != 0) {
+        ModelViolation ("queue not page aligned");
+        return SC_INVALID_FIELD;
+      }
+
+      if (Command->Opcode == NVME_ADMIN_CREATE_IO_CQ) {
+        mModel.Cq[QueueId] = (MODEL_RING){ TRUE, Command->Dptr[0], Size, 0, 0, 1, 0 };
+      } else {
+        if (!mModel.Cq[Command->Cdw11 >> 16].Valid) {
+          ModelViolation ("SQ created before its CQ");
+          return SC_INVALID_FIELD;
+        }
+
+        mModel.Sq[QueueId] = (MODEL_RING){ TRUE, Command->Dptr[0], Size, 0, 0, 0, (UINT16)(Command->Cdw11 >> 16) };
+      }
+
+      return 0;
+
+    default:
+      return SC_INVALID_OPCODE;
+  }
+}
+
+STATIC
+UINT16
+ModelIo (
+  IN NVME_SQE  *Command
+  )
+{
+  UINT64  Lba;
+  UINT64  Blocks;
+  UINTN   Bytes;
+  UINTN   Limit;
+
+  mModel.IoCommands++;
+  if (Command->Nsid != 1) {
+    ModelViolation ("I/O to a namespace the host should not use");
+    return SC_INVALID_FIELD;
+  }
+
+  if (Command->Opcode == NVME_IO_FLUSH) {
+    mModel.Flushes++;
+    return 0;
+  }
+
+  if ((Command->Opcode != NVME_IO_READ) && (Command->Opcode != NVME_IO_WRITE)) {
+    return SC_INVALID_OPCODE;
+  }
+
+  Lba    = ((UINT64)Command->Cdw11 << 32) | Command->Cdw10;
+  Blocks = (Command->Cdw12 & 0xFFFF) + 1;
+  Bytes  = (UINTN)(Blocks << mModel.BlockShift);
+  Limit  = (mModel.Mdts == 0) ? (UINTN)MAX_UINT32 : (UINTN)(NVME_PAGE_SIZE << mModel.Mdts);
+  if (Bytes > Limit) {
+    ModelViolation ("transfer above MDTS");
+    return SC_INVALID_FIELD;
+  }
+
+  if ((Lba >= mModel.Blocks) || (Blocks > mModel.Blocks - Lba)) {
+    return SC_LBA_RANGE;
+  }
+
+  if ((mModel.FailLba >= Lba) && (mModel.FailLba < Lba + Blocks)) {
+    return SC_INTERNAL;
+  }
+
+  return ModelTransfer (
+           Command,
+           mModel.Disk + (Lba << mModel.BlockShift),
+           Bytes,
+           (BOOLEAN)(Command->Opcode == NVME_IO_WRITE),
+           FALSE
+           ) ? 0 : SC_INVALID_FIELD;
+}
+
+/**
+  Fetch and execute what the host queued up to the new tail.
+**/
+STATIC
+VOID
+ModelRing (
+  IN UINT16  QueueId,
+  IN UINT16  Tail
+  )
+{
+  MODEL_RING  *Sq;
+  NVME_SQE    Command;
+  NVME_CQE    Entry;
+  UINT16      Status;
+
+  Sq = &mModel.Sq[QueueId];
+  if (!Sq->Valid || (Tail >= Sq->Size)) {
+    ModelViolation ("doorbell of a queue that does not exist");
+    return;
+  }
+
+  Sq->Tail = Tail;
+  while (Sq->Head != Sq->Tail) {
+    memcpy (&Command, (NVME_SQE *)(UINTN)Sq->Base + Sq->Head, sizeof (Command));
+    Sq->Head = (UINT16)((Sq->Head + 1) % Sq->Size);
+
+    memset (&Entry, 0, sizeof (Entry));
+    Status       = (QueueId == 0) ? ModelAdmin (&Command, &Entry.Dw0) : ModelIo (&Command);
+    Entry.SqHead = Sq->Head;
+    Entry.SqId   = QueueId;
+    Entry.Cid    = Command.Cid;
+    Entry.Status = (UINT16)(Status << 1);
+
+    if (mModel.Hold && (QueueId != 0)) {
+      mModel.Pending[mModel.PendingCount].CqId  = Sq->CqId;
+      mModel.Pending[mModel.PendingCount].Entry = Entry;
+      mModel.PendingCount++;
+    } else {
+      ModelPost (Sq->CqId, &Entry);
+    }
+  }
+}
+
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  )
+{
+  switch (Address - MODEL_BASE) {
+    case NVME_VS:   return 0x00010400;
+    case NVME_CC:   return mModel.Cc;
+    case NVME_CSTS: return mModel.Csts;
+    case NVME_AQA:  return mModel.Aqa;
+    default:        return 0;
+  }
+}
+
+UINT64
+EFIAPI
+PlatformMmioRead64 (
+  IN UINTN  Address
+  )
+{
+  if (Address - MODEL_BASE == NVME_CAP) {
+    return mModel.Mqes | (1ULL << 16) | (1ULL << 24) | NVME_CAP_CSS_NVM;
+  }
+
+  return 0;
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  UINTN  Offset;
+  UINTN  Doorbell;
+
+  Offset = Address - MODEL_BASE;
+  if (Offset >= NVME_DOORBELL) {
+    Doorbell = (Offset - NVME_DOORBELL) / 4;
+    if ((mModel.Csts & NVME_CSTS_RDY) == 0) {
+      ModelViolation ("doorbell while disabled");
+    } else if ((Doorbell & 1) == 0) {
+      mModel.IoDoorbells += (Doorbell != 0) ? 1 : 0;
+      ModelRing ((UINT16)(Doorbell / 2), (UINT16)Value);
+    } else {
+      mModel.IoCqDoorbells += (Doorbell != 1) ? 1 : 0;
+      mModel.Cq[Doorbell / 2].Head = (UINT16)Value;
+    }
+
+    return;
+  }
+
+  switch (Offset) {
+    case NVME_AQA:
+      mModel.Aqa = Value;
+      break;
+
+    case NVME_CC:
+      if (((Value & NVME_CC_EN) != 0) && ((mModel.Cc & NVME_CC_EN) == 0)) {
+        if ((mModel.Asq == 0) || (mModel.Acq == 0) || ((Value & (NVME_CC_IOSQES | NVME_CC_IOCQES)) != (NVME_CC_IOSQES | NVME_CC_IOCQES))) {
+          ModelViolation ("enabled without admin queues or entry sizes");
+        }
+
+        mModel.Sq[0] = (MODEL_RING){ TRUE, mModel.Asq, (UINT16)((mModel.Aqa & 0xFFF) + 1), 0, 0, 0, 0 };
+        mModel.Cq[0] = (MODEL_RING){ TRUE, mModel.Acq, (UINT16)(((mModel.Aqa >> 16) & 0xFFF) + 1), 0, 0, 1, 0 };
+        mModel.Csts |= NVME_CSTS_RDY;
+      } else if ((Value & NVME_CC_EN) == 0) {
+        memset (mModel.Sq, 0, sizeof (mModel.Sq));
+        memset (mModel.Cq, 0, sizeof (mModel.Cq));
+        mModel.Csts = 0;
+      }
+
+      if ((Value & NVME_CC_SHN_MASK) != 0) {
+        mModel.Csts = (mModel.Csts & ~NVME_CSTS_SHST_MASK) | NVME_CSTS_SHST_COMPLETE;
+      }
+
+      mModel.Cc = Value;
+      break;
+
+    default:
+      break;
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite64 (
+  IN UINTN   Address,
+  IN UINT64  Value
+  )
+{
+  switch (Address - MODEL_BASE) {
+    case NVME_ASQ: mModel.Asq = Value; break;
+    case NVME_ACQ: mModel.Acq = Value; break;
+    default:       ModelViolation ("64-bit write to a 32-bit register");
+  }
+}
+
+//
+// Scenarios
+//
+
+typedef struct {
+  CONST char    *Name;
+  UINT16        Mqes;
+  UINT8         Mdts;
+  UINT32        Sgls;
+  UINT32        MaxQueues;
+  UINT8         BlockShift;
+} SCENARIO;
+
+STATIC
+VOID
+ModelReset (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  free (mModel.Disk);
+  memset (&mModel, 0, sizeof (mModel));
+  mModel.Mqes       = Scenario->Mqes;
+  mModel.Mdts       = Scenario->Mdts;
+  mModel.Sgls       = Scenario->Sgls;
+  mModel.MaxQueues  = Scenario->MaxQueues;
+  mModel.BlockShift = Scenario->BlockShift;
+  mModel.Blocks     = (64 * SIZE_1MB) >> Scenario->BlockShift;
+  mModel.FailLba    = MAX_UINT64;
+  mModel.Disk       = calloc (1, 64 * SIZE_1MB);
+}
+
+STATIC
+EFI_STATUS
+RunTransfer (
+  IN NVME_CONTROLLER  *Controller,
+  IN UINT8            Opcode,
+  IN EFI_LBA          Lba,
+  IN VOID             *Buffer,
+  IN UINTN            Bytes
+  )
+{
+  NVME_TRANSFER  Transfer;
+  EFI_STATUS     Status;
+
+  memset (&Transfer, 0, sizeof (Transfer));
+  Transfer.Controller = Controller;
+  Transfer.Namespace  = &Controller->Namespaces[0];
+  Transfer.Opcode     = Opcode;
+  Transfer.Lba        = Lba;
+  Transfer.Buffer     = Buffer;
+  Transfer.Blocks     = Bytes >> Transfer.Namespace->BlockShift;
+
+  Status = NvmeTransferStart (&Transfer);
+  if (!EFI_ERROR (Status)) {
+    Status = NvmeTransferWait (&Transfer, NVME_IO_TIMEOUT);
+  }
+
+  return Status;
+}
+
+/**
+  Every slot is free again and every data mapping was released.
+**/
+STATIC
+VOID
+CheckIdle (
+  IN NVME_CONTROLLER  *Controller,
+  IN UINT64           Maps,
+  IN UINT64           Unmaps
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Controller->IoQueueCount; Index++) {
+    CHECK (Controller->IoQueues[Index].FreeCount == Controller->IoQueues[Index].Size - 1, "slots returned");
+  }
+
+  CHECK (mModel.Maps - Maps == mModel.Unmaps - Unmaps, "mappings released");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+}
+
+STATIC
+VOID
+Fill (
+  OUT UINT8   *Buffer,
+  IN  UINTN   Bytes,
+  IN  UINT32  Seed
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Bytes; Index++) {
+    Seed          = Seed * 1103515245 + 12345;
+    Buffer[Index] = (UINT8)(Seed >> 16);
+  }
+}
+
+/**
+  Write Bytes at Lba from a buffer at Offset into a page, read them back
+  into another, and check the disk and the copy.
+**/
+STATIC
+VOID
+CheckRoundTrip (
+  IN NVME_CONTROLLER  *Controller,
+  IN EFI_LBA          Lba,
+  IN UINTN            Bytes,
+  IN UINTN            Offset
+  )
+{
+  UINT8       *Source;
+  UINT8       *Copy;
+  UINT64      Maps;
+  UINT64      Unmaps;
+  EFI_STATUS  Status;
+
+  Source = aligned_alloc (EFI_PAGE_SIZE, Bytes + EFI_PAGE_SIZE);
+  Copy   = aligned_alloc (EFI_PAGE_SIZE, Bytes + EFI_PAGE_SIZE);
+  Fill (Source + Offset, Bytes, (UINT32)Lba);
+  memset (Copy, 0, Bytes + EFI_PAGE_SIZE);
+  Maps   = mModel.Maps;
+  Unmaps = mModel.Unmaps;
+
+  Status = RunTransfer (Controller, NVME_IO_WRITE, Lba, Source + Offset, Bytes);
+  CHECK (Status == EFI_SUCCESS, "write succeeds");
+  CHECK (memcmp (mModel.Disk + (Lba << mModel.BlockShift), Source + Offset, Bytes) == 0, "written data on the disk");
+
+  Status = RunTransfer (Controller, NVME_IO_READ, Lba, Copy + Offset, Bytes);
+  CHECK (Status == EFI_SUCCESS, "read succeeds");
+  CHECK (memcmp (Copy + Offset, Source + Offset, Bytes) == 0, "read data matches");
+  CHECK ((Offset == 0) || (Copy[Offset - 1] == 0), "nothing read before the buffer");
+  CHECK (Copy[Offset + Bytes] == 0, "nothing read past the buffer");
+
+  CheckIdle (Controller, Maps, Unmaps);
+  free (Source);
+  free (Copy);
+}
+
+STATIC
+BOOLEAN
+StartController (
+  IN  CONST SCENARIO   *Scenario,
+  OUT NVME_CONTROLLER  *Controller
+  )
+{
+  EFI_STATUS  Status;
+
+  ModelReset (Scenario);
+  memset (Controller, 0, sizeof (*Controller));
+  Controller->Base         = MODEL_BASE;
+  Controller->RootBridgeIo = &mRootBridgeIo;
+
+  Status = NvmeControllerInit (Controller);
+  CHECK (Status == EFI_SUCCESS, "controller init");
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  CHECK (Controller->IoQueueCount == MIN (Scenario->MaxQueues, NVME_MAX_IO_QUEUES), "one queue pair per core, up to those granted");
+  CHECK (Controller->IoQueues[0].Size == MIN (NVME_IO_QUEUE_SIZE, Scenario->Mqes + 1), "queue depth within MQES");
+  CHECK (Controller->SglSupported == (Scenario->Sgls != 0), "SGL support detected");
+  CHECK (Controller->NamespaceCount == 1, "namespace with metadata skipped");
+  CHECK (Controller->Namespaces[0].BlockSize == (1U << Scenario->BlockShift), "block size");
+  return TRUE;
+}
+
+STATIC
+VOID
+TestLargeTransfers (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  NVME_CONTROLLER  Controller;
+  UINT64           Commands;
+  UINT64           Doorbells;
+  UINT64           CqDoorbells;
+
+  printf ("%s\n", Scenario->Name);
+  if (!StartController (Scenario, &Controller)) {
+    return;
+  }
+
+  //
+  // 1 MB and 3 MB, page aligned and dword aligned
+  //
+  CheckRoundTrip (&Controller, 8, SIZE_1MB, 0);
+  Commands    = mModel.IoCommands;
+  Doorbells   = mModel.IoDoorbells;
+  CqDoorbells = mModel.IoCqDoorbells;
+  CheckRoundTrip (&Controller, 2048, 4 * SIZE_1MB, 0);
+  Commands    = mModel.IoCommands - Commands;
+  Doorbells   = mModel.IoDoorbells - Doorbells;
+  CqDoorbells = mModel.IoCqDoorbells - CqDoorbells;
+  printf (
+    "  4 MB write and read: %llu commands, %llu submission and %llu completion doorbell writes\n",
+    (unsigned long long)Commands,
+    (unsigned long long)Doorbells,
+    (unsigned long long)CqDoorbells
+    );
+
+  //
+  // A transfer of more commands than queues puts several on a queue with
+  // one doorbell write, when the queue has room for them; each batch is
+  // acknowledged with one head write.
+  //
+  CHECK (Doorbells <= Commands, "no more doorbell writes than commands");
+  if ((Controller.IoQueues[0].Size > 2) && (Commands / 2 > Controller.IoQueueCount)) {
+    CHECK (Doorbells < Commands, "doorbell writes batched");
+  }
+
+  CHECK (CqDoorbells <= Doorbells, "one completion doorbell write per batch");
+
+  CheckRoundTrip (&Controller, 4099, 3 * SIZE_1MB, 4);
+  CheckRoundTrip (&Controller, mModel.Blocks - (SIZE_1MB >> Scenario->BlockShift), SIZE_1MB, 512);
+
+  if (Scenario->Sgls != 0) {
+    CHECK (mModel.SglCommands == mModel.IoCommands && mModel.PrpCommands == 0, "every data command uses an SGL");
+  } else {
+    CHECK (mModel.PrpListCommands != 0, "PRP lists used");
+  }
+
+  NvmeControllerShutdown (&Controller);
+  CHECK ((mModel.Csts & NVME_CSTS_SHST_MASK) == NVME_CSTS_SHST_COMPLETE, "shutdown complete");
+}
+
+STATIC
+VOID
+TestFailure (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenario = { "Failed command", 63, 5, 1, 4, 9 };
+  NVME_CONTROLLER        Controller;
+  UINT8                  *Buffer;
+  UINT64                 Maps;
+  UINT64                 Unmaps;
+  EFI_STATUS             Status;
+
+  printf ("%s\n", Scenario.Name);
+  if (!StartController (&Scenario, &Controller)) {
+    return;
+  }
+
+  Buffer         = aligned_alloc (EFI_PAGE_SIZE, 2 * SIZE_1MB);
+  Maps           = mModel.Maps;
+  Unmaps         = mModel.Unmaps;
+  mModel.FailLba = 1000;
+  Status         = RunTransfer (&Controller, NVME_IO_READ, 0, Buffer, 2 * SIZE_1MB);
+  CHECK (Status == EFI_DEVICE_ERROR, "failure reported");
+  CheckIdle (&Controller, Maps, Unmaps);
+
+  mModel.FailLba = MAX_UINT64;
+  Status         = RunTransfer (&Controller, NVME_IO_READ, mModel.Blocks - 1, Buffer, 2 * 512);
+  CHECK (Status == EFI_DEVICE_ERROR, "LBA range error reported");
+  CheckIdle (&Controller, Maps, Unmaps);
+  free (Buffer);
+}
+
+STATIC
+VOID
+TransferDone (
+  IN NVME_TRANSFER  *Transfer
+  )
+{
+  (*(UINTN *)Transfer->Context)++;
+}
+
+STATIC
+VOID
+TestAsync (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenario = { "Asynchronous and abandoned transfers", 7, 4, 0, 4, 9 };
+  NVME_CONTROLLER        Controller;
+  NVME_TRANSFER          Transfer;
+  UINT8                  *Buffer;
+  UINTN                  Calls;
+  UINTN                  Polls;
+  UINT64                 Maps;
+  UINT64                 Unmaps;
+  EFI_STATUS             Status;
+
+  printf ("%s\n", Scenario.Name);
+  if (!StartController (&Scenario, &Controller)) {
+    return;
+  }
+
+  Buffer = aligned_alloc (EFI_PAGE_SIZE, 2 * SIZE_1MB);
+  Maps   = mModel.Maps;
+  Unmaps = mModel.Unmaps;
+
+  //
+  // Started, then completed by polling alone, refilling the queues from
+  // the completions.
+  //
+  Calls = 0;
+  memset (&Transfer, 0, sizeof (Transfer));
+  Transfer.Controller   = &Controller;
+  Transfer.Namespace    = &Controller.Namespaces[0];
+  Transfer.Opcode       = NVME_IO_READ;
+  Transfer.Buffer       = Buffer;
+  Transfer.Blocks       = (2 * SIZE_1MB) >> 9;
+  Transfer.DoneCallback = TransferDone;
+  Transfer.Context      = &Calls;
+  Status                = NvmeTransferStart (&Transfer);
+  CHECK (Status == EFI_SUCCESS, "asynchronous transfer started");
+  CHECK (!Transfer.Queued, "more commands than slots");
+  for (Polls = 0; Calls == 0 && Polls < 1000; Polls++) {
+    NvmePollIoQueues (&Controller);
+  }
+
+  CHECK (Calls == 1 && Transfer.Status == EFI_SUCCESS, "callback once, on success");
+  CheckIdle (&Controller, Maps, Unmaps);
+
+  //
+  // The controller stops answering: the transfer times out, and the
+  // completions that arrive later retire their slots without it.
+  //
+  Calls       = 0;
+  mModel.Hold = TRUE;
+  memset (&Transfer, 0, sizeof (Transfer));
+  Transfer.Controller   = &Controller;
+  Transfer.Namespace    = &Controller.Namespaces[0];
+  Transfer.Opcode       = NVME_IO_WRITE;
+  Transfer.Buffer       = Buffer;
+  Transfer.Blocks       = SIZE_1MB >> 9;
+  Transfer.DoneCallback = TransferDone;
+  Transfer.Context      = &Calls;
+  Status                = NvmeTransferStart (&Transfer);
+  CHECK (Status == EFI_SUCCESS, "transfer started");
+  Status = NvmeTransferWait (&Transfer, 1000);
+  CHECK (Status == EFI_TIMEOUT, "timeout reported");
+  CHECK (mModel.Maps - Maps == mModel.Unmaps - Unmaps, "abandoned commands unmapped");
+
+  memset (&Transfer, 0xA5, sizeof (Transfer));
+  mModel.Hold = FALSE;
+  ModelRelease ();
+  CHECK (NvmePollIoQueues (&Controller) != 0, "late completions reaped");
+  CHECK (Calls == 0, "no callback after abandoning");
+  CheckIdle (&Controller, Maps, Unmaps);
+
+  free (Buffer);
+}
+
+int
+main (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenarios[] = {
+    { "SGL, 4 queues, 128 KB commands",               63, 5, 1, 8, 9  },
+    { "SGL, 4 queues, 2 MB commands",                 63, 0, 1, 8, 9  },
+    { "PRP lists, 2 queues granted, 2 MB commands",   63, 0, 0, 2, 9  },
+    { "PRP lists, 4 KB blocks, 512 KB commands",      63, 7, 0, 4, 12 },
+    { "Queue wrap: 8 entries, 8 KB commands",         7,  1, 0, 4, 9  },
+    { "Queue wrap: 2 entries, 1 queue granted",       1,  3, 1, 1, 9  },
+  };
+  UINTN                  Index;
+
+  for (Index = 0; Index < sizeof (Scenarios) / sizeof (Scenarios[0]); Index++) {
+    TestLargeTransfers (&Scenarios[Index]);
+  }
+
+  TestFailure ();
+  TestAsync ();
+
+  return HostTestResult ();
+}
@@ -0,0 +1,49 @@
+/** @file
+  Host stand-in for the PCI root bridge I/O protocol: the DMA services
+  the NvmeDxe queue engine uses.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_PCI_ROOT_BRIDGE_IO_H_
+#define HOST_PCI_ROOT_BRIDGE_IO_H_
+
+typedef struct _EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL;
+
+typedef enum {
+  EfiPciOperationBusMasterRead,
+  EfiPciOperationBusMasterWrite,
+  EfiPciOperationBusMasterCommonBuffer
+} EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION;
+
+struct _EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL {
+  EFI_STATUS (*Map)(
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL            *This,
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION  Operation,
+    VOID                                       *HostAddress,
+    UINTN                                      *NumberOfBytes,
+    EFI_PHYSICAL_ADDRESS                       *DeviceAddress,
+    VOID                                       **Mapping
+    );
+  EFI_STATUS (*Unmap)(
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+    VOID                             *Mapping
+    );
+  EFI_STATUS (*AllocateBuffer)(
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+    EFI_ALLOCATE_TYPE                Type,
+    EFI_MEMORY_TYPE                  MemoryType,
+    UINTN                            Pages,
+    VOID                             **HostAddress,
+    UINT64                           Attributes
+    );
+  EFI_STATUS (*FreeBuffer)(
+    EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *This,
+    UINTN                            Pages,
+    VOID                             *HostAddress
+    );
+};
+
+#endif
@@ -0,0 +1,608 @@
+/** @file
+  Block I/O and Block I/O 2 on NVMe namespaces.
+
+  Both protocols run on NVME_TRANSFER: a request is split into commands
+  of the controller's transfer size and spread over the I/O queues. A
+  blocking request polls until it is over; a Block I/O 2 request with an
+  event returns at once and its token is signalled from the poll timer.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmeDxe.h"
+
+/**
+  Check the arguments of a read or write.
+
+  @param  Disk          Namespace.
+  @param  MediaId       Media ID from the caller.
+  @param  Lba           First block.
+  @param  BufferSize    Bytes to transfer, not 0.
+  @param  Buffer        Caller's buffer.
+
+  @retval EFI_SUCCESS           Valid.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+NvmeDiskCheckRequest (
+  IN NVME_DISK  *Disk,
+  IN UINT32     MediaId,
+  IN EFI_LBA    Lba,
+  IN UINTN      BufferSize,
+  IN VOID       *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Media = &Disk->Media;
+
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+  if ((Buffer == NULL) || (((UINTN)Buffer & (Media->IoAlign - 1)) != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((BufferSize % Media->BlockSize) != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  if ((Lba > Media->LastBlock) || ((BufferSize / Media->BlockSize) - 1 > Media->LastBlock - Lba)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Finish a Block I/O 2 request: hand its status to the token and signal
+  it. Runs from NvmePoll at NVME_TPL.
+
+  @param  Transfer      Transfer of the request.
+**/
+STATIC
+VOID
+NvmeAsyncDone (
+  IN NVME_TRANSFER  *Transfer
+  )
+{
+  NVME_ASYNC_REQUEST  *Async;
+
+  Async = BASE_CR (Transfer, NVME_ASYNC_REQUEST, Transfer);
+  RemoveEntryList (&Async->Link);
+  Async->Token->TransactionStatus = Transfer->Status;
+  gBS->SignalEvent (Async->Token->Event);
+  FreePool (Async);
+}
+
+/**
+  Run a read, write or flush. Without a token event it blocks; with one
+  it is started and the token is completed later.
+
+  @param  Disk          Namespace.
+  @param  Opcode        NVME_IO_READ, NVME_IO_WRITE or NVME_IO_FLUSH.
+  @param  Lba           First block.
+  @param  Blocks        Number of blocks, 0 for a flush.
+  @param  Buffer        Data.
+  @param  Token         Block I/O 2 token, or NULL.
+
+  @retval EFI_SUCCESS           Done, or started when Token has an event.
+  @retval EFI_DEVICE_ERROR      The controller failed a command.
+  @retval EFI_TIMEOUT           The controller stopped making progress.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the request.
+**/
+STATIC
+EFI_STATUS
+NvmeDiskTransfer (
+  IN NVME_DISK            *Disk,
+  IN UINT8                Opcode,
+  IN EFI_LBA              Lba,
+  IN UINTN                Blocks,
+  IN VOID                 *Buffer,
+  IN EFI_BLOCK_IO2_TOKEN  *Token  OPTIONAL
+  )
+{
+  NVME_PRIVATE_DATA   *Private;
+  NVME_ASYNC_REQUEST  *Async;
+  NVME_TRANSFER       Transfer;
+  EFI_STATUS          Status;
+  EFI_TPL             OldTpl;
+
+  Private = Disk->Private;
+
+  if ((Token == NULL) || (Token->Event == NULL)) {
+    ZeroMem (&Transfer, sizeof (Transfer));
+    Transfer.Controller = &Private->Controller;
+    Transfer.Namespace  = Disk->Namespace;
+    Transfer.Opcode     = Opcode;
+    Transfer.Lba        = Lba;
+    Transfer.Buffer     = Buffer;
+    Transfer.Blocks     = Blocks;
+
+    OldTpl = gBS->RaiseTPL (NVME_TPL);
+    Status = NvmeTransferStart (&Transfer);
+    if (!EFI_ERROR (Status)) {
+      Status = NvmeTransferWait (&Transfer, NVME_IO_TIMEOUT);
+    }
+
+    gBS->RestoreTPL (OldTpl);
+
+    if (Token != NULL) {
+      Token->TransactionStatus = Status;
+    }
+
+    return Status;
+  }
+
+  Async = AllocateZeroPool (sizeof (NVME_ASYNC_REQUEST));
+  if (Async == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Async->Signature             = NVME_ASYNC_SIGNATURE;
+  Async->Token                 = Token;
+  Async->Transfer.Controller   = &Private->Controller;
+  Async->Transfer.Namespace    = Disk->Namespace;
+  Async->Transfer.Opcode       = Opcode;
+  Async->Transfer.Lba          = Lba;
+  Async->Transfer.Buffer       = Buffer;
+  Async->Transfer.Blocks       = Blocks;
+  Async->Transfer.DoneCallback = NvmeAsyncDone;
+  Token->TransactionStatus     = EFI_NOT_READY;
+
+  OldTpl = gBS->RaiseTPL (NVME_TPL);
+  InsertTailList (&Private->AsyncList, &Async->Link);
+  Status = NvmeTransferStart (&Async->Transfer);
+  if (EFI_ERROR (Status)) {
+    RemoveEntryList (&Async->Link);
+    FreePool (Async);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Complete Block I/O 2 requests whose commands have finished. Commands
+  queued by blocking requests complete here too when they finish first.
+
+  @param  Event         Poll timer.
+  @param  Context       Driver private data.
+**/
+VOID
+EFIAPI
+NvmePollAsync (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  NVME_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  if (!IsListEmpty (&Private->AsyncList)) {
+    NvmePollIoQueues (&Private->Controller);
+  }
+}
+
+/**
+  Abort every Block I/O 2 request in flight with EFI_ABORTED.
+
+  @param  Private       Driver private data.
+**/
+STATIC
+VOID
+NvmeAbortAsync (
+  IN NVME_PRIVATE_DATA  *Private
+  )
+{
+  NVME_ASYNC_REQUEST  *Async;
+
+  while (!IsListEmpty (&Private->AsyncList)) {
+    Async = NVME_ASYNC_FROM_LINK (GetFirstNode (&Private->AsyncList));
+    NvmeTransferAbandon (&Async->Transfer);
+    RemoveEntryList (&Async->Link);
+    Async->Token->TransactionStatus = EFI_ABORTED;
+    gBS->SignalEvent (Async->Token->Event);
+    FreePool (Async);
+  }
+}
+
+/**
+  Reset the block device. The controller keeps running; there is no
+  state in the driver to clear.
+
+  @param  This                  Block I/O protocol instance.
+  @param  ExtendedVerification  Ignored.
+
+  @retval EFI_SUCCESS           Reset.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskReset (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to read.
+  @param  BufferSize    Bytes to read.
+  @param  Buffer        Destination buffer.
+
+  @retval EFI_SUCCESS           Data read.
+  @retval EFI_DEVICE_ERROR      The controller failed a command.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  NVME_DISK   *Disk;
+  EFI_STATUS  Status;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO (This);
+  if (BufferSize == 0) {
+    return (MediaId != Disk->Media.MediaId) ? EFI_MEDIA_CHANGED : EFI_SUCCESS;
+  }
+
+  Status = NvmeDiskCheckRequest (Disk, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_READ, Lba, BufferSize / Disk->Media.BlockSize, Buffer, NULL);
+}
+
+/**
+  Write blocks.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to write.
+  @param  BufferSize    Bytes to write.
+  @param  Buffer        Source buffer.
+
+  @retval EFI_SUCCESS           Data written.
+  @retval EFI_DEVICE_ERROR      The controller failed a command.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  NVME_DISK   *Disk;
+  EFI_STATUS  Status;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO (This);
+  if (BufferSize == 0) {
+    return (MediaId != Disk->Media.MediaId) ? EFI_MEDIA_CHANGED : EFI_SUCCESS;
+  }
+
+  Status = NvmeDiskCheckRequest (Disk, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_WRITE, Lba, BufferSize / Disk->Media.BlockSize, Buffer, NULL);
+}
+
+/**
+  Flush the volatile write cache, when the controller has one.
+
+  @param  This          Block I/O protocol instance.
+
+  @retval EFI_SUCCESS       Flushed.
+  @retval EFI_DEVICE_ERROR  The controller failed the flush.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  NVME_DISK  *Disk;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO (This);
+  if (!Disk->Private->Controller.VolatileCache) {
+    return EFI_SUCCESS;
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_FLUSH, 0, 0, NULL, NULL);
+}
+
+/**
+  Reset the block device, aborting every Block I/O 2 request in flight.
+
+  @param  This                  Block I/O 2 protocol instance.
+  @param  ExtendedVerification  Ignored.
+
+  @retval EFI_SUCCESS           Reset.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN BOOLEAN                 ExtendedVerification
+  )
+{
+  NVME_DISK  *Disk;
+  EFI_TPL    OldTpl;
+
+  Disk   = NVME_DISK_FROM_BLOCK_IO2 (This);
+  OldTpl = gBS->RaiseTPL (NVME_TPL);
+  NvmeAbortAsync (Disk->Private);
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Complete a Block I/O 2 request that has nothing to transfer.
+**/
+STATIC
+EFI_STATUS
+NvmeDiskCompleteEmpty (
+  IN EFI_BLOCK_IO2_TOKEN  *Token  OPTIONAL
+  )
+{
+  if (Token != NULL) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    if (Token->Event != NULL) {
+      gBS->SignalEvent (Token->Event);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks, asynchronously when Token has an event.
+
+  @param  This          Block I/O 2 protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to read.
+  @param  Token         Completion token, or NULL to block.
+  @param  BufferSize    Bytes to read.
+  @param  Buffer        Destination buffer.
+
+  @retval EFI_SUCCESS           Read, or started.
+  @retval EFI_DEVICE_ERROR      The controller failed a command.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the request.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  )
+{
+  NVME_DISK   *Disk;
+  EFI_STATUS  Status;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO2 (This);
+  if (BufferSize == 0) {
+    if (MediaId != Disk->Media.MediaId) {
+      return EFI_MEDIA_CHANGED;
+    }
+
+    return NvmeDiskCompleteEmpty (Token);
+  }
+
+  Status = NvmeDiskCheckRequest (Disk, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_READ, Lba, BufferSize / Disk->Media.BlockSize, Buffer, Token);
+}
+
+/**
+  Write blocks, asynchronously when Token has an event.
+
+  @param  This          Block I/O 2 protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to write.
+  @param  Token         Completion token, or NULL to block.
+  @param  BufferSize    Bytes to write.
+  @param  Buffer        Source buffer.
+
+  @retval EFI_SUCCESS           Written, or started.
+  @retval EFI_DEVICE_ERROR      The controller failed a command.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the request.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  IN     VOID                    *Buffer
+  )
+{
+  NVME_DISK   *Disk;
+  EFI_STATUS  Status;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO2 (This);
+  if (BufferSize == 0) {
+    if (MediaId != Disk->Media.MediaId) {
+      return EFI_MEDIA_CHANGED;
+    }
+
+    return NvmeDiskCompleteEmpty (Token);
+  }
+
+  Status = NvmeDiskCheckRequest (Disk, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_WRITE, Lba, BufferSize / Disk->Media.BlockSize, Buffer, Token);
+}
+
+/**
+  Flush the volatile write cache, asynchronously when Token has an event.
+
+  @param  This          Block I/O 2 protocol instance.
+  @param  Token         Completion token, or NULL to block.
+
+  @retval EFI_SUCCESS           Flushed, or started.
+  @retval EFI_DEVICE_ERROR      The controller failed the flush.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the request.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmeDiskFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token
+  )
+{
+  NVME_DISK  *Disk;
+
+  Disk = NVME_DISK_FROM_BLOCK_IO2 (This);
+  if (!Disk->Private->Controller.VolatileCache) {
+    return NvmeDiskCompleteEmpty (Token);
+  }
+
+  return NvmeDiskTransfer (Disk, NVME_IO_FLUSH, 0, 0, NULL, Token);
+}
+
+/**
+  Publish one namespace as a disk.
+
+  @param  Private       Driver private data.
+  @param  Namespace     Namespace to publish.
+
+  @return The disk, or NULL when it could not be published.
+**/
+STATIC
+NVME_DISK *
+NvmeInstallDisk (
+  IN NVME_PRIVATE_DATA  *Private,
+  IN NVME_NAMESPACE     *Namespace
+  )
+{
+  NVME_DISK              *Disk;
+  NVME_DISK_DEVICE_PATH  Node;
+  EFI_STATUS             Status;
+
+  Disk = AllocateZeroPool (sizeof (NVME_DISK));
+  if (Disk == NULL) {
+    return NULL;
+  }
+
+  Disk->Signature = NVME_DISK_SIGNATURE;
+  Disk->Private   = Private;
+  Disk->Namespace = Namespace;
+
+  Disk->Media.MediaPresent                     = TRUE;
+  Disk->Media.WriteCaching                     = Private->Controller.VolatileCache;
+  Disk->Media.BlockSize                        = Namespace->BlockSize;
+  Disk->Media.IoAlign                          = Private->PassThruMode.IoAlign;
+  Disk->Media.LastBlock                        = Namespace->LastBlock;
+  Disk->Media.LogicalBlocksPerPhysicalBlock    = 1;
+  Disk->Media.OptimalTransferLengthGranularity = Private->Controller.MaxTransfer >> Namespace->BlockShift;
+
+  Disk->BlockIo.Revision    = EFI_BLOCK_IO_PROTOCOL_REVISION3;
+  Disk->BlockIo.Media       = &Disk->Media;
+  Disk->BlockIo.Reset       = NvmeDiskReset;
+  Disk->BlockIo.ReadBlocks  = NvmeDiskReadBlocks;
+  Disk->BlockIo.WriteBlocks = NvmeDiskWriteBlocks;
+  Disk->BlockIo.FlushBlocks = NvmeDiskFlushBlocks;
+
+  Disk->BlockIo2.Media         = &Disk->Media;
+  Disk->BlockIo2.Reset         = NvmeDiskResetEx;
+  Disk->BlockIo2.ReadBlocksEx  = NvmeDiskReadBlocksEx;
+  Disk->BlockIo2.WriteBlocksEx = NvmeDiskWriteBlocksEx;
+  Disk->BlockIo2.FlushBlocksEx = NvmeDiskFlushBlocksEx;
+
+  ZeroMem (&Node, sizeof (Node));
+  Node.Namespace.Header.Type    = MESSAGING_DEVICE_PATH;
+  Node.Namespace.Header.SubType = MSG_NVME_NAMESPACE_DP;
+  SetDevicePathNodeLength (&Node.Namespace.Header, sizeof (NVME_NAMESPACE_DEVICE_PATH));
+  Node.Namespace.NamespaceId   = Namespace->Nsid;
+  Node.Namespace.NamespaceUuid = Namespace->Eui64;
+  SetDevicePathEndNode (&Node.End);
+  Disk->DevicePath = AppendDevicePathNode (Private->DevicePath, &Node.Namespace.Header);
+  if (Disk->DevicePath == NULL) {
+    FreePool (Disk);
+    return NULL;
+  }
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Disk->Handle,
+                  &gEfiBlockIoProtocolGuid, &Disk->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Disk->BlockIo2,
+                  &gEfiDevicePathProtocolGuid, Disk->DevicePath,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[NVME] Namespace %d: protocol install failed: %r\n", Namespace->Nsid, Status));
+    FreePool (Disk->DevicePath);
+    FreePool (Disk);
+    return NULL;
+  }
+
+  gBS->ConnectController (Disk->Handle, NULL, NULL, TRUE);
+  return Disk;
+}
+
+/**
+  Publish Block I/O and Block I/O 2 for every namespace.
+
+  @param  Private       Driver private data with an initialized controller.
+**/
+VOID
+NvmeInstallDisks (
+  IN NVME_PRIVATE_DATA  *Private
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Private->Controller.NamespaceCount; Index++) {
+    Private->Disks[Index] = NvmeInstallDisk (Private, &Private->Controller.Namespaces[Index]);
+  }
+}
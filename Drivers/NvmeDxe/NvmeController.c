@@ -0,0 +1,501 @@
+/** @file
+  NVMe controller bring-up: reset, admin queue, identify, and one I/O
+  queue pair per core.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmeHc.h"
+
+/**
+  Allocate and map DMA memory the controller reads and writes.
+
+  @param  Controller    NVMe controller.
+  @param  Pages         Size in pages.
+  @param  Buffer        Filled in; the memory is zeroed.
+
+  @retval EFI_SUCCESS   Allocated.
+  @retval others        Allocation or mapping failed.
+**/
+EFI_STATUS
+NvmeDmaAllocate (
+  IN  NVME_CONTROLLER  *Controller,
+  IN  UINTN            Pages,
+  OUT NVME_DMA_BUFFER  *Buffer
+  )
+{
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *Io;
+  EFI_STATUS                       Status;
+  UINTN                            Bytes;
+
+  Io = Controller->RootBridgeIo;
+  ZeroMem (Buffer, sizeof (*Buffer));
+
+  Status = Io->AllocateBuffer (Io, AllocateAnyPages, EfiBootServicesData, Pages, &Buffer->Host, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ZeroMem (Buffer->Host, EFI_PAGES_TO_SIZE (Pages));
+
+  Bytes  = EFI_PAGES_TO_SIZE (Pages);
+  Status = Io->Map (Io, EfiPciOperationBusMasterCommonBuffer, Buffer->Host, &Bytes, &Buffer->Device, &Buffer->Mapping);
+  if (!EFI_ERROR (Status) && (Bytes != EFI_PAGES_TO_SIZE (Pages))) {
+    Io->Unmap (Io, Buffer->Mapping);
+    Status = EFI_OUT_OF_RESOURCES;
+  }
+
+  if (EFI_ERROR (Status)) {
+    Io->FreeBuffer (Io, Pages, Buffer->Host);
+    ZeroMem (Buffer, sizeof (*Buffer));
+    return Status;
+  }
+
+  Buffer->Pages = Pages;
+  return EFI_SUCCESS;
+}
+
+/**
+  Unmap and free DMA memory. Does nothing for a buffer never allocated.
+
+  @param  Controller    NVMe controller.
+  @param  Buffer        Buffer to free.
+**/
+VOID
+NvmeDmaFree (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_DMA_BUFFER  *Buffer
+  )
+{
+  if (Buffer->Host == NULL) {
+    return;
+  }
+
+  Controller->RootBridgeIo->Unmap (Controller->RootBridgeIo, Buffer->Mapping);
+  Controller->RootBridgeIo->FreeBuffer (Controller->RootBridgeIo, Buffer->Pages, Buffer->Host);
+  ZeroMem (Buffer, sizeof (*Buffer));
+}
+
+/**
+  Allocate the memory of a queue pair and set it up.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to create.
+  @param  QueueId       Queue ID.
+  @param  Size          Entries in each of the two queues.
+
+  @retval EFI_SUCCESS   Ready to be announced to the controller.
+  @retval others        No memory.
+**/
+STATIC
+EFI_STATUS
+NvmeQueueAllocate (
+  IN  NVME_CONTROLLER  *Controller,
+  OUT NVME_QUEUE       *Queue,
+  IN  UINT16           QueueId,
+  IN  UINT16           Size
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Pages;
+
+  ZeroMem (Queue, sizeof (*Queue));
+  Queue->Size = Size;
+  Pages       = EFI_SIZE_TO_PAGES (Size * sizeof (NVME_SQE)) + EFI_SIZE_TO_PAGES (Size * sizeof (NVME_CQE));
+  Status      = NvmeDmaAllocate (Controller, Pages, &Queue->Memory);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = NvmeQueueInit (Controller, Queue, QueueId);
+  if (EFI_ERROR (Status)) {
+    NvmeDmaFree (Controller, &Queue->Memory);
+  }
+
+  return Status;
+}
+
+/**
+  Free a queue pair allocated by NvmeQueueAllocate.
+**/
+STATIC
+VOID
+NvmeQueueRelease (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_QUEUE       *Queue
+  )
+{
+  NvmeQueueFree (Controller, Queue);
+  NvmeDmaFree (Controller, &Queue->Memory);
+}
+
+/**
+  Free every queue pair and the scratch page.
+**/
+STATIC
+VOID
+NvmeReleaseQueues (
+  IN OUT NVME_CONTROLLER  *Controller
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Controller->IoQueueCount; Index++) {
+    NvmeQueueRelease (Controller, &Controller->IoQueues[Index]);
+  }
+
+  Controller->IoQueueCount = 0;
+  NvmeQueueRelease (Controller, &Controller->AdminQueue);
+  NvmeDmaFree (Controller, &Controller->Scratch);
+}
+
+/**
+  Run an admin command whose data, if any, is the scratch page.
+
+  @param  Controller    NVMe controller.
+  @param  Request       Command; Buffer and Length are filled in here
+                        when DataLength is not 0.
+  @param  DataLength    Bytes of scratch data the command transfers.
+
+  @return Status of the command.
+**/
+STATIC
+EFI_STATUS
+NvmeAdminCommand (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_REQUEST     *Request,
+  IN     UINT32           DataLength
+  )
+{
+  Request->Buffer = (DataLength != 0) ? Controller->Scratch.Host : NULL;
+  Request->Length = DataLength;
+  return NvmeExecute (Controller, &Controller->AdminQueue, Request, NVME_ADMIN_TIMEOUT);
+}
+
+/**
+  Read Identify data into the scratch page.
+
+  @param  Controller    NVMe controller.
+  @param  Cns           NVME_CNS_*.
+  @param  Nsid          Namespace, for NVME_CNS_NAMESPACE.
+
+  @return Status of the command.
+**/
+STATIC
+EFI_STATUS
+NvmeIdentify (
+  IN NVME_CONTROLLER  *Controller,
+  IN UINT8            Cns,
+  IN UINT32           Nsid
+  )
+{
+  NVME_REQUEST  Request;
+
+  ZeroMem (&Request, sizeof (Request));
+  Request.Command.Opcode = NVME_ADMIN_IDENTIFY;
+  Request.Command.Nsid   = Nsid;
+  Request.Command.Cdw10  = Cns;
+  return NvmeAdminCommand (Controller, &Request, SIZE_4KB);
+}
+
+/**
+  Clear CC.EN and wait for the controller to stop.
+
+  @param  Controller    NVMe controller.
+
+  @retval EFI_SUCCESS   Disabled.
+  @retval EFI_TIMEOUT   CSTS.RDY stayed set beyond CAP.TO.
+**/
+STATIC
+EFI_STATUS
+NvmeDisable (
+  IN NVME_CONTROLLER  *Controller
+  )
+{
+  UINT32  Config;
+  UINT64  Elapsed;
+
+  Config = PlatformMmioRead32 (Controller->Base + NVME_CC);
+  if ((Config & NVME_CC_EN) != 0) {
+    PlatformMmioWrite32 (Controller->Base + NVME_CC, Config & ~NVME_CC_EN);
+  }
+
+  return PlatformWaitMmio32 (Controller->Base + NVME_CSTS, NVME_CSTS_RDY, 0, Controller->ReadyTimeout, &Elapsed);
+}
+
+/**
+  Create the I/O queue pairs: ask for one per core and build as many as
+  the controller grants.
+
+  @param  Controller    NVMe controller with a running admin queue.
+
+  @retval EFI_SUCCESS   At least one pair exists.
+  @retval others        None could be created.
+**/
+STATIC
+EFI_STATUS
+NvmeCreateIoQueues (
+  IN OUT NVME_CONTROLLER  *Controller
+  )
+{
+  EFI_STATUS    Status;
+  NVME_REQUEST  Request;
+  NVME_QUEUE    *Queue;
+  UINTN         Wanted;
+  UINTN         Granted;
+  UINT16        Size;
+  UINT16        QueueId;
+
+  Wanted = NVME_MAX_IO_QUEUES;
+  ZeroMem (&Request, sizeof (Request));
+  Request.Command.Opcode = NVME_ADMIN_SET_FEATURES;
+  Request.Command.Cdw10  = NVME_FEATURE_QUEUES;
+  Request.Command.Cdw11  = (UINT32)(((Wanted - 1) << 16) | (Wanted - 1));
+  Status                 = NvmeAdminCommand (Controller, &Request, 0);
+  if (EFI_ERROR (Status)) {
+    Granted = 1;
+  } else {
+    Granted = MIN ((Request.Completion.Dw0 & 0xFFFF), (Request.Completion.Dw0 >> 16)) + 1;
+  }
+
+  Granted = MIN (Granted, Wanted);
+  Size    = (UINT16)MIN (NVME_IO_QUEUE_SIZE, NVME_CAP_MQES (Controller->Cap) + 1);
+
+  for (QueueId = 1; QueueId <= Granted; QueueId++) {
+    Queue  = &Controller->IoQueues[QueueId - 1];
+    Status = NvmeQueueAllocate (Controller, Queue, QueueId, Size);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    ZeroMem (&Request, sizeof (Request));
+    Request.Command.Opcode  = NVME_ADMIN_CREATE_IO_CQ;
+    Request.Command.Dptr[0] = Queue->CqDevice;
+    Request.Command.Cdw10   = ((UINT32)(Size - 1) << 16) | QueueId;
+    Request.Command.Cdw11   = BIT0;                                   // physically contiguous, no interrupt
+    Status                  = NvmeAdminCommand (Controller, &Request, 0);
+    if (!EFI_ERROR (Status)) {
+      ZeroMem (&Request, sizeof (Request));
+      Request.Command.Opcode  = NVME_ADMIN_CREATE_IO_SQ;
+      Request.Command.Dptr[0] = Queue->SqDevice;
+      Request.Command.Cdw10   = ((UINT32)(Size - 1) << 16) | QueueId;
+      Request.Command.Cdw11   = ((UINT32)QueueId << 16) | BIT0;       // its CQ, physically contiguous
+      Status                  = NvmeAdminCommand (Controller, &Request, 0);
+    }
+
+    if (EFI_ERROR (Status)) {
+      NvmeQueueRelease (Controller, Queue);
+      break;
+    }
+
+    Controller->IoQueueCount++;
+  }
+
+  if (Controller->IoQueueCount == 0) {
+    return EFI_ERROR (Status) ? Status : EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Identify the active namespaces the driver can serve: those formatted
+  without metadata, whose blocks are plain data.
+
+  @param  Controller    NVMe controller.
+**/
+STATIC
+VOID
+NvmeIdentifyNamespaces (
+  IN OUT NVME_CONTROLLER  *Controller
+  )
+{
+  NVME_IDENTIFY_NAMESPACE  *Data;
+  NVME_NAMESPACE           *Namespace;
+  NVME_LBA_FORMAT          *Format;
+  UINT32                   Nsid;
+  EFI_STATUS               Status;
+
+  Data = Controller->Scratch.Host;
+  for (Nsid = 1; (Nsid <= Controller->Identify.Nn) && (Controller->NamespaceCount < NVME_MAX_NAMESPACES); Nsid++) {
+    Status = NvmeIdentify (Controller, NVME_CNS_NAMESPACE, Nsid);
+    if (EFI_ERROR (Status) || (Data->Nsze == 0)) {
+      continue;
+    }
+
+    Format = &Data->Lbaf[Data->Flbas & 0xF];
+    if ((Format->Ms != 0) || (Format->Lbads < 9) || (Format->Lbads > 16)) {
+      DEBUG ((DEBUG_WARN, "[NVME] Namespace %d: LBA format %d not supported\n", Nsid, Data->Flbas & 0xF));
+      continue;
+    }
+
+    Namespace             = &Controller->Namespaces[Controller->NamespaceCount++];
+    Namespace->Nsid       = Nsid;
+    Namespace->BlockShift = Format->Lbads;
+    Namespace->BlockSize  = 1U << Format->Lbads;
+    Namespace->LastBlock  = Data->Nsze - 1;
+    Namespace->Eui64      = Data->Eui64;
+
+    DEBUG ((
+      DEBUG_INFO,
+      "[NVME] Namespace %d: %lu blocks of %d bytes\n",
+      Nsid,
+      Data->Nsze,
+      Namespace->BlockSize
+      ));
+  }
+}
+
+/**
+  Reset and enable the controller, create the I/O queues and identify
+  the namespaces.
+
+  @param  Controller    Base and RootBridgeIo set; everything else zero.
+
+  @retval EFI_SUCCESS       Controller ready.
+  @retval EFI_UNSUPPORTED   No NVM command set or 4KB pages.
+  @retval others            Controller not usable; its resources are freed.
+**/
+EFI_STATUS
+NvmeControllerInit (
+  IN OUT NVME_CONTROLLER  *Controller
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Elapsed;
+  UINT32      Mdts;
+
+  Controller->Cap            = PlatformMmioRead64 (Controller->Base + NVME_CAP);
+  Controller->DoorbellStride = 4U << NVME_CAP_DSTRD (Controller->Cap);
+  Controller->ReadyTimeout   = MAX (NVME_CAP_TO (Controller->Cap), 1) * 500000;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "[NVME] Version %d.%d, CAP 0x%016lx\n",
+    PlatformMmioRead32 (Controller->Base + NVME_VS) >> 16,
+    (PlatformMmioRead32 (Controller->Base + NVME_VS) >> 8) & 0xFF,
+    Controller->Cap
+    ));
+
+  if (((Controller->Cap & NVME_CAP_CSS_NVM) == 0) || (NVME_CAP_MPSMIN (Controller->Cap) != 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = NvmeDisable (Controller);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[NVME] Controller does not stop: %r\n", Status));
+    return Status;
+  }
+
+  Status = NvmeDmaAllocate (Controller, 1, &Controller->Scratch);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = NvmeQueueAllocate (
+             Controller,
+             &Controller->AdminQueue,
+             0,
+             (UINT16)MIN (NVME_ADMIN_QUEUE_SIZE, NVME_CAP_MQES (Controller->Cap) + 1)
+             );
+  if (EFI_ERROR (Status)) {
+    NvmeDmaFree (Controller, &Controller->Scratch);
+    return Status;
+  }
+
+  //
+  // Interrupts stay masked; the driver polls.
+  //
+  PlatformMmioWrite32 (Controller->Base + NVME_INTMS, MAX_UINT32);
+  PlatformMmioWrite32 (
+    Controller->Base + NVME_AQA,
+    ((UINT32)(Controller->AdminQueue.Size - 1) << 16) | (Controller->AdminQueue.Size - 1)
+    );
+  PlatformMmioWrite64 (Controller->Base + NVME_ASQ, Controller->AdminQueue.SqDevice);
+  PlatformMmioWrite64 (Controller->Base + NVME_ACQ, Controller->AdminQueue.CqDevice);
+  PlatformMmioWrite32 (Controller->Base + NVME_CC, NVME_CC_IOSQES | NVME_CC_IOCQES | NVME_CC_EN);
+
+  Status = PlatformWaitMmio32 (
+             Controller->Base + NVME_CSTS,
+             NVME_CSTS_RDY | NVME_CSTS_CFS,
+             NVME_CSTS_RDY,
+             Controller->ReadyTimeout,
+             &Elapsed
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[NVME] Controller does not become ready: CSTS 0x%x\n", PlatformMmioRead32 (Controller->Base + NVME_CSTS)));
+    goto Fail;
+  }
+
+  DEBUG ((DEBUG_INFO, "[NVME] Ready after %lu us\n", Elapsed));
+
+  Status = NvmeIdentify (Controller, NVME_CNS_CONTROLLER, 0);
+  if (EFI_ERROR (Status)) {
+    goto Fail;
+  }
+
+  CopyMem (&Controller->Identify, Controller->Scratch.Host, sizeof (Controller->Identify));
+  Mdts                      = Controller->Identify.Mdts;
+  Controller->MaxTransfer   = ((Mdts == 0) || (Mdts > 9)) ? NVME_MAX_TRANSFER : MIN (NVME_PAGE_SIZE << Mdts, NVME_MAX_TRANSFER);
+  Controller->SglSupported  = (BOOLEAN)((Controller->Identify.Sgls & NVME_SGLS_SUPPORTED_MASK) != 0);
+  Controller->VolatileCache = (BOOLEAN)((Controller->Identify.Vwc & BIT0) != 0);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "[NVME] %.40a, %d namespaces, %d KB transfers, %a\n",
+    Controller->Identify.Mn,
+    Controller->Identify.Nn,
+    Controller->MaxTransfer / SIZE_1KB,
+    Controller->SglSupported ? "SGL" : "PRP"
+    ));
+
+  Status = NvmeCreateIoQueues (Controller);
+  if (EFI_ERROR (Status)) {
+    goto Fail;
+  }
+
+  DEBUG ((DEBUG_INFO, "[NVME] %d I/O queue pairs of %d entries\n", Controller->IoQueueCount, Controller->IoQueues[0].Size));
+
+  NvmeIdentifyNamespaces (Controller);
+  return EFI_SUCCESS;
+
+Fail:
+  NvmeDisable (Controller);
+  NvmeReleaseQueues (Controller);
+  return Status;
+}
+
+/**
+  Shut the controller down so it flushes its volatile write cache. Its
+  memory stays allocated, as nothing may be freed at ExitBootServices.
+
+  @param  Controller    NVMe controller.
+**/
+VOID
+NvmeControllerShutdown (
+  IN OUT NVME_CONTROLLER  *Controller
+  )
+{
+  UINT32      Config;
+  UINT64      Elapsed;
+  EFI_STATUS  Status;
+
+  Config = PlatformMmioRead32 (Controller->Base + NVME_CC);
+  if ((Config & NVME_CC_EN) == 0) {
+    return;
+  }
+
+  PlatformMmioWrite32 (Controller->Base + NVME_CC, (Config & ~NVME_CC_SHN_MASK) | NVME_CC_SHN_NORMAL);
+  Status = PlatformWaitMmio32 (
+             Controller->Base + NVME_CSTS,
+             NVME_CSTS_SHST_MASK,
+             NVME_CSTS_SHST_COMPLETE,
+             Controller->ReadyTimeout,
+             &Elapsed
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[NVME] Shutdown: %r after %lu us\n", Status, Elapsed));
+  }
+}
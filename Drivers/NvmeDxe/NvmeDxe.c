@@ -0,0 +1,258 @@
+/** @file
+  NVMe boot driver for Raspberry Pi 5 D-step
+
+  There is no PCI bus driver on this platform, so the driver finds the
+  controller on the bus behind the BCM2712 root port itself and reaches
+  it through the root bridge I/O protocol, which also provides its DMA
+  mappings. The controller is shut down at ExitBootServices so that its
+  write cache is flushed before the OS takes over.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmeDxe.h"
+
+/**
+  Find the NVMe function on the bus behind the root port and the CPU
+  address of its registers.
+
+  @param  RootBridgeIo  Root bridge of the PCIe controller.
+  @param  Function      Function number.
+  @param  Base          CPU address of BAR0.
+
+  @retval EFI_SUCCESS   Found.
+  @retval EFI_NOT_FOUND No NVMe controller, or one without a memory BAR.
+**/
+STATIC
+EFI_STATUS
+NvmeFindController (
+  IN  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL  *RootBridgeIo,
+  OUT UINT8                            *Function,
+  OUT UINTN                            *Base
+  )
+{
+  UINT8   Index;
+  UINT32  Id;
+  UINT32  ClassCode;
+  UINT32  Bar[2];
+  UINT64  Address;
+
+  for (Index = 0; Index < NVME_PCI_MAX_FUNCTIONS; Index++) {
+    RootBridgeIo->Pci.Read (RootBridgeIo, EfiPciWidthUint32, EFI_PCI_ADDRESS (NVME_PCI_BUS, 0, Index, PCI_VENDOR_ID_OFFSET), 1, &Id);
+    if ((UINT16)Id == 0xFFFF) {
+      if (Index == 0) {
+        break;
+      }
+
+      continue;
+    }
+
+    RootBridgeIo->Pci.Read (RootBridgeIo, EfiPciWidthUint32, EFI_PCI_ADDRESS (NVME_PCI_BUS, 0, Index, PCI_REVISION_ID_OFFSET), 1, &ClassCode);
+    if ((ClassCode >> 8) != ((PCI_CLASS_MASS_STORAGE << 16) | (PCI_CLASS_MASS_STORAGE_SOLID_STATE << 8) | PCI_IF_MASS_STORAGE_SOLID_STATE_ENTERPRISE_NVMHCI)) {
+      continue;
+    }
+
+    RootBridgeIo->Pci.Read (RootBridgeIo, EfiPciWidthUint32, EFI_PCI_ADDRESS (NVME_PCI_BUS, 0, Index, PCI_BASE_ADDRESSREG_OFFSET), 2, Bar);
+    Address = Bar[0] & ~0xFU;
+    if ((Bar[0] & 0x6) == 0x4) {
+      Address |= LShiftU64 (Bar[1], 32);
+    }
+
+    if (((Bar[0] & BIT0) != 0) || (Address < RPI5D_PCIE_MEM_BUS_BASE) || (Address >= RPI5D_PCIE_MEM_BUS_BASE + RPI5D_PCIE_MEM_SIZE)) {
+      DEBUG ((DEBUG_ERROR, "[NVME] 01:00.%d BAR0 0x%lx is outside the memory window\n", Index, Address));
+      continue;
+    }
+
+    DEBUG ((DEBUG_INFO, "[NVME] Controller %04x:%04x at 01:00.%d\n", (UINT16)Id, Id >> 16, Index));
+    *Function = Index;
+    *Base     = (UINTN)(Address - RPI5D_PCIE_MEM_BUS_BASE + RPI5D_PCIE_MEM_BASE);
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Build the device path of the controller below the root bridge.
+
+  @param  RootBridgeHandle  Handle of the root bridge I/O protocol.
+  @param  Function          Function of the controller.
+
+  @return Allocated device path, or NULL.
+**/
+STATIC
+EFI_DEVICE_PATH_PROTOCOL *
+NvmeBuildDevicePath (
+  IN EFI_HANDLE  RootBridgeHandle,
+  IN UINT8       Function
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL  *RootBridgePath;
+  EFI_DEVICE_PATH_PROTOCOL  *RootPortPath;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  NVME_PCI_DEVICE_PATH      Node;
+  EFI_STATUS                Status;
+
+  Status = gBS->HandleProtocol (RootBridgeHandle, &gEfiDevicePathProtocolGuid, (VOID **)&RootBridgePath);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  ZeroMem (&Node, sizeof (Node));
+  Node.RootPort.Header.Type      = HARDWARE_DEVICE_PATH;
+  Node.RootPort.Header.SubType   = HW_PCI_DP;
+  SetDevicePathNodeLength (&Node.RootPort.Header, sizeof (PCI_DEVICE_PATH));
+  Node.Controller.Header.Type    = HARDWARE_DEVICE_PATH;
+  Node.Controller.Header.SubType = HW_PCI_DP;
+  SetDevicePathNodeLength (&Node.Controller.Header, sizeof (PCI_DEVICE_PATH));
+  Node.Controller.Function       = Function;
+  SetDevicePathEndNode (&Node.End);
+
+  RootPortPath = AppendDevicePathNode (RootBridgePath, &Node.RootPort.Header);
+  if (RootPortPath == NULL) {
+    return NULL;
+  }
+
+  DevicePath = AppendDevicePathNode (RootPortPath, &Node.Controller.Header);
+  FreePool (RootPortPath);
+  return DevicePath;
+}
+
+/**
+  Shut the controller down before the OS takes over.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Driver private data.
+**/
+STATIC
+VOID
+EFIAPI
+NvmeExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  NVME_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  gBS->SetTimer (Private->PollTimer, TimerCancel, 0);
+  NvmeControllerShutdown (&Private->Controller);
+}
+
+/**
+  Entry point of the NVMe driver.
+
+  @param  ImageHandle   EFI_HANDLE.
+  @param  SystemTable   EFI_SYSTEM_TABLE.
+
+  @retval EFI_SUCCESS   Driver initialized successfully.
+  @retval EFI_NOT_FOUND No NVMe controller on the PCIe link.
+**/
+EFI_STATUS
+EFIAPI
+NvmeDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS         Status;
+  NVME_PRIVATE_DATA  *Private;
+  EFI_HANDLE         *Handles;
+  UINTN              HandleCount;
+  UINT8              Function;
+  UINTN              Base;
+
+  Private = AllocateZeroPool (sizeof (NVME_PRIVATE_DATA));
+  if (Private == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Private->Signature = NVME_PRIVATE_SIGNATURE;
+  InitializeListHead (&Private->AsyncList);
+
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiPciRootBridgeIoProtocolGuid, NULL, &HandleCount, &Handles);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[NVME] PCIe root bridge not found: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
+  Status = gBS->HandleProtocol (Handles[0], &gEfiPciRootBridgeIoProtocolGuid, (VOID **)&Private->Controller.RootBridgeIo);
+  if (!EFI_ERROR (Status)) {
+    Status = NvmeFindController (Private->Controller.RootBridgeIo, &Function, &Base);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Private->DevicePath = NvmeBuildDevicePath (Handles[0], Function);
+    if (Private->DevicePath == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  FreePool (Handles);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "[NVME] No controller: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
+  Private->Controller.Base = Base;
+  Status                   = NvmeControllerInit (&Private->Controller);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[NVME] Controller init failed: %r\n", Status));
+    FreePool (Private->DevicePath);
+    FreePool (Private);
+    return Status;
+  }
+
+  NvmeInitPassThru (Private);
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, NVME_TPL, NvmePollAsync, Private, &Private->PollTimer);
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (Private->PollTimer, TimerPeriodic, NVME_POLL_INTERVAL);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (
+                    EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                    TPL_CALLBACK,
+                    NvmeExitBootServices,
+                    Private,
+                    &Private->ExitBootServicesEvent
+                    );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Private->Handle,
+                    &gEfiNvmExpressPassThruProtocolGuid, &Private->PassThru,
+                    &gEfiDevicePathProtocolGuid, Private->DevicePath,
+                    NULL
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // The controller keeps its queues until it is shut down; their
+    // memory is left allocated rather than freed under a live device.
+    //
+    DEBUG ((DEBUG_ERROR, "[NVME] Driver setup failed: %r\n", Status));
+    if (Private->ExitBootServicesEvent != NULL) {
+      gBS->CloseEvent (Private->ExitBootServicesEvent);
+    }
+
+    if (Private->PollTimer != NULL) {
+      gBS->CloseEvent (Private->PollTimer);
+    }
+
+    NvmeControllerShutdown (&Private->Controller);
+    return Status;
+  }
+
+  NvmeInstallDisks (Private);
+
+  DEBUG ((DEBUG_INFO, "[NVME] Driver loaded, %d namespaces\n", Private->Controller.NamespaceCount));
+  return EFI_SUCCESS;
+}
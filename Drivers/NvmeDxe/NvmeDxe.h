@@ -0,0 +1,153 @@
+/** @file
+  NVMe boot driver for Raspberry Pi 5 D-step
+
+  Drives the NVMe controller behind the BCM2712 PCIe root port through
+  the root bridge I/O protocol, and publishes the NVM Express pass thru
+  protocol on the controller and Block I/O and Block I/O 2 on each
+  namespace.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef NVME_DXE_H_
+#define NVME_DXE_H_
+
+#include "NvmeHc.h"
+#include <IndustryStandard/Pci.h>
+#include <Library/DevicePathLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
+#include <Protocol/DevicePath.h>
+#include <Protocol/NvmExpressPassthru.h>
+
+//
+// The controller is a function of the device behind the root port.
+//
+#define NVME_PCI_BUS                1
+#define NVME_PCI_MAX_FUNCTIONS      8
+
+//
+// Requests are serialized at this TPL; the poll timer completes Block
+// I/O 2 tokens every NVME_POLL_INTERVAL (100 ns units).
+//
+#define NVME_TPL                    TPL_NOTIFY
+#define NVME_POLL_INTERVAL          10000
+
+typedef struct _NVME_PRIVATE_DATA  NVME_PRIVATE_DATA;
+
+//
+// Device path of the controller: root bridge, root port, function
+//
+#pragma pack(1)
+typedef struct {
+  PCI_DEVICE_PATH             RootPort;
+  PCI_DEVICE_PATH             Controller;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} NVME_PCI_DEVICE_PATH;
+
+typedef struct {
+  NVME_NAMESPACE_DEVICE_PATH    Namespace;
+  EFI_DEVICE_PATH_PROTOCOL      End;
+} NVME_DISK_DEVICE_PATH;
+#pragma pack()
+
+//
+// One namespace, published as a disk
+//
+typedef struct {
+  UINT32                      Signature;
+  NVME_PRIVATE_DATA           *Private;
+  NVME_NAMESPACE              *Namespace;
+  EFI_HANDLE                  Handle;
+  EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
+  EFI_BLOCK_IO_MEDIA          Media;
+  EFI_BLOCK_IO_PROTOCOL       BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL      BlockIo2;
+} NVME_DISK;
+
+#define NVME_DISK_SIGNATURE  SIGNATURE_32 ('N', 'V', 'M', 'D')
+#define NVME_DISK_FROM_BLOCK_IO(a) \
+  CR (a, NVME_DISK, BlockIo, NVME_DISK_SIGNATURE)
+#define NVME_DISK_FROM_BLOCK_IO2(a) \
+  CR (a, NVME_DISK, BlockIo2, NVME_DISK_SIGNATURE)
+
+//
+// Block I/O 2 request in flight
+//
+typedef struct {
+  UINT32                 Signature;
+  LIST_ENTRY             Link;
+  NVME_TRANSFER          Transfer;
+  EFI_BLOCK_IO2_TOKEN    *Token;
+} NVME_ASYNC_REQUEST;
+
+#define NVME_ASYNC_SIGNATURE  SIGNATURE_32 ('N', 'V', 'M', 'A')
+#define NVME_ASYNC_FROM_LINK(a) \
+  CR (a, NVME_ASYNC_REQUEST, Link, NVME_ASYNC_SIGNATURE)
+
+//
+// Driver private data
+//
+struct _NVME_PRIVATE_DATA {
+  UINT32                                Signature;
+  EFI_HANDLE                            Handle;
+  EFI_DEVICE_PATH_PROTOCOL              *DevicePath;
+  NVME_CONTROLLER                       Controller;
+  EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL    PassThru;
+  EFI_NVM_EXPRESS_PASS_THRU_MODE        PassThruMode;
+  NVME_DISK                             *Disks[NVME_MAX_NAMESPACES];
+  LIST_ENTRY                            AsyncList;
+  EFI_EVENT                             PollTimer;
+  EFI_EVENT                             ExitBootServicesEvent;
+};
+
+#define NVME_PRIVATE_SIGNATURE  SIGNATURE_32 ('N', 'V', 'M', 'E')
+#define NVME_PRIVATE_FROM_PASS_THRU(a) \
+  CR (a, NVME_PRIVATE_DATA, PassThru, NVME_PRIVATE_SIGNATURE)
+
+//
+// NvmeBlockIo.c
+//
+
+/**
+  Publish Block I/O and Block I/O 2 for every namespace.
+
+  @param  Private       Driver private data with an initialized controller.
+**/
+VOID
+NvmeInstallDisks (
+  IN NVME_PRIVATE_DATA  *Private
+  );
+
+/**
+  Complete Block I/O 2 requests whose commands have finished.
+
+  @param  Event         Poll timer.
+  @param  Context       Driver private data.
+**/
+VOID
+EFIAPI
+NvmePollAsync (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
+//
+// NvmePassThru.c
+//
+
+/**
+  Fill in the NVM Express pass thru protocol and its mode.
+
+  @param  Private       Driver private data with an initialized controller.
+**/
+VOID
+NvmeInitPassThru (
+  IN NVME_PRIVATE_DATA  *Private
+  );
+
+#endif
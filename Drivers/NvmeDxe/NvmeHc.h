@@ -0,0 +1,537 @@
+/** @file
+  NVMe controller engine of NvmeDxe
+
+  Register layout, queue entry formats and the queue engine shared by
+  the controller, queue, Block I/O and pass thru modules. The engine
+  (NvmeController.c, NvmeQueue.c) only uses the PCI root bridge I/O
+  protocol, PlatformMmioLib and base libraries, so Host/NvmeModelTest.c
+  builds it unchanged against a software controller.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef NVME_HC_H_
+#define NVME_HC_H_
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Protocol/PciRootBridgeIo.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+#include "../../Include/Platform/RPi5D.h"
+
+// Controller registers
+#define NVME_CAP                  0x0000
+#define NVME_VS                   0x0008
+#define NVME_INTMS                0x000C
+#define NVME_CC                   0x0014
+#define NVME_CSTS                 0x001C
+#define NVME_AQA                  0x0024
+#define NVME_ASQ                  0x0028
+#define NVME_ACQ                  0x0030
+#define NVME_DOORBELL             0x1000
+
+// Controller capabilities
+#define NVME_CAP_MQES(Cap)        ((UINT32)((Cap) & 0xFFFF))
+#define NVME_CAP_TO(Cap)          ((UINT32)RShiftU64 ((Cap), 24) & 0xFF)      // 500 ms units
+#define NVME_CAP_DSTRD(Cap)       ((UINT32)RShiftU64 ((Cap), 32) & 0xF)
+#define NVME_CAP_CSS_NVM          BIT37
+#define NVME_CAP_MPSMIN(Cap)      ((UINT32)RShiftU64 ((Cap), 48) & 0xF)
+
+// Controller configuration
+#define NVME_CC_EN                BIT0
+#define NVME_CC_IOSQES            (6 << 16)       // 64-byte submission entries
+#define NVME_CC_IOCQES            (4 << 20)       // 16-byte completion entries
+#define NVME_CC_SHN_NORMAL        (1 << 14)
+#define NVME_CC_SHN_MASK          (3 << 14)
+
+// Controller status
+#define NVME_CSTS_RDY             BIT0
+#define NVME_CSTS_CFS             BIT1
+#define NVME_CSTS_SHST_MASK       (3 << 2)
+#define NVME_CSTS_SHST_COMPLETE   (2 << 2)
+
+// Admin commands
+#define NVME_ADMIN_CREATE_IO_SQ   0x01
+#define NVME_ADMIN_CREATE_IO_CQ   0x05
+#define NVME_ADMIN_IDENTIFY       0x06
+#define NVME_ADMIN_SET_FEATURES   0x09
+
+#define NVME_CNS_NAMESPACE        0x00
+#define NVME_CNS_CONTROLLER       0x01
+#define NVME_FEATURE_QUEUES       0x07
+
+// NVM commands
+#define NVME_IO_FLUSH             0x00
+#define NVME_IO_WRITE             0x01
+#define NVME_IO_READ              0x02
+
+//
+// Data pointer type in the command flags: PRP, or an SGL whose first
+// descriptor is in the command.
+//
+#define NVME_FLAGS_PSDT_MASK      0xC0
+#define NVME_FLAGS_PSDT_SGL       0x40
+
+// SGL descriptor identifier of a Data Block descriptor
+#define NVME_SGL_DATA_BLOCK       0x00
+
+// Controller SGL support (Identify Controller SGLS bits 1:0)
+#define NVME_SGLS_SUPPORTED_MASK  0x3
+
+// Completion status: phase tag in bit 0, then SC and SCT
+#define NVME_CQE_PHASE            BIT0
+#define NVME_CQE_STATUS(Status)   (((Status) >> 1) & 0x7FF)
+
+//
+// Queue sizes. An I/O queue pair is created for every core, up to what
+// the controller grants, and I/O is spread over them so the controller
+// always has several queues to fetch from. One page holds a submission
+// queue of NVME_IO_QUEUE_SIZE entries.
+//
+#define NVME_ADMIN_QUEUE_SIZE     32
+#define NVME_IO_QUEUE_SIZE        64
+#define NVME_MAX_IO_QUEUES        RPI5D_CORE_COUNT
+
+//
+// Largest single command. Longer transfers are split into commands of
+// this size and queued together. With PRPs a command needs up to
+// NVME_PRP_LIST_PAGES of list per slot; with SGLs it needs none.
+//
+#define NVME_PAGE_SIZE            SIZE_4KB
+#define NVME_MAX_TRANSFER         SIZE_2MB
+#define NVME_PRP_PER_PAGE         (NVME_PAGE_SIZE / sizeof (UINT64))
+#define NVME_PRP_LIST_PAGES       \
+  (((NVME_MAX_TRANSFER / NVME_PAGE_SIZE) + NVME_PRP_PER_PAGE - 3) / (NVME_PRP_PER_PAGE - 1))
+
+#define NVME_MAX_NAMESPACES       8
+
+//
+// Timeouts, in microseconds
+//
+#define NVME_ADMIN_TIMEOUT        5000000
+#define NVME_IO_TIMEOUT           30000000
+
+#define NVME_CACHE_LINE_SIZE      64
+
+//
+// Queue entries
+//
+#pragma pack(1)
+typedef struct {
+  UINT8     Opcode;
+  UINT8     Flags;
+  UINT16    Cid;
+  UINT32    Nsid;
+  UINT32    Cdw2;
+  UINT32    Cdw3;
+  UINT64    Mptr;
+  UINT64    Dptr[2];      // PRP1 and PRP2, or an SGL descriptor
+  UINT32    Cdw10;
+  UINT32    Cdw11;
+  UINT32    Cdw12;
+  UINT32    Cdw13;
+  UINT32    Cdw14;
+  UINT32    Cdw15;
+} NVME_SQE;
+
+typedef struct {
+  UINT32    Dw0;
+  UINT32    Dw1;
+  UINT16    SqHead;
+  UINT16    SqId;
+  UINT16    Cid;
+  UINT16    Status;
+} NVME_CQE;
+
+typedef struct {
+  UINT64    Address;
+  UINT32    Length;
+  UINT8     Reserved[3];
+  UINT8     Identifier;
+} NVME_SGL_DESCRIPTOR;
+
+//
+// Identify data, the fields the driver uses
+//
+typedef struct {
+  UINT16    Vid;
+  UINT16    Ssvid;
+  CHAR8     Sn[20];
+  CHAR8     Mn[40];
+  CHAR8     Fr[8];
+  UINT8     Rab;
+  UINT8     Ieee[3];
+  UINT8     Cmic;
+  UINT8     Mdts;
+  UINT16    Cntlid;
+  UINT32    Ver;
+  UINT8     Reserved1[428];
+  UINT8     Sqes;
+  UINT8     Cqes;
+  UINT16    Maxcmd;
+  UINT32    Nn;
+  UINT16    Oncs;
+  UINT16    Fuses;
+  UINT8     Fna;
+  UINT8     Vwc;
+  UINT16    Awun;
+  UINT16    Awupf;
+  UINT8     Nvscc;
+  UINT8     Nwpc;
+  UINT16    Acwu;
+  UINT16    Reserved2;
+  UINT32    Sgls;
+  UINT8     Reserved3[3556];
+} NVME_IDENTIFY_CONTROLLER;
+
+typedef struct {
+  UINT16    Ms;
+  UINT8     Lbads;
+  UINT8     Rp;
+} NVME_LBA_FORMAT;
+
+typedef struct {
+  UINT64             Nsze;
+  UINT64             Ncap;
+  UINT64             Nuse;
+  UINT8              Nsfeat;
+  UINT8              Nlbaf;
+  UINT8              Flbas;
+  UINT8              Mc;
+  UINT8              Dpc;
+  UINT8              Dps;
+  UINT8              Nmic;
+  UINT8              Rescap;
+  UINT8              Reserved1[88];
+  UINT64             Eui64;
+  NVME_LBA_FORMAT    Lbaf[16];
+  UINT8              Reserved2[3904];
+} NVME_IDENTIFY_NAMESPACE;
+#pragma pack()
+
+STATIC_ASSERT (sizeof (NVME_SQE) == 64, "Submission queue entries are 64 bytes");
+STATIC_ASSERT (sizeof (NVME_CQE) == 16, "Completion queue entries are 16 bytes");
+STATIC_ASSERT (OFFSET_OF (NVME_IDENTIFY_CONTROLLER, Sgls) == 536, "SGLS is at byte 536");
+STATIC_ASSERT (sizeof (NVME_IDENTIFY_CONTROLLER) == SIZE_4KB, "Identify data is one page");
+STATIC_ASSERT (OFFSET_OF (NVME_IDENTIFY_NAMESPACE, Lbaf) == 128, "LBAF0 is at byte 128");
+STATIC_ASSERT (sizeof (NVME_IDENTIFY_NAMESPACE) == SIZE_4KB, "Identify data is one page");
+
+//
+// DMA memory shared with the controller
+//
+typedef struct {
+  VOID                    *Host;
+  EFI_PHYSICAL_ADDRESS    Device;
+  UINTN                   Pages;
+  VOID                    *Mapping;
+} NVME_DMA_BUFFER;
+
+typedef struct _NVME_QUEUE    NVME_QUEUE;
+typedef struct _NVME_REQUEST  NVME_REQUEST;
+
+/**
+  Called when a request completes, after its data has been unmapped.
+
+  @param  Request       Completed request; Status and Completion are set.
+**/
+typedef
+VOID
+(*NVME_REQUEST_DONE)(
+  IN NVME_REQUEST  *Request
+  );
+
+//
+// One command. The caller fills in Command except for the command ID
+// and data pointer, and Buffer, Length and Write; the engine maps the
+// buffer and builds the PRPs or the SGL.
+//
+struct _NVME_REQUEST {
+  NVME_SQE             Command;
+  VOID                 *Buffer;
+  UINT32               Length;
+  BOOLEAN              Write;           // memory to device
+  NVME_REQUEST_DONE    DoneCallback;    // OPTIONAL
+  VOID                 *Context;
+
+  //
+  // Set by the engine
+  //
+  NVME_QUEUE           *Queue;
+  VOID                 *Mapping;
+  BOOLEAN              Done;
+  EFI_STATUS           Status;
+  NVME_CQE             Completion;
+  NVME_REQUEST         *Next;           // reaped in the same pass
+};
+
+//
+// Submission and completion queue pair. Command IDs are slot numbers in
+// Requests, taken from the FreeCids stack.
+//
+struct _NVME_QUEUE {
+  UINT16                QueueId;
+  UINT16                Size;
+  NVME_DMA_BUFFER       Memory;           // SQ page, then the CQ
+  NVME_SQE              *Sq;
+  NVME_CQE              *Cq;
+  EFI_PHYSICAL_ADDRESS  SqDevice;
+  EFI_PHYSICAL_ADDRESS  CqDevice;
+  UINTN                 SqDoorbell;
+  UINTN                 CqDoorbell;
+  UINT16                SqTail;
+  UINT16                SqRung;           // SqTail as last written to the doorbell
+  UINT16                CqHead;
+  UINT8                 Phase;
+  NVME_DMA_BUFFER       PrpLists;         // NVME_PRP_LIST_PAGES per slot, without SGLs
+  NVME_REQUEST          **Requests;
+  UINT16                *FreeCids;
+  UINT16                FreeCount;
+};
+
+//
+// Namespace formatted without metadata
+//
+typedef struct {
+  UINT32     Nsid;
+  UINT32     BlockSize;
+  UINT8      BlockShift;
+  UINT64     LastBlock;
+  UINT64     Eui64;
+} NVME_NAMESPACE;
+
+//
+// Controller
+//
+typedef struct {
+  UINTN                              Base;
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL    *RootBridgeIo;
+  UINT64                             Cap;
+  UINT32                             DoorbellStride;
+  UINT32                             ReadyTimeout;      // microseconds
+  UINT32                             MaxTransfer;
+  BOOLEAN                            SglSupported;
+  BOOLEAN                            VolatileCache;
+  NVME_DMA_BUFFER                    Scratch;           // identify data
+  NVME_IDENTIFY_CONTROLLER           Identify;
+  NVME_QUEUE                         AdminQueue;
+  NVME_QUEUE                         IoQueues[NVME_MAX_IO_QUEUES];
+  UINTN                              IoQueueCount;
+  UINTN                              NextQueue;
+  UINTN                              PollDepth;         // callbacks running
+  UINT32                             DeferredRings;     // I/O queues to ring after them
+  NVME_NAMESPACE                     Namespaces[NVME_MAX_NAMESPACES];
+  UINTN                              NamespaceCount;
+} NVME_CONTROLLER;
+
+//
+// Transfer of any length on one namespace, split into commands of at
+// most MaxTransfer and spread over the I/O queues. Commands are queued
+// as slots free up, with one doorbell write per queue per batch.
+//
+typedef struct _NVME_TRANSFER  NVME_TRANSFER;
+
+typedef
+VOID
+(*NVME_TRANSFER_DONE)(
+  IN NVME_TRANSFER  *Transfer
+  );
+
+struct _NVME_TRANSFER {
+  NVME_CONTROLLER       *Controller;
+  NVME_NAMESPACE        *Namespace;
+  UINT8                 Opcode;           // NVME_IO_READ, NVME_IO_WRITE or NVME_IO_FLUSH
+  EFI_LBA               Lba;              // next block to queue
+  UINT8                 *Buffer;          // its data
+  UINTN                 Blocks;           // blocks not yet queued
+  UINTN                 Outstanding;      // commands in flight
+  BOOLEAN               Queued;           // everything queued
+  EFI_STATUS            Status;
+  NVME_TRANSFER_DONE    DoneCallback;     // OPTIONAL
+  VOID                  *Context;
+};
+
+//
+// NvmeController.c
+//
+
+/**
+  Allocate and map DMA memory the controller reads and writes.
+
+  @param  Controller    NVMe controller.
+  @param  Pages         Size in pages.
+  @param  Buffer        Filled in; the memory is zeroed.
+
+  @retval EFI_SUCCESS   Allocated.
+  @retval others        Allocation or mapping failed.
+**/
+EFI_STATUS
+NvmeDmaAllocate (
+  IN  NVME_CONTROLLER  *Controller,
+  IN  UINTN            Pages,
+  OUT NVME_DMA_BUFFER  *Buffer
+  );
+
+/**
+  Unmap and free DMA memory.
+**/
+VOID
+NvmeDmaFree (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_DMA_BUFFER  *Buffer
+  );
+
+/**
+  Reset and enable the controller, create the I/O queues and identify
+  the namespaces.
+
+  @param  Controller    Base and RootBridgeIo set; everything else zero.
+
+  @retval EFI_SUCCESS   Controller ready.
+  @retval others        Controller not usable; its resources are freed.
+**/
+EFI_STATUS
+NvmeControllerInit (
+  IN OUT NVME_CONTROLLER  *Controller
+  );
+
+/**
+  Shut the controller down so it flushes its volatile write cache. Its
+  memory stays allocated.
+
+  @param  Controller    NVMe controller.
+**/
+VOID
+NvmeControllerShutdown (
+  IN OUT NVME_CONTROLLER  *Controller
+  );
+
+//
+// NvmeQueue.c
+//
+
+/**
+  Set up the ring state and command ID stack of a queue whose Memory and
+  Size are set.
+
+  @retval EFI_SUCCESS           Ready.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the slot tables.
+**/
+EFI_STATUS
+NvmeQueueInit (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_QUEUE       *Queue,
+  IN     UINT16           QueueId
+  );
+
+/**
+  Free the slot tables and PRP lists of a queue.
+**/
+VOID
+NvmeQueueFree (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_QUEUE       *Queue
+  );
+
+/**
+  Place a request in the submission queue without ringing the doorbell.
+
+  @retval EFI_SUCCESS           Queued; NvmeRing makes it visible.
+  @retval EFI_NOT_READY         The queue is full.
+  @retval others                The buffer could not be mapped.
+**/
+EFI_STATUS
+NvmeSubmit (
+  IN     NVME_CONTROLLER  *Controller,
+  IN     NVME_QUEUE       *Queue,
+  IN OUT NVME_REQUEST     *Request
+  );
+
+/**
+  Hand every request queued since the last call to the controller with
+  one doorbell write.
+**/
+VOID
+NvmeRing (
+  IN NVME_QUEUE  *Queue
+  );
+
+/**
+  Reap completed requests from a queue and call their callbacks. Work
+  the callbacks queue is rung once they have all run.
+
+  @return Number of requests completed.
+**/
+UINTN
+NvmePoll (
+  IN NVME_CONTROLLER  *Controller,
+  IN NVME_QUEUE       *Queue
+  );
+
+/**
+  Reap completed requests from every I/O queue.
+**/
+UINTN
+NvmePollIoQueues (
+  IN NVME_CONTROLLER  *Controller
+  );
+
+/**
+  Submit one request, waiting for a free slot if needed, and wait for it.
+
+  @param  Timeout       Microseconds; 0 waits forever.
+
+  @retval EFI_SUCCESS   Completed successfully.
+  @retval EFI_TIMEOUT   Did not complete in time; the request is abandoned.
+  @retval others        Submission or command failure.
+**/
+EFI_STATUS
+NvmeExecute (
+  IN     NVME_CONTROLLER  *Controller,
+  IN     NVME_QUEUE       *Queue,
+  IN OUT NVME_REQUEST     *Request,
+  IN     UINT64           Timeout
+  );
+
+/**
+  Start a transfer: queue as many of its commands as the I/O queues have
+  room for. The rest follow as earlier ones complete.
+
+  @retval EFI_SUCCESS   Started; DoneCallback runs when it is over.
+  @retval others        Nothing could be queued.
+**/
+EFI_STATUS
+NvmeTransferStart (
+  IN OUT NVME_TRANSFER  *Transfer
+  );
+
+/**
+  Detach the commands of a transfer still in flight so their slots
+  retire without calling back into it.
+**/
+VOID
+NvmeTransferAbandon (
+  IN OUT NVME_TRANSFER  *Transfer
+  );
+
+/**
+  Poll until a started transfer is over.
+
+  @param  Timeout       Microseconds without progress before giving up.
+
+  @return Status of the transfer, or EFI_TIMEOUT once it is abandoned.
+**/
+EFI_STATUS
+NvmeTransferWait (
+  IN OUT NVME_TRANSFER  *Transfer,
+  IN     UINT64         Timeout
+  );
+
+#endif
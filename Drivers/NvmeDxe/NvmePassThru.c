@@ -0,0 +1,312 @@
+/** @file
+  NVM Express pass thru protocol.
+
+  Commands run through the same queues as Block I/O: admin commands on
+  the admin queue, NVM commands on the first I/O queue. They are always
+  blocking; the Event parameter is ignored, as the protocol allows when
+  EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_NONBLOCKIO is not reported.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmeDxe.h"
+
+/**
+  Send an NVM Express command and wait for it.
+
+  @param  This          Pass thru protocol instance.
+  @param  NamespaceId   Namespace the command is for.
+  @param  Packet        Command, data and completion.
+  @param  Event         Ignored.
+
+  @retval EFI_SUCCESS           Completed; the completion is in Packet.
+  @retval EFI_BAD_BUFFER_SIZE   TransferLength could not be mapped.
+  @retval EFI_DEVICE_ERROR      The command failed; the completion is in Packet.
+  @retval EFI_INVALID_PARAMETER Packet invalid.
+  @retval EFI_UNSUPPORTED       Metadata was passed.
+  @retval EFI_TIMEOUT           CommandTimeout expired.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmePassThruPassThru (
+  IN     EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL        *This,
+  IN     UINT32                                    NamespaceId,
+  IN OUT EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  *Packet,
+  IN     EFI_EVENT                                 Event OPTIONAL
+  )
+{
+  NVME_PRIVATE_DATA        *Private;
+  NVME_CONTROLLER          *Controller;
+  NVME_QUEUE               *Queue;
+  EFI_NVM_EXPRESS_COMMAND  *Command;
+  NVME_REQUEST             Request;
+  EFI_STATUS               Status;
+  EFI_TPL                  OldTpl;
+  UINT64                   Timeout;
+
+  Private    = NVME_PRIVATE_FROM_PASS_THRU (This);
+  Controller = &Private->Controller;
+
+  if ((Packet == NULL) || (Packet->NvmeCmd == NULL) || (Packet->NvmeCompletion == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((Packet->QueueType != NVME_ADMIN_QUEUE) && (Packet->QueueType != NVME_IO_QUEUE)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((Packet->TransferLength != 0) &&
+      ((Packet->TransferBuffer == NULL) || (((UINTN)Packet->TransferBuffer & (This->Mode->IoAlign - 1)) != 0)))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((Packet->MetadataBuffer != NULL) || (Packet->MetadataLength != 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Admin data is at most a page and goes through PRPs without a list;
+  // I/O data is limited to what one command may carry.
+  //
+  if (Packet->QueueType == NVME_ADMIN_QUEUE) {
+    if (Packet->TransferLength > NVME_PAGE_SIZE - ((UINTN)Packet->TransferBuffer & (NVME_PAGE_SIZE - 1)) + NVME_PAGE_SIZE) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    Queue = &Controller->AdminQueue;
+  } else {
+    if (Packet->TransferLength > Controller->MaxTransfer) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    Queue = &Controller->IoQueues[0];
+  }
+
+  Command = Packet->NvmeCmd;
+  ZeroMem (&Request, sizeof (Request));
+  Request.Command.Opcode = (UINT8)Command->Cdw0.Opcode;
+  Request.Command.Flags  = (UINT8)Command->Cdw0.FusedOperation;
+  Request.Command.Nsid   = NamespaceId;
+  Request.Command.Cdw2   = ((Command->Flags & CDW2_VALID) != 0) ? Command->Cdw2 : 0;
+  Request.Command.Cdw3   = ((Command->Flags & CDW3_VALID) != 0) ? Command->Cdw3 : 0;
+  Request.Command.Cdw10  = ((Command->Flags & CDW10_VALID) != 0) ? Command->Cdw10 : 0;
+  Request.Command.Cdw11  = ((Command->Flags & CDW11_VALID) != 0) ? Command->Cdw11 : 0;
+  Request.Command.Cdw12  = ((Command->Flags & CDW12_VALID) != 0) ? Command->Cdw12 : 0;
+  Request.Command.Cdw13  = ((Command->Flags & CDW13_VALID) != 0) ? Command->Cdw13 : 0;
+  Request.Command.Cdw14  = ((Command->Flags & CDW14_VALID) != 0) ? Command->Cdw14 : 0;
+  Request.Command.Cdw15  = ((Command->Flags & CDW15_VALID) != 0) ? Command->Cdw15 : 0;
+  Request.Buffer         = Packet->TransferBuffer;
+  Request.Length         = Packet->TransferLength;
+
+  //
+  // Opcode bits 1:0 give the data direction; 01b is host to controller.
+  //
+  Request.Write = (BOOLEAN)((Request.Command.Opcode & 0x3) == 0x1);
+
+  //
+  // CommandTimeout is in 100 ns units, 0 waiting forever.
+  //
+  Timeout = DivU64x32 (Packet->CommandTimeout + 9, 10);
+
+  OldTpl = gBS->RaiseTPL (NVME_TPL);
+  Status = NvmeExecute (Controller, Queue, &Request, Timeout);
+  gBS->RestoreTPL (OldTpl);
+
+  if (Request.Done) {
+    Packet->NvmeCompletion->DW0 = Request.Completion.Dw0;
+    Packet->NvmeCompletion->DW1 = Request.Completion.Dw1;
+    Packet->NvmeCompletion->DW2 = ((UINT32)Request.Completion.SqId << 16) | Request.Completion.SqHead;
+    Packet->NvmeCompletion->DW3 = ((UINT32)Request.Completion.Status << 16) | Request.Completion.Cid;
+  }
+
+  return Status;
+}
+
+/**
+  Walk the namespaces the driver serves.
+
+  @param  This          Pass thru protocol instance.
+  @param  NamespaceId   0xFFFFFFFF to start; the next namespace on return.
+
+  @retval EFI_SUCCESS           Next namespace returned.
+  @retval EFI_NOT_FOUND         No more namespaces.
+  @retval EFI_INVALID_PARAMETER NamespaceId is not one of them.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmePassThruGetNextNamespace (
+  IN     EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL  *This,
+  IN OUT UINT32                              *NamespaceId
+  )
+{
+  NVME_CONTROLLER  *Controller;
+  UINTN            Index;
+
+  if (NamespaceId == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Controller = &NVME_PRIVATE_FROM_PASS_THRU (This)->Controller;
+  if (*NamespaceId == MAX_UINT32) {
+    Index = 0;
+  } else {
+    for (Index = 0; Index < Controller->NamespaceCount; Index++) {
+      if (Controller->Namespaces[Index].Nsid == *NamespaceId) {
+        break;
+      }
+    }
+
+    if (Index == Controller->NamespaceCount) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Index++;
+  }
+
+  if (Index >= Controller->NamespaceCount) {
+    return EFI_NOT_FOUND;
+  }
+
+  *NamespaceId = Controller->Namespaces[Index].Nsid;
+  return EFI_SUCCESS;
+}
+
+/**
+  Find a namespace the driver serves.
+**/
+STATIC
+NVME_NAMESPACE *
+NvmeFindNamespace (
+  IN NVME_CONTROLLER  *Controller,
+  IN UINT32           NamespaceId
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Controller->NamespaceCount; Index++) {
+    if (Controller->Namespaces[Index].Nsid == NamespaceId) {
+      return &Controller->Namespaces[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Build the device path node of a namespace.
+
+  @param  This          Pass thru protocol instance.
+  @param  NamespaceId   Namespace.
+  @param  DevicePath    Allocated node; the caller frees it.
+
+  @retval EFI_SUCCESS           Built.
+  @retval EFI_NOT_FOUND         No such namespace.
+  @retval EFI_INVALID_PARAMETER DevicePath is NULL.
+  @retval EFI_OUT_OF_RESOURCES  No memory.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmePassThruBuildDevicePath (
+  IN     EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL  *This,
+  IN     UINT32                              NamespaceId,
+  OUT    EFI_DEVICE_PATH_PROTOCOL            **DevicePath
+  )
+{
+  NVME_NAMESPACE              *Namespace;
+  NVME_NAMESPACE_DEVICE_PATH  *Node;
+
+  if (DevicePath == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Namespace = NvmeFindNamespace (&NVME_PRIVATE_FROM_PASS_THRU (This)->Controller, NamespaceId);
+  if (Namespace == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Node = AllocateZeroPool (sizeof (NVME_NAMESPACE_DEVICE_PATH));
+  if (Node == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Node->Header.Type    = MESSAGING_DEVICE_PATH;
+  Node->Header.SubType = MSG_NVME_NAMESPACE_DP;
+  SetDevicePathNodeLength (&Node->Header, sizeof (NVME_NAMESPACE_DEVICE_PATH));
+  Node->NamespaceId   = Namespace->Nsid;
+  Node->NamespaceUuid = Namespace->Eui64;
+
+  *DevicePath = &Node->Header;
+  return EFI_SUCCESS;
+}
+
+/**
+  Namespace of a device path node built by BuildDevicePath.
+
+  @param  This          Pass thru protocol instance.
+  @param  DevicePath    Device path node.
+  @param  NamespaceId   Namespace.
+
+  @retval EFI_SUCCESS           Found.
+  @retval EFI_UNSUPPORTED       Not an NVMe namespace node.
+  @retval EFI_NOT_FOUND         Not a namespace the driver serves.
+  @retval EFI_INVALID_PARAMETER An argument is NULL.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+NvmePassThruGetNamespace (
+  IN     EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL  *This,
+  IN     EFI_DEVICE_PATH_PROTOCOL            *DevicePath,
+  OUT    UINT32                              *NamespaceId
+  )
+{
+  NVME_NAMESPACE_DEVICE_PATH  *Node;
+
+  if ((DevicePath == NULL) || (NamespaceId == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((DevicePathType (DevicePath) != MESSAGING_DEVICE_PATH) ||
+      (DevicePathSubType (DevicePath) != MSG_NVME_NAMESPACE_DP) ||
+      (DevicePathNodeLength (DevicePath) != sizeof (NVME_NAMESPACE_DEVICE_PATH)))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Node = (NVME_NAMESPACE_DEVICE_PATH *)DevicePath;
+  if (NvmeFindNamespace (&NVME_PRIVATE_FROM_PASS_THRU (This)->Controller, Node->NamespaceId) == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  *NamespaceId = Node->NamespaceId;
+  return EFI_SUCCESS;
+}
+
+/**
+  Fill in the NVM Express pass thru protocol and its mode.
+
+  @param  Private       Driver private data with an initialized controller.
+**/
+VOID
+NvmeInitPassThru (
+  IN NVME_PRIVATE_DATA  *Private
+  )
+{
+  //
+  // PRP entries and SGL data blocks both need dword aligned data.
+  //
+  Private->PassThruMode.Attributes = EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_PHYSICAL |
+                                     EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_LOGICAL |
+                                     EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_CMD_SET_NVM;
+  Private->PassThruMode.IoAlign     = sizeof (UINT32);
+  Private->PassThruMode.NvmeVersion = PlatformMmioRead32 (Private->Controller.Base + NVME_VS);
+
+  Private->PassThru.Mode             = &Private->PassThruMode;
+  Private->PassThru.PassThru         = NvmePassThruPassThru;
+  Private->PassThru.GetNextNamespace = NvmePassThruGetNextNamespace;
+  Private->PassThru.BuildDevicePath  = NvmePassThruBuildDevicePath;
+  Private->PassThru.GetNamespace     = NvmePassThruGetNamespace;
+}
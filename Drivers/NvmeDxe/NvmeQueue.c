@@ -0,0 +1,797 @@
+/** @file
+  NVMe queue engine.
+
+  Requests are written into the submission queue as they come and the
+  doorbell is written once per batch, so a large transfer costs one
+  register write per queue rather than one per command. Data buffers are
+  mapped in place; a command describes its buffer with one SGL data
+  block descriptor when the controller takes SGLs, and with PRPs, using
+  a preallocated list per slot, when it does not. Completions are reaped
+  by phase tag and acknowledged with one head doorbell write per pass.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmeHc.h"
+
+/**
+  Set up the ring state and command ID stack of a queue whose Memory and
+  Size are set: the submission queue fills the first page of Memory and
+  the completion queue follows it.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to set up.
+  @param  QueueId       0 for the admin queue.
+
+  @retval EFI_SUCCESS           Ready.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the slot tables.
+**/
+EFI_STATUS
+NvmeQueueInit (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_QUEUE       *Queue,
+  IN     UINT16           QueueId
+  )
+{
+  EFI_STATUS  Status;
+  UINT16      Slot;
+  UINTN       SqBytes;
+
+  SqBytes           = ALIGN_VALUE (Queue->Size * sizeof (NVME_SQE), NVME_PAGE_SIZE);
+  Queue->QueueId    = QueueId;
+  Queue->Sq         = Queue->Memory.Host;
+  Queue->Cq         = (NVME_CQE *)((UINT8 *)Queue->Memory.Host + SqBytes);
+  Queue->SqDevice   = Queue->Memory.Device;
+  Queue->CqDevice   = Queue->Memory.Device + SqBytes;
+  Queue->SqDoorbell = Controller->Base + NVME_DOORBELL + (2 * QueueId) * Controller->DoorbellStride;
+  Queue->CqDoorbell = Controller->Base + NVME_DOORBELL + (2 * QueueId + 1) * Controller->DoorbellStride;
+  Queue->SqTail     = 0;
+  Queue->SqRung     = 0;
+  Queue->CqHead     = 0;
+  Queue->Phase      = 1;
+
+  //
+  // One slot stays empty so a full queue can be told from an empty one.
+  //
+  Queue->Requests = AllocateZeroPool (Queue->Size * sizeof (NVME_REQUEST *));
+  Queue->FreeCids = AllocatePool (Queue->Size * sizeof (UINT16));
+  if ((Queue->Requests == NULL) || (Queue->FreeCids == NULL)) {
+    NvmeQueueFree (Controller, Queue);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Queue->FreeCount = 0;
+  for (Slot = Queue->Size - 1; Slot > 0; Slot--) {
+    Queue->FreeCids[Queue->FreeCount++] = Slot - 1;
+  }
+
+  //
+  // Admin commands carry at most a page and need no list.
+  //
+  if ((QueueId != 0) && !Controller->SglSupported) {
+    Status = NvmeDmaAllocate (Controller, Queue->Size * NVME_PRP_LIST_PAGES, &Queue->PrpLists);
+    if (EFI_ERROR (Status)) {
+      NvmeQueueFree (Controller, Queue);
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the slot tables and PRP lists of a queue. The queue memory itself
+  belongs to the caller.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to free.
+**/
+VOID
+NvmeQueueFree (
+  IN     NVME_CONTROLLER  *Controller,
+  IN OUT NVME_QUEUE       *Queue
+  )
+{
+  if (Queue->Requests != NULL) {
+    FreePool (Queue->Requests);
+    Queue->Requests = NULL;
+  }
+
+  if (Queue->FreeCids != NULL) {
+    FreePool (Queue->FreeCids);
+    Queue->FreeCids = NULL;
+  }
+
+  NvmeDmaFree (Controller, &Queue->PrpLists);
+  Queue->FreeCount = 0;
+}
+
+/**
+  Describe a mapped buffer with PRPs. The first entry may start anywhere
+  in a page; a longer buffer continues in the slot's PRP list, whose
+  last entry chains to the next list page when one is not enough.
+
+  @param  Queue         Queue the command goes to.
+  @param  Cid           Slot of the command.
+  @param  Command       Command to fill in.
+  @param  Address       Device address of the buffer.
+  @param  Length        Bytes mapped.
+**/
+STATIC
+VOID
+NvmeBuildPrps (
+  IN     NVME_QUEUE            *Queue,
+  IN     UINT16                Cid,
+  IN OUT NVME_SQE              *Command,
+  IN     EFI_PHYSICAL_ADDRESS  Address,
+  IN     UINTN                 Length
+  )
+{
+  UINTN                 First;
+  UINTN                 Entries;
+  UINTN                 Index;
+  UINT64                *List;
+  EFI_PHYSICAL_ADDRESS  ListDevice;
+  EFI_PHYSICAL_ADDRESS  Page;
+
+  Command->Dptr[0] = Address;
+  Command->Dptr[1] = 0;
+
+  First = NVME_PAGE_SIZE - (UINTN)(Address & (NVME_PAGE_SIZE - 1));
+  if (Length <= First) {
+    return;
+  }
+
+  Page    = (Address & ~(UINT64)(NVME_PAGE_SIZE - 1)) + NVME_PAGE_SIZE;
+  Entries = (Length - First + NVME_PAGE_SIZE - 1) / NVME_PAGE_SIZE;
+  if (Entries == 1) {
+    Command->Dptr[1] = Page;
+    return;
+  }
+
+  List             = (UINT64 *)((UINT8 *)Queue->PrpLists.Host + (UINTN)Cid * NVME_PRP_LIST_PAGES * NVME_PAGE_SIZE);
+  ListDevice       = Queue->PrpLists.Device + (UINTN)Cid * NVME_PRP_LIST_PAGES * NVME_PAGE_SIZE;
+  Command->Dptr[1] = ListDevice;
+
+  for (Index = 0; Entries > 0; Index++) {
+    if (((Index % NVME_PRP_PER_PAGE) == NVME_PRP_PER_PAGE - 1) && (Entries > 1)) {
+      List[Index] = ListDevice + (Index + 1) * sizeof (UINT64);
+      continue;
+    }
+
+    List[Index] = Page;
+    Page       += NVME_PAGE_SIZE;
+    Entries--;
+  }
+
+  WriteBackDataCacheRange (List, Index * sizeof (UINT64));
+}
+
+/**
+  Place a request in the submission queue without ringing the doorbell.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to use.
+  @param  Request       Request to queue.
+
+  @retval EFI_SUCCESS           Queued; NvmeRing makes it visible.
+  @retval EFI_NOT_READY         The queue is full.
+  @retval EFI_BAD_BUFFER_SIZE   The buffer could only be mapped in part.
+  @retval others                The buffer could not be mapped.
+**/
+EFI_STATUS
+NvmeSubmit (
+  IN     NVME_CONTROLLER  *Controller,
+  IN     NVME_QUEUE       *Queue,
+  IN OUT NVME_REQUEST     *Request
+  )
+{
+  EFI_STATUS                                 Status;
+  EFI_PCI_ROOT_BRIDGE_IO_PROTOCOL_OPERATION  Operation;
+  EFI_PHYSICAL_ADDRESS                       Address;
+  UINTN                                      Length;
+  UINT16                                     Cid;
+  NVME_SQE                                   *Entry;
+  NVME_SGL_DESCRIPTOR                        *Sgl;
+
+  if (Queue->FreeCount == 0) {
+    return EFI_NOT_READY;
+  }
+
+  Request->Queue   = Queue;
+  Request->Mapping = NULL;
+  Request->Done    = FALSE;
+  Request->Status  = EFI_NOT_READY;
+  Address          = 0;
+
+  if (Request->Length != 0) {
+    Operation = Request->Write ? EfiPciOperationBusMasterRead : EfiPciOperationBusMasterWrite;
+    Length    = Request->Length;
+    Status    = Controller->RootBridgeIo->Map (
+                                            Controller->RootBridgeIo,
+                                            Operation,
+                                            Request->Buffer,
+                                            &Length,
+                                            &Address,
+                                            &Request->Mapping
+                                            );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (Length != Request->Length) {
+      Controller->RootBridgeIo->Unmap (Controller->RootBridgeIo, Request->Mapping);
+      Request->Mapping = NULL;
+      return EFI_BAD_BUFFER_SIZE;
+    }
+  }
+
+  Cid                     = Queue->FreeCids[--Queue->FreeCount];
+  Queue->Requests[Cid]    = Request;
+  Request->Command.Cid    = Cid;
+  Request->Command.Flags &= ~NVME_FLAGS_PSDT_MASK;
+
+  if (Request->Length != 0) {
+    if ((Queue->QueueId != 0) && Controller->SglSupported) {
+      Request->Command.Flags |= NVME_FLAGS_PSDT_SGL;
+      Sgl                     = (NVME_SGL_DESCRIPTOR *)Request->Command.Dptr;
+      Sgl->Address            = Address;
+      Sgl->Length             = Request->Length;
+      ZeroMem (Sgl->Reserved, sizeof (Sgl->Reserved));
+      Sgl->Identifier = NVME_SGL_DATA_BLOCK;
+    } else {
+      NvmeBuildPrps (Queue, Cid, &Request->Command, Address, Request->Length);
+    }
+  }
+
+  Entry = &Queue->Sq[Queue->SqTail];
+  CopyMem (Entry, &Request->Command, sizeof (NVME_SQE));
+  Queue->SqTail = (UINT16)((Queue->SqTail + 1) % Queue->Size);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Hand every request queued since the last call to the controller with
+  one doorbell write. The entries are cleaned to memory first; the
+  barrier of the doorbell write orders them before it.
+
+  @param  Queue         Queue to ring.
+**/
+VOID
+NvmeRing (
+  IN NVME_QUEUE  *Queue
+  )
+{
+  UINT16  Start;
+
+  Start = Queue->SqRung;
+  if (Start == Queue->SqTail) {
+    return;
+  }
+
+  if (Start < Queue->SqTail) {
+    WriteBackDataCacheRange (&Queue->Sq[Start], (Queue->SqTail - Start) * sizeof (NVME_SQE));
+  } else {
+    WriteBackDataCacheRange (&Queue->Sq[Start], (Queue->Size - Start) * sizeof (NVME_SQE));
+    WriteBackDataCacheRange (&Queue->Sq[0], Queue->SqTail * sizeof (NVME_SQE));
+  }
+
+  PlatformMmioWrite32 (Queue->SqDoorbell, Queue->SqTail);
+  Queue->SqRung = Queue->SqTail;
+}
+
+/**
+  Ring the I/O queues that completion callbacks queued work on, once the
+  outermost poll is done with its callbacks.
+
+  @param  Controller    NVMe controller.
+**/
+STATIC
+VOID
+NvmeRingDeferred (
+  IN NVME_CONTROLLER  *Controller
+  )
+{
+  UINTN  Index;
+
+  if (Controller->PollDepth != 0) {
+    return;
+  }
+
+  for (Index = 0; Index < Controller->IoQueueCount; Index++) {
+    if ((Controller->DeferredRings & (1U << Index)) != 0) {
+      NvmeRing (&Controller->IoQueues[Index]);
+    }
+  }
+
+  Controller->DeferredRings = 0;
+}
+
+/**
+  Reap completed requests from a queue, release their entries with one
+  head doorbell write, then call their callbacks. The callbacks may
+  queue more work into the slots just freed; that work is only rung
+  after the head doorbell, as the controller may otherwise post its
+  completions over entries not yet released.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to reap.
+
+  @return Number of requests completed.
+**/
+UINTN
+NvmePoll (
+  IN NVME_CONTROLLER  *Controller,
+  IN NVME_QUEUE       *Queue
+  )
+{
+  NVME_CQE      *Entry;
+  NVME_REQUEST  *Request;
+  NVME_REQUEST  *Reaped;
+  NVME_REQUEST  **Tail;
+  UINTN         Count;
+
+  Count  = 0;
+  Reaped = NULL;
+  Tail   = &Reaped;
+  for ( ; ; ) {
+    Entry = &Queue->Cq[Queue->CqHead];
+    if ((Count == 0) || ((Queue->CqHead % (NVME_CACHE_LINE_SIZE / sizeof (NVME_CQE))) == 0)) {
+      InvalidateDataCacheRange (Entry, sizeof (NVME_CQE));
+    }
+
+    if ((Entry->Status & NVME_CQE_PHASE) != Queue->Phase) {
+      break;
+    }
+
+    Queue->CqHead++;
+    if (Queue->CqHead == Queue->Size) {
+      Queue->CqHead = 0;
+      Queue->Phase ^= 1;
+    }
+
+    Count++;
+    if (Entry->Cid >= Queue->Size) {
+      continue;
+    }
+
+    //
+    // An abandoned request left its slot behind with no owner.
+    //
+    Request                             = Queue->Requests[Entry->Cid];
+    Queue->Requests[Entry->Cid]         = NULL;
+    Queue->FreeCids[Queue->FreeCount++] = Entry->Cid;
+    if (Request == NULL) {
+      continue;
+    }
+
+    CopyMem (&Request->Completion, Entry, sizeof (NVME_CQE));
+    Request->Status = (NVME_CQE_STATUS (Entry->Status) == 0) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+    Request->Next   = NULL;
+    *Tail           = Request;
+    Tail            = &Request->Next;
+  }
+
+  if (Count == 0) {
+    return 0;
+  }
+
+  PlatformMmioWrite32 (Queue->CqDoorbell, Queue->CqHead);
+
+  Controller->PollDepth++;
+  while (Reaped != NULL) {
+    Request = Reaped;
+    Reaped  = Request->Next;
+    if (Request->Mapping != NULL) {
+      Controller->RootBridgeIo->Unmap (Controller->RootBridgeIo, Request->Mapping);
+      Request->Mapping = NULL;
+    }
+
+    Request->Done = TRUE;
+    if (Request->DoneCallback != NULL) {
+      Request->DoneCallback (Request);
+    }
+  }
+
+  Controller->PollDepth--;
+  NvmeRingDeferred (Controller);
+  return Count;
+}
+
+/**
+  Reap completed requests from every I/O queue. Work queued by the
+  callbacks is rung once, after all queues have been reaped.
+
+  @param  Controller    NVMe controller.
+
+  @return Number of requests completed.
+**/
+UINTN
+NvmePollIoQueues (
+  IN NVME_CONTROLLER  *Controller
+  )
+{
+  UINTN  Index;
+  UINTN  Count;
+
+  Count = 0;
+  Controller->PollDepth++;
+  for (Index = 0; Index < Controller->IoQueueCount; Index++) {
+    Count += NvmePoll (Controller, &Controller->IoQueues[Index]);
+  }
+
+  Controller->PollDepth--;
+  NvmeRingDeferred (Controller);
+  return Count;
+}
+
+/**
+  Microseconds since a performance counter value.
+**/
+STATIC
+UINT64
+NvmeElapsed (
+  IN UINT64  Start
+  )
+{
+  return DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - Start), 1000);
+}
+
+/**
+  Submit one request, waiting for a free slot if needed, and wait for it.
+
+  @param  Controller    NVMe controller.
+  @param  Queue         Queue to use.
+  @param  Request       Request to execute.
+  @param  Timeout       Microseconds; 0 waits forever.
+
+  @retval EFI_SUCCESS   Completed successfully.
+  @retval EFI_TIMEOUT   Did not complete in time; the request is abandoned.
+  @retval others        Submission or command failure.
+**/
+EFI_STATUS
+NvmeExecute (
+  IN     NVME_CONTROLLER  *Controller,
+  IN     NVME_QUEUE       *Queue,
+  IN OUT NVME_REQUEST     *Request,
+  IN     UINT64           Timeout
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Start;
+
+  Start = GetPerformanceCounter ();
+  for ( ; ; ) {
+    Status = NvmeSubmit (Controller, Queue, Request);
+    if (Status != EFI_NOT_READY) {
+      break;
+    }
+
+    if ((NvmePoll (Controller, Queue) == 0) && (Timeout != 0) && (NvmeElapsed (Start) >= Timeout)) {
+      return EFI_TIMEOUT;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  NvmeRing (Queue);
+
+  while (!Request->Done) {
+    if (NvmePoll (Controller, Queue) == 0) {
+      if ((Timeout != 0) && (NvmeElapsed (Start) >= Timeout)) {
+        break;
+      }
+    }
+  }
+
+  if (!Request->Done) {
+    //
+    // Let the slot retire without touching the caller's request.
+    //
+    Queue->Requests[Request->Command.Cid] = NULL;
+    if (Request->Mapping != NULL) {
+      Controller->RootBridgeIo->Unmap (Controller->RootBridgeIo, Request->Mapping);
+      Request->Mapping = NULL;
+    }
+
+    DEBUG ((DEBUG_ERROR, "[NVME] Queue %d command 0x%02x timed out\n", Queue->QueueId, Request->Command.Opcode));
+    return EFI_TIMEOUT;
+  }
+
+  if (EFI_ERROR (Request->Status)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "[NVME] Queue %d command 0x%02x failed: status 0x%03x\n",
+      Queue->QueueId,
+      Request->Command.Opcode,
+      NVME_CQE_STATUS (Request->Completion.Status)
+      ));
+  }
+
+  return Request->Status;
+}
+
+/**
+  I/O queue with the most free slots, starting the search after the one
+  used last so that equal queues take turns.
+**/
+STATIC
+NVME_QUEUE *
+NvmePickQueue (
+  IN NVME_CONTROLLER  *Controller
+  )
+{
+  NVME_QUEUE  *Best;
+  NVME_QUEUE  *Queue;
+  UINTN       Index;
+
+  Best = NULL;
+  for (Index = 1; Index <= Controller->IoQueueCount; Index++) {
+    Queue = &Controller->IoQueues[(Controller->NextQueue + Index) % Controller->IoQueueCount];
+    if ((Queue->FreeCount > 0) && ((Best == NULL) || (Queue->FreeCount > Best->FreeCount))) {
+      Best = Queue;
+    }
+  }
+
+  if (Best != NULL) {
+    Controller->NextQueue = (UINTN)(Best - Controller->IoQueues);
+  }
+
+  return Best;
+}
+
+STATIC
+VOID
+NvmeTransferCommandDone (
+  IN NVME_REQUEST  *Request
+  );
+
+/**
+  Queue commands of a transfer while slots are free, then ring each
+  queue that got one, or leave that to the poll whose callback this is.
+
+  @param  Transfer      Transfer to continue.
+
+  @retval EFI_SUCCESS   Zero or more commands queued.
+  @retval others        A command could not be built.
+**/
+STATIC
+EFI_STATUS
+NvmeTransferQueue (
+  IN OUT NVME_TRANSFER  *Transfer
+  )
+{
+  NVME_CONTROLLER  *Controller;
+  NVME_NAMESPACE   *Namespace;
+  NVME_QUEUE       *Queue;
+  NVME_REQUEST     *Request;
+  EFI_STATUS       Status;
+  UINTN            Blocks;
+  UINT32           Touched;
+
+  Controller = Transfer->Controller;
+  Namespace  = Transfer->Namespace;
+  Status     = EFI_SUCCESS;
+  Touched    = 0;
+
+  while (!Transfer->Queued) {
+    Queue = NvmePickQueue (Controller);
+    if (Queue == NULL) {
+      break;
+    }
+
+    Request = AllocateZeroPool (sizeof (NVME_REQUEST));
+    if (Request == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      break;
+    }
+
+    Request->Command.Opcode = Transfer->Opcode;
+    Request->Command.Nsid   = Namespace->Nsid;
+    Request->DoneCallback   = NvmeTransferCommandDone;
+    Request->Context        = Transfer;
+
+    if (Transfer->Opcode != NVME_IO_FLUSH) {
+      Blocks                 = MIN (Transfer->Blocks, (UINTN)(Controller->MaxTransfer >> Namespace->BlockShift));
+      Request->Buffer        = Transfer->Buffer;
+      Request->Length        = (UINT32)(Blocks << Namespace->BlockShift);
+      Request->Write         = (BOOLEAN)(Transfer->Opcode == NVME_IO_WRITE);
+      Request->Command.Cdw10 = (UINT32)Transfer->Lba;
+      Request->Command.Cdw11 = (UINT32)RShiftU64 (Transfer->Lba, 32);
+      Request->Command.Cdw12 = (UINT32)(Blocks - 1);
+    } else {
+      Blocks = 0;
+    }
+
+    Status = NvmeSubmit (Controller, Queue, Request);
+    if (EFI_ERROR (Status)) {
+      FreePool (Request);
+      break;
+    }
+
+    Touched |= 1U << (Queue - Controller->IoQueues);
+    Transfer->Outstanding++;
+    Transfer->Lba    += Blocks;
+    Transfer->Buffer += Blocks << Namespace->BlockShift;
+    Transfer->Blocks -= Blocks;
+    Transfer->Queued  = (BOOLEAN)(Transfer->Blocks == 0);
+  }
+
+  Controller->DeferredRings |= Touched;
+  NvmeRingDeferred (Controller);
+  return Status;
+}
+
+/**
+  Finish a transfer once nothing of it is queued or in flight.
+**/
+STATIC
+VOID
+NvmeTransferCheckDone (
+  IN OUT NVME_TRANSFER  *Transfer
+  )
+{
+  if (Transfer->Queued && (Transfer->Outstanding == 0) && (Transfer->DoneCallback != NULL)) {
+    Transfer->DoneCallback (Transfer);
+  }
+}
+
+/**
+  Completion of one command of a transfer: record its status and queue
+  more of the transfer into the slot it freed.
+
+  @param  Request       Completed command.
+**/
+STATIC
+VOID
+NvmeTransferCommandDone (
+  IN NVME_REQUEST  *Request
+  )
+{
+  NVME_TRANSFER  *Transfer;
+  EFI_STATUS     Status;
+
+  Transfer = Request->Context;
+  Transfer->Outstanding--;
+  if (EFI_ERROR (Request->Status) && !EFI_ERROR (Transfer->Status)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "[NVME] %a at LBA 0x%lx failed: status 0x%03x\n",
+      Request->Write ? "Write" : "Read",
+      LShiftU64 (Request->Command.Cdw11, 32) | Request->Command.Cdw10,
+      NVME_CQE_STATUS (Request->Completion.Status)
+      ));
+    Transfer->Status = Request->Status;
+  }
+
+  FreePool (Request);
+
+  //
+  // After a failure nothing more is queued; the transfer ends when what
+  // is in flight has drained.
+  //
+  if (EFI_ERROR (Transfer->Status)) {
+    Transfer->Queued = TRUE;
+  } else if (!Transfer->Queued) {
+    Status = NvmeTransferQueue (Transfer);
+    if (EFI_ERROR (Status)) {
+      Transfer->Status = Status;
+      Transfer->Queued = TRUE;
+    }
+  }
+
+  NvmeTransferCheckDone (Transfer);
+}
+
+/**
+  Start a transfer: queue as many of its commands as the I/O queues have
+  room for. The rest follow as earlier ones complete.
+
+  @param  Transfer      Controller, Namespace, Opcode, Lba, Buffer and
+                        Blocks set; DoneCallback and Context optional.
+
+  @retval EFI_SUCCESS   Started; DoneCallback runs when it is over.
+  @retval others        Nothing could be queued.
+**/
+EFI_STATUS
+NvmeTransferStart (
+  IN OUT NVME_TRANSFER  *Transfer
+  )
+{
+  EFI_STATUS  Status;
+
+  Transfer->Outstanding = 0;
+  Transfer->Status      = EFI_SUCCESS;
+  Transfer->Queued      = FALSE;
+  if ((Transfer->Opcode != NVME_IO_FLUSH) && (Transfer->Blocks == 0)) {
+    Transfer->Queued = TRUE;
+    NvmeTransferCheckDone (Transfer);
+    return EFI_SUCCESS;
+  }
+
+  Status = NvmeTransferQueue (Transfer);
+  if (EFI_ERROR (Status)) {
+    Transfer->Queued = TRUE;
+    if (Transfer->Outstanding == 0) {
+      return Status;
+    }
+
+    Transfer->Status = Status;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Detach the commands of a transfer still in flight so their slots
+  retire without calling back into it.
+
+  @param  Transfer      Transfer to give up on.
+**/
+VOID
+NvmeTransferAbandon (
+  IN OUT NVME_TRANSFER  *Transfer
+  )
+{
+  NVME_CONTROLLER  *Controller;
+  NVME_QUEUE       *Queue;
+  NVME_REQUEST     *Request;
+  UINTN            Index;
+  UINT16           Cid;
+
+  Controller = Transfer->Controller;
+  for (Index = 0; Index < Controller->IoQueueCount; Index++) {
+    Queue = &Controller->IoQueues[Index];
+    for (Cid = 0; Cid < Queue->Size; Cid++) {
+      Request = Queue->Requests[Cid];
+      if ((Request == NULL) || (Request->Context != Transfer) || (Request->DoneCallback != NvmeTransferCommandDone)) {
+        continue;
+      }
+
+      Queue->Requests[Cid] = NULL;
+      if (Request->Mapping != NULL) {
+        Controller->RootBridgeIo->Unmap (Controller->RootBridgeIo, Request->Mapping);
+      }
+
+      FreePool (Request);
+    }
+  }
+
+  Transfer->Outstanding = 0;
+  Transfer->Queued      = TRUE;
+}
+
+/**
+  Poll until a started transfer is over.
+
+  @param  Transfer      Started transfer.
+  @param  Timeout       Microseconds without progress before giving up.
+
+  @return Status of the transfer, or EFI_TIMEOUT once it is abandoned.
+**/
+EFI_STATUS
+NvmeTransferWait (
+  IN OUT NVME_TRANSFER  *Transfer,
+  IN     UINT64         Timeout
+  )
+{
+  UINT64  Start;
+
+  Start = GetPerformanceCounter ();
+  while (!Transfer->Queued || (Transfer->Outstanding != 0)) {
+    if (NvmePollIoQueues (Transfer->Controller) != 0) {
+      Start = GetPerformanceCounter ();
+    } else if (NvmeElapsed (Start) >= Timeout) {
+      DEBUG ((DEBUG_ERROR, "[NVME] Transfer at LBA 0x%lx timed out\n", Transfer->Lba));
+      NvmeTransferAbandon (Transfer);
+      return EFI_TIMEOUT;
+    }
+  }
+
+  return Transfer->Status;
+}
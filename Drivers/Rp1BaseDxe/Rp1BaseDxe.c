@@ -1,7 +1,9 @@
 /** @file
   RP1 Southbridge Base Driver for Raspberry Pi 5 D-step
 
-  This driver initializes the RP1 southbridge and exports its base addresses.
+  This driver initializes the RP1 southbridge and installs the RP1
+  protocol: the base addresses, chip revision and reference counted
+  block clocks and resets.
   RP1 memory map (verified on BCM2712 D0):
     - 0x1f00000000 - RP1 peripheral base
     - 0x1f00000000 + 0x00200000 - XHCI USB 3.0
@@ -14,9 +16,14 @@
 
 #include <Uefi.h>
 #include <Library/DebugLib.h>
-#include <Library/IoLib.h>
 #include <Library/ArmLib.h>
+#include <Library/HobLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+#include "../../Include/Protocol/Rp1.h"
 
 //
 // RP1 Memory Map - D0 stepping verified
@@ -33,50 +40,202 @@
 #define RP1_SYS_STATUS            (RP1_BASE + 0x00000004)
 #define RP1_CLK_ENABLE           (RP1_BASE + 0x00000100)
 #define RP1_CLK_STATUS           (RP1_BASE + 0x00000104)
+#define RP1_RST_CTRL             (RP1_BASE + 0x00000108)
+#define RP1_CHIP_ID              (RP1_BASE + 0x00000FFC)
 
 //
-// Clock bits
+// Clock and reset bits, one per RP1_BLOCK
 //
 #define RP1_CLK_XHCI             BIT0
 #define RP1_CLK_GMAC             BIT1
 #define RP1_CLK_PCIE            BIT2
 #define RP1_CLK_SDIO            BIT3
+#define RP1_CLK_ALL              (RP1_CLK_XHCI | RP1_CLK_GMAC | RP1_CLK_PCIE | RP1_CLK_SDIO)
+
+//
+// Clock settle timeout, in microseconds
+//
+#define RP1_CLK_TIMEOUT          100000
+
+//
+// Time a block is held in reset, in microseconds
+//
+#define RP1_RST_HOLD             10
+
+STATIC CONST EFI_GUID  mVideoCorePropertiesGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+STATIC UINT32          mClockUsers[Rp1BlockMax];
 
 /**
-  Enable RP1 clock domains.
+  Take a reference on the clock of a block. The first reference starts
+  the clock; every caller then waits for it to settle, so a second user
+  arriving while the first one waits does not touch the block early.
+
+  The reference count and RP1_CLK_ENABLE are updated at TPL_NOTIFY, but
+  the settle wait runs at the caller's TPL so that notify functions and
+  timer callbacks are not held off for up to RP1_CLK_TIMEOUT.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to clock.
 
-  @param  ClockMask   Bitmask of clocks to enable.
+  @retval EFI_SUCCESS            The clock is running.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_TIMEOUT            The clock did not become stable.
 **/
 STATIC
-VOID
+EFI_STATUS
+EFIAPI
 Rp1EnableClock (
-  IN UINT32  ClockMask
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
   )
 {
-  UINT32  Status;
-  UINT32  Timeout;
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+  UINT32      Clock;
+  UINT64      Elapsed;
+  BOOLEAN     Started;
+
+  if ((UINT32)Block >= Rp1BlockMax) {
+    return EFI_INVALID_PARAMETER;
+  }
 
-  DEBUG ((DEBUG_INFO, "[RP1] Enabling clocks: 0x%08x\n", ClockMask));
+  Clock  = 1U << Block;
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
 
-  // Write 1 to enable
-  MmioWrite32 (RP1_CLK_ENABLE, ClockMask);
+  Started = (BOOLEAN)(mClockUsers[Block]++ == 0);
+  if (Started) {
+    This->Clocks |= Clock;
+    PlatformMmioWrite32 (RP1_CLK_ENABLE, This->Clocks);
+  }
+
+  gBS->RestoreTPL (OldTpl);
 
-  // Wait for clocks to stabilize (max 100ms)
-  Timeout = 1000;
-  while (Timeout--) {
-    Status = MmioRead32 (RP1_CLK_STATUS);
-    if ((Status & ClockMask) == ClockMask) {
-      DEBUG ((DEBUG_INFO, "[RP1] Clocks stable after %d polls\n", 1000 - Timeout));
-      return;
+  Status = PlatformWaitMmio32 (RP1_CLK_STATUS, Clock, Clock, RP1_CLK_TIMEOUT, &Elapsed);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[RP1] Clock 0x%x enable timeout! Status: 0x%08x\n", Clock, PlatformMmioRead32 (RP1_CLK_STATUS)));
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    if (--mClockUsers[Block] == 0) {
+      This->Clocks &= ~Clock;
+      PlatformMmioWrite32 (RP1_CLK_ENABLE, This->Clocks);
     }
-    gBS->Stall (100);  // 100 microseconds
+
+    gBS->RestoreTPL (OldTpl);
+    return Status;
   }
 
-  DEBUG ((DEBUG_WARN, "[RP1] Clock enable timeout! Status: 0x%08x\n", Status));
+  if (Started) {
+    DEBUG ((DEBUG_INFO, "[RP1] Clock 0x%x stable after %Lu us\n", Clock, Elapsed));
+  }
+
+  return EFI_SUCCESS;
 }
 
 /**
-  Get RP1 firmware version from VideoCore mailbox.
+  Drop a reference on the clock of a block; the last one gates it.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to release.
+
+  @retval EFI_SUCCESS            The reference was dropped.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_NOT_STARTED        No reference is held on the clock.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Rp1DisableClock (
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if ((UINT32)Block >= Rp1BlockMax) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  if (mClockUsers[Block] == 0) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_NOT_STARTED;
+  }
+
+  if (--mClockUsers[Block] == 0) {
+    This->Clocks &= ~(1U << Block);
+    PlatformMmioWrite32 (RP1_CLK_ENABLE, This->Clocks);
+    DEBUG ((DEBUG_INFO, "[RP1] Clock 0x%x gated\n", 1U << Block));
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Pulse the reset of a block.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to reset.
+
+  @retval EFI_SUCCESS            The block was reset.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_NOT_READY          The clock of the block is gated.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Rp1Reset (
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
+  )
+{
+  EFI_TPL                OldTpl;
+  PLATFORM_MMIO_UPDATE   Assert;
+  PLATFORM_MMIO_UPDATE   Release;
+
+  if ((UINT32)Block >= Rp1BlockMax) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Assert.Address  = RP1_RST_CTRL;
+  Assert.AndMask  = ~(1U << Block);
+  Assert.OrMask   = 1U << Block;
+  Release.Address = RP1_RST_CTRL;
+  Release.AndMask = ~(1U << Block);
+  Release.OrMask  = 0;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  if ((This->Clocks & (1U << Block)) == 0) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_NOT_READY;
+  }
+
+  PlatformMmioUpdate32 (&Assert, 1);
+  MicroSecondDelay (RP1_RST_HOLD);
+  PlatformMmioUpdate32 (&Release, 1);
+  gBS->RestoreTPL (OldTpl);
+
+  DEBUG ((DEBUG_INFO, "[RP1] Block %d reset\n", Block));
+  return EFI_SUCCESS;
+}
+
+STATIC RP1_PROTOCOL  mRp1 = {
+  RP1_BASE,
+  { RP1_XHCI_BASE, RP1_GMAC_BASE, RP1_PCIE_BASE, 0 },
+  0,
+  0,
+  0,
+  0,
+  Rp1EnableClock,
+  Rp1DisableClock,
+  Rp1Reset
+};
+
+/**
+  Get the VideoCore firmware revision, from the properties MemoryInitPeiLib
+  read through the mailbox.
 
   @return Firmware version, or 0 if not available.
 **/
@@ -86,9 +245,14 @@ Rp1GetFirmwareVersion (
   VOID
   )
 {
-  // TODO: Implement mailbox call to VideoCore
-  // For now, return a dummy version
-  return 0x20260213;
+  VOID  *Hob;
+
+  Hob = GetFirstGuidHob (&mVideoCorePropertiesGuid);
+  if (Hob == NULL) {
+    return 0;
+  }
+
+  return ((VIDEOCORE_PROPERTIES *)GET_GUID_HOB_DATA (Hob))->FirmwareRevision;
 }
 
 /**
@@ -106,9 +270,9 @@ Rp1BaseDriverEntryPoint (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
-  UINT32 ChipId;
-  UINT32  FwVersion;
-  UINT32  SysCfg;
+  EFI_STATUS  Status;
+  EFI_HANDLE  Handle;
+  UINT32      Running;
 
   DEBUG ((DEBUG_INFO, "\n[RP1] ========================================\n"));
   DEBUG ((DEBUG_INFO, "[RP1] RP1 Southbridge Base Driver\n"));
@@ -125,34 +289,49 @@ Rp1BaseDriverEntryPoint (
   //
   // Read system configuration
   //
-  SysCfg = MmioRead32 (RP1_SYS_CFG);
-  DEBUG ((DEBUG_INFO, "[RP1] System config:    0x%08x\n", SysCfg));
+  mRp1.SysCfg = PlatformMmioRead32 (RP1_SYS_CFG);
+  DEBUG ((DEBUG_INFO, "[RP1] System config:    0x%08x\n", mRp1.SysCfg));
 
   //
   // Read RP1 chip ID and revision
   //
-  ChipId = MmioRead32 (RP1_BASE + 0x00000FFC);
-  DEBUG ((DEBUG_INFO, "[RP1] Chip ID:       0x%08x\n", ChipId));
-  DEBUG ((DEBUG_INFO, "[RP1]   - Part number:  %d\n", (ChipId >> 12) & 0xFFF));
-  DEBUG ((DEBUG_INFO, "[RP1]   - Revision:     %d.%d\n", (ChipId >> 4) & 0xF, ChipId & 0xF));
+  mRp1.ChipId = PlatformMmioRead32 (RP1_CHIP_ID);
+  DEBUG ((DEBUG_INFO, "[RP1] Chip ID:       0x%08x\n", mRp1.ChipId));
+  DEBUG ((DEBUG_INFO, "[RP1]   - Part number:  %d\n", RP1_CHIP_PART (mRp1.ChipId)));
+  DEBUG ((DEBUG_INFO, "[RP1]   - Revision:     %d.%d\n", RP1_CHIP_MAJOR (mRp1.ChipId), RP1_CHIP_MINOR (mRp1.ChipId)));
   //
   // Get firmware version
   //
-  FwVersion = Rp1GetFirmwareVersion ();
-  DEBUG ((DEBUG_INFO, "[RP1] Firmware version: 0x%08x\n", FwVersion));
+  mRp1.FirmwareVersion = Rp1GetFirmwareVersion ();
+  DEBUG ((DEBUG_INFO, "[RP1] Firmware version: 0x%08x\n", mRp1.FirmwareVersion));
 
   //
-  // Enable essential clocks
-  // XHCI and GMAC are needed for boot; PCIe can be enabled later
+  // Gate every clock; each block driver enables its own through the
+  // protocol, so blocks nothing drives stay off.
   //
-  Rp1EnableClock (RP1_CLK_XHCI | RP1_CLK_GMAC);
+  Running = PlatformMmioRead32 (RP1_CLK_ENABLE) & RP1_CLK_ALL;
+  if (Running != 0) {
+    DEBUG ((DEBUG_INFO, "[RP1] Gating clocks:    0x%08x\n", Running));
+    PlatformMmioWrite32 (RP1_CLK_ENABLE, 0);
+  }
 
   //
   // TODO: Set up interrupt routing (GIC-600)
   // TODO: Configure RP1 AXI bus
-  // TODO: Export RP1 protocol for other drivers
   //
 
+  Handle = NULL;
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Handle,
+                  &gRp1ProtocolGuid,
+                  &mRp1,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[RP1] Protocol install failed: %r\n", Status));
+    return Status;
+  }
+
   DEBUG ((DEBUG_INFO, "[RP1] Initialization complete\n"));
   DEBUG ((DEBUG_INFO, "[RP1] ========================================\n\n"));
 
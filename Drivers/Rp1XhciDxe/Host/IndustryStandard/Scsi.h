@@ -0,0 +1,22 @@
+/** @file
+  Host stand-in for the SCSI definitions of MdePkg: the opcodes of the
+  bulk-only boot path.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_SCSI_H_
+#define HOST_SCSI_H_
+
+#define EFI_SCSI_OP_TEST_UNIT_READY   0x00
+#define EFI_SCSI_OP_REQUEST_SENSE     0x03
+#define EFI_SCSI_OP_READ_CAPACITY     0x25
+#define EFI_SCSI_OP_READ10            0x28
+#define EFI_SCSI_OP_WRITE10           0x2A
+#define EFI_SCSI_OP_READ16            0x88
+#define EFI_SCSI_OP_WRITE16           0x8A
+#define EFI_SCSI_OP_READ_CAPACITY16   0x9E
+
+#endif
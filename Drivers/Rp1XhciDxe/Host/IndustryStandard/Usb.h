@@ -0,0 +1,103 @@
+/** @file
+  Host stand-in for the USB definitions of MdePkg: standard requests and
+  descriptors.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_USB_H_
+#define HOST_USB_H_
+
+#define USB_MASS_STORE_CLASS      0x08
+
+#define USB_DESC_TYPE_DEVICE      0x01
+#define USB_DESC_TYPE_CONFIG      0x02
+#define USB_DESC_TYPE_INTERFACE   0x04
+#define USB_DESC_TYPE_ENDPOINT    0x05
+
+#define USB_REQ_TYPE_STANDARD     (0x00 << 5)
+#define USB_REQ_TYPE_CLASS        (0x01 << 5)
+#define USB_TARGET_DEVICE         0x00
+#define USB_TARGET_INTERFACE      0x01
+#define USB_TARGET_ENDPOINT       0x02
+
+#define USB_DEV_GET_DESCRIPTOR              0x06
+#define USB_DEV_GET_DESCRIPTOR_REQ_TYPE     0x80
+#define USB_DEV_SET_ADDRESS                 0x05
+#define USB_DEV_SET_ADDRESS_REQ_TYPE        0x00
+#define USB_DEV_SET_CONFIGURATION           0x09
+#define USB_DEV_SET_CONFIGURATION_REQ_TYPE  0x00
+#define USB_DEV_CLEAR_FEATURE               0x01
+#define USB_DEV_CLEAR_FEATURE_REQ_TYPE_E    0x02
+
+#define USB_FEATURE_ENDPOINT_HALT  0
+
+#define USB_ENDPOINT_DIR_IN     0x80
+#define USB_ENDPOINT_TYPE_MASK  0x03
+#define USB_ENDPOINT_CONTROL    0x00
+#define USB_ENDPOINT_ISO        0x01
+#define USB_ENDPOINT_BULK       0x02
+#define USB_ENDPOINT_INTERRUPT  0x03
+
+#pragma pack(1)
+typedef struct {
+  UINT8     RequestType;
+  UINT8     Request;
+  UINT16    Value;
+  UINT16    Index;
+  UINT16    Length;
+} USB_DEVICE_REQUEST;
+
+typedef struct {
+  UINT8     Length;
+  UINT8     DescriptorType;
+  UINT16    BcdUSB;
+  UINT8     DeviceClass;
+  UINT8     DeviceSubClass;
+  UINT8     DeviceProtocol;
+  UINT8     MaxPacketSize0;
+  UINT16    IdVendor;
+  UINT16    IdProduct;
+  UINT16    BcdDevice;
+  UINT8     StrManufacturer;
+  UINT8     StrProduct;
+  UINT8     StrSerialNumber;
+  UINT8     NumConfigurations;
+} USB_DEVICE_DESCRIPTOR;
+
+typedef struct {
+  UINT8     Length;
+  UINT8     DescriptorType;
+  UINT16    TotalLength;
+  UINT8     NumInterfaces;
+  UINT8     ConfigurationValue;
+  UINT8     Configuration;
+  UINT8     Attributes;
+  UINT8     MaxPower;
+} USB_CONFIG_DESCRIPTOR;
+
+typedef struct {
+  UINT8    Length;
+  UINT8    DescriptorType;
+  UINT8    InterfaceNumber;
+  UINT8    AlternateSetting;
+  UINT8    NumEndpoints;
+  UINT8    InterfaceClass;
+  UINT8    InterfaceSubClass;
+  UINT8    InterfaceProtocol;
+  UINT8    Interface;
+} USB_INTERFACE_DESCRIPTOR;
+
+typedef struct {
+  UINT8     Length;
+  UINT8     DescriptorType;
+  UINT8     EndpointAddress;
+  UINT8     Attributes;
+  UINT16    MaxPacketSize;
+  UINT8     Interval;
+} USB_ENDPOINT_DESCRIPTOR;
+#pragma pack()
+
+#endif
@@ -0,0 +1,32 @@
+/** @file
+  Host stand-in for DevicePathLib: the node helpers the mass storage
+  boot path builds its device path with. The model supplies them.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_DEVICE_PATH_LIB_H_
+#define HOST_DEVICE_PATH_LIB_H_
+
+#include <Protocol/DevicePath.h>
+
+UINT16
+SetDevicePathNodeLength (
+  IN OUT VOID  *Node,
+  IN     UINTN  Length
+  );
+
+VOID
+SetDevicePathEndNode (
+  OUT VOID  *Node
+  );
+
+EFI_DEVICE_PATH_PROTOCOL *
+AppendDevicePathNode (
+  IN CONST EFI_DEVICE_PATH_PROTOCOL  *DevicePath OPTIONAL,
+  IN CONST EFI_DEVICE_PATH_PROTOCOL  *DevicePathNode OPTIONAL
+  );
+
+#endif
@@ -0,0 +1,83 @@
+/** @file
+  Host stand-in for UefiBootServicesTableLib: the boot services the
+  Rp1XhciDxe engine calls. The model supplies gBS.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_UEFI_BOOT_SERVICES_TABLE_LIB_H_
+#define HOST_UEFI_BOOT_SERVICES_TABLE_LIB_H_
+
+#include <Uefi.h>
+
+#define EVT_TIMER                      0x80000000
+#define EVT_NOTIFY_SIGNAL              0x00000200
+#define EVT_SIGNAL_EXIT_BOOT_SERVICES  0x00000201
+
+typedef enum {
+  TimerCancel,
+  TimerPeriodic,
+  TimerRelative
+} EFI_TIMER_DELAY;
+
+typedef
+VOID
+(EFIAPI *EFI_EVENT_NOTIFY)(
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
+typedef struct {
+  EFI_TPL (EFIAPI *RaiseTPL)(
+    EFI_TPL  NewTpl
+    );
+  VOID (EFIAPI *RestoreTPL)(
+    EFI_TPL  OldTpl
+    );
+  EFI_STATUS (EFIAPI *CreateEvent)(
+    UINT32            Type,
+    EFI_TPL           NotifyTpl,
+    EFI_EVENT_NOTIFY  NotifyFunction,
+    VOID              *NotifyContext,
+    EFI_EVENT         *Event
+    );
+  EFI_STATUS (EFIAPI *SetTimer)(
+    EFI_EVENT        Event,
+    EFI_TIMER_DELAY  Type,
+    UINT64           TriggerTime
+    );
+  EFI_STATUS (EFIAPI *SignalEvent)(
+    EFI_EVENT  Event
+    );
+  EFI_STATUS (EFIAPI *CloseEvent)(
+    EFI_EVENT  Event
+    );
+  EFI_STATUS (EFIAPI *Stall)(
+    UINTN  Microseconds
+    );
+  EFI_STATUS (EFIAPI *ConnectController)(
+    EFI_HANDLE  ControllerHandle,
+    EFI_HANDLE  *DriverImageHandle,
+    VOID        *RemainingDevicePath,
+    BOOLEAN     Recursive
+    );
+  EFI_STATUS (EFIAPI *DisconnectController)(
+    EFI_HANDLE  ControllerHandle,
+    EFI_HANDLE  DriverImageHandle,
+    EFI_HANDLE  ChildHandle
+    );
+  EFI_STATUS (EFIAPI *InstallMultipleProtocolInterfaces)(
+    EFI_HANDLE  *Handle,
+    ...
+    );
+  EFI_STATUS (EFIAPI *UninstallMultipleProtocolInterfaces)(
+    EFI_HANDLE  Handle,
+    ...
+    );
+} EFI_BOOT_SERVICES;
+
+extern EFI_BOOT_SERVICES  *gBS;
+
+#endif
@@ -0,0 +1,15 @@
+/** @file
+  Host stand-in for UefiLib; the Rp1XhciDxe engine only uses the BaseLib
+  it brings in.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_UEFI_LIB_H_
+#define HOST_UEFI_LIB_H_
+
+#include <Library/BaseLib.h>
+
+#endif
@@ -0,0 +1,41 @@
+/** @file
+  Host stand-in for the device path protocol: the nodes Rp1XhciDxe
+  builds.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_DEVICE_PATH_H_
+#define HOST_DEVICE_PATH_H_
+
+#pragma pack(1)
+typedef struct {
+  UINT8    Type;
+  UINT8    SubType;
+  UINT8    Length[2];
+} EFI_DEVICE_PATH_PROTOCOL;
+
+typedef struct {
+  EFI_DEVICE_PATH_PROTOCOL    Header;
+  EFI_GUID                    Guid;
+} VENDOR_DEVICE_PATH;
+
+typedef struct {
+  EFI_DEVICE_PATH_PROTOCOL    Header;
+  UINT8                       ParentPortNumber;
+  UINT8                       InterfaceNumber;
+} USB_DEVICE_PATH;
+#pragma pack()
+
+#define HARDWARE_DEVICE_PATH      0x01
+#define HW_VENDOR_DP              0x04
+#define MESSAGING_DEVICE_PATH     0x03
+#define MSG_USB_DP                0x05
+#define END_DEVICE_PATH_TYPE      0x7F
+#define END_ENTIRE_DEVICE_PATH_SUBTYPE  0xFF
+
+extern EFI_GUID  gEfiDevicePathProtocolGuid;
+
+#endif
@@ -0,0 +1,62 @@
+/** @file
+  Host stand-in for the USB2 host controller protocol: the types the
+  Rp1XhciDxe engine passes around. The protocol functions themselves are
+  not built into the host tests.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_USB2_HOST_CONTROLLER_H_
+#define HOST_USB2_HOST_CONTROLLER_H_
+
+#include <IndustryStandard/Usb.h>
+
+typedef USB_DEVICE_REQUEST  EFI_USB_DEVICE_REQUEST;
+
+typedef enum {
+  EfiUsbDataIn,
+  EfiUsbDataOut,
+  EfiUsbNoData
+} EFI_USB_DATA_DIRECTION;
+
+#define EFI_USB_NOERROR         0x0000
+#define EFI_USB_ERR_NOTEXECUTE  0x0001
+#define EFI_USB_ERR_STALL       0x0002
+#define EFI_USB_ERR_BUFFER      0x0004
+#define EFI_USB_ERR_BABBLE      0x0008
+#define EFI_USB_ERR_NAK         0x0010
+#define EFI_USB_ERR_CRC         0x0020
+#define EFI_USB_ERR_TIMEOUT     0x0040
+#define EFI_USB_ERR_BITSTUFF    0x0080
+#define EFI_USB_ERR_SYSTEM      0x0100
+
+#define EFI_USB_SPEED_FULL   0x0000
+#define EFI_USB_SPEED_LOW    0x0001
+#define EFI_USB_SPEED_HIGH   0x0002
+#define EFI_USB_SPEED_SUPER  0x0003
+
+#define EFI_USB_MAX_BULK_BUFFER_NUM  10
+#define EFI_USB_MAX_ISO_BUFFER_NUM   7
+
+typedef struct {
+  UINT8    TranslatorHubAddress;
+  UINT8    TranslatorPortNumber;
+} EFI_USB2_HC_TRANSACTION_TRANSLATOR;
+
+typedef
+EFI_STATUS
+(EFIAPI *EFI_ASYNC_USB_TRANSFER_CALLBACK)(
+  IN VOID    *Data,
+  IN UINTN   DataLength,
+  IN VOID    *Context,
+  IN UINT32  Status
+  );
+
+typedef struct {
+  UINT16    MajorRevision;
+  UINT16    MinorRevision;
+} EFI_USB2_HC_PROTOCOL;
+
+#endif
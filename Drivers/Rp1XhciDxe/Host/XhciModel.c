@@ -0,0 +1,1476 @@
+/** @file
+  Software xHCI controller the Rp1XhciDxe host tests run the engine on,
+  and the platform services the engine calls.
+
+  Time only moves when the engine stalls; the TD on the bus is completed
+  as soon as the model time passes its end.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "XhciModel.h"
+
+MODEL  mModel;
+
+//
+// Completion codes only the model reports
+//
+#define MODEL_COMPLETION_NO_SLOTS        9
+#define MODEL_COMPLETION_SLOT_NOT_ENABLED 11
+#define MODEL_COMPLETION_CONTEXT_STATE   19
+
+#define MODEL_CONTEXT_SIZE  32
+
+//
+// TRBs of one TD, link TRBs left out
+//
+#define MODEL_TD_TRBS  (XHCI_MAX_TD_TRBS + 8)
+
+typedef struct {
+  XHCI_TRB    *Trbs[MODEL_TD_TRBS];
+  UINT64      Addresses[MODEL_TD_TRBS];
+  UINT32      Count;
+  UINT64      Next;                   // dequeue pointer past the TD
+  UINT32      NextCycle;
+} MODEL_TD;
+
+EFI_GUID  gEfiBlockIoProtocolGuid    = { 0x964E5B21, 0x6459, 0x11D2, { 0x8E, 0x39, 0x00, 0xA0, 0xC9, 0x69, 0x72, 0x3B } };
+EFI_GUID  gEfiDevicePathProtocolGuid = { 0x09576E91, 0x6D3F, 0x11D2, { 0x8E, 0x39, 0x00, 0xA0, 0xC9, 0x69, 0x72, 0x3B } };
+
+STATIC EFI_TPL  mTpl = TPL_APPLICATION;
+
+//
+// Data of the TD on the bus, gathered from or scattered to its TRBs
+//
+STATIC UINT8  mTdData[XHCI_MAX_TD_BYTES];
+
+STATIC
+VOID
+ModelRunBus (
+  VOID
+  );
+
+VOID
+ModelViolation (
+  IN CONST char  *Message
+  )
+{
+  printf ("  model: %s\n", Message);
+  mModel.Violations++;
+}
+
+//
+// Services of the platform the engine runs on
+//
+
+STATIC
+EFI_TPL
+EFIAPI
+HostRaiseTpl (
+  IN EFI_TPL  NewTpl
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if (NewTpl < mTpl) {
+    ModelViolation ("TPL lowered by RaiseTPL");
+  }
+
+  OldTpl = mTpl;
+  mTpl   = NewTpl;
+  return OldTpl;
+}
+
+STATIC
+VOID
+EFIAPI
+HostRestoreTpl (
+  IN EFI_TPL  OldTpl
+  )
+{
+  if (OldTpl > mTpl) {
+    ModelViolation ("TPL raised by RestoreTPL");
+  }
+
+  mTpl = OldTpl;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostStall (
+  IN UINTN  Microseconds
+  )
+{
+  MicroSecondDelay (Microseconds);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostConnectController (
+  IN EFI_HANDLE  ControllerHandle,
+  IN EFI_HANDLE  *DriverImageHandle,
+  IN VOID        *RemainingDevicePath,
+  IN BOOLEAN     Recursive
+  )
+{
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostDisconnectController (
+  IN EFI_HANDLE  ControllerHandle,
+  IN EFI_HANDLE  DriverImageHandle,
+  IN EFI_HANDLE  ChildHandle
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Protocols are not kept; a new handle is any distinct pointer.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+HostInstallMultipleProtocolInterfaces (
+  IN OUT EFI_HANDLE  *Handle,
+  ...
+  )
+{
+  if (*Handle == NULL) {
+    *Handle = Handle;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostUninstallMultipleProtocolInterfaces (
+  IN EFI_HANDLE  Handle,
+  ...
+  )
+{
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_BOOT_SERVICES  mBootServices = {
+  .RaiseTPL                            = HostRaiseTpl,
+  .RestoreTPL                          = HostRestoreTpl,
+  .Stall                               = HostStall,
+  .ConnectController                   = HostConnectController,
+  .DisconnectController                = HostDisconnectController,
+  .InstallMultipleProtocolInterfaces   = HostInstallMultipleProtocolInterfaces,
+  .UninstallMultipleProtocolInterfaces = HostUninstallMultipleProtocolInterfaces
+};
+
+EFI_BOOT_SERVICES  *gBS = &mBootServices;
+
+UINT64
+HostModelTime (
+  VOID
+  )
+{
+  return mModel.Time * 1000;
+}
+
+VOID
+HostModelDelay (
+  IN UINT64  Nanoseconds
+  )
+{
+  mModel.Time += Nanoseconds / 1000;
+  ModelRunBus ();
+}
+
+VOID *
+WriteBackDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+InvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  mModel.Invalidates++;
+  return Address;
+}
+
+VOID *
+WriteBackInvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+AllocateAlignedPages (
+  IN UINTN  Pages,
+  IN UINTN  Alignment
+  )
+{
+  VOID  *Buffer;
+
+  Alignment = MAX (Alignment, EFI_PAGE_SIZE);
+  Buffer    = aligned_alloc (Alignment, ALIGN_VALUE (EFI_PAGES_TO_SIZE (Pages), Alignment));
+  if (Buffer != NULL) {
+    mModel.Allocations++;
+  }
+
+  return Buffer;
+}
+
+VOID
+FreeAlignedPages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  )
+{
+  mModel.Frees++;
+  free (Buffer);
+}
+
+VOID *
+AllocatePages (
+  IN UINTN  Pages
+  )
+{
+  return AllocateAlignedPages (Pages, EFI_PAGE_SIZE);
+}
+
+VOID
+FreePages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  )
+{
+  FreeAlignedPages (Buffer, Pages);
+}
+
+UINT16
+SetDevicePathNodeLength (
+  IN OUT VOID   *Node,
+  IN     UINTN  Length
+  )
+{
+  ((EFI_DEVICE_PATH_PROTOCOL *)Node)->Length[0] = (UINT8)Length;
+  ((EFI_DEVICE_PATH_PROTOCOL *)Node)->Length[1] = (UINT8)(Length >> 8);
+  return (UINT16)Length;
+}
+
+VOID
+SetDevicePathEndNode (
+  OUT VOID  *Node
+  )
+{
+  ((EFI_DEVICE_PATH_PROTOCOL *)Node)->Type    = END_DEVICE_PATH_TYPE;
+  ((EFI_DEVICE_PATH_PROTOCOL *)Node)->SubType = END_ENTIRE_DEVICE_PATH_SUBTYPE;
+  SetDevicePathNodeLength (Node, sizeof (EFI_DEVICE_PATH_PROTOCOL));
+}
+
+EFI_DEVICE_PATH_PROTOCOL *
+AppendDevicePathNode (
+  IN CONST EFI_DEVICE_PATH_PROTOCOL  *DevicePath OPTIONAL,
+  IN CONST EFI_DEVICE_PATH_PROTOCOL  *DevicePathNode OPTIONAL
+  )
+{
+  CONST UINT8  *Node;
+  UINT8        *Path;
+  UINTN        Size;
+  UINTN        NodeSize;
+
+  Size = 0;
+  if (DevicePath != NULL) {
+    for (Node = (CONST UINT8 *)DevicePath; Node[0] != END_DEVICE_PATH_TYPE; Node += Node[2] | (Node[3] << 8)) {
+    }
+    Size = Node - (CONST UINT8 *)DevicePath;
+  }
+
+  NodeSize = (DevicePathNode == NULL) ? 0 : DevicePathNode->Length[0] | (DevicePathNode->Length[1] << 8);
+  Path     = malloc (Size + NodeSize + sizeof (EFI_DEVICE_PATH_PROTOCOL));
+  if (Path != NULL) {
+    if (Size > 0) {
+      memcpy (Path, DevicePath, Size);
+    }
+
+    if (NodeSize > 0) {
+      memcpy (Path + Size, DevicePathNode, NodeSize);
+    }
+
+    SetDevicePathEndNode (Path + Size + NodeSize);
+  }
+
+  return (EFI_DEVICE_PATH_PROTOCOL *)Path;
+}
+
+//
+// Event ring
+//
+
+/**
+  Position of the consumer, from ERDP.
+
+  @param  Segment       ERST entry ERDP points into.
+  @param  Index         TRB within that segment.
+
+  @retval TRUE          ERDP points into the event ring.
+**/
+STATIC
+BOOLEAN
+ModelEventDequeue (
+  OUT UINT32  *Segment,
+  OUT UINT32  *Index
+  )
+{
+  XHCI_ERST_ENTRY  *Erst;
+  UINT64           Address;
+
+  Erst    = XHCI_HOST_ADDRESS (mModel.Erstba);
+  Address = mModel.Erdp & ~(UINT64)0xF;
+  for (*Segment = 0; *Segment < mModel.Erstsz; (*Segment)++) {
+    if ((Address >= Erst[*Segment].SegmentBase) &&
+        (Address < Erst[*Segment].SegmentBase + Erst[*Segment].SegmentSize * sizeof (XHCI_TRB)))
+    {
+      *Index = (UINT32)((Address - Erst[*Segment].SegmentBase) / sizeof (XHCI_TRB));
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+BOOLEAN
+ModelPostEvent (
+  IN XHCI_TRB  *Event
+  )
+{
+  XHCI_ERST_ENTRY  *Erst;
+  XHCI_TRB         *Trb;
+  UINT32           Segment;
+  UINT32           Index;
+  UINT32           DequeueSegment;
+  UINT32           DequeueIndex;
+
+  Erst    = XHCI_HOST_ADDRESS (mModel.Erstba);
+  Segment = mModel.EventSegment;
+  Index   = mModel.EventIndex + 1;
+  if (Index == Erst[Segment].SegmentSize) {
+    Segment = (Segment + 1) % mModel.Erstsz;
+    Index   = 0;
+  }
+
+  //
+  // One TRB stays free, so a full ring can be told from an empty one.
+  //
+  if (!ModelEventDequeue (&DequeueSegment, &DequeueIndex)) {
+    ModelViolation ("ERDP outside the event ring");
+    return FALSE;
+  }
+
+  if ((Segment == DequeueSegment) && (Index == DequeueIndex)) {
+    ModelViolation ("event ring full");
+    return FALSE;
+  }
+
+  Trb            = (XHCI_TRB *)XHCI_HOST_ADDRESS (Erst[mModel.EventSegment].SegmentBase) + mModel.EventIndex;
+  Trb->Parameter = Event->Parameter;
+  Trb->Status    = Event->Status;
+  Trb->Control   = (Event->Control & ~TRB_CYCLE) | mModel.EventCycle;
+  mModel.Events++;
+
+  if ((Segment == 0) && (Index == 0)) {
+    mModel.EventCycle ^= 1;
+  }
+
+  mModel.EventSegment = Segment;
+  mModel.EventIndex   = Index;
+  return TRUE;
+}
+
+//
+// Transfer rings and the bus
+//
+
+/**
+  Collect the TRBs of the TD at the dequeue pointer of an endpoint. A
+  control TD ends with its status stage, any other with the first TRB
+  that is not chained.
+
+  @param  Endpoint      Endpoint.
+  @param  Control       TRUE for the default control endpoint.
+  @param  Td            TD found.
+
+  @retval TRUE          A complete TD is on the ring.
+**/
+STATIC
+BOOLEAN
+ModelFetchTd (
+  IN  MODEL_ENDPOINT  *Endpoint,
+  IN  BOOLEAN         Control,
+  OUT MODEL_TD        *Td
+  )
+{
+  XHCI_TRB  *Trb;
+  UINT64    Address;
+  UINT32    Cycle;
+  UINT32    Type;
+  UINT32    Links;
+
+  Address   = Endpoint->Dequeue;
+  Cycle     = Endpoint->Cycle;
+  Links     = 0;
+  Td->Count = 0;
+  while ((Td->Count < MODEL_TD_TRBS) && (Links <= XHCI_TRANSFER_RING_SEGMENTS)) {
+    Trb = XHCI_HOST_ADDRESS (Address);
+    if ((Trb->Control & TRB_CYCLE) != Cycle) {
+      return FALSE;
+    }
+
+    Type = TRB_GET_TYPE (Trb->Control);
+    if (Type == TRB_TYPE_LINK) {
+      if ((Trb->Control & TRB_TOGGLE_CYCLE) != 0) {
+        Cycle ^= 1;
+      }
+
+      Address = Trb->Parameter;
+      Links++;
+      continue;
+    }
+
+    Td->Trbs[Td->Count]      = Trb;
+    Td->Addresses[Td->Count] = Address;
+    Td->Count++;
+    Address += sizeof (XHCI_TRB);
+
+    if (Control ? (Type == TRB_TYPE_STATUS_STAGE) : ((Trb->Control & TRB_CHAIN) == 0)) {
+      Td->Next      = Address;
+      Td->NextCycle = Cycle;
+      return TRUE;
+    }
+  }
+
+  ModelViolation ("TD without an end");
+  return FALSE;
+}
+
+/**
+  Total length of the data TRBs First to Last - 1 of a TD.
+**/
+STATIC
+UINTN
+ModelTdLength (
+  IN MODEL_TD  *Td,
+  IN UINT32    First,
+  IN UINT32    Last
+  )
+{
+  UINTN  Length;
+
+  for (Length = 0; First < Last; First++) {
+    Length += TRB_GET_LENGTH (Td->Trbs[First]->Status) & 0x1FFFF;
+  }
+
+  return Length;
+}
+
+/**
+  Copy the data of TRBs First to Last - 1 of a TD into mTdData.
+**/
+STATIC
+VOID
+ModelGather (
+  IN MODEL_TD  *Td,
+  IN UINT32    First,
+  IN UINT32    Last
+  )
+{
+  UINTN  Offset;
+  UINTN  Length;
+
+  for (Offset = 0; First < Last; First++, Offset += Length) {
+    Length = TRB_GET_LENGTH (Td->Trbs[First]->Status) & 0x1FFFF;
+    memcpy (mTdData + Offset, XHCI_HOST_ADDRESS (Td->Trbs[First]->Parameter), Length);
+  }
+}
+
+/**
+  Copy Length bytes of mTdData into the buffers of TRBs First to
+  Last - 1 of a TD.
+
+  @return Index of the TRB the data ended in; its residual is stored in
+          Residual.
+**/
+STATIC
+UINT32
+ModelScatter (
+  IN  MODEL_TD  *Td,
+  IN  UINT32    First,
+  IN  UINT32    Last,
+  IN  UINTN     Length,
+  OUT UINT32    *Residual
+  )
+{
+  UINTN  Offset;
+  UINTN  Chunk;
+  UINTN  Size;
+
+  *Residual = 0;
+  for (Offset = 0; First < Last; First++) {
+    Size  = TRB_GET_LENGTH (Td->Trbs[First]->Status) & 0x1FFFF;
+    Chunk = MIN (Size, Length - Offset);
+    memcpy (XHCI_HOST_ADDRESS (Td->Trbs[First]->Parameter), mTdData + Offset, Chunk);
+    Offset += Chunk;
+    if ((Chunk < Size) || (First == Last - 1)) {
+      *Residual = (UINT32)(Size - Chunk);
+      return First;
+    }
+  }
+
+  return Last - 1;
+}
+
+/**
+  Queue a transfer event for the end of the TD on the bus.
+**/
+STATIC
+VOID
+ModelTransferEvent (
+  IN UINT64  Address,
+  IN UINT8   Code,
+  IN UINT32  Residual
+  )
+{
+  XHCI_TRB  *Event;
+
+  Event            = &mModel.BusEvents[mModel.BusEventCount++];
+  Event->Parameter = Address;
+  Event->Status    = ((UINT32)Code << 24) | (Residual & 0xFFFFFF);
+  Event->Control   = TRB_TYPE (TRB_TYPE_TRANS_EVENT) | TRB_SLOT_ID (mModel.BusSlot) | TRB_EP_ID (mModel.BusDci);
+}
+
+/**
+  Run a control TD on the device.
+
+  @param  Td            TD.
+  @param  Duration      Bus time taken.
+
+  @return Completion code of the TD.
+**/
+STATIC
+UINT8
+ModelRunControlTd (
+  IN  MODEL_TD  *Td,
+  OUT UINT64    *Duration
+  )
+{
+  EFI_USB_DEVICE_REQUEST  Request;
+  UINTN                   Length;
+  UINTN                   Moved;
+  UINT32                  Index;
+  UINT32                  Residual;
+  UINT32                  Last;
+  BOOLEAN                 In;
+  UINT8                   Code;
+
+  *Duration = MODEL_TD_OVERHEAD;
+  if ((TRB_GET_TYPE (Td->Trbs[0]->Control) != TRB_TYPE_SETUP_STAGE) ||
+      ((Td->Trbs[0]->Control & TRB_IDT) == 0))
+  {
+    ModelViolation ("control TD without an immediate setup stage");
+    ModelTransferEvent (Td->Addresses[0], TRB_COMPLETION_TRB_ERROR, 0);
+    return TRB_COMPLETION_TRB_ERROR;
+  }
+
+  memcpy (&Request, &Td->Trbs[0]->Parameter, sizeof (Request));
+  Last   = Td->Count - 1;
+  Length = ModelTdLength (Td, 1, Last);
+  In     = (BOOLEAN)((Last > 1) && ((Td->Trbs[1]->Control & TRB_DIR_IN) != 0));
+  if ((Length != Request.Length) && ((Length != 0) || (Request.Length != 0))) {
+    ModelViolation ("data stage length differs from wLength");
+  }
+
+  if (!In) {
+    ModelGather (Td, 1, Last);
+  }
+
+  Moved = Length;
+  Code  = mModel.Device->Control (&Request, mTdData, &Moved);
+  if (Code != TRB_COMPLETION_SUCCESS) {
+    ModelTransferEvent (Td->Addresses[0], Code, 0);
+    return Code;
+  }
+
+  *Duration += (Moved + MODEL_BUS_BYTES_PER_US - 1) / MODEL_BUS_BYTES_PER_US;
+  if (In) {
+    Index = ModelScatter (Td, 1, Last, Moved, &Residual);
+    if (Moved < Length) {
+      ModelTransferEvent (Td->Addresses[Index], TRB_COMPLETION_SHORT_PACKET, Residual);
+    }
+  }
+
+  ModelTransferEvent (Td->Addresses[Last], TRB_COMPLETION_SUCCESS, 0);
+  return TRB_COMPLETION_SUCCESS;
+}
+
+/**
+  Run a bulk TD on the device.
+
+  @param  Td            TD.
+  @param  Dci           Endpoint DCI.
+  @param  Duration      Bus time taken.
+
+  @return Completion code of the TD, or MODEL_NAK if the device did not
+          take it.
+**/
+STATIC
+UINT8
+ModelRunBulkTd (
+  IN  MODEL_TD  *Td,
+  IN  UINT8     Dci,
+  OUT UINT64    *Duration
+  )
+{
+  UINTN    Length;
+  UINTN    Moved;
+  UINT64   Latency;
+  UINT32   Index;
+  UINT32   Residual;
+  BOOLEAN  In;
+  UINT8    Code;
+
+  In     = (BOOLEAN)((Dci & 1) != 0);
+  Length = ModelTdLength (Td, 0, Td->Count);
+  if (!In) {
+    ModelGather (Td, 0, Td->Count);
+  }
+
+  Moved   = Length;
+  Latency = 0;
+  Code    = mModel.Device->Bulk ((UINT8)((Dci >> 1) | (In ? USB_ENDPOINT_DIR_IN : 0)), mTdData, &Moved, &Latency);
+  if (Code == MODEL_NAK) {
+    return MODEL_NAK;
+  }
+
+  *Duration = MODEL_TD_OVERHEAD + Latency;
+  if (Code != TRB_COMPLETION_SUCCESS) {
+    ModelTransferEvent (Td->Addresses[0], Code, TRB_GET_LENGTH (Td->Trbs[0]->Status) & 0x1FFFF);
+    return Code;
+  }
+
+  *Duration += (Moved + MODEL_BUS_BYTES_PER_US - 1) / MODEL_BUS_BYTES_PER_US;
+  if (In && (Moved < Length)) {
+    Index = ModelScatter (Td, 0, Td->Count, Moved, &Residual);
+    if ((Td->Trbs[Index]->Control & (TRB_ISP | TRB_IOC)) == 0) {
+      ModelViolation ("short packet on a TRB that reports none");
+    }
+
+    ModelTransferEvent (Td->Addresses[Index], TRB_COMPLETION_SHORT_PACKET, Residual);
+    return TRB_COMPLETION_SHORT_PACKET;
+  }
+
+  if (In) {
+    ModelScatter (Td, 0, Td->Count, Moved, &Residual);
+  }
+
+  if ((Td->Trbs[Td->Count - 1]->Control & TRB_IOC) == 0) {
+    ModelViolation ("TD that never interrupts");
+  }
+
+  ModelTransferEvent (Td->Addresses[Td->Count - 1], TRB_COMPLETION_SUCCESS, 0);
+  return TRB_COMPLETION_SUCCESS;
+}
+
+/**
+  Put the next TD on the bus: of the running endpoints with a TD the
+  device takes, the one rung first.
+
+  @retval TRUE          A TD is on the bus.
+**/
+STATIC
+BOOLEAN
+ModelStartTd (
+  VOID
+  )
+{
+  MODEL_ENDPOINT  *Endpoint;
+  MODEL_TD        Td;
+  UINT64          Tried[MODEL_MAX_SLOTS + 1];
+  UINT64          Duration;
+  UINT32          SlotId;
+  UINT32          Dci;
+  UINT32          BestSlot;
+  UINT32          BestDci;
+  UINT8           Code;
+
+  if (mModel.Device == NULL) {
+    return FALSE;
+  }
+
+  memset (Tried, 0, sizeof (Tried));
+  while (TRUE) {
+    BestSlot = 0;
+    BestDci  = 0;
+    for (SlotId = 1; SlotId <= MODEL_MAX_SLOTS; SlotId++) {
+      if (!mModel.Slots[SlotId].Enabled) {
+        continue;
+      }
+
+      for (Dci = 1; Dci <= XHCI_MAX_DCI; Dci++) {
+        Endpoint = &mModel.Slots[SlotId].Endpoints[Dci];
+        if ((Endpoint->State != MODEL_EP_RUNNING) || ((Tried[SlotId] & (1ULL << Dci)) != 0)) {
+          continue;
+        }
+
+        if ((BestSlot == 0) || (Endpoint->RungAt < mModel.Slots[BestSlot].Endpoints[BestDci].RungAt)) {
+          BestSlot = SlotId;
+          BestDci  = Dci;
+        }
+      }
+    }
+
+    if (BestSlot == 0) {
+      return FALSE;
+    }
+
+    Tried[BestSlot] |= 1ULL << BestDci;
+    Endpoint         = &mModel.Slots[BestSlot].Endpoints[BestDci];
+    if (!ModelFetchTd (Endpoint, (BOOLEAN)(BestDci == 1), &Td)) {
+      continue;
+    }
+
+    mModel.BusSlot       = (UINT8)BestSlot;
+    mModel.BusDci        = (UINT8)BestDci;
+    mModel.BusStart      = MAX (mModel.BusFree, Endpoint->RungAt);
+    mModel.BusEventCount = 0;
+    if (BestDci == 1) {
+      Code = ModelRunControlTd (&Td, &Duration);
+    } else {
+      Code = ModelRunBulkTd (&Td, (UINT8)BestDci, &Duration);
+    }
+
+    if (Code == MODEL_NAK) {
+      continue;
+    }
+
+    mModel.BusTd      = Td.Addresses[0];
+    mModel.BusTdCycle = Endpoint->Cycle;
+    mModel.BusEnd     = mModel.BusStart + Duration;
+    mModel.BusBusy    = TRUE;
+    mModel.BusTime   += Duration;
+    mModel.Tds++;
+
+    //
+    // A halted endpoint keeps its dequeue pointer on the failed TD.
+    //
+    if ((Code == TRB_COMPLETION_SUCCESS) || (Code == TRB_COMPLETION_SHORT_PACKET)) {
+      Endpoint->Dequeue = Td.Next;
+      Endpoint->Cycle   = Td.NextCycle;
+    } else {
+      Endpoint->State = MODEL_EP_HALTED;
+    }
+
+    return TRUE;
+  }
+}
+
+/**
+  Complete the TDs whose bus time has passed and start the ones queued
+  behind them.
+**/
+STATIC
+VOID
+ModelRunBus (
+  VOID
+  )
+{
+  UINT32  Index;
+
+  do {
+    if (mModel.BusBusy) {
+      if (mModel.BusEnd > mModel.Time) {
+        return;
+      }
+
+      for (Index = 0; Index < mModel.BusEventCount; Index++) {
+        ModelPostEvent (&mModel.BusEvents[Index]);
+      }
+
+      mModel.BusBusy = FALSE;
+      mModel.BusFree = mModel.BusEnd;
+    }
+  } while (ModelStartTd ());
+}
+
+/**
+  Take the TD of an endpoint off the bus unfinished and put its dequeue
+  pointer back on it.
+
+  @param  Code          Completion code to report, 0 for none.
+**/
+STATIC
+VOID
+ModelCancelTd (
+  IN UINT8  Code
+  )
+{
+  MODEL_ENDPOINT  *Endpoint;
+
+  Endpoint          = &mModel.Slots[mModel.BusSlot].Endpoints[mModel.BusDci];
+  Endpoint->Dequeue = mModel.BusTd;
+  Endpoint->Cycle   = mModel.BusTdCycle;
+  mModel.BusBusy    = FALSE;
+  mModel.BusFree    = mModel.Time;
+
+  if (Code != 0) {
+    mModel.BusEventCount = 0;
+    ModelTransferEvent (mModel.BusTd, Code, 0);
+    ModelPostEvent (&mModel.BusEvents[0]);
+  }
+}
+
+/**
+  Ring the doorbell of a device endpoint.
+**/
+STATIC
+VOID
+ModelRingEndpoint (
+  IN UINT32  SlotId,
+  IN UINT32  Dci
+  )
+{
+  MODEL_ENDPOINT  *Endpoint;
+
+  if ((Dci == 0) || (Dci > XHCI_MAX_DCI) ||
+      (mModel.Slots[SlotId].Endpoints[Dci].State == MODEL_EP_DISABLED))
+  {
+    ModelViolation ("doorbell of an endpoint that is not enabled");
+    return;
+  }
+
+  //
+  // A halted endpoint ignores its doorbell until it is reset.
+  //
+  Endpoint         = &mModel.Slots[SlotId].Endpoints[Dci];
+  Endpoint->RungAt = mModel.Time;
+  if (Endpoint->State == MODEL_EP_STOPPED) {
+    Endpoint->State = MODEL_EP_RUNNING;
+  }
+
+  ModelRunBus ();
+}
+
+//
+// Command ring
+//
+
+STATIC
+VOID
+ModelCompleteCommand (
+  IN UINT64  Address,
+  IN UINT8   Code,
+  IN UINT8   SlotId
+  )
+{
+  XHCI_TRB  Event;
+
+  Event.Parameter = Address;
+  Event.Status    = (UINT32)Code << 24;
+  Event.Control   = TRB_TYPE (TRB_TYPE_COMMAND_COMPLT_EVENT) | TRB_SLOT_ID (SlotId);
+  ModelPostEvent (&Event);
+}
+
+/**
+  Return a context entry of the input context a command points to.
+**/
+STATIC
+VOID *
+ModelInputContext (
+  IN XHCI_TRB  *Command,
+  IN UINT32    Dci
+  )
+{
+  return (UINT8 *)XHCI_HOST_ADDRESS (Command->Parameter) + (Dci + 1) * MODEL_CONTEXT_SIZE;
+}
+
+/**
+  Return a context entry of the output context of a slot, found through
+  the DCBAA.
+**/
+STATIC
+VOID *
+ModelOutputContext (
+  IN UINT32  SlotId,
+  IN UINT32  Dci
+  )
+{
+  UINT64  *Dcbaa;
+
+  Dcbaa = XHCI_HOST_ADDRESS (mModel.Dcbaap);
+  return (UINT8 *)XHCI_HOST_ADDRESS (Dcbaa[SlotId]) + Dci * MODEL_CONTEXT_SIZE;
+}
+
+/**
+  Enable an endpoint from its input context entry.
+**/
+STATIC
+VOID
+ModelAddEndpoint (
+  IN XHCI_TRB  *Command,
+  IN UINT32    SlotId,
+  IN UINT32    Dci
+  )
+{
+  XHCI_ENDPOINT_CONTEXT  *Input;
+  MODEL_ENDPOINT         *Endpoint;
+
+  Input = ModelInputContext (Command, Dci);
+  if ((Input->Dequeue & ~(UINT64)0xF) == 0) {
+    ModelViolation ("endpoint added without a transfer ring");
+  }
+
+  Endpoint          = &mModel.Slots[SlotId].Endpoints[Dci];
+  Endpoint->State   = MODEL_EP_RUNNING;
+  Endpoint->Dequeue = Input->Dequeue & ~(UINT64)0xF;
+  Endpoint->Cycle   = (UINT32)(Input->Dequeue & TRB_CYCLE);
+  Endpoint->RungAt  = 0;
+  memcpy (ModelOutputContext (SlotId, Dci), Input, MODEL_CONTEXT_SIZE);
+}
+
+/**
+  Stop using an endpoint of a slot, taking its TD off the bus.
+**/
+STATIC
+VOID
+ModelDropEndpoint (
+  IN UINT32  SlotId,
+  IN UINT32  Dci
+  )
+{
+  if (mModel.BusBusy && (mModel.BusSlot == SlotId) && (mModel.BusDci == Dci)) {
+    ModelCancelTd (0);
+  }
+
+  memset (&mModel.Slots[SlotId].Endpoints[Dci], 0, sizeof (MODEL_ENDPOINT));
+}
+
+/**
+  Execute Address Device, Evaluate Context or Configure Endpoint.
+**/
+STATIC
+UINT8
+ModelContextCommand (
+  IN XHCI_TRB  *Command,
+  IN UINT32    SlotId
+  )
+{
+  XHCI_INPUT_CONTROL_CONTEXT  *InputControl;
+  XHCI_SLOT_CONTEXT           *Slot;
+  XHCI_SLOT_CONTEXT           *Output;
+  UINT32                      Dci;
+
+  InputControl = XHCI_HOST_ADDRESS (Command->Parameter);
+  Slot         = ModelInputContext (Command, 0);
+
+  switch (TRB_GET_TYPE (Command->Control)) {
+    case TRB_TYPE_ADDRESS_DEV:
+      if ((InputControl->AddFlags & (BIT0 | BIT1)) != (BIT0 | BIT1)) {
+        ModelViolation ("Address Device without slot and EP0 contexts");
+        return TRB_COMPLETION_TRB_ERROR;
+      }
+
+      if ((mModel.Device == NULL) || (((Slot->Dword1 >> 16) & 0xFF) != mModel.Device->Port + 1U)) {
+        return TRB_COMPLETION_USB_TRANSACTION_ERROR;
+      }
+
+      if (mModel.Slots[SlotId].Address != 0) {
+        ModelViolation ("Address Device of an addressed slot");
+        return MODEL_COMPLETION_CONTEXT_STATE;
+      }
+
+      ModelDropEndpoint (SlotId, 1);
+      ModelAddEndpoint (Command, SlotId, 1);
+      if ((Command->Control & TRB_BSR) == 0) {
+        mModel.Slots[SlotId].Address = (UINT8)SlotId;
+      }
+
+      Output = ModelOutputContext (SlotId, 0);
+      memcpy (Output, Slot, MODEL_CONTEXT_SIZE);
+      Output->Dword3 = mModel.Slots[SlotId].Address;
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_EVALU_CONTXT:
+      if ((InputControl->AddFlags & ~(BIT0 | BIT1)) != 0) {
+        ModelViolation ("Evaluate Context of an endpoint other than EP0");
+      }
+
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_CON_ENDPOINT:
+      if (mModel.Slots[SlotId].Address == 0) {
+        ModelViolation ("Configure Endpoint before Address Device");
+        return MODEL_COMPLETION_CONTEXT_STATE;
+      }
+
+      if (((InputControl->AddFlags | InputControl->DropFlags) & (BIT1 | BIT0)) != BIT0) {
+        ModelViolation ("Configure Endpoint touching EP0 or without the slot context");
+        return TRB_COMPLETION_TRB_ERROR;
+      }
+
+      for (Dci = 2; Dci <= XHCI_MAX_DCI; Dci++) {
+        if ((InputControl->DropFlags & (1U << Dci)) != 0) {
+          ModelDropEndpoint (SlotId, Dci);
+        }
+
+        if ((InputControl->AddFlags & (1U << Dci)) != 0) {
+          ModelDropEndpoint (SlotId, Dci);
+          ModelAddEndpoint (Command, SlotId, Dci);
+        }
+      }
+
+      return TRB_COMPLETION_SUCCESS;
+
+    default:
+      return TRB_COMPLETION_TRB_ERROR;
+  }
+}
+
+/**
+  Execute Reset Endpoint, Stop Endpoint or Set TR Dequeue Pointer.
+**/
+STATIC
+UINT8
+ModelEndpointCommand (
+  IN XHCI_TRB  *Command,
+  IN UINT32    SlotId
+  )
+{
+  MODEL_ENDPOINT  *Endpoint;
+  UINT32          Dci;
+
+  Dci = TRB_GET_EP_ID (Command->Control);
+  if ((Dci == 0) || (mModel.Slots[SlotId].Endpoints[Dci].State == MODEL_EP_DISABLED)) {
+    ModelViolation ("endpoint command for an endpoint that is not enabled");
+    return TRB_COMPLETION_TRB_ERROR;
+  }
+
+  Endpoint = &mModel.Slots[SlotId].Endpoints[Dci];
+  switch (TRB_GET_TYPE (Command->Control)) {
+    case TRB_TYPE_RESET_ENDPOINT:
+      if (Endpoint->State != MODEL_EP_HALTED) {
+        return MODEL_COMPLETION_CONTEXT_STATE;
+      }
+
+      Endpoint->State = MODEL_EP_STOPPED;
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_STOP_ENDPOINT:
+      if (Endpoint->State != MODEL_EP_RUNNING) {
+        return MODEL_COMPLETION_CONTEXT_STATE;
+      }
+
+      if (mModel.BusBusy && (mModel.BusSlot == SlotId) && (mModel.BusDci == Dci)) {
+        ModelCancelTd (TRB_COMPLETION_STOPPED);
+      }
+
+      Endpoint->State = MODEL_EP_STOPPED;
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_SET_TR_DEQUE:
+      if (Endpoint->State != MODEL_EP_STOPPED) {
+        return MODEL_COMPLETION_CONTEXT_STATE;
+      }
+
+      Endpoint->Dequeue = Command->Parameter & ~(UINT64)0xF;
+      Endpoint->Cycle   = (UINT32)(Command->Parameter & TRB_CYCLE);
+      return TRB_COMPLETION_SUCCESS;
+
+    default:
+      return TRB_COMPLETION_TRB_ERROR;
+  }
+}
+
+/**
+  Execute one command.
+
+  @param  Command       Command TRB.
+  @param  SlotId        Slot reported in the completion.
+
+  @return Completion code.
+**/
+STATIC
+UINT8
+ModelCommand (
+  IN  XHCI_TRB  *Command,
+  OUT UINT8     *SlotId
+  )
+{
+  UINT32  Type;
+  UINT32  Dci;
+
+  Type    = TRB_GET_TYPE (Command->Control);
+  *SlotId = 0;
+  switch (Type) {
+    case TRB_TYPE_NO_OP_COMMAND:
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_EN_SLOT:
+      for (*SlotId = 1; *SlotId <= MIN (mModel.Config & 0xFF, MODEL_MAX_SLOTS); (*SlotId)++) {
+        if (!mModel.Slots[*SlotId].Enabled) {
+          memset (&mModel.Slots[*SlotId], 0, sizeof (MODEL_SLOT));
+          mModel.Slots[*SlotId].Enabled = TRUE;
+          return TRB_COMPLETION_SUCCESS;
+        }
+      }
+
+      *SlotId = 0;
+      return MODEL_COMPLETION_NO_SLOTS;
+
+    case TRB_TYPE_DIS_SLOT:
+    case TRB_TYPE_ADDRESS_DEV:
+    case TRB_TYPE_EVALU_CONTXT:
+    case TRB_TYPE_CON_ENDPOINT:
+    case TRB_TYPE_RESET_ENDPOINT:
+    case TRB_TYPE_STOP_ENDPOINT:
+    case TRB_TYPE_SET_TR_DEQUE:
+      *SlotId = (UINT8)TRB_GET_SLOT_ID (Command->Control);
+      if ((*SlotId == 0) || (*SlotId > MODEL_MAX_SLOTS) || !mModel.Slots[*SlotId].Enabled) {
+        ModelViolation ("command for a slot that is not enabled");
+        return MODEL_COMPLETION_SLOT_NOT_ENABLED;
+      }
+
+      break;
+
+    default:
+      ModelViolation ("unknown command");
+      return TRB_COMPLETION_TRB_ERROR;
+  }
+
+  switch (Type) {
+    case TRB_TYPE_DIS_SLOT:
+      for (Dci = 1; Dci <= XHCI_MAX_DCI; Dci++) {
+        ModelDropEndpoint (*SlotId, Dci);
+      }
+
+      mModel.Slots[*SlotId].Enabled = FALSE;
+      mModel.Slots[*SlotId].Address = 0;
+      return TRB_COMPLETION_SUCCESS;
+
+    case TRB_TYPE_ADDRESS_DEV:
+    case TRB_TYPE_EVALU_CONTXT:
+    case TRB_TYPE_CON_ENDPOINT:
+      return ModelContextCommand (Command, *SlotId);
+
+    default:
+      return ModelEndpointCommand (Command, *SlotId);
+  }
+}
+
+/**
+  Fetch and execute commands until the ring is empty or a command hangs.
+**/
+STATIC
+VOID
+ModelRunCommands (
+  VOID
+  )
+{
+  XHCI_TRB  *Trb;
+  UINT8     Code;
+  UINT8     SlotId;
+
+  while (!mModel.CmdBusy) {
+    Trb = XHCI_HOST_ADDRESS (mModel.CmdDequeue);
+    if ((Trb->Control & TRB_CYCLE) != mModel.CmdCycle) {
+      return;
+    }
+
+    if (TRB_GET_TYPE (Trb->Control) == TRB_TYPE_LINK) {
+      mModel.Links++;
+      if ((Trb->Control & TRB_TOGGLE_CYCLE) != 0) {
+        mModel.CmdCycle ^= 1;
+      }
+
+      mModel.CmdDequeue = Trb->Parameter;
+      continue;
+    }
+
+    if (mModel.HangCommands) {
+      mModel.CmdBusy = TRUE;
+      return;
+    }
+
+    mModel.Commands++;
+    Code = ModelCommand (Trb, &SlotId);
+    ModelCompleteCommand (mModel.CmdDequeue, Code, SlotId);
+    mModel.CmdDequeue += sizeof (XHCI_TRB);
+  }
+}
+
+/**
+  Abort the command in progress and stop the command ring.
+**/
+STATIC
+VOID
+ModelAbortCommands (
+  VOID
+  )
+{
+  if (!mModel.CmdRunning) {
+    return;
+  }
+
+  mModel.Aborts++;
+  if (mModel.CmdBusy) {
+    ModelCompleteCommand (mModel.CmdDequeue, TRB_COMPLETION_COMMAND_ABORTED, 0);
+    mModel.CmdDequeue += sizeof (XHCI_TRB);
+    mModel.CmdBusy     = FALSE;
+  }
+
+  ModelCompleteCommand (mModel.CmdDequeue, TRB_COMPLETION_COMMAND_RING_STOPPED, 0);
+  mModel.CmdRunning = FALSE;
+}
+
+//
+// Registers
+//
+
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  )
+{
+  UINTN  Offset;
+
+  Offset = Address - MODEL_BASE;
+  switch (Offset) {
+    case XHCI_CAPLENGTH:
+      return 0x01000000 | MODEL_CAPLENGTH;
+    case XHCI_HCSPARAMS1:
+      return ((UINT32)MODEL_MAX_PORTS << 24) | MODEL_MAX_SLOTS;
+    case XHCI_HCSPARAMS2:
+      return (UINT32)MODEL_SCRATCHPADS << 27;
+    case XHCI_HCCPARAMS:
+      return XHCI_HCC_AC64;
+    case XHCI_DBOFF:
+      return MODEL_DBOFF;
+    case XHCI_RTSOFF:
+      return MODEL_RTSOFF;
+    case MODEL_CAPLENGTH + XHCI_USBCMD:
+      return mModel.UsbCmd;
+    case MODEL_CAPLENGTH + XHCI_USBSTS:
+      return ((mModel.UsbCmd & XHCI_CMD_RUN) == 0) ? XHCI_STS_HCH : 0;
+    case MODEL_CAPLENGTH + XHCI_PAGESIZE:
+      return 1;
+    case MODEL_CAPLENGTH + XHCI_CRCR:
+      return mModel.CmdRunning ? XHCI_CRCR_CRR : 0;
+    case MODEL_CAPLENGTH + XHCI_CONFIG:
+      return mModel.Config;
+    case MODEL_RTSOFF + XHCI_IR0 + XHCI_IMAN:
+      return mModel.Iman;
+    default:
+      ModelViolation ("read of an unmodelled register");
+      return 0;
+  }
+}
+
+UINT64
+EFIAPI
+PlatformMmioRead64 (
+  IN UINTN  Address
+  )
+{
+  ModelViolation ("64-bit register read");
+  return 0;
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  UINTN   Offset;
+  UINT32  SlotId;
+
+  Offset = Address - MODEL_BASE;
+  if (Offset >= MODEL_DBOFF) {
+    SlotId = (UINT32)(Offset - MODEL_DBOFF) / sizeof (UINT32);
+    if ((mModel.UsbCmd & XHCI_CMD_RUN) == 0) {
+      ModelViolation ("doorbell while halted");
+    } else if ((SlotId == 0) && (Value == 0)) {
+      mModel.CmdRunning = TRUE;
+      ModelRunCommands ();
+    } else if ((SlotId == 0) || (SlotId > MODEL_MAX_SLOTS) || !mModel.Slots[SlotId].Enabled) {
+      ModelViolation ("doorbell of a slot that is not enabled");
+    } else {
+      ModelRingEndpoint (SlotId, Value);
+    }
+
+    return;
+  }
+
+  switch (Offset) {
+    case MODEL_CAPLENGTH + XHCI_USBCMD:
+      if (((Value & XHCI_CMD_RUN) != 0) && ((mModel.UsbCmd & XHCI_CMD_RUN) == 0)) {
+        if ((mModel.Dcbaap == 0) || (mModel.Erstsz == 0) || (mModel.Config == 0)) {
+          ModelViolation ("run before DCBAAP, CONFIG and the event ring are set");
+        }
+      } else if ((Value & XHCI_CMD_RUN) == 0) {
+        mModel.CmdRunning = FALSE;
+        mModel.CmdBusy    = FALSE;
+      }
+
+      mModel.UsbCmd = Value & ~XHCI_CMD_HCRST;
+      break;
+
+    case MODEL_CAPLENGTH + XHCI_USBSTS:
+      break;
+
+    case MODEL_CAPLENGTH + XHCI_CRCR:
+      if ((Value & XHCI_CRCR_CA) != 0) {
+        ModelAbortCommands ();
+      } else {
+        ModelViolation ("32-bit CRCR write without abort");
+      }
+
+      break;
+
+    case MODEL_CAPLENGTH + XHCI_CONFIG:
+      if ((Value & 0xFF) > MODEL_MAX_SLOTS) {
+        ModelViolation ("more slots enabled than supported");
+      }
+
+      mModel.Config = Value;
+      break;
+
+    case MODEL_RTSOFF + XHCI_IR0 + XHCI_IMAN:
+      mModel.Iman = (mModel.Iman & ~(Value & XHCI_IMAN_IP)) | (Value & XHCI_IMAN_IE);
+      break;
+
+    case MODEL_RTSOFF + XHCI_IR0 + XHCI_ERSTSZ:
+      mModel.Erstsz = Value & 0xFFFF;
+      break;
+
+    default:
+      ModelViolation ("write of an unmodelled register");
+      break;
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite64 (
+  IN UINTN   Address,
+  IN UINT64  Value
+  )
+{
+  UINT32  Segment;
+  UINT32  Index;
+
+  switch (Address - MODEL_BASE) {
+    case MODEL_CAPLENGTH + XHCI_CRCR:
+      if (mModel.CmdRunning) {
+        ModelViolation ("command ring moved while running");
+      }
+
+      mModel.CmdDequeue = Value & ~(UINT64)0x3F;
+      mModel.CmdCycle   = (UINT32)(Value & XHCI_CRCR_RCS);
+      break;
+
+    case MODEL_CAPLENGTH + XHCI_DCBAAP:
+      mModel.Dcbaap = Value;
+      break;
+
+    case MODEL_RTSOFF + XHCI_IR0 + XHCI_ERSTBA:
+      if (mModel.Erstsz == 0) {
+        ModelViolation ("ERSTBA written before ERSTSZ");
+      }
+
+      mModel.Erstba       = Value;
+      mModel.EventSegment = 0;
+      mModel.EventIndex   = 0;
+      mModel.EventCycle   = 1;
+      break;
+
+    case MODEL_RTSOFF + XHCI_IR0 + XHCI_ERDP:
+      mModel.Erdp = Value;
+      mModel.ErdpWrites++;
+      if ((mModel.Erstba != 0) && !ModelEventDequeue (&Segment, &Index)) {
+        ModelViolation ("ERDP outside the event ring");
+      }
+
+      break;
+
+    default:
+      ModelViolation ("64-bit write of an unmodelled register");
+      break;
+  }
+}
+
+//
+// Controller bring-up
+//
+
+VOID
+ModelStart (
+  OUT XHCI_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+
+  memset (&mModel, 0, sizeof (mModel));
+  memset (Private, 0, sizeof (*Private));
+
+  Private->Signature      = XHCI_PRIVATE_SIGNATURE;
+  Private->XhciBase       = MODEL_BASE;
+  Private->CapLength      = PlatformMmioRead32 (MODEL_BASE + XHCI_CAPLENGTH) & 0xFF;
+  Private->OpBase         = MODEL_BASE + Private->CapLength;
+  Private->RtBase         = MODEL_BASE + PlatformMmioRead32 (MODEL_BASE + XHCI_RTSOFF);
+  Private->DbBase         = MODEL_BASE + PlatformMmioRead32 (MODEL_BASE + XHCI_DBOFF);
+  Private->MaxSlots       = XHCI_GET_MAX_SLOTS (PlatformMmioRead32 (MODEL_BASE + XHCI_HCSPARAMS1));
+  Private->MaxPorts       = XHCI_GET_MAX_PORTS (PlatformMmioRead32 (MODEL_BASE + XHCI_HCSPARAMS1));
+  Private->MaxScratchpads = XHCI_GET_MAX_SCRATCHPADS (PlatformMmioRead32 (MODEL_BASE + XHCI_HCSPARAMS2));
+  Private->HccParams      = PlatformMmioRead32 (MODEL_BASE + XHCI_HCCPARAMS);
+  Private->PageSize       = EFI_PAGE_SIZE;
+  Private->ContextSize    = MODEL_CONTEXT_SIZE;
+  InitializeListHead (&Private->UrbList);
+  InitializeListHead (&Private->StorageList);
+
+  Status = XhciAllocateRings (Private);
+  CHECK (!EFI_ERROR (Status), "rings allocated");
+  if (EFI_ERROR (Status)) {
+    exit (1);
+  }
+
+  XhciProgramRings (Private);
+  XhciWriteOpReg (Private, XHCI_USBCMD, XHCI_CMD_RUN | XHCI_CMD_INTE);
+  Status = XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, 0, XHCI_RESET_TIMEOUT);
+  CHECK (!EFI_ERROR (Status), "controller running");
+}
+
+VOID
+ModelStop (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XhciWriteOpReg (Private, XHCI_USBCMD, 0);
+  XhciFreeRings (Private);
+}
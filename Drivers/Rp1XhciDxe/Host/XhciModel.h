@@ -0,0 +1,234 @@
+/** @file
+  Software xHCI controller the Rp1XhciDxe host tests run the engine on.
+
+  The model decodes the capability, operational, runtime and doorbell
+  registers, fetches the command ring on doorbell 0 following link TRBs
+  and the consumer cycle state, executes the commands and posts their
+  completions to the event ring described by the ERST, refusing to
+  overrun the dequeue pointer last written to ERDP. Whatever the host
+  does against the xHCI rules is counted as a violation.
+
+  A test may attach one USB device. The slot and endpoint commands then
+  keep device and endpoint state, and endpoint doorbells hand the TDs on
+  the transfer rings to the device one at a time, as on a single bus:
+  each TD occupies the bus for the device's latency plus its bytes at
+  MODEL_BUS_BYTES_PER_US, and its transfer events are posted once the
+  model time has passed its end.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef XHCI_MODEL_H_
+#define XHCI_MODEL_H_
+
+#include "HostTest.h"
+
+#include "../Rp1XhciDxe.h"
+
+//
+// Register windows of the model
+//
+#define MODEL_BASE        0x200000000ULL
+#define MODEL_CAPLENGTH   0x20
+#define MODEL_RTSOFF      0x1000
+#define MODEL_DBOFF       0x2000
+#define MODEL_MAX_SLOTS   32
+#define MODEL_MAX_PORTS   2
+#define MODEL_SCRATCHPADS 2
+
+//
+// Bus timing: SuperSpeed bulk payload rate and the fixed cost of a TD
+//
+#define MODEL_BUS_BYTES_PER_US  400
+#define MODEL_TD_OVERHEAD       2
+
+//
+// Returned by a device for a TD it cannot take yet; the TD stays on its
+// ring until the device state changes.
+//
+#define MODEL_NAK  0xFF
+
+/**
+  Run a control transfer on the default endpoint of the device.
+
+  @param  Request       Setup packet.
+  @param  Data          Data stage buffer.
+  @param  Length        On input the data stage length, on output the
+                        bytes moved.
+
+  @return TRB completion code.
+**/
+typedef
+UINT8
+(*MODEL_DEVICE_CONTROL)(
+  IN     EFI_USB_DEVICE_REQUEST  *Request,
+  IN OUT VOID                    *Data,
+  IN OUT UINTN                   *Length
+  );
+
+/**
+  Run a TD on a bulk endpoint of the device.
+
+  @param  EpAddress     Endpoint address.
+  @param  Data          Data of an OUT TD, buffer for an IN TD.
+  @param  Length        On input the TD length, on output the bytes moved.
+  @param  Latency       Microseconds the device takes before data moves.
+
+  @return TRB completion code, or MODEL_NAK to leave the TD on the ring.
+**/
+typedef
+UINT8
+(*MODEL_DEVICE_BULK)(
+  IN     UINT8   EpAddress,
+  IN OUT VOID    *Data,
+  IN OUT UINTN   *Length,
+  OUT    UINT64  *Latency
+  );
+
+typedef struct {
+  UINT8                 Port;       // root port, 0-based
+  MODEL_DEVICE_CONTROL  Control;
+  MODEL_DEVICE_BULK     Bulk;
+} MODEL_DEVICE;
+
+//
+// Endpoint states, as in the endpoint context
+//
+#define MODEL_EP_DISABLED  0
+#define MODEL_EP_RUNNING   1
+#define MODEL_EP_HALTED    2
+#define MODEL_EP_STOPPED   3
+
+typedef struct {
+  UINT8     State;
+  UINT64    Dequeue;
+  UINT32    Cycle;
+  UINT64    RungAt;                   // time of the last doorbell
+} MODEL_ENDPOINT;
+
+typedef struct {
+  BOOLEAN         Enabled;
+  UINT8           Address;            // 0 in the default state
+  MODEL_ENDPOINT  Endpoints[XHCI_MAX_DCI + 1];
+} MODEL_SLOT;
+
+typedef struct {
+  //
+  // Configuration
+  //
+  BOOLEAN       HangCommands;         // fetch commands but never complete them
+  MODEL_DEVICE  *Device;              // device on a root port, or NULL
+
+  //
+  // Registers
+  //
+  UINT32        UsbCmd;
+  UINT32        Config;
+  UINT64        Dcbaap;
+  UINT32        Iman;
+  UINT32        Erstsz;
+  UINT64        Erstba;
+  UINT64        Erdp;
+
+  //
+  // Command ring
+  //
+  UINT64        CmdDequeue;
+  UINT32        CmdCycle;
+  BOOLEAN       CmdRunning;           // CRCR.CRR
+  BOOLEAN       CmdBusy;              // the command at CmdDequeue hangs
+
+  //
+  // Event ring producer
+  //
+  UINT32        EventSegment;
+  UINT32        EventIndex;
+  UINT32        EventCycle;
+
+  //
+  // Device slots and the TD on the bus. BusStart and BusEnd bound the TD
+  // being run; BusFree is where the one before it ended.
+  //
+  MODEL_SLOT    Slots[MODEL_MAX_SLOTS + 1];
+  BOOLEAN       BusBusy;
+  UINT8         BusSlot;
+  UINT8         BusDci;
+  UINT64        BusTd;                // first TRB of the TD on the bus
+  UINT32        BusTdCycle;
+  UINT64        BusStart;
+  UINT64        BusEnd;
+  UINT64        BusFree;
+  XHCI_TRB      BusEvents[2];
+  UINT32        BusEventCount;
+
+  //
+  // Time in microseconds, advanced by the engine's stalls
+  //
+  UINT64        Time;
+
+  //
+  // Counters
+  //
+  UINT64        Commands;
+  UINT64        Links;                // link TRBs followed on the command ring
+  UINT64        Aborts;
+  UINT64        Events;
+  UINT64        ErdpWrites;
+  UINT64        Invalidates;
+  UINT64        Tds;                  // TDs run on the bus
+  UINT64        BusTime;              // microseconds the bus was busy
+  UINT64        Allocations;
+  UINT64        Frees;
+  UINT64        Violations;           // protocol errors by the host
+} MODEL;
+
+extern MODEL  mModel;
+
+/**
+  Count a protocol error by the host.
+
+  @param  Message       What went wrong.
+**/
+VOID
+ModelViolation (
+  IN CONST char  *Message
+  );
+
+/**
+  Post an event TRB with the producer cycle state.
+
+  @param  Event         Event; its cycle bit is replaced.
+
+  @retval TRUE          Event posted.
+  @retval FALSE         The event ring is full.
+**/
+BOOLEAN
+ModelPostEvent (
+  IN XHCI_TRB  *Event
+  );
+
+/**
+  Reset the model and bring a controller up on it the way
+  XhciInitController() does: rings allocated and programmed, controller
+  running.
+
+  @param  Private       XHCI private data to set up.
+**/
+VOID
+ModelStart (
+  OUT XHCI_PRIVATE_DATA  *Private
+  );
+
+/**
+  Halt the controller and release the rings.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+ModelStop (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+#endif
@@ -0,0 +1,340 @@
+/** @file
+  Host test of the Rp1XhciDxe ring engine against a software controller.
+
+  XhciRing.c and XhciReg.c are built unchanged on top of the xHCI model
+  in XhciModel.c. The scenarios cover TRB enqueue up to a full ring,
+  link TRB hand-over and the producer cycle toggle on the command ring,
+  batched event ring drains with one ERDP update per batch across the
+  event ring wrap, and a command timeout with the abort and restart of
+  the command ring.
+
+    cd Drivers/Rp1XhciDxe
+    cc -O2 -IHost -I../../Host -o XhciRingTest XhciRing.c XhciReg.c Host/XhciModel.c Host/XhciRingTest.c ../../Host/HostTest.c
+    ./XhciRingTest
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "XhciModel.h"
+
+STATIC UINT64  mTransferEvents;
+STATIC UINT64  mPortEvents;
+
+//
+// Event handlers of the modules not under test
+//
+
+VOID
+XhciHandleTransferEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+  mTransferEvents++;
+}
+
+VOID
+XhciHandlePortStatusEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+  mPortEvents++;
+}
+
+//
+// Scenarios
+//
+
+STATIC
+VOID
+NoOp (
+  OUT XHCI_TRB  *Trb
+  )
+{
+  memset (Trb, 0, sizeof (*Trb));
+  Trb->Control = TRB_TYPE (TRB_TYPE_NO_OP_COMMAND);
+}
+
+/**
+  Fill a transfer ring, free part of it and fill it again across the
+  last link TRB.
+**/
+STATIC
+VOID
+TestEnqueue (
+  VOID
+  )
+{
+  XHCI_RING   *Ring;
+  XHCI_TRB    Trb;
+  XHCI_TRB    *Link;
+  EFI_STATUS  Status;
+  UINT32      Capacity;
+  UINT32      Total;
+  UINT32      Queued;
+  UINT32      Indices[XHCI_TRANSFER_RING_SEGMENTS * XHCI_RING_SEGMENT_TRBS];
+  UINT32      Index;
+  UINT32      Last;
+  UINT32      Wrap;
+  UINT32      Segment;
+
+  printf ("Enqueue to a full transfer ring\n");
+
+  Ring     = XhciCreateTransferRing ();
+  Total    = XHCI_TRANSFER_RING_SEGMENTS * XHCI_RING_SEGMENT_TRBS;
+  Capacity = XhciRingFreeCount (Ring);
+  CHECK (Capacity == XHCI_TRANSFER_RING_SEGMENTS * (XHCI_RING_SEGMENT_TRBS - 1) - 1, "capacity excludes links and one slot");
+
+  //
+  // First pass: cycle 1, chain on every other TRB so that the links pick
+  // up both values.
+  //
+  memset (&Trb, 0, sizeof (Trb));
+  Last = 0;
+  for (Queued = 0; Queued < Capacity; Queued++) {
+    Trb.Parameter = Queued;
+    Trb.Control   = TRB_TYPE (TRB_TYPE_NORMAL) | (((Queued / XHCI_RING_SEGMENT_TRBS) % 2 == 0) ? TRB_CHAIN : 0) | TRB_CYCLE;
+    Status        = XhciRingEnqueue (Ring, &Trb, &Index);
+    CHECK (!EFI_ERROR (Status), "TRB queued");
+    CHECK ((Index % XHCI_RING_SEGMENT_TRBS) != XHCI_RING_SEGMENT_TRBS - 1, "TRB not placed on a link");
+    CHECK (Ring->Trbs[Index].Parameter == Queued, "TRB copied");
+    CHECK ((Ring->Trbs[Index].Control & TRB_CYCLE) == 1, "first pass carries cycle 1");
+    CHECK (XhciRingFreeCount (Ring) == Capacity - Queued - 1, "free count");
+    Indices[Queued] = Index;
+    Last            = Index;
+  }
+
+  Status = XhciRingEnqueue (Ring, &Trb, NULL);
+  CHECK (Status == EFI_OUT_OF_RESOURCES, "full ring refuses a TRB");
+
+  for (Segment = 0; Segment < XHCI_TRANSFER_RING_SEGMENTS - 1; Segment++) {
+    Link = &Ring->Trbs[(Segment + 1) * XHCI_RING_SEGMENT_TRBS - 1];
+    CHECK ((Link->Control & TRB_CYCLE) == 1, "crossed link handed over");
+    CHECK ((Link->Control & TRB_CHAIN) == (Link[-1].Control & TRB_CHAIN), "link carries the chain bit of the TRB before it");
+    CHECK ((Link->Control & TRB_TOGGLE_CYCLE) == 0, "only the last link toggles");
+    CHECK (Link->Parameter == XHCI_DMA_ADDRESS (Link + 1), "link points at the next segment");
+  }
+
+  Link = &Ring->Trbs[Total - 1];
+  CHECK ((Link->Control & TRB_CYCLE) == 0, "last link not handed over yet");
+  CHECK ((Link->Control & TRB_TOGGLE_CYCLE) != 0, "last link toggles");
+  CHECK (Link->Parameter == XHCI_DMA_ADDRESS (Ring->Trbs), "last link points at the first segment");
+  CHECK (Ring->Cycle == 1, "cycle unchanged before the wrap");
+
+  //
+  // Hand back the first half and fill again: the second pass crosses the
+  // last link and carries cycle 0 from there on.
+  //
+  Wrap = Ring->Enqueue;
+  XhciRingRetire (Ring, Indices[Capacity / 2 - 1]);
+  CHECK (XhciRingFreeCount (Ring) == Capacity / 2, "free count after retiring");
+
+  for (Queued = 0; Queued < Capacity / 2; Queued++) {
+    Trb.Parameter = Capacity + Queued;
+    Trb.Control   = TRB_TYPE (TRB_TYPE_NORMAL) | TRB_CYCLE;
+    Status        = XhciRingEnqueue (Ring, &Trb, &Index);
+    CHECK (!EFI_ERROR (Status), "TRB queued after the wrap");
+    CHECK ((Ring->Trbs[Index].Control & TRB_CYCLE) == ((Index >= Wrap) ? 1 : 0), "second pass flips cycle at the wrap");
+    CHECK (XhciRingFreeCount (Ring) == Capacity / 2 - Queued - 1, "free count across the wrap");
+    Last = Index;
+  }
+
+  CHECK (Ring->Cycle == 0, "producer cycle toggled by the last link");
+  CHECK ((Link->Control & TRB_CYCLE) == 1, "last link handed over with the old cycle");
+  CHECK (XhciRingEnqueue (Ring, &Trb, NULL) == EFI_OUT_OF_RESOURCES, "full again");
+
+  XhciRingRetire (Ring, Last);
+  CHECK (XhciRingFreeCount (Ring) == Capacity, "empty after retiring everything");
+  CHECK (XhciRingIndexFromDma (Ring, XHCI_DMA_ADDRESS (&Ring->Trbs[Last])) == Last, "index from bus address");
+  CHECK (XhciRingIndexFromDma (Ring, XHCI_DMA_ADDRESS (&Ring->Trbs[Total])) == MAX_UINT32, "address past the ring rejected");
+
+  XhciFreeTransferRing (Ring);
+}
+
+/**
+  Run the command ring round several times, one command per doorbell.
+**/
+STATIC
+VOID
+TestCommandWrap (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XHCI_TRB         Trb;
+  XHCI_CMD_RESULT  Result;
+  EFI_STATUS       Status;
+  UINT32           Capacity;
+  UINT32           Count;
+  UINT32           PerSegment;
+
+  printf ("Command ring wrap\n");
+
+  Capacity   = XhciRingFreeCount (&Private->CommandRing);
+  PerSegment = XHCI_RING_SEGMENT_TRBS - 1;
+  for (Count = 0; Count < 3 * XHCI_CMD_RING_TRBS + 5; Count++) {
+    NoOp (&Trb);
+    Status = XhciCmdExecute (Private, &Trb, &Result);
+    if (EFI_ERROR (Status)) {
+      CHECK (FALSE, "command completes");
+      break;
+    }
+  }
+
+  CHECK (mModel.Commands == Count, "every command executed once");
+  CHECK (mModel.Links == Count / PerSegment, "controller followed every link");
+  CHECK (Private->CommandRing.Cycle == ((Count / (PerSegment * XHCI_CMD_RING_SEGMENTS)) % 2 == 0 ? 1 : 0), "producer cycle toggled once per wrap");
+  CHECK (mModel.CmdCycle == Private->CommandRing.Cycle, "consumer cycle matches");
+  CHECK (XhciRingFreeCount (&Private->CommandRing) == Capacity, "command ring empty again");
+}
+
+/**
+  Drain bursts of events in batches: one ERDP write per batch, and one
+  invalidate per cache line of events.
+**/
+STATIC
+VOID
+TestEventBatch (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XHCI_TRB         Trb;
+  EFI_STATUS       Status;
+  UINT32           Index[40];
+  UINT64           Writes;
+  UINT64           Invalidates;
+  UINT64           Events;
+  UINTN            Count;
+  UINTN            Drained;
+  UINTN            Burst;
+  UINTN            Round;
+  UINTN            Calls;
+
+  printf ("Batched event drain\n");
+
+  //
+  // Bursts of port status changes, larger than a batch, going round the
+  // event ring several times; the last one fills it.
+  //
+  Events = mPortEvents;
+  for (Round = 0; Round < 21; Round++) {
+    Burst = (Round < 20) ? 40 : XHCI_EVENT_RING_TRBS - 1;
+    for (Count = 0; Count < Burst; Count++) {
+      Trb.Parameter = (UINT64)(1 + Count % MODEL_MAX_PORTS) << 24;
+      Trb.Status    = (UINT32)TRB_COMPLETION_SUCCESS << 24;
+      Trb.Control   = TRB_TYPE (TRB_TYPE_PORT_STATUS_CHANGE);
+      CHECK (ModelPostEvent (&Trb), "event posted");
+    }
+
+    Drained = 0;
+    Calls   = 0;
+    do {
+      Writes      = mModel.ErdpWrites;
+      Invalidates = mModel.Invalidates;
+      Count       = XhciProcessEventRing (Private);
+      Drained    += Count;
+      Calls++;
+      CHECK (Count == MIN (Burst - (Drained - Count), XHCI_EVENT_BATCH), "full batches first");
+      CHECK (mModel.ErdpWrites - Writes == ((Count > 0) ? 1 : 0), "one ERDP write per batch");
+      CHECK (mModel.Invalidates - Invalidates <= (Count + 3) / 4 + 1, "one invalidate per cache line");
+      CHECK (mModel.Erdp == (XHCI_DMA_ADDRESS (&Private->EventRing.Trbs[Private->EventRing.Dequeue]) | XHCI_ERDP_EHB),
+             "ERDP points at the next event and clears EHB");
+    } while (Count > 0);
+
+    CHECK (Drained == Burst, "burst drained");
+    CHECK (Calls == (Burst + XHCI_EVENT_BATCH - 1) / XHCI_EVENT_BATCH + 1, "drained in batches");
+  }
+
+  CHECK (mPortEvents - Events == 20 * 40 + XHCI_EVENT_RING_TRBS - 1, "port events dispatched");
+  CHECK (Private->EventRing.Cycle == mModel.EventCycle, "consumer cycle follows the producer");
+
+  //
+  // Commands queued together and started by one doorbell complete in one
+  // burst; waiting for the first drains a whole batch.
+  //
+  for (Count = 0; Count < 40; Count++) {
+    NoOp (&Trb);
+    Status = XhciCmdPost (Private, &Trb, &Index[Count]);
+    CHECK (!EFI_ERROR (Status), "command posted");
+  }
+
+  Writes = mModel.ErdpWrites;
+  XhciRingDoorbell (Private, 0, 0);
+  for (Count = 0; Count < 40; Count++) {
+    Status = XhciCmdWait (Private, Index[Count], XHCI_COMMAND_TIMEOUT, NULL);
+    CHECK (!EFI_ERROR (Status), "posted command completes");
+  }
+
+  CHECK (mModel.ErdpWrites - Writes == (40 + XHCI_EVENT_BATCH - 1) / XHCI_EVENT_BATCH, "completions drained in batches");
+  CHECK (mTransferEvents == 0, "no transfer events");
+}
+
+/**
+  A command that never completes times out, the command ring is aborted
+  and the next command runs normally.
+**/
+STATIC
+VOID
+TestCmdTimeout (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XHCI_TRB         Trb;
+  XHCI_CMD_RESULT  Result;
+  EFI_STATUS       Status;
+  UINT32           Capacity;
+  UINT32           Index;
+  UINT64           Start;
+
+  printf ("Command timeout\n");
+
+  Capacity            = XhciRingFreeCount (&Private->CommandRing);
+  mModel.HangCommands = TRUE;
+
+  NoOp (&Trb);
+  Status = XhciCmdPost (Private, &Trb, &Index);
+  CHECK (!EFI_ERROR (Status), "command posted");
+  XhciRingDoorbell (Private, 0, 0);
+
+  Start  = mModel.Time;
+  Status = XhciCmdWait (Private, Index, XHCI_COMMAND_TIMEOUT, &Result);
+  CHECK (Status == EFI_TIMEOUT, "command times out");
+  CHECK (mModel.Time - Start >= XHCI_COMMAND_TIMEOUT, "waited the full timeout");
+  CHECK (mModel.Time - Start < XHCI_COMMAND_TIMEOUT + 10 * XHCI_POLL_INTERVAL, "gave up right after the timeout");
+  CHECK (mModel.Aborts == 1, "command ring aborted");
+  CHECK (!mModel.CmdRunning, "command ring stopped");
+  CHECK (Private->CmdResults[Index].Done, "aborted command completed");
+  CHECK (Private->CmdResults[Index].CompletionCode == TRB_COMPLETION_COMMAND_ABORTED, "aborted command reported as such");
+  CHECK (XhciRingFreeCount (&Private->CommandRing) == Capacity, "command ring empty after the abort");
+
+  mModel.HangCommands = FALSE;
+  NoOp (&Trb);
+  Status = XhciCmdExecute (Private, &Trb, &Result);
+  CHECK (!EFI_ERROR (Status), "command ring restarted by the next doorbell");
+  CHECK (XhciRingFreeCount (&Private->CommandRing) == Capacity, "command ring empty again");
+}
+
+int
+main (
+  VOID
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+
+  Private = calloc (1, sizeof (*Private));
+  ModelStart (Private);
+
+  TestEnqueue ();
+  TestCommandWrap (Private);
+  TestEventBatch (Private);
+  TestCmdTimeout (Private);
+
+  ModelStop (Private);
+  CHECK (mModel.Allocations == mModel.Frees, "every page allocation freed");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+  free (Private);
+
+  return HostTestResult ();
+}
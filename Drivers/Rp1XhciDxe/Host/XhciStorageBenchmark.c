@@ -0,0 +1,612 @@
+/** @file
+  Host benchmark of the Rp1XhciDxe USB mass storage boot path.
+
+  XhciMassStorage.c, XhciTransfer.c and XhciDevice.c are built unchanged
+  on top of the xHCI model in XhciModel.c, with a SuperSpeed bulk-only
+  disk on root port 1. The disk answers the SCSI commands of the boot
+  path, takes DISK_READ_LATENCY to start a read and then moves data at
+  the bus rate of the model. The scenarios read the disk sequentially
+  through Block I/O, check the data, and report the throughput in model
+  time along with the number of commands and how much of the caller's
+  own work the read-ahead hid.
+
+    cd Drivers/Rp1XhciDxe
+    cc -O2 -IHost -I../../Host -o XhciStorageBenchmark XhciRing.c XhciReg.c XhciTransfer.c XhciDevice.c XhciMassStorage.c Host/XhciModel.c Host/XhciStorageBenchmark.c ../../Host/HostTest.c
+    ./XhciStorageBenchmark
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "XhciModel.h"
+
+//
+// The disk
+//
+#define DISK_PORT             0
+#define DISK_BLOCK_SIZE       512
+#define DISK_BLOCKS           (SIZE_64MB / DISK_BLOCK_SIZE * 2)
+#define DISK_BULK_IN          0x81
+#define DISK_BULK_OUT         0x02
+#define DISK_MAX_PACKET       1024
+#define DISK_READ_LATENCY     100     // microseconds from CBW to read data
+#define DISK_COMMAND_LATENCY  20      // microseconds for other commands
+
+//
+// Sense keys and additional sense codes
+//
+#define DISK_SENSE_UNIT_ATTENTION   0x06
+#define DISK_SENSE_ILLEGAL_REQUEST  0x05
+#define DISK_ASC_MEDIUM_CHANGED     0x28
+#define DISK_ASC_INVALID_OPCODE     0x20
+#define DISK_ASC_LBA_OUT_OF_RANGE   0x21
+
+//
+// Size of each benchmark read
+//
+#define BENCHMARK_SIZE  SIZE_64MB
+
+typedef enum {
+  BotCommand,
+  BotDataIn,
+  BotDataOut,
+  BotStatus
+} BOT_PHASE;
+
+typedef struct {
+  BOT_PHASE    Phase;
+  UINT32       Tag;
+  UINT32       DataLength;          // dCBWDataTransferLength
+  UINT32       Residue;
+  UINT8        Status;
+  UINT8        Response[32];
+  UINT32       ResponseLength;
+  BOOLEAN      Read;                // data stage comes from the medium
+  UINT64       ReadLba;
+  BOOLEAN      UnitAttention;
+  UINT8        SenseKey;
+  UINT8        Asc;
+  UINT8        Configuration;
+
+  //
+  // Counters
+  //
+  UINT64       Commands;
+  UINT64       Reads;
+  UINT64       LargestRead;         // bytes
+  UINT64       StageWaits;          // stages the host queued after the bus idled
+} DISK;
+
+STATIC DISK  mDisk;
+
+STATIC CONST UINT8  mDeviceDescriptor[] = {
+  18, USB_DESC_TYPE_DEVICE, 0x20, 0x03, 0, 0, 0, 9,
+  0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+STATIC CONST UINT8  mConfigDescriptor[] = {
+  9, USB_DESC_TYPE_CONFIG, 44, 0, 1, 1, 0, 0x80, 50,
+  9, USB_DESC_TYPE_INTERFACE, 0, 0, 2, USB_MASS_STORE_CLASS, XHCI_MASS_STORAGE_SCSI, XHCI_MASS_STORAGE_BOT, 0,
+  7, USB_DESC_TYPE_ENDPOINT, DISK_BULK_IN, USB_ENDPOINT_BULK, DISK_MAX_PACKET & 0xFF, DISK_MAX_PACKET >> 8, 0,
+  6, 0x30, 15, 0, 0, 0,
+  7, USB_DESC_TYPE_ENDPOINT, DISK_BULK_OUT, USB_ENDPOINT_BULK, DISK_MAX_PACKET & 0xFF, DISK_MAX_PACKET >> 8, 0,
+  6, 0x30, 15, 0, 0, 0
+};
+
+//
+// Port handling of the module not under test
+//
+
+VOID
+XhciHandlePortStatusEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+}
+
+VOID
+XhciServicePorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+}
+
+//
+// Disk model
+//
+
+/**
+  Return the word of the disk contents at a byte offset that is a
+  multiple of four.
+**/
+STATIC
+UINT32
+DiskWord (
+  IN UINT64  Offset
+  )
+{
+  return (UINT32)(Offset >> 2) * 2654435761U ^ (UINT32)(Offset >> 32);
+}
+
+STATIC
+VOID
+DiskFill (
+  OUT UINT8   *Buffer,
+  IN  UINT64  Offset,
+  IN  UINTN   Length
+  )
+{
+  UINT32  Word;
+  UINTN   Index;
+
+  for (Index = 0; Index < Length; Index += sizeof (Word)) {
+    Word = DiskWord (Offset + Index);
+    memcpy (Buffer + Index, &Word, sizeof (Word));
+  }
+}
+
+STATIC
+BOOLEAN
+DiskCheck (
+  IN CONST UINT8  *Buffer,
+  IN UINT64       Offset,
+  IN UINTN        Length
+  )
+{
+  UINT32  Word;
+  UINTN   Index;
+
+  for (Index = 0; Index < Length; Index += sizeof (Word)) {
+    memcpy (&Word, Buffer + Index, sizeof (Word));
+    if (Word != DiskWord (Offset + Index)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+VOID
+DiskFail (
+  IN UINT8  SenseKey,
+  IN UINT8  Asc
+  )
+{
+  mDisk.Status   = XHCI_BOT_CSW_FAILED;
+  mDisk.SenseKey = SenseKey;
+  mDisk.Asc      = Asc;
+}
+
+/**
+  Decode the SCSI command of a CBW and set up its data and status stages.
+**/
+STATIC
+VOID
+DiskCommand (
+  IN  XHCI_BOT_CBW  *Cbw,
+  OUT UINT64        *Latency
+  )
+{
+  UINT8   *Cmd;
+  UINT64  Lba;
+  UINT64  Blocks;
+
+  Cmd = Cbw->Cmd;
+
+  mDisk.Commands++;
+  mDisk.Tag            = Cbw->Tag;
+  mDisk.DataLength     = Cbw->DataLength;
+  mDisk.Residue        = Cbw->DataLength;
+  mDisk.Status         = XHCI_BOT_CSW_PASSED;
+  mDisk.ResponseLength = 0;
+  mDisk.Read           = FALSE;
+  *Latency             = DISK_COMMAND_LATENCY;
+
+  memset (mDisk.Response, 0, sizeof (mDisk.Response));
+
+  switch (Cmd[0]) {
+    case EFI_SCSI_OP_TEST_UNIT_READY:
+      if (mDisk.UnitAttention) {
+        mDisk.UnitAttention = FALSE;
+        DiskFail (DISK_SENSE_UNIT_ATTENTION, DISK_ASC_MEDIUM_CHANGED);
+      }
+
+      break;
+
+    case EFI_SCSI_OP_REQUEST_SENSE:
+      mDisk.Response[0]    = 0x70;
+      mDisk.Response[2]    = mDisk.SenseKey;
+      mDisk.Response[7]    = 10;
+      mDisk.Response[12]   = mDisk.Asc;
+      mDisk.ResponseLength = 18;
+      mDisk.SenseKey       = 0;
+      mDisk.Asc            = 0;
+      break;
+
+    case EFI_SCSI_OP_READ_CAPACITY:
+      WriteUnaligned32 ((UINT32 *)&mDisk.Response[0], SwapBytes32 (DISK_BLOCKS - 1));
+      WriteUnaligned32 ((UINT32 *)&mDisk.Response[4], SwapBytes32 (DISK_BLOCK_SIZE));
+      mDisk.ResponseLength = 8;
+      break;
+
+    case EFI_SCSI_OP_READ10:
+    case EFI_SCSI_OP_READ16:
+      if (Cmd[0] == EFI_SCSI_OP_READ10) {
+        Lba    = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Cmd[2]));
+        Blocks = SwapBytes16 (ReadUnaligned16 ((UINT16 *)&Cmd[7]));
+      } else {
+        Lba    = SwapBytes64 (ReadUnaligned64 ((UINT64 *)&Cmd[2]));
+        Blocks = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Cmd[10]));
+      }
+
+      if ((Lba + Blocks > DISK_BLOCKS) ||
+          (Blocks * DISK_BLOCK_SIZE != Cbw->DataLength) ||
+          ((Cbw->Flags & XHCI_BOT_CBW_DATA_IN) == 0))
+      {
+        ModelViolation ("bad READ command");
+        DiskFail (DISK_SENSE_ILLEGAL_REQUEST, DISK_ASC_LBA_OUT_OF_RANGE);
+        break;
+      }
+
+      mDisk.Reads++;
+      mDisk.LargestRead = MAX (mDisk.LargestRead, Cbw->DataLength);
+      mDisk.Read        = TRUE;
+      mDisk.ReadLba     = Lba;
+      *Latency          = DISK_READ_LATENCY;
+      break;
+
+    default:
+      DiskFail (DISK_SENSE_ILLEGAL_REQUEST, DISK_ASC_INVALID_OPCODE);
+      break;
+  }
+
+  if (Cbw->DataLength == 0) {
+    mDisk.Phase = BotStatus;
+  } else if ((Cbw->Flags & XHCI_BOT_CBW_DATA_IN) != 0) {
+    mDisk.Phase = BotDataIn;
+  } else {
+    mDisk.Phase = BotDataOut;
+  }
+}
+
+STATIC
+UINT8
+DiskControl (
+  IN     EFI_USB_DEVICE_REQUEST  *Request,
+  IN OUT VOID                    *Data,
+  IN OUT UINTN                   *Length
+  )
+{
+  CONST UINT8  *Descriptor;
+  UINTN        Size;
+
+  if ((Request->RequestType == USB_DEV_GET_DESCRIPTOR_REQ_TYPE) && (Request->Request == USB_DEV_GET_DESCRIPTOR)) {
+    switch (Request->Value >> 8) {
+      case USB_DESC_TYPE_DEVICE:
+        Descriptor = mDeviceDescriptor;
+        Size       = sizeof (mDeviceDescriptor);
+        break;
+
+      case USB_DESC_TYPE_CONFIG:
+        Descriptor = mConfigDescriptor;
+        Size       = sizeof (mConfigDescriptor);
+        break;
+
+      default:
+        return TRB_COMPLETION_STALL_ERROR;
+    }
+
+    *Length = MIN (*Length, Size);
+    memcpy (Data, Descriptor, *Length);
+    return TRB_COMPLETION_SUCCESS;
+  }
+
+  *Length = 0;
+
+  if ((Request->RequestType == USB_DEV_SET_CONFIGURATION_REQ_TYPE) && (Request->Request == USB_DEV_SET_CONFIGURATION)) {
+    mDisk.Configuration = (UINT8)Request->Value;
+    return TRB_COMPLETION_SUCCESS;
+  }
+
+  if ((Request->RequestType == USB_DEV_CLEAR_FEATURE_REQ_TYPE_E) && (Request->Request == USB_DEV_CLEAR_FEATURE)) {
+    return TRB_COMPLETION_SUCCESS;
+  }
+
+  if ((Request->RequestType == (USB_REQ_TYPE_CLASS | USB_TARGET_INTERFACE)) && (Request->Request == XHCI_BOT_RESET_REQUEST)) {
+    mDisk.Phase = BotCommand;
+    return TRB_COMPLETION_SUCCESS;
+  }
+
+  return TRB_COMPLETION_STALL_ERROR;
+}
+
+/**
+  Run a bulk TD. Each stage waits for its direction; a stage the host
+  had not queued by the time the bus went idle is counted, since the
+  boot path queues all three with the CBW.
+**/
+STATIC
+UINT8
+DiskBulk (
+  IN     UINT8   EpAddress,
+  IN OUT VOID    *Data,
+  IN OUT UINTN   *Length,
+  OUT    UINT64  *Latency
+  )
+{
+  XHCI_BOT_CSW  *Csw;
+  UINTN         Moved;
+
+  *Latency = 0;
+
+  switch (mDisk.Phase) {
+    case BotCommand:
+      if (EpAddress != DISK_BULK_OUT) {
+        return MODEL_NAK;
+      }
+
+      if ((*Length != sizeof (XHCI_BOT_CBW)) || (((XHCI_BOT_CBW *)Data)->Signature != XHCI_BOT_CBW_SIGNATURE)) {
+        ModelViolation ("invalid CBW");
+        return TRB_COMPLETION_STALL_ERROR;
+      }
+
+      DiskCommand (Data, Latency);
+      return TRB_COMPLETION_SUCCESS;
+
+    case BotDataIn:
+    case BotDataOut:
+      if (EpAddress != ((mDisk.Phase == BotDataIn) ? DISK_BULK_IN : DISK_BULK_OUT)) {
+        return MODEL_NAK;
+      }
+
+      if (mModel.BusStart > mModel.BusFree) {
+        mDisk.StageWaits++;
+      }
+
+      Moved = MIN (*Length, mDisk.DataLength);
+      if (mDisk.Phase == BotDataIn) {
+        if (mDisk.Read) {
+          DiskFill (Data, mDisk.ReadLba * DISK_BLOCK_SIZE, Moved);
+        } else {
+          Moved = MIN (Moved, mDisk.ResponseLength);
+          memcpy (Data, mDisk.Response, Moved);
+        }
+      }
+
+      mDisk.Residue = mDisk.DataLength - (UINT32)Moved;
+      mDisk.Phase   = BotStatus;
+      *Length       = Moved;
+      return TRB_COMPLETION_SUCCESS;
+
+    case BotStatus:
+      if (EpAddress != DISK_BULK_IN) {
+        return MODEL_NAK;
+      }
+
+      if (mModel.BusStart > mModel.BusFree) {
+        mDisk.StageWaits++;
+      }
+
+      if (*Length < sizeof (XHCI_BOT_CSW)) {
+        ModelViolation ("CSW buffer too short");
+        return TRB_COMPLETION_STALL_ERROR;
+      }
+
+      Csw            = Data;
+      Csw->Signature = XHCI_BOT_CSW_SIGNATURE;
+      Csw->Tag       = mDisk.Tag;
+      Csw->Residue   = mDisk.Residue;
+      Csw->Status    = mDisk.Status;
+      *Length        = sizeof (XHCI_BOT_CSW);
+      mDisk.Phase    = BotCommand;
+      return TRB_COMPLETION_SUCCESS;
+  }
+
+  return TRB_COMPLETION_STALL_ERROR;
+}
+
+STATIC MODEL_DEVICE  mDiskDevice = { DISK_PORT, DiskControl, DiskBulk };
+
+//
+// Scenarios
+//
+
+/**
+  Read BENCHMARK_SIZE bytes from the start of the disk in Chunk sized
+  Block I/O reads, spending Work microseconds after each as a boot loader
+  parsing the data would, and report the throughput.
+
+  @param  BlockIo       Block I/O of the disk.
+  @param  Title         Scenario title.
+  @param  Chunk         Bytes per read.
+  @param  Work          Microseconds of caller work per read.
+  @param  Elapsed       Model time of the whole read.
+  @param  Busy          Bus time used by the read.
+
+  @return READ commands the disk saw.
+**/
+STATIC
+UINT64
+ReadSequential (
+  IN  EFI_BLOCK_IO_PROTOCOL  *BlockIo,
+  IN  CONST char             *Title,
+  IN  UINTN                  Chunk,
+  IN  UINT64                 Work,
+  OUT UINT64                 *Elapsed,
+  OUT UINT64                 *Busy
+  )
+{
+  UINT8       *Buffer;
+  UINT64      Offset;
+  UINT64      Start;
+  UINT64      BusTime;
+  UINT64      Reads;
+  EFI_STATUS  Status;
+  BOOLEAN     Match;
+
+  CHECK (!EFI_ERROR (BlockIo->Reset (BlockIo, FALSE)), "Block I/O reset");
+
+  Buffer  = malloc (Chunk);
+  Match   = TRUE;
+  Status  = EFI_SUCCESS;
+  Start   = mModel.Time;
+  BusTime = mModel.BusTime;
+  Reads   = mDisk.Reads;
+
+  for (Offset = 0; Offset < BENCHMARK_SIZE; Offset += Chunk) {
+    Status = BlockIo->ReadBlocks (BlockIo, BlockIo->Media->MediaId, Offset / DISK_BLOCK_SIZE, Chunk, Buffer);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Match = Match && DiskCheck (Buffer, Offset, Chunk);
+    gBS->Stall (Work);
+  }
+
+  *Elapsed = mModel.Time - Start;
+  *Busy    = mModel.BusTime - BusTime;
+  Reads    = mDisk.Reads - Reads;
+  free (Buffer);
+
+  CHECK (!EFI_ERROR (Status), "every read succeeds");
+  CHECK (Match, "data matches the disk");
+  CHECK (*Elapsed > 0, "model time advances");
+
+  printf (
+    "  %-24s %4llu MB/s, %llu READ commands, bus busy %llu%%\n",
+    Title,
+    (unsigned long long)(BENCHMARK_SIZE / MAX (*Elapsed, 1)),
+    (unsigned long long)Reads,
+    (unsigned long long)(*Busy * 100 / MAX (*Elapsed, 1))
+    );
+
+  return Reads;
+}
+
+/**
+  64 KB reads, the way a boot loader reads a large file, with nothing
+  else to do: the device should stream read-ahead windows with only the
+  polling delay between commands.
+**/
+STATIC
+VOID
+TestStream (
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo
+  )
+{
+  UINT64  Reads;
+  UINT64  Elapsed;
+  UINT64  Busy;
+  UINT64  Waits;
+
+  printf ("Sequential 64 KB reads\n");
+
+  Waits = mDisk.StageWaits;
+  Reads = ReadSequential (BlockIo, "64 KB reads", SIZE_64KB, 0, &Elapsed, &Busy);
+
+  CHECK (Reads <= BENCHMARK_SIZE / XHCI_STORAGE_READ_AHEAD + 2, "one READ per read-ahead window");
+  CHECK (mDisk.StageWaits == Waits, "data and status stages queued with their CBW");
+  CHECK (Elapsed <= Busy + Reads * 2 * XHCI_POLL_INTERVAL, "bus only idles while a completion is polled for");
+}
+
+/**
+  64 KB reads with caller work after each: the device fills the next
+  window while the caller works, so most of the work is hidden.
+**/
+STATIC
+VOID
+TestOverlap (
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo
+  )
+{
+  UINT64  Elapsed;
+  UINT64  Busy;
+  UINT64  Work;
+
+  printf ("Sequential 64 KB reads with 150 us of work each\n");
+
+  ReadSequential (BlockIo, "64 KB reads + work", SIZE_64KB, 150, &Elapsed, &Busy);
+
+  Work = (BENCHMARK_SIZE / SIZE_64KB) * 150;
+  CHECK (Elapsed < Busy + Work / 4, "read-ahead overlaps three quarters of the caller's work");
+}
+
+/**
+  4 MB reads: past the cached window the data goes straight into the
+  caller's buffer, as one READ command per call.
+**/
+STATIC
+VOID
+TestDirect (
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo
+  )
+{
+  UINT64  Reads;
+  UINT64  Elapsed;
+  UINT64  Busy;
+
+  printf ("Sequential 4 MB reads\n");
+
+  Reads = ReadSequential (BlockIo, "4 MB reads", SIZE_4MB, 0, &Elapsed, &Busy);
+
+  CHECK (Reads <= 2 * (BENCHMARK_SIZE / SIZE_4MB) + 1, "a window and one direct READ per call");
+  CHECK (mDisk.LargestRead == SIZE_4MB, "a whole 4 MB read in one command");
+}
+
+int
+main (
+  VOID
+  )
+{
+  XHCI_PRIVATE_DATA      *Private;
+  XHCI_STORAGE           *Storage;
+  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
+  EFI_STATUS             Status;
+
+  Private = calloc (1, sizeof (*Private));
+  ModelStart (Private);
+  mModel.Device       = &mDiskDevice;
+  mDisk.UnitAttention = TRUE;
+
+  printf ("Bus %d MB/s, read latency %d us, poll interval %d us\n",
+          MODEL_BUS_BYTES_PER_US, DISK_READ_LATENCY, XHCI_POLL_INTERVAL);
+
+  //
+  // Enumerate the disk as the root port handling does after a connect
+  //
+  Status = XhciInitializeDeviceSlot (Private, DISK_PORT, XHCI_SPEED_SUPER);
+  CHECK (!EFI_ERROR (Status), "device slot initialized");
+  Private->ProbedPorts |= 1U << DISK_PORT;
+  Status = XhciProbeBootStorage (Private, DISK_PORT);
+  CHECK (!EFI_ERROR (Status), "mass storage probed");
+  CHECK (mDisk.Configuration == 1, "configuration set");
+
+  if (!EFI_ERROR (Status)) {
+    Storage = XHCI_STORAGE_FROM_LINK (GetFirstNode (&Private->StorageList));
+    BlockIo = &Storage->BlockIo;
+    CHECK (BlockIo->Media->LastBlock == DISK_BLOCKS - 1, "capacity read");
+    CHECK (BlockIo->Media->BlockSize == DISK_BLOCK_SIZE, "block size read");
+
+    TestStream (BlockIo);
+    TestOverlap (BlockIo);
+    TestDirect (BlockIo);
+
+    //
+    // Unplug with the last read-ahead still in flight
+    //
+    XhciDisableDeviceSlot (Private, Storage->Device->SlotId);
+    Status = XhciProbeBootStorage (Private, DISK_PORT);
+    CHECK (Status == EFI_NOT_FOUND, "no device left on the port");
+    CHECK (IsListEmpty (&Private->StorageList), "Block I/O removed");
+  }
+
+  ModelStop (Private);
+  CHECK (mModel.Allocations == mModel.Frees, "every page allocation freed");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+  free (Private);
+
+  return HostTestResult ();
+}
@@ -6,111 +6,86 @@
 
 **/
 
-#include <Uefi.h>
-#include <Library/DebugLib.h>
-#include <Library/IoLib.h>
-#include <Library/UefiBootServicesTableLib.h>
-#include <Library/BaseMemoryLib.h>
-#include <Library/TimerLib.h>
-#include <Library/MemoryAllocationLib.h>
-#include <Protocol/Usb2HostController.h>
-
-//
-// RP1 XHCI registers
-//
-#define RP1_XHCI_BASE              0x1f00200000ULL
-
-// Capability registers
-#define XHCI_CAPLENGTH            0x00
-#define XHCI_HCIVERSION          0x02
-#define XHCI_HCSPARAMS1          0x04
-#define XHCI_HCSPARAMS2          0x08
-#define XHCI_HCSPARAMS3          0x0C
-#define XHCI_HCCPARAMS           0x10
-#define XHCI_DBOFF               0x14
-#define XHCI_RTSOFF              0x18
-
-// Operational registers
-#define XHCI_USBCMD              0x00
-#define XHCI_USBSTS             0x04
-#define XHCI_PAGESIZE           0x08
-#define XHCI_DNCTRL             0x14
-#define XHCI_CRCR               0x18
-#define XHCI_DCBAAP             0x30
-#define XHCI_CONFIG             0x38
-#define XHCI_PORTSC             0x400
-
-// Command register bits
-#define XHCI_CMD_RUN            BIT0
-#define XHCI_CMD_HCRST         BIT1
-#define XHCI_CMD_INTE          BIT2
-#define XHCI_CMD_HSEE          BIT3
-#define XHCI_CMD_LWCR          BIT7
-
-// Status register bits
-#define XHCI_STS_HCH           BIT0
-#define XHCI_STS_HSE           BIT2
-#define XHCI_STS_EINT          BIT3
-#define XHCI_STS_PCD           BIT4
-#define XHCI_STS_SSS           BIT8
-#define XHCI_STS_RSS           BIT9
-#define XHCI_STS_SRE           BIT10
-#define XHCI_STS_CNR           BIT11
-#define XHCI_STS_HCE           BIT12
-
-// Port status register bits
-#define XHCI_PORT_CCS          BIT0
-#define XHCI_PORT_PED          BIT1
-#define XHCI_PORT_OCA          BIT3
-#define XHCI_PORT_PR           BIT4
-#define XHCI_PORT_PP           BIT9
-#define XHCI_PORT_CSC          BIT17
-#define XHCI_PORT_PEC          BIT18
-#define XHCI_PORT_PRC          BIT21
-
-// Max slots and ports
-#define XHCI_GET_MAX_SLOTS(x)  ((x) & 0xFF)
-#define XHCI_GET_MAX_PORTS(x)  (((x) >> 24) & 0xFF)
-
-//
-// XHCI data structures
-//
-#pragma pack(1)
-typedef struct {
-  UINT64                  Address;
-  UINT32                  Reserved0;
-  UINT32                  Reserved1;
-} XHCI_TRB;
-
-typedef struct {
-  UINT64                  DeviceContextBaseAddressArray;
-  UINT32                  Reserved0;
-  UINT32                  Reserved1;
-} XHCI_DCBAAP_STRUCT;
-
-typedef struct {
-  XHCI_TRB                *RingSegment;
-  UINT32                  DequeuePointer;
-  UINT32                  CycleState;
-} XHCI_COMMAND_RING;
-#pragma pack()
-
-//
-// Private context for XHCI controller
-//
-typedef struct {
-  UINT32                  Signature;
-  EFI_USB2_HC_PROTOCOL    Usb2HcProtocol;
-  UINT64                  XhciBase;
-  UINT32                  MaxSlots;
-  UINT32                  MaxPorts;
-  UINT32                  PageSize;
-  UINT32                  CapLength;
-  VOID                    *Dcbaa;
-  XHCI_COMMAND_RING       CommandRing;
-} XHCI_PRIVATE_DATA;
-
-#define XHCI_PRIVATE_SIGNATURE  SIGNATURE_32('X', 'H', 'C', 'I')
+#include "Rp1XhciDxe.h"
+
+STATIC XHCI_DEVICE_PATH  mXhciDevicePath = {
+  {
+    {
+      HARDWARE_DEVICE_PATH,
+      HW_VENDOR_DP,
+      { (UINT8)sizeof (VENDOR_DEVICE_PATH), (UINT8)(sizeof (VENDOR_DEVICE_PATH) >> 8) }
+    },
+    RP1_XHCI_DEVICE_PATH_GUID
+  },
+  {
+    END_DEVICE_PATH_TYPE,
+    END_ENTIRE_DEVICE_PATH_SUBTYPE,
+    { (UINT8)sizeof (EFI_DEVICE_PATH_PROTOCOL), 0 }
+  }
+};
+
+/**
+  Halt the controller, perform a host controller reset and wait until the
+  controller is ready to accept register writes again.
+
+  @param  Private       XHCI private data.
+
+  @retval EFI_SUCCESS   Controller reset successfully.
+  @retval EFI_TIMEOUT   Controller did not halt or leave reset in time.
+**/
+STATIC
+EFI_STATUS
+XhciResetController (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Resetting controller\n"));
+
+  if ((XhciReadOpReg (Private, XHCI_USBSTS) & XHCI_STS_HCH) == 0) {
+    XhciWriteOpReg (Private, XHCI_USBCMD, XhciReadOpReg (Private, XHCI_USBCMD) & ~XHCI_CMD_RUN);
+    Status = XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, XHCI_STS_HCH, XHCI_RESET_TIMEOUT);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[XHCI] Halt timeout!\n"));
+      return Status;
+    }
+  }
+
+  XhciWriteOpReg (Private, XHCI_USBCMD, XHCI_CMD_HCRST);
+
+  Status = XhciWaitOpReg (Private, XHCI_USBCMD, XHCI_CMD_HCRST, 0, XHCI_RESET_TIMEOUT);
+  if (!EFI_ERROR (Status)) {
+    Status = XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_CNR, 0, XHCI_RESET_TIMEOUT);
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Reset timeout!\n"));
+    return Status;
+  }
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Reset complete\n"));
+  return EFI_SUCCESS;
+}
+
+/**
+  Hand the rings to a freshly reset controller and set it running.
+
+  @param  Private       XHCI private data.
+
+  @retval EFI_SUCCESS   Controller running.
+  @retval EFI_TIMEOUT   Controller did not leave the halted state.
+**/
+STATIC
+EFI_STATUS
+XhciStartController (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XhciProgramRings (Private);
+  XhciWriteOpReg (Private, XHCI_USBCMD, XhciReadOpReg (Private, XHCI_USBCMD) | XHCI_CMD_RUN);
+
+  return XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, 0, XHCI_RESET_TIMEOUT);
+}
 
 /**
   Reset the XHCI host controller.
@@ -128,28 +103,60 @@ XhciReset (
   )
 {
   XHCI_PRIVATE_DATA *Private;
-  UINT32            Status;
-  UINT32            Timeout;
+  EFI_STATUS        Status;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
-  
-  DEBUG ((DEBUG_INFO, "[XHCI] Resetting controller\n"));
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
-  MmioWrite32 (Private->XhciBase + XHCI_USBCMD, XHCI_CMD_HCRST);
+  //
+  // A reset forgets every device slot; drop the software state with them.
+  //
+  XhciFreeDevices (Private);
+  ZeroMem (Private->PortChange, sizeof (Private->PortChange));
+  Private->ResettingPorts = 0;
+  Private->ReadyPorts     = 0;
+  Private->ProbedPorts    = 0;
+  Private->ChangedPorts   = 0;
+
+  Status = XhciResetController (Private);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-  Timeout = 10000;
-  do {
-    gBS->Stall (100);
-    Status = MmioRead32 (Private->XhciBase + XHCI_USBSTS);
-    Timeout--;
-  } while ((!(Status & XHCI_STS_HCH)) && (Timeout > 0));
+  return XhciStartController (Private);
+}
 
-  if (Timeout == 0) {
-    DEBUG ((DEBUG_ERROR, "[XHCI] Reset timeout!\n"));
-    return EFI_TIMEOUT;
+/**
+  Retrieve the capabilities of the USB host controller.
+
+  @param  This          USB2 HC protocol instance.
+  @param  MaxSpeed      Maximum speed supported by the controller.
+  @param  PortNumber    Number of root hub ports.
+  @param  Is64BitCapable  TRUE if the controller supports 64-bit DMA.
+
+  @retval EFI_SUCCESS           Capabilities returned.
+  @retval EFI_INVALID_PARAMETER An output pointer is NULL.
+**/
+EFI_STATUS
+EFIAPI
+XhciGetCapability (
+  IN  EFI_USB2_HC_PROTOCOL   *This,
+  OUT UINT8                 *MaxSpeed,
+  OUT UINT8                 *PortNumber,
+  OUT UINT8                 *Is64BitCapable
+  )
+{
+  XHCI_PRIVATE_DATA *Private;
+
+  if ((MaxSpeed == NULL) || (PortNumber == NULL) || (Is64BitCapable == NULL)) {
+    return EFI_INVALID_PARAMETER;
   }
 
-  DEBUG ((DEBUG_INFO, "[XHCI] Reset complete\n"));
+  Private = XHCI_PRIVATE_FROM_THIS (This);
+
+  *MaxSpeed       = EFI_USB_SPEED_SUPER;
+  *PortNumber     = (UINT8)Private->MaxPorts;
+  *Is64BitCapable = (UINT8)((Private->HccParams & XHCI_HCC_AC64) != 0);
+
   return EFI_SUCCESS;
 }
 
@@ -169,15 +176,13 @@ XhciGetState (
   )
 {
   XHCI_PRIVATE_DATA *Private;
-  UINT32            UsbCmd;
   UINT32            UsbSts;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
-  UsbCmd = MmioRead32 (Private->XhciBase + XHCI_USBCMD);
-  UsbSts = MmioRead32 (Private->XhciBase + XHCI_USBSTS);
+  UsbSts = XhciReadOpReg (Private, XHCI_USBSTS);
 
-  if (UsbCmd & XHCI_CMD_RUN) {
+  if (!(UsbSts & XHCI_STS_HCH)) {
     *State = EfiUsbHcStateOperational;
   } else {
     *State = EfiUsbHcStateHalt;
@@ -203,20 +208,18 @@ XhciSetState (
 {
   XHCI_PRIVATE_DATA *Private;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
   switch (State) {
   case EfiUsbHcStateHalt:
-    MmioAnd32 (Private->XhciBase + XHCI_USBCMD, ~XHCI_CMD_RUN);
-    break;
+    XhciWriteOpReg (Private, XHCI_USBCMD, XhciReadOpReg (Private, XHCI_USBCMD) & ~XHCI_CMD_RUN);
+    return XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, XHCI_STS_HCH, XHCI_RESET_TIMEOUT);
   case EfiUsbHcStateOperational:
-    MmioOr32 (Private->XhciBase + XHCI_USBCMD, XHCI_CMD_RUN);
-    break;
+    XhciWriteOpReg (Private, XHCI_USBCMD, XhciReadOpReg (Private, XHCI_USBCMD) | XHCI_CMD_RUN);
+    return XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, 0, XHCI_RESET_TIMEOUT);
   default:
     return EFI_UNSUPPORTED;
   }
-
-  return EFI_SUCCESS;
 }
 
 /**
@@ -237,17 +240,20 @@ XhciGetRootHubPortStatus (
   )
 {
   XHCI_PRIVATE_DATA *Private;
-  UINT32            PortOffset;
   UINT32            PortSc;
+  EFI_TPL           OldTpl;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
   if (PortNumber >= Private->MaxPorts) {
     return EFI_INVALID_PARAMETER;
   }
 
-  PortOffset = XHCI_PORTSC + (PortNumber * 0x10);
-  PortSc = MmioRead32 (Private->XhciBase + PortOffset);
+  //
+  // Change bits live in the port manager once their event has been seen.
+  //
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+  PortSc = XhciUpdatePort (Private, PortNumber) | Private->PortChange[PortNumber];
 
   ZeroMem (PortStatus, sizeof (EFI_USB_PORT_STATUS));
 
@@ -257,9 +263,30 @@ XhciGetRootHubPortStatus (
   if (PortSc & XHCI_PORT_PED) {
     PortStatus->PortStatus |= USB_PORT_STAT_ENABLE;
   }
+  if (PortSc & XHCI_PORT_OCA) {
+    PortStatus->PortStatus |= USB_PORT_STAT_OVERCURRENT;
+  }
+  if (PortSc & XHCI_PORT_PR) {
+    PortStatus->PortStatus |= USB_PORT_STAT_RESET;
+  }
   if (PortSc & XHCI_PORT_PP) {
     PortStatus->PortStatus |= USB_PORT_STAT_POWER;
   }
+
+  switch (XHCI_PORT_SPEED (PortSc)) {
+  case XHCI_SPEED_LOW:
+    PortStatus->PortStatus |= USB_PORT_STAT_LOW_SPEED;
+    break;
+  case XHCI_SPEED_HIGH:
+    PortStatus->PortStatus |= USB_PORT_STAT_HIGH_SPEED;
+    break;
+  case XHCI_SPEED_SUPER:
+    PortStatus->PortStatus |= USB_PORT_STAT_SUPER_SPEED;
+    break;
+  default:
+    break;
+  }
+
   if (PortSc & XHCI_PORT_CSC) {
     PortStatus->PortChangeStatus |= USB_PORT_STAT_C_CONNECTION;
   }
@@ -270,6 +297,14 @@ XhciGetRootHubPortStatus (
     PortStatus->PortChangeStatus |= USB_PORT_STAT_C_RESET;
   }
 
+  //
+  // The bus driver polls this after every port reset; it is where device
+  // slots are created for newly enabled ports and released for removed
+  // ones.
+  //
+  XhciPollPortStatusChange (Private, PortNumber, PortSc);
+  gBS->RestoreTPL (OldTpl);
+
   return EFI_SUCCESS;
 }
 
@@ -291,25 +326,37 @@ XhciSetRootHubPortFeature (
   )
 {
   XHCI_PRIVATE_DATA *Private;
+  XHCI_DEVICE       *Device;
   UINT32            PortOffset;
+  UINT32            PortSc;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
   if (PortNumber >= Private->MaxPorts) {
     return EFI_INVALID_PARAMETER;
   }
 
   PortOffset = XHCI_PORTSC + (PortNumber * 0x10);
+  PortSc     = XhciReadOpReg (Private, PortOffset) & ~XHCI_PORT_WRITE_MASK;
 
   switch (Feature) {
   case EfiUsbPortPower:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PP);
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PP);
     break;
   case EfiUsbPortReset:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PR);
+    //
+    // The device behind a reset port is enumerated again from scratch.
+    //
+    Device = XhciDeviceFromPort (Private, PortNumber);
+    if (Device != NULL) {
+      XhciDisableDeviceSlot (Private, Device->SlotId);
+    }
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PR);
     break;
   case EfiUsbPortEnable:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PED);
+    //
+    // Ports are enabled by the controller at the end of a reset.
+    //
     break;
   default:
     return EFI_UNSUPPORTED;
@@ -337,40 +384,54 @@ XhciClearRootHubPortFeature (
 {
   XHCI_PRIVATE_DATA *Private;
   UINT32            PortOffset;
+  UINT32            PortSc;
+  EFI_TPL           OldTpl;
+  EFI_STATUS        Status;
 
-  Private = CR (This, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE);
+  Private = XHCI_PRIVATE_FROM_THIS (This);
 
   if (PortNumber >= Private->MaxPorts) {
     return EFI_INVALID_PARAMETER;
   }
 
+  OldTpl     = gBS->RaiseTPL (XHCI_TPL);
   PortOffset = XHCI_PORTSC + (PortNumber * 0x10);
+  PortSc     = XhciReadOpReg (Private, PortOffset) & ~XHCI_PORT_WRITE_MASK;
+  Status     = EFI_SUCCESS;
 
   switch (Feature) {
   case EfiUsbPortPower:
-    MmioAnd32 (Private->XhciBase + PortOffset, ~XHCI_PORT_PP);
+    XhciWriteOpReg (Private, PortOffset, PortSc & ~XHCI_PORT_PP);
     break;
   case EfiUsbPortReset:
-    MmioAnd32 (Private->XhciBase + PortOffset, ~XHCI_PORT_PR);
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PRC);
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PRC);
+    Private->PortChange[PortNumber] &= ~XHCI_PORT_PRC;
     break;
   case EfiUsbPortEnable:
-    MmioAnd32 (Private->XhciBase + PortOffset, ~XHCI_PORT_PED);
+    //
+    // PED is write-1-to-clear.
+    //
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PED);
     break;
   case EfiUsbPortConnectChange:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_CSC);
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_CSC);
+    Private->PortChange[PortNumber] &= ~XHCI_PORT_CSC;
     break;
   case EfiUsbPortEnableChange:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PEC);
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PEC);
+    Private->PortChange[PortNumber] &= ~XHCI_PORT_PEC;
     break;
   case EfiUsbPortResetChange:
-    MmioOr32 (Private->XhciBase + PortOffset, XHCI_PORT_PRC);
+    XhciWriteOpReg (Private, PortOffset, PortSc | XHCI_PORT_PRC);
+    Private->PortChange[PortNumber] &= ~XHCI_PORT_PRC;
     break;
   default:
-    return EFI_UNSUPPORTED;
+    Status = EFI_UNSUPPORTED;
+    break;
   }
 
-  return EFI_SUCCESS;
+  gBS->RestoreTPL (OldTpl);
+  return Status;
 }
 
 /**
@@ -386,52 +447,124 @@ XhciInitController (
   IN XHCI_PRIVATE_DATA  *Private
   )
 {
-  UINT32  HcParams1;
-  UINT32  HcParams2;
-  UINT32  HccParams;
-  UINT32  Pages;
-  UINT32  DcbaaSize;
-  UINT64  *Dcbaa;
+  EFI_STATUS  Status;
+  UINT32      HcParams1;
+  UINT32      HcParams2;
+  UINT32      Cap[(XHCI_RTSOFF / 4) + 1];
+  UINT32      Pages;
+  XHCI_TRB    Trb;
 
   DEBUG ((DEBUG_INFO, "[XHCI] Initializing controller\n"));
 
-  Private->CapLength = MmioRead8 (Private->XhciBase + XHCI_CAPLENGTH);
-  HcParams1 = MmioRead32 (Private->XhciBase + XHCI_HCSPARAMS1);
-  HcParams2 = MmioRead32 (Private->XhciBase + XHCI_HCSPARAMS2);
-  HccParams = MmioRead32 (Private->XhciBase + XHCI_HCCPARAMS);
+  //
+  // The capability registers are read-only; take them in one pass.
+  //
+  PlatformMmioReadBlock32 ((UINTN)Private->XhciBase, ARRAY_SIZE (Cap), Cap);
+  Private->CapLength = (UINT8)Cap[XHCI_CAPLENGTH / 4];
+  HcParams1 = Cap[XHCI_HCSPARAMS1 / 4];
+  HcParams2 = Cap[XHCI_HCSPARAMS2 / 4];
+  Private->HccParams = Cap[XHCI_HCCPARAMS / 4];
+
+  Private->OpBase = (UINTN)Private->XhciBase + Private->CapLength;
+  Private->RtBase = (UINTN)Private->XhciBase + (Cap[XHCI_RTSOFF / 4] & ~0x1F);
+  Private->DbBase = (UINTN)Private->XhciBase + (Cap[XHCI_DBOFF / 4] & ~0x3);
 
   Private->MaxSlots = XHCI_GET_MAX_SLOTS (HcParams1);
-  Private->MaxPorts = XHCI_GET_MAX_PORTS (HcParams1);
+  Private->MaxPorts = MIN (XHCI_GET_MAX_PORTS (HcParams1), XHCI_MAX_ROOT_PORTS);
+  Private->MaxScratchpads = XHCI_GET_MAX_SCRATCHPADS (HcParams2);
   
   DEBUG ((DEBUG_INFO, "[XHCI] Max slots: %d, Max ports: %d\n", 
           Private->MaxSlots, Private->MaxPorts));
 
-  Pages = MmioRead32 (Private->XhciBase + XHCI_PAGESIZE);
-  Private->PageSize = 1 << (Pages + 12);
+  Pages = XhciReadOpReg (Private, XHCI_PAGESIZE) & 0xFFFF;
+  Private->PageSize = 1 << (LowBitSet32 (Pages) + 12);
   DEBUG ((DEBUG_INFO, "[XHCI] Page size: 0x%x\n", Private->PageSize));
 
-  DcbaaSize = Private->MaxSlots * sizeof (UINT64);
-  Dcbaa = AllocatePages (EFI_SIZE_TO_PAGES (DcbaaSize));
-  if (Dcbaa == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  Private->ContextSize = (Private->HccParams & XHCI_HCC_CSZ) ? 64 : 32;
+  InitializeListHead (&Private->UrbList);
+  InitializeListHead (&Private->StorageList);
+
+  Status = XhciAllocateRings (Private);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
-  ZeroMem (Dcbaa, DcbaaSize);
-  Private->Dcbaa = Dcbaa;
 
-  MmioWrite32 (Private->XhciBase + XHCI_DCBAAP, (UINT32)(UINTN)Dcbaa);
-  if (HccParams & BIT0) {
-    MmioWrite32 (Private->XhciBase + XHCI_DCBAAP + 4, (UINT32)((UINTN)Dcbaa >> 32));
+  Status = XhciResetController (Private);
+  if (!EFI_ERROR (Status)) {
+    Status = XhciStartController (Private);
+  }
+  if (EFI_ERROR (Status)) {
+    XhciFreeRings (Private);
+    return Status;
   }
 
-  MmioWrite32 (Private->XhciBase + XHCI_CONFIG, Private->MaxSlots);
+  //
+  // A no-op command proves the command ring, doorbell and event ring
+  // round trip before anything depends on them.
+  //
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Control = TRB_TYPE (TRB_TYPE_NO_OP_COMMAND);
+  Status = XhciCmdExecute (Private, &Trb, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Command ring not responding: %r\n", Status));
+    XhciResetController (Private);
+    XhciFreeRings (Private);
+    return Status;
+  }
 
-  XhciReset (&Private->Usb2HcProtocol, 0);
-  MmioOr32 (Private->XhciBase + XHCI_USBCMD, XHCI_CMD_RUN);
+  //
+  // One periodic timer services every asynchronous interrupt transfer.
+  //
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  XHCI_TPL,
+                  XhciMonitorAsyncRequests,
+                  Private,
+                  &Private->AsyncTimer
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (Private->AsyncTimer, TimerPeriodic, XHCI_ASYNC_TIMER_INTERVAL);
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (Private->AsyncTimer);
+    }
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Async timer setup failed: %r\n", Status));
+    XhciResetController (Private);
+    XhciFreeRings (Private);
+    return Status;
+  }
 
   DEBUG ((DEBUG_INFO, "[XHCI] Controller initialized\n"));
   return EFI_SUCCESS;
 }
 
+/**
+  Halt the controller so that read-ahead and asynchronous interrupt
+  transfers stop writing into memory the OS now owns.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       XHCI private data.
+**/
+STATIC
+VOID
+EFIAPI
+XhciExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  gBS->SetTimer (Private->AsyncTimer, TimerCancel, 0);
+
+  XhciWriteOpReg (Private, XHCI_USBCMD, XhciReadOpReg (Private, XHCI_USBCMD) & ~XHCI_CMD_RUN);
+  if (EFI_ERROR (XhciWaitOpReg (Private, XHCI_USBSTS, XHCI_STS_HCH, XHCI_STS_HCH, XHCI_RESET_TIMEOUT))) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Halt timeout at ExitBootServices\n"));
+  }
+}
+
 /**
   Entry point of RP1 XHCI Driver.
 
@@ -460,18 +593,34 @@ Rp1XhciDriverEntryPoint (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  Status = gBS->LocateProtocol (&gRp1ProtocolGuid, NULL, (VOID **)&Private->Rp1);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] RP1 protocol not found: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
+  Status = Private->Rp1->EnableClock (Private->Rp1, Rp1BlockXhci);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Clock enable failed: %r\n", Status));
+    FreePool (Private);
+    return Status;
+  }
+
   Private->Signature = XHCI_PRIVATE_SIGNATURE;
-  Private->XhciBase = RP1_XHCI_BASE;
+  Private->XhciBase = Private->Rp1->BlockBase[Rp1BlockXhci];
+  Private->DevicePath = (EFI_DEVICE_PATH_PROTOCOL *)&mXhciDevicePath;
   DEBUG ((DEBUG_INFO, "[XHCI] Controller base: 0x%016lx\n", Private->XhciBase));
 
   Private->Usb2HcProtocol.Reset               = XhciReset;
   Private->Usb2HcProtocol.GetState            = XhciGetState;
   Private->Usb2HcProtocol.SetState            = XhciSetState;
-  Private->Usb2HcProtocol.ControlTransfer     = NULL;
-  Private->Usb2HcProtocol.BulkTransfer        = NULL;
-  Private->Usb2HcProtocol.SyncInterruptTransfer  = NULL;
-  Private->Usb2HcProtocol.IsochronousTransfer = NULL;
-  Private->Usb2HcProtocol.AsyncInterruptTransfer = NULL;
+  Private->Usb2HcProtocol.GetCapability       = XhciGetCapability;
+  Private->Usb2HcProtocol.ControlTransfer     = XhciControlTransfer;
+  Private->Usb2HcProtocol.BulkTransfer        = XhciBulkTransfer;
+  Private->Usb2HcProtocol.SyncInterruptTransfer  = XhciSyncInterruptTransfer;
+  Private->Usb2HcProtocol.IsochronousTransfer = XhciIsochronousTransfer;
+  Private->Usb2HcProtocol.AsyncInterruptTransfer = XhciAsyncInterruptTransfer;
   Private->Usb2HcProtocol.GetRootHubPortStatus = XhciGetRootHubPortStatus;
   Private->Usb2HcProtocol.SetRootHubPortFeature = XhciSetRootHubPortFeature;
   Private->Usb2HcProtocol.ClearRootHubPortFeature = XhciClearRootHubPortFeature;
@@ -481,22 +630,53 @@ Rp1XhciDriverEntryPoint (
   Status = XhciInitController (Private);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "[XHCI] Controller init failed: %r\n", Status));
+    Private->Rp1->DisableClock (Private->Rp1, Rp1BlockXhci);
     FreePool (Private);
     return Status;
   }
 
-  Handle = NULL;
-  Status = gBS->InstallMultipleProtocolInterfaces (
-                  &Handle,
-                  &gEfiUsb2HcProtocolGuid, &Private->Usb2HcProtocol,
-                  NULL
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  XhciExitBootServices,
+                  Private,
+                  &Private->ExitBootServicesEvent
                   );
+  if (!EFI_ERROR (Status)) {
+    Handle = NULL;
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Handle,
+                    &gEfiUsb2HcProtocolGuid, &Private->Usb2HcProtocol,
+                    &gEfiDevicePathProtocolGuid, Private->DevicePath,
+                    NULL
+                    );
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (Private->ExitBootServicesEvent);
+    }
+  }
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "[XHCI] Protocol install failed: %r\n", Status));
+    gBS->CloseEvent (Private->AsyncTimer);
+    XhciResetController (Private);
+    XhciFreeRings (Private);
+    Private->Rp1->DisableClock (Private->Rp1, Rp1BlockXhci);
     FreePool (Private);
     return Status;
   }
 
+  Private->Handle = Handle;
+
+  //
+  // No USB bus driver is part of this platform; boot disks on the root
+  // ports are brought up here, and again whenever a port changes.
+  //
+  Status = XhciInitPorts (Private);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[XHCI] Hot-plug disabled: %r\n", Status));
+    Private->HotPlugEvent = NULL;
+  }
+  XhciEnumerateRootPorts (Private);
+
   DEBUG ((DEBUG_INFO, "[XHCI] Driver loaded successfully\n"));
   DEBUG ((DEBUG_INFO, "[XHCI] ========================================\n\n"));
 
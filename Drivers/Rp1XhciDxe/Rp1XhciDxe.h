@@ -0,0 +1,1040 @@
+/** @file
+  RP1 XHCI USB 3.0 Controller Driver for Raspberry Pi 5 D-step
+
+  Register layout, TRB formats and private context shared by the
+  controller, register access and ring engine modules.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RP1_XHCI_DXE_H_
+#define RP1_XHCI_DXE_H_
+
+#include <Uefi.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/TimerLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/UefiLib.h>
+#include <Library/DevicePathLib.h>
+#include <Protocol/Usb2HostController.h>
+#include <Protocol/BlockIo.h>
+#include <Protocol/DevicePath.h>
+#include <IndustryStandard/Scsi.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+#include "../../Include/Protocol/Rp1.h"
+
+//
+// RP1 masters reach host DRAM through the PCIe inbound window, which
+// places CPU physical address 0 at bus address 0x10_0000_0000.
+//
+#define RP1_DMA_OFFSET             0x1000000000ULL
+#define XHCI_DMA_ADDRESS(Ptr)      ((UINT64)(UINTN)(Ptr) + RP1_DMA_OFFSET)
+#define XHCI_HOST_ADDRESS(Addr)    ((VOID *)(UINTN)((Addr) - RP1_DMA_OFFSET))
+
+// Capability registers
+#define XHCI_CAPLENGTH            0x00
+#define XHCI_HCIVERSION          0x02
+#define XHCI_HCSPARAMS1          0x04
+#define XHCI_HCSPARAMS2          0x08
+#define XHCI_HCSPARAMS3          0x0C
+#define XHCI_HCCPARAMS           0x10
+#define XHCI_DBOFF               0x14
+#define XHCI_RTSOFF              0x18
+
+// Operational registers
+#define XHCI_USBCMD              0x00
+#define XHCI_USBSTS             0x04
+#define XHCI_PAGESIZE           0x08
+#define XHCI_DNCTRL             0x14
+#define XHCI_CRCR               0x18
+#define XHCI_DCBAAP             0x30
+#define XHCI_CONFIG             0x38
+#define XHCI_PORTSC             0x400
+
+// Runtime registers (interrupter 0)
+#define XHCI_IR0                0x20
+#define XHCI_IMAN               0x00
+#define XHCI_IMOD               0x04
+#define XHCI_ERSTSZ             0x08
+#define XHCI_ERSTBA             0x10
+#define XHCI_ERDP               0x18
+
+// Command register bits
+#define XHCI_CMD_RUN            BIT0
+#define XHCI_CMD_HCRST         BIT1
+#define XHCI_CMD_INTE          BIT2
+#define XHCI_CMD_HSEE          BIT3
+#define XHCI_CMD_LWCR          BIT7
+
+// Status register bits
+#define XHCI_STS_HCH           BIT0
+#define XHCI_STS_HSE           BIT2
+#define XHCI_STS_EINT          BIT3
+#define XHCI_STS_PCD           BIT4
+#define XHCI_STS_SSS           BIT8
+#define XHCI_STS_RSS           BIT9
+#define XHCI_STS_SRE           BIT10
+#define XHCI_STS_CNR           BIT11
+#define XHCI_STS_HCE           BIT12
+
+// Command ring control bits
+#define XHCI_CRCR_RCS          BIT0
+#define XHCI_CRCR_CS           BIT1
+#define XHCI_CRCR_CA           BIT2
+#define XHCI_CRCR_CRR          BIT3
+
+// Interrupter bits
+#define XHCI_IMAN_IP           BIT0
+#define XHCI_IMAN_IE           BIT1
+#define XHCI_ERDP_EHB          BIT3
+
+// Port status register bits
+#define XHCI_PORT_CCS          BIT0
+#define XHCI_PORT_PED          BIT1
+#define XHCI_PORT_OCA          BIT3
+#define XHCI_PORT_PR           BIT4
+#define XHCI_PORT_PP           BIT9
+#define XHCI_PORT_SPEED(x)     (((x) >> 10) & 0xF)
+#define XHCI_PORT_CSC          BIT17
+#define XHCI_PORT_PEC          BIT18
+#define XHCI_PORT_WRC          BIT19
+#define XHCI_PORT_OCC          BIT20
+#define XHCI_PORT_PRC          BIT21
+#define XHCI_PORT_PLC          BIT22
+#define XHCI_PORT_CEC          BIT23
+
+//
+// Bits that must be written as zero when preserving PORTSC: PED and the
+// change bits are write-1-to-clear.
+//
+#define XHCI_PORT_CHANGE_MASK  (XHCI_PORT_CSC | XHCI_PORT_PEC | XHCI_PORT_WRC | \
+                                XHCI_PORT_OCC | XHCI_PORT_PRC | XHCI_PORT_PLC | \
+                                XHCI_PORT_CEC)
+#define XHCI_PORT_WRITE_MASK   (XHCI_PORT_PED | XHCI_PORT_CHANGE_MASK)
+
+// PORTSC speed field values
+#define XHCI_SPEED_FULL        1
+#define XHCI_SPEED_LOW         2
+#define XHCI_SPEED_HIGH        3
+#define XHCI_SPEED_SUPER       4
+
+// Capability parameter bits
+#define XHCI_HCC_AC64          BIT0
+#define XHCI_HCC_CSZ           BIT2
+
+// Max slots and ports
+#define XHCI_GET_MAX_SLOTS(x)  ((x) & 0xFF)
+#define XHCI_GET_MAX_PORTS(x)  (((x) >> 24) & 0xFF)
+#define XHCI_GET_MAX_SCRATCHPADS(x) \
+  ((((x) >> 27) & 0x1F) | ((((x) >> 21) & 0x1F) << 5))
+
+//
+// TRB control field
+//
+#define TRB_CYCLE              BIT0
+#define TRB_TOGGLE_CYCLE       BIT1   // Link TRB
+#define TRB_ENT                BIT1   // Transfer TRBs
+#define TRB_ISP                BIT2
+#define TRB_CHAIN              BIT4
+#define TRB_IOC                BIT5
+#define TRB_IDT                BIT6
+#define TRB_TYPE(x)            (((UINT32)(x) & 0x3F) << 10)
+#define TRB_GET_TYPE(c)        (((c) >> 10) & 0x3F)
+#define TRB_SLOT_ID(x)         (((UINT32)(x) & 0xFF) << 24)
+#define TRB_GET_SLOT_ID(c)     (((c) >> 24) & 0xFF)
+#define TRB_GET_EP_ID(c)       (((c) >> 16) & 0x1F)
+#define TRB_GET_COMPLETION(s)  (((s) >> 24) & 0xFF)
+#define TRB_GET_LENGTH(s)      ((s) & 0xFFFFFF)
+#define TRB_GET_PORT_ID(p)     (((p) >> 24) & 0xFF)   // Port status change event, 1-based
+#define TRB_EP_ID(x)           (((UINT32)(x) & 0x1F) << 16)
+#define TRB_LENGTH(x)          ((UINT32)(x) & 0x1FFFF)
+#define TRB_TD_SIZE(x)         (((UINT32)MIN ((x), 31)) << 17)
+#define TRB_DIR_IN             BIT16      // Data and status stage
+#define TRB_TRT(x)             (((UINT32)(x) & 0x3) << 16)
+#define TRB_BSR                BIT9       // Address device
+#define TRB_SIA                BIT31      // Isoch: start as soon as possible
+#define TRB_TSP                BIT9       // Reset endpoint: preserve state
+
+#define TRB_TRT_NO_DATA        0
+#define TRB_TRT_OUT_DATA       2
+#define TRB_TRT_IN_DATA        3
+
+//
+// TRB types
+//
+#define TRB_TYPE_NORMAL              1
+#define TRB_TYPE_SETUP_STAGE         2
+#define TRB_TYPE_DATA_STAGE          3
+#define TRB_TYPE_STATUS_STAGE        4
+#define TRB_TYPE_ISOCH               5
+#define TRB_TYPE_LINK                6
+#define TRB_TYPE_EN_SLOT             9
+#define TRB_TYPE_DIS_SLOT            10
+#define TRB_TYPE_ADDRESS_DEV         11
+#define TRB_TYPE_CON_ENDPOINT        12
+#define TRB_TYPE_EVALU_CONTXT        13
+#define TRB_TYPE_RESET_ENDPOINT      14
+#define TRB_TYPE_STOP_ENDPOINT       15
+#define TRB_TYPE_SET_TR_DEQUE        16
+#define TRB_TYPE_NO_OP_COMMAND       23
+#define TRB_TYPE_TRANS_EVENT         32
+#define TRB_TYPE_COMMAND_COMPLT_EVENT 33
+#define TRB_TYPE_PORT_STATUS_CHANGE  34
+#define TRB_TYPE_HOST_CONTROLLER     37
+
+//
+// Completion codes
+//
+#define TRB_COMPLETION_INVALID       0
+#define TRB_COMPLETION_SUCCESS       1
+#define TRB_COMPLETION_DATA_BUFFER_ERROR 2
+#define TRB_COMPLETION_BABBLE_ERROR  3
+#define TRB_COMPLETION_USB_TRANSACTION_ERROR 4
+#define TRB_COMPLETION_TRB_ERROR     5
+#define TRB_COMPLETION_STALL_ERROR   6
+#define TRB_COMPLETION_SHORT_PACKET  13
+#define TRB_COMPLETION_COMMAND_RING_STOPPED 24
+#define TRB_COMPLETION_COMMAND_ABORTED 25
+#define TRB_COMPLETION_STOPPED       26
+#define TRB_COMPLETION_STOPPED_LENGTH_INVALID 27
+
+//
+// Ring geometry. Every segment ends with a link TRB; the event ring has
+// no link TRBs and is described to the controller through the ERST.
+//
+#define XHCI_CACHE_LINE_SIZE         64
+#define XHCI_RING_SEGMENT_TRBS       64
+#define XHCI_CMD_RING_SEGMENTS       2
+#define XHCI_EVENT_RING_SEGMENT_TRBS 128
+#define XHCI_EVENT_RING_SEGMENTS     2
+#define XHCI_MAX_DEVICE_SLOTS        256
+#define XHCI_MAX_ROOT_PORTS          32
+#define XHCI_EVENT_BATCH             32
+#define XHCI_TRANSFER_RING_SEGMENTS  4
+#define XHCI_MAX_DCI                 31
+#define XHCI_MAX_CONFIGS             4
+#define XHCI_TRB_MAX_LENGTH          SIZE_64KB
+#define XHCI_MAX_TD_TRBS             128
+
+//
+// Largest TD a single doorbell is asked to move. One TRB is kept in hand
+// for a buffer that does not start on a 64KB boundary; the result is still
+// a multiple of every USB max packet size.
+//
+#define XHCI_MAX_TD_BYTES            ((XHCI_MAX_TD_TRBS - 1) * XHCI_TRB_MAX_LENGTH)
+
+#define XHCI_CMD_RING_TRBS    (XHCI_RING_SEGMENT_TRBS * XHCI_CMD_RING_SEGMENTS)
+#define XHCI_EVENT_RING_TRBS  (XHCI_EVENT_RING_SEGMENT_TRBS * XHCI_EVENT_RING_SEGMENTS)
+
+//
+// Timeouts, in microseconds
+//
+#define XHCI_POLL_INTERVAL           10
+#define XHCI_RESET_TIMEOUT           1000000
+#define XHCI_COMMAND_TIMEOUT         500000
+
+//
+// Isochronous transfers carry no timeout of their own; milliseconds.
+//
+#define XHCI_ISOCH_TIMEOUT           1000
+
+//
+// Transfers and the async monitor run at this TPL so the periodic timer
+// never drains the event ring underneath a synchronous transfer.
+//
+#define XHCI_TPL                     TPL_NOTIFY
+#define XHCI_ASYNC_TIMER_INTERVAL    EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// Vendor device path node of the controller handle
+//
+#define RP1_XHCI_DEVICE_PATH_GUID \
+  { 0x6f1f3c52, 0x8a53, 0x4c1e, { 0x9d, 0x24, 0x7b, 0x0e, 0x31, 0x5a, 0xc4, 0x82 } }
+
+typedef struct {
+  VENDOR_DEVICE_PATH          Vendor;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} XHCI_DEVICE_PATH;
+
+//
+// XHCI data structures
+//
+#pragma pack(1)
+typedef struct {
+  UINT64                  Parameter;
+  UINT32                  Status;
+  UINT32                  Control;
+} XHCI_TRB;
+
+typedef struct {
+  UINT64                  DeviceContextBaseAddressArray;
+  UINT32                  Reserved0;
+  UINT32                  Reserved1;
+} XHCI_DCBAAP_STRUCT;
+
+typedef struct {
+  UINT64                  SegmentBase;
+  UINT32                  SegmentSize;
+  UINT32                  Reserved;
+} XHCI_ERST_ENTRY;
+#pragma pack()
+
+//
+// Layout of the single DMA block shared with the controller. Each member
+// starts on a boundary at least as large as its own size so that no ring
+// segment crosses a 64KB boundary and no two members share a cache line.
+//
+typedef struct {
+  XHCI_TRB                CommandRing[XHCI_CMD_RING_TRBS];
+  XHCI_TRB                EventRing[XHCI_EVENT_RING_TRBS];
+  UINT64                  Dcbaa[XHCI_MAX_DEVICE_SLOTS];
+  XHCI_ERST_ENTRY         Erst[4];
+} XHCI_DMA_BLOCK;
+
+STATIC_ASSERT (
+  (OFFSET_OF (XHCI_DMA_BLOCK, EventRing) % sizeof (((XHCI_DMA_BLOCK *)0)->CommandRing)) == 0,
+  "Event ring must be naturally aligned"
+  );
+STATIC_ASSERT (
+  (OFFSET_OF (XHCI_DMA_BLOCK, Erst) % XHCI_CACHE_LINE_SIZE) == 0,
+  "ERST must be cache-line aligned"
+  );
+
+//
+// Producer ring (command or transfer). Indices run across all segments,
+// which are laid out back to back in memory.
+//
+typedef struct {
+  XHCI_TRB                *Trbs;
+  UINT32                  NumSegments;
+  UINT32                  SegmentTrbs;
+  UINT32                  Enqueue;
+  UINT32                  Dequeue;
+  UINT32                  Cycle;
+} XHCI_RING;
+
+//
+// Consumer ring written by the controller.
+//
+typedef struct {
+  XHCI_TRB                *Trbs;
+  UINT32                  TotalTrbs;
+  UINT32                  Dequeue;
+  UINT32                  Cycle;
+} XHCI_EVENT_RING;
+
+//
+// Completion record for one command ring slot.
+//
+typedef struct {
+  BOOLEAN                 Done;
+  UINT8                   CompletionCode;
+  UINT8                   SlotId;
+  UINT32                  Parameter;
+} XHCI_CMD_RESULT;
+
+//
+// Endpoint types in the endpoint context
+//
+#define XHCI_EP_ISOCH_OUT      1
+#define XHCI_EP_BULK_OUT       2
+#define XHCI_EP_INT_OUT        3
+#define XHCI_EP_CONTROL        4
+#define XHCI_EP_ISOCH_IN       5
+#define XHCI_EP_BULK_IN        6
+#define XHCI_EP_INT_IN         7
+
+//
+// SuperSpeed endpoint companion descriptor
+//
+#define XHCI_DESC_TYPE_SS_EP_COMPANION  0x30
+
+//
+// Slot and endpoint context fields
+//
+#define XHCI_SLOT_CTX_SPEED(x)        (((UINT32)(x) & 0xF) << 20)
+#define XHCI_SLOT_CTX_ENTRIES(x)      (((UINT32)(x) & 0x1F) << 27)
+#define XHCI_SLOT_CTX_ROOT_PORT(x)    (((UINT32)(x) & 0xFF) << 16)
+#define XHCI_SLOT_CTX_GET_ADDRESS(x)  ((x) & 0xFF)
+#define XHCI_EP_CTX_INTERVAL(x)       (((UINT32)(x) & 0xFF) << 16)
+#define XHCI_EP_CTX_CERR(x)           (((UINT32)(x) & 0x3) << 1)
+#define XHCI_EP_CTX_TYPE(x)           (((UINT32)(x) & 0x7) << 3)
+#define XHCI_EP_CTX_MAX_BURST(x)      (((UINT32)(x) & 0xFF) << 8)
+#define XHCI_EP_CTX_MAX_PACKET(x)     (((UINT32)(x) & 0xFFFF) << 16)
+#define XHCI_EP_CTX_AVG_TRB_LEN(x)    ((UINT32)(x) & 0xFFFF)
+#define XHCI_EP_CTX_MAX_ESIT_LO(x)    (((UINT32)(x) & 0xFFFF) << 16)
+
+//
+// Device context index of an endpoint address; both directions of the
+// default control endpoint map to DCI 1.
+//
+#define XHCI_ENDPOINT_TO_DCI(Addr)                                  \
+  ((UINT8)((((Addr) & 0xF) == 0) ? 1 :                              \
+           ((((Addr) & 0xF) << 1) | (((Addr) & USB_ENDPOINT_DIR_IN) ? 1 : 0))))
+
+//
+// Input control context and the first dwords of the slot and endpoint
+// contexts. Context size is 32 or 64 bytes depending on HCCPARAMS.CSZ;
+// only the leading 32 bytes are ever touched.
+//
+typedef struct {
+  UINT32                  DropFlags;
+  UINT32                  AddFlags;
+  UINT32                  Reserved[6];
+} XHCI_INPUT_CONTROL_CONTEXT;
+
+typedef struct {
+  UINT32                  Dword0;
+  UINT32                  Dword1;
+  UINT32                  Dword2;
+  UINT32                  Dword3;
+  UINT32                  Reserved[4];
+} XHCI_SLOT_CONTEXT;
+
+typedef struct {
+  UINT32                  Dword0;
+  UINT32                  Dword1;
+  UINT64                  Dequeue;
+  UINT32                  Dword4;
+  UINT32                  Reserved[3];
+} XHCI_ENDPOINT_CONTEXT;
+
+//
+// One addressed device and its endpoint rings, indexed by DCI.
+//
+typedef struct {
+  UINT8                   SlotId;
+  UINT8                   BusAddress;
+  UINT8                   RootPort;
+  UINT8                   Speed;
+  UINT16                  MaxPacket0;
+  UINT8                   EpType[XHCI_MAX_DCI + 1];
+  VOID                    *InputContext;
+  VOID                    *OutputContext;
+  XHCI_RING               *Rings[XHCI_MAX_DCI + 1];
+  USB_CONFIG_DESCRIPTOR   *ConfigDesc[XHCI_MAX_CONFIGS];
+} XHCI_DEVICE;
+
+//
+// Context entries are ContextSize bytes apart and indexed by DCI, with the
+// slot context at DCI 0. The input context is preceded by the input control
+// context, so each of its entries sits one further along.
+//
+#define XHCI_INPUT_CTX(Private, Device, Dci) \
+  ((VOID *)((UINT8 *)(Device)->InputContext + ((Dci) + 1) * (Private)->ContextSize))
+#define XHCI_OUTPUT_CTX(Private, Device, Dci) \
+  ((VOID *)((UINT8 *)(Device)->OutputContext + (Dci) * (Private)->ContextSize))
+
+//
+// One transfer descriptor in flight on an endpoint ring.
+//
+typedef struct {
+  UINT32                          Signature;
+  LIST_ENTRY                      Link;
+  XHCI_DEVICE                     *Device;
+  UINT8                           Dci;
+  UINT8                           EpAddress;
+  UINT16                          MaxPacket;
+  UINT32                          FirstIndex;
+  UINT32                          LastIndex;
+  EFI_USB_DEVICE_REQUEST          *Request;
+  VOID                            *Data;
+  UINTN                           DataLength;
+  UINTN                           TdLength;
+  BOOLEAN                         DataIn;
+  BOOLEAN                         Done;
+  UINT8                           CompletionCode;
+  UINTN                           Completed;
+  BOOLEAN                         LengthSet;
+  //
+  // Asynchronous interrupt transfers only
+  //
+  BOOLEAN                         Async;
+  EFI_ASYNC_USB_TRANSFER_CALLBACK Callback;
+  VOID                            *Context;
+} XHCI_URB;
+
+#define XHCI_URB_SIGNATURE    SIGNATURE_32('X', 'U', 'R', 'B')
+#define XHCI_URB_FROM_LINK(a) CR (a, XHCI_URB, Link, XHCI_URB_SIGNATURE)
+
+//
+// Private context for XHCI controller
+//
+typedef struct {
+  UINT32                  Signature;
+  EFI_USB2_HC_PROTOCOL    Usb2HcProtocol;
+  RP1_PROTOCOL            *Rp1;
+  UINT64                  XhciBase;
+  UINTN                   OpBase;
+  UINTN                   RtBase;
+  UINTN                   DbBase;
+  UINT32                  MaxSlots;
+  UINT32                  MaxPorts;
+  UINT32                  PageSize;
+  UINT32                  CapLength;
+  UINT32                  HccParams;
+  UINT32                  MaxScratchpads;
+  UINT32                  ContextSize;
+  XHCI_DMA_BLOCK          *DmaBlock;
+  UINTN                   DmaPages;
+  UINT64                  *ScratchpadArray;
+  VOID                    *ScratchpadBuffers;
+  UINT64                  *Dcbaa;
+  XHCI_RING               CommandRing;
+  XHCI_EVENT_RING         EventRing;
+  XHCI_CMD_RESULT         CmdResults[XHCI_CMD_RING_TRBS];
+  XHCI_DEVICE             *Devices[XHCI_MAX_DEVICE_SLOTS];
+  //
+  // Bus address to slot ID. Entry 0 is the device most recently enabled
+  // on a root port, still waiting for SET_ADDRESS.
+  //
+  UINT8                   AddressMap[128];
+  LIST_ENTRY              UrbList;
+  EFI_EVENT               AsyncTimer;
+  EFI_HANDLE              Handle;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  LIST_ENTRY              StorageList;
+  //
+  // Root port manager. PORTSC change bits are cleared in hardware as soon
+  // as their event is seen and kept in PortChange until the bus driver
+  // acknowledges them; the maps below hold one bit per root port.
+  //
+  UINT32                  PortChange[XHCI_MAX_ROOT_PORTS];
+  UINT32                  ConnectedPorts;
+  UINT32                  ResettingPorts;
+  UINT32                  ReadyPorts;
+  UINT32                  ProbedPorts;
+  UINT32                  ChangedPorts;
+  EFI_EVENT               HotPlugEvent;
+  EFI_EVENT               ExitBootServicesEvent;
+} XHCI_PRIVATE_DATA;
+
+#define XHCI_PRIVATE_SIGNATURE  SIGNATURE_32('X', 'H', 'C', 'I')
+#define XHCI_PRIVATE_FROM_THIS(a) \
+  CR (a, XHCI_PRIVATE_DATA, Usb2HcProtocol, XHCI_PRIVATE_SIGNATURE)
+
+//
+// USB mass storage boot path: SCSI transparent command set over the
+// bulk-only transport.
+//
+#define XHCI_MASS_STORAGE_SCSI       0x06
+#define XHCI_MASS_STORAGE_BOT        0x50
+
+#define XHCI_BOT_CBW_SIGNATURE       SIGNATURE_32 ('U', 'S', 'B', 'C')
+#define XHCI_BOT_CSW_SIGNATURE       SIGNATURE_32 ('U', 'S', 'B', 'S')
+#define XHCI_BOT_CBW_DATA_IN         BIT7
+#define XHCI_BOT_RESET_REQUEST       0xFF
+#define XHCI_BOT_CSW_PASSED          0
+#define XHCI_BOT_CSW_FAILED          1
+#define XHCI_BOT_CSW_PHASE_ERROR     2
+
+//
+// Port reset and device settle times, in microseconds
+//
+#define XHCI_PORT_RESET_TIMEOUT      500000
+#define XHCI_STORAGE_READY_INTERVAL  100000
+#define XHCI_STORAGE_READY_TIMEOUT   2000000
+
+//
+// Bulk-only commands and control requests, in milliseconds
+//
+#define XHCI_STORAGE_TIMEOUT         10000
+#define XHCI_CONTROL_TIMEOUT         1000
+
+//
+// Sequential reads are staged through two read-ahead windows: one serves
+// the Block I/O reads while the other is being filled by the device.
+//
+#define XHCI_STORAGE_READ_AHEAD      SIZE_512KB
+
+#pragma pack(1)
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  Tag;
+  UINT32                  DataLength;
+  UINT8                   Flags;
+  UINT8                   Lun;
+  UINT8                   CmdLength;
+  UINT8                   Cmd[16];
+} XHCI_BOT_CBW;
+
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  Tag;
+  UINT32                  Residue;
+  UINT8                   Status;
+} XHCI_BOT_CSW;
+
+typedef struct {
+  USB_DEVICE_PATH           Usb;
+  EFI_DEVICE_PATH_PROTOCOL  End;
+} XHCI_STORAGE_DEVICE_PATH;
+#pragma pack()
+
+//
+// One bulk-only mass storage device on a root port. The three URBs of a
+// command are queued together; at most one command is outstanding, which
+// is either a Block I/O request being waited for or a read-ahead.
+//
+typedef struct {
+  UINT32                    Signature;
+  LIST_ENTRY                Link;
+  EFI_HANDLE                Handle;
+  XHCI_PRIVATE_DATA         *Private;
+  XHCI_DEVICE               *Device;
+  UINT8                     RootPort;
+  UINT8                     Interface;
+  UINT8                     BulkIn;
+  UINT8                     BulkOut;
+  UINT16                    MaxPacketIn;
+  UINT16                    MaxPacketOut;
+  UINT32                    Tag;
+  EFI_BLOCK_IO_PROTOCOL     BlockIo;
+  EFI_BLOCK_IO_MEDIA        Media;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  UINTN                     MaxTransferBlocks;
+
+  //
+  // Command in flight
+  //
+  VOID                      *IoPage;
+  XHCI_BOT_CBW              *Cbw;
+  XHCI_BOT_CSW              *Csw;
+  XHCI_URB                  CbwUrb;
+  XHCI_URB                  DataUrb;
+  XHCI_URB                  CswUrb;
+  UINT32                    Queued;
+  UINTN                     DataLength;
+
+  //
+  // Read-ahead
+  //
+  UINTN                     WindowBlocks;
+  UINTN                     WindowPages;
+  UINT8                     *Window[2];
+  UINTN                     Current;
+  EFI_LBA                   CacheLba;
+  UINTN                     CacheBlocks;
+  BOOLEAN                   Pending;
+  EFI_LBA                   PendingLba;
+  UINTN                     PendingBlocks;
+  EFI_LBA                   NextLba;
+} XHCI_STORAGE;
+
+#define XHCI_STORAGE_SIGNATURE  SIGNATURE_32 ('X', 'U', 'M', 'S')
+#define XHCI_STORAGE_FROM_BLOCK_IO(a) \
+  CR (a, XHCI_STORAGE, BlockIo, XHCI_STORAGE_SIGNATURE)
+#define XHCI_STORAGE_FROM_LINK(a) \
+  CR (a, XHCI_STORAGE, Link, XHCI_STORAGE_SIGNATURE)
+
+//
+// XhciReg.c
+//
+UINT32
+XhciReadOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset
+  );
+
+VOID
+XhciWriteOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Data
+  );
+
+VOID
+XhciWriteOpReg64 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT64             Data
+  );
+
+UINT32
+XhciReadRuntimeReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset
+  );
+
+VOID
+XhciWriteRuntimeReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Data
+  );
+
+VOID
+XhciWriteRuntimeReg64 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT64             Data
+  );
+
+VOID
+XhciRingDoorbell (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             SlotId,
+  IN UINT32             Target
+  );
+
+EFI_STATUS
+XhciWaitOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Mask,
+  IN UINT32             Value,
+  IN UINTN              Timeout
+  );
+
+//
+// XhciRing.c
+//
+EFI_STATUS
+XhciAllocateRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+VOID
+XhciFreeRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+VOID
+XhciInitProducerRing (
+  IN OUT XHCI_RING  *Ring,
+  IN     XHCI_TRB   *Trbs,
+  IN     UINT32     NumSegments,
+  IN     UINT32     SegmentTrbs
+  );
+
+VOID
+XhciProgramRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+EFI_STATUS
+XhciRingEnqueue (
+  IN OUT XHCI_RING  *Ring,
+  IN     XHCI_TRB   *Trb,
+  OUT    UINT32     *Index OPTIONAL
+  );
+
+UINT32
+XhciRingFreeCount (
+  IN XHCI_RING  *Ring
+  );
+
+UINT32
+XhciRingIndexFromDma (
+  IN XHCI_RING  *Ring,
+  IN UINT64     DmaAddress
+  );
+
+VOID
+XhciRingRetire (
+  IN OUT XHCI_RING  *Ring,
+  IN     UINT32     Index
+  );
+
+XHCI_RING *
+XhciCreateTransferRing (
+  VOID
+  );
+
+VOID
+XhciFreeTransferRing (
+  IN XHCI_RING  *Ring
+  );
+
+UINTN
+XhciProcessEventRing (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+EFI_STATUS
+XhciCmdPost (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_TRB           *Trb,
+  OUT UINT32             *Index
+  );
+
+EFI_STATUS
+XhciWaitEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN BOOLEAN            *Done,
+  IN UINT64             Timeout
+  );
+
+EFI_STATUS
+XhciCmdWait (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  UINT32             Index,
+  IN  UINTN              Timeout,
+  OUT XHCI_CMD_RESULT    *Result OPTIONAL
+  );
+
+EFI_STATUS
+XhciCmdExecute (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_TRB           *Trb,
+  OUT XHCI_CMD_RESULT    *Result OPTIONAL
+  );
+
+//
+// XhciDevice.c
+//
+XHCI_DEVICE *
+XhciDeviceFromAddress (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              BusAddress
+  );
+
+EFI_STATUS
+XhciInitializeDeviceSlot (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              RootPort,
+  IN UINT8              Speed
+  );
+
+EFI_STATUS
+XhciDisableDeviceSlot (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              SlotId
+  );
+
+EFI_STATUS
+XhciSetDeviceAddress (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              BusAddress
+  );
+
+EFI_STATUS
+XhciEvaluateMaxPacket0 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT16             MaxPacket0
+  );
+
+EFI_STATUS
+XhciConfigureEndpoints (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              ConfigValue
+  );
+
+EFI_STATUS
+XhciRecoverEndpoint (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              Dci,
+  IN BOOLEAN            Halted
+  );
+
+XHCI_DEVICE *
+XhciDeviceFromPort (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              RootPort
+  );
+
+VOID
+XhciFreeDevices (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+VOID
+XhciPollPortStatusChange (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port,
+  IN UINT32             PortSc
+  );
+
+//
+// XhciPort.c
+//
+EFI_STATUS
+XhciInitPorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+UINT32
+XhciUpdatePort (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port
+  );
+
+VOID
+XhciHandlePortStatusEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  );
+
+VOID
+XhciServicePorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+UINT32
+XhciResetPorts (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             PortMap
+  );
+
+EFI_STATUS
+XhciWaitPortReady (
+  IN     XHCI_PRIVATE_DATA  *Private,
+  IN     UINT32             PortMap,
+  IN OUT UINTN              *Timeout,
+  OUT    UINT8              *Port
+  );
+
+VOID
+XhciEnumerateRootPorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  );
+
+//
+// XhciTransfer.c
+//
+VOID
+XhciInitUrb (
+  OUT XHCI_URB                *Urb,
+  IN  XHCI_DEVICE             *Device,
+  IN  UINT8                   EpAddress,
+  IN  UINTN                   MaxPacket,
+  IN  EFI_USB_DEVICE_REQUEST  *Request OPTIONAL,
+  IN  VOID                    *Data,
+  IN  UINTN                   DataLength,
+  IN  BOOLEAN                 DataIn
+  );
+
+EFI_STATUS
+XhciQueueUrb (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_URB           *Urb
+  );
+
+EFI_STATUS
+XhciWaitUrb (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_URB           *Urb,
+  IN  UINTN              Timeout,
+  OUT UINT32             *TransferResult
+  );
+
+VOID
+XhciHandleTransferEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  );
+
+VOID
+EFIAPI
+XhciMonitorAsyncRequests (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
+VOID
+XhciFreeDeviceUrbs (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device
+  );
+
+EFI_STATUS
+EFIAPI
+XhciControlTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     EFI_USB_DEVICE_REQUEST              *Request,
+  IN     EFI_USB_DATA_DIRECTION              TransferDirection,
+  IN OUT VOID                                *Data,
+  IN OUT UINTN                               *DataLength,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  );
+
+EFI_STATUS
+EFIAPI
+XhciBulkTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     UINT8                               DataBuffersNumber,
+  IN OUT VOID                                *Data[EFI_USB_MAX_BULK_BUFFER_NUM],
+  IN OUT UINTN                               *DataLength,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  );
+
+EFI_STATUS
+EFIAPI
+XhciAsyncInterruptTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     BOOLEAN                             IsNewTransfer,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               PollingInterval,
+  IN     UINTN                               DataLength,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  IN     EFI_ASYNC_USB_TRANSFER_CALLBACK     CallBackFunction,
+  IN     VOID                                *Context OPTIONAL
+  );
+
+EFI_STATUS
+EFIAPI
+XhciSyncInterruptTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN OUT VOID                                *Data,
+  IN OUT UINTN                               *DataLength,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  );
+
+EFI_STATUS
+EFIAPI
+XhciIsochronousTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     UINT8                               DataBuffersNumber,
+  IN OUT VOID                                *Data[EFI_USB_MAX_ISO_BUFFER_NUM],
+  IN     UINTN                               DataLength,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  );
+
+//
+// XhciMassStorage.c
+//
+EFI_STATUS
+XhciProbeBootStorage (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port
+  );
+
+#endif
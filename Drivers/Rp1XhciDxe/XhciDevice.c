@@ -0,0 +1,762 @@
+/** @file
+  RP1 XHCI device slot management.
+
+  The USB bus driver enumerates devices through EFI_USB2_HC_PROTOCOL and
+  knows nothing about device slots. A slot is enabled as soon as a root
+  port reports an enabled device, and the standard requests that change
+  controller state (SET_ADDRESS, SET_CONFIGURATION) are turned into the
+  matching xHCI commands by the control transfer path.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+/**
+  Look up a device by the address the USB bus driver assigned to it.
+
+  @param  Private       XHCI private data.
+  @param  BusAddress    Bus address, 0 for the device awaiting SET_ADDRESS.
+
+  @return Device, or NULL if no slot is bound to the address.
+**/
+XHCI_DEVICE *
+XhciDeviceFromAddress (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              BusAddress
+  )
+{
+  UINT8  SlotId;
+
+  if (BusAddress >= ARRAY_SIZE (Private->AddressMap)) {
+    return NULL;
+  }
+
+  SlotId = Private->AddressMap[BusAddress];
+  if (SlotId == 0) {
+    return NULL;
+  }
+
+  return Private->Devices[SlotId];
+}
+
+/**
+  Look up the device attached directly to a root port.
+
+  @param  Private       XHCI private data.
+  @param  RootPort      Root port number (0-based).
+
+  @return Device, or NULL if the port has no slot.
+**/
+XHCI_DEVICE *
+XhciDeviceFromPort (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              RootPort
+  )
+{
+  UINT32  SlotId;
+
+  for (SlotId = 1; SlotId <= Private->MaxSlots; SlotId++) {
+    if ((Private->Devices[SlotId] != NULL) && (Private->Devices[SlotId]->RootPort == RootPort)) {
+      return Private->Devices[SlotId];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Release the memory of a device and all of its rings.
+
+  @param  Device        Device to free.
+**/
+STATIC
+VOID
+XhciFreeDevice (
+  IN XHCI_DEVICE  *Device
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index <= XHCI_MAX_DCI; Index++) {
+    if (Device->Rings[Index] != NULL) {
+      XhciFreeTransferRing (Device->Rings[Index]);
+    }
+  }
+  for (Index = 0; Index < XHCI_MAX_CONFIGS; Index++) {
+    if (Device->ConfigDesc[Index] != NULL) {
+      FreePool (Device->ConfigDesc[Index]);
+    }
+  }
+  if (Device->InputContext != NULL) {
+    FreePages (Device->InputContext, 1);
+  }
+  if (Device->OutputContext != NULL) {
+    FreePages (Device->OutputContext, 1);
+  }
+  FreePool (Device);
+}
+
+/**
+  Forget every device without talking to the controller. Used before a
+  host controller reset, which drops all slots anyway.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+XhciFreeDevices (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  UINTN  SlotId;
+
+  for (SlotId = 1; SlotId < XHCI_MAX_DEVICE_SLOTS; SlotId++) {
+    if (Private->Devices[SlotId] != NULL) {
+      XhciFreeDeviceUrbs (Private, Private->Devices[SlotId]);
+      XhciFreeDevice (Private->Devices[SlotId]);
+      Private->Devices[SlotId] = NULL;
+    }
+  }
+  ZeroMem (Private->AddressMap, sizeof (Private->AddressMap));
+}
+
+/**
+  Rebuild the default control endpoint entry of the input context from the
+  current state of its ring.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+**/
+STATIC
+VOID
+XhciFillEp0Context (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device
+  )
+{
+  XHCI_ENDPOINT_CONTEXT  *Ep0;
+  XHCI_RING              *Ring;
+
+  Ring = Device->Rings[1];
+  Ep0  = XHCI_INPUT_CTX (Private, Device, 1);
+
+  ZeroMem (Ep0, Private->ContextSize);
+  Ep0->Dword1  = XHCI_EP_CTX_CERR (3) | XHCI_EP_CTX_TYPE (XHCI_EP_CONTROL) |
+                 XHCI_EP_CTX_MAX_PACKET (Device->MaxPacket0);
+  Ep0->Dequeue = XHCI_DMA_ADDRESS (&Ring->Trbs[Ring->Enqueue]) | Ring->Cycle;
+  Ep0->Dword4  = XHCI_EP_CTX_AVG_TRB_LEN (8);
+  Ring->Dequeue = Ring->Enqueue;
+}
+
+/**
+  Issue a context command (address, evaluate or configure) for a device
+  after pushing its input context out to memory.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  Control       TRB control word without the slot ID.
+
+  @return Status of XhciCmdExecute.
+**/
+STATIC
+EFI_STATUS
+XhciContextCommand (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT32             Control
+  )
+{
+  XHCI_TRB  Trb;
+
+  WriteBackDataCacheRange (Device->InputContext, EFI_PAGE_SIZE);
+
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Parameter = XHCI_DMA_ADDRESS (Device->InputContext);
+  Trb.Control   = Control | TRB_SLOT_ID (Device->SlotId);
+
+  return XhciCmdExecute (Private, &Trb, NULL);
+}
+
+/**
+  Enable a device slot for a device that has just come up on a root port
+  and move it to the default state. The device keeps bus address 0 until
+  the USB bus driver sends SET_ADDRESS.
+
+  @param  Private       XHCI private data.
+  @param  RootPort      Root port number (0-based).
+  @param  Speed         PORTSC speed ID.
+
+  @retval EFI_SUCCESS           Slot enabled and in the default state.
+  @retval EFI_OUT_OF_RESOURCES  Context or ring allocation failed.
+  @retval others                Enable Slot or Address Device failed.
+**/
+EFI_STATUS
+XhciInitializeDeviceSlot (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              RootPort,
+  IN UINT8              Speed
+  )
+{
+  EFI_STATUS                  Status;
+  XHCI_TRB                    Trb;
+  XHCI_CMD_RESULT             Result;
+  XHCI_DEVICE                 *Device;
+  XHCI_INPUT_CONTROL_CONTEXT  *InputControl;
+  XHCI_SLOT_CONTEXT           *Slot;
+  UINT8                       SlotId;
+
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Control = TRB_TYPE (TRB_TYPE_EN_SLOT);
+  Status = XhciCmdExecute (Private, &Trb, &Result);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  SlotId = Result.SlotId;
+  if ((SlotId == 0) || (SlotId > Private->MaxSlots)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Device = AllocateZeroPool (sizeof (XHCI_DEVICE));
+  if (Device == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto DisableSlot;
+  }
+
+  Device->InputContext  = AllocatePages (1);
+  Device->OutputContext = AllocatePages (1);
+  Device->Rings[1]      = XhciCreateTransferRing ();
+  if ((Device->InputContext == NULL) || (Device->OutputContext == NULL) ||
+      (Device->Rings[1] == NULL))
+  {
+    XhciFreeDevice (Device);
+    Status = EFI_OUT_OF_RESOURCES;
+    goto DisableSlot;
+  }
+  ZeroMem (Device->InputContext, EFI_PAGE_SIZE);
+  ZeroMem (Device->OutputContext, EFI_PAGE_SIZE);
+  WriteBackInvalidateDataCacheRange (Device->OutputContext, EFI_PAGE_SIZE);
+
+  Device->SlotId    = SlotId;
+  Device->RootPort  = RootPort;
+  Device->Speed     = Speed;
+  Device->EpType[1] = XHCI_EP_CONTROL;
+  switch (Speed) {
+  case XHCI_SPEED_SUPER:
+    Device->MaxPacket0 = 512;
+    break;
+  case XHCI_SPEED_HIGH:
+    Device->MaxPacket0 = 64;
+    break;
+  default:
+    Device->MaxPacket0 = 8;
+    break;
+  }
+
+  InputControl           = Device->InputContext;
+  InputControl->AddFlags = BIT0 | BIT1;
+
+  Slot         = XHCI_INPUT_CTX (Private, Device, 0);
+  Slot->Dword0 = XHCI_SLOT_CTX_SPEED (Speed) | XHCI_SLOT_CTX_ENTRIES (1);
+  Slot->Dword1 = XHCI_SLOT_CTX_ROOT_PORT (RootPort + 1);
+
+  XhciFillEp0Context (Private, Device);
+
+  Private->Devices[SlotId] = Device;
+  Private->Dcbaa[SlotId]   = XHCI_DMA_ADDRESS (Device->OutputContext);
+  WriteBackDataCacheRange (&Private->Dcbaa[SlotId], sizeof (UINT64));
+
+  //
+  // BSR keeps the device in the default state: the bus driver reads the
+  // first bytes of the device descriptor at address 0 before it assigns
+  // an address, as it would on any other host controller.
+  //
+  Status = XhciContextCommand (Private, Device, TRB_TYPE (TRB_TYPE_ADDRESS_DEV) | TRB_BSR);
+  if (EFI_ERROR (Status)) {
+    XhciDisableDeviceSlot (Private, SlotId);
+    return Status;
+  }
+
+  Private->AddressMap[0] = SlotId;
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Port %d: slot %d enabled, speed %d\n", RootPort, SlotId, Speed));
+  return EFI_SUCCESS;
+
+DisableSlot:
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Control = TRB_TYPE (TRB_TYPE_DIS_SLOT) | TRB_SLOT_ID (SlotId);
+  XhciCmdExecute (Private, &Trb, NULL);
+  return Status;
+}
+
+/**
+  Disable a device slot and release everything attached to it.
+
+  @param  Private       XHCI private data.
+  @param  SlotId        Slot to disable.
+
+  @retval EFI_SUCCESS       Slot disabled.
+  @retval EFI_NOT_FOUND     No device in the slot.
+  @retval others            Disable Slot command failed; the device is
+                            released anyway.
+**/
+EFI_STATUS
+XhciDisableDeviceSlot (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              SlotId
+  )
+{
+  EFI_STATUS   Status;
+  XHCI_DEVICE  *Device;
+  XHCI_TRB     Trb;
+  UINTN        Index;
+
+  Device = Private->Devices[SlotId];
+  if (Device == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  XhciFreeDeviceUrbs (Private, Device);
+
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Control = TRB_TYPE (TRB_TYPE_DIS_SLOT) | TRB_SLOT_ID (SlotId);
+  Status = XhciCmdExecute (Private, &Trb, NULL);
+
+  Private->Dcbaa[SlotId] = 0;
+  WriteBackDataCacheRange (&Private->Dcbaa[SlotId], sizeof (UINT64));
+
+  for (Index = 0; Index < ARRAY_SIZE (Private->AddressMap); Index++) {
+    if (Private->AddressMap[Index] == SlotId) {
+      Private->AddressMap[Index] = 0;
+    }
+  }
+
+  Private->Devices[SlotId] = NULL;
+  XhciFreeDevice (Device);
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Slot %d disabled\n", SlotId));
+  return Status;
+}
+
+/**
+  Complete SET_ADDRESS for a device in the default state. The controller
+  picks the address it puts on the wire; the bus address is only used to
+  find the slot again.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device in the default state.
+  @param  BusAddress    Address chosen by the USB bus driver.
+
+  @retval EFI_SUCCESS           Device addressed.
+  @retval EFI_INVALID_PARAMETER Bus address out of range.
+  @retval others                Address Device command failed.
+**/
+EFI_STATUS
+XhciSetDeviceAddress (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              BusAddress
+  )
+{
+  EFI_STATUS                  Status;
+  XHCI_INPUT_CONTROL_CONTEXT  *InputControl;
+  XHCI_SLOT_CONTEXT           *Slot;
+
+  if ((BusAddress == 0) || (BusAddress >= ARRAY_SIZE (Private->AddressMap))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  InputControl            = Device->InputContext;
+  InputControl->DropFlags = 0;
+  InputControl->AddFlags  = BIT0 | BIT1;
+  XhciFillEp0Context (Private, Device);
+
+  Status = XhciContextCommand (Private, Device, TRB_TYPE (TRB_TYPE_ADDRESS_DEV));
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Private->AddressMap[0] == Device->SlotId) {
+    Private->AddressMap[0] = 0;
+  }
+  Private->AddressMap[BusAddress] = Device->SlotId;
+  Device->BusAddress              = BusAddress;
+
+  Slot = XHCI_OUTPUT_CTX (Private, Device, 0);
+  InvalidateDataCacheRange (Slot, sizeof (XHCI_SLOT_CONTEXT));
+  DEBUG ((DEBUG_INFO, "[XHCI] Slot %d: bus address %d, device address %d\n",
+          Device->SlotId, BusAddress, XHCI_SLOT_CTX_GET_ADDRESS (Slot->Dword3)));
+  return EFI_SUCCESS;
+}
+
+/**
+  Update the default control endpoint once the real bMaxPacketSize0 is
+  known from the device descriptor.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  MaxPacket0    Max packet size of endpoint 0 in bytes.
+
+  @return Status of the Evaluate Context command.
+**/
+EFI_STATUS
+XhciEvaluateMaxPacket0 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT16             MaxPacket0
+  )
+{
+  XHCI_INPUT_CONTROL_CONTEXT  *InputControl;
+  XHCI_ENDPOINT_CONTEXT       *Ep0;
+
+  if ((MaxPacket0 == 0) || (MaxPacket0 == Device->MaxPacket0)) {
+    return EFI_SUCCESS;
+  }
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Slot %d: EP0 max packet %d\n", Device->SlotId, MaxPacket0));
+  Device->MaxPacket0 = MaxPacket0;
+
+  InputControl            = Device->InputContext;
+  InputControl->DropFlags = 0;
+  InputControl->AddFlags  = BIT1;
+
+  Ep0          = XHCI_INPUT_CTX (Private, Device, 1);
+  Ep0->Dword1 &= ~XHCI_EP_CTX_MAX_PACKET (0xFFFF);
+  Ep0->Dword1 |= XHCI_EP_CTX_MAX_PACKET (MaxPacket0);
+
+  return XhciContextCommand (Private, Device, TRB_TYPE (TRB_TYPE_EVALU_CONTXT));
+}
+
+/**
+  Convert an endpoint descriptor bInterval to the xHCI interval exponent,
+  in 125us units.
+
+  @param  Speed         PORTSC speed ID of the device.
+  @param  Type          USB endpoint transfer type.
+  @param  Interval      bInterval from the endpoint descriptor.
+
+  @return Interval field of the endpoint context.
+**/
+STATIC
+UINT8
+XhciEndpointInterval (
+  IN UINT8  Speed,
+  IN UINT8  Type,
+  IN UINT8  Interval
+  )
+{
+  INTN  Exponent;
+
+  if ((Type == USB_ENDPOINT_BULK) || (Type == USB_ENDPOINT_CONTROL)) {
+    return 0;
+  }
+
+  if ((Speed == XHCI_SPEED_HIGH) || (Speed == XHCI_SPEED_SUPER) || (Type == USB_ENDPOINT_ISO)) {
+    //
+    // 2^(bInterval - 1) units; full-speed isochronous counts frames.
+    //
+    Exponent = MIN (MAX (Interval, 1), 16) - 1;
+    if ((Speed != XHCI_SPEED_HIGH) && (Speed != XHCI_SPEED_SUPER)) {
+      Exponent += 3;
+    }
+    return (UINT8)Exponent;
+  }
+
+  //
+  // Full- and low-speed interrupt endpoints give bInterval in frames.
+  //
+  Exponent = HighBitSet32 ((UINT32)MAX (Interval, 1) * 8);
+  return (UINT8)MIN (MAX (Exponent, 3), 10);
+}
+
+/**
+  Fill the input context entry of one endpoint and give it a ring.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  EpDesc        Endpoint descriptor.
+  @param  MaxBurst      bMaxBurst from the SuperSpeed companion, or 0.
+
+  @return DCI of the endpoint, or 0 if no ring could be allocated.
+**/
+STATIC
+UINT8
+XhciAddEndpoint (
+  IN XHCI_PRIVATE_DATA        *Private,
+  IN XHCI_DEVICE              *Device,
+  IN USB_ENDPOINT_DESCRIPTOR  *EpDesc,
+  IN UINT8                    MaxBurst
+  )
+{
+  XHCI_ENDPOINT_CONTEXT  *Ep;
+  XHCI_RING              *Ring;
+  UINT8                  Dci;
+  UINT8                  Type;
+  UINT8                  EpType;
+  UINT32                 MaxPacket;
+  UINT32                 AvgTrbLength;
+  UINT32                 Esit;
+
+  Dci  = XHCI_ENDPOINT_TO_DCI (EpDesc->EndpointAddress);
+  Type = EpDesc->Attributes & USB_ENDPOINT_TYPE_MASK;
+
+  Ring = XhciCreateTransferRing ();
+  if (Ring == NULL) {
+    return 0;
+  }
+
+  MaxPacket = EpDesc->MaxPacketSize & 0x7FF;
+  if ((Device->Speed == XHCI_SPEED_HIGH) && ((Type == USB_ENDPOINT_ISO) || (Type == USB_ENDPOINT_INTERRUPT))) {
+    //
+    // High-bandwidth endpoints carry the additional transactions per
+    // microframe in bits 12:11.
+    //
+    MaxBurst = (EpDesc->MaxPacketSize >> 11) & 0x3;
+  }
+
+  switch (Type) {
+  case USB_ENDPOINT_ISO:
+    EpType       = (EpDesc->EndpointAddress & USB_ENDPOINT_DIR_IN) ? XHCI_EP_ISOCH_IN : XHCI_EP_ISOCH_OUT;
+    AvgTrbLength = 3072;
+    break;
+  case USB_ENDPOINT_INTERRUPT:
+    EpType       = (EpDesc->EndpointAddress & USB_ENDPOINT_DIR_IN) ? XHCI_EP_INT_IN : XHCI_EP_INT_OUT;
+    AvgTrbLength = 1024;
+    break;
+  case USB_ENDPOINT_BULK:
+    EpType       = (EpDesc->EndpointAddress & USB_ENDPOINT_DIR_IN) ? XHCI_EP_BULK_IN : XHCI_EP_BULK_OUT;
+    AvgTrbLength = 3072;
+    break;
+  default:
+    EpType       = XHCI_EP_CONTROL;
+    AvgTrbLength = 8;
+    break;
+  }
+
+  Esit = 0;
+  if ((Type == USB_ENDPOINT_ISO) || (Type == USB_ENDPOINT_INTERRUPT)) {
+    Esit = MaxPacket * (MaxBurst + 1);
+  }
+
+  Ep = XHCI_INPUT_CTX (Private, Device, Dci);
+  ZeroMem (Ep, Private->ContextSize);
+  Ep->Dword0 = XHCI_EP_CTX_INTERVAL (XhciEndpointInterval (Device->Speed, Type, EpDesc->Interval));
+  //
+  // Isochronous endpoints must not be retried.
+  //
+  Ep->Dword1 = XHCI_EP_CTX_CERR ((Type == USB_ENDPOINT_ISO) ? 0 : 3) |
+               XHCI_EP_CTX_TYPE (EpType) |
+               XHCI_EP_CTX_MAX_BURST (MaxBurst) |
+               XHCI_EP_CTX_MAX_PACKET (MaxPacket);
+  Ep->Dequeue = XHCI_DMA_ADDRESS (Ring->Trbs) | Ring->Cycle;
+  Ep->Dword4  = XHCI_EP_CTX_AVG_TRB_LEN (AvgTrbLength) | XHCI_EP_CTX_MAX_ESIT_LO (Esit);
+
+  Device->Rings[Dci]  = Ring;
+  Device->EpType[Dci] = EpType;
+  return Dci;
+}
+
+/**
+  Configure the endpoints of a configuration that SET_CONFIGURATION has
+  just selected. The configuration descriptor must have been read before
+  through the control transfer path, which caches it. Endpoints of a
+  previous configuration are dropped in the same command.
+
+  @param  Private       XHCI private data.
+  @param  Device        Addressed device.
+  @param  ConfigValue   bConfigurationValue, 0 to unconfigure.
+
+  @retval EFI_SUCCESS           Endpoints configured.
+  @retval EFI_NOT_FOUND         Configuration descriptor not cached.
+  @retval EFI_OUT_OF_RESOURCES  Ring allocation failed.
+  @retval others                Configure Endpoint command failed.
+**/
+EFI_STATUS
+XhciConfigureEndpoints (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              ConfigValue
+  )
+{
+  EFI_STATUS                  Status;
+  XHCI_INPUT_CONTROL_CONTEXT  *InputControl;
+  XHCI_SLOT_CONTEXT           *Slot;
+  USB_CONFIG_DESCRIPTOR       *Config;
+  USB_ENDPOINT_DESCRIPTOR     *EpDesc;
+  XHCI_RING                   *OldRings[XHCI_MAX_DCI + 1];
+  UINT8                       *Desc;
+  UINT8                       *End;
+  UINT8                       AltSetting;
+  UINT8                       MaxBurst;
+  UINT8                       MaxDci;
+  UINT8                       Dci;
+  UINTN                       Index;
+
+  Config = NULL;
+  if (ConfigValue != 0) {
+    for (Index = 0; Index < XHCI_MAX_CONFIGS; Index++) {
+      if ((Device->ConfigDesc[Index] != NULL) &&
+          (Device->ConfigDesc[Index]->ConfigurationValue == ConfigValue))
+      {
+        Config = Device->ConfigDesc[Index];
+        break;
+      }
+    }
+    if (Config == NULL) {
+      DEBUG ((DEBUG_ERROR, "[XHCI] Slot %d: configuration %d not cached\n", Device->SlotId, ConfigValue));
+      return EFI_NOT_FOUND;
+    }
+  }
+
+  InputControl            = Device->InputContext;
+  InputControl->DropFlags = 0;
+  InputControl->AddFlags  = BIT0;
+
+  ZeroMem (OldRings, sizeof (OldRings));
+  for (Dci = 2; Dci <= XHCI_MAX_DCI; Dci++) {
+    if (Device->Rings[Dci] != NULL) {
+      InputControl->DropFlags |= (UINT32)1 << Dci;
+      OldRings[Dci]       = Device->Rings[Dci];
+      Device->Rings[Dci]  = NULL;
+      Device->EpType[Dci] = 0;
+    }
+  }
+
+  MaxDci = 1;
+  Status = EFI_SUCCESS;
+  if (Config != NULL) {
+    Desc       = (UINT8 *)Config + Config->Length;
+    End        = (UINT8 *)Config + Config->TotalLength;
+    AltSetting = 0;
+    while ((Desc + 2 <= End) && (Desc[0] >= 2) && (Desc + Desc[0] <= End)) {
+      if (Desc[1] == USB_DESC_TYPE_INTERFACE) {
+        AltSetting = ((USB_INTERFACE_DESCRIPTOR *)Desc)->AlternateSetting;
+      } else if ((Desc[1] == USB_DESC_TYPE_ENDPOINT) && (AltSetting == 0)) {
+        EpDesc   = (USB_ENDPOINT_DESCRIPTOR *)Desc;
+        MaxBurst = 0;
+        if ((Desc + Desc[0] + 3 <= End) && (Desc[Desc[0] + 1] == XHCI_DESC_TYPE_SS_EP_COMPANION)) {
+          MaxBurst = Desc[Desc[0] + 2];
+        }
+
+        Dci = XhciAddEndpoint (Private, Device, EpDesc, MaxBurst);
+        if (Dci == 0) {
+          Status = EFI_OUT_OF_RESOURCES;
+          break;
+        }
+        InputControl->AddFlags |= (UINT32)1 << Dci;
+        MaxDci                  = MAX (MaxDci, Dci);
+      }
+      Desc += Desc[0];
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Slot          = XHCI_INPUT_CTX (Private, Device, 0);
+    Slot->Dword0 &= ~XHCI_SLOT_CTX_ENTRIES (0x1F);
+    Slot->Dword0 |= XHCI_SLOT_CTX_ENTRIES (MaxDci);
+
+    Status = XhciContextCommand (Private, Device, TRB_TYPE (TRB_TYPE_CON_ENDPOINT));
+  }
+
+  for (Dci = 2; Dci <= XHCI_MAX_DCI; Dci++) {
+    if (EFI_ERROR (Status) && (Device->Rings[Dci] != NULL)) {
+      XhciFreeTransferRing (Device->Rings[Dci]);
+      Device->Rings[Dci]  = NULL;
+      Device->EpType[Dci] = 0;
+    }
+    if (OldRings[Dci] != NULL) {
+      XhciFreeTransferRing (OldRings[Dci]);
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "[XHCI] Slot %d: configuration %d, %d endpoint contexts\n",
+            Device->SlotId, ConfigValue, MaxDci));
+  }
+  return Status;
+}
+
+/**
+  Bring an endpoint back to a usable state after an error or a cancelled
+  transfer, and move its dequeue pointer past everything queued so far.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  Dci           Endpoint DCI.
+  @param  Halted        TRUE if the endpoint halted (stall, babble,
+                        transaction error); FALSE to stop a running one.
+
+  @return Status of the Set TR Dequeue Pointer command.
+**/
+EFI_STATUS
+XhciRecoverEndpoint (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              Dci,
+  IN BOOLEAN            Halted
+  )
+{
+  EFI_STATUS  Status;
+  XHCI_RING   *Ring;
+  XHCI_TRB    Trb;
+
+  Ring = Device->Rings[Dci];
+  if (Ring == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Control = TRB_TYPE (Halted ? TRB_TYPE_RESET_ENDPOINT : TRB_TYPE_STOP_ENDPOINT) |
+                TRB_SLOT_ID (Device->SlotId) | TRB_EP_ID (Dci);
+  //
+  // Stopping an endpoint that already halted or stopped fails with a
+  // context state error; the dequeue pointer can be moved either way.
+  //
+  XhciCmdExecute (Private, &Trb, NULL);
+
+  ZeroMem (&Trb, sizeof (Trb));
+  Trb.Parameter = XHCI_DMA_ADDRESS (&Ring->Trbs[Ring->Enqueue]) | Ring->Cycle;
+  Trb.Control   = TRB_TYPE (TRB_TYPE_SET_TR_DEQUE) | TRB_SLOT_ID (Device->SlotId) | TRB_EP_ID (Dci);
+  Status        = XhciCmdExecute (Private, &Trb, NULL);
+  if (!EFI_ERROR (Status)) {
+    Ring->Dequeue = Ring->Enqueue;
+  }
+
+  return Status;
+}
+
+/**
+  Keep the device slot of a root port in step with the port state. A slot
+  is enabled once the port reports an enabled device and disabled when the
+  device goes away.
+
+  @param  Private       XHCI private data.
+  @param  Port          Root port number (0-based).
+  @param  PortSc        Current PORTSC value.
+**/
+VOID
+XhciPollPortStatusChange (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port,
+  IN UINT32             PortSc
+  )
+{
+  XHCI_DEVICE  *Device;
+
+  Device = XhciDeviceFromPort (Private, Port);
+
+  if ((PortSc & XHCI_PORT_CCS) == 0) {
+    if (Device != NULL) {
+      XhciDisableDeviceSlot (Private, Device->SlotId);
+    }
+    return;
+  }
+
+  if ((Device != NULL) || ((PortSc & XHCI_PORT_PED) == 0) || ((PortSc & XHCI_PORT_PR) != 0)) {
+    return;
+  }
+
+  XhciInitializeDeviceSlot (Private, Port, (UINT8)XHCI_PORT_SPEED (PortSc));
+}
@@ -0,0 +1,1404 @@
+/** @file
+  RP1 XHCI boot path for USB mass storage devices on the root ports.
+
+  Bulk-only devices are enumerated by the driver itself and get a Block
+  I/O protocol that queues the CBW, data and CSW stages of a command in
+  one go instead of running three synchronous transfers. Reads are issued
+  in the largest TDs the rings take, rounded to the controller page size,
+  and sequential reads are served from two read-ahead windows: while the
+  caller consumes one, the device is already filling the other.
+
+  Build with -DXHCI_STORAGE_BENCHMARK to time a sequential read of every
+  device found and log the throughput. Host/XhciStorageBenchmark.c runs
+  the same reads against a model disk without hardware.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+//
+// Stages of the command in flight that are still on an endpoint ring
+//
+#define XHCI_STORAGE_QUEUED_CBW   BIT0
+#define XHCI_STORAGE_QUEUED_DATA  BIT1
+#define XHCI_STORAGE_QUEUED_CSW   BIT2
+
+//
+// Layout of the command page: CBW, CSW and small SCSI responses each
+// start on their own cache line.
+//
+#define XHCI_STORAGE_CBW_OFFSET      0
+#define XHCI_STORAGE_CSW_OFFSET      XHCI_CACHE_LINE_SIZE
+#define XHCI_STORAGE_SCRATCH_OFFSET  (2 * XHCI_CACHE_LINE_SIZE)
+#define XHCI_STORAGE_SCRATCH_SIZE    64
+
+#ifdef XHCI_STORAGE_BENCHMARK
+#define XHCI_STORAGE_BENCHMARK_SIZE   SIZE_64MB
+#define XHCI_STORAGE_BENCHMARK_CHUNK  SIZE_64KB
+#endif
+
+//
+// PORTSC speed IDs to EFI_USB_SPEED_* values
+//
+STATIC CONST UINT8  mXhciEfiSpeed[] = {
+  EFI_USB_SPEED_FULL,
+  EFI_USB_SPEED_FULL,
+  EFI_USB_SPEED_LOW,
+  EFI_USB_SPEED_HIGH,
+  EFI_USB_SPEED_SUPER
+};
+
+/**
+  Issue a control request to a device through the USB2_HC control path,
+  so that address and configuration changes reach the device context.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  RequestType   bmRequestType.
+  @param  Request       bRequest.
+  @param  Value         wValue.
+  @param  Index         wIndex.
+  @param  Data          Data stage buffer, NULL if there is none.
+  @param  Length        Data stage length.
+
+  @return Status of the control transfer.
+**/
+STATIC
+EFI_STATUS
+XhciStorageControl (
+  IN     XHCI_PRIVATE_DATA  *Private,
+  IN     XHCI_DEVICE        *Device,
+  IN     UINT8              RequestType,
+  IN     UINT8              Request,
+  IN     UINT16             Value,
+  IN     UINT16             Index,
+  IN OUT VOID               *Data OPTIONAL,
+  IN     UINTN              Length
+  )
+{
+  EFI_USB_DEVICE_REQUEST  DevReq;
+  EFI_USB_DATA_DIRECTION  Direction;
+  UINT32                  Result;
+
+  DevReq.RequestType = RequestType;
+  DevReq.Request     = Request;
+  DevReq.Value       = Value;
+  DevReq.Index       = Index;
+  DevReq.Length      = (UINT16)Length;
+
+  if (Length == 0) {
+    Direction = EfiUsbNoData;
+  } else if ((RequestType & USB_ENDPOINT_DIR_IN) != 0) {
+    Direction = EfiUsbDataIn;
+  } else {
+    Direction = EfiUsbDataOut;
+  }
+
+  return XhciControlTransfer (
+           &Private->Usb2HcProtocol,
+           Device->BusAddress,
+           mXhciEfiSpeed[MIN (Device->Speed, ARRAY_SIZE (mXhciEfiSpeed) - 1)],
+           Device->MaxPacket0,
+           &DevReq,
+           Direction,
+           Data,
+           (Length == 0) ? NULL : &Length,
+           XHCI_CONTROL_TIMEOUT,
+           NULL,
+           &Result
+           );
+}
+
+/**
+  Return TRUE while the device of a storage instance is still attached.
+  A removed device is freed together with its slot, so it is looked up
+  again by root port rather than dereferenced; a port that saw a connect
+  change since the probe holds some other device.
+**/
+STATIC
+BOOLEAN
+XhciStorageAttached (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  if ((Storage->Device != NULL) &&
+      ((Storage->Private->ProbedPorts & (1U << Storage->RootPort)) != 0) &&
+      (XhciDeviceFromPort (Storage->Private, Storage->RootPort) == Storage->Device))
+  {
+    return TRUE;
+  }
+
+  //
+  // The URBs of a removed device were dropped from the URB list along
+  // with its slot.
+  //
+  Storage->Media.MediaPresent = FALSE;
+  Storage->Queued             = 0;
+  Storage->Pending            = FALSE;
+  Storage->CacheBlocks        = 0;
+  return FALSE;
+}
+
+/**
+  Take every stage of the command in flight off its ring and stop both
+  bulk endpoints so that their dequeue pointers skip the abandoned TDs.
+**/
+STATIC
+VOID
+XhciStorageCancel (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  if (Storage->Queued == 0) {
+    return;
+  }
+
+  if ((Storage->Queued & XHCI_STORAGE_QUEUED_CBW) != 0) {
+    RemoveEntryList (&Storage->CbwUrb.Link);
+  }
+  if ((Storage->Queued & XHCI_STORAGE_QUEUED_DATA) != 0) {
+    RemoveEntryList (&Storage->DataUrb.Link);
+  }
+  if ((Storage->Queued & XHCI_STORAGE_QUEUED_CSW) != 0) {
+    RemoveEntryList (&Storage->CswUrb.Link);
+  }
+  Storage->Queued = 0;
+
+  XhciRecoverEndpoint (Storage->Private, Storage->Device, XHCI_ENDPOINT_TO_DCI (Storage->BulkOut), FALSE);
+  XhciRecoverEndpoint (Storage->Private, Storage->Device, XHCI_ENDPOINT_TO_DCI (Storage->BulkIn), FALSE);
+}
+
+/**
+  Clear a halted bulk endpoint on the device and in the controller.
+**/
+STATIC
+VOID
+XhciStorageClearHalt (
+  IN XHCI_STORAGE  *Storage,
+  IN UINT8         EpAddress
+  )
+{
+  XhciStorageControl (
+    Storage->Private,
+    Storage->Device,
+    USB_DEV_CLEAR_FEATURE_REQ_TYPE_E,
+    USB_DEV_CLEAR_FEATURE,
+    USB_FEATURE_ENDPOINT_HALT,
+    EpAddress,
+    NULL,
+    0
+    );
+  XhciRecoverEndpoint (Storage->Private, Storage->Device, XHCI_ENDPOINT_TO_DCI (EpAddress), TRUE);
+}
+
+/**
+  Bulk-only reset recovery: reset the interface and clear both bulk
+  endpoints.
+**/
+STATIC
+VOID
+XhciStorageResetRecovery (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  DEBUG ((DEBUG_WARN, "[XHCI] Port %d: mass storage reset recovery\n", Storage->RootPort + 1));
+
+  XhciStorageControl (
+    Storage->Private,
+    Storage->Device,
+    USB_REQ_TYPE_CLASS | USB_TARGET_INTERFACE,
+    XHCI_BOT_RESET_REQUEST,
+    0,
+    Storage->Interface,
+    NULL,
+    0
+    );
+  XhciStorageClearHalt (Storage, Storage->BulkIn);
+  XhciStorageClearHalt (Storage, Storage->BulkOut);
+}
+
+/**
+  Queue all stages of a bulk-only command: the CBW on the bulk OUT ring,
+  then the data and the CSW behind each other. Nothing is waited for.
+
+  @param  Storage       Storage instance.
+  @param  Cmd           SCSI command block.
+  @param  CmdLength     Command block length.
+  @param  Data          Data buffer, NULL if there is no data stage.
+  @param  DataLength    Data length.
+  @param  DataIn        TRUE if the data stage reads from the device.
+
+  @retval EFI_SUCCESS   Command queued.
+  @retval others        Command could not be queued; nothing is left on
+                        the rings.
+**/
+STATIC
+EFI_STATUS
+XhciStorageSubmit (
+  IN XHCI_STORAGE  *Storage,
+  IN UINT8         *Cmd,
+  IN UINT8         CmdLength,
+  IN VOID          *Data OPTIONAL,
+  IN UINTN         DataLength,
+  IN BOOLEAN       DataIn
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_BOT_CBW       *Cbw;
+  EFI_STATUS         Status;
+
+  Private = Storage->Private;
+  Cbw     = Storage->Cbw;
+
+  ZeroMem (Cbw, sizeof (XHCI_BOT_CBW));
+  Cbw->Signature  = XHCI_BOT_CBW_SIGNATURE;
+  Cbw->Tag        = ++Storage->Tag;
+  Cbw->DataLength = (UINT32)DataLength;
+  Cbw->Flags      = DataIn ? XHCI_BOT_CBW_DATA_IN : 0;
+  Cbw->CmdLength  = CmdLength;
+  CopyMem (Cbw->Cmd, Cmd, CmdLength);
+
+  Storage->DataLength = DataLength;
+
+  XhciInitUrb (&Storage->CbwUrb, Storage->Device, Storage->BulkOut, Storage->MaxPacketOut, NULL, Cbw, sizeof (XHCI_BOT_CBW), FALSE);
+  Status = XhciQueueUrb (Private, &Storage->CbwUrb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  Storage->Queued = XHCI_STORAGE_QUEUED_CBW;
+
+  if (DataLength > 0) {
+    XhciInitUrb (
+      &Storage->DataUrb,
+      Storage->Device,
+      DataIn ? Storage->BulkIn : Storage->BulkOut,
+      DataIn ? Storage->MaxPacketIn : Storage->MaxPacketOut,
+      NULL,
+      Data,
+      DataLength,
+      DataIn
+      );
+    Status = XhciQueueUrb (Private, &Storage->DataUrb);
+    if (EFI_ERROR (Status)) {
+      XhciStorageCancel (Storage);
+      return Status;
+    }
+    Storage->Queued |= XHCI_STORAGE_QUEUED_DATA;
+  }
+
+  XhciInitUrb (&Storage->CswUrb, Storage->Device, Storage->BulkIn, Storage->MaxPacketIn, NULL, Storage->Csw, sizeof (XHCI_BOT_CSW), TRUE);
+  Status = XhciQueueUrb (Private, &Storage->CswUrb);
+  if (EFI_ERROR (Status)) {
+    XhciStorageCancel (Storage);
+    return Status;
+  }
+  Storage->Queued |= XHCI_STORAGE_QUEUED_CSW;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Wait for the command in flight and check its status wrapper. A stalled
+  data stage is cleared and the CSW collected; anything else that breaks
+  the protocol ends in reset recovery.
+
+  @param  Storage       Storage instance.
+  @param  Transferred   Bytes moved in the data stage.
+
+  @retval EFI_SUCCESS       Command passed.
+  @retval EFI_DEVICE_ERROR  Command failed or the transport broke down.
+**/
+STATIC
+EFI_STATUS
+XhciStorageFinish (
+  IN  XHCI_STORAGE  *Storage,
+  OUT UINTN         *Transferred OPTIONAL
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_BOT_CSW       *Csw;
+  EFI_STATUS         Status;
+  UINT32             Result;
+  UINTN              Moved;
+  BOOLEAN            CswSkipped;
+
+  Private = Storage->Private;
+  Csw     = Storage->Csw;
+  Moved   = 0;
+
+  if (Transferred != NULL) {
+    *Transferred = 0;
+  }
+
+  Status = XhciWaitUrb (Private, &Storage->CbwUrb, XHCI_STORAGE_TIMEOUT, &Result);
+  Storage->Queued &= ~XHCI_STORAGE_QUEUED_CBW;
+  if (EFI_ERROR (Status)) {
+    goto Recover;
+  }
+
+  if ((Storage->Queued & XHCI_STORAGE_QUEUED_DATA) != 0) {
+    Status = XhciWaitUrb (Private, &Storage->DataUrb, XHCI_STORAGE_TIMEOUT, &Result);
+    Storage->Queued &= ~XHCI_STORAGE_QUEUED_DATA;
+    Moved = Storage->DataUrb.Completed;
+    if (EFI_ERROR (Status)) {
+      if (Result != EFI_USB_ERR_STALL) {
+        goto Recover;
+      }
+
+      //
+      // The device may end the data stage with a stall and still report
+      // a CSW. Recovering a stalled IN endpoint moved its dequeue pointer
+      // past the queued CSW, so it is queued again once the halt clears.
+      //
+      Moved      = 0;
+      CswSkipped = (BOOLEAN)(Storage->DataUrb.Dci == Storage->CswUrb.Dci);
+      if (CswSkipped) {
+        RemoveEntryList (&Storage->CswUrb.Link);
+        Storage->Queued &= ~XHCI_STORAGE_QUEUED_CSW;
+      }
+      XhciStorageClearHalt (Storage, Storage->DataUrb.EpAddress);
+      if (CswSkipped) {
+        if (EFI_ERROR (XhciQueueUrb (Private, &Storage->CswUrb))) {
+          goto Recover;
+        }
+        Storage->Queued |= XHCI_STORAGE_QUEUED_CSW;
+      }
+    }
+  }
+
+  Status = XhciWaitUrb (Private, &Storage->CswUrb, XHCI_STORAGE_TIMEOUT, &Result);
+  Storage->Queued &= ~XHCI_STORAGE_QUEUED_CSW;
+  if (EFI_ERROR (Status) && (Result == EFI_USB_ERR_STALL)) {
+    XhciStorageClearHalt (Storage, Storage->BulkIn);
+    Status = XhciQueueUrb (Private, &Storage->CswUrb);
+    if (!EFI_ERROR (Status)) {
+      Status = XhciWaitUrb (Private, &Storage->CswUrb, XHCI_STORAGE_TIMEOUT, &Result);
+    }
+  }
+  if (EFI_ERROR (Status)) {
+    goto Recover;
+  }
+
+  if ((Storage->CswUrb.Completed != sizeof (XHCI_BOT_CSW)) ||
+      (Csw->Signature != XHCI_BOT_CSW_SIGNATURE) ||
+      (Csw->Tag != Storage->Tag))
+  {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Port %d: invalid CSW\n", Storage->RootPort + 1));
+    goto Recover;
+  }
+
+  if (Csw->Status == XHCI_BOT_CSW_PHASE_ERROR) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Port %d: CSW phase error\n", Storage->RootPort + 1));
+    goto Recover;
+  }
+
+  if (Transferred != NULL) {
+    *Transferred = MIN (Moved, Storage->DataLength - MIN (Csw->Residue, Storage->DataLength));
+  }
+
+  return (Csw->Status == XHCI_BOT_CSW_PASSED) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+
+Recover:
+  XhciStorageCancel (Storage);
+  XhciStorageResetRecovery (Storage);
+  return EFI_DEVICE_ERROR;
+}
+
+/**
+  Collect the read-ahead in flight, if any, and make it the cached window.
+  A failed read-ahead is dropped; the read that needs the data reports
+  the error.
+**/
+STATIC
+VOID
+XhciStorageFinishReadAhead (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Transferred;
+
+  if (!Storage->Pending) {
+    return;
+  }
+
+  Storage->Pending = FALSE;
+  Status = XhciStorageFinish (Storage, &Transferred);
+  if (EFI_ERROR (Status) || (Transferred != Storage->PendingBlocks * Storage->Media.BlockSize)) {
+    return;
+  }
+
+  Storage->Current    ^= 1;
+  Storage->CacheLba    = Storage->PendingLba;
+  Storage->CacheBlocks = Storage->PendingBlocks;
+}
+
+/**
+  Run one SCSI command to completion. A read-ahead still in flight is
+  collected first, since bulk-only devices take one command at a time.
+  Raises to XHCI_TPL for the probe path, which runs below it.
+
+  @param  Storage       Storage instance.
+  @param  Cmd           SCSI command block.
+  @param  CmdLength     Command block length.
+  @param  Data          Data buffer, NULL if there is no data stage.
+  @param  DataLength    Data length.
+  @param  DataIn        TRUE if the data stage reads from the device.
+  @param  Transferred   Bytes moved in the data stage.
+
+  @return Status of the command.
+**/
+STATIC
+EFI_STATUS
+XhciStorageCommand (
+  IN  XHCI_STORAGE  *Storage,
+  IN  UINT8         *Cmd,
+  IN  UINT8         CmdLength,
+  IN  VOID          *Data OPTIONAL,
+  IN  UINTN         DataLength,
+  IN  BOOLEAN       DataIn,
+  OUT UINTN         *Transferred OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  XhciStorageFinishReadAhead (Storage);
+
+  Status = XhciStorageSubmit (Storage, Cmd, CmdLength, Data, DataLength, DataIn);
+  if (!EFI_ERROR (Status)) {
+    Status = XhciStorageFinish (Storage, Transferred);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Queue a READ or WRITE command, using the 16-byte form only when the
+  range does not fit the 10-byte one.
+
+  @param  Storage       Storage instance.
+  @param  Lba           First block.
+  @param  Blocks        Block count, at most MaxTransferBlocks.
+  @param  Buffer        Data buffer.
+  @param  Write         TRUE to write, FALSE to read.
+
+  @return Status of XhciStorageSubmit.
+**/
+STATIC
+EFI_STATUS
+XhciStorageSubmitReadWrite (
+  IN XHCI_STORAGE  *Storage,
+  IN EFI_LBA       Lba,
+  IN UINTN         Blocks,
+  IN VOID          *Buffer,
+  IN BOOLEAN       Write
+  )
+{
+  UINT8  Cmd[16];
+  UINT8  CmdLength;
+
+  ZeroMem (Cmd, sizeof (Cmd));
+  if (Lba + Blocks - 1 > MAX_UINT32) {
+    Cmd[0] = Write ? EFI_SCSI_OP_WRITE16 : EFI_SCSI_OP_READ16;
+    WriteUnaligned64 ((UINT64 *)&Cmd[2], SwapBytes64 (Lba));
+    WriteUnaligned32 ((UINT32 *)&Cmd[10], SwapBytes32 ((UINT32)Blocks));
+    CmdLength = 16;
+  } else {
+    Cmd[0] = Write ? EFI_SCSI_OP_WRITE10 : EFI_SCSI_OP_READ10;
+    WriteUnaligned32 ((UINT32 *)&Cmd[2], SwapBytes32 ((UINT32)Lba));
+    WriteUnaligned16 ((UINT16 *)&Cmd[7], SwapBytes16 ((UINT16)Blocks));
+    CmdLength = 10;
+  }
+
+  return XhciStorageSubmit (Storage, Cmd, CmdLength, Buffer, Blocks * Storage->Media.BlockSize, (BOOLEAN)!Write);
+}
+
+/**
+  Read or write a run of blocks and wait for it.
+**/
+STATIC
+EFI_STATUS
+XhciStorageReadWrite (
+  IN XHCI_STORAGE  *Storage,
+  IN EFI_LBA       Lba,
+  IN UINTN         Blocks,
+  IN VOID          *Buffer,
+  IN BOOLEAN       Write
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Transferred;
+
+  XhciStorageFinishReadAhead (Storage);
+
+  Status = XhciStorageSubmitReadWrite (Storage, Lba, Blocks, Buffer, Write);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = XhciStorageFinish (Storage, &Transferred);
+  if (!EFI_ERROR (Status) && (Transferred != Blocks * Storage->Media.BlockSize)) {
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  return Status;
+}
+
+/**
+  Start reading the window at Lba into the spare buffer, unless a
+  read-ahead is already in flight or Lba is past the end of the media.
+**/
+STATIC
+VOID
+XhciStorageStartReadAhead (
+  IN XHCI_STORAGE  *Storage,
+  IN EFI_LBA       Lba
+  )
+{
+  UINTN  Blocks;
+
+  if (Storage->Pending || (Lba > Storage->Media.LastBlock)) {
+    return;
+  }
+
+  Blocks = (UINTN)MIN ((UINT64)Storage->WindowBlocks, Storage->Media.LastBlock + 1 - Lba);
+  if (!EFI_ERROR (XhciStorageSubmitReadWrite (Storage, Lba, Blocks, Storage->Window[Storage->Current ^ 1], FALSE))) {
+    Storage->Pending       = TRUE;
+    Storage->PendingLba    = Lba;
+    Storage->PendingBlocks = Blocks;
+  }
+}
+
+/**
+  Fetch and log the sense data of the last failed command.
+**/
+STATIC
+VOID
+XhciStorageRequestSense (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  UINT8  Cmd[6];
+  UINT8  *Sense;
+
+  Sense = (UINT8 *)Storage->IoPage + XHCI_STORAGE_SCRATCH_OFFSET;
+
+  ZeroMem (Cmd, sizeof (Cmd));
+  Cmd[0] = EFI_SCSI_OP_REQUEST_SENSE;
+  Cmd[4] = 18;
+  if (!EFI_ERROR (XhciStorageCommand (Storage, Cmd, sizeof (Cmd), Sense, 18, TRUE, NULL))) {
+    DEBUG ((DEBUG_INFO, "[XHCI] Port %d: sense key 0x%x ASC 0x%x ASCQ 0x%x\n",
+            Storage->RootPort + 1, Sense[2] & 0x0F, Sense[12], Sense[13]));
+  }
+}
+
+/**
+  Ask the device whether the medium is ready, fetching the sense data
+  for the log when it is not.
+
+  @param  Context       Storage instance.
+
+  @retval TRUE          TEST UNIT READY passed.
+  @retval FALSE         Keep waiting.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+XhciStorageUnitReady (
+  IN VOID  *Context
+  )
+{
+  XHCI_STORAGE  *Storage;
+  UINT8         Cmd[6];
+
+  Storage = Context;
+
+  ZeroMem (Cmd, sizeof (Cmd));
+  Cmd[0] = EFI_SCSI_OP_TEST_UNIT_READY;
+  if (!EFI_ERROR (XhciStorageCommand (Storage, Cmd, sizeof (Cmd), NULL, 0, FALSE, NULL))) {
+    return TRUE;
+  }
+
+  XhciStorageRequestSense (Storage);
+  return FALSE;
+}
+
+/**
+  Wait for the medium to become ready and read its geometry.
+
+  @param  Storage       Storage instance.
+
+  @retval EFI_SUCCESS       Media fields filled in.
+  @retval EFI_NO_MEDIA      The device never became ready.
+  @retval EFI_UNSUPPORTED   The reported block size is unusable.
+**/
+STATIC
+EFI_STATUS
+XhciStorageReadCapacity (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       Cmd[16];
+  UINT8       *Data;
+  UINT64      LastBlock;
+  UINT32      BlockSize;
+
+  Data = (UINT8 *)Storage->IoPage + XHCI_STORAGE_SCRATCH_OFFSET;
+
+  Status = PlatformWaitConditionInterval (
+             XhciStorageUnitReady,
+             Storage,
+             XHCI_STORAGE_READY_TIMEOUT,
+             XHCI_STORAGE_READY_INTERVAL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    return EFI_NO_MEDIA;
+  }
+
+  ZeroMem (Cmd, sizeof (Cmd));
+  Cmd[0] = EFI_SCSI_OP_READ_CAPACITY;
+  Status = XhciStorageCommand (Storage, Cmd, 10, Data, 8, TRUE, NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  LastBlock = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Data[0]));
+  BlockSize = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Data[4]));
+
+  if (LastBlock == MAX_UINT32) {
+    ZeroMem (Cmd, sizeof (Cmd));
+    Cmd[0] = EFI_SCSI_OP_READ_CAPACITY16;
+    Cmd[1] = 0x10;
+    WriteUnaligned32 ((UINT32 *)&Cmd[10], SwapBytes32 (32));
+    Status = XhciStorageCommand (Storage, Cmd, 16, Data, 32, TRUE, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    LastBlock = SwapBytes64 (ReadUnaligned64 ((UINT64 *)&Data[0]));
+    BlockSize = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Data[8]));
+  }
+
+  if ((BlockSize == 0) || (BlockSize > SIZE_64KB) || ((BlockSize & (BlockSize - 1)) != 0)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Port %d: unsupported block size %d\n", Storage->RootPort + 1, BlockSize));
+    return EFI_UNSUPPORTED;
+  }
+
+  Storage->Media.LastBlock    = LastBlock;
+  Storage->Media.BlockSize    = BlockSize;
+  Storage->Media.MediaPresent = TRUE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Reset the block device.
+
+  @param  This                  Block I/O protocol instance.
+  @param  ExtendedVerification  TRUE to run bulk-only reset recovery.
+
+  @retval EFI_SUCCESS           Device reset.
+  @retval EFI_NO_MEDIA          Device was removed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+XhciStorageReset (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  XHCI_STORAGE  *Storage;
+  EFI_TPL       OldTpl;
+  EFI_STATUS    Status;
+
+  Storage = XHCI_STORAGE_FROM_BLOCK_IO (This);
+  OldTpl  = gBS->RaiseTPL (XHCI_TPL);
+
+  Status = EFI_NO_MEDIA;
+  if (XhciStorageAttached (Storage)) {
+    XhciStorageFinishReadAhead (Storage);
+    Storage->CacheBlocks = 0;
+    if (ExtendedVerification) {
+      XhciStorageResetRecovery (Storage);
+    }
+    Status = EFI_SUCCESS;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Check the arguments of a Block I/O read or write.
+**/
+STATIC
+EFI_STATUS
+XhciStorageCheckRequest (
+  IN XHCI_STORAGE  *Storage,
+  IN UINT32        MediaId,
+  IN EFI_LBA       Lba,
+  IN UINTN         BufferSize,
+  IN VOID          *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Media = &Storage->Media;
+
+  if (!Media->MediaPresent) {
+    return EFI_NO_MEDIA;
+  }
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((BufferSize % Media->BlockSize) != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  if ((Lba > Media->LastBlock) || ((BufferSize / Media->BlockSize) - 1 > Media->LastBlock - Lba)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks from the device.
+
+  Reads are served from the cached read-ahead window where possible. A
+  miss of less than a window fills a whole window; larger misses go
+  straight into the caller's buffer in MaxTransferBlocks pieces. After a
+  sequential read the next window is requested from the device before
+  returning, so that it arrives while the caller works on this one.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to read.
+  @param  BufferSize    Bytes to read.
+  @param  Buffer        Destination buffer.
+
+  @retval EFI_SUCCESS           Data read.
+  @retval EFI_DEVICE_ERROR      Device reported an error.
+  @retval EFI_NO_MEDIA          Device was removed.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+XhciStorageReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  XHCI_STORAGE  *Storage;
+  EFI_STATUS    Status;
+  EFI_TPL       OldTpl;
+  UINT8         *Output;
+  UINTN         BlockSize;
+  UINTN         Blocks;
+  UINTN         Count;
+  BOOLEAN       Sequential;
+  EFI_LBA       CacheEnd;
+
+  Storage = XHCI_STORAGE_FROM_BLOCK_IO (This);
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = XhciStorageCheckRequest (Storage, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  if (!XhciStorageAttached (Storage)) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_NO_MEDIA;
+  }
+
+  BlockSize  = Storage->Media.BlockSize;
+  Blocks     = BufferSize / BlockSize;
+  Output     = Buffer;
+  Sequential = (BOOLEAN)(Lba == Storage->NextLba);
+
+  while (Blocks > 0) {
+    CacheEnd = Storage->CacheLba + Storage->CacheBlocks;
+    if ((Storage->CacheBlocks > 0) && (Lba >= Storage->CacheLba) && (Lba < CacheEnd)) {
+      Count = (UINTN)MIN ((UINT64)Blocks, CacheEnd - Lba);
+      CopyMem (Output, Storage->Window[Storage->Current] + (UINTN)(Lba - Storage->CacheLba) * BlockSize, Count * BlockSize);
+    } else if (Storage->Pending) {
+      XhciStorageFinishReadAhead (Storage);
+      continue;
+    } else if (Blocks >= Storage->WindowBlocks) {
+      Count  = MIN (Blocks, Storage->MaxTransferBlocks);
+      Status = XhciStorageReadWrite (Storage, Lba, Count, Output, FALSE);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    } else {
+      Storage->CacheBlocks = 0;
+      Count  = (UINTN)MIN ((UINT64)Storage->WindowBlocks, Storage->Media.LastBlock + 1 - Lba);
+      Status = XhciStorageReadWrite (Storage, Lba, Count, Storage->Window[Storage->Current], FALSE);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+      Storage->CacheLba    = Lba;
+      Storage->CacheBlocks = Count;
+      continue;
+    }
+
+    Lba    += Count;
+    Output += Count * BlockSize;
+    Blocks -= Count;
+  }
+
+  if (EFI_ERROR (Status)) {
+    Storage->NextLba = MAX_UINT64;
+  } else {
+    Storage->NextLba = Lba;
+    if (Sequential) {
+      CacheEnd = Storage->CacheLba + Storage->CacheBlocks;
+      if ((Storage->CacheBlocks > 0) && (Lba >= Storage->CacheLba) && (Lba < CacheEnd)) {
+        Lba = CacheEnd;
+      }
+      XhciStorageStartReadAhead (Storage, Lba);
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Write blocks to the device. The read-ahead cache is dropped.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to write.
+  @param  BufferSize    Bytes to write.
+  @param  Buffer        Source buffer.
+
+  @retval EFI_SUCCESS           Data written.
+  @retval EFI_WRITE_PROTECTED   Media is read-only.
+  @retval EFI_DEVICE_ERROR      Device reported an error.
+  @retval EFI_NO_MEDIA          Device was removed.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+XhciStorageWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  XHCI_STORAGE  *Storage;
+  EFI_STATUS    Status;
+  EFI_TPL       OldTpl;
+  UINT8         *Input;
+  UINTN         Blocks;
+  UINTN         Count;
+
+  Storage = XHCI_STORAGE_FROM_BLOCK_IO (This);
+  if (Storage->Media.ReadOnly) {
+    return EFI_WRITE_PROTECTED;
+  }
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = XhciStorageCheckRequest (Storage, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  if (!XhciStorageAttached (Storage)) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_NO_MEDIA;
+  }
+
+  XhciStorageFinishReadAhead (Storage);
+  Storage->CacheBlocks = 0;
+  Storage->NextLba     = MAX_UINT64;
+
+  Blocks = BufferSize / Storage->Media.BlockSize;
+  Input  = Buffer;
+  while (Blocks > 0) {
+    Count  = MIN (Blocks, Storage->MaxTransferBlocks);
+    Status = XhciStorageReadWrite (Storage, Lba, Count, Input, TRUE);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    Lba    += Count;
+    Input  += Count * Storage->Media.BlockSize;
+    Blocks -= Count;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Flush the block device. Bulk-only writes are complete once their CSW
+  has been received, so there is nothing to do.
+
+  @param  This          Block I/O protocol instance.
+
+  @retval EFI_SUCCESS   Nothing pending.
+  @retval EFI_NO_MEDIA  Device was removed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+XhciStorageFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return XHCI_STORAGE_FROM_BLOCK_IO (This)->Media.MediaPresent ? EFI_SUCCESS : EFI_NO_MEDIA;
+}
+
+#ifdef XHCI_STORAGE_BENCHMARK
+/**
+  Time a sequential read through Block I/O, the way a boot loader reads a
+  large file, and log the throughput.
+**/
+STATIC
+VOID
+XhciStorageBenchmark (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  VOID                *Buffer;
+  UINT64              Total;
+  UINT64              Offset;
+  UINT64              Start;
+  UINT64              Elapsed;
+  EFI_STATUS          Status;
+
+  Media  = &Storage->Media;
+  Total  = MIN ((UINT64)XHCI_STORAGE_BENCHMARK_SIZE, MultU64x32 (Media->LastBlock + 1, Media->BlockSize));
+  Total -= Total % XHCI_STORAGE_BENCHMARK_CHUNK;
+  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (XHCI_STORAGE_BENCHMARK_CHUNK));
+  if ((Buffer == NULL) || (Total == 0)) {
+    return;
+  }
+
+  Status = EFI_SUCCESS;
+  Start  = GetPerformanceCounter ();
+  for (Offset = 0; Offset < Total && !EFI_ERROR (Status); Offset += XHCI_STORAGE_BENCHMARK_CHUNK) {
+    Status = Storage->BlockIo.ReadBlocks (
+                                &Storage->BlockIo,
+                                Media->MediaId,
+                                DivU64x32 (Offset, Media->BlockSize),
+                                XHCI_STORAGE_BENCHMARK_CHUNK,
+                                Buffer
+                                );
+  }
+  Elapsed = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - Start), 1000);
+
+  if (EFI_ERROR (Status) || (Elapsed == 0)) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Storage benchmark failed: %r\n", Status));
+  } else {
+    DEBUG ((DEBUG_INFO, "[XHCI] Storage benchmark: %Lu KB in %Lu us, %Lu MB/s\n",
+            DivU64x32 (Total, SIZE_1KB), Elapsed, DivU64x64Remainder (Total, Elapsed, NULL)));
+  }
+
+  FreePages (Buffer, EFI_SIZE_TO_PAGES (XHCI_STORAGE_BENCHMARK_CHUNK));
+}
+#endif
+
+/**
+  Release a storage instance that was never installed.
+**/
+STATIC
+VOID
+XhciStorageFree (
+  IN XHCI_STORAGE  *Storage
+  )
+{
+  if (Storage->Window[0] != NULL) {
+    FreePages (Storage->Window[0], Storage->WindowPages);
+  }
+  if (Storage->Window[1] != NULL) {
+    FreePages (Storage->Window[1], Storage->WindowPages);
+  }
+  if (Storage->IoPage != NULL) {
+    FreePages (Storage->IoPage, 1);
+  }
+  if (Storage->DevicePath != NULL) {
+    FreePool (Storage->DevicePath);
+  }
+  FreePool (Storage);
+}
+
+/**
+  Create the Block I/O instance of a configured bulk-only device.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+  @param  Interface     Mass storage interface number.
+  @param  BulkIn        Bulk IN endpoint address.
+  @param  MaxPacketIn   Bulk IN max packet size.
+  @param  BulkOut       Bulk OUT endpoint address.
+  @param  MaxPacketOut  Bulk OUT max packet size.
+
+  @retval EFI_SUCCESS   Block I/O installed.
+  @retval others        Device is not usable.
+**/
+STATIC
+EFI_STATUS
+XhciStorageCreate (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device,
+  IN UINT8              Interface,
+  IN UINT8              BulkIn,
+  IN UINT16             MaxPacketIn,
+  IN UINT8              BulkOut,
+  IN UINT16             MaxPacketOut
+  )
+{
+  XHCI_STORAGE              *Storage;
+  XHCI_STORAGE_DEVICE_PATH  Node;
+  EFI_STATUS                Status;
+  UINTN                     Transfer;
+
+  Storage = AllocateZeroPool (sizeof (XHCI_STORAGE));
+  if (Storage == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Storage->Signature    = XHCI_STORAGE_SIGNATURE;
+  Storage->Private      = Private;
+  Storage->Device       = Device;
+  Storage->RootPort     = Device->RootPort;
+  Storage->Interface    = Interface;
+  Storage->BulkIn       = BulkIn;
+  Storage->BulkOut      = BulkOut;
+  Storage->MaxPacketIn  = MaxPacketIn;
+  Storage->MaxPacketOut = MaxPacketOut;
+  Storage->NextLba      = MAX_UINT64;
+
+  Storage->IoPage = AllocatePages (1);
+  if (Storage->IoPage == NULL) {
+    XhciStorageFree (Storage);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Storage->Cbw = (XHCI_BOT_CBW *)((UINT8 *)Storage->IoPage + XHCI_STORAGE_CBW_OFFSET);
+  Storage->Csw = (XHCI_BOT_CSW *)((UINT8 *)Storage->IoPage + XHCI_STORAGE_CSW_OFFSET);
+
+  Storage->Media.RemovableMedia = TRUE;
+  Status = XhciStorageReadCapacity (Storage);
+  if (EFI_ERROR (Status)) {
+    XhciStorageFree (Storage);
+    return Status;
+  }
+
+  //
+  // Transfers are whole controller pages, as large as one TD can carry
+  // and no larger than a READ(10) block count.
+  //
+  Transfer                   = (XHCI_MAX_TD_BYTES / Private->PageSize) * Private->PageSize;
+  Storage->MaxTransferBlocks = MIN (Transfer / Storage->Media.BlockSize, MAX_UINT16);
+  Storage->WindowBlocks      = MIN (
+                                 ALIGN_VALUE (XHCI_STORAGE_READ_AHEAD, Private->PageSize) / Storage->Media.BlockSize,
+                                 Storage->MaxTransferBlocks
+                                 );
+  Storage->WindowBlocks      = MAX (Storage->WindowBlocks, 1);
+  Storage->WindowPages       = EFI_SIZE_TO_PAGES (Storage->WindowBlocks * Storage->Media.BlockSize);
+  Storage->Window[0]         = AllocatePages (Storage->WindowPages);
+  Storage->Window[1]         = AllocatePages (Storage->WindowPages);
+  if ((Storage->Window[0] == NULL) || (Storage->Window[1] == NULL)) {
+    XhciStorageFree (Storage);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Storage->Media.OptimalTransferLengthGranularity = (UINT32)Storage->WindowBlocks;
+  Storage->BlockIo.Revision    = EFI_BLOCK_IO_PROTOCOL_REVISION3;
+  Storage->BlockIo.Media       = &Storage->Media;
+  Storage->BlockIo.Reset       = XhciStorageReset;
+  Storage->BlockIo.ReadBlocks  = XhciStorageReadBlocks;
+  Storage->BlockIo.WriteBlocks = XhciStorageWriteBlocks;
+  Storage->BlockIo.FlushBlocks = XhciStorageFlushBlocks;
+
+  ZeroMem (&Node, sizeof (Node));
+  Node.Usb.Header.Type     = MESSAGING_DEVICE_PATH;
+  Node.Usb.Header.SubType  = MSG_USB_DP;
+  SetDevicePathNodeLength (&Node.Usb.Header, sizeof (USB_DEVICE_PATH));
+  Node.Usb.ParentPortNumber = Device->RootPort;
+  Node.Usb.InterfaceNumber  = Interface;
+  SetDevicePathEndNode (&Node.End);
+  Storage->DevicePath = AppendDevicePathNode (Private->DevicePath, &Node.Usb.Header);
+  if (Storage->DevicePath == NULL) {
+    XhciStorageFree (Storage);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Storage->Handle,
+                  &gEfiBlockIoProtocolGuid, &Storage->BlockIo,
+                  &gEfiDevicePathProtocolGuid, Storage->DevicePath,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    XhciStorageFree (Storage);
+    return Status;
+  }
+
+  InsertTailList (&Private->StorageList, &Storage->Link);
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Port %d: mass storage, %Lu blocks of %d bytes, %d KB transfers\n",
+          Storage->RootPort + 1, Storage->Media.LastBlock + 1, Storage->Media.BlockSize,
+          (Storage->MaxTransferBlocks * Storage->Media.BlockSize) / SIZE_1KB));
+
+#ifdef XHCI_STORAGE_BENCHMARK
+  XhciStorageBenchmark (Storage);
+#endif
+
+  gBS->ConnectController (Storage->Handle, NULL, NULL, TRUE);
+  return EFI_SUCCESS;
+}
+
+/**
+  Remove the Block I/O instance left behind by a device that has since
+  been unplugged from a root port.
+
+  @param  Private       XHCI private data.
+  @param  Port          Root port number (0-based).
+**/
+STATIC
+VOID
+XhciStorageRemove (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port
+  )
+{
+  LIST_ENTRY    *Entry;
+  LIST_ENTRY    *Next;
+  XHCI_STORAGE  *Storage;
+  EFI_STATUS    Status;
+
+  for (Entry = GetFirstNode (&Private->StorageList); !IsNull (&Private->StorageList, Entry); Entry = Next) {
+    Next    = GetNextNode (&Private->StorageList, Entry);
+    Storage = XHCI_STORAGE_FROM_LINK (Entry);
+    if (Storage->RootPort != Port) {
+      continue;
+    }
+
+    //
+    // The device structure may already be reused for the new device, so
+    // the instance is retired here rather than by XhciStorageAttached().
+    // Its URBs went with the old slot.
+    //
+    Storage->Device             = NULL;
+    Storage->Media.MediaPresent = FALSE;
+    Storage->Queued             = 0;
+    Storage->Pending            = FALSE;
+    Storage->CacheBlocks        = 0;
+
+    gBS->DisconnectController (Storage->Handle, NULL, NULL);
+    Status = gBS->UninstallMultipleProtocolInterfaces (
+                    Storage->Handle,
+                    &gEfiBlockIoProtocolGuid, &Storage->BlockIo,
+                    &gEfiDevicePathProtocolGuid, Storage->DevicePath,
+                    NULL
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "[XHCI] Port %d: stale mass storage still in use: %r\n", Port + 1, Status));
+      continue;
+    }
+
+    RemoveEntryList (&Storage->Link);
+    XhciStorageFree (Storage);
+  }
+}
+
+/**
+  Enumerate the device on a root port and attach the boot path to it if
+  it is a SCSI bulk-only mass storage device.
+
+  @param  Private       XHCI private data.
+  @param  Port          Root port number (0-based).
+
+  @retval EFI_SUCCESS       Block I/O installed for the device.
+  @retval EFI_NOT_FOUND     No device slot on the port.
+  @retval EFI_UNSUPPORTED   Not a bulk-only mass storage device.
+  @retval others            Enumeration failed.
+**/
+EFI_STATUS
+XhciProbeBootStorage (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port
+  )
+{
+  XHCI_DEVICE               *Device;
+  USB_DEVICE_DESCRIPTOR     *DevDesc;
+  USB_CONFIG_DESCRIPTOR     *Config;
+  USB_INTERFACE_DESCRIPTOR  *Interface;
+  USB_ENDPOINT_DESCRIPTOR   *Endpoint;
+  EFI_STATUS                Status;
+  UINT8                     *Buffer;
+  UINT8                     *Desc;
+  UINT8                     *End;
+  UINT8                     Address;
+  UINT8                     InterfaceNumber;
+  UINT8                     BulkIn;
+  UINT8                     BulkOut;
+  UINT16                    MaxPacketIn;
+  UINT16                    MaxPacketOut;
+  BOOLEAN                   Found;
+
+  XhciStorageRemove (Private, Port);
+
+  Device = XhciDeviceFromPort (Private, Port);
+  if (Device == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  Buffer = AllocatePages (1);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The first eight bytes give the real EP0 packet size before anything
+  // longer is asked for.
+  //
+  if (Device->BusAddress == 0) {
+    //
+    // Several ports may have come up at once; address 0 is whichever
+    // device is being enumerated.
+    //
+    Private->AddressMap[0] = Device->SlotId;
+
+    Status = XhciStorageControl (Private, Device, USB_DEV_GET_DESCRIPTOR_REQ_TYPE, USB_DEV_GET_DESCRIPTOR,
+                                 USB_DESC_TYPE_DEVICE << 8, 0, Buffer, 8);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    for (Address = 1; Address < ARRAY_SIZE (Private->AddressMap); Address++) {
+      if (Private->AddressMap[Address] == 0) {
+        break;
+      }
+    }
+    if (Address == ARRAY_SIZE (Private->AddressMap)) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+
+    Status = XhciStorageControl (Private, Device, USB_DEV_SET_ADDRESS_REQ_TYPE, USB_DEV_SET_ADDRESS,
+                                 Address, 0, NULL, 0);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  Status = XhciStorageControl (Private, Device, USB_DEV_GET_DESCRIPTOR_REQ_TYPE, USB_DEV_GET_DESCRIPTOR,
+                               USB_DESC_TYPE_DEVICE << 8, 0, Buffer, sizeof (USB_DEVICE_DESCRIPTOR));
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+  DevDesc = (USB_DEVICE_DESCRIPTOR *)Buffer;
+  if (DevDesc->NumConfigurations == 0) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  Status = XhciStorageControl (Private, Device, USB_DEV_GET_DESCRIPTOR_REQ_TYPE, USB_DEV_GET_DESCRIPTOR,
+                               USB_DESC_TYPE_CONFIG << 8, 0, Buffer, sizeof (USB_CONFIG_DESCRIPTOR));
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+  Config = (USB_CONFIG_DESCRIPTOR *)Buffer;
+  if ((Config->TotalLength < sizeof (USB_CONFIG_DESCRIPTOR)) || (Config->TotalLength > EFI_PAGE_SIZE)) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  Status = XhciStorageControl (Private, Device, USB_DEV_GET_DESCRIPTOR_REQ_TYPE, USB_DEV_GET_DESCRIPTOR,
+                               USB_DESC_TYPE_CONFIG << 8, 0, Buffer, Config->TotalLength);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  //
+  // Look for a SCSI bulk-only interface in its default setting. UAS
+  // devices offer one too, as alternate setting 0.
+  //
+  Found           = FALSE;
+  InterfaceNumber = 0;
+  BulkIn          = 0;
+  BulkOut         = 0;
+  MaxPacketIn     = 0;
+  MaxPacketOut    = 0;
+  Desc            = Buffer + Config->Length;
+  End             = Buffer + Config->TotalLength;
+  while ((Desc + 2 <= End) && (Desc[0] >= 2) && (Desc + Desc[0] <= End)) {
+    if (Desc[1] == USB_DESC_TYPE_INTERFACE) {
+      if (Found) {
+        break;
+      }
+      Interface = (USB_INTERFACE_DESCRIPTOR *)Desc;
+      if ((Interface->AlternateSetting == 0) &&
+          (Interface->InterfaceClass == USB_MASS_STORE_CLASS) &&
+          (Interface->InterfaceSubClass == XHCI_MASS_STORAGE_SCSI) &&
+          (Interface->InterfaceProtocol == XHCI_MASS_STORAGE_BOT))
+      {
+        Found           = TRUE;
+        InterfaceNumber = Interface->InterfaceNumber;
+      }
+    } else if (Found && (Desc[1] == USB_DESC_TYPE_ENDPOINT)) {
+      Endpoint = (USB_ENDPOINT_DESCRIPTOR *)Desc;
+      if ((Endpoint->Attributes & USB_ENDPOINT_TYPE_MASK) == USB_ENDPOINT_BULK) {
+        if ((Endpoint->EndpointAddress & USB_ENDPOINT_DIR_IN) != 0) {
+          BulkIn      = Endpoint->EndpointAddress;
+          MaxPacketIn = Endpoint->MaxPacketSize & 0x7FF;
+        } else {
+          BulkOut      = Endpoint->EndpointAddress;
+          MaxPacketOut = Endpoint->MaxPacketSize & 0x7FF;
+        }
+      }
+    }
+    Desc += Desc[0];
+  }
+
+  if (!Found || (BulkIn == 0) || (BulkOut == 0)) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  Status = XhciStorageControl (Private, Device, USB_DEV_SET_CONFIGURATION_REQ_TYPE, USB_DEV_SET_CONFIGURATION,
+                               Config->ConfigurationValue, 0, NULL, 0);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = XhciStorageCreate (Private, Device, InterfaceNumber, BulkIn, MaxPacketIn, BulkOut, MaxPacketOut);
+
+Done:
+  FreePages (Buffer, 1);
+  return Status;
+}
@@ -0,0 +1,362 @@
+/** @file
+  RP1 XHCI root port manager.
+
+  Port Status Change events are the only source of port state: each one
+  snapshots PORTSC, latches its change bits for the bus driver and clears
+  them in hardware so that the next change raises a new event. Ports are
+  reset together and devices are enumerated in the order their ports
+  come up, so one slow device no longer holds back the others.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+/**
+  Enumerate the root ports again after a hot-plug change.
+
+  @param  Event         Hot-plug event.
+  @param  Context       XHCI private data.
+**/
+STATIC
+VOID
+EFIAPI
+XhciHotPlugNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  XhciEnumerateRootPorts (Context);
+}
+
+/**
+  Create the event that enumerates the root ports again after a hot-plug
+  change. Until it exists, changes are only tracked.
+
+  @param  Private       XHCI private data.
+
+  @retval EFI_SUCCESS   Hot-plug enumeration enabled.
+  @retval others        Event could not be created.
+**/
+EFI_STATUS
+XhciInitPorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  return gBS->CreateEvent (
+                EVT_NOTIFY_SIGNAL,
+                TPL_CALLBACK,
+                XhciHotPlugNotify,
+                Private,
+                &Private->HotPlugEvent
+                );
+}
+
+/**
+  Snapshot a root port, latch and clear its change bits and bring the
+  port maps up to date.
+
+  @param  Private       XHCI private data.
+  @param  Port          Root port number (0-based).
+
+  @return PORTSC value read.
+**/
+UINT32
+XhciUpdatePort (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT8              Port
+  )
+{
+  UINT32  Offset;
+  UINT32  PortSc;
+  UINT32  Change;
+  UINT32  Bit;
+
+  Offset = XHCI_PORTSC + (Port * 0x10);
+  PortSc = XhciReadOpReg (Private, Offset);
+  Change = PortSc & XHCI_PORT_CHANGE_MASK;
+  if (Change != 0) {
+    XhciWriteOpReg (Private, Offset, (PortSc & ~XHCI_PORT_WRITE_MASK) | Change);
+    Private->PortChange[Port] |= Change;
+  }
+
+  Bit = 1U << Port;
+
+  //
+  // A connect change means a different device may be there now.
+  //
+  if (((PortSc & XHCI_PORT_CCS) == 0) || ((Change & XHCI_PORT_CSC) != 0)) {
+    Private->ProbedPorts &= ~Bit;
+  }
+
+  if ((PortSc & XHCI_PORT_CCS) != 0) {
+    Private->ConnectedPorts |= Bit;
+  } else {
+    Private->ConnectedPorts &= ~Bit;
+  }
+
+  if ((PortSc & XHCI_PORT_PR) == 0) {
+    Private->ResettingPorts &= ~Bit;
+  }
+
+  if ((PortSc & (XHCI_PORT_CCS | XHCI_PORT_PED | XHCI_PORT_PR)) == (XHCI_PORT_CCS | XHCI_PORT_PED)) {
+    Private->ReadyPorts |= Bit;
+  } else {
+    Private->ReadyPorts &= ~Bit;
+  }
+
+  return PortSc;
+}
+
+/**
+  Handle a Port Status Change event. Slot work is left to
+  XhciServicePorts(), as it needs commands that cannot be issued from
+  inside the event ring.
+
+  @param  Private       XHCI private data.
+  @param  Event         Copy of the event TRB.
+**/
+VOID
+XhciHandlePortStatusEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+  UINT32  PortId;
+
+  PortId = (UINT32)TRB_GET_PORT_ID (Event->Parameter);
+  if ((PortId == 0) || (PortId > Private->MaxPorts)) {
+    DEBUG ((DEBUG_WARN, "[XHCI] Status change on unknown port %d\n", PortId));
+    return;
+  }
+
+  XhciUpdatePort (Private, (UINT8)(PortId - 1));
+  Private->ChangedPorts |= 1U << (PortId - 1);
+}
+
+/**
+  Create and release device slots for the ports that changed since the
+  last call, and schedule enumeration when a device has arrived.
+
+  Called with the event ring drained, at XHCI_TPL.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+XhciServicePorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  UINT32  Changed;
+  UINT32  PortSc;
+  UINT8   Port;
+
+  Changed               = Private->ChangedPorts;
+  Private->ChangedPorts = 0;
+  if (Changed == 0) {
+    return;
+  }
+
+  for (Port = 0; Port < Private->MaxPorts; Port++) {
+    if ((Changed & (1U << Port)) == 0) {
+      continue;
+    }
+
+    PortSc = XhciReadOpReg (Private, XHCI_PORTSC + (Port * 0x10));
+    DEBUG ((DEBUG_VERBOSE, "[XHCI] Port %d: PORTSC 0x%08x, changes 0x%08x\n",
+            Port + 1, PortSc, Private->PortChange[Port]));
+    XhciPollPortStatusChange (Private, Port, PortSc);
+  }
+
+  if ((Private->HotPlugEvent != NULL) &&
+      ((Private->ConnectedPorts & ~Private->ProbedPorts & ~Private->ResettingPorts) != 0))
+  {
+    gBS->SignalEvent (Private->HotPlugEvent);
+  }
+}
+
+/**
+  Start a reset on every connected port of the map that is not enabled
+  yet. The resets run concurrently; completion is reported through Port
+  Status Change events.
+
+  @param  Private       XHCI private data.
+  @param  PortMap       Ports to reset, one bit per root port.
+
+  @return Ports now resetting.
+**/
+UINT32
+XhciResetPorts (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             PortMap
+  )
+{
+  UINT32  Offset;
+  UINT32  PortSc;
+  UINT32  Started;
+  UINT8   Port;
+
+  Started = 0;
+  for (Port = 0; Port < Private->MaxPorts; Port++) {
+    if ((PortMap & (1U << Port)) == 0) {
+      continue;
+    }
+
+    //
+    // USB3 ports enable themselves once the link trains; USB2 ports need
+    // a reset first.
+    //
+    PortSc = XhciUpdatePort (Private, Port);
+    if (((PortSc & XHCI_PORT_CCS) == 0) || ((PortSc & (XHCI_PORT_PED | XHCI_PORT_PR)) != 0)) {
+      continue;
+    }
+
+    Offset = XHCI_PORTSC + (Port * 0x10);
+    XhciWriteOpReg (Private, Offset, (PortSc & ~XHCI_PORT_WRITE_MASK) | XHCI_PORT_PR);
+    Started |= 1U << Port;
+  }
+
+  Private->ResettingPorts |= Started;
+  return Started;
+}
+
+//
+// Condition context of XhciWaitPortReady()
+//
+typedef struct {
+  XHCI_PRIVATE_DATA  *Private;
+  UINT32             PortMap;
+  UINT32             Ready;
+} XHCI_PORT_WAIT;
+
+/**
+  Return TRUE once a port of the set is ready.
+
+  The periodic timer normally delivers the port events first; reading the
+  ports as well covers a controller that is slow to post them.
+
+  @param  Context       XHCI_PORT_WAIT.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+XhciPortReadyCondition (
+  IN VOID  *Context
+  )
+{
+  XHCI_PORT_WAIT  *Wait;
+  EFI_TPL         OldTpl;
+  UINT8           Index;
+
+  Wait   = Context;
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+  XhciProcessEventRing (Wait->Private);
+  for (Index = 0; Index < Wait->Private->MaxPorts; Index++) {
+    if ((Wait->PortMap & (1U << Index)) != 0) {
+      XhciUpdatePort (Wait->Private, Index);
+    }
+  }
+  Wait->Ready = Wait->Private->ReadyPorts & Wait->PortMap;
+  gBS->RestoreTPL (OldTpl);
+
+  return (BOOLEAN)(Wait->Ready != 0);
+}
+
+/**
+  Wait for the first port of a set to become ready.
+
+  @param  Private       XHCI private data.
+  @param  PortMap       Ports waited for, one bit per root port.
+  @param  Timeout       On input the time left, in microseconds; on output
+                        what remains of it.
+  @param  Port          First ready port (0-based).
+
+  @retval EFI_SUCCESS   A port is ready.
+  @retval EFI_TIMEOUT   None of the ports came up in time.
+**/
+EFI_STATUS
+XhciWaitPortReady (
+  IN     XHCI_PRIVATE_DATA  *Private,
+  IN     UINT32             PortMap,
+  IN OUT UINTN              *Timeout,
+  OUT    UINT8              *Port
+  )
+{
+  XHCI_PORT_WAIT  Wait;
+  EFI_STATUS      Status;
+  UINT64          Elapsed;
+
+  Wait.Private = Private;
+  Wait.PortMap = PortMap;
+
+  Status   = PlatformWaitCondition (XhciPortReadyCondition, &Wait, *Timeout, &Elapsed);
+  *Timeout = (Elapsed < *Timeout) ? (UINTN)(*Timeout - Elapsed) : 0;
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *Port = (UINT8)LowBitSet32 (Wait.Ready);
+  DEBUG ((DEBUG_VERBOSE, "[XHCI] Port %d ready after %Lu us\n", *Port + 1, Elapsed));
+  return EFI_SUCCESS;
+}
+
+/**
+  Bring up the devices connected to root ports that have not been looked
+  at yet: all their ports are reset at once and each device is enumerated
+  as soon as its own port is ready, bulk-only mass storage devices getting
+  the boot path attached.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+XhciEnumerateRootPorts (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+  EFI_TPL     PortTpl;
+  UINT32      Pending;
+  UINTN       Timeout;
+  UINT8       Port;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  PortTpl = gBS->RaiseTPL (XHCI_TPL);
+  for (Port = 0; Port < Private->MaxPorts; Port++) {
+    XhciUpdatePort (Private, Port);
+  }
+  Pending = Private->ConnectedPorts & ~Private->ProbedPorts;
+  XhciResetPorts (Private, Pending & ~Private->ReadyPorts);
+  gBS->RestoreTPL (PortTpl);
+
+  if (Pending != 0) {
+    DEBUG ((DEBUG_INFO, "[XHCI] Ports 0x%x connected, 0x%x ready, 0x%x resetting\n",
+            Pending, Private->ReadyPorts & Pending, Private->ResettingPorts & Pending));
+  }
+
+  Timeout = XHCI_PORT_RESET_TIMEOUT;
+  while (Pending != 0) {
+    Status = XhciWaitPortReady (Private, Pending, &Timeout, &Port);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "[XHCI] Ports 0x%x: reset timeout\n", Pending));
+      break;
+    }
+
+    Pending              &= ~(1U << Port);
+    Private->ProbedPorts |= 1U << Port;
+
+    PortTpl = gBS->RaiseTPL (XHCI_TPL);
+    XhciPollPortStatusChange (Private, Port, XhciReadOpReg (Private, XHCI_PORTSC + (Port * 0x10)));
+    gBS->RestoreTPL (PortTpl);
+
+    Status = XhciProbeBootStorage (Private, Port);
+    if (EFI_ERROR (Status) && (Status != EFI_UNSUPPORTED)) {
+      DEBUG ((DEBUG_WARN, "[XHCI] Port %d: boot storage probe failed: %r\n", Port + 1, Status));
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+}
@@ -0,0 +1,162 @@
+/** @file
+  RP1 XHCI register access helpers.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+/**
+  Read an operational register.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the operational register base.
+
+  @return Register value.
+**/
+UINT32
+XhciReadOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset
+  )
+{
+  return PlatformMmioRead32 (Private->OpBase + Offset);
+}
+
+/**
+  Write an operational register.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the operational register base.
+  @param  Data          Value to write.
+**/
+VOID
+XhciWriteOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Data
+  )
+{
+  PlatformMmioWrite32 (Private->OpBase + Offset, Data);
+}
+
+/**
+  Write a 64-bit operational register with one access.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the operational register base.
+  @param  Data          Value to write.
+**/
+VOID
+XhciWriteOpReg64 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT64             Data
+  )
+{
+  PlatformMmioWrite64 (Private->OpBase + Offset, Data);
+}
+
+/**
+  Read a runtime register.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the runtime register base.
+
+  @return Register value.
+**/
+UINT32
+XhciReadRuntimeReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset
+  )
+{
+  return PlatformMmioRead32 (Private->RtBase + Offset);
+}
+
+/**
+  Write a runtime register.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the runtime register base.
+  @param  Data          Value to write.
+**/
+VOID
+XhciWriteRuntimeReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Data
+  )
+{
+  PlatformMmioWrite32 (Private->RtBase + Offset, Data);
+}
+
+/**
+  Write a 64-bit runtime register with one access.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the runtime register base.
+  @param  Data          Value to write.
+**/
+VOID
+XhciWriteRuntimeReg64 (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT64             Data
+  )
+{
+  PlatformMmioWrite64 (Private->RtBase + Offset, Data);
+}
+
+/**
+  Ring a doorbell. Slot 0 is the host controller (command ring).
+
+  @param  Private       XHCI private data.
+  @param  SlotId        Device slot, or 0 for the command ring.
+  @param  Target        Doorbell target (endpoint DCI, or 0).
+**/
+VOID
+XhciRingDoorbell (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             SlotId,
+  IN UINT32             Target
+  )
+{
+  //
+  // The write is ordered after the TRBs, so the controller fetches them
+  // complete.
+  //
+  PlatformMmioWrite32 (Private->DbBase + SlotId * sizeof (UINT32), Target);
+}
+
+/**
+  Wait for the masked bits of an operational register to equal Value.
+
+  @param  Private       XHCI private data.
+  @param  Offset        Offset from the operational register base.
+  @param  Mask          Bits to test.
+  @param  Value         Expected value of the masked bits.
+  @param  Timeout       Timeout in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+XhciWaitOpReg (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN UINT32             Offset,
+  IN UINT32             Mask,
+  IN UINT32             Value,
+  IN UINTN              Timeout
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Elapsed;
+
+  Status = PlatformWaitMmio32 (Private->OpBase + Offset, Mask, Value, Timeout, &Elapsed);
+  DEBUG ((DEBUG_VERBOSE, "[XHCI] Op reg 0x%x & 0x%08x == 0x%08x: %r after %Lu us\n",
+          Offset, Mask, Value, Status, Elapsed));
+  return Status;
+}
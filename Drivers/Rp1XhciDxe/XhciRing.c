@@ -0,0 +1,700 @@
+/** @file
+  RP1 XHCI ring engine: command, transfer and event rings.
+
+  Producer rings are built from segments laid out back to back, each
+  closed by a link TRB; the last link toggles the producer cycle state.
+  The event ring is consumed in batches and the dequeue pointer is handed
+  back to the controller once per batch. Host/XhciRingTest.c builds this
+  file unchanged against a software controller.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+#define XHCI_TRBS_PER_CACHE_LINE  (XHCI_CACHE_LINE_SIZE / sizeof (XHCI_TRB))
+
+/**
+  Allocate the shared DMA block, the scratchpad buffers and set up the
+  software state of the command and event rings.
+
+  @param  Private       XHCI private data.
+
+  @retval EFI_SUCCESS           Rings allocated.
+  @retval EFI_OUT_OF_RESOURCES  Allocation failed.
+**/
+EFI_STATUS
+XhciAllocateRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  UINTN   Index;
+  UINTN   BufferPages;
+  UINT8   *Buffer;
+
+  Private->DmaPages = EFI_SIZE_TO_PAGES (sizeof (XHCI_DMA_BLOCK));
+  Private->DmaBlock = AllocateAlignedPages (Private->DmaPages, EFI_PAGE_SIZE);
+  if (Private->DmaBlock == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem (Private->DmaBlock, EFI_PAGES_TO_SIZE (Private->DmaPages));
+  Private->Dcbaa = Private->DmaBlock->Dcbaa;
+
+  if (Private->MaxScratchpads > 0) {
+    Private->ScratchpadArray = AllocateAlignedPages (
+                                 EFI_SIZE_TO_PAGES (Private->MaxScratchpads * sizeof (UINT64)),
+                                 XHCI_CACHE_LINE_SIZE
+                                 );
+    BufferPages = Private->MaxScratchpads * EFI_SIZE_TO_PAGES (Private->PageSize);
+    Private->ScratchpadBuffers = AllocateAlignedPages (BufferPages, Private->PageSize);
+    if ((Private->ScratchpadArray == NULL) || (Private->ScratchpadBuffers == NULL)) {
+      XhciFreeRings (Private);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Buffer = Private->ScratchpadBuffers;
+    ZeroMem (Buffer, EFI_PAGES_TO_SIZE (BufferPages));
+    for (Index = 0; Index < Private->MaxScratchpads; Index++) {
+      Private->ScratchpadArray[Index] = XHCI_DMA_ADDRESS (Buffer + Index * Private->PageSize);
+    }
+    WriteBackDataCacheRange (Private->ScratchpadArray, Private->MaxScratchpads * sizeof (UINT64));
+    WriteBackDataCacheRange (Buffer, EFI_PAGES_TO_SIZE (BufferPages));
+  }
+
+  DEBUG ((DEBUG_INFO, "[XHCI] Ring block at 0x%p (%d pages), %d scratchpads\n",
+          Private->DmaBlock, Private->DmaPages, Private->MaxScratchpads));
+  return EFI_SUCCESS;
+}
+
+/**
+  Release everything allocated by XhciAllocateRings.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+XhciFreeRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  if (Private->ScratchpadBuffers != NULL) {
+    FreeAlignedPages (
+      Private->ScratchpadBuffers,
+      Private->MaxScratchpads * EFI_SIZE_TO_PAGES (Private->PageSize)
+      );
+    Private->ScratchpadBuffers = NULL;
+  }
+  if (Private->ScratchpadArray != NULL) {
+    FreeAlignedPages (
+      Private->ScratchpadArray,
+      EFI_SIZE_TO_PAGES (Private->MaxScratchpads * sizeof (UINT64))
+      );
+    Private->ScratchpadArray = NULL;
+  }
+  if (Private->DmaBlock != NULL) {
+    FreeAlignedPages (Private->DmaBlock, Private->DmaPages);
+    Private->DmaBlock = NULL;
+    Private->Dcbaa    = NULL;
+  }
+}
+
+/**
+  Initialize a producer ring over pre-allocated, contiguous segments and
+  chain the segments together with link TRBs.
+
+  @param  Ring          Ring to initialize.
+  @param  Trbs          First TRB of the first segment.
+  @param  NumSegments   Number of segments.
+  @param  SegmentTrbs   TRBs per segment, including the link TRB.
+**/
+VOID
+XhciInitProducerRing (
+  IN OUT XHCI_RING  *Ring,
+  IN     XHCI_TRB   *Trbs,
+  IN     UINT32     NumSegments,
+  IN     UINT32     SegmentTrbs
+  )
+{
+  UINT32    Segment;
+  XHCI_TRB  *Link;
+
+  ZeroMem (Trbs, NumSegments * SegmentTrbs * sizeof (XHCI_TRB));
+
+  for (Segment = 0; Segment < NumSegments; Segment++) {
+    Link            = &Trbs[Segment * SegmentTrbs + SegmentTrbs - 1];
+    Link->Parameter = XHCI_DMA_ADDRESS (&Trbs[((Segment + 1) % NumSegments) * SegmentTrbs]);
+    Link->Control   = TRB_TYPE (TRB_TYPE_LINK);
+    if (Segment == NumSegments - 1) {
+      Link->Control |= TRB_TOGGLE_CYCLE;
+    }
+  }
+
+  Ring->Trbs        = Trbs;
+  Ring->NumSegments = NumSegments;
+  Ring->SegmentTrbs = SegmentTrbs;
+  Ring->Enqueue     = 0;
+  Ring->Dequeue     = 0;
+  Ring->Cycle       = 1;
+
+  WriteBackDataCacheRange (Trbs, NumSegments * SegmentTrbs * sizeof (XHCI_TRB));
+}
+
+/**
+  Reset the software ring state and hand the DCBAA, command ring and event
+  ring to the controller. Must be called while the controller is halted.
+
+  @param  Private       XHCI private data.
+**/
+VOID
+XhciProgramRings (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XHCI_DMA_BLOCK  *Block;
+  UINT32          Segment;
+
+  Block = Private->DmaBlock;
+
+  XhciInitProducerRing (
+    &Private->CommandRing,
+    Block->CommandRing,
+    XHCI_CMD_RING_SEGMENTS,
+    XHCI_RING_SEGMENT_TRBS
+    );
+  ZeroMem (Private->CmdResults, sizeof (Private->CmdResults));
+
+  ZeroMem (Block->EventRing, sizeof (Block->EventRing));
+  for (Segment = 0; Segment < XHCI_EVENT_RING_SEGMENTS; Segment++) {
+    Block->Erst[Segment].SegmentBase =
+      XHCI_DMA_ADDRESS (&Block->EventRing[Segment * XHCI_EVENT_RING_SEGMENT_TRBS]);
+    Block->Erst[Segment].SegmentSize = XHCI_EVENT_RING_SEGMENT_TRBS;
+    Block->Erst[Segment].Reserved    = 0;
+  }
+  Private->EventRing.Trbs      = Block->EventRing;
+  Private->EventRing.TotalTrbs = XHCI_EVENT_RING_TRBS;
+  Private->EventRing.Dequeue   = 0;
+  Private->EventRing.Cycle     = 1;
+
+  ZeroMem (Block->Dcbaa, sizeof (Block->Dcbaa));
+  if (Private->ScratchpadArray != NULL) {
+    Block->Dcbaa[0] = XHCI_DMA_ADDRESS (Private->ScratchpadArray);
+  }
+
+  //
+  // Push the whole block out once; the controller must never observe a
+  // stale line from a previous run.
+  //
+  WriteBackInvalidateDataCacheRange (Block, sizeof (XHCI_DMA_BLOCK));
+
+  XhciWriteOpReg (Private, XHCI_CONFIG, Private->MaxSlots);
+  XhciWriteOpReg64 (Private, XHCI_DCBAAP, XHCI_DMA_ADDRESS (Block->Dcbaa));
+  XhciWriteOpReg64 (
+    Private,
+    XHCI_CRCR,
+    XHCI_DMA_ADDRESS (Block->CommandRing) | XHCI_CRCR_RCS
+    );
+
+  XhciWriteRuntimeReg (Private, XHCI_IR0 + XHCI_ERSTSZ, XHCI_EVENT_RING_SEGMENTS);
+  XhciWriteRuntimeReg64 (
+    Private,
+    XHCI_IR0 + XHCI_ERDP,
+    XHCI_DMA_ADDRESS (Block->EventRing) | XHCI_ERDP_EHB
+    );
+  //
+  // ERSTBA must be written last, it latches the event ring configuration.
+  //
+  XhciWriteRuntimeReg64 (Private, XHCI_IR0 + XHCI_ERSTBA, XHCI_DMA_ADDRESS (Block->Erst));
+  XhciWriteRuntimeReg (Private, XHCI_IR0 + XHCI_IMAN, XHCI_IMAN_IP | XHCI_IMAN_IE);
+}
+
+/**
+  Allocate and initialize a transfer ring for one endpoint. The ring fits
+  in a single page, so none of its segments crosses a 64KB boundary.
+
+  @return New ring, or NULL on allocation failure.
+**/
+XHCI_RING *
+XhciCreateTransferRing (
+  VOID
+  )
+{
+  XHCI_RING  *Ring;
+  XHCI_TRB   *Trbs;
+
+  Ring = AllocateZeroPool (sizeof (XHCI_RING));
+  if (Ring == NULL) {
+    return NULL;
+  }
+
+  Trbs = AllocateAlignedPages (
+           EFI_SIZE_TO_PAGES (XHCI_TRANSFER_RING_SEGMENTS * XHCI_RING_SEGMENT_TRBS * sizeof (XHCI_TRB)),
+           EFI_PAGE_SIZE
+           );
+  if (Trbs == NULL) {
+    FreePool (Ring);
+    return NULL;
+  }
+
+  XhciInitProducerRing (Ring, Trbs, XHCI_TRANSFER_RING_SEGMENTS, XHCI_RING_SEGMENT_TRBS);
+  return Ring;
+}
+
+/**
+  Free a ring created by XhciCreateTransferRing.
+
+  @param  Ring          Ring to free.
+**/
+VOID
+XhciFreeTransferRing (
+  IN XHCI_RING  *Ring
+  )
+{
+  FreeAlignedPages (
+    Ring->Trbs,
+    EFI_SIZE_TO_PAGES (XHCI_TRANSFER_RING_SEGMENTS * XHCI_RING_SEGMENT_TRBS * sizeof (XHCI_TRB))
+    );
+  FreePool (Ring);
+}
+
+/**
+  Return TRUE if Index is the link TRB of its segment.
+**/
+STATIC
+BOOLEAN
+XhciRingIsLink (
+  IN XHCI_RING  *Ring,
+  IN UINT32     Index
+  )
+{
+  return (BOOLEAN)((Index % Ring->SegmentTrbs) == Ring->SegmentTrbs - 1);
+}
+
+/**
+  Return the number of TRBs that can still be enqueued on a producer ring.
+
+  @param  Ring          Producer ring.
+
+  @return Free TRB count, excluding link TRBs.
+**/
+UINT32
+XhciRingFreeCount (
+  IN XHCI_RING  *Ring
+  )
+{
+  UINT32  Total;
+  UINT32  Used;
+  UINT32  Links;
+
+  Total = Ring->NumSegments * Ring->SegmentTrbs;
+  Used  = (Ring->Enqueue + Total - Ring->Dequeue) % Total;
+
+  if ((Ring->Enqueue / Ring->SegmentTrbs == Ring->Dequeue / Ring->SegmentTrbs) &&
+      (Ring->Enqueue < Ring->Dequeue))
+  {
+    Links = Ring->NumSegments;
+  } else {
+    Links = (Ring->Enqueue / Ring->SegmentTrbs + Ring->NumSegments -
+             Ring->Dequeue / Ring->SegmentTrbs) % Ring->NumSegments;
+  }
+
+  //
+  // One slot is always kept empty so that a full ring can be told apart
+  // from an empty one.
+  //
+  return Total - Ring->NumSegments - (Used - Links) - 1;
+}
+
+/**
+  Place one TRB on a producer ring. The cycle bit of Trb is ignored and
+  replaced with the producer cycle state. Crossing a segment end hands the
+  link TRB to the controller, carrying the chain bit of the TRB before it.
+
+  The doorbell is not rung, so callers can queue any number of TRBs and
+  then ring once.
+
+  @param  Ring          Producer ring.
+  @param  Trb           TRB to copy onto the ring.
+  @param  Index         Optional ring index the TRB was written to.
+
+  @retval EFI_SUCCESS           TRB queued.
+  @retval EFI_OUT_OF_RESOURCES  Ring is full.
+**/
+EFI_STATUS
+XhciRingEnqueue (
+  IN OUT XHCI_RING  *Ring,
+  IN     XHCI_TRB   *Trb,
+  OUT    UINT32     *Index OPTIONAL
+  )
+{
+  XHCI_TRB  *Slot;
+  XHCI_TRB  *Link;
+
+  if (XhciRingFreeCount (Ring) == 0) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Slot            = &Ring->Trbs[Ring->Enqueue];
+  Slot->Parameter = Trb->Parameter;
+  Slot->Status    = Trb->Status;
+  MemoryFence ();
+  Slot->Control = (Trb->Control & ~TRB_CYCLE) | Ring->Cycle;
+  WriteBackDataCacheRange (Slot, sizeof (XHCI_TRB));
+
+  if (Index != NULL) {
+    *Index = Ring->Enqueue;
+  }
+
+  Ring->Enqueue++;
+  if (XhciRingIsLink (Ring, Ring->Enqueue)) {
+    Link          = &Ring->Trbs[Ring->Enqueue];
+    Link->Control = (Link->Control & ~(TRB_CYCLE | TRB_CHAIN)) |
+                    (Trb->Control & TRB_CHAIN) | Ring->Cycle;
+    WriteBackDataCacheRange (Link, sizeof (XHCI_TRB));
+
+    if ((Link->Control & TRB_TOGGLE_CYCLE) != 0) {
+      Ring->Cycle ^= 1;
+    }
+    Ring->Enqueue = (Ring->Enqueue + 1) % (Ring->NumSegments * Ring->SegmentTrbs);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Translate a TRB bus address reported in an event back to a ring index.
+
+  @param  Ring          Producer ring.
+  @param  DmaAddress    Bus address of the TRB.
+
+  @return Ring index, or MAX_UINT32 if the address is not on this ring.
+**/
+UINT32
+XhciRingIndexFromDma (
+  IN XHCI_RING  *Ring,
+  IN UINT64     DmaAddress
+  )
+{
+  UINT64  Base;
+  UINT64  Offset;
+
+  Base = XHCI_DMA_ADDRESS (Ring->Trbs);
+  if (DmaAddress < Base) {
+    return MAX_UINT32;
+  }
+
+  Offset = DmaAddress - Base;
+  if ((Offset % sizeof (XHCI_TRB)) != 0 ||
+      (Offset / sizeof (XHCI_TRB)) >= Ring->NumSegments * Ring->SegmentTrbs)
+  {
+    return MAX_UINT32;
+  }
+
+  return (UINT32)(Offset / sizeof (XHCI_TRB));
+}
+
+/**
+  Mark every TRB up to and including Index as consumed by the controller.
+
+  @param  Ring          Producer ring.
+  @param  Index         Index of the last consumed TRB.
+**/
+VOID
+XhciRingRetire (
+  IN OUT XHCI_RING  *Ring,
+  IN     UINT32     Index
+  )
+{
+  Ring->Dequeue = (Index + 1) % (Ring->NumSegments * Ring->SegmentTrbs);
+  if (XhciRingIsLink (Ring, Ring->Dequeue)) {
+    Ring->Dequeue = (Ring->Dequeue + 1) % (Ring->NumSegments * Ring->SegmentTrbs);
+  }
+}
+
+/**
+  Dispatch one event TRB.
+
+  @param  Private       XHCI private data.
+  @param  Event         Copy of the event TRB.
+**/
+STATIC
+VOID
+XhciHandleEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+  UINT32           Index;
+  XHCI_CMD_RESULT  *Result;
+
+  switch (TRB_GET_TYPE (Event->Control)) {
+  case TRB_TYPE_COMMAND_COMPLT_EVENT:
+    //
+    // After an abort the ring reports where it stopped: the next command
+    // to run, which has not been consumed.
+    //
+    if (TRB_GET_COMPLETION (Event->Status) == TRB_COMPLETION_COMMAND_RING_STOPPED) {
+      break;
+    }
+    Index = XhciRingIndexFromDma (&Private->CommandRing, Event->Parameter);
+    if (Index == MAX_UINT32) {
+      DEBUG ((DEBUG_WARN, "[XHCI] Completion for unknown command 0x%lx\n", Event->Parameter));
+      break;
+    }
+    Result                 = &Private->CmdResults[Index];
+    Result->CompletionCode = (UINT8)TRB_GET_COMPLETION (Event->Status);
+    Result->SlotId         = (UINT8)TRB_GET_SLOT_ID (Event->Control);
+    Result->Parameter      = Event->Status & 0xFFFFFF;
+    Result->Done           = TRUE;
+    XhciRingRetire (&Private->CommandRing, Index);
+    break;
+
+  case TRB_TYPE_TRANS_EVENT:
+    XhciHandleTransferEvent (Private, Event);
+    break;
+
+  case TRB_TYPE_PORT_STATUS_CHANGE:
+    XhciHandlePortStatusEvent (Private, Event);
+    break;
+
+  case TRB_TYPE_HOST_CONTROLLER:
+    DEBUG ((DEBUG_ERROR, "[XHCI] Host controller event, code %d\n",
+            TRB_GET_COMPLETION (Event->Status)));
+    break;
+
+  default:
+    DEBUG ((DEBUG_VERBOSE, "[XHCI] Unhandled event type %d\n", TRB_GET_TYPE (Event->Control)));
+    break;
+  }
+}
+
+/**
+  Drain up to XHCI_EVENT_BATCH events from the event ring, then publish the
+  new dequeue pointer to the controller with a single register write.
+
+  The ring is invalidated one cache line at a time, so a batch of events
+  costs one cache maintenance operation per four TRBs.
+
+  @param  Private       XHCI private data.
+
+  @return Number of events processed.
+**/
+UINTN
+XhciProcessEventRing (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XHCI_EVENT_RING  *Ring;
+  XHCI_TRB         *Trb;
+  XHCI_TRB         Event;
+  UINTN            Count;
+
+  Ring = &Private->EventRing;
+
+  for (Count = 0; Count < XHCI_EVENT_BATCH; Count++) {
+    Trb = &Ring->Trbs[Ring->Dequeue];
+    if ((Count == 0) || ((Ring->Dequeue % XHCI_TRBS_PER_CACHE_LINE) == 0)) {
+      InvalidateDataCacheRange (
+        Trb - (Ring->Dequeue % XHCI_TRBS_PER_CACHE_LINE),
+        XHCI_CACHE_LINE_SIZE
+        );
+    }
+
+    if ((Trb->Control & TRB_CYCLE) != Ring->Cycle) {
+      break;
+    }
+
+    CopyMem (&Event, Trb, sizeof (XHCI_TRB));
+    XhciHandleEvent (Private, &Event);
+
+    Ring->Dequeue++;
+    if (Ring->Dequeue == Ring->TotalTrbs) {
+      Ring->Dequeue = 0;
+      Ring->Cycle  ^= 1;
+    }
+  }
+
+  if (Count > 0) {
+    XhciWriteRuntimeReg64 (
+      Private,
+      XHCI_IR0 + XHCI_ERDP,
+      XHCI_DMA_ADDRESS (&Ring->Trbs[Ring->Dequeue]) | XHCI_ERDP_EHB
+      );
+  }
+
+  return Count;
+}
+
+/**
+  Queue a command TRB without ringing the command doorbell.
+
+  @param  Private       XHCI private data.
+  @param  Trb           Command TRB.
+  @param  Index         Command ring index, used to wait for completion.
+
+  @retval EFI_SUCCESS           Command queued.
+  @retval EFI_OUT_OF_RESOURCES  Command ring is full.
+**/
+EFI_STATUS
+XhciCmdPost (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_TRB           *Trb,
+  OUT UINT32             *Index
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = XhciRingEnqueue (&Private->CommandRing, Trb, Index);
+  if (!EFI_ERROR (Status)) {
+    ZeroMem (&Private->CmdResults[*Index], sizeof (XHCI_CMD_RESULT));
+  }
+
+  return Status;
+}
+
+/**
+  Abort the command ring after a timeout so the next command starts from
+  a known state.
+
+  @param  Private       XHCI private data.
+**/
+STATIC
+VOID
+XhciCmdAbort (
+  IN XHCI_PRIVATE_DATA  *Private
+  )
+{
+  XhciWriteOpReg (Private, XHCI_CRCR, XHCI_CRCR_CA);
+  if (EFI_ERROR (XhciWaitOpReg (Private, XHCI_CRCR, XHCI_CRCR_CRR, 0, XHCI_COMMAND_TIMEOUT))) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Command ring abort timeout\n"));
+  }
+  XhciProcessEventRing (Private);
+}
+
+//
+// Completion flag polled by XhciWaitEvent.
+//
+typedef struct {
+  XHCI_PRIVATE_DATA  *Private;
+  BOOLEAN            *Done;
+} XHCI_EVENT_WAIT;
+
+/**
+  Drain the event ring and report whether the awaited completion arrived.
+
+  @param  Context       XHCI_EVENT_WAIT.
+
+  @retval TRUE          Completion arrived.
+  @retval FALSE         Keep waiting.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+XhciEventDone (
+  IN VOID  *Context
+  )
+{
+  XHCI_EVENT_WAIT  *Wait;
+
+  Wait = Context;
+  while (!*Wait->Done && (XhciProcessEventRing (Wait->Private) > 0)) {
+  }
+
+  return *Wait->Done;
+}
+
+/**
+  Drain the event ring until a completion flag is set. Time spent
+  draining counts against the timeout.
+
+  @param  Private       XHCI private data.
+  @param  Done          Flag set by the event handler on completion.
+  @param  Timeout       Timeout in microseconds, MAX_UINT64 to wait forever.
+
+  @retval EFI_SUCCESS   Flag set.
+  @retval EFI_TIMEOUT   Flag still clear at the timeout.
+**/
+EFI_STATUS
+XhciWaitEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN BOOLEAN            *Done,
+  IN UINT64             Timeout
+  )
+{
+  XHCI_EVENT_WAIT  Wait;
+
+  Wait.Private = Private;
+  Wait.Done    = Done;
+  return PlatformWaitConditionInterval (XhciEventDone, &Wait, Timeout, XHCI_POLL_INTERVAL, NULL);
+}
+
+/**
+  Wait for a posted command to complete, draining the event ring while
+  waiting so that other completions are not held back.
+
+  @param  Private       XHCI private data.
+  @param  Index         Index returned by XhciCmdPost.
+  @param  Timeout       Timeout in microseconds.
+  @param  Result        Optional copy of the completion record.
+
+  @retval EFI_SUCCESS       Command completed successfully.
+  @retval EFI_DEVICE_ERROR  Command completed with an error code.
+  @retval EFI_TIMEOUT       Command did not complete in time.
+**/
+EFI_STATUS
+XhciCmdWait (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  UINT32             Index,
+  IN  UINTN              Timeout,
+  OUT XHCI_CMD_RESULT    *Result OPTIONAL
+  )
+{
+  XHCI_CMD_RESULT  *Record;
+
+  Record = &Private->CmdResults[Index];
+
+  if (EFI_ERROR (XhciWaitEvent (Private, &Record->Done, Timeout))) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Command %d timeout\n", Index));
+    XhciCmdAbort (Private);
+    return EFI_TIMEOUT;
+  }
+
+  if (Result != NULL) {
+    CopyMem (Result, Record, sizeof (XHCI_CMD_RESULT));
+  }
+
+  if (Record->CompletionCode != TRB_COMPLETION_SUCCESS) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Command %d failed, code %d\n", Index, Record->CompletionCode));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Queue a single command, ring the command doorbell and wait for it.
+
+  @param  Private       XHCI private data.
+  @param  Trb           Command TRB.
+  @param  Result        Optional copy of the completion record.
+
+  @return Status of XhciCmdPost or XhciCmdWait.
+**/
+EFI_STATUS
+XhciCmdExecute (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_TRB           *Trb,
+  OUT XHCI_CMD_RESULT    *Result OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Index;
+
+  Status = XhciCmdPost (Private, Trb, &Index);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  XhciRingDoorbell (Private, 0, 0);
+  return XhciCmdWait (Private, Index, XHCI_COMMAND_TIMEOUT, Result);
+}
@@ -0,0 +1,1176 @@
+/** @file
+  RP1 XHCI transfer engine: control, bulk, interrupt and isochronous
+  transfers on top of the endpoint transfer rings.
+
+  Every transfer is tracked by an XHCI_URB that sits on the controller's
+  URB list while its TD is on a ring. Data buffers are split into TRBs at
+  64KB boundaries and chained into one TD, so a single doorbell moves the
+  whole buffer. Synchronous transfers drain the event ring until their URB
+  completes; asynchronous interrupt transfers stay on the list and are
+  serviced by one periodic timer that drains the event ring once per tick
+  for every endpoint.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Rp1XhciDxe.h"
+
+/**
+  Return the number of TRBs needed to describe a buffer without any TRB
+  crossing a 64KB boundary.
+
+  @param  Data          Buffer.
+  @param  Length        Buffer length in bytes.
+
+  @return TRB count; a zero-length buffer still takes one TRB.
+**/
+STATIC
+UINT32
+XhciCountDataTrbs (
+  IN VOID   *Data,
+  IN UINTN  Length
+  )
+{
+  UINT64  Start;
+
+  if (Length == 0) {
+    return 1;
+  }
+
+  Start = XHCI_DMA_ADDRESS (Data);
+  return (UINT32)(((Start + Length - 1) / XHCI_TRB_MAX_LENGTH) - (Start / XHCI_TRB_MAX_LENGTH) + 1);
+}
+
+/**
+  Return the number of TRBs the TD(s) of an URB take on its ring.
+
+  @param  Urb           URB.
+
+  @return TRB count.
+**/
+STATIC
+UINT32
+XhciCountUrbTrbs (
+  IN XHCI_URB  *Urb
+  )
+{
+  UINT32  Count;
+  UINTN   Offset;
+  UINTN   Length;
+
+  if (Urb->Request != NULL) {
+    Count = 2;
+    if (Urb->DataLength > 0) {
+      Count += XhciCountDataTrbs (Urb->Data, Urb->DataLength);
+    }
+    return Count;
+  }
+
+  if (Urb->TdLength == 0) {
+    return XhciCountDataTrbs (Urb->Data, Urb->DataLength);
+  }
+
+  Count = 0;
+  for (Offset = 0; Offset < Urb->DataLength; Offset += Length) {
+    Length = MIN (Urb->TdLength, Urb->DataLength - Offset);
+    Count += XhciCountDataTrbs ((UINT8 *)Urb->Data + Offset, Length);
+  }
+  return Count;
+}
+
+/**
+  Queue the TRBs describing one data buffer. Every TRB but the last one
+  carries the chain bit; the first one takes FirstControl as its type and
+  flags, the others are normal TRBs. The caller has checked that the ring
+  has room.
+
+  @param  Ring          Transfer ring.
+  @param  FirstControl  Type and flags of the first TRB.
+  @param  Flags         Flags applied to every TRB.
+  @param  LastFlags     Flags applied to the last TRB only.
+  @param  Data          Buffer.
+  @param  Length        Buffer length in bytes.
+  @param  MaxPacket     Endpoint max packet size, for the TD size field.
+  @param  FirstIndex    Optional ring index of the first TRB.
+  @param  LastIndex     Ring index of the last TRB.
+**/
+STATIC
+VOID
+XhciQueueDataTrbs (
+  IN OUT XHCI_RING  *Ring,
+  IN     UINT32     FirstControl,
+  IN     UINT32     Flags,
+  IN     UINT32     LastFlags,
+  IN     UINT8      *Data,
+  IN     UINTN      Length,
+  IN     UINTN      MaxPacket,
+  OUT    UINT32     *FirstIndex OPTIONAL,
+  OUT    UINT32     *LastIndex
+  )
+{
+  XHCI_TRB  Trb;
+  UINT64    Address;
+  UINTN     Offset;
+  UINTN     Chunk;
+  UINTN     Remaining;
+  UINT32    Index;
+
+  MaxPacket = MAX (MaxPacket, 1);
+  Offset    = 0;
+  do {
+    Address   = (Length > 0) ? XHCI_DMA_ADDRESS (Data + Offset) : 0;
+    Chunk     = MIN (Length - Offset, XHCI_TRB_MAX_LENGTH - (UINTN)(Address & (XHCI_TRB_MAX_LENGTH - 1)));
+    Remaining = Length - Offset - Chunk;
+
+    Trb.Parameter = Address;
+    Trb.Status    = TRB_LENGTH (Chunk) | TRB_TD_SIZE ((Remaining + MaxPacket - 1) / MaxPacket);
+    Trb.Control   = ((Offset == 0) ? FirstControl : TRB_TYPE (TRB_TYPE_NORMAL)) | Flags |
+                    ((Remaining > 0) ? TRB_CHAIN : LastFlags);
+    XhciRingEnqueue (Ring, &Trb, &Index);
+
+    if ((Offset == 0) && (FirstIndex != NULL)) {
+      *FirstIndex = Index;
+    }
+    Offset += Chunk;
+  } while (Offset < Length);
+
+  *LastIndex = Index;
+}
+
+/**
+  Put the TD(s) of an URB on its endpoint ring, add the URB to the list
+  of transfers in flight and ring the endpoint doorbell once.
+
+  @param  Private       XHCI private data.
+  @param  Urb           URB to queue.
+
+  @retval EFI_SUCCESS           TD queued and doorbell rung.
+  @retval EFI_DEVICE_ERROR      Endpoint has no transfer ring.
+  @retval EFI_OUT_OF_RESOURCES  Ring does not have room for the TD.
+**/
+EFI_STATUS
+XhciQueueUrb (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_URB           *Urb
+  )
+{
+  XHCI_RING  *Ring;
+  XHCI_TRB   Trb;
+  UINT8      *Data;
+  UINTN      Offset;
+  UINTN      Length;
+  UINT32     Control;
+
+  Ring = Urb->Device->Rings[Urb->Dci];
+  if (Ring == NULL) {
+    return EFI_DEVICE_ERROR;
+  }
+  if (XhciRingFreeCount (Ring) < XhciCountUrbTrbs (Urb)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Data = Urb->Data;
+  if (Urb->DataLength > 0) {
+    if (Urb->DataIn) {
+      WriteBackInvalidateDataCacheRange (Data, Urb->DataLength);
+    } else {
+      WriteBackDataCacheRange (Data, Urb->DataLength);
+    }
+  }
+
+  if (Urb->Request != NULL) {
+    ZeroMem (&Trb, sizeof (Trb));
+    CopyMem (&Trb.Parameter, Urb->Request, sizeof (EFI_USB_DEVICE_REQUEST));
+    Trb.Status  = TRB_LENGTH (sizeof (EFI_USB_DEVICE_REQUEST));
+    Trb.Control = TRB_TYPE (TRB_TYPE_SETUP_STAGE) | TRB_IDT;
+    if (Urb->DataLength > 0) {
+      Trb.Control |= TRB_TRT (Urb->DataIn ? TRB_TRT_IN_DATA : TRB_TRT_OUT_DATA);
+    }
+    XhciRingEnqueue (Ring, &Trb, &Urb->FirstIndex);
+
+    if (Urb->DataLength > 0) {
+      XhciQueueDataTrbs (
+        Ring,
+        TRB_TYPE (TRB_TYPE_DATA_STAGE) | (Urb->DataIn ? TRB_DIR_IN : 0),
+        TRB_ISP,
+        0,
+        Data,
+        Urb->DataLength,
+        Urb->MaxPacket,
+        NULL,
+        &Urb->LastIndex
+        );
+    }
+
+    //
+    // The status stage runs opposite to the data stage, IN when there is
+    // no data stage.
+    //
+    ZeroMem (&Trb, sizeof (Trb));
+    Trb.Control = TRB_TYPE (TRB_TYPE_STATUS_STAGE) | TRB_IOC;
+    if ((Urb->DataLength == 0) || !Urb->DataIn) {
+      Trb.Control |= TRB_DIR_IN;
+    }
+    XhciRingEnqueue (Ring, &Trb, &Urb->LastIndex);
+  } else if (Urb->TdLength != 0) {
+    //
+    // Isochronous: one TD per service interval, scheduled as soon as
+    // possible. Only the last TD interrupts; short packets are normal.
+    //
+    for (Offset = 0; Offset < Urb->DataLength; Offset += Length) {
+      Length  = MIN (Urb->TdLength, Urb->DataLength - Offset);
+      Control = TRB_TYPE (TRB_TYPE_ISOCH) | TRB_SIA;
+      XhciQueueDataTrbs (
+        Ring,
+        Control,
+        0,
+        (Offset + Length == Urb->DataLength) ? TRB_IOC : 0,
+        Data + Offset,
+        Length,
+        Urb->MaxPacket,
+        (Offset == 0) ? &Urb->FirstIndex : NULL,
+        &Urb->LastIndex
+        );
+    }
+  } else {
+    XhciQueueDataTrbs (
+      Ring,
+      TRB_TYPE (TRB_TYPE_NORMAL),
+      TRB_ISP,
+      TRB_IOC,
+      Data,
+      Urb->DataLength,
+      Urb->MaxPacket,
+      &Urb->FirstIndex,
+      &Urb->LastIndex
+      );
+  }
+
+  Urb->Done           = FALSE;
+  Urb->LengthSet      = FALSE;
+  Urb->Completed      = 0;
+  Urb->CompletionCode = TRB_COMPLETION_INVALID;
+  InsertTailList (&Private->UrbList, &Urb->Link);
+
+  XhciRingDoorbell (Private, Urb->Device->SlotId, Urb->Dci);
+  return EFI_SUCCESS;
+}
+
+/**
+  Return TRUE if a ring index lies within the TD(s) of an URB.
+**/
+STATIC
+BOOLEAN
+XhciUrbOwnsIndex (
+  IN XHCI_RING  *Ring,
+  IN XHCI_URB   *Urb,
+  IN UINT32     Index
+  )
+{
+  UINT32  Total;
+
+  Total = Ring->NumSegments * Ring->SegmentTrbs;
+  return (BOOLEAN)(((Index + Total - Urb->FirstIndex) % Total) <=
+                   ((Urb->LastIndex + Total - Urb->FirstIndex) % Total));
+}
+
+/**
+  Count the bytes moved by an URB up to and including the TRB an event
+  reported on. Setup, status and link TRBs carry no data.
+
+  @param  Ring          Transfer ring.
+  @param  Urb           URB.
+  @param  EventIndex    Ring index of the TRB the event points to.
+  @param  Residual      Untransferred length reported in the event.
+
+  @return Bytes transferred.
+**/
+STATIC
+UINTN
+XhciUrbTransferred (
+  IN XHCI_RING  *Ring,
+  IN XHCI_URB   *Urb,
+  IN UINT32     EventIndex,
+  IN UINT32     Residual
+  )
+{
+  XHCI_TRB  *Trb;
+  UINT32    Total;
+  UINT32    Index;
+  UINT32    Type;
+  UINTN     Length;
+  UINTN     Transferred;
+
+  Total       = Ring->NumSegments * Ring->SegmentTrbs;
+  Transferred = 0;
+  for (Index = Urb->FirstIndex; ; Index = (Index + 1) % Total) {
+    Trb  = &Ring->Trbs[Index];
+    Type = TRB_GET_TYPE (Trb->Control);
+    if ((Type == TRB_TYPE_NORMAL) || (Type == TRB_TYPE_DATA_STAGE) || (Type == TRB_TYPE_ISOCH)) {
+      Length = TRB_LENGTH (Trb->Status);
+      if (Index == EventIndex) {
+        Length -= MIN (Residual, Length);
+      }
+      Transferred += Length;
+    }
+    if (Index == EventIndex) {
+      break;
+    }
+  }
+
+  return Transferred;
+}
+
+/**
+  Match a transfer event to the URB whose TD it reports on, record the
+  result and retire the TD from the ring once the URB is complete.
+
+  @param  Private       XHCI private data.
+  @param  Event         Copy of the transfer event TRB.
+**/
+VOID
+XhciHandleTransferEvent (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_TRB           *Event
+  )
+{
+  XHCI_DEVICE  *Device;
+  XHCI_RING    *Ring;
+  XHCI_URB     *Urb;
+  LIST_ENTRY   *Entry;
+  UINT32       Index;
+  UINT8        SlotId;
+  UINT8        Dci;
+  UINT8        Code;
+  BOOLEAN      Control;
+
+  SlotId = (UINT8)TRB_GET_SLOT_ID (Event->Control);
+  Dci    = (UINT8)TRB_GET_EP_ID (Event->Control);
+  Code   = (UINT8)TRB_GET_COMPLETION (Event->Status);
+
+  //
+  // Stop Endpoint reports the TRB it stopped on; whoever stopped the
+  // endpoint already owns the URB.
+  //
+  if ((Code == TRB_COMPLETION_STOPPED) || (Code == TRB_COMPLETION_STOPPED_LENGTH_INVALID)) {
+    return;
+  }
+
+  Device = Private->Devices[SlotId];
+  if ((Device == NULL) || (Device->Rings[Dci] == NULL)) {
+    return;
+  }
+
+  Ring  = Device->Rings[Dci];
+  Index = XhciRingIndexFromDma (Ring, Event->Parameter);
+  if (Index == MAX_UINT32) {
+    DEBUG ((DEBUG_WARN, "[XHCI] Transfer event for unknown TRB 0x%lx\n", Event->Parameter));
+    return;
+  }
+
+  for (Entry = GetFirstNode (&Private->UrbList);
+       !IsNull (&Private->UrbList, Entry);
+       Entry = GetNextNode (&Private->UrbList, Entry))
+  {
+    Urb = XHCI_URB_FROM_LINK (Entry);
+    if ((Urb->Device != Device) || (Urb->Dci != Dci) || Urb->Done ||
+        !XhciUrbOwnsIndex (Ring, Urb, Index))
+    {
+      continue;
+    }
+
+    Urb->CompletionCode = Code;
+    if (((Code == TRB_COMPLETION_SUCCESS) || (Code == TRB_COMPLETION_SHORT_PACKET)) && !Urb->LengthSet) {
+      Urb->Completed = XhciUrbTransferred (Ring, Urb, Index, TRB_GET_LENGTH (Event->Status));
+      Urb->LengthSet = (BOOLEAN)((Code == TRB_COMPLETION_SHORT_PACKET) || (Index == Urb->LastIndex));
+    }
+
+    //
+    // A short packet ends a normal TD at once, but a control TD still
+    // runs its status stage and reports again from there.
+    //
+    Control = (BOOLEAN)(TRB_GET_TYPE (Ring->Trbs[Urb->LastIndex].Control) == TRB_TYPE_STATUS_STAGE);
+    if ((Index == Urb->LastIndex) ||
+        ((Code != TRB_COMPLETION_SUCCESS) && (Code != TRB_COMPLETION_SHORT_PACKET)) ||
+        ((Code == TRB_COMPLETION_SHORT_PACKET) && !Control))
+    {
+      Urb->Done = TRUE;
+      XhciRingRetire (Ring, Urb->LastIndex);
+    }
+    return;
+  }
+}
+
+/**
+  Translate a completion code to an EFI_USB_ERR_* transfer result.
+**/
+STATIC
+UINT32
+XhciCompletionToResult (
+  IN UINT8  Code
+  )
+{
+  switch (Code) {
+  case TRB_COMPLETION_SUCCESS:
+  case TRB_COMPLETION_SHORT_PACKET:
+    return EFI_USB_NOERROR;
+  case TRB_COMPLETION_STALL_ERROR:
+    return EFI_USB_ERR_STALL;
+  case TRB_COMPLETION_BABBLE_ERROR:
+    return EFI_USB_ERR_BABBLE;
+  case TRB_COMPLETION_DATA_BUFFER_ERROR:
+    return EFI_USB_ERR_BUFFER;
+  case TRB_COMPLETION_USB_TRANSACTION_ERROR:
+    return EFI_USB_ERR_TIMEOUT;
+  default:
+    return EFI_USB_ERR_SYSTEM;
+  }
+}
+
+/**
+  Initialize an URB for one transfer on an endpoint.
+**/
+VOID
+XhciInitUrb (
+  OUT XHCI_URB                *Urb,
+  IN  XHCI_DEVICE             *Device,
+  IN  UINT8                   EpAddress,
+  IN  UINTN                   MaxPacket,
+  IN  EFI_USB_DEVICE_REQUEST  *Request OPTIONAL,
+  IN  VOID                    *Data,
+  IN  UINTN                   DataLength,
+  IN  BOOLEAN                 DataIn
+  )
+{
+  ZeroMem (Urb, sizeof (XHCI_URB));
+  Urb->Signature  = XHCI_URB_SIGNATURE;
+  Urb->Device     = Device;
+  Urb->EpAddress  = EpAddress;
+  Urb->Dci        = XHCI_ENDPOINT_TO_DCI (EpAddress);
+  Urb->MaxPacket  = (UINT16)MaxPacket;
+  Urb->Request    = Request;
+  Urb->Data       = Data;
+  Urb->DataLength = DataLength;
+  Urb->DataIn     = DataIn;
+}
+
+/**
+  Wait for a queued URB, take it off the URB list and recover the
+  endpoint if it failed. Runs at XHCI_TPL so the async monitor never
+  drains the event ring concurrently.
+
+  @param  Private         XHCI private data.
+  @param  Urb             Queued URB.
+  @param  Timeout         Timeout in milliseconds, 0 to wait forever.
+  @param  TransferResult  EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS       Transfer completed, possibly short.
+  @retval EFI_TIMEOUT       Transfer did not complete; it was cancelled.
+  @retval EFI_DEVICE_ERROR  Transfer failed.
+**/
+EFI_STATUS
+XhciWaitUrb (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_URB           *Urb,
+  IN  UINTN              Timeout,
+  OUT UINT32             *TransferResult
+  )
+{
+  XhciWaitEvent (Private, &Urb->Done, (Timeout == 0) ? MAX_UINT64 : MultU64x32 (Timeout, 1000));
+
+  RemoveEntryList (&Urb->Link);
+
+  if ((Urb->DataLength > 0) && Urb->DataIn) {
+    InvalidateDataCacheRange (Urb->Data, Urb->DataLength);
+  }
+
+  if (!Urb->Done) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Slot %d DCI %d: transfer timeout\n", Urb->Device->SlotId, Urb->Dci));
+    XhciRecoverEndpoint (Private, Urb->Device, Urb->Dci, FALSE);
+    *TransferResult = EFI_USB_ERR_TIMEOUT;
+    return EFI_TIMEOUT;
+  }
+
+  *TransferResult = XhciCompletionToResult (Urb->CompletionCode);
+  if (*TransferResult != EFI_USB_NOERROR) {
+    DEBUG ((DEBUG_ERROR, "[XHCI] Slot %d DCI %d: transfer failed, code %d\n",
+            Urb->Device->SlotId, Urb->Dci, Urb->CompletionCode));
+    XhciRecoverEndpoint (Private, Urb->Device, Urb->Dci, TRUE);
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Queue an URB and wait for it.
+
+  @param  Private         XHCI private data.
+  @param  Urb             Initialized URB, normally on the caller's stack.
+  @param  Timeout         Timeout in milliseconds, 0 to wait forever.
+  @param  TransferResult  EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS       Transfer completed, possibly short.
+  @retval EFI_TIMEOUT       Transfer did not complete; it was cancelled.
+  @retval EFI_DEVICE_ERROR  Transfer failed.
+  @retval others            Transfer could not be queued.
+**/
+STATIC
+EFI_STATUS
+XhciExecuteUrb (
+  IN  XHCI_PRIVATE_DATA  *Private,
+  IN  XHCI_URB           *Urb,
+  IN  UINTN              Timeout,
+  OUT UINT32             *TransferResult
+  )
+{
+  EFI_STATUS  Status;
+
+  *TransferResult = EFI_USB_ERR_SYSTEM;
+
+  Status = XhciQueueUrb (Private, Urb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return XhciWaitUrb (Private, Urb, Timeout, TransferResult);
+}
+
+/**
+  Release an URB created for an asynchronous interrupt transfer.
+**/
+STATIC
+VOID
+XhciFreeUrb (
+  IN XHCI_URB  *Urb
+  )
+{
+  if (Urb->Async && (Urb->Data != NULL)) {
+    FreePages (Urb->Data, EFI_SIZE_TO_PAGES (Urb->DataLength));
+  }
+  FreePool (Urb);
+}
+
+/**
+  Drop every asynchronous URB of a device that is going away.
+
+  @param  Private       XHCI private data.
+  @param  Device        Device.
+**/
+VOID
+XhciFreeDeviceUrbs (
+  IN XHCI_PRIVATE_DATA  *Private,
+  IN XHCI_DEVICE        *Device
+  )
+{
+  LIST_ENTRY  *Entry;
+  LIST_ENTRY  *Next;
+  XHCI_URB    *Urb;
+
+  for (Entry = GetFirstNode (&Private->UrbList); !IsNull (&Private->UrbList, Entry); Entry = Next) {
+    Next = GetNextNode (&Private->UrbList, Entry);
+    Urb  = XHCI_URB_FROM_LINK (Entry);
+    if (Urb->Device == Device) {
+      RemoveEntryList (&Urb->Link);
+      if (Urb->Async) {
+        XhciFreeUrb (Urb);
+      }
+    }
+  }
+}
+
+/**
+  Periodic timer handler. Drains the event ring once for all endpoints,
+  hands completed asynchronous interrupt data to their callbacks and puts
+  their TDs back on the ring, then acts on root port changes.
+
+  @param  Event         Timer event.
+  @param  Context       XHCI private data.
+**/
+VOID
+EFIAPI
+XhciMonitorAsyncRequests (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  LIST_ENTRY         *Entry;
+  LIST_ENTRY         *Next;
+  XHCI_URB           *Urb;
+  VOID               *Copy;
+  UINTN              Length;
+  UINT32             Result;
+
+  Private = Context;
+
+  while (XhciProcessEventRing (Private) == XHCI_EVENT_BATCH) {
+  }
+
+  for (Entry = GetFirstNode (&Private->UrbList); !IsNull (&Private->UrbList, Entry); Entry = Next) {
+    Next = GetNextNode (&Private->UrbList, Entry);
+    Urb  = XHCI_URB_FROM_LINK (Entry);
+    if (!Urb->Async || !Urb->Done) {
+      continue;
+    }
+
+    RemoveEntryList (&Urb->Link);
+    InvalidateDataCacheRange (Urb->Data, Urb->DataLength);
+
+    Result = XhciCompletionToResult (Urb->CompletionCode);
+    Copy   = NULL;
+    Length = 0;
+    if (Result == EFI_USB_NOERROR) {
+      Length = Urb->Completed;
+      if (Length > 0) {
+        Copy = AllocateCopyPool (Length, Urb->Data);
+        if (Copy == NULL) {
+          Length = 0;
+          Result = EFI_USB_ERR_SYSTEM;
+        }
+      }
+    } else {
+      XhciRecoverEndpoint (Private, Urb->Device, Urb->Dci, TRUE);
+    }
+
+    //
+    // Requeue before the callback: the callback may cancel the transfer,
+    // which frees the URB.
+    //
+    if (EFI_ERROR (XhciQueueUrb (Private, Urb))) {
+      DEBUG ((DEBUG_ERROR, "[XHCI] Slot %d DCI %d: async requeue failed\n", Urb->Device->SlotId, Urb->Dci));
+    }
+
+    Urb->Callback (Copy, Length, Urb->Context, Result);
+
+    if (Copy != NULL) {
+      FreePool (Copy);
+    }
+  }
+
+  XhciServicePorts (Private);
+}
+
+/**
+  Submits control transfer to a target USB device.
+
+  SET_ADDRESS is carried out by the controller through an Address Device
+  command. Device and configuration descriptors are watched on the way
+  back so that the default control endpoint and SET_CONFIGURATION can be
+  mirrored into the device context.
+
+  @param  This                 USB2 HC protocol instance.
+  @param  DeviceAddress        Target device address.
+  @param  DeviceSpeed          Target device speed.
+  @param  MaximumPacketLength  Max packet size of the default control endpoint.
+  @param  Request              USB device request to send.
+  @param  TransferDirection    Direction of the data stage.
+  @param  Data                 Data buffer.
+  @param  DataLength           On input, bytes to transfer; on output, bytes
+                               transferred.
+  @param  Timeout              Timeout in milliseconds.
+  @param  Translator           Transaction translator, unused.
+  @param  TransferResult       EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS           Transfer completed.
+  @retval EFI_INVALID_PARAMETER Invalid parameter.
+  @retval EFI_TIMEOUT           Transfer timed out.
+  @retval EFI_DEVICE_ERROR      Transfer failed or no such device.
+**/
+EFI_STATUS
+EFIAPI
+XhciControlTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     EFI_USB_DEVICE_REQUEST              *Request,
+  IN     EFI_USB_DATA_DIRECTION              TransferDirection,
+  IN OUT VOID                                *Data,
+  IN OUT UINTN                               *DataLength,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  )
+{
+  XHCI_PRIVATE_DATA      *Private;
+  XHCI_DEVICE            *Device;
+  XHCI_URB               Urb;
+  USB_DEVICE_DESCRIPTOR  *DevDesc;
+  USB_CONFIG_DESCRIPTOR  *Config;
+  EFI_STATUS             Status;
+  EFI_TPL                OldTpl;
+  UINTN                  Length;
+  UINT8                  DescType;
+  UINT8                  Index;
+
+  if ((Request == NULL) || (TransferResult == NULL) || (TransferDirection > EfiUsbNoData)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((TransferDirection != EfiUsbNoData) && ((Data == NULL) || (DataLength == NULL))) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((TransferDirection == EfiUsbNoData) && (DataLength != NULL) && (*DataLength != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((MaximumPacketLength != 8) && (MaximumPacketLength != 16) && (MaximumPacketLength != 32) &&
+      (MaximumPacketLength != 64) && (MaximumPacketLength != 512))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private         = XHCI_PRIVATE_FROM_THIS (This);
+  *TransferResult = EFI_USB_ERR_SYSTEM;
+  Length          = (TransferDirection == EfiUsbNoData) ? 0 : *DataLength;
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  Device = XhciDeviceFromAddress (Private, DeviceAddress);
+  if (Device == NULL) {
+    Status = EFI_DEVICE_ERROR;
+    goto Done;
+  }
+
+  if ((Request->RequestType == USB_DEV_SET_ADDRESS_REQ_TYPE) &&
+      (Request->Request == USB_DEV_SET_ADDRESS))
+  {
+    Status = XhciSetDeviceAddress (Private, Device, (UINT8)Request->Value);
+    if (!EFI_ERROR (Status)) {
+      *TransferResult = EFI_USB_NOERROR;
+    }
+    goto Done;
+  }
+
+  XhciInitUrb (
+    &Urb,
+    Device,
+    0,
+    Device->MaxPacket0,
+    Request,
+    Data,
+    Length,
+    (BOOLEAN)(TransferDirection == EfiUsbDataIn)
+    );
+  Status = XhciExecuteUrb (Private, &Urb, Timeout, TransferResult);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Length = Urb.Completed;
+  if (TransferDirection != EfiUsbNoData) {
+    *DataLength = Length;
+  }
+
+  if ((Request->RequestType == USB_DEV_GET_DESCRIPTOR_REQ_TYPE) &&
+      (Request->Request == USB_DEV_GET_DESCRIPTOR))
+  {
+    DescType = (UINT8)(Request->Value >> 8);
+    if ((DescType == USB_DESC_TYPE_DEVICE) && (Length >= 8)) {
+      DevDesc = Data;
+      Status  = XhciEvaluateMaxPacket0 (
+                  Private,
+                  Device,
+                  (Device->Speed == XHCI_SPEED_SUPER) ?
+                  (UINT16)(1 << DevDesc->MaxPacketSize0) :
+                  DevDesc->MaxPacketSize0
+                  );
+    } else if ((DescType == USB_DESC_TYPE_CONFIG) && (Length >= sizeof (USB_CONFIG_DESCRIPTOR))) {
+      Config = Data;
+      Index  = (UINT8)Request->Value;
+      if ((Index < XHCI_MAX_CONFIGS) && (Length >= Config->TotalLength)) {
+        if (Device->ConfigDesc[Index] != NULL) {
+          FreePool (Device->ConfigDesc[Index]);
+        }
+        Device->ConfigDesc[Index] = AllocateCopyPool (Config->TotalLength, Config);
+      }
+    }
+  } else if ((Request->RequestType == USB_DEV_SET_CONFIGURATION_REQ_TYPE) &&
+             (Request->Request == USB_DEV_SET_CONFIGURATION))
+  {
+    Status = XhciConfigureEndpoints (Private, Device, (UINT8)Request->Value);
+  }
+
+  if (EFI_ERROR (Status)) {
+    *TransferResult = EFI_USB_ERR_SYSTEM;
+  }
+
+Done:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Submits bulk transfer to a bulk endpoint of a USB device.
+
+  Up to XHCI_MAX_TD_BYTES go out as one chained TD behind a single
+  doorbell; larger buffers are moved in TDs of that size.
+
+  @param  This                 USB2 HC protocol instance.
+  @param  DeviceAddress        Target device address.
+  @param  EndPointAddress      Endpoint number and direction.
+  @param  DeviceSpeed          Target device speed.
+  @param  MaximumPacketLength  Max packet size of the endpoint.
+  @param  DataBuffersNumber    Number of data buffers; only Data[0] is used.
+  @param  Data                 Data buffers.
+  @param  DataLength           On input, bytes to transfer; on output, bytes
+                               transferred.
+  @param  DataToggle           Data toggle, managed by the controller.
+  @param  Timeout              Timeout in milliseconds.
+  @param  Translator           Transaction translator, unused.
+  @param  TransferResult       EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS           Transfer completed.
+  @retval EFI_INVALID_PARAMETER Invalid parameter.
+  @retval EFI_TIMEOUT           Transfer timed out.
+  @retval EFI_DEVICE_ERROR      Transfer failed or no such device.
+**/
+EFI_STATUS
+EFIAPI
+XhciBulkTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     UINT8                               DataBuffersNumber,
+  IN OUT VOID                                *Data[EFI_USB_MAX_BULK_BUFFER_NUM],
+  IN OUT UINTN                               *DataLength,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_DEVICE        *Device;
+  XHCI_URB           Urb;
+  EFI_STATUS         Status;
+  EFI_TPL            OldTpl;
+  UINTN              Offset;
+  UINTN              Length;
+
+  if ((DataLength == NULL) || (*DataLength == 0) || (Data == NULL) || (Data[0] == NULL) ||
+      (TransferResult == NULL) || (DataBuffersNumber == 0) || (MaximumPacketLength == 0) ||
+      (DeviceSpeed == EFI_USB_SPEED_LOW))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private         = XHCI_PRIVATE_FROM_THIS (This);
+  *TransferResult = EFI_USB_ERR_SYSTEM;
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  Device = XhciDeviceFromAddress (Private, DeviceAddress);
+  if (Device == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = EFI_SUCCESS;
+  for (Offset = 0; Offset < *DataLength; Offset += Urb.Completed) {
+    Length = MIN (*DataLength - Offset, XHCI_MAX_TD_BYTES);
+    XhciInitUrb (
+      &Urb,
+      Device,
+      EndPointAddress,
+      MaximumPacketLength,
+      NULL,
+      (UINT8 *)Data[0] + Offset,
+      Length,
+      (BOOLEAN)((EndPointAddress & USB_ENDPOINT_DIR_IN) != 0)
+      );
+    Status = XhciExecuteUrb (Private, &Urb, Timeout, TransferResult);
+    if (EFI_ERROR (Status) || (Urb.Completed < Length)) {
+      Offset += EFI_ERROR (Status) ? 0 : Urb.Completed;
+      break;
+    }
+  }
+
+  *DataLength = Offset;
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Submits an asynchronous interrupt transfer to an interrupt endpoint of a
+  USB device, or cancels one.
+
+  The TD stays queued on the endpoint; the controller polls the device at
+  the endpoint interval and the periodic monitor delivers each completion
+  to CallBackFunction.
+
+  @param  This                 USB2 HC protocol instance.
+  @param  DeviceAddress        Target device address.
+  @param  EndPointAddress      Endpoint number and direction.
+  @param  DeviceSpeed          Target device speed.
+  @param  MaximumPacketLength  Max packet size of the endpoint.
+  @param  IsNewTransfer        TRUE to start a transfer, FALSE to cancel.
+  @param  DataToggle           Data toggle, managed by the controller.
+  @param  PollingInterval      Polling interval in milliseconds.
+  @param  DataLength           Bytes to receive per completion.
+  @param  Translator           Transaction translator, unused.
+  @param  CallBackFunction     Called on every completion.
+  @param  Context              Passed to CallBackFunction.
+
+  @retval EFI_SUCCESS           Transfer started or cancelled.
+  @retval EFI_INVALID_PARAMETER Invalid parameter or no such transfer.
+  @retval EFI_OUT_OF_RESOURCES  Allocation failed.
+  @retval EFI_DEVICE_ERROR      No such device or endpoint.
+**/
+EFI_STATUS
+EFIAPI
+XhciAsyncInterruptTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     BOOLEAN                             IsNewTransfer,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               PollingInterval,
+  IN     UINTN                               DataLength,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  IN     EFI_ASYNC_USB_TRANSFER_CALLBACK     CallBackFunction,
+  IN     VOID                                *Context OPTIONAL
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_DEVICE        *Device;
+  XHCI_URB           *Urb;
+  LIST_ENTRY         *Entry;
+  EFI_STATUS         Status;
+  EFI_TPL            OldTpl;
+
+  if ((EndPointAddress & USB_ENDPOINT_DIR_IN) == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (IsNewTransfer &&
+      ((DataLength == 0) || (CallBackFunction == NULL) || (PollingInterval == 0) ||
+       (PollingInterval > 255) || (MaximumPacketLength == 0)))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private = XHCI_PRIVATE_FROM_THIS (This);
+  OldTpl  = gBS->RaiseTPL (XHCI_TPL);
+
+  Device = XhciDeviceFromAddress (Private, DeviceAddress);
+
+  if (!IsNewTransfer) {
+    Status = EFI_INVALID_PARAMETER;
+    for (Entry = GetFirstNode (&Private->UrbList);
+         !IsNull (&Private->UrbList, Entry);
+         Entry = GetNextNode (&Private->UrbList, Entry))
+    {
+      Urb = XHCI_URB_FROM_LINK (Entry);
+      if (Urb->Async && (Urb->Device == Device) && (Urb->EpAddress == EndPointAddress)) {
+        RemoveEntryList (&Urb->Link);
+        XhciRecoverEndpoint (Private, Device, Urb->Dci, FALSE);
+        XhciFreeUrb (Urb);
+        Status = EFI_SUCCESS;
+        break;
+      }
+    }
+    gBS->RestoreTPL (OldTpl);
+    return Status;
+  }
+
+  if (Device == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  Urb = AllocateZeroPool (sizeof (XHCI_URB));
+  if (Urb == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The buffer gets its own pages so that invalidating it after DMA can
+  // never discard a neighbour's data.
+  //
+  XhciInitUrb (Urb, Device, EndPointAddress, MaximumPacketLength, NULL, NULL, DataLength, TRUE);
+  Urb->Async    = TRUE;
+  Urb->Callback = CallBackFunction;
+  Urb->Context  = Context;
+  Urb->Data     = AllocatePages (EFI_SIZE_TO_PAGES (DataLength));
+  if (Urb->Data == NULL) {
+    FreePool (Urb);
+    gBS->RestoreTPL (OldTpl);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = XhciQueueUrb (Private, Urb);
+  if (EFI_ERROR (Status)) {
+    XhciFreeUrb (Urb);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Submits synchronous interrupt transfer to an interrupt endpoint of a USB
+  device.
+
+  @param  This                 USB2 HC protocol instance.
+  @param  DeviceAddress        Target device address.
+  @param  EndPointAddress      Endpoint number and direction.
+  @param  DeviceSpeed          Target device speed.
+  @param  MaximumPacketLength  Max packet size of the endpoint.
+  @param  Data                 Data buffer.
+  @param  DataLength           On input, bytes to transfer; on output, bytes
+                               transferred.
+  @param  DataToggle           Data toggle, managed by the controller.
+  @param  Timeout              Timeout in milliseconds.
+  @param  Translator           Transaction translator, unused.
+  @param  TransferResult       EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS           Transfer completed.
+  @retval EFI_INVALID_PARAMETER Invalid parameter.
+  @retval EFI_TIMEOUT           Transfer timed out.
+  @retval EFI_DEVICE_ERROR      Transfer failed or no such device.
+**/
+EFI_STATUS
+EFIAPI
+XhciSyncInterruptTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN OUT VOID                                *Data,
+  IN OUT UINTN                               *DataLength,
+  IN OUT UINT8                               *DataToggle,
+  IN     UINTN                               Timeout,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_DEVICE        *Device;
+  XHCI_URB           Urb;
+  EFI_STATUS         Status;
+  EFI_TPL            OldTpl;
+
+  if ((Data == NULL) || (DataLength == NULL) || (*DataLength == 0) ||
+      (*DataLength > XHCI_MAX_TD_BYTES) || (TransferResult == NULL) || (MaximumPacketLength == 0))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private         = XHCI_PRIVATE_FROM_THIS (This);
+  *TransferResult = EFI_USB_ERR_SYSTEM;
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  Device = XhciDeviceFromAddress (Private, DeviceAddress);
+  if (Device == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  XhciInitUrb (
+    &Urb,
+    Device,
+    EndPointAddress,
+    MaximumPacketLength,
+    NULL,
+    Data,
+    *DataLength,
+    (BOOLEAN)((EndPointAddress & USB_ENDPOINT_DIR_IN) != 0)
+    );
+  Status = XhciExecuteUrb (Private, &Urb, Timeout, TransferResult);
+  *DataLength = EFI_ERROR (Status) ? 0 : Urb.Completed;
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Submits isochronous transfer to an isochronous endpoint of a USB device.
+
+  Data[0] is split into one TD per MaximumPacketLength bytes, each started
+  as soon as possible, and the whole run is handed to the controller with
+  one doorbell.
+
+  @param  This                 USB2 HC protocol instance.
+  @param  DeviceAddress        Target device address.
+  @param  EndPointAddress      Endpoint number and direction.
+  @param  DeviceSpeed          Target device speed.
+  @param  MaximumPacketLength  Bytes per service interval.
+  @param  DataBuffersNumber    Number of data buffers; only Data[0] is used.
+  @param  Data                 Data buffers.
+  @param  DataLength           Bytes to transfer.
+  @param  Translator           Transaction translator, unused.
+  @param  TransferResult       EFI_USB_ERR_* result.
+
+  @retval EFI_SUCCESS           Transfer completed.
+  @retval EFI_INVALID_PARAMETER Invalid parameter.
+  @retval EFI_OUT_OF_RESOURCES  Transfer does not fit the endpoint ring.
+  @retval EFI_TIMEOUT           Transfer timed out.
+  @retval EFI_DEVICE_ERROR      Transfer failed or no such device.
+**/
+EFI_STATUS
+EFIAPI
+XhciIsochronousTransfer (
+  IN     EFI_USB2_HC_PROTOCOL                *This,
+  IN     UINT8                               DeviceAddress,
+  IN     UINT8                               EndPointAddress,
+  IN     UINT8                               DeviceSpeed,
+  IN     UINTN                               MaximumPacketLength,
+  IN     UINT8                               DataBuffersNumber,
+  IN OUT VOID                                *Data[EFI_USB_MAX_ISO_BUFFER_NUM],
+  IN     UINTN                               DataLength,
+  IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR  *Translator,
+  OUT    UINT32                              *TransferResult
+  )
+{
+  XHCI_PRIVATE_DATA  *Private;
+  XHCI_DEVICE        *Device;
+  XHCI_URB           Urb;
+  EFI_STATUS         Status;
+  EFI_TPL            OldTpl;
+
+  if ((Data == NULL) || (Data[0] == NULL) || (DataLength == 0) || (DataBuffersNumber == 0) ||
+      (MaximumPacketLength == 0) || (TransferResult == NULL))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Private         = XHCI_PRIVATE_FROM_THIS (This);
+  *TransferResult = EFI_USB_ERR_SYSTEM;
+
+  OldTpl = gBS->RaiseTPL (XHCI_TPL);
+
+  Device = XhciDeviceFromAddress (Private, DeviceAddress);
+  if ((Device == NULL) ||
+      ((Device->EpType[XHCI_ENDPOINT_TO_DCI (EndPointAddress)] != XHCI_EP_ISOCH_IN) &&
+       (Device->EpType[XHCI_ENDPOINT_TO_DCI (EndPointAddress)] != XHCI_EP_ISOCH_OUT)))
+  {
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+
+  XhciInitUrb (
+    &Urb,
+    Device,
+    EndPointAddress,
+    MaximumPacketLength,
+    NULL,
+    Data[0],
+    DataLength,
+    (BOOLEAN)((EndPointAddress & USB_ENDPOINT_DIR_IN) != 0)
+    );
+  Urb.TdLength = MaximumPacketLength;
+
+  Status = XhciExecuteUrb (Private, &Urb, XHCI_ISOCH_TIMEOUT, TransferResult);
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
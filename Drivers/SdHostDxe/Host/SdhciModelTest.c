@@ -0,0 +1,1288 @@
+/** @file
+  Host test of the SdHostDxe engine against a software host controller.
+
+  SdHc.c and SdCard.c are built unchanged on top of a model of an SDHCI
+  controller with an SD card in its slot: the registers, 64-bit ADMA2
+  descriptor tables, tuning, the slot power and I/O voltage, and a card
+  that follows the identification, voltage switch, bus width and bus
+  speed commands and holds its blocks in memory. Each scenario sets up
+  what the controller and the card support and checks the bus timing
+  the engine ends up in, the data that lands on the card and back, the
+  commands per transfer, and the throughput at the modelled bus clock.
+
+    cd Drivers/SdHostDxe
+    cc -O2 -I../../Host -o SdhciModelTest SdHc.c SdCard.c Host/SdhciModelTest.c ../../Host/HostTest.c
+    ./SdhciModelTest
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HostTest.h"
+
+#include "../SdHc.h"
+
+#define MODEL_BASE            0x100000000ULL
+#define MODEL_DISK_SIZE       (64 * SIZE_1MB)
+#define MODEL_BLOCKS          (MODEL_DISK_SIZE / SD_BLOCK_SIZE)
+#define MODEL_RCA             0x5A17
+#define MODEL_TUNING_BLOCKS   6
+
+//
+// Card access time of each data command, in nanoseconds
+//
+#define MODEL_ACCESS_NS       100000
+
+//
+// Card states of the R1 status
+//
+#define CARD_IDLE             0
+#define CARD_READY            1
+#define CARD_IDENT            2
+#define CARD_STANDBY          3
+#define CARD_TRANSFER         4
+#define CARD_DATA             5
+
+typedef struct {
+  //
+  // Configuration
+  //
+  UINT32     BaseClockMhz;
+  UINT32     Capabilities2;
+  BOOLEAN    CardVersion2;          // answers CMD8, high capacity
+  BOOLEAN    CardUhs;               // accepts 1.8 V signalling
+  UINT8      CardFunctions;         // group 1 bus speeds
+  BOOLEAN    CardCmd23;
+  BOOLEAN    SwitchFails;           // card never releases DAT after CMD11
+  BOOLEAN    TuningFails;
+  UINT64     FailLba;               // a transfer covering it fails its CRC
+
+  //
+  // Controller registers and slot
+  //
+  UINT32     Block;
+  UINT32     Argument;
+  UINT32     Response[4];
+  UINT32     HostControl;
+  UINT32     ClockControl;
+  UINT32     IntStatus;
+  UINT32     IntStatusEnable;
+  UINT32     HostControl2;
+  UINT64     AdmaAddress;
+  UINT32     TuningBlocks;
+  BOOLEAN    Powered;
+  BOOLEAN    IoLow;
+
+  //
+  // Card
+  //
+  UINT32     State;
+  BOOLEAN    AppCmd;
+  UINT32     OpCondPolls;
+  BOOLEAN    S18Accepted;
+  BOOLEAN    Switching;
+  BOOLEAN    Signal1V8;
+  BOOLEAN    Wide;
+  UINT8      Function;
+  UINT32     BlockCount;            // set by CMD23, 0 if none
+  UINT8      *Disk;
+
+  //
+  // Counters
+  //
+  UINT64     Commands[64];
+  UINT64     DataCommands;
+  UINT64     AutoStops;
+  UINT64     Descriptors;
+  UINT64     MaxDescriptors;
+  UINT64     PowerCycles;
+  UINT64     Allocations;
+  UINT64     Violations;
+  UINT64     Ns;
+  UINT64     BusNs;
+} MODEL;
+
+STATIC MODEL  mModel;
+
+//
+// Highest card clock of each group 1 function, in MHz
+//
+STATIC CONST UINT32  mModelFunctionClock[] = { 25, 50, 100, 208, 50 };
+
+//
+// Controller UHS mode of each group 1 function
+//
+STATIC CONST UINT32  mModelFunctionMode[] = {
+  SD_HC_UHS_SDR12,
+  SD_HC_UHS_SDR25,
+  SD_HC_UHS_SDR50,
+  SD_HC_UHS_SDR104,
+  SD_HC_UHS_DDR50
+};
+
+STATIC
+VOID
+ModelViolation (
+  IN CONST char  *Message
+  )
+{
+  printf ("  model: %s\n", Message);
+  mModel.Violations++;
+}
+
+//
+// Services of the platform the engine runs on
+//
+
+UINT64
+HostModelTime (
+  VOID
+  )
+{
+  return mModel.Ns;
+}
+
+VOID
+HostModelDelay (
+  IN UINT64  Nanoseconds
+  )
+{
+  mModel.Ns += Nanoseconds;
+}
+
+//
+// The model shares memory with the engine, so cache maintenance does
+// nothing.
+//
+
+VOID *
+WriteBackDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+InvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+WriteBackInvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  )
+{
+  return Address;
+}
+
+VOID *
+AllocateAlignedPages (
+  IN UINTN  Pages,
+  IN UINTN  Alignment
+  )
+{
+  mModel.Allocations++;
+  return aligned_alloc (Alignment, Pages * EFI_PAGE_SIZE);
+}
+
+VOID
+FreeAlignedPages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  )
+{
+  free (Buffer);
+}
+
+STATIC
+VOID
+EFIAPI
+ModelSetPower (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  On
+  )
+{
+  if (On && !mModel.Powered) {
+    mModel.PowerCycles++;
+    mModel.State       = CARD_IDLE;
+    mModel.AppCmd      = FALSE;
+    mModel.OpCondPolls = 0;
+    mModel.S18Accepted = FALSE;
+    mModel.Switching   = FALSE;
+    mModel.Signal1V8   = FALSE;
+    mModel.Wide        = FALSE;
+    mModel.Function    = 0;
+    mModel.BlockCount  = 0;
+  }
+
+  mModel.Powered = On;
+}
+
+STATIC
+VOID
+EFIAPI
+ModelSetIoVoltage (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Signal1V8
+  )
+{
+  mModel.IoLow = Signal1V8;
+}
+
+//
+// Controller and card model
+//
+
+/**
+  Card clock from the clock control register, in Hz; 0 when gated.
+**/
+STATIC
+UINT64
+ModelCardClock (
+  VOID
+  )
+{
+  UINT32  Divider;
+  UINT64  Base;
+
+  if ((mModel.ClockControl & (SD_HC_CLOCK_INTERNAL | SD_HC_CLOCK_CARD)) != (SD_HC_CLOCK_INTERNAL | SD_HC_CLOCK_CARD)) {
+    return 0;
+  }
+
+  Base    = (UINT64)mModel.BaseClockMhz * 1000000;
+  Divider = ((mModel.ClockControl >> 8) & 0xFF) | (((mModel.ClockControl >> 6) & 0x3) << 8);
+  return (Divider == 0) ? Base : Base / (2 * Divider);
+}
+
+STATIC
+UINT32
+ModelCardStatus (
+  VOID
+  )
+{
+  return (mModel.State << 9) | SD_R1_READY_FOR_DATA | (mModel.AppCmd ? BIT5 : 0);
+}
+
+/**
+  Set a field of the CSD in the layout of an R2 response.
+**/
+STATIC
+VOID
+ModelCsdField (
+  IN UINT32  *Response,
+  IN UINTN   Start,
+  IN UINTN   Width,
+  IN UINT32  Value
+  )
+{
+  UINTN  Index;
+  UINTN  Bit;
+
+  for (Index = 0; Index < Width; Index++) {
+    Bit = Start + Index - 8;
+    if (((Value >> Index) & 1) != 0) {
+      Response[Bit / 32] |= 1U << (Bit % 32);
+    }
+  }
+}
+
+/**
+  Check that the controller drives the bus the way the card expects it
+  before a data transfer. Register reads only need the width and the
+  voltage to agree; Strict adds the bus speed for block transfers.
+**/
+STATIC
+VOID
+ModelCheckBus (
+  IN BOOLEAN  Strict
+  )
+{
+  if (mModel.Wide != ((mModel.HostControl & SD_HC_CTRL_DATA_4BIT) != 0)) {
+    ModelViolation ("bus width differs between card and controller");
+  }
+
+  if ((mModel.HostControl & SD_HC_CTRL_DMA_MASK) != SD_HC_CTRL_ADMA2_64) {
+    ModelViolation ("data without 64-bit ADMA2 selected");
+  }
+
+  if ((mModel.Signal1V8 != ((mModel.HostControl2 & SD_HC_CTRL2_SIGNAL_1V8) != 0)) || (mModel.Signal1V8 != mModel.IoLow)) {
+    ModelViolation ("signal voltage differs between card, controller and regulator");
+  }
+
+  if (!Strict) {
+    return;
+  }
+
+  if (mModel.Signal1V8) {
+    if (((mModel.HostControl2 & SD_HC_CTRL2_UHS_MASK) >> 16) != mModelFunctionMode[mModel.Function]) {
+      ModelViolation ("controller UHS mode differs from the card bus speed");
+    }
+
+    if ((mModel.Function == 3) && ((mModel.HostControl2 & SD_HC_CTRL2_SAMPLING_CLOCK) == 0)) {
+      ModelViolation ("SDR104 data without a tuned sampling clock");
+    }
+  } else if ((mModel.Function == 1) && ((mModel.HostControl & SD_HC_CTRL_HIGH_SPEED) == 0)) {
+    ModelViolation ("high speed card with the controller at default speed");
+  }
+}
+
+/**
+  Move Bytes between memory and Device through the ADMA2 descriptor
+  table.
+
+  @return TRUE when the table was valid.
+**/
+STATIC
+BOOLEAN
+ModelDma (
+  IN UINT8    *Device,
+  IN UINTN    Bytes,
+  IN BOOLEAN  ToDevice
+  )
+{
+  SD_ADMA_DESCRIPTOR  *Descriptor;
+  UINTN               Count;
+  UINTN               Length;
+  UINT8               *Memory;
+
+  if ((mModel.AdmaAddress & 7) != 0) {
+    ModelViolation ("descriptor table not 8-byte aligned");
+    return FALSE;
+  }
+
+  Descriptor = (SD_ADMA_DESCRIPTOR *)(UINTN)mModel.AdmaAddress;
+  for (Count = 1; ; Count++, Descriptor++) {
+    if (Count > SD_ADMA_DESCRIPTORS) {
+      ModelViolation ("descriptor table runs past its end");
+      return FALSE;
+    }
+
+    if (((Descriptor->Attributes & SD_ADMA_VALID) == 0) || ((Descriptor->Attributes & 0x30) != SD_ADMA_TRANSFER)) {
+      ModelViolation ("invalid descriptor");
+      return FALSE;
+    }
+
+    Length = (Descriptor->Length == 0) ? SIZE_64KB : Descriptor->Length;
+    Memory = (UINT8 *)(UINTN)(Descriptor->AddressLow | ((UINT64)Descriptor->AddressHigh << 32));
+    if ((((UINTN)Memory) & (SD_ADMA_ALIGNMENT - 1)) != 0) {
+      ModelViolation ("descriptor address not aligned");
+      return FALSE;
+    }
+
+    if (Length > Bytes) {
+      ModelViolation ("descriptors longer than the transfer");
+      return FALSE;
+    }
+
+    if (ToDevice) {
+      memcpy (Device, Memory, Length);
+    } else {
+      memcpy (Memory, Device, Length);
+    }
+
+    Device += Length;
+    Bytes  -= Length;
+    if ((Descriptor->Attributes & SD_ADMA_END) != 0) {
+      break;
+    }
+  }
+
+  if (Bytes != 0) {
+    ModelViolation ("descriptors shorter than the transfer");
+    return FALSE;
+  }
+
+  mModel.Descriptors   += Count;
+  mModel.MaxDescriptors = MAX (mModel.MaxDescriptors, Count);
+  return TRUE;
+}
+
+/**
+  Data phase of a command: move it and account for its time on the bus.
+
+  @return Interrupt status bits to post.
+**/
+STATIC
+UINT32
+ModelData (
+  IN UINT8    *Device,
+  IN UINT32   Mode,
+  IN BOOLEAN  ToDevice,
+  IN BOOLEAN  Strict
+  )
+{
+  UINTN   Bytes;
+  UINT64  Clocks;
+  UINT64  Clock;
+
+  Bytes = (mModel.Block & 0xFFF) * (mModel.Block >> 16);
+  if ((Mode & SD_HC_MODE_DMA) == 0) {
+    ModelViolation ("data without DMA");
+    return SD_HC_INT_ERROR | SD_HC_INT_ADMA;
+  }
+
+  if (((Mode & SD_HC_MODE_READ) != 0) == ToDevice) {
+    ModelViolation ("transfer direction differs from the command");
+  }
+
+  ModelCheckBus (Strict);
+  if (!ModelDma (Device, Bytes, ToDevice)) {
+    return SD_HC_INT_ERROR | SD_HC_INT_ADMA;
+  }
+
+  Clock  = ModelCardClock ();
+  Clocks = Bytes * 8 / (mModel.Wide ? 4 : 1);
+  if (mModel.Signal1V8 && (mModel.Function == 4)) {
+    Clocks /= 2;
+  }
+
+  mModel.BusNs += MODEL_ACCESS_NS + Clocks * 1000000000ULL / Clock;
+  return SD_HC_INT_TRANSFER_COMPLETE;
+}
+
+/**
+  CMD17/18/24/25.
+
+  @return Interrupt status bits to post with the response.
+**/
+STATIC
+UINT32
+ModelReadWrite (
+  IN UINT8   Index,
+  IN UINT32  Mode
+  )
+{
+  BOOLEAN  Multi;
+  BOOLEAN  Write;
+  UINT64   Lba;
+  UINT32   Blocks;
+  UINT32   Status;
+
+  Multi  = (Index == SD_READ_MULTIPLE_BLOCK) || (Index == SD_WRITE_MULTIPLE_BLOCK);
+  Write  = (Index == SD_WRITE_BLOCK) || (Index == SD_WRITE_MULTIPLE_BLOCK);
+  Blocks = mModel.Block >> 16;
+  if (mModel.State != CARD_TRANSFER) {
+    ModelViolation ("block transfer outside the transfer state");
+    return SD_HC_INT_ERROR | SD_HC_INT_CMD_TIMEOUT;
+  }
+
+  if ((mModel.Block & 0xFFF) != SD_BLOCK_SIZE) {
+    ModelViolation ("block size other than 512 bytes");
+  }
+
+  if (mModel.CardVersion2) {
+    Lba = mModel.Argument;
+  } else {
+    if ((mModel.Argument % SD_BLOCK_SIZE) != 0) {
+      ModelViolation ("byte address not on a block");
+    }
+
+    Lba = mModel.Argument / SD_BLOCK_SIZE;
+  }
+
+  if (Multi) {
+    if ((Mode & (SD_HC_MODE_MULTI_BLOCK | SD_HC_MODE_BLOCK_COUNT)) != (SD_HC_MODE_MULTI_BLOCK | SD_HC_MODE_BLOCK_COUNT)) {
+      ModelViolation ("multiple block command without a block count");
+    }
+
+    if (mModel.BlockCount != 0) {
+      if (mModel.BlockCount != Blocks) {
+        ModelViolation ("CMD23 count differs from the block count");
+      }
+
+      if ((Mode & SD_HC_MODE_AUTO_CMD12) != 0) {
+        ModelViolation ("auto CMD12 after CMD23");
+      }
+    } else if ((Mode & SD_HC_MODE_AUTO_CMD12) == 0) {
+      ModelViolation ("open-ended multiple block command");
+    } else {
+      mModel.AutoStops++;
+    }
+  } else if ((Blocks != 1) || ((Mode & SD_HC_MODE_MULTI_BLOCK) != 0)) {
+    ModelViolation ("single block command for several blocks");
+  }
+
+  mModel.BlockCount = 0;
+  mModel.DataCommands++;
+  if (Lba + Blocks > MODEL_BLOCKS) {
+    ModelViolation ("transfer past the end of the card");
+    return SD_HC_INT_ERROR | SD_HC_INT_DATA_CRC;
+  }
+
+  if ((mModel.FailLba >= Lba) && (mModel.FailLba < Lba + Blocks)) {
+    mModel.State = Multi ? CARD_DATA : CARD_TRANSFER;
+    return SD_HC_INT_ERROR | SD_HC_INT_DATA_CRC;
+  }
+
+  Status = ModelData (mModel.Disk + Lba * SD_BLOCK_SIZE, Mode, Write, TRUE);
+  if ((Mode & SD_HC_MODE_AUTO_CMD12) != 0) {
+    mModel.Commands[SD_STOP_TRANSMISSION]++;
+  }
+
+  return Status;
+}
+
+/**
+  Response type each command is sent with: 0 none, 1 136 bits, 2 48
+  bits, 3 48 bits with busy.
+**/
+STATIC
+UINT32
+ModelResponseType (
+  IN UINT8    Index,
+  IN BOOLEAN  App
+  )
+{
+  if (App) {
+    return 2;
+  }
+
+  switch (Index) {
+    case SD_GO_IDLE_STATE:     return 0;
+    case SD_ALL_SEND_CID:      return 1;
+    case SD_SEND_CSD:          return 1;
+    case SD_SELECT_CARD:       return 3;
+    case SD_STOP_TRANSMISSION: return 3;
+    default:                   return 2;
+  }
+}
+
+STATIC
+BOOLEAN
+ModelHasData (
+  IN UINT8    Index,
+  IN BOOLEAN  App
+  )
+{
+  if (App) {
+    return Index == SD_APP_SEND_SCR;
+  }
+
+  switch (Index) {
+    case SD_SWITCH_FUNC:
+    case SD_READ_SINGLE_BLOCK:
+    case SD_READ_MULTIPLE_BLOCK:
+    case SD_SEND_TUNING_BLOCK:
+    case SD_WRITE_BLOCK:
+    case SD_WRITE_MULTIPLE_BLOCK:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/**
+  The card's side of CMD6: the switch status block, and the new bus
+  speed when Argument sets one.
+**/
+STATIC
+UINT32
+ModelSwitch (
+  IN UINT32  Mode
+  )
+{
+  UINT8   Status[SD_SWITCH_STATUS_SIZE];
+  UINT8   Supported;
+  UINT8   Function;
+  UINT8   Result;
+  UINT32  Post;
+
+  Supported = 1 | (mModel.CardFunctions & (mModel.Signal1V8 ? 0x1F : 0x03));
+  Function  = mModel.Argument & 0xF;
+  if (Function == 0xF) {
+    Result = mModel.Function;
+  } else if ((Supported & (1 << Function)) != 0) {
+    Result = Function;
+  } else {
+    Result = 0xF;
+  }
+
+  memset (Status, 0, sizeof (Status));
+  Status[SD_SWITCH_SUPPORT - 1] = 0x80;
+  Status[SD_SWITCH_SUPPORT]     = Supported;
+  Status[SD_SWITCH_RESULT]      = Result;
+  if ((mModel.Block & 0xFFF) != SD_SWITCH_STATUS_SIZE) {
+    ModelViolation ("switch status read with the wrong block size");
+  }
+
+  Post = ModelData (Status, Mode, FALSE, FALSE);
+  if (((mModel.Argument & BIT31) != 0) && (Result != 0xF)) {
+    mModel.Function = Result;
+  }
+
+  return Post;
+}
+
+STATIC
+UINT32
+ModelSendScr (
+  IN UINT32  Mode
+  )
+{
+  UINT8  Scr[SD_SCR_SIZE];
+
+  memset (Scr, 0, sizeof (Scr));
+  Scr[0] = mModel.CardVersion2 ? 0x02 : 0x01;
+  Scr[1] = 0x05;
+  Scr[2] = mModel.CardVersion2 ? 0x80 : 0x00;
+  Scr[3] = mModel.CardCmd23 ? SD_SCR_CMD23 : 0;
+  if ((mModel.Block & 0xFFF) != SD_SCR_SIZE) {
+    ModelViolation ("SCR read with the wrong block size");
+  }
+
+  return ModelData (Scr, Mode, FALSE, FALSE);
+}
+
+/**
+  A write to the command register: the card answers, moves the data and
+  the controller posts the interrupt status.
+**/
+STATIC
+VOID
+ModelCommand (
+  IN UINT32  Value
+  )
+{
+  UINT8    Index;
+  UINT32   Mode;
+  BOOLEAN  App;
+  UINT32   Post;
+  UINT64   Clock;
+  UINT64   Limit;
+  BOOLEAN  HighCapacity;
+
+  Index         = (UINT8)(Value >> 24) & 0x3F;
+  Mode          = Value & 0xFFFF;
+  App           = mModel.AppCmd;
+  Post          = SD_HC_INT_CMD_COMPLETE;
+  mModel.AppCmd = FALSE;
+  mModel.Commands[Index]++;
+  memset (mModel.Response, 0, sizeof (mModel.Response));
+
+  if (!mModel.Powered || ((mModel.HostControl & SD_HC_POWER_ON) == 0)) {
+    ModelViolation ("command with the card unpowered");
+    mModel.IntStatus |= SD_HC_INT_CMD_TIMEOUT & mModel.IntStatusEnable;
+    return;
+  }
+
+  Clock = ModelCardClock ();
+  Limit = (mModel.State < CARD_STANDBY) ? 400000 : (UINT64)mModelFunctionClock[mModel.Function] * 1000000;
+  if (Clock == 0) {
+    ModelViolation ("command with the card clock stopped");
+    mModel.IntStatus |= SD_HC_INT_CMD_TIMEOUT & mModel.IntStatusEnable;
+    return;
+  }
+
+  if (Clock > Limit) {
+    ModelViolation ("card clock above what the card runs at");
+  }
+
+  if (((Value >> 16) & 3) != ModelResponseType (Index, App)) {
+    ModelViolation ("wrong response type");
+  }
+
+  if (((Value & SD_HC_CMD_DATA_PRESENT) != 0) != ModelHasData (Index, App)) {
+    ModelViolation ("data present flag differs from the command");
+  }
+
+  if (App) {
+    switch (Index) {
+      case SD_APP_SEND_OP_COND:
+        if (mModel.State != CARD_IDLE) {
+          ModelViolation ("ACMD41 outside the idle state");
+        }
+
+        //
+        // A high capacity card stays busy for a host without HCS.
+        //
+        HighCapacity        = mModel.CardVersion2 && ((mModel.Argument & SD_OCR_HCS) != 0);
+        mModel.Response[0]  = SD_OCR_VDD_32_34;
+        if ((++mModel.OpCondPolls < 3) || (mModel.CardVersion2 && !HighCapacity)) {
+          break;
+        }
+
+        mModel.S18Accepted  = mModel.CardUhs && HighCapacity && ((mModel.Argument & SD_OCR_S18) != 0);
+        mModel.Response[0] |= SD_OCR_BUSY | (HighCapacity ? SD_OCR_HCS : 0) | (mModel.S18Accepted ? SD_OCR_S18 : 0);
+        mModel.State        = CARD_READY;
+        break;
+
+      case SD_APP_SET_BUS_WIDTH:
+        if (mModel.State != CARD_TRANSFER) {
+          ModelViolation ("ACMD6 outside the transfer state");
+        }
+
+        mModel.Wide        = (mModel.Argument & 3) == SD_BUS_WIDTH_4;
+        mModel.Response[0] = ModelCardStatus ();
+        break;
+
+      case SD_APP_SEND_SCR:
+        mModel.Response[0] = ModelCardStatus ();
+        Post              |= ModelSendScr (Mode);
+        break;
+
+      default:
+        ModelViolation ("unknown application command");
+        Post = SD_HC_INT_CMD_TIMEOUT;
+    }
+
+    mModel.IntStatus |= Post & mModel.IntStatusEnable;
+    return;
+  }
+
+  switch (Index) {
+    case SD_GO_IDLE_STATE:
+      mModel.State       = CARD_IDLE;
+      mModel.OpCondPolls = 0;
+      mModel.Wide        = FALSE;
+      mModel.Function    = 0;
+      mModel.BlockCount  = 0;
+      break;
+
+    case SD_SEND_IF_COND:
+      if (!mModel.CardVersion2) {
+        Post = SD_HC_INT_CMD_TIMEOUT;
+      } else {
+        mModel.Response[0] = mModel.Argument & 0xFFF;
+      }
+
+      break;
+
+    case SD_APP_CMD:
+      mModel.AppCmd      = TRUE;
+      mModel.Response[0] = ModelCardStatus ();
+      break;
+
+    case SD_VOLTAGE_SWITCH:
+      if (!mModel.S18Accepted || (mModel.State != CARD_READY)) {
+        ModelViolation ("CMD11 without an accepted 1.8 V request");
+        Post = SD_HC_INT_CMD_TIMEOUT;
+        break;
+      }
+
+      mModel.Switching   = TRUE;
+      mModel.Response[0] = ModelCardStatus ();
+      break;
+
+    case SD_ALL_SEND_CID:
+      if (mModel.State != CARD_READY) {
+        ModelViolation ("CMD2 outside the ready state");
+      }
+
+      if (mModel.Switching) {
+        ModelViolation ("CMD2 during the voltage switch");
+      }
+
+      mModel.State       = CARD_IDENT;
+      mModel.Response[0] = 0x1234A0;
+      mModel.Response[1] = 0x0F00C0DE;
+      mModel.Response[2] = 0x4D4F44;
+      mModel.Response[3] = 0x035344;
+      break;
+
+    case SD_SEND_RELATIVE_ADDR:
+      if (mModel.State != CARD_IDENT) {
+        ModelViolation ("CMD3 outside the identification state");
+      }
+
+      mModel.State       = CARD_STANDBY;
+      mModel.Response[0] = ((UINT32)MODEL_RCA << 16) | (CARD_STANDBY << 9) | SD_R1_READY_FOR_DATA;
+      break;
+
+    case SD_SEND_CSD:
+      if ((mModel.State != CARD_STANDBY) || (mModel.Argument != ((UINT32)MODEL_RCA << 16))) {
+        ModelViolation ("CMD9 outside the standby state or to another card");
+      }
+
+      if (mModel.CardVersion2) {
+        ModelCsdField (mModel.Response, 126, 2, 1);
+        ModelCsdField (mModel.Response, 48, 22, MODEL_BLOCKS / 1024 - 1);
+      } else {
+        ModelCsdField (mModel.Response, 80, 4, 9);
+        ModelCsdField (mModel.Response, 62, 12, MODEL_BLOCKS / 512 - 1);
+        ModelCsdField (mModel.Response, 47, 3, 7);
+      }
+
+      break;
+
+    case SD_SELECT_CARD:
+      if ((mModel.State != CARD_STANDBY) || (mModel.Argument != ((UINT32)MODEL_RCA << 16))) {
+        ModelViolation ("CMD7 outside the standby state or to another card");
+      }
+
+      mModel.Response[0] = ModelCardStatus ();
+      mModel.State       = CARD_TRANSFER;
+      Post              |= SD_HC_INT_TRANSFER_COMPLETE;
+      break;
+
+    case SD_SWITCH_FUNC:
+      if (mModel.State != CARD_TRANSFER) {
+        ModelViolation ("CMD6 outside the transfer state");
+      }
+
+      mModel.Response[0] = ModelCardStatus ();
+      Post              |= ModelSwitch (Mode);
+      break;
+
+    case SD_STOP_TRANSMISSION:
+      mModel.Response[0] = ModelCardStatus ();
+      if (mModel.State == CARD_DATA) {
+        mModel.State = CARD_TRANSFER;
+      }
+
+      Post |= SD_HC_INT_TRANSFER_COMPLETE;
+      break;
+
+    case SD_SEND_STATUS:
+      if (mModel.Argument != ((UINT32)MODEL_RCA << 16)) {
+        ModelViolation ("CMD13 to another card");
+      }
+
+      mModel.Response[0] = ModelCardStatus ();
+      break;
+
+    case SD_SET_BLOCKLEN:
+      if (mModel.CardVersion2 || (mModel.Argument != SD_BLOCK_SIZE)) {
+        ModelViolation ("CMD16 to a high capacity card or not for 512 bytes");
+      }
+
+      mModel.Response[0] = ModelCardStatus ();
+      break;
+
+    case SD_READ_SINGLE_BLOCK:
+    case SD_READ_MULTIPLE_BLOCK:
+    case SD_WRITE_BLOCK:
+    case SD_WRITE_MULTIPLE_BLOCK:
+      mModel.Response[0] = ModelCardStatus ();
+      Post              |= ModelReadWrite (Index, Mode);
+      break;
+
+    case SD_SEND_TUNING_BLOCK:
+      if (!mModel.Signal1V8 || ((mModel.Function != 2) && (mModel.Function != 3)) ||
+          ((mModel.HostControl2 & SD_HC_CTRL2_EXECUTE_TUNING) == 0) || ((Mode & SD_HC_MODE_DMA) != 0))
+      {
+        ModelViolation ("CMD19 outside tuning of SDR50 or SDR104");
+      }
+
+      mModel.Response[0] = ModelCardStatus ();
+      Post              |= SD_HC_INT_BUFFER_READ_READY;
+      if (++mModel.TuningBlocks >= MODEL_TUNING_BLOCKS) {
+        mModel.HostControl2 &= ~SD_HC_CTRL2_EXECUTE_TUNING;
+        if (!mModel.TuningFails) {
+          mModel.HostControl2 |= SD_HC_CTRL2_SAMPLING_CLOCK;
+        }
+      }
+
+      break;
+
+    case SD_SET_BLOCK_COUNT:
+      if (!mModel.CardCmd23) {
+        ModelViolation ("CMD23 to a card without it");
+        Post = SD_HC_INT_CMD_TIMEOUT;
+        break;
+      }
+
+      mModel.BlockCount  = mModel.Argument;
+      mModel.Response[0] = ModelCardStatus ();
+      break;
+
+    default:
+      ModelViolation ("unknown command");
+      Post = SD_HC_INT_CMD_TIMEOUT;
+  }
+
+  mModel.IntStatus |= Post & mModel.IntStatusEnable;
+}
+
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  )
+{
+  switch (Address - MODEL_BASE) {
+    case SD_HC_PRESENT_STATE:
+      //
+      // The card lets DAT go once the host is at 1.8 V and clocks it.
+      //
+      if (mModel.Switching && !mModel.SwitchFails && mModel.IoLow &&
+          ((mModel.HostControl2 & SD_HC_CTRL2_SIGNAL_1V8) != 0) && (ModelCardClock () != 0))
+      {
+        mModel.Switching = FALSE;
+        mModel.Signal1V8 = TRUE;
+      }
+
+      return mModel.Switching ? 0 : SD_HC_PRESENT_DAT_LINES;
+
+    case SD_HC_HOST_CONTROL:
+      return mModel.HostControl;
+
+    case SD_HC_CLOCK_CONTROL:
+      return mModel.ClockControl | (((mModel.ClockControl & SD_HC_CLOCK_INTERNAL) != 0) ? SD_HC_CLOCK_STABLE : 0);
+
+    case SD_HC_INT_STATUS:
+      return mModel.IntStatus | (((mModel.IntStatus & SD_HC_INT_ERRORS) != 0) ? SD_HC_INT_ERROR : 0);
+
+    case SD_HC_INT_STATUS_ENABLE:
+      return mModel.IntStatusEnable;
+
+    case SD_HC_HOST_CONTROL2:
+      return mModel.HostControl2;
+
+    case SD_HC_CAPABILITIES:
+      return (mModel.BaseClockMhz << 8) | SD_HC_CAP_ADMA2 | SD_HC_CAP_HIGH_SPEED | SD_HC_CAP_64BIT | BIT24;
+
+    case SD_HC_CAPABILITIES2:
+      return mModel.Capabilities2;
+
+    case SD_HC_VERSION:
+      return SD_HC_SPEC_300 << 16;
+
+    case SD_HC_RESPONSE:
+    case SD_HC_RESPONSE + 4:
+    case SD_HC_RESPONSE + 8:
+    case SD_HC_RESPONSE + 12:
+      return mModel.Response[(Address - MODEL_BASE - SD_HC_RESPONSE) / 4];
+
+    default:
+      return 0;
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioReadBlock32 (
+  IN  UINTN   Address,
+  IN  UINTN   Count,
+  OUT UINT32  *Buffer
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    Buffer[Index] = PlatformMmioRead32 (Address + Index * 4);
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  switch (Address - MODEL_BASE) {
+    case SD_HC_BLOCK:
+      mModel.Block = Value;
+      break;
+
+    case SD_HC_ARGUMENT:
+      mModel.Argument = Value;
+      break;
+
+    case SD_HC_COMMAND:
+      ModelCommand (Value);
+      break;
+
+    case SD_HC_HOST_CONTROL:
+      mModel.HostControl = Value;
+      break;
+
+    case SD_HC_CLOCK_CONTROL:
+      if ((Value & SD_HC_RESET_ALL) != 0) {
+        mModel.HostControl     = 0;
+        mModel.HostControl2    = 0;
+        mModel.ClockControl    = 0;
+        mModel.IntStatus       = 0;
+        mModel.IntStatusEnable = 0;
+        mModel.Block           = 0;
+        mModel.AdmaAddress     = 0;
+        break;
+      }
+
+      if ((Value & (SD_HC_RESET_CMD | SD_HC_RESET_DAT)) != 0) {
+        mModel.IntStatus = 0;
+      }
+
+      mModel.ClockControl = Value & ~(SD_HC_RESET_ALL | SD_HC_RESET_CMD | SD_HC_RESET_DAT | SD_HC_CLOCK_STABLE);
+      break;
+
+    case SD_HC_INT_STATUS:
+      mModel.IntStatus &= ~Value;
+      break;
+
+    case SD_HC_INT_STATUS_ENABLE:
+      mModel.IntStatusEnable = Value;
+      break;
+
+    case SD_HC_HOST_CONTROL2:
+      if (((Value & SD_HC_CTRL2_EXECUTE_TUNING) != 0) && ((mModel.HostControl2 & SD_HC_CTRL2_EXECUTE_TUNING) == 0)) {
+        mModel.TuningBlocks = 0;
+      }
+
+      mModel.HostControl2 = Value & 0xFFFF0000;
+      break;
+
+    case SD_HC_ADMA_ADDRESS:
+      mModel.AdmaAddress = (mModel.AdmaAddress & 0xFFFFFFFF00000000ULL) | Value;
+      break;
+
+    case SD_HC_ADMA_ADDRESS + 4:
+      mModel.AdmaAddress = (mModel.AdmaAddress & 0xFFFFFFFF) | ((UINT64)Value << 32);
+      break;
+
+    default:
+      break;
+  }
+}
+
+//
+// Scenarios
+//
+
+typedef struct {
+  CONST char    *Name;
+  UINT32        BaseClockMhz;
+  UINT32        Capabilities2;
+  BOOLEAN       CardVersion2;
+  BOOLEAN       CardUhs;
+  UINT8         CardFunctions;
+  BOOLEAN       CardCmd23;
+  BOOLEAN       SwitchFails;
+  BOOLEAN       TuningFails;
+  SD_TIMING     MaxTiming;
+  SD_TIMING     Timing;               // expected
+  UINT32        MinMBps;              // expected 32 MB read throughput
+} SCENARIO;
+
+STATIC
+VOID
+ModelReset (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  free (mModel.Disk);
+  memset (&mModel, 0, sizeof (mModel));
+  mModel.BaseClockMhz  = Scenario->BaseClockMhz;
+  mModel.Capabilities2 = Scenario->Capabilities2;
+  mModel.CardVersion2  = Scenario->CardVersion2;
+  mModel.CardUhs       = Scenario->CardUhs;
+  mModel.CardFunctions = Scenario->CardFunctions;
+  mModel.CardCmd23     = Scenario->CardCmd23;
+  mModel.SwitchFails   = Scenario->SwitchFails;
+  mModel.TuningFails   = Scenario->TuningFails;
+  mModel.FailLba       = MAX_UINT64;
+  mModel.Disk          = calloc (1, MODEL_DISK_SIZE);
+}
+
+STATIC
+BOOLEAN
+StartCard (
+  IN  CONST SCENARIO  *Scenario,
+  OUT SD_HOST         *Host
+  )
+{
+  EFI_STATUS  Status;
+
+  ModelReset (Scenario);
+  memset (Host, 0, sizeof (*Host));
+  Host->Base         = MODEL_BASE;
+  Host->MaxTiming    = Scenario->MaxTiming;
+  Host->SetPower     = ModelSetPower;
+  Host->SetIoVoltage = ModelSetIoVoltage;
+
+  Status = SdCardInit (Host);
+  CHECK (Status == EFI_SUCCESS, "card started");
+  return !EFI_ERROR (Status);
+}
+
+STATIC
+VOID
+Fill (
+  IN UINT8   *Buffer,
+  IN UINTN   Size,
+  IN UINT64  Seed
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Size; Index++) {
+    Buffer[Index] = (UINT8)((Index * 131 + Seed * 7) ^ (Index >> 9));
+  }
+}
+
+/**
+  Write Blocks at Lba, read them back and count the commands each way.
+**/
+STATIC
+VOID
+CheckRoundTrip (
+  IN SD_HOST  *Host,
+  IN UINT64   Lba,
+  IN UINTN    Blocks
+  )
+{
+  UINT8       *Buffer;
+  UINT8       *Readback;
+  UINTN       Size;
+  UINT64      Commands;
+  UINT64      Multi;
+  UINT64      DataCommands;
+  UINT64      SetCounts;
+  UINT64      AutoStops;
+  UINTN       Pass;
+  EFI_STATUS  Status;
+
+  Size     = Blocks * SD_BLOCK_SIZE;
+  Buffer   = aligned_alloc (EFI_PAGE_SIZE, Size);
+  Readback = aligned_alloc (EFI_PAGE_SIZE, Size);
+  Fill (Buffer, Size, Lba + Blocks);
+  memset (Readback, 0xA5, Size);
+
+  Commands = (Blocks + SD_MAX_BLOCKS - 1) / SD_MAX_BLOCKS;
+  Multi    = Blocks / SD_MAX_BLOCKS + ((Blocks % SD_MAX_BLOCKS) > 1 ? 1 : 0);
+  for (Pass = 0; Pass < 2; Pass++) {
+    DataCommands = mModel.DataCommands;
+    SetCounts    = mModel.Commands[SD_SET_BLOCK_COUNT];
+    AutoStops    = mModel.AutoStops;
+    Status       = SdCardTransfer (Host, Lba, Blocks, (Pass == 0) ? Buffer : Readback, Pass == 0);
+    CHECK (Status == EFI_SUCCESS, "transfer succeeded");
+    CHECK (mModel.DataCommands - DataCommands == Commands, "one data command per descriptor table");
+    if (mModel.CardCmd23) {
+      CHECK (mModel.Commands[SD_SET_BLOCK_COUNT] - SetCounts == Multi, "CMD23 before each multiple block command");
+      CHECK (mModel.AutoStops == AutoStops, "no auto CMD12 with CMD23");
+    } else {
+      CHECK (mModel.AutoStops - AutoStops == Multi, "auto CMD12 after each multiple block command");
+    }
+  }
+
+  CHECK (memcmp (mModel.Disk + Lba * SD_BLOCK_SIZE, Buffer, Size) == 0, "data written to the card");
+  CHECK (memcmp (Readback, Buffer, Size) == 0, "data read back");
+  free (Buffer);
+  free (Readback);
+}
+
+STATIC
+VOID
+TestScenario (
+  IN CONST SCENARIO  *Scenario
+  )
+{
+  SD_HOST  Host;
+  UINT8    *Buffer;
+  UINT64   MBps;
+
+  printf ("%s\n", Scenario->Name);
+  if (!StartCard (Scenario, &Host)) {
+    return;
+  }
+
+  CHECK (Host.Timing == Scenario->Timing, "bus timing");
+  CHECK (Host.Blocks == MODEL_BLOCKS, "capacity");
+  CHECK (Host.HighCapacity == Scenario->CardVersion2, "addressing");
+  CHECK (Host.SetBlockCount == Scenario->CardCmd23, "CMD23 use");
+  CHECK (mModel.Wide, "4-bit bus");
+  if (Scenario->MaxTiming <= SdTimingHighSpeed) {
+    CHECK (mModel.Commands[SD_VOLTAGE_SWITCH] == 0, "no voltage switch");
+  }
+
+  if (Scenario->SwitchFails) {
+    CHECK (mModel.PowerCycles >= 2 && !mModel.Signal1V8, "power cycled back to 3.3 V");
+  }
+
+  CheckRoundTrip (&Host, 0, 1);
+  CheckRoundTrip (&Host, 1, 2);
+  CheckRoundTrip (&Host, 9, 7);
+  CheckRoundTrip (&Host, 100, 128);
+  CheckRoundTrip (&Host, 4096, 2048);
+  CheckRoundTrip (&Host, 20000, SD_MAX_BLOCKS + 3);
+  CheckRoundTrip (&Host, MODEL_BLOCKS - 5, 5);
+
+  //
+  // 32 MB read at the bus clock the card ended up at
+  //
+  Buffer       = aligned_alloc (EFI_PAGE_SIZE, 32 * SIZE_1MB);
+  mModel.BusNs = 0;
+  CHECK (SdCardTransfer (&Host, 0, 32 * SIZE_1MB / SD_BLOCK_SIZE, Buffer, FALSE) == EFI_SUCCESS, "32 MB read");
+  MBps = 32 * 1000000000ULL / MAX (mModel.BusNs, 1);
+  printf (
+    "  %u kHz, 32 MB read at %llu MB/s, up to %llu descriptors per command, %llu allocation\n",
+    Host.Clock / 1000,
+    (unsigned long long)MBps,
+    (unsigned long long)mModel.MaxDescriptors,
+    (unsigned long long)mModel.Allocations
+    );
+  CHECK (MBps >= Scenario->MinMBps, "throughput");
+  CHECK (mModel.Allocations == 1, "descriptor table allocated once");
+  CHECK (mModel.Violations == 0, "no protocol violations");
+  free (Buffer);
+  FreeAlignedPages (Host.AdmaTable, 0);
+}
+
+STATIC
+VOID
+TestFailure (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenario = {
+    "Failed read", 200, SD_HC_CAP2_UHS, TRUE, TRUE, 0x1F, TRUE, FALSE, FALSE, SdTimingSdr104, SdTimingSdr104, 0
+  };
+  SD_HOST                Host;
+  UINT8                  *Buffer;
+  EFI_STATUS             Status;
+
+  printf ("%s\n", Scenario.Name);
+  if (!StartCard (&Scenario, &Host)) {
+    return;
+  }
+
+  Buffer         = aligned_alloc (EFI_PAGE_SIZE, 2 * SIZE_1MB);
+  mModel.FailLba = 5000;
+  Status         = SdCardTransfer (&Host, 2000, 4096, Buffer, FALSE);
+  CHECK (EFI_ERROR (Status), "failure reported");
+  CHECK (mModel.State == CARD_TRANSFER, "card stopped and back in the transfer state");
+  CHECK (mModel.Commands[SD_STOP_TRANSMISSION] == 1, "one CMD12");
+
+  Status = SdCardTransfer (&Host, 6000, 64, Buffer, FALSE);
+  CHECK (Status == EFI_SUCCESS, "next read succeeds");
+  mModel.FailLba = MAX_UINT64;
+  CHECK (mModel.Violations == 0, "no protocol violations");
+  free (Buffer);
+  FreeAlignedPages (Host.AdmaTable, 0);
+}
+
+int
+main (
+  VOID
+  )
+{
+  STATIC CONST SCENARIO  Scenarios[] = {
+    { "SDR104, CMD23",                     200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x1F, TRUE,  FALSE, FALSE, SdTimingSdr104,    SdTimingSdr104,    80 },
+    { "DDR50 card",                        200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x17, TRUE,  FALSE, FALSE, SdTimingSdr104,    SdTimingDdr50,     40 },
+    { "SDR50 card, tuned",                 200, SD_HC_CAP2_UHS | SD_HC_CAP2_TUNING_SDR50,  TRUE,  TRUE,  0x07, TRUE,  FALSE, FALSE, SdTimingSdr104,    SdTimingSdr50,     40 },
+    { "3.3 V card",                        200, SD_HC_CAP2_UHS,                            TRUE,  FALSE, 0x03, TRUE,  FALSE, FALSE, SdTimingSdr104,    SdTimingHighSpeed, 20 },
+    { "Controller without UHS-I",          100, 0,                                         TRUE,  TRUE,  0x1F, TRUE,  FALSE, FALSE, SdTimingSdr104,    SdTimingHighSpeed, 20 },
+    { "No CMD23, auto CMD12",              200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x1F, FALSE, FALSE, FALSE, SdTimingSdr104,    SdTimingSdr104,    80 },
+    { "Tuning fails, DDR50",               200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x1F, TRUE,  FALSE, TRUE,  SdTimingSdr104,    SdTimingDdr50,     40 },
+    { "Voltage switch fails, 3.3 V",       200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x1F, TRUE,  TRUE,  FALSE, SdTimingSdr104,    SdTimingHighSpeed, 20 },
+    { "SDSC card, byte addressed",         200, SD_HC_CAP2_UHS,                            FALSE, FALSE, 0x03, FALSE, FALSE, FALSE, SdTimingSdr104,    SdTimingHighSpeed, 20 },
+    { "Built for 3.3 V high speed",        200, SD_HC_CAP2_UHS,                            TRUE,  TRUE,  0x1F, TRUE,  FALSE, FALSE, SdTimingHighSpeed, SdTimingHighSpeed, 20 },
+  };
+  UINTN                  Index;
+
+  for (Index = 0; Index < sizeof (Scenarios) / sizeof (Scenarios[0]); Index++) {
+    TestScenario (&Scenarios[Index]);
+  }
+
+  TestFailure ();
+
+  return HostTestResult ();
+}
@@ -0,0 +1,545 @@
+/** @file
+  SD card bring-up and block transfers of SdHostDxe.
+
+  The card is identified at 400 kHz and 3.3 V, asked for 1.8 V
+  signalling when the controller has UHS-I modes, put on a 4-bit bus and
+  switched to the fastest bus speed both sides support: SDR104 (tuned),
+  then DDR50, SDR50 and high speed. A UHS-I bring-up that fails is
+  retried from power off at 3.3 V.
+
+  Reads and writes of more than one block are single CMD18/CMD25
+  commands of up to SD_MAX_BLOCKS blocks. Their length is set up front
+  with CMD23 when the card supports it, otherwise the controller stops
+  them with CMD12.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SdHc.h"
+
+//
+// Group 1 function of each bus timing
+//
+STATIC CONST UINT8  mSdCardFunction[SdTimingMax] = { 0, 1, 2, 4, 3 };
+
+//
+// Controller capability each UHS-I timing needs
+//
+STATIC CONST UINT32  mSdCardHostSupport[SdTimingMax] = {
+  0,
+  0,
+  SD_HC_CAP2_SDR50,
+  SD_HC_CAP2_DDR50,
+  SD_HC_CAP2_SDR104
+};
+
+/**
+  Send a command without data.
+
+  @param  Host          Host controller.
+  @param  Index         Command index.
+  @param  Argument      Command argument.
+  @param  ResponseType  Response of the command.
+  @param  Response      First dword of the response, or NULL.
+
+  @return Status of SdHcCommand.
+**/
+STATIC
+EFI_STATUS
+SdCardCommand (
+  IN  SD_HOST           *Host,
+  IN  UINT8             Index,
+  IN  UINT32            Argument,
+  IN  SD_RESPONSE_TYPE  ResponseType,
+  OUT UINT32            *Response OPTIONAL
+  )
+{
+  SD_COMMAND  Command;
+  EFI_STATUS  Status;
+
+  ZeroMem (&Command, sizeof (Command));
+  Command.Index        = Index;
+  Command.Argument     = Argument;
+  Command.ResponseType = ResponseType;
+  Status               = SdHcCommand (Host, &Command);
+  if (Response != NULL) {
+    *Response = Command.Response[0];
+  }
+
+  return Status;
+}
+
+/**
+  Read a card register of Size bytes into Host->Scratch with an
+  addressed or application command.
+
+  @param  Host          Host controller with a selected card.
+  @param  App           TRUE for an application command.
+  @param  Index         Command index.
+  @param  Argument      Command argument.
+  @param  Size          Bytes to read, at most SD_SCRATCH_SIZE.
+
+  @return Status of SdHcCommand.
+**/
+STATIC
+EFI_STATUS
+SdCardReadRegister (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  App,
+  IN UINT8    Index,
+  IN UINT32   Argument,
+  IN UINT32   Size
+  )
+{
+  SD_COMMAND  Command;
+  EFI_STATUS  Status;
+
+  if (App) {
+    Status = SdCardCommand (Host, SD_APP_CMD, (UINT32)Host->Rca << 16, SdResponseR1, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  ZeroMem (&Command, sizeof (Command));
+  Command.Index        = Index;
+  Command.Argument     = Argument;
+  Command.ResponseType = SdResponseR1;
+  Command.Data         = Host->Scratch;
+  Command.BlockSize    = Size;
+  Command.Blocks       = 1;
+  return SdHcCommand (Host, &Command);
+}
+
+/**
+  Extract a field of the CSD. The controller drops the CRC byte of an
+  R2 response, so CSD bit n is bit n - 8 of Host->Csd.
+
+  @param  Host          Host controller.
+  @param  Start         Lowest CSD bit of the field.
+  @param  Width         Width of the field, at most 32.
+
+  @return Field value.
+**/
+STATIC
+UINT32
+SdCardCsd (
+  IN SD_HOST  *Host,
+  IN UINTN    Start,
+  IN UINTN    Width
+  )
+{
+  UINTN   Bit;
+  UINT64  Value;
+
+  Bit   = Start - 8;
+  Value = RShiftU64 (Host->Csd[Bit / 32], Bit % 32);
+  if ((Bit / 32 < 3) && ((Bit % 32) + Width > 32)) {
+    Value |= LShiftU64 (Host->Csd[Bit / 32 + 1], 32 - (Bit % 32));
+  }
+
+  return (UINT32)(Value & (LShiftU64 (1, Width) - 1));
+}
+
+/**
+  Work out the capacity of the card from its CSD.
+
+  @param  Host          Host controller with Csd read.
+
+  @retval EFI_SUCCESS       Host->Blocks set.
+  @retval EFI_UNSUPPORTED   Unknown CSD structure.
+**/
+STATIC
+EFI_STATUS
+SdCardParseCsd (
+  IN SD_HOST  *Host
+  )
+{
+  UINT32  Size;
+
+  switch (SdCardCsd (Host, 126, 2)) {
+    case 0:
+      //
+      // Standard capacity: (C_SIZE + 1) << (C_SIZE_MULT + 2) blocks of
+      // 2^READ_BL_LEN bytes
+      //
+      Size         = SdCardCsd (Host, 62, 12) + 1;
+      Host->Blocks = RShiftU64 (LShiftU64 (Size, SdCardCsd (Host, 47, 3) + 2 + SdCardCsd (Host, 80, 4)), 9);
+      return EFI_SUCCESS;
+
+    case 1:
+    case 2:
+      //
+      // High and ultra capacity: (C_SIZE + 1) * 512 KB
+      //
+      Size         = SdCardCsd (Host, 48, 28) + 1;
+      Host->Blocks = LShiftU64 (Size, 10);
+      return EFI_SUCCESS;
+
+    default:
+      return EFI_UNSUPPORTED;
+  }
+}
+
+/**
+  Switch the card and the controller to the fastest bus timing they
+  both support, tuning the controller where the timing needs it.
+
+  @param  Host          Host controller with a selected card on a 4-bit bus.
+
+  @retval EFI_SUCCESS   Host->Timing is in effect.
+  @retval others        The card did not answer at the default timing.
+**/
+STATIC
+EFI_STATUS
+SdCardSelectTiming (
+  IN SD_HOST  *Host
+  )
+{
+  EFI_STATUS  Status;
+  SD_TIMING   Timing;
+  UINT8       Supported;
+  BOOLEAN     Tune;
+
+  Status = SdHcSetTiming (Host, SdTimingDefault);
+  if (EFI_ERROR (Status) || (SD_SCR_SPEC (Host->Scr) == 0)) {
+    return Status;
+  }
+
+  //
+  // Cards from version 1.10 tell their bus speeds with CMD6.
+  //
+  Status = SdCardReadRegister (Host, FALSE, SD_SWITCH_FUNC, SD_SWITCH_CHECK, SD_SWITCH_STATUS_SIZE);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[SD] Switch function check failed: %r\n", Status));
+    return EFI_SUCCESS;
+  }
+
+  Supported = Host->Scratch[SD_SWITCH_SUPPORT];
+  for (Timing = Host->MaxTiming; Timing > SdTimingDefault; Timing--) {
+    if ((Supported & (1 << mSdCardFunction[Timing])) == 0) {
+      continue;
+    }
+
+    if (Timing == SdTimingHighSpeed) {
+      if (!Host->Signal1V8 && ((Host->Capabilities & SD_HC_CAP_HIGH_SPEED) == 0)) {
+        continue;
+      }
+    } else if (!Host->Signal1V8 || ((Host->Capabilities2 & mSdCardHostSupport[Timing]) == 0)) {
+      continue;
+    }
+
+    Status = SdCardReadRegister (Host, FALSE, SD_SWITCH_FUNC, SD_SWITCH_SET | mSdCardFunction[Timing], SD_SWITCH_STATUS_SIZE);
+    if (EFI_ERROR (Status) || ((Host->Scratch[SD_SWITCH_RESULT] & 0xF) != mSdCardFunction[Timing])) {
+      DEBUG ((DEBUG_WARN, "[SD] Card refused bus speed function %d\n", mSdCardFunction[Timing]));
+      continue;
+    }
+
+    Status = SdHcSetTiming (Host, Timing);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Tune = (Timing == SdTimingSdr104) ||
+           ((Timing == SdTimingSdr50) && ((Host->Capabilities2 & SD_HC_CAP2_TUNING_SDR50) != 0));
+    if (!Tune || !EFI_ERROR (SdHcTune (Host))) {
+      return EFI_SUCCESS;
+    }
+
+    //
+    // Untuned, try the next timing down; the card takes CMD6 again at
+    // the default clock.
+    //
+    Status = SdHcSetTiming (Host, SdTimingDefault);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Identify and select the card, then set up its bus.
+
+  @param  Host          Host controller, just through SdHcInit.
+  @param  Uhs           TRUE to ask the card for 1.8 V signalling.
+
+  @retval EFI_SUCCESS   The card is ready for transfers.
+  @retval others        It is not.
+**/
+STATIC
+EFI_STATUS
+SdCardStart (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Uhs
+  )
+{
+  EFI_STATUS  Status;
+  SD_COMMAND  Command;
+  UINT32      Response;
+  UINT32      Argument;
+  UINTN       Attempt;
+  BOOLEAN     Version2;
+
+  Host->Rca           = 0;
+  Host->HighCapacity  = FALSE;
+  Host->SetBlockCount = FALSE;
+  Host->Blocks        = 0;
+
+  SdCardCommand (Host, SD_GO_IDLE_STATE, 0, SdResponseNone, NULL);
+
+  //
+  // Only cards of version 2.00 and later answer CMD8.
+  //
+  Status = SdCardCommand (Host, SD_SEND_IF_COND, SD_IF_COND_PATTERN, SdResponseR7, &Response);
+  if (Status == EFI_NO_RESPONSE) {
+    Version2 = FALSE;
+  } else if (EFI_ERROR (Status)) {
+    return Status;
+  } else if ((Response & 0xFFF) != SD_IF_COND_PATTERN) {
+    DEBUG ((DEBUG_ERROR, "[SD] Card rejected the interface conditions: 0x%x\n", Response));
+    return EFI_UNSUPPORTED;
+  } else {
+    Version2 = TRUE;
+  }
+
+  Argument = SD_OCR_VDD_32_34;
+  if (Version2) {
+    Argument |= SD_OCR_HCS | (Uhs ? SD_OCR_S18 : 0);
+  }
+
+  for (Attempt = 0; Attempt < SD_OP_COND_TIMEOUT / SD_OP_COND_INTERVAL; Attempt++) {
+    Status = SdCardCommand (Host, SD_APP_CMD, 0, SdResponseR1, NULL);
+    if (!EFI_ERROR (Status)) {
+      Status = SdCardCommand (Host, SD_APP_SEND_OP_COND, Argument, SdResponseR3, &Host->Ocr);
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "[SD] No card: %r\n", Status));
+      return Status;
+    }
+
+    if ((Host->Ocr & SD_OCR_BUSY) != 0) {
+      break;
+    }
+
+    MicroSecondDelay (SD_OP_COND_INTERVAL);
+  }
+
+  if ((Host->Ocr & SD_OCR_BUSY) == 0) {
+    DEBUG ((DEBUG_ERROR, "[SD] Card stayed busy powering up\n"));
+    return EFI_TIMEOUT;
+  }
+
+  Host->HighCapacity = Version2 && ((Host->Ocr & SD_OCR_HCS) != 0);
+  if (Uhs && Version2 && ((Host->Ocr & SD_OCR_S18) != 0)) {
+    Status = SdCardCommand (Host, SD_VOLTAGE_SWITCH, 0, SdResponseR1, NULL);
+    if (!EFI_ERROR (Status)) {
+      Status = SdHcSwitchVoltage (Host);
+    }
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  ZeroMem (&Command, sizeof (Command));
+  Command.Index        = SD_ALL_SEND_CID;
+  Command.ResponseType = SdResponseR2;
+  Status               = SdHcCommand (Host, &Command);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  CopyMem (Host->Cid, Command.Response, sizeof (Host->Cid));
+
+  Status = SdCardCommand (Host, SD_SEND_RELATIVE_ADDR, 0, SdResponseR6, &Response);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Host->Rca            = (UINT16)(Response >> 16);
+  Command.Index        = SD_SEND_CSD;
+  Command.Argument     = (UINT32)Host->Rca << 16;
+  Status               = SdHcCommand (Host, &Command);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  CopyMem (Host->Csd, Command.Response, sizeof (Host->Csd));
+  Status = SdCardParseCsd (Host);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[SD] Unknown CSD structure\n"));
+    return Status;
+  }
+
+  Status = SdCardCommand (Host, SD_SELECT_CARD, (UINT32)Host->Rca << 16, SdResponseR1b, NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SdCardReadRegister (Host, TRUE, SD_APP_SEND_SCR, 0, SD_SCR_SIZE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  CopyMem (Host->Scr, Host->Scratch, SD_SCR_SIZE);
+  Host->SetBlockCount = (Host->Scr[3] & SD_SCR_CMD23) != 0;
+
+  if ((Host->Scr[1] & SD_SCR_BUS_WIDTH_4) != 0) {
+    Status = SdCardCommand (Host, SD_APP_CMD, (UINT32)Host->Rca << 16, SdResponseR1, NULL);
+    if (!EFI_ERROR (Status)) {
+      Status = SdCardCommand (Host, SD_APP_SET_BUS_WIDTH, SD_BUS_WIDTH_4, SdResponseR1, NULL);
+    }
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    SdHcSetBusWidth (Host, TRUE);
+  }
+
+  if (!Host->HighCapacity) {
+    Status = SdCardCommand (Host, SD_SET_BLOCKLEN, SD_BLOCK_SIZE, SdResponseR1, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return SdCardSelectTiming (Host);
+}
+
+EFI_STATUS
+SdCardInit (
+  IN OUT SD_HOST  *Host
+  )
+{
+  EFI_STATUS  Status;
+  BOOLEAN     Uhs;
+
+  Status = SdHcInit (Host);
+  if (!EFI_ERROR (Status)) {
+    Uhs    = (Host->MaxTiming > SdTimingHighSpeed) && ((Host->Capabilities2 & SD_HC_CAP2_UHS) != 0);
+    Status = SdCardStart (Host, Uhs);
+    if (EFI_ERROR (Status) && Uhs) {
+      //
+      // A card only leaves 1.8 V signalling by losing power.
+      //
+      DEBUG ((DEBUG_WARN, "[SD] UHS-I bring-up failed (%r), retrying at 3.3 V\n", Status));
+      Status = SdHcInit (Host);
+      if (!EFI_ERROR (Status)) {
+        Status = SdCardStart (Host, FALSE);
+      }
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    SdHcPowerOff (Host);
+    return Status;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "[SD] %a card, %lu MB, timing %d at %d kHz, %a\n",
+    Host->HighCapacity ? "SDHC/SDXC" : "SDSC",
+    RShiftU64 (Host->Blocks, 11),
+    Host->Timing,
+    Host->Clock / 1000,
+    Host->SetBlockCount ? "CMD23" : "auto CMD12"
+    ));
+  return EFI_SUCCESS;
+}
+
+/**
+  Bring the card back to the transfer state after a failed transfer.
+
+  @param  Host          Host controller.
+  @param  Stop          TRUE to end a multiple block command.
+**/
+STATIC
+VOID
+SdCardRecover (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Stop
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      CardStatus;
+  UINTN       Attempt;
+
+  if (Stop) {
+    SdCardCommand (Host, SD_STOP_TRANSMISSION, 0, SdResponseR1b, NULL);
+  }
+
+  for (Attempt = 0; Attempt < SD_HC_BUSY_TIMEOUT / SD_OP_COND_INTERVAL; Attempt++) {
+    Status = SdCardCommand (Host, SD_SEND_STATUS, (UINT32)Host->Rca << 16, SdResponseR1, &CardStatus);
+    if (!EFI_ERROR (Status) &&
+        (SD_R1_STATE (CardStatus) == SD_STATE_TRANSFER) &&
+        ((CardStatus & SD_R1_READY_FOR_DATA) != 0))
+    {
+      return;
+    }
+
+    MicroSecondDelay (SD_OP_COND_INTERVAL);
+  }
+
+  DEBUG ((DEBUG_ERROR, "[SD] Card did not return to the transfer state\n"));
+}
+
+EFI_STATUS
+SdCardTransfer (
+  IN SD_HOST  *Host,
+  IN EFI_LBA  Lba,
+  IN UINTN    Blocks,
+  IN VOID     *Buffer,
+  IN BOOLEAN  Write
+  )
+{
+  EFI_STATUS  Status;
+  SD_COMMAND  Command;
+  UINT32      Count;
+
+  while (Blocks > 0) {
+    Count = (UINT32)MIN (Blocks, SD_MAX_BLOCKS);
+
+    ZeroMem (&Command, sizeof (Command));
+    Command.Argument     = Host->HighCapacity ? (UINT32)Lba : (UINT32)(Lba * SD_BLOCK_SIZE);
+    Command.ResponseType = SdResponseR1;
+    Command.Data         = Buffer;
+    Command.BlockSize    = SD_BLOCK_SIZE;
+    Command.Blocks       = Count;
+    Command.Write        = Write;
+
+    if (Count == 1) {
+      Command.Index = Write ? SD_WRITE_BLOCK : SD_READ_SINGLE_BLOCK;
+      Status        = EFI_SUCCESS;
+    } else {
+      Command.Index = Write ? SD_WRITE_MULTIPLE_BLOCK : SD_READ_MULTIPLE_BLOCK;
+      if (Host->SetBlockCount) {
+        Status = SdCardCommand (Host, SD_SET_BLOCK_COUNT, Count, SdResponseR1, NULL);
+      } else {
+        Command.AutoStop = TRUE;
+        Status           = EFI_SUCCESS;
+      }
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Status = SdHcCommand (Host, &Command);
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[SD] CMD%d of %d blocks at %lu failed: %r\n", Command.Index, Count, Lba, Status));
+      SdCardRecover (Host, Count > 1);
+      return Status;
+    }
+
+    Lba    += Count;
+    Blocks -= Count;
+    Buffer  = (UINT8 *)Buffer + (UINTN)Count * SD_BLOCK_SIZE;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,590 @@
+/** @file
+  SDHCI controller access of SdHostDxe.
+
+  Commands are polled: the controller raises no interrupt, the status
+  bits are only read. Data moves by 64-bit ADMA2 straight to and from
+  the caller's buffer, described by the descriptor table allocated once
+  at init; the buffer is cleaned or invalidated around the transfer.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SdHc.h"
+
+//
+// Highest card clock and UHS mode of each timing
+//
+STATIC CONST UINT32  mSdHcTimingClock[SdTimingMax] = {
+  25000000,
+  50000000,
+  100000000,
+  50000000,
+  208000000
+};
+
+STATIC CONST UINT8  mSdHcTimingMode[SdTimingMax] = {
+  SD_HC_UHS_SDR12,
+  SD_HC_UHS_SDR25,
+  SD_HC_UHS_SDR50,
+  SD_HC_UHS_DDR50,
+  SD_HC_UHS_SDR104
+};
+
+//
+// Command register flags of each response type
+//
+STATIC CONST UINT32  mSdHcResponseFlags[] = {
+  0,                                                                          // none
+  SD_HC_CMD_RESPONSE_48 | SD_HC_CMD_CRC_CHECK | SD_HC_CMD_INDEX_CHECK,        // R1
+  SD_HC_CMD_RESPONSE_BUSY | SD_HC_CMD_CRC_CHECK | SD_HC_CMD_INDEX_CHECK,      // R1b
+  SD_HC_CMD_RESPONSE_136 | SD_HC_CMD_CRC_CHECK,                               // R2
+  SD_HC_CMD_RESPONSE_48,                                                      // R3
+  SD_HC_CMD_RESPONSE_48 | SD_HC_CMD_CRC_CHECK | SD_HC_CMD_INDEX_CHECK,        // R6
+  SD_HC_CMD_RESPONSE_48 | SD_HC_CMD_CRC_CHECK | SD_HC_CMD_INDEX_CHECK         // R7
+};
+
+typedef struct {
+  SD_HOST    *Host;
+  UINT32     Mask;
+} SD_HC_WAIT;
+
+/**
+  Wait condition: one of the interrupt status bits is set.
+
+  @param  Context       SD_HC_WAIT.
+
+  @retval TRUE          A bit of Mask is set.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+SdHcInterruptPending (
+  IN VOID  *Context
+  )
+{
+  SD_HC_WAIT  *Wait;
+
+  Wait = Context;
+  return (PlatformMmioRead32 (Wait->Host->Base + SD_HC_INT_STATUS) & Wait->Mask) != 0;
+}
+
+/**
+  Wait for an interrupt status bit of Mask or an error.
+
+  @param  Host          Host controller.
+  @param  Mask          Status bits to wait for.
+  @param  Timeout       Timeout in microseconds.
+  @param  IntStatus     Interrupt status when the wait ended.
+
+  @retval EFI_SUCCESS   A bit of Mask or an error is set.
+  @retval EFI_TIMEOUT   Neither is set.
+**/
+STATIC
+EFI_STATUS
+SdHcWaitInterrupt (
+  IN  SD_HOST  *Host,
+  IN  UINT32   Mask,
+  IN  UINT64   Timeout,
+  OUT UINT32   *IntStatus
+  )
+{
+  SD_HC_WAIT  Wait;
+  EFI_STATUS  Status;
+
+  Wait.Host  = Host;
+  Wait.Mask  = Mask | SD_HC_INT_ERROR | SD_HC_INT_ERRORS;
+  Status     = PlatformWaitCondition (SdHcInterruptPending, &Wait, Timeout, NULL);
+  *IntStatus = PlatformMmioRead32 (Host->Base + SD_HC_INT_STATUS);
+  return Status;
+}
+
+/**
+  Pulse software reset of parts of the controller.
+
+  @param  Host          Host controller.
+  @param  Reset         SD_HC_RESET_ALL, or SD_HC_RESET_CMD and SD_HC_RESET_DAT.
+
+  @retval EFI_SUCCESS   Reset done.
+  @retval EFI_TIMEOUT   The reset did not complete.
+**/
+STATIC
+EFI_STATUS
+SdHcReset (
+  IN SD_HOST  *Host,
+  IN UINT32   Reset
+  )
+{
+  UINTN  Address;
+
+  Address = Host->Base + SD_HC_CLOCK_CONTROL;
+  PlatformMmioWrite32 (Address, PlatformMmioRead32 (Address) | Reset);
+  return PlatformWaitMmio32 (Address, Reset, 0, SD_HC_RESET_TIMEOUT, NULL);
+}
+
+/**
+  Gate or ungate the card clock, leaving the divider alone.
+
+  @param  Host          Host controller.
+  @param  Enable        TRUE to run the card clock.
+**/
+STATIC
+VOID
+SdHcGateClock (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Enable
+  )
+{
+  UINTN   Address;
+  UINT32  Value;
+
+  Address = Host->Base + SD_HC_CLOCK_CONTROL;
+  Value   = PlatformMmioRead32 (Address) & ~(SD_HC_RESET_ALL | SD_HC_RESET_CMD | SD_HC_RESET_DAT);
+  PlatformMmioWrite32 (Address, Enable ? (Value | SD_HC_CLOCK_CARD) : (Value & ~SD_HC_CLOCK_CARD));
+}
+
+EFI_STATUS
+SdHcInit (
+  IN OUT SD_HOST  *Host
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Address;
+
+  SdHcPowerOff (Host);
+  MicroSecondDelay (SD_POWER_OFF_DELAY);
+
+  Status = SdHcReset (Host, SD_HC_RESET_ALL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[SD] Controller reset timeout\n"));
+    return Status;
+  }
+
+  Host->Version       = SD_HC_SPEC_VERSION (PlatformMmioRead32 (Host->Base + SD_HC_VERSION));
+  Host->Capabilities  = PlatformMmioRead32 (Host->Base + SD_HC_CAPABILITIES);
+  Host->Capabilities2 = PlatformMmioRead32 (Host->Base + SD_HC_CAPABILITIES2);
+  if ((Host->Version < SD_HC_SPEC_300) ||
+      ((Host->Capabilities & (SD_HC_CAP_ADMA2 | SD_HC_CAP_64BIT)) != (SD_HC_CAP_ADMA2 | SD_HC_CAP_64BIT)))
+  {
+    DEBUG ((DEBUG_ERROR, "[SD] Controller version %d, capabilities 0x%08x: no 64-bit ADMA2\n", Host->Version, Host->Capabilities));
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Host->BaseClock == 0) {
+    Host->BaseClock = SD_HC_CAP_BASE_CLOCK (Host->Capabilities) * 1000000;
+    if (Host->BaseClock == 0) {
+      DEBUG ((DEBUG_ERROR, "[SD] Base clock unknown\n"));
+      return EFI_UNSUPPORTED;
+    }
+  }
+
+  if (Host->AdmaTable == NULL) {
+    Host->AdmaTable = AllocateAlignedPages (EFI_SIZE_TO_PAGES (SD_ADMA_TABLE_SIZE + SD_SCRATCH_SIZE), EFI_PAGE_SIZE);
+    if (Host->AdmaTable == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Host->Scratch = (UINT8 *)Host->AdmaTable + SD_ADMA_TABLE_SIZE;
+  }
+
+  PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS_ENABLE, SD_HC_INT_ENABLED);
+  PlatformMmioWrite32 (Host->Base + SD_HC_INT_SIGNAL_ENABLE, 0);
+  PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, MAX_UINT32);
+
+  //
+  // 3.3 V signalling and bus power, 1-bit bus, ADMA2
+  //
+  Address = Host->Base + SD_HC_HOST_CONTROL;
+  PlatformMmioWrite32 (Address, SD_HC_CTRL_ADMA2_64 | SD_HC_POWER_330);
+  if (Host->SetPower != NULL) {
+    Host->SetPower (Host, TRUE);
+  }
+
+  PlatformMmioWrite32 (Address, SD_HC_CTRL_ADMA2_64 | SD_HC_POWER_330 | SD_HC_POWER_ON);
+  MicroSecondDelay (SD_POWER_ON_DELAY);
+
+  Host->Signal1V8 = FALSE;
+  Host->Timing    = SdTimingDefault;
+  PlatformMmioWrite32 (Host->Base + SD_HC_CLOCK_CONTROL, SD_HC_TIMEOUT_MAX);
+  Status = SdHcSetClock (Host, 400000);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // 74 clocks before the first command
+  //
+  MicroSecondDelay (SD_CLOCK_RESUME_DELAY);
+  return EFI_SUCCESS;
+}
+
+VOID
+SdHcPowerOff (
+  IN SD_HOST  *Host
+  )
+{
+  SdHcReset (Host, SD_HC_RESET_ALL);
+  if (Host->SetPower != NULL) {
+    Host->SetPower (Host, FALSE);
+  }
+
+  if (Host->SetIoVoltage != NULL) {
+    Host->SetIoVoltage (Host, FALSE);
+  }
+
+  Host->Signal1V8 = FALSE;
+}
+
+EFI_STATUS
+SdHcSetClock (
+  IN SD_HOST  *Host,
+  IN UINT32   Frequency
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Address;
+  UINT32      Value;
+  UINT32      Divider;
+
+  //
+  // The card clock is the base clock divided by twice the divider, or
+  // the base clock itself for a divider of 0.
+  //
+  Divider = 0;
+  if (Host->BaseClock > Frequency) {
+    Divider = (Host->BaseClock + 2 * Frequency - 1) / (2 * Frequency);
+    Divider = MIN (Divider, SD_HC_CLOCK_MAX_DIVIDER);
+  }
+
+  Address = Host->Base + SD_HC_CLOCK_CONTROL;
+  Value   = PlatformMmioRead32 (Address) & ~(SD_HC_CLOCK_MASK | SD_HC_RESET_ALL | SD_HC_RESET_CMD | SD_HC_RESET_DAT);
+  PlatformMmioWrite32 (Address, Value);
+  Value |= SD_HC_CLOCK_DIVIDER (Divider) | SD_HC_CLOCK_INTERNAL;
+  PlatformMmioWrite32 (Address, Value);
+  Status = PlatformWaitMmio32 (Address, SD_HC_CLOCK_STABLE, SD_HC_CLOCK_STABLE, SD_HC_CLOCK_TIMEOUT, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[SD] Internal clock not stable\n"));
+    return Status;
+  }
+
+  PlatformMmioWrite32 (Address, Value | SD_HC_CLOCK_CARD);
+  Host->Clock = (Divider == 0) ? Host->BaseClock : Host->BaseClock / (2 * Divider);
+  return EFI_SUCCESS;
+}
+
+VOID
+SdHcSetBusWidth (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Wide
+  )
+{
+  UINTN   Address;
+  UINT32  Value;
+
+  Address = Host->Base + SD_HC_HOST_CONTROL;
+  Value   = PlatformMmioRead32 (Address);
+  PlatformMmioWrite32 (Address, Wide ? (Value | SD_HC_CTRL_DATA_4BIT) : (Value & ~SD_HC_CTRL_DATA_4BIT));
+}
+
+EFI_STATUS
+SdHcSetTiming (
+  IN SD_HOST    *Host,
+  IN SD_TIMING  Timing
+  )
+{
+  UINTN   Address;
+  UINT32  Value;
+
+  SdHcGateClock (Host, FALSE);
+
+  Address = Host->Base + SD_HC_HOST_CONTROL;
+  Value   = PlatformMmioRead32 (Address);
+  PlatformMmioWrite32 (Address, (Timing == SdTimingDefault) ? (Value & ~SD_HC_CTRL_HIGH_SPEED) : (Value | SD_HC_CTRL_HIGH_SPEED));
+
+  if (Host->Signal1V8) {
+    Address = Host->Base + SD_HC_HOST_CONTROL2;
+    Value   = PlatformMmioRead32 (Address) & ~SD_HC_CTRL2_UHS_MASK;
+    PlatformMmioWrite32 (Address, Value | SD_HC_CTRL2_UHS (mSdHcTimingMode[Timing]));
+  }
+
+  Host->Timing = Timing;
+  return SdHcSetClock (Host, mSdHcTimingClock[Timing]);
+}
+
+EFI_STATUS
+SdHcSwitchVoltage (
+  IN SD_HOST  *Host
+  )
+{
+  UINTN   Address;
+  UINT32  Lines;
+
+  //
+  // The card holds DAT[3:0] low from its response until it has
+  // switched; the clock is stopped while both sides change over.
+  //
+  SdHcGateClock (Host, FALSE);
+  Lines = PlatformMmioRead32 (Host->Base + SD_HC_PRESENT_STATE) & SD_HC_PRESENT_DAT_LINES;
+  if (Lines != 0) {
+    DEBUG ((DEBUG_WARN, "[SD] Card did not start the voltage switch\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  Address = Host->Base + SD_HC_HOST_CONTROL2;
+  PlatformMmioWrite32 (Address, PlatformMmioRead32 (Address) | SD_HC_CTRL2_SIGNAL_1V8);
+  if (Host->SetIoVoltage != NULL) {
+    Host->SetIoVoltage (Host, TRUE);
+  }
+
+  MicroSecondDelay (SD_VOLTAGE_SWITCH_DELAY);
+  if ((PlatformMmioRead32 (Address) & SD_HC_CTRL2_SIGNAL_1V8) == 0) {
+    DEBUG ((DEBUG_WARN, "[SD] Controller did not keep 1.8 V signalling\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  SdHcGateClock (Host, TRUE);
+  MicroSecondDelay (SD_CLOCK_RESUME_DELAY);
+  Lines = PlatformMmioRead32 (Host->Base + SD_HC_PRESENT_STATE) & SD_HC_PRESENT_DAT_LINES;
+  if (Lines != SD_HC_PRESENT_DAT_LINES) {
+    DEBUG ((DEBUG_WARN, "[SD] Card did not finish the voltage switch\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  Host->Signal1V8 = TRUE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Write the argument and command registers, starting the command.
+
+  @param  Host          Host controller.
+  @param  Index         Command index.
+  @param  Argument      Command argument.
+  @param  ResponseType  Response of the command.
+  @param  Mode          Transfer mode.
+  @param  Data          TRUE if the command moves data.
+
+  @retval EFI_SUCCESS   Started.
+  @retval EFI_TIMEOUT   The command or data lines stayed busy.
+**/
+STATIC
+EFI_STATUS
+SdHcIssue (
+  IN SD_HOST           *Host,
+  IN UINT8             Index,
+  IN UINT32            Argument,
+  IN SD_RESPONSE_TYPE  ResponseType,
+  IN UINT32            Mode,
+  IN BOOLEAN           Data
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Inhibit;
+  UINT32      Command;
+
+  Inhibit = SD_HC_PRESENT_CMD_INHIBIT;
+  if (Data || (ResponseType == SdResponseR1b)) {
+    Inhibit |= SD_HC_PRESENT_DAT_INHIBIT;
+  }
+
+  Status = PlatformWaitMmio32 (Host->Base + SD_HC_PRESENT_STATE, Inhibit, 0, SD_HC_COMMAND_TIMEOUT, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[SD] CMD%d: lines busy\n", Index));
+    return Status;
+  }
+
+  Command = SD_HC_CMD_INDEX (Index) | mSdHcResponseFlags[ResponseType];
+  if (Data) {
+    Command |= SD_HC_CMD_DATA_PRESENT;
+  }
+
+  PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, MAX_UINT32);
+  PlatformMmioWrite32 (Host->Base + SD_HC_ARGUMENT, Argument);
+  PlatformMmioWrite32 (Host->Base + SD_HC_COMMAND, Command | Mode);
+  return EFI_SUCCESS;
+}
+
+/**
+  Describe a buffer in the ADMA2 descriptor table and point the
+  controller at it.
+
+  @param  Host          Host controller.
+  @param  Data          Buffer, at most SD_ADMA_DESCRIPTORS * 64 KB.
+  @param  Bytes         Length of the buffer.
+**/
+STATIC
+VOID
+SdHcBuildAdmaTable (
+  IN SD_HOST  *Host,
+  IN VOID     *Data,
+  IN UINTN    Bytes
+  )
+{
+  SD_ADMA_DESCRIPTOR  *Descriptor;
+  UINT64              Address;
+  UINTN               Length;
+
+  Descriptor = Host->AdmaTable;
+  Address    = (UINTN)Data;
+  while (Bytes > 0) {
+    Length                  = MIN (Bytes, SD_ADMA_MAX_LENGTH);
+    Descriptor->Attributes  = SD_ADMA_VALID | SD_ADMA_TRANSFER;
+    Descriptor->Length      = (UINT16)Length;
+    Descriptor->AddressLow  = (UINT32)Address;
+    Descriptor->AddressHigh = (UINT32)RShiftU64 (Address, 32);
+    Address                += Length;
+    Bytes                  -= Length;
+    Descriptor++;
+  }
+
+  (Descriptor - 1)->Attributes |= SD_ADMA_END;
+  WriteBackDataCacheRange (Host->AdmaTable, (UINTN)Descriptor - (UINTN)Host->AdmaTable);
+
+  Address = (UINTN)Host->AdmaTable;
+  PlatformMmioWrite32 (Host->Base + SD_HC_ADMA_ADDRESS, (UINT32)Address);
+  PlatformMmioWrite32 (Host->Base + SD_HC_ADMA_ADDRESS + 4, (UINT32)RShiftU64 (Address, 32));
+}
+
+EFI_STATUS
+SdHcCommand (
+  IN     SD_HOST     *Host,
+  IN OUT SD_COMMAND  *Command
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Mode;
+  UINT32      IntStatus;
+  UINTN       Bytes;
+  UINT64      Timeout;
+
+  Mode  = 0;
+  Bytes = 0;
+  if (Command->Data != NULL) {
+    Bytes = (UINTN)Command->BlockSize * Command->Blocks;
+    ASSERT (((UINTN)Command->Data & (SD_ADMA_ALIGNMENT - 1)) == 0);
+    ASSERT (Bytes <= SD_ADMA_DESCRIPTORS * SD_ADMA_MAX_LENGTH);
+
+    if (Command->Write) {
+      WriteBackDataCacheRange (Command->Data, Bytes);
+    } else {
+      WriteBackInvalidateDataCacheRange (Command->Data, Bytes);
+    }
+
+    SdHcBuildAdmaTable (Host, Command->Data, Bytes);
+    PlatformMmioWrite32 (Host->Base + SD_HC_BLOCK, Command->BlockSize | (Command->Blocks << 16));
+
+    Mode = SD_HC_MODE_DMA | (Command->Write ? 0 : SD_HC_MODE_READ);
+    if (Command->Blocks > 1) {
+      Mode |= SD_HC_MODE_MULTI_BLOCK | SD_HC_MODE_BLOCK_COUNT;
+      if (Command->AutoStop) {
+        Mode |= SD_HC_MODE_AUTO_CMD12;
+      }
+    }
+  }
+
+  Status = SdHcIssue (Host, Command->Index, Command->Argument, Command->ResponseType, Mode, Command->Data != NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SdHcWaitInterrupt (Host, SD_HC_INT_CMD_COMPLETE, SD_HC_COMMAND_TIMEOUT, &IntStatus);
+  if (!EFI_ERROR (Status) && ((IntStatus & SD_HC_INT_ERRORS) == 0)) {
+    if (Command->ResponseType == SdResponseR2) {
+      PlatformMmioReadBlock32 (Host->Base + SD_HC_RESPONSE, 4, Command->Response);
+    } else {
+      Command->Response[0] = PlatformMmioRead32 (Host->Base + SD_HC_RESPONSE);
+    }
+
+    PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, SD_HC_INT_CMD_COMPLETE);
+
+    //
+    // Data, and the busy signal of an R1b command, end with transfer
+    // complete.
+    //
+    if ((Command->Data != NULL) || (Command->ResponseType == SdResponseR1b)) {
+      Timeout = SD_HC_BUSY_TIMEOUT + (Bytes / SIZE_1MB) * SD_HC_TIMEOUT_PER_MB;
+      Status  = SdHcWaitInterrupt (Host, SD_HC_INT_TRANSFER_COMPLETE, Timeout, &IntStatus);
+      PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, IntStatus);
+    }
+  }
+
+  if ((Command->Data != NULL) && !Command->Write) {
+    InvalidateDataCacheRange (Command->Data, Bytes);
+  }
+
+  if (EFI_ERROR (Status) || ((IntStatus & SD_HC_INT_ERRORS) != 0)) {
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "[SD] CMD%d failed: interrupt status 0x%08x, ADMA error 0x%x\n",
+      Command->Index,
+      IntStatus,
+      PlatformMmioRead32 (Host->Base + SD_HC_ADMA_ERROR)
+      ));
+    PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, MAX_UINT32);
+    SdHcReset (Host, SD_HC_RESET_CMD | SD_HC_RESET_DAT);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    return ((IntStatus & SD_HC_INT_ERRORS) == SD_HC_INT_CMD_TIMEOUT) ? EFI_NO_RESPONSE : EFI_DEVICE_ERROR;
+  }
+
+  if (((Command->ResponseType == SdResponseR1) || (Command->ResponseType == SdResponseR1b)) &&
+      ((Command->Response[0] & SD_R1_ERRORS) != 0))
+  {
+    DEBUG ((DEBUG_VERBOSE, "[SD] CMD%d: card status 0x%08x\n", Command->Index, Command->Response[0]));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+SdHcTune (
+  IN SD_HOST  *Host
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Address;
+  UINT32      Control;
+  UINT32      IntStatus;
+  UINTN       Attempt;
+
+  //
+  // The controller reads each tuning block itself and moves its sampling
+  // point; it clears EXECUTE_TUNING when it is done and leaves
+  // SAMPLING_CLOCK set if it found a good point.
+  //
+  Address = Host->Base + SD_HC_HOST_CONTROL2;
+  PlatformMmioWrite32 (Address, (PlatformMmioRead32 (Address) & ~SD_HC_CTRL2_SAMPLING_CLOCK) | SD_HC_CTRL2_EXECUTE_TUNING);
+  PlatformMmioWrite32 (Host->Base + SD_HC_BLOCK, SD_TUNING_BLOCK_SIZE | (1 << 16));
+
+  for (Attempt = 0; Attempt < SD_HC_TUNING_ATTEMPTS; Attempt++) {
+    Status = SdHcIssue (Host, SD_SEND_TUNING_BLOCK, 0, SdResponseR1, SD_HC_MODE_READ, TRUE);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Status = SdHcWaitInterrupt (Host, SD_HC_INT_BUFFER_READ_READY, SD_HC_TUNING_TIMEOUT, &IntStatus);
+    PlatformMmioWrite32 (Host->Base + SD_HC_INT_STATUS, IntStatus);
+    if (EFI_ERROR (Status) || ((IntStatus & SD_HC_INT_BUFFER_READ_READY) == 0)) {
+      break;
+    }
+
+    Control = PlatformMmioRead32 (Address);
+    if ((Control & SD_HC_CTRL2_EXECUTE_TUNING) == 0) {
+      if ((Control & SD_HC_CTRL2_SAMPLING_CLOCK) != 0) {
+        DEBUG ((DEBUG_INFO, "[SD] Tuned after %d blocks\n", Attempt + 1));
+        return EFI_SUCCESS;
+      }
+
+      break;
+    }
+  }
+
+  DEBUG ((DEBUG_WARN, "[SD] Tuning failed after %d blocks\n", Attempt));
+  PlatformMmioWrite32 (Address, PlatformMmioRead32 (Address) & ~(SD_HC_CTRL2_EXECUTE_TUNING | SD_HC_CTRL2_SAMPLING_CLOCK));
+  SdHcReset (Host, SD_HC_RESET_CMD | SD_HC_RESET_DAT);
+  return EFI_DEVICE_ERROR;
+}
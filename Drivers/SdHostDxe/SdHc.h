@@ -0,0 +1,508 @@
+/** @file
+  SD host controller engine of SdHostDxe
+
+  SDHCI register layout, ADMA2 descriptors, SD commands and the host and
+  card state shared by the controller (SdHc.c) and card (SdCard.c)
+  modules. The engine only uses PlatformMmioLib, PlatformWaitLib and
+  base libraries, so Host/SdhciModelTest.c builds it unchanged against a
+  software host controller and card.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SD_HC_H_
+#define SD_HC_H_
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/PlatformWaitLib.h"
+
+//
+// Controller registers. The controller is only accessed 32 bits at a
+// time, so its 8 and 16-bit registers are named by the dword that
+// holds them.
+//
+#define SD_HC_ARGUMENT2           0x00
+#define SD_HC_BLOCK               0x04    // block size [11:0], block count [31:16]
+#define SD_HC_ARGUMENT            0x08
+#define SD_HC_COMMAND             0x0C    // transfer mode [15:0], command [31:16]
+#define SD_HC_RESPONSE            0x10    // four dwords
+#define SD_HC_BUFFER              0x20
+#define SD_HC_PRESENT_STATE       0x24
+#define SD_HC_HOST_CONTROL        0x28    // host control 1 [7:0], power control [15:8]
+#define SD_HC_CLOCK_CONTROL       0x2C    // clock [15:0], timeout [19:16], software reset [26:24]
+#define SD_HC_INT_STATUS          0x30    // normal [15:0], error [31:16]; write 1 to clear
+#define SD_HC_INT_STATUS_ENABLE   0x34
+#define SD_HC_INT_SIGNAL_ENABLE   0x38
+#define SD_HC_HOST_CONTROL2       0x3C    // auto CMD error [15:0], host control 2 [31:16]
+#define SD_HC_CAPABILITIES        0x40
+#define SD_HC_CAPABILITIES2       0x44
+#define SD_HC_ADMA_ERROR          0x54
+#define SD_HC_ADMA_ADDRESS        0x58    // two dwords
+#define SD_HC_VERSION             0xFC    // host controller version [31:16]
+
+// Transfer mode and command
+#define SD_HC_MODE_DMA            BIT0
+#define SD_HC_MODE_BLOCK_COUNT    BIT1
+#define SD_HC_MODE_AUTO_CMD12     BIT2
+#define SD_HC_MODE_READ           BIT4
+#define SD_HC_MODE_MULTI_BLOCK    BIT5
+#define SD_HC_CMD_RESPONSE_136    (1 << 16)
+#define SD_HC_CMD_RESPONSE_48     (2 << 16)
+#define SD_HC_CMD_RESPONSE_BUSY   (3 << 16)
+#define SD_HC_CMD_CRC_CHECK       BIT19
+#define SD_HC_CMD_INDEX_CHECK     BIT20
+#define SD_HC_CMD_DATA_PRESENT    BIT21
+#define SD_HC_CMD_INDEX(Index)    ((UINT32)(Index) << 24)
+
+// Present state
+#define SD_HC_PRESENT_CMD_INHIBIT  BIT0
+#define SD_HC_PRESENT_DAT_INHIBIT  BIT1
+#define SD_HC_PRESENT_DAT_LINES    (0xF << 20)
+
+// Host control 1 and power control
+#define SD_HC_CTRL_DATA_4BIT      BIT1
+#define SD_HC_CTRL_HIGH_SPEED     BIT2
+#define SD_HC_CTRL_ADMA2_64       (3 << 3)
+#define SD_HC_CTRL_DMA_MASK       (3 << 3)
+#define SD_HC_POWER_ON            BIT8
+#define SD_HC_POWER_330           (7 << 9)
+
+// Clock control, timeout control and software reset
+#define SD_HC_CLOCK_INTERNAL      BIT0
+#define SD_HC_CLOCK_STABLE        BIT1
+#define SD_HC_CLOCK_CARD          BIT2
+#define SD_HC_CLOCK_DIVIDER(Div)  ((((Div) & 0xFF) << 8) | ((((Div) >> 8) & 0x3) << 6))
+#define SD_HC_CLOCK_MASK          0xFFFF
+#define SD_HC_CLOCK_MAX_DIVIDER   0x3FF
+#define SD_HC_TIMEOUT_MAX         (0xE << 16)
+#define SD_HC_RESET_ALL           BIT24
+#define SD_HC_RESET_CMD           BIT25
+#define SD_HC_RESET_DAT           BIT26
+
+// Interrupt status
+#define SD_HC_INT_CMD_COMPLETE    BIT0
+#define SD_HC_INT_TRANSFER_COMPLETE  BIT1
+#define SD_HC_INT_BUFFER_READ_READY  BIT5
+#define SD_HC_INT_ERROR           BIT15
+#define SD_HC_INT_CMD_TIMEOUT     BIT16
+#define SD_HC_INT_DATA_CRC        BIT21
+#define SD_HC_INT_ADMA            BIT25
+#define SD_HC_INT_ERRORS          0x03FF0000
+#define SD_HC_INT_ENABLED         (SD_HC_INT_ERRORS | SD_HC_INT_BUFFER_READ_READY | SD_HC_INT_TRANSFER_COMPLETE | SD_HC_INT_CMD_COMPLETE)
+
+// Host control 2
+#define SD_HC_CTRL2_UHS_MASK      (7 << 16)
+#define SD_HC_CTRL2_UHS(Mode)     ((UINT32)(Mode) << 16)
+#define SD_HC_CTRL2_SIGNAL_1V8    BIT19
+#define SD_HC_CTRL2_EXECUTE_TUNING  BIT22
+#define SD_HC_CTRL2_SAMPLING_CLOCK  BIT23
+
+// UHS mode select of host control 2
+#define SD_HC_UHS_SDR12           0
+#define SD_HC_UHS_SDR25           1
+#define SD_HC_UHS_SDR50           2
+#define SD_HC_UHS_SDR104          3
+#define SD_HC_UHS_DDR50           4
+
+// Capabilities
+#define SD_HC_CAP_BASE_CLOCK(Cap)  (((Cap) >> 8) & 0xFF)   // MHz
+#define SD_HC_CAP_ADMA2           BIT19
+#define SD_HC_CAP_HIGH_SPEED      BIT21
+#define SD_HC_CAP_64BIT           BIT28
+#define SD_HC_CAP2_SDR50          BIT0
+#define SD_HC_CAP2_SDR104         BIT1
+#define SD_HC_CAP2_DDR50          BIT2
+#define SD_HC_CAP2_TUNING_SDR50   BIT13
+#define SD_HC_CAP2_UHS            (SD_HC_CAP2_SDR50 | SD_HC_CAP2_SDR104 | SD_HC_CAP2_DDR50)
+
+#define SD_HC_SPEC_VERSION(Version)  (((Version) >> 16) & 0xFF)
+#define SD_HC_SPEC_300            2
+
+//
+// ADMA2 descriptor for 64-bit addressing. A descriptor moves up to
+// 64 KB, its length field holding 0 for a full 64 KB. The table holds
+// SD_ADMA_DESCRIPTORS descriptors, which bounds a command to 16 MB.
+//
+#pragma pack(1)
+typedef struct {
+  UINT16    Attributes;
+  UINT16    Length;
+  UINT32    AddressLow;
+  UINT32    AddressHigh;
+} SD_ADMA_DESCRIPTOR;
+#pragma pack()
+
+#define SD_ADMA_VALID             BIT0
+#define SD_ADMA_END               BIT1
+#define SD_ADMA_TRANSFER          (2 << 4)
+#define SD_ADMA_MAX_LENGTH        SIZE_64KB
+#define SD_ADMA_ALIGNMENT         4
+#define SD_ADMA_DESCRIPTORS       256
+
+//
+// The descriptor table and a small buffer for card registers read by
+// DMA share one page; the buffer starts on a cache line of its own.
+//
+#define SD_ADMA_TABLE_SIZE        (SD_ADMA_DESCRIPTORS * sizeof (SD_ADMA_DESCRIPTOR))
+#define SD_SCRATCH_SIZE           64
+
+#define SD_BLOCK_SIZE             512
+#define SD_MAX_BLOCKS             (SD_ADMA_DESCRIPTORS * (SD_ADMA_MAX_LENGTH / SD_BLOCK_SIZE))
+
+//
+// Timeouts in microseconds. A data command is given SD_HC_BUSY_TIMEOUT
+// plus SD_HC_TIMEOUT_PER_MB for each MB it moves, enough for default
+// speed.
+//
+#define SD_HC_RESET_TIMEOUT       100000
+#define SD_HC_CLOCK_TIMEOUT       20000
+#define SD_HC_COMMAND_TIMEOUT     100000
+#define SD_HC_BUSY_TIMEOUT        1000000
+#define SD_HC_TIMEOUT_PER_MB      200000
+#define SD_HC_TUNING_TIMEOUT      10000
+#define SD_HC_TUNING_ATTEMPTS     40
+
+//
+// Delays in microseconds: card power off and ramp, and the signal
+// voltage switch.
+//
+#define SD_POWER_OFF_DELAY        10000
+#define SD_POWER_ON_DELAY         1000
+#define SD_VOLTAGE_SWITCH_DELAY   5000
+#define SD_CLOCK_RESUME_DELAY     1000
+
+// SD commands
+#define SD_GO_IDLE_STATE          0
+#define SD_ALL_SEND_CID           2
+#define SD_SEND_RELATIVE_ADDR     3
+#define SD_SWITCH_FUNC            6
+#define SD_SELECT_CARD            7
+#define SD_SEND_IF_COND           8
+#define SD_SEND_CSD               9
+#define SD_VOLTAGE_SWITCH         11
+#define SD_STOP_TRANSMISSION      12
+#define SD_SEND_STATUS            13
+#define SD_SET_BLOCKLEN           16
+#define SD_READ_SINGLE_BLOCK      17
+#define SD_READ_MULTIPLE_BLOCK    18
+#define SD_SEND_TUNING_BLOCK      19
+#define SD_SET_BLOCK_COUNT        23
+#define SD_WRITE_BLOCK            24
+#define SD_WRITE_MULTIPLE_BLOCK   25
+#define SD_APP_CMD                55
+
+// Application commands, after SD_APP_CMD
+#define SD_APP_SET_BUS_WIDTH      6
+#define SD_APP_SEND_OP_COND       41
+#define SD_APP_SEND_SCR           51
+
+#define SD_IF_COND_PATTERN        0x1AA   // 2.7-3.6 V, check pattern 0xAA
+#define SD_BUS_WIDTH_4            2
+#define SD_TUNING_BLOCK_SIZE      64
+
+// Operation conditions
+#define SD_OCR_VDD_32_34          (BIT20 | BIT21)
+#define SD_OCR_S18                BIT24   // 1.8 V signalling: requested / accepted
+#define SD_OCR_HCS                BIT30   // high capacity: supported / card is SDHC or SDXC
+#define SD_OCR_BUSY               BIT31   // clear while the card powers up
+#define SD_OP_COND_TIMEOUT        1000000
+#define SD_OP_COND_INTERVAL       10000
+
+// Card status of an R1 response
+#define SD_R1_ERRORS              0xFD380000
+#define SD_R1_STATE(Status)       (((Status) >> 9) & 0xF)
+#define SD_R1_READY_FOR_DATA      BIT8
+#define SD_STATE_TRANSFER         4
+
+//
+// Switch function (CMD6). The argument checks or sets group 1, the bus
+// speed mode, leaving the other groups alone. Of the 64-byte status,
+// byte 13 holds the functions group 1 supports and the low nibble of
+// byte 16 the one selected.
+//
+#define SD_SWITCH_CHECK           0x00FFFFFF
+#define SD_SWITCH_SET             0x80FFFFF0
+#define SD_SWITCH_STATUS_SIZE     64
+#define SD_SWITCH_SUPPORT         13
+#define SD_SWITCH_RESULT          16
+
+//
+// SCR, read by ACMD51 as 8 big-endian bytes
+//
+#define SD_SCR_SIZE               8
+#define SD_SCR_SPEC(Scr)          ((Scr)[0] & 0xF)
+#define SD_SCR_BUS_WIDTH_4        BIT2      // of byte 1
+#define SD_SCR_CMD23              BIT1      // of byte 3
+
+//
+// Bus timings from slowest to fastest. All but the first two need 1.8 V
+// signalling.
+//
+typedef enum {
+  SdTimingDefault,                    // 25 MHz
+  SdTimingHighSpeed,                  // 50 MHz, SDR25 at 1.8 V
+  SdTimingSdr50,                      // 100 MHz
+  SdTimingDdr50,                      // 50 MHz, both edges
+  SdTimingSdr104,                     // 208 MHz
+  SdTimingMax
+} SD_TIMING;
+
+typedef enum {
+  SdResponseNone,
+  SdResponseR1,
+  SdResponseR1b,
+  SdResponseR2,
+  SdResponseR3,
+  SdResponseR6,
+  SdResponseR7
+} SD_RESPONSE_TYPE;
+
+//
+// One command. Data, if any, is moved by ADMA2 and must be aligned to
+// SD_ADMA_ALIGNMENT.
+//
+typedef struct {
+  UINT8               Index;
+  UINT32              Argument;
+  SD_RESPONSE_TYPE    ResponseType;
+  UINT32              Response[4];
+  VOID                *Data;
+  UINT32              BlockSize;
+  UINT32              Blocks;
+  BOOLEAN             Write;
+  BOOLEAN             AutoStop;       // let the controller send CMD12
+} SD_COMMAND;
+
+typedef struct _SD_HOST  SD_HOST;
+
+/**
+  Switch the power of the card slot.
+
+  @param  Host          Host controller.
+  @param  On            TRUE to power the card.
+**/
+typedef
+VOID
+(EFIAPI *SD_HOST_SET_POWER)(
+  IN SD_HOST  *Host,
+  IN BOOLEAN  On
+  );
+
+/**
+  Switch the signal voltage of the card slot.
+
+  @param  Host          Host controller.
+  @param  Signal1V8     TRUE for 1.8 V, FALSE for 3.3 V.
+**/
+typedef
+VOID
+(EFIAPI *SD_HOST_SET_IO_VOLTAGE)(
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Signal1V8
+  );
+
+struct _SD_HOST {
+  //
+  // Set by the caller before SdCardInit
+  //
+  UINTN                     Base;
+  UINT32                    BaseClock;        // Hz, 0 to use the capabilities
+  SD_TIMING                 MaxTiming;
+  SD_HOST_SET_POWER         SetPower;         // optional: slot power switch
+  SD_HOST_SET_IO_VOLTAGE    SetIoVoltage;     // optional: slot I/O regulator
+
+  //
+  // Controller
+  //
+  UINT32                    Version;
+  UINT32                    Capabilities;
+  UINT32                    Capabilities2;
+  SD_ADMA_DESCRIPTOR        *AdmaTable;
+  UINT8                     *Scratch;
+  UINT32                    Clock;            // card clock, Hz
+  BOOLEAN                   Signal1V8;
+  SD_TIMING                 Timing;
+
+  //
+  // Card
+  //
+  UINT16                    Rca;
+  UINT32                    Ocr;
+  UINT32                    Cid[4];
+  UINT32                    Csd[4];
+  UINT8                     Scr[SD_SCR_SIZE];
+  BOOLEAN                   HighCapacity;     // block addressed
+  BOOLEAN                   SetBlockCount;    // CMD23 supported
+  UINT64                    Blocks;
+};
+
+//
+// SdHc.c
+//
+
+/**
+  Reset the controller and power cycle the card: 3.3 V, 1-bit bus,
+  identification clock. Allocates the ADMA2 descriptor table on first
+  use.
+
+  @param  Host          Host controller with Base set.
+
+  @retval EFI_SUCCESS           The card is powered and clocked.
+  @retval EFI_UNSUPPORTED       The controller has no 64-bit ADMA2 or no
+                                known base clock.
+  @retval EFI_TIMEOUT           The controller did not come out of reset.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the descriptor table.
+**/
+EFI_STATUS
+SdHcInit (
+  IN OUT SD_HOST  *Host
+  );
+
+/**
+  Reset the controller and remove power from the card.
+
+  @param  Host          Host controller.
+**/
+VOID
+SdHcPowerOff (
+  IN SD_HOST  *Host
+  );
+
+/**
+  Run the card clock at up to Frequency.
+
+  @param  Host          Host controller.
+  @param  Frequency     Highest card clock in Hz.
+
+  @retval EFI_SUCCESS   The clock runs at Host->Clock.
+  @retval EFI_TIMEOUT   The internal clock did not become stable.
+**/
+EFI_STATUS
+SdHcSetClock (
+  IN SD_HOST  *Host,
+  IN UINT32   Frequency
+  );
+
+/**
+  Select a 1-bit or 4-bit data bus.
+
+  @param  Host          Host controller.
+  @param  Wide          TRUE for 4 bits.
+**/
+VOID
+SdHcSetBusWidth (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Wide
+  );
+
+/**
+  Set the bus timing of the controller and its card clock. The card
+  must have been switched to the timing already.
+
+  @param  Host          Host controller.
+  @param  Timing        Bus timing.
+
+  @retval EFI_SUCCESS   The timing is in effect.
+  @retval EFI_TIMEOUT   The clock did not become stable.
+**/
+EFI_STATUS
+SdHcSetTiming (
+  IN SD_HOST    *Host,
+  IN SD_TIMING  Timing
+  );
+
+/**
+  Host side of the switch to 1.8 V signalling, after the card accepted
+  SD_VOLTAGE_SWITCH.
+
+  @param  Host          Host controller.
+
+  @retval EFI_SUCCESS       Both sides signal at 1.8 V.
+  @retval EFI_DEVICE_ERROR  The card or the regulator did not follow; the
+                            card must be power cycled.
+**/
+EFI_STATUS
+SdHcSwitchVoltage (
+  IN SD_HOST  *Host
+  );
+
+/**
+  Find the sampling point for the current timing with SD_SEND_TUNING_BLOCK.
+
+  @param  Host          Host controller.
+
+  @retval EFI_SUCCESS       The controller samples at the tuned point.
+  @retval EFI_DEVICE_ERROR  Tuning failed; the fixed sampling clock is in use.
+**/
+EFI_STATUS
+SdHcTune (
+  IN SD_HOST  *Host
+  );
+
+/**
+  Send a command and move its data, if any.
+
+  @param  Host          Host controller.
+  @param  Command       Command; the response is returned in it.
+
+  @retval EFI_SUCCESS       Done.
+  @retval EFI_NO_RESPONSE   The card did not answer the command.
+  @retval EFI_DEVICE_ERROR  The command or its data failed, or the card
+                            reported an error.
+  @retval EFI_TIMEOUT       The controller did not finish in time.
+**/
+EFI_STATUS
+SdHcCommand (
+  IN     SD_HOST     *Host,
+  IN OUT SD_COMMAND  *Command
+  );
+
+//
+// SdCard.c
+//
+
+/**
+  Bring up the card in the fastest bus timing it, the controller and
+  Host->MaxTiming allow, with a 4-bit bus.
+
+  @param  Host          Host controller.
+
+  @retval EFI_SUCCESS       The card is selected; Host->Blocks is its size.
+  @retval others            No usable card.
+**/
+EFI_STATUS
+SdCardInit (
+  IN OUT SD_HOST  *Host
+  );
+
+/**
+  Read or write blocks of SD_BLOCK_SIZE bytes.
+
+  @param  Host          Host controller with an initialized card.
+  @param  Lba           First block.
+  @param  Blocks        Number of blocks.
+  @param  Buffer        Data, aligned to SD_ADMA_ALIGNMENT.
+  @param  Write         TRUE to write.
+
+  @retval EFI_SUCCESS       Done.
+  @retval others            A command failed.
+**/
+EFI_STATUS
+SdCardTransfer (
+  IN SD_HOST  *Host,
+  IN EFI_LBA  Lba,
+  IN UINTN    Blocks,
+  IN VOID     *Buffer,
+  IN BOOLEAN  Write
+  );
+
+#endif
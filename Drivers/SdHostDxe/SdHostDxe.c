@@ -0,0 +1,453 @@
+/** @file
+  SD card boot driver for Raspberry Pi 5 D-step
+
+  The TF card slot hangs off the SDHCI of the BCM2712 itself, not RP1.
+  The driver brings the card up once at load and publishes Block I/O on
+  it; the slot power and I/O voltage are switched through two always-on
+  GPIOs. At ExitBootServices the card is power cycled back to 3.3 V so
+  that the OS finds it in its idle state.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SdHostDxe.h"
+
+STATIC CONST EFI_GUID  mVideoCorePropertiesGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+
+STATIC SD_HOST_DEVICE_PATH  mSdHostDevicePath = {
+  {
+    {
+      HARDWARE_DEVICE_PATH,
+      HW_VENDOR_DP,
+      { (UINT8)sizeof (VENDOR_DEVICE_PATH), (UINT8)(sizeof (VENDOR_DEVICE_PATH) >> 8) }
+    },
+    SD_HOST_DEVICE_PATH_GUID
+  },
+  {
+    {
+      MESSAGING_DEVICE_PATH,
+      MSG_SD_DP,
+      { (UINT8)sizeof (SD_DEVICE_PATH), (UINT8)(sizeof (SD_DEVICE_PATH) >> 8) }
+    },
+    0
+  },
+  {
+    END_DEVICE_PATH_TYPE,
+    END_ENTIRE_DEVICE_PATH_SUBTYPE,
+    { (UINT8)sizeof (EFI_DEVICE_PATH_PROTOCOL), 0 }
+  }
+};
+
+/**
+  Drive an always-on GPIO as an output.
+
+  @param  Gpio          Pin of the first bank.
+  @param  High          Level to drive.
+**/
+STATIC
+VOID
+SdHostSetGpio (
+  IN UINTN    Gpio,
+  IN BOOLEAN  High
+  )
+{
+  PLATFORM_MMIO_UPDATE  Updates[2];
+  UINT32                Bit;
+
+  Bit                = 1U << Gpio;
+  Updates[0].Address = RPI5D_GPIO_AON_BASE + SD_GPIO_DATA;
+  Updates[0].AndMask = ~Bit;
+  Updates[0].OrMask  = High ? Bit : 0;
+  Updates[1].Address = RPI5D_GPIO_AON_BASE + SD_GPIO_IODIR;
+  Updates[1].AndMask = ~Bit;
+  Updates[1].OrMask  = 0;
+  PlatformMmioUpdate32 (Updates, 2);
+}
+
+/**
+  Switch the power of the card slot.
+
+  @param  Host          Host controller.
+  @param  On            TRUE to power the card.
+**/
+STATIC
+VOID
+EFIAPI
+SdHostSetPower (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  On
+  )
+{
+  SdHostSetGpio (RPI5D_SD_VCC_GPIO, On);
+}
+
+/**
+  Switch the I/O regulator of the card slot.
+
+  @param  Host          Host controller.
+  @param  Signal1V8     TRUE for 1.8 V, FALSE for 3.3 V.
+**/
+STATIC
+VOID
+EFIAPI
+SdHostSetIoVoltage (
+  IN SD_HOST  *Host,
+  IN BOOLEAN  Signal1V8
+  )
+{
+  SdHostSetGpio (RPI5D_SD_IO_1V8_GPIO, Signal1V8);
+}
+
+/**
+  Base clock of the controller: the EMMC2 clock reported by the
+  VideoCore firmware, or 0 to take it from the capabilities.
+
+  @return Clock in Hz.
+**/
+STATIC
+UINT32
+SdHostBaseClock (
+  VOID
+  )
+{
+  VOID  *Hob;
+
+  Hob = GetFirstGuidHob (&mVideoCorePropertiesGuid);
+  if (Hob == NULL) {
+    return 0;
+  }
+
+  return ((VIDEOCORE_PROPERTIES *)GET_GUID_HOB_DATA (Hob))->EmmcClockRate;
+}
+
+/**
+  Describe the card in the Block I/O media.
+
+  @param  Private       Driver private data with an initialized card.
+**/
+STATIC
+VOID
+SdHostUpdateMedia (
+  IN SD_HOST_PRIVATE_DATA  *Private
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Media = &Private->Media;
+  if (!Media->MediaPresent || (Media->LastBlock != Private->Host.Blocks - 1)) {
+    Media->MediaId++;
+  }
+
+  Media->RemovableMedia                   = TRUE;
+  Media->MediaPresent                     = TRUE;
+  Media->BlockSize                        = SD_BLOCK_SIZE;
+  Media->IoAlign                          = SD_ADMA_ALIGNMENT;
+  Media->LastBlock                        = Private->Host.Blocks - 1;
+  Media->LogicalBlocksPerPhysicalBlock    = 1;
+  Media->OptimalTransferLengthGranularity = SD_MAX_BLOCKS;
+}
+
+/**
+  Check the arguments of a read or write.
+
+  @param  Private       Driver private data.
+  @param  MediaId       Media ID from the caller.
+  @param  Lba           First block.
+  @param  BufferSize    Bytes to transfer, not 0.
+  @param  Buffer        Caller's buffer.
+
+  @retval EFI_SUCCESS           Valid.
+  @retval EFI_NO_MEDIA          No card.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+SdHostCheckRequest (
+  IN SD_HOST_PRIVATE_DATA  *Private,
+  IN UINT32                MediaId,
+  IN EFI_LBA               Lba,
+  IN UINTN                 BufferSize,
+  IN VOID                  *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Media = &Private->Media;
+
+  if (!Media->MediaPresent) {
+    return EFI_NO_MEDIA;
+  }
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+  if ((Buffer == NULL) || (((UINTN)Buffer & (Media->IoAlign - 1)) != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if ((BufferSize % Media->BlockSize) != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  if ((Lba > Media->LastBlock) || ((BufferSize / Media->BlockSize) - 1 > Media->LastBlock - Lba)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Bring the card up again.
+
+  @param  This                  Block I/O protocol instance.
+  @param  ExtendedVerification  Ignored.
+
+  @retval EFI_SUCCESS           The card is ready.
+  @retval EFI_DEVICE_ERROR      No card answered.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+SdHostReset (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  SD_HOST_PRIVATE_DATA  *Private;
+  EFI_STATUS            Status;
+  EFI_TPL               OldTpl;
+
+  Private = SD_HOST_PRIVATE_FROM_BLOCK_IO (This);
+
+  OldTpl = gBS->RaiseTPL (SD_HOST_TPL);
+  Status = SdCardInit (&Private->Host);
+  if (EFI_ERROR (Status)) {
+    Private->Media.MediaPresent = FALSE;
+    Status                      = EFI_DEVICE_ERROR;
+  } else {
+    SdHostUpdateMedia (Private);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Read blocks.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to read.
+  @param  BufferSize    Bytes to read.
+  @param  Buffer        Destination buffer.
+
+  @retval EFI_SUCCESS           Read.
+  @retval EFI_DEVICE_ERROR      The card failed the read.
+  @retval EFI_NO_MEDIA          No card.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+SdHostReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  SD_HOST_PRIVATE_DATA  *Private;
+  EFI_STATUS            Status;
+  EFI_TPL               OldTpl;
+
+  Private = SD_HOST_PRIVATE_FROM_BLOCK_IO (This);
+  if (BufferSize == 0) {
+    return (MediaId != Private->Media.MediaId) ? EFI_MEDIA_CHANGED : EFI_SUCCESS;
+  }
+
+  Status = SdHostCheckRequest (Private, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OldTpl = gBS->RaiseTPL (SD_HOST_TPL);
+  Status = SdCardTransfer (&Private->Host, Lba, BufferSize / SD_BLOCK_SIZE, Buffer, FALSE);
+  gBS->RestoreTPL (OldTpl);
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+/**
+  Write blocks.
+
+  @param  This          Block I/O protocol instance.
+  @param  MediaId       Media ID.
+  @param  Lba           First block to write.
+  @param  BufferSize    Bytes to write.
+  @param  Buffer        Source buffer.
+
+  @retval EFI_SUCCESS           Written.
+  @retval EFI_DEVICE_ERROR      The card failed the write.
+  @retval EFI_NO_MEDIA          No card.
+  @retval EFI_MEDIA_CHANGED     MediaId is stale.
+  @retval EFI_BAD_BUFFER_SIZE   BufferSize is not a multiple of the block size.
+  @retval EFI_INVALID_PARAMETER Range or buffer invalid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+SdHostWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  SD_HOST_PRIVATE_DATA  *Private;
+  EFI_STATUS            Status;
+  EFI_TPL               OldTpl;
+
+  Private = SD_HOST_PRIVATE_FROM_BLOCK_IO (This);
+  if (BufferSize == 0) {
+    return (MediaId != Private->Media.MediaId) ? EFI_MEDIA_CHANGED : EFI_SUCCESS;
+  }
+
+  Status = SdHostCheckRequest (Private, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OldTpl = gBS->RaiseTPL (SD_HOST_TPL);
+  Status = SdCardTransfer (&Private->Host, Lba, BufferSize / SD_BLOCK_SIZE, Buffer, TRUE);
+  gBS->RestoreTPL (OldTpl);
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+/**
+  Flush written blocks. Writes complete on the card before they return,
+  so there is nothing to do.
+
+  @param  This          Block I/O protocol instance.
+
+  @retval EFI_SUCCESS   Done.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+SdHostFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Leave the card powered at 3.3 V in its idle state for the OS, which
+  may not know how to power cycle the slot out of 1.8 V signalling.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Driver private data.
+**/
+STATIC
+VOID
+EFIAPI
+SdHostExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  SD_HOST_PRIVATE_DATA  *Private;
+
+  Private = Context;
+  SdHcPowerOff (&Private->Host);
+  MicroSecondDelay (SD_POWER_OFF_DELAY);
+  SdHostSetPower (&Private->Host, TRUE);
+}
+
+/**
+  Entry point of the SD card driver.
+
+  @param  ImageHandle   EFI_HANDLE.
+  @param  SystemTable   EFI_SYSTEM_TABLE.
+
+  @retval EFI_SUCCESS   Driver initialized successfully.
+  @retval others        No card in the slot, or it could not be set up.
+**/
+EFI_STATUS
+EFIAPI
+SdHostDxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS            Status;
+  SD_HOST_PRIVATE_DATA  *Private;
+
+  Private = AllocateZeroPool (sizeof (SD_HOST_PRIVATE_DATA));
+  if (Private == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Private->Signature         = SD_HOST_PRIVATE_SIGNATURE;
+  Private->Host.Base         = RPI5D_SDIO_BASE;
+  Private->Host.BaseClock    = SdHostBaseClock ();
+  Private->Host.MaxTiming    = SD_HOST_MAX_TIMING;
+  Private->Host.SetPower     = SdHostSetPower;
+  Private->Host.SetIoVoltage = SdHostSetIoVoltage;
+
+  Status = SdCardInit (&Private->Host);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "[SD] No card: %r\n", Status));
+    if (Private->Host.AdmaTable != NULL) {
+      FreeAlignedPages (Private->Host.AdmaTable, EFI_SIZE_TO_PAGES (SD_ADMA_TABLE_SIZE + SD_SCRATCH_SIZE));
+    }
+
+    FreePool (Private);
+    return Status;
+  }
+
+  SdHostUpdateMedia (Private);
+  Private->BlockIo.Revision    = EFI_BLOCK_IO_PROTOCOL_REVISION3;
+  Private->BlockIo.Media       = &Private->Media;
+  Private->BlockIo.Reset       = SdHostReset;
+  Private->BlockIo.ReadBlocks  = SdHostReadBlocks;
+  Private->BlockIo.WriteBlocks = SdHostWriteBlocks;
+  Private->BlockIo.FlushBlocks = SdHostFlushBlocks;
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  SdHostExitBootServices,
+                  Private,
+                  &Private->ExitBootServicesEvent
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Private->Handle,
+                    &gEfiBlockIoProtocolGuid, &Private->BlockIo,
+                    &gEfiDevicePathProtocolGuid, &mSdHostDevicePath,
+                    NULL
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[SD] Driver setup failed: %r\n", Status));
+    if (Private->ExitBootServicesEvent != NULL) {
+      gBS->CloseEvent (Private->ExitBootServicesEvent);
+    }
+
+    SdHcPowerOff (&Private->Host);
+    FreeAlignedPages (Private->Host.AdmaTable, EFI_SIZE_TO_PAGES (SD_ADMA_TABLE_SIZE + SD_SCRATCH_SIZE));
+    FreePool (Private);
+    return Status;
+  }
+
+  gBS->ConnectController (Private->Handle, NULL, NULL, TRUE);
+
+  DEBUG ((DEBUG_INFO, "[SD] Driver loaded, %lu blocks\n", Private->Host.Blocks));
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/** @file
+  SD card boot driver for Raspberry Pi 5 D-step
+
+  Drives the SDHCI of the BCM2712 behind the TF card slot and publishes
+  Block I/O on the card.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SD_HOST_DXE_H_
+#define SD_HOST_DXE_H_
+
+#include "SdHc.h"
+#include <Library/DevicePathLib.h>
+#include <Library/HobLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/BlockIo.h>
+#include <Protocol/DevicePath.h>
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Platform/RPi5D.h"
+
+//
+// Requests are serialized at this TPL.
+//
+#define SD_HOST_TPL                 TPL_NOTIFY
+
+//
+// Fastest bus timing used. Build with -DSD_HOST_NO_UHS to keep the card
+// at 3.3 V high speed.
+//
+#ifdef SD_HOST_NO_UHS
+#define SD_HOST_MAX_TIMING          SdTimingHighSpeed
+#else
+#define SD_HOST_MAX_TIMING          SdTimingSdr104
+#endif
+
+//
+// Registers of a bank of the always-on GPIO controller; a set IODIR bit
+// makes the pin an input.
+//
+#define SD_GPIO_DATA                0x04
+#define SD_GPIO_IODIR               0x08
+
+//
+// Vendor device path node of the controller
+//
+#define SD_HOST_DEVICE_PATH_GUID \
+  { 0x0add01c3, 0x9e9e, 0x478b, { 0x94, 0xee, 0x59, 0x4c, 0x1a, 0xec, 0xae, 0x5b } }
+
+#pragma pack(1)
+typedef struct {
+  VENDOR_DEVICE_PATH          Vendor;
+  SD_DEVICE_PATH              Sd;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} SD_HOST_DEVICE_PATH;
+#pragma pack()
+
+//
+// Driver private data
+//
+typedef struct {
+  UINT32                   Signature;
+  EFI_HANDLE               Handle;
+  SD_HOST                  Host;
+  EFI_BLOCK_IO_MEDIA       Media;
+  EFI_BLOCK_IO_PROTOCOL    BlockIo;
+  EFI_EVENT                ExitBootServicesEvent;
+} SD_HOST_PRIVATE_DATA;
+
+#define SD_HOST_PRIVATE_SIGNATURE  SIGNATURE_32 ('S', 'D', 'H', 'C')
+#define SD_HOST_PRIVATE_FROM_BLOCK_IO(a) \
+  CR (a, SD_HOST_PRIVATE_DATA, BlockIo, SD_HOST_PRIVATE_SIGNATURE)
+
+#endif
@@ -0,0 +1,118 @@
+/** @file
+  Host stand-in for MdePkg Base.h, shared by the host tests in the Host
+  directory of each driver. Only what the engines built into them use is
+  here.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_BASE_H_
+#define HOST_BASE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t    UINT8;
+typedef uint16_t   UINT16;
+typedef uint32_t   UINT32;
+typedef uint64_t   UINT64;
+typedef int32_t    INT32;
+typedef size_t     UINTN;
+typedef intptr_t   INTN;
+typedef UINT8      BOOLEAN;
+typedef char       CHAR8;
+typedef UINTN      RETURN_STATUS;
+
+typedef struct _LIST_ENTRY  LIST_ENTRY;
+
+struct _LIST_ENTRY {
+  LIST_ENTRY    *ForwardLink;
+  LIST_ENTRY    *BackLink;
+};
+
+#define VOID      void
+#define CONST     const
+#define STATIC    static
+#define EFIAPI
+#define IN
+#define OUT
+#define OPTIONAL
+#define TRUE      ((BOOLEAN)1)
+#define FALSE     ((BOOLEAN)0)
+#define MIN(a, b)  (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)  (((a) > (b)) ? (a) : (b))
+
+#define BIT0        0x00000001
+#define BIT1        0x00000002
+#define BIT2        0x00000004
+#define BIT3        0x00000008
+#define BIT4        0x00000010
+#define BIT5        0x00000020
+#define BIT6        0x00000040
+#define BIT7        0x00000080
+#define BIT8        0x00000100
+#define BIT9        0x00000200
+#define BIT10       0x00000400
+#define BIT11       0x00000800
+#define BIT12       0x00001000
+#define BIT13       0x00002000
+#define BIT14       0x00004000
+#define BIT15       0x00008000
+#define BIT16       0x00010000
+#define BIT17       0x00020000
+#define BIT18       0x00040000
+#define BIT19       0x00080000
+#define BIT20       0x00100000
+#define BIT21       0x00200000
+#define BIT22       0x00400000
+#define BIT23       0x00800000
+#define BIT24       0x01000000
+#define BIT25       0x02000000
+#define BIT26       0x04000000
+#define BIT27       0x08000000
+#define BIT28       0x10000000
+#define BIT29       0x20000000
+#define BIT30       0x40000000
+#define BIT31       0x80000000
+#define BIT37       0x0000002000000000ULL
+#define SIZE_1KB    0x00000400
+#define SIZE_4KB    0x00001000
+#define SIZE_64KB   0x00010000
+#define SIZE_512KB  0x00080000
+#define SIZE_1MB    0x00100000
+#define SIZE_2MB    0x00200000
+#define SIZE_4MB    0x00400000
+#define SIZE_64MB   0x04000000
+#define MAX_UINT16  ((UINT16)0xFFFF)
+#define MAX_UINT32  ((UINT32)0xFFFFFFFF)
+#define MAX_UINT64  ((UINT64)0xFFFFFFFFFFFFFFFFULL)
+
+#define SIGNATURE_16(A, B)          ((A) | ((B) << 8))
+#define SIGNATURE_32(A, B, C, D)    (SIGNATURE_16 (A, B) | (SIGNATURE_16 (C, D) << 16))
+
+#define ARRAY_SIZE(Array)              (sizeof (Array) / sizeof ((Array)[0]))
+#define ALIGN_VALUE(Value, Alignment)  ((Value) + (((Alignment) - (Value)) & ((Alignment) - 1)))
+#define OFFSET_OF(TYPE, Field)         offsetof (TYPE, Field)
+#define BASE_CR(Record, TYPE, Field)   ((TYPE *)((CHAR8 *)(Record) - OFFSET_OF (TYPE, Field)))
+#define STATIC_ASSERT                  _Static_assert
+
+#define ENCODE_ERROR(a)              ((RETURN_STATUS)1 << (sizeof (UINTN) * 8 - 1) | (a))
+#define RETURN_SUCCESS               0
+#define RETURN_INVALID_PARAMETER     ENCODE_ERROR (2)
+#define RETURN_UNSUPPORTED           ENCODE_ERROR (3)
+#define RETURN_BAD_BUFFER_SIZE       ENCODE_ERROR (4)
+#define RETURN_BUFFER_TOO_SMALL      ENCODE_ERROR (5)
+#define RETURN_NOT_READY             ENCODE_ERROR (6)
+#define RETURN_DEVICE_ERROR          ENCODE_ERROR (7)
+#define RETURN_WRITE_PROTECTED       ENCODE_ERROR (8)
+#define RETURN_OUT_OF_RESOURCES      ENCODE_ERROR (9)
+#define RETURN_NO_MEDIA              ENCODE_ERROR (12)
+#define RETURN_MEDIA_CHANGED         ENCODE_ERROR (13)
+#define RETURN_NOT_FOUND             ENCODE_ERROR (14)
+#define RETURN_NO_RESPONSE           ENCODE_ERROR (16)
+#define RETURN_TIMEOUT               ENCODE_ERROR (18)
+#define RETURN_ERROR(StatusCode)     (((INTN)(RETURN_STATUS)(StatusCode)) < 0)
+
+#endif
@@ -0,0 +1,161 @@
+/** @file
+  Scaffolding shared by the driver host tests.
+
+  TimerLib and PlatformWaitLib on the model clock. The waits are the
+  deadline loops of PlatformWaitLib, with every delay handed to the
+  model, so an engine that never waits long enough runs into the same
+  timeouts as on the board.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HostTest.h"
+#include "../Include/Library/PlatformMmioLib.h"
+#include "../Include/Library/PlatformWaitLib.h"
+
+UINTN  mFailures;
+
+int
+HostTestResult (
+  VOID
+  )
+{
+  printf ("%s\n", (mFailures == 0) ? "PASS" : "FAIL");
+  return (mFailures == 0) ? 0 : 1;
+}
+
+//
+// Services of the platform the engine runs on
+//
+
+UINTN
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  HostModelDelay ((UINT64)MicroSeconds * 1000);
+  return MicroSeconds;
+}
+
+UINT64
+GetPerformanceCounter (
+  VOID
+  )
+{
+  return HostModelTime ();
+}
+
+UINT64
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  )
+{
+  return Ticks;
+}
+
+STATIC
+EFI_STATUS
+HostWaitCondition (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  UINT64                   MinInterval,
+  IN  UINT64                   MaxInterval,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Start;
+  UINT64      Waited;
+  UINT64      Interval;
+
+  Start    = HostModelTime ();
+  Interval = MinInterval;
+  for ( ; ; ) {
+    if (Condition (Context)) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+
+    Waited = (HostModelTime () - Start) / 1000;
+    if (Waited >= Timeout) {
+      Status = EFI_TIMEOUT;
+      break;
+    }
+
+    MicroSecondDelay ((UINTN)MIN (Interval, Timeout - Waited));
+    Interval = MIN (Interval * 2, MaxInterval);
+  }
+
+  if (Elapsed != NULL) {
+    *Elapsed = (HostModelTime () - Start) / 1000;
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+EFIAPI
+PlatformWaitCondition (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  return HostWaitCondition (
+           Condition,
+           Context,
+           Timeout,
+           PLATFORM_WAIT_MIN_INTERVAL,
+           PLATFORM_WAIT_MAX_INTERVAL,
+           Elapsed
+           );
+}
+
+EFI_STATUS
+EFIAPI
+PlatformWaitConditionInterval (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  UINT64                   Interval,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  return HostWaitCondition (Condition, Context, Timeout, Interval, Interval, Elapsed);
+}
+
+STATIC
+BOOLEAN
+EFIAPI
+HostMmio32Condition (
+  IN VOID  *Context
+  )
+{
+  PLATFORM_WAIT  *Wait;
+
+  Wait = Context;
+  return (BOOLEAN)((PlatformMmioRead32 (Wait->Address) & Wait->Mask) == Wait->Value);
+}
+
+EFI_STATUS
+EFIAPI
+PlatformWaitMmio32 (
+  IN  UINTN   Address,
+  IN  UINT32  Mask,
+  IN  UINT32  Value,
+  IN  UINT64  Timeout,
+  OUT UINT64  *Elapsed OPTIONAL
+  )
+{
+  PLATFORM_WAIT  Wait;
+
+  Wait.Address = Address;
+  Wait.Mask    = Mask;
+  Wait.Value   = Value;
+
+  return PlatformWaitCondition (HostMmio32Condition, &Wait, Timeout, Elapsed);
+}
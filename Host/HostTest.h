@@ -0,0 +1,63 @@
+/** @file
+  Scaffolding shared by the driver host tests: the failure count and
+  CHECK, and the platform services the engines call, run on the clock of
+  the test's model.
+
+  Each test defines HostModelTime() and HostModelDelay() and links
+  HostTest.c.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Uefi.h>
+
+extern UINTN  mFailures;
+
+#define CHECK(Condition, Message) \
+  do { \
+    if (!(Condition)) { \
+      printf ("  FAIL %s (line %d)\n", Message, __LINE__); \
+      mFailures++; \
+    } \
+  } while (0)
+
+/**
+  Print the verdict of the test.
+
+  @return Exit code of the test: 0 if every CHECK held.
+**/
+int
+HostTestResult (
+  VOID
+  );
+
+/**
+  Time of the model, which is also the performance counter.
+
+  @return Nanoseconds.
+**/
+UINT64
+HostModelTime (
+  VOID
+  );
+
+/**
+  Let the model run while the engine waits.
+
+  @param  Nanoseconds   Time that passes.
+**/
+VOID
+HostModelDelay (
+  IN UINT64  Nanoseconds
+  );
+
+#endif
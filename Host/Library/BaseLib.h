@@ -0,0 +1,132 @@
+/** @file
+  Host stand-in for BaseLib.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_BASE_LIB_H_
+#define HOST_BASE_LIB_H_
+
+#define RShiftU64(Operand, Count)    ((UINT64)(Operand) >> (Count))
+#define LShiftU64(Operand, Count)    ((UINT64)(Operand) << (Count))
+#define DivU64x32(Dividend, Divisor) ((UINT64)(Dividend) / (UINT32)(Divisor))
+#define MultU64x32(Multiplicand, Multiplier)  ((UINT64)(Multiplicand) * (UINT32)(Multiplier))
+#define DivU64x64Remainder(Dividend, Divisor, Remainder) \
+  ((UINT64)(Dividend) / (UINT64)(Divisor))
+#define HighBitSet32(Operand)        (((UINT32)(Operand) == 0) ? -1 : 31 - __builtin_clz (Operand))
+#define SwapBytes16(Value)           __builtin_bswap16 (Value)
+#define SwapBytes32(Value)           __builtin_bswap32 (Value)
+#define SwapBytes64(Value)           __builtin_bswap64 (Value)
+#define MemoryFence()                __sync_synchronize ()
+
+//
+// Unaligned accesses
+//
+
+#define HOST_UNALIGNED_ACCESSORS(Bits) \
+  STATIC inline \
+  UINT##Bits \
+  ReadUnaligned##Bits ( \
+    IN CONST UINT##Bits  *Buffer \
+    ) \
+  { \
+    UINT##Bits  Value; \
+    __builtin_memcpy (&Value, Buffer, sizeof (Value)); \
+    return Value; \
+  } \
+  STATIC inline \
+  UINT##Bits \
+  WriteUnaligned##Bits ( \
+    OUT UINT##Bits  *Buffer, \
+    IN  UINT##Bits  Value \
+    ) \
+  { \
+    __builtin_memcpy (Buffer, &Value, sizeof (Value)); \
+    return Value; \
+  }
+
+HOST_UNALIGNED_ACCESSORS (16)
+HOST_UNALIGNED_ACCESSORS (32)
+HOST_UNALIGNED_ACCESSORS (64)
+
+//
+// Doubly linked lists
+//
+
+STATIC inline
+LIST_ENTRY *
+InitializeListHead (
+  IN OUT LIST_ENTRY  *ListHead
+  )
+{
+  ListHead->ForwardLink = ListHead;
+  ListHead->BackLink    = ListHead;
+  return ListHead;
+}
+
+STATIC inline
+LIST_ENTRY *
+InsertTailList (
+  IN OUT LIST_ENTRY  *ListHead,
+  IN OUT LIST_ENTRY  *Entry
+  )
+{
+  Entry->ForwardLink           = ListHead;
+  Entry->BackLink              = ListHead->BackLink;
+  Entry->BackLink->ForwardLink = Entry;
+  ListHead->BackLink           = Entry;
+  return ListHead;
+}
+
+STATIC inline
+LIST_ENTRY *
+RemoveEntryList (
+  IN CONST LIST_ENTRY  *Entry
+  )
+{
+  Entry->ForwardLink->BackLink = Entry->BackLink;
+  Entry->BackLink->ForwardLink = Entry->ForwardLink;
+  return Entry->ForwardLink;
+}
+
+STATIC inline
+BOOLEAN
+IsListEmpty (
+  IN CONST LIST_ENTRY  *ListHead
+  )
+{
+  return (BOOLEAN)(ListHead->ForwardLink == ListHead);
+}
+
+STATIC inline
+LIST_ENTRY *
+GetFirstNode (
+  IN CONST LIST_ENTRY  *List
+  )
+{
+  return List->ForwardLink;
+}
+
+STATIC inline
+LIST_ENTRY *
+GetNextNode (
+  IN CONST LIST_ENTRY  *List,
+  IN CONST LIST_ENTRY  *Node
+  )
+{
+  return Node->ForwardLink;
+}
+
+STATIC inline
+BOOLEAN
+IsNull (
+  IN CONST LIST_ENTRY  *List,
+  IN CONST LIST_ENTRY  *Node
+  )
+{
+  return (BOOLEAN)(Node == List);
+}
+
+#endif
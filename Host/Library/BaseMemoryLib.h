@@ -0,0 +1,17 @@
+/** @file
+  Host stand-in for BaseMemoryLib.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_BASE_MEMORY_LIB_H_
+#define HOST_BASE_MEMORY_LIB_H_
+
+#include <string.h>
+
+#define ZeroMem(Buffer, Length)                    memset ((Buffer), 0, (Length))
+#define CopyMem(Destination, Source, Length)       memcpy ((Destination), (Source), (Length))
+
+#endif
@@ -0,0 +1,31 @@
+/** @file
+  Host stand-in for CacheMaintenanceLib. Each test supplies the calls its
+  engine makes, so that its model can count or act on the maintenance.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_CACHE_MAINTENANCE_LIB_H_
+#define HOST_CACHE_MAINTENANCE_LIB_H_
+
+VOID *
+WriteBackDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  );
+
+VOID *
+InvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  );
+
+VOID *
+WriteBackInvalidateDataCacheRange (
+  IN VOID   *Address,
+  IN UINTN  Length
+  );
+
+#endif
@@ -0,0 +1,24 @@
+/** @file
+  Host stand-in for DebugLib: messages are dropped, assertions abort.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_DEBUG_LIB_H_
+#define HOST_DEBUG_LIB_H_
+
+#include <assert.h>
+
+#define DEBUG_INFO     0x00000040
+#define DEBUG_VERBOSE  0x00400000
+#define DEBUG_WARN     0x00000002
+#define DEBUG_ERROR    0x80000000
+
+#define DEBUG(Expression)
+#define ASSERT(Expression)  assert (Expression)
+
+#define CR(Record, TYPE, Field, TestSignature)  BASE_CR (Record, TYPE, Field)
+
+#endif
@@ -0,0 +1,60 @@
+/** @file
+  Host stand-in for MemoryAllocationLib. Pool allocations go to the C
+  library; each test supplies the page allocations its engine makes, so
+  that its model can count them.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_MEMORY_ALLOCATION_LIB_H_
+#define HOST_MEMORY_ALLOCATION_LIB_H_
+
+#include <stdlib.h>
+
+#define AllocatePool(Size)      malloc (Size)
+#define AllocateZeroPool(Size)  calloc (1, (Size))
+#define FreePool(Buffer)        free (Buffer)
+
+STATIC inline
+VOID *
+AllocateCopyPool (
+  IN UINTN       AllocationSize,
+  IN CONST VOID  *Buffer
+  )
+{
+  VOID  *Memory;
+
+  Memory = malloc (AllocationSize);
+  if (Memory != NULL) {
+    __builtin_memcpy (Memory, Buffer, AllocationSize);
+  }
+
+  return Memory;
+}
+
+VOID *
+AllocatePages (
+  IN UINTN  Pages
+  );
+
+VOID
+FreePages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  );
+
+VOID *
+AllocateAlignedPages (
+  IN UINTN  Pages,
+  IN UINTN  Alignment
+  );
+
+VOID
+FreeAlignedPages (
+  IN VOID   *Buffer,
+  IN UINTN  Pages
+  );
+
+#endif
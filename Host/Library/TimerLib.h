@@ -0,0 +1,28 @@
+/** @file
+  Host stand-in for TimerLib, implemented by HostTest.c on the clock of
+  the test's model.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_TIMER_LIB_H_
+#define HOST_TIMER_LIB_H_
+
+UINTN
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  );
+
+UINT64
+GetPerformanceCounter (
+  VOID
+  );
+
+UINT64
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  );
+
+#endif
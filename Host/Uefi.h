@@ -0,0 +1,65 @@
+/** @file
+  Host stand-in for MdePkg Uefi.h: the status codes and types the engines
+  built into the driver host tests use.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_UEFI_H_
+#define HOST_UEFI_H_
+
+#include <Base.h>
+
+typedef RETURN_STATUS  EFI_STATUS;
+typedef UINT64         EFI_PHYSICAL_ADDRESS;
+typedef UINT64         EFI_LBA;
+typedef VOID           *EFI_EVENT;
+typedef VOID           *EFI_HANDLE;
+typedef UINTN          EFI_TPL;
+
+typedef struct {
+  UINT32    Data1;
+  UINT16    Data2;
+  UINT16    Data3;
+  UINT8     Data4[8];
+} EFI_GUID;
+
+#define TPL_APPLICATION  4
+#define TPL_CALLBACK     8
+#define TPL_NOTIFY       16
+#define TPL_HIGH_LEVEL   31
+
+#define EFI_SUCCESS               RETURN_SUCCESS
+#define EFI_INVALID_PARAMETER     RETURN_INVALID_PARAMETER
+#define EFI_UNSUPPORTED           RETURN_UNSUPPORTED
+#define EFI_BAD_BUFFER_SIZE       RETURN_BAD_BUFFER_SIZE
+#define EFI_BUFFER_TOO_SMALL      RETURN_BUFFER_TOO_SMALL
+#define EFI_NOT_READY             RETURN_NOT_READY
+#define EFI_DEVICE_ERROR          RETURN_DEVICE_ERROR
+#define EFI_WRITE_PROTECTED       RETURN_WRITE_PROTECTED
+#define EFI_OUT_OF_RESOURCES      RETURN_OUT_OF_RESOURCES
+#define EFI_NO_MEDIA              RETURN_NO_MEDIA
+#define EFI_MEDIA_CHANGED         RETURN_MEDIA_CHANGED
+#define EFI_NOT_FOUND             RETURN_NOT_FOUND
+#define EFI_NO_RESPONSE           RETURN_NO_RESPONSE
+#define EFI_TIMEOUT               RETURN_TIMEOUT
+#define EFI_ERROR(A)              RETURN_ERROR (A)
+
+#define EFI_TIMER_PERIOD_MICROSECONDS(Microseconds)  ((UINT64)(Microseconds) * 10)
+#define EFI_TIMER_PERIOD_MILLISECONDS(Milliseconds)  ((UINT64)(Milliseconds) * 10000)
+
+#define EFI_PAGE_SIZE             SIZE_4KB
+#define EFI_PAGES_TO_SIZE(Pages)  ((Pages) << 12)
+#define EFI_SIZE_TO_PAGES(Size)   (((Size) >> 12) + (((Size) & 0xFFF) ? 1 : 0))
+
+typedef enum {
+  AllocateAnyPages
+} EFI_ALLOCATE_TYPE;
+
+typedef enum {
+  EfiBootServicesData = 4
+} EFI_MEMORY_TYPE;
+
+#endif
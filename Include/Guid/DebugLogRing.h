@@ -0,0 +1,39 @@
+/** @file
+  RAM ring of DEBUG output on RPi5D.
+
+  DebugLib output of DXE drivers is appended to this ring with a generic
+  timer timestamp on every line and drained to the console UART later by
+  DebugLogDxe. The ring is installed as a configuration table in
+  EfiRuntimeServicesData, so the OS can read the firmware log: the text
+  is the last MIN (Head, Size) bytes ending at offset Head % Size of Data.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef DEBUG_LOG_RING_H_
+#define DEBUG_LOG_RING_H_
+
+#define RPI5D_DEBUG_LOG_RING_GUID \
+  { 0x3f6a9c2e, 0x81d4, 0x4b7a, { 0x9e, 0x05, 0x6c, 0x2d, 0xb8, 0x41, 0xf3, 0x7a } }
+
+#define DEBUG_LOG_RING_SIGNATURE  SIGNATURE_32 ('R', 'L', 'O', 'G')
+
+//
+// Bytes of text the ring holds; a power of two.
+//
+#define DEBUG_LOG_RING_SIZE  SIZE_128KB
+
+typedef struct {
+  UINT32     Signature;
+  UINT32     Size;          // bytes of Data
+  UINT64     Head;          // bytes ever appended
+  UINT64     Tail;          // bytes ever written to the UART
+  BOOLEAN    LineStart;     // the next byte starts a line
+  BOOLEAN    Synchronous;   // ExitBootServices: drain on every append
+  UINT8      Reserved[6];
+  UINT8      Data[];
+} DEBUG_LOG_RING;
+
+#endif
@@ -0,0 +1,33 @@
+/** @file
+  Result of the boot time DRAM pattern test on RPi5D.
+
+  MemoryScrubDxe installs this configuration table when it is built with
+  the pattern test. Failing ranges are also allocated as
+  EfiUnusableMemory, so neither UEFI nor the OS uses them.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MEMORY_TEST_RESULT_H_
+#define MEMORY_TEST_RESULT_H_
+
+#define RPI5D_MEMORY_TEST_RESULT_GUID \
+  { 0x7d20c4b8, 0x5e91, 0x4a36, { 0x8f, 0x4c, 0x2b, 0xe7, 0x10, 0x93, 0xd6, 0x5a } }
+
+#define MEMORY_TEST_RESULT_SIGNATURE  SIGNATURE_32 ('R', 'M', 'T', 'R')
+
+typedef struct {
+  UINT64    Base;
+  UINT64    Length;
+} MEMORY_TEST_FAILURE;
+
+typedef struct {
+  UINT32                 Signature;
+  UINT32                 Count;         // entries of Failures
+  UINT64                 BytesTested;
+  MEMORY_TEST_FAILURE    Failures[];    // page aligned, ascending
+} MEMORY_TEST_RESULT;
+
+#endif
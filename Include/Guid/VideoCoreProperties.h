@@ -0,0 +1,42 @@
+/** @file
+  VideoCore firmware properties of RPi5D.
+
+  MemoryInitPeiLib asks the VideoCore firmware for all of these in one
+  mailbox call before the MMU is on and publishes the answers in a GUID
+  HOB, so DXE drivers read them from memory instead of calling the
+  mailbox again. A field the firmware did not answer is 0.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef VIDEOCORE_PROPERTIES_H_
+#define VIDEOCORE_PROPERTIES_H_
+
+#define RPI5D_VIDEOCORE_PROPERTIES_GUID \
+  { 0x1e6c9b52, 0x0d47, 0x4f3a, { 0x96, 0xe8, 0x54, 0xa1, 0x2c, 0x7b, 0xd0, 0x3f } }
+
+typedef struct {
+  UINT32    FirmwareRevision;
+  UINT32    BoardRevision;
+  UINT64    BoardSerial;
+  UINT64    ArmMemoryBase;        // memory split: ARM part of the low 1GB
+  UINT64    ArmMemorySize;
+  UINT64    VcMemoryBase;         // memory split: VideoCore part
+  UINT64    VcMemorySize;
+  UINT32    ArmClockRate;         // Hz
+  UINT32    CoreClockRate;
+  UINT32    UartClockRate;
+  UINT32    EmmcClockRate;        // EMMC2
+  UINT8     MacAddress[6];
+  UINT8     Reserved[2];
+  UINT64    FramebufferBase;      // CPU physical address
+  UINT32    FramebufferSize;
+  UINT32    FramebufferWidth;
+  UINT32    FramebufferHeight;
+  UINT32    FramebufferPitch;     // bytes
+  UINT32    FramebufferDepth;     // bits per pixel
+} VIDEOCORE_PROPERTIES;
+
+#endif
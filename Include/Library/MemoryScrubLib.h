@@ -0,0 +1,55 @@
+/** @file
+  Clearing and quick testing of DRAM stripes.
+
+  Both functions touch nothing but the stripe and call no boot services,
+  so they may run on the secondary cores through the RPi5D work queue.
+  A stripe starts and ends on a cache line.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MEMORY_SCRUB_LIB_H_
+#define MEMORY_SCRUB_LIB_H_
+
+#include <Base.h>
+
+#define MEMORY_SCRUB_ALIGNMENT  64
+
+/**
+  Zero a stripe with DC ZVA, or with pairs of zero register stores when
+  DC ZVA is prohibited or its block does not divide the stripe.
+
+  @param  Buffer        Start of the stripe, MEMORY_SCRUB_ALIGNMENT aligned.
+  @param  Length        Bytes, a multiple of MEMORY_SCRUB_ALIGNMENT.
+**/
+VOID
+EFIAPI
+MemoryScrubZero (
+  IN VOID   *Buffer,
+  IN UINTN  Length
+  );
+
+/**
+  Write an address-derived pattern to a stripe, push it out to DRAM,
+  read it back and leave the stripe zeroed.
+
+  @param  Buffer        Start of the stripe, MEMORY_SCRUB_ALIGNMENT aligned.
+  @param  Length        Bytes, a multiple of MEMORY_SCRUB_ALIGNMENT.
+  @param  FailStart     Offset of the first mismatching word.
+  @param  FailEnd       Offset just past the last mismatching word.
+
+  @retval TRUE          The stripe read back correctly.
+  @retval FALSE         [FailStart, FailEnd) holds every mismatch.
+**/
+BOOLEAN
+EFIAPI
+MemoryScrubTest (
+  IN  VOID   *Buffer,
+  IN  UINTN  Length,
+  OUT UINTN  *FailStart,
+  OUT UINTN  *FailEnd
+  );
+
+#endif
@@ -0,0 +1,38 @@
+/** @file
+  RPi5D extensions of the RAM ring DebugLib.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PLATFORM_DEBUG_LOG_LIB_H_
+#define PLATFORM_DEBUG_LOG_LIB_H_
+
+#include <Library/DebugLib.h>
+
+/**
+  Write pending ring text to the console UART.
+
+  @param  Blocking      TRUE to wait until everything is written; FALSE to
+                        write only what the transmit FIFO accepts now.
+
+  @return Number of bytes written.
+**/
+UINTN
+EFIAPI
+DebugLogDrain (
+  IN BOOLEAN  Blocking
+  );
+
+/**
+  Drain the ring and write every later DEBUG message straight through,
+  for ExitBootServices when no timer will drain it again.
+**/
+VOID
+EFIAPI
+DebugLogSynchronous (
+  VOID
+  );
+
+#endif
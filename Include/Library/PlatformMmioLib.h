@@ -0,0 +1,173 @@
+/** @file
+  Register access of RPi5D drivers with few barriers.
+
+  The register windows are mapped Device-nGnRE, so accesses to one device
+  already reach it in program order. A barrier is only needed between
+  register accesses and normal memory the device reads or writes by DMA:
+  before a write, so the device sees memory written earlier, and after a
+  read, so memory read later is not read early. The single accessors pay
+  that one barrier; the block and update forms pay it once per call.
+
+  Build the firmware with -DPLATFORM_MMIO_TRACE to log every access with
+  a timestamp for profiling; RPi5D.dsc then lists the library as a
+  component with the define in its build options, which every module
+  linking it picks up.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PLATFORM_MMIO_LIB_H_
+#define PLATFORM_MMIO_LIB_H_
+
+#include <Base.h>
+
+//
+// One step of PlatformMmioUpdate32: Register = (Register & AndMask) | OrMask.
+// An AndMask of 0 writes OrMask without reading the register first.
+//
+typedef struct {
+  UINTN     Address;
+  UINT32    AndMask;
+  UINT32    OrMask;
+} PLATFORM_MMIO_UPDATE;
+
+//
+// Trace log entry
+//
+#define PLATFORM_MMIO_TRACE_READ   0x00
+#define PLATFORM_MMIO_TRACE_WRITE  0x80
+
+typedef struct {
+  UINT64    Timestamp;    // performance counter
+  UINT64    Address;
+  UINT64    Value;
+  UINT8     Access;       // PLATFORM_MMIO_TRACE_READ/WRITE | width in bytes
+  UINT8     Reserved[7];
+} PLATFORM_MMIO_TRACE_ENTRY;
+
+/**
+  Read a 32-bit register.
+
+  @param  Address       Register address.
+
+  @return Register value.
+**/
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  );
+
+/**
+  Write a 32-bit register.
+
+  @param  Address       Register address.
+  @param  Value         Value to write.
+**/
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  );
+
+/**
+  Read a 64-bit register with one access.
+
+  @param  Address       Register address, 8 byte aligned.
+
+  @return Register value.
+**/
+UINT64
+EFIAPI
+PlatformMmioRead64 (
+  IN UINTN  Address
+  );
+
+/**
+  Write a 64-bit register with one access.
+
+  @param  Address       Register address, 8 byte aligned.
+  @param  Value         Value to write.
+**/
+VOID
+EFIAPI
+PlatformMmioWrite64 (
+  IN UINTN   Address,
+  IN UINT64  Value
+  );
+
+/**
+  Read contiguous 32-bit registers.
+
+  @param  Address       First register.
+  @param  Count         Number of registers.
+  @param  Buffer        Values read.
+**/
+VOID
+EFIAPI
+PlatformMmioReadBlock32 (
+  IN  UINTN   Address,
+  IN  UINTN   Count,
+  OUT UINT32  *Buffer
+  );
+
+/**
+  Write contiguous 32-bit registers.
+
+  @param  Address       First register.
+  @param  Count         Number of registers.
+  @param  Buffer        Values to write.
+**/
+VOID
+EFIAPI
+PlatformMmioWriteBlock32 (
+  IN UINTN         Address,
+  IN UINTN         Count,
+  IN CONST UINT32  *Buffer
+  );
+
+/**
+  Apply read-modify-write steps in order, with one barrier at the end.
+
+  The steps are not ordered after normal memory written before the call;
+  call PlatformMmioBarrier first when a step starts a DMA.
+
+  @param  Updates       Steps.
+  @param  Count         Number of steps.
+**/
+VOID
+EFIAPI
+PlatformMmioUpdate32 (
+  IN CONST PLATFORM_MMIO_UPDATE  *Updates,
+  IN UINTN                       Count
+  );
+
+/**
+  Order register accesses against normal memory accesses.
+**/
+VOID
+EFIAPI
+PlatformMmioBarrier (
+  VOID
+  );
+
+/**
+  Return the trace log.
+
+  @param  Entries       Ring of entries; the oldest is at Total % Size once
+                        the ring has wrapped.
+  @param  Size          Entries in the ring, 0 without PLATFORM_MMIO_TRACE.
+
+  @return Accesses logged since boot.
+**/
+UINT64
+EFIAPI
+PlatformMmioTrace (
+  OUT CONST PLATFORM_MMIO_TRACE_ENTRY  **Entries,
+  OUT UINTN                            *Size
+  );
+
+#endif
@@ -0,0 +1,56 @@
+/** @file
+  RPi5D extensions of SerialPortLib for the PL011 console UART.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PLATFORM_SERIAL_PORT_LIB_H_
+#define PLATFORM_SERIAL_PORT_LIB_H_
+
+#include <Library/SerialPortLib.h>
+
+//
+// Depth of the PL011 transmit FIFO.
+//
+#define PL011_TX_FIFO_DEPTH  32
+#define PL011_RX_FIFO_DEPTH  32
+
+/**
+  Write as much of a buffer as the transmit FIFO accepts right now,
+  without waiting for it to drain.
+
+  @param  Buffer           Data to write.
+  @param  NumberOfBytes    Number of bytes in Buffer.
+
+  @return Number of bytes queued, possibly 0 when the FIFO is full.
+**/
+UINTN
+EFIAPI
+SerialPortWriteNonBlocking (
+  IN UINT8  *Buffer,
+  IN UINTN  NumberOfBytes
+  );
+
+/**
+  Compute the PL011 divisor of a baud rate from the UART clock.
+
+  The divisor is UARTCLK / (16 * BaudRate) in 1/64ths, rounded to the
+  nearest: the top bits go to UART_IBRD and the low six to UART_FBRD.
+
+  @param  BaudRate      Requested baud rate.
+  @param  Divisor       The divisor in 1/64ths.
+
+  @retval RETURN_SUCCESS        Divisor computed.
+  @retval RETURN_UNSUPPORTED    The rate is above UARTCLK / 16 or too low
+                                for a 16-bit integer divisor.
+**/
+RETURN_STATUS
+EFIAPI
+SerialPortBaudDivisor (
+  IN  UINT64  BaudRate,
+  OUT UINT32  *Divisor
+  );
+
+#endif
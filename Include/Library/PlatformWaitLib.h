@@ -0,0 +1,189 @@
+/** @file
+  Bounded waits on hardware conditions.
+
+  A condition is polled against a TimerLib deadline with an exponentially
+  growing interval, so short settle times are caught quickly and long
+  ones cost few register reads. The asynchronous form polls from a timer
+  event and signals the caller's event when it is done, leaving the
+  dispatcher free to run other drivers in the meantime.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PLATFORM_WAIT_LIB_H_
+#define PLATFORM_WAIT_LIB_H_
+
+#include <Uefi.h>
+
+//
+// Poll interval bounds, in microseconds. Asynchronous waits start higher
+// as the timer tick is coarse anyway.
+//
+#define PLATFORM_WAIT_MIN_INTERVAL        1
+#define PLATFORM_WAIT_MAX_INTERVAL        1000
+#define PLATFORM_WAIT_ASYNC_MIN_INTERVAL  100
+#define PLATFORM_WAIT_ASYNC_MAX_INTERVAL  10000
+
+/**
+  Condition to wait for.
+
+  @param  Context       Caller context.
+
+  @retval TRUE          Condition met, the wait is over.
+  @retval FALSE         Keep waiting.
+**/
+typedef
+BOOLEAN
+(EFIAPI *PLATFORM_WAIT_CONDITION)(
+  IN VOID  *Context
+  );
+
+//
+// State of an asynchronous wait. Owned by the caller and left alone until
+// Status is no longer EFI_NOT_READY or the wait is cancelled.
+//
+typedef struct {
+  PLATFORM_WAIT_CONDITION  Condition;
+  VOID                     *Context;
+  UINTN                    Address;
+  UINT32                   Mask;
+  UINT32                   Value;
+  UINT64                   Start;
+  UINT64                   Timeout;
+  UINT64                   Interval;
+  EFI_EVENT                Timer;
+  EFI_EVENT                Event;
+  EFI_STATUS               Status;
+  UINT64                   Elapsed;
+} PLATFORM_WAIT;
+
+/**
+  Wait for a condition to be met.
+
+  @param  Condition     Condition to poll.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitCondition (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  OUT UINT64                   *Elapsed OPTIONAL
+  );
+
+/**
+  Wait for a condition to be met, polling it at a fixed interval. For
+  conditions that must be polled steadily rather than with a growing
+  interval, such as completions drained from an event ring.
+
+  @param  Condition     Condition to poll.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds, MAX_UINT64 to wait forever.
+  @param  Interval      Poll interval in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitConditionInterval (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  UINT64                   Interval,
+  OUT UINT64                   *Elapsed OPTIONAL
+  );
+
+/**
+  Wait for the masked bits of a 32-bit MMIO register to equal Value.
+
+  @param  Address       Register address.
+  @param  Mask          Bits to test.
+  @param  Value         Expected value of the masked bits.
+  @param  Timeout       Timeout in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitMmio32 (
+  IN  UINTN   Address,
+  IN  UINT32  Mask,
+  IN  UINT32  Value,
+  IN  UINT64  Timeout,
+  OUT UINT64  *Elapsed OPTIONAL
+  );
+
+/**
+  Start waiting for a condition in the background. Wait->Status reads
+  EFI_NOT_READY until the condition is met (EFI_SUCCESS) or the timeout
+  expires (EFI_TIMEOUT); Event is signalled at that point.
+
+  @param  Wait          Wait state, kept valid until the wait is over.
+  @param  Condition     Condition to poll, called at TPL_CALLBACK.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds.
+  @param  Event         Event to signal when the wait is over, or NULL.
+
+  @retval EFI_SUCCESS   Wait started, or already over.
+  @retval others        Timer event could not be created.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitConditionAsync (
+  OUT PLATFORM_WAIT            *Wait,
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  EFI_EVENT                Event OPTIONAL
+  );
+
+/**
+  Start waiting in the background for the masked bits of a 32-bit MMIO
+  register to equal Value. See PlatformWaitConditionAsync().
+
+  @param  Wait          Wait state, kept valid until the wait is over.
+  @param  Address       Register address.
+  @param  Mask          Bits to test.
+  @param  Value         Expected value of the masked bits.
+  @param  Timeout       Timeout in microseconds.
+  @param  Event         Event to signal when the wait is over, or NULL.
+
+  @retval EFI_SUCCESS   Wait started, or already over.
+  @retval others        Timer event could not be created.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitMmio32Async (
+  OUT PLATFORM_WAIT  *Wait,
+  IN  UINTN          Address,
+  IN  UINT32         Mask,
+  IN  UINT32         Value,
+  IN  UINT64         Timeout,
+  IN  EFI_EVENT      Event OPTIONAL
+  );
+
+/**
+  Stop a background wait that is still running. Its event is not
+  signalled.
+
+  @param  Wait          Wait state.
+**/
+VOID
+EFIAPI
+PlatformWaitCancel (
+  IN OUT PLATFORM_WAIT  *Wait
+  );
+
+#endif
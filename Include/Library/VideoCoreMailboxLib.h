@@ -0,0 +1,85 @@
+/** @file
+  VideoCore firmware mailbox of RPi5D.
+
+  The property channel takes a buffer of tagged requests, answers every
+  tag in place and returns the buffer. Batch related queries into one
+  buffer: each call is a round trip through the VideoCore firmware.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef VIDEOCORE_MAILBOX_LIB_H_
+#define VIDEOCORE_MAILBOX_LIB_H_
+
+#include <Base.h>
+
+//
+// Buffer codes: VIDEOCORE_MBOX_REQUEST in the second word on the way in,
+// VIDEOCORE_MBOX_SUCCESS on the way out. Every answered tag has
+// VIDEOCORE_MBOX_TAG_RESPONSE set in its code word, with the length of
+// its answer in the low bits.
+//
+#define VIDEOCORE_MBOX_REQUEST       0x00000000
+#define VIDEOCORE_MBOX_SUCCESS       0x80000000
+#define VIDEOCORE_MBOX_TAG_RESPONSE  BIT31
+#define VIDEOCORE_MBOX_END_TAG       0x00000000
+
+//
+// Property tags
+//
+#define VIDEOCORE_TAG_GET_FIRMWARE_REVISION   0x00000001
+#define VIDEOCORE_TAG_GET_BOARD_REVISION      0x00010002
+#define VIDEOCORE_TAG_GET_MAC_ADDRESS         0x00010003
+#define VIDEOCORE_TAG_GET_BOARD_SERIAL        0x00010004
+#define VIDEOCORE_TAG_GET_ARM_MEMORY          0x00010005
+#define VIDEOCORE_TAG_GET_VC_MEMORY           0x00010006
+#define VIDEOCORE_TAG_GET_CLOCK_RATE          0x00030002
+#define VIDEOCORE_TAG_ALLOCATE_BUFFER         0x00040001
+#define VIDEOCORE_TAG_GET_PHYSICAL_SIZE       0x00040003
+#define VIDEOCORE_TAG_GET_DEPTH               0x00040005
+#define VIDEOCORE_TAG_GET_PITCH               0x00040008
+
+//
+// Clock IDs of VIDEOCORE_TAG_GET_CLOCK_RATE
+//
+#define VIDEOCORE_CLOCK_EMMC                  1
+#define VIDEOCORE_CLOCK_UART                  2
+#define VIDEOCORE_CLOCK_ARM                   3
+#define VIDEOCORE_CLOCK_CORE                  4
+#define VIDEOCORE_CLOCK_EMMC2                 12
+
+//
+// Board revision: new style codes carry the DRAM size, 256MB << field.
+//
+#define VIDEOCORE_BOARD_NEW_STYLE             BIT23
+#define VIDEOCORE_BOARD_MEMORY_SIZE(Rev)      LShiftU64 (SIZE_256MB, ((Rev) >> 20) & 0x7)
+
+//
+// The VideoCore sees the low 1GB of DRAM at bus address 0xC0000000,
+// uncached. Property buffers must lie in that gigabyte; addresses in
+// answers are bus addresses.
+//
+#define VIDEOCORE_BUS_ALIAS                   0xC0000000
+#define VIDEOCORE_BUS_TO_PHYS(Address)        ((Address) & ~VIDEOCORE_BUS_ALIAS)
+
+/**
+  Send a property buffer to the VideoCore firmware and wait for the answer.
+
+  @param  Buffer        Property buffer: total size, VIDEOCORE_MBOX_REQUEST,
+                        tags, VIDEOCORE_MBOX_END_TAG. 16 byte aligned and
+                        below 1GB. Answered in place.
+
+  @retval RETURN_SUCCESS            The firmware answered the buffer.
+  @retval RETURN_INVALID_PARAMETER  Buffer is misaligned or above 1GB.
+  @retval RETURN_TIMEOUT            The firmware did not answer.
+  @retval RETURN_DEVICE_ERROR       The firmware rejected the buffer.
+**/
+RETURN_STATUS
+EFIAPI
+VideoCoreMailboxProperty (
+  IN OUT UINT32  *Buffer
+  );
+
+#endif
@@ -1,9 +1,78 @@
 #ifndef RPI5D_PLATFORM_H__
 #define RPI5D_PLATFORM_H__
 
+//
+// AcpiTables/Dsdt.asl includes this file; the constants it uses carry
+// no integer suffixes.
+//
+
 #define RPI5D_PERIPHERAL_BASE     0x107C000000ULL
 #define RPI5D_UART_BASE           (RPI5D_PERIPHERAL_BASE + 0x4000)
-#define RPI5D_SYSTEM_MEMORY_BASE  0x00000000
-#define RPI5D_SYSTEM_MEMORY_SIZE  0x20000000  // 8GB
+#define RPI5D_UART_INTERRUPT      153   // GIC SPI 121
+#define RPI5D_MAILBOX_BASE        (RPI5D_PERIPHERAL_BASE + 0x13880)
+
+//
+// Four Cortex-A76 cores. Their MPIDR has MT set and the core number in
+// Aff1: 0x81000000, 0x81000100, 0x81000200, 0x81000300.
+//
+#define RPI5D_CORE_COUNT          4
+#define RPI5D_MPIDR_AFFINITY      0xFFFFFF
+#define RPI5D_MPIDR_CORE_SHIFT    8
+#define RPI5D_MPIDR_CORE_MASK     0xFF00
+#define RPI5D_CORE_POSITION(MpId)  (((MpId) & RPI5D_MPIDR_CORE_MASK) >> RPI5D_MPIDR_CORE_SHIFT)
+
+//
+// DRAM. The size is what the board is built with; the firmware device
+// tree, or else the VideoCore board revision, gives the size actually
+// fitted. PcdSystemMemorySize must match.
+//
+#define RPI5D_SYSTEM_MEMORY_BASE   0x00000000
+#define RPI5D_SYSTEM_MEMORY_SIZE   0x200000000  // 8GB
+#define RPI5D_SYSTEM_MEMORY_LIMIT  0x1FFFFFFFF
+
+//
+// Framebuffer of the VideoCore firmware when the device tree does not
+// describe one: 1920x1080 at 32bpp, rounded up to 2MB.
+//
+#define RPI5D_FRAMEBUFFER_BASE     0x3B000000
+#define RPI5D_FRAMEBUFFER_SIZE     0x800000
+
+//
+// Device windows, each a whole number of 1GB blocks so the MMU maps
+// them with block descriptors.
+//
+// 0x10_0000_0000 - 0x10_8000_0000: PCIe root complex registers and the
+// SoC peripherals (UART, GIC-600 at 0x10_7C40_0000).
+//
+#define RPI5D_SOC_DEVICE_BASE      0x1000000000
+#define RPI5D_SOC_DEVICE_SIZE      0x80000000
+
+//
+// 0x18_0000_0000 - 0x20_0000_0000: PCIe outbound windows, with RP1 at
+// 0x1F_0000_0000.
+//
+#define RPI5D_PCIE_WINDOW_BASE     0x1800000000
+#define RPI5D_PCIE_WINDOW_SIZE     0x800000000
+
+//
+// PCIe controller of the external connector (pcie1). Its outbound memory
+// window puts PCI 0xC000_0000 at CPU 0x1B_0000_0000; DRAM appears to its
+// devices at RPI5D_PCIE_DMA_OFFSET, as it does to RP1.
+//
+#define RPI5D_PCIE_BASE            0x1000110000
+#define RPI5D_PCIE_MEM_BASE        0x1B00000000
+#define RPI5D_PCIE_MEM_BUS_BASE    0xC0000000
+#define RPI5D_PCIE_MEM_SIZE        0x40000000
+#define RPI5D_PCIE_DMA_OFFSET      0x1000000000
+
+//
+// SD card slot: the SDHCI of the BCM2712 (sdio1), clocked from the
+// VideoCore EMMC2 clock. Two always-on GPIOs switch the slot power and
+// its I/O regulator (high for 1.8 V).
+//
+#define RPI5D_SDIO_BASE            0x1000FFF000
+#define RPI5D_GPIO_AON_BASE        0x107D517C00
+#define RPI5D_SD_IO_1V8_GPIO       3
+#define RPI5D_SD_VCC_GPIO          4
 
 #endif
@@ -0,0 +1,33 @@
+/** @file
+  Region types of the RPi5D virtual memory map.
+
+  ArmPlatformGetVirtualMemoryMap describes how each region is mapped;
+  the parallel mRPi5DMemoryTypes array tells MemoryInitPeiLib what to
+  report to DXE for it.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RPI5D_MEMORY_MAP_H_
+#define RPI5D_MEMORY_MAP_H_
+
+//
+// Most regions in the map, terminator included.
+//
+#define RPI5D_MEMORY_REGIONS_MAX  24
+
+typedef enum {
+  RPI5D_MEM_DEVICE_REGION,      // MMIO; no memory resource
+  RPI5D_MEM_BASIC_REGION,       // DRAM for UEFI and the OS
+  RPI5D_MEM_RESERVED_REGION     // DRAM kept by the firmware, VideoCore or framebuffer
+} RPI5D_MEMORY_TYPE;
+
+//
+// Type of each region returned by ArmPlatformGetVirtualMemoryMap, in
+// the same order.
+//
+extern RPI5D_MEMORY_TYPE  mRPi5DMemoryTypes[RPI5D_MEMORY_REGIONS_MAX];
+
+#endif
@@ -0,0 +1,63 @@
+/** @file
+  Work queue of the RPi5D secondary cores.
+
+  Boot time jobs that split into independent pieces, such as clearing
+  memory or the framebuffer and hashing images, submit each piece here.
+  The pieces run on the secondary cores, and on the boot core while it
+  waits for them. Items run outside the TPL model and must not call boot
+  services or DEBUG.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RPI5D_WORK_QUEUE_H_
+#define RPI5D_WORK_QUEUE_H_
+
+#include <Protocol/MpService.h>
+
+#define RPI5D_WORK_QUEUE_PROTOCOL_GUID \
+  { 0x9b41e0d7, 0x2c6a, 0x4f83, { 0xa5, 0x1e, 0x07, 0xd3, 0x6c, 0x92, 0xb8, 0x4f } }
+
+typedef struct _RPI5D_WORK_QUEUE_PROTOCOL RPI5D_WORK_QUEUE_PROTOCOL;
+
+/**
+  Queue one work item. Only the boot core submits. When the queue is
+  full the boot core runs queued items until there is room.
+
+  @param  This          The work queue.
+  @param  Procedure     Function to run on some core.
+  @param  Argument      Its argument.
+
+  @retval EFI_SUCCESS            The item is queued.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_DEVICE_ERROR       Not called on the boot core.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RPI5D_WORK_QUEUE_SUBMIT)(
+  IN RPI5D_WORK_QUEUE_PROTOCOL  *This,
+  IN EFI_AP_PROCEDURE           Procedure,
+  IN VOID                       *Argument
+  );
+
+/**
+  Run queued items on the boot core too, and return once every item
+  submitted so far has finished.
+
+  @param  This          The work queue.
+**/
+typedef
+VOID
+(EFIAPI *RPI5D_WORK_QUEUE_WAIT)(
+  IN RPI5D_WORK_QUEUE_PROTOCOL  *This
+  );
+
+struct _RPI5D_WORK_QUEUE_PROTOCOL {
+  UINTN                      Workers;   // cores running items, the boot core included
+  RPI5D_WORK_QUEUE_SUBMIT    Submit;
+  RPI5D_WORK_QUEUE_WAIT      Wait;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/** @file
+  RP1 southbridge services on RPi5D.
+
+  Rp1BaseDxe probes RP1 once and publishes what it found here, so the
+  drivers of the RP1 blocks take their register windows and the chip
+  revision from memory. Block clocks are reference counted: a clock runs
+  while at least one driver holds it and is gated otherwise.
+
+  The GUID is declared in RPi5D.dec; consumers list gRp1ProtocolGuid in
+  their depex so that they are dispatched after Rp1BaseDxe.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RP1_PROTOCOL_H_
+#define RP1_PROTOCOL_H_
+
+#define RP1_PROTOCOL_GUID \
+  { 0x5c8e2f14, 0xa7d3, 0x4e91, { 0xb0, 0x6c, 0x3d, 0x82, 0xe9, 0x17, 0x4a, 0xc5 } }
+
+extern EFI_GUID  gRp1ProtocolGuid;
+
+typedef struct _RP1_PROTOCOL RP1_PROTOCOL;
+
+//
+// RP1 blocks with a clock and reset of their own. The value is also the
+// bit of the block in RP1_PROTOCOL.Clocks.
+//
+typedef enum {
+  Rp1BlockXhci,
+  Rp1BlockGmac,
+  Rp1BlockPcie,
+  Rp1BlockSdio,
+  Rp1BlockMax
+} RP1_BLOCK;
+
+/**
+  Take a reference on the clock of a block. The first reference starts
+  the clock and returns once it is stable.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to clock.
+
+  @retval EFI_SUCCESS            The clock is running.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_TIMEOUT            The clock did not become stable; no
+                                 reference was taken.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RP1_ENABLE_CLOCK)(
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
+  );
+
+/**
+  Drop a reference taken by EnableClock. The last one gates the clock.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to release.
+
+  @retval EFI_SUCCESS            The reference was dropped.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_NOT_STARTED        No reference is held on the clock.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RP1_DISABLE_CLOCK)(
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
+  );
+
+/**
+  Pulse the reset of a block, returning its registers to their reset
+  values. The caller must hold a reference on its clock.
+
+  @param  This          The RP1 protocol.
+  @param  Block         Block to reset.
+
+  @retval EFI_SUCCESS            The block was reset.
+  @retval EFI_INVALID_PARAMETER  Block is not a valid RP1_BLOCK.
+  @retval EFI_NOT_READY          The clock of the block is gated.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RP1_RESET)(
+  IN RP1_PROTOCOL  *This,
+  IN RP1_BLOCK     Block
+  );
+
+struct _RP1_PROTOCOL {
+  UINT64               Base;                     // RP1 peripheral base
+  UINT64               BlockBase[Rp1BlockMax];   // register window, 0 if none
+  UINT32               ChipId;
+  UINT32               SysCfg;
+  UINT32               FirmwareVersion;
+  UINT32               Clocks;                   // enabled clocks, bit per RP1_BLOCK
+  RP1_ENABLE_CLOCK     EnableClock;
+  RP1_DISABLE_CLOCK    DisableClock;
+  RP1_RESET            Reset;
+};
+
+//
+// Fields of ChipId
+//
+#define RP1_CHIP_PART(ChipId)      (((ChipId) >> 12) & 0xFFF)
+#define RP1_CHIP_MAJOR(ChipId)     (((ChipId) >> 4) & 0xF)
+#define RP1_CHIP_MINOR(ChipId)     ((ChipId) & 0xF)
+
+#endif
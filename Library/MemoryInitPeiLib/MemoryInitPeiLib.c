@@ -0,0 +1,263 @@
+/** @file
+  Memory initialization of RPi5D from the platform memory map.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/ArmMmuLib.h>
+#include <Library/ArmPlatformLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Library/VideoCoreMailboxLib.h"
+#include "../../Include/Platform/RPi5DMemoryMap.h"
+
+#define RPI5D_DRAM_RESOURCE_ATTRIBUTES               \
+  (EFI_RESOURCE_ATTRIBUTE_PRESENT                 | \
+   EFI_RESOURCE_ATTRIBUTE_INITIALIZED             | \
+   EFI_RESOURCE_ATTRIBUTE_UNCACHEABLE             | \
+   EFI_RESOURCE_ATTRIBUTE_WRITE_COMBINEABLE       | \
+   EFI_RESOURCE_ATTRIBUTE_WRITE_THROUGH_CACHEABLE | \
+   EFI_RESOURCE_ATTRIBUTE_WRITE_BACK_CACHEABLE    | \
+   EFI_RESOURCE_ATTRIBUTE_TESTED)
+
+STATIC CONST EFI_GUID  mVideoCorePropertiesGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+
+#pragma pack (1)
+
+typedef struct {
+  UINT32    Tag;
+  UINT32    Size;         // bytes of the value buffer
+  UINT32    Code;
+} VIDEOCORE_TAG;
+
+typedef struct {
+  VIDEOCORE_TAG    Header;
+  UINT32           Value;
+} VIDEOCORE_TAG_U32;
+
+typedef struct {
+  VIDEOCORE_TAG    Header;
+  UINT32           Value[2];
+} VIDEOCORE_TAG_U32X2;
+
+typedef struct {
+  UINT32                 BufferSize;
+  UINT32                 Code;
+  VIDEOCORE_TAG_U32      FirmwareRevision;
+  VIDEOCORE_TAG_U32      BoardRevision;
+  VIDEOCORE_TAG_U32X2    BoardSerial;
+  VIDEOCORE_TAG_U32X2    MacAddress;
+  VIDEOCORE_TAG_U32X2    ArmMemory;
+  VIDEOCORE_TAG_U32X2    VcMemory;
+  VIDEOCORE_TAG_U32X2    ArmClock;
+  VIDEOCORE_TAG_U32X2    CoreClock;
+  VIDEOCORE_TAG_U32X2    UartClock;
+  VIDEOCORE_TAG_U32X2    EmmcClock;
+  VIDEOCORE_TAG_U32X2    PhysicalSize;
+  VIDEOCORE_TAG_U32      Depth;
+  VIDEOCORE_TAG_U32X2    Framebuffer;
+  VIDEOCORE_TAG_U32      Pitch;
+  UINT32                 EndTag;
+} VIDEOCORE_PROPERTY_REQUEST;
+
+#pragma pack ()
+
+//
+// Fill in a tag header; Value is the first word of the value buffer.
+//
+#define VIDEOCORE_TAG_INIT(Field, TagId, Value0)                    \
+  do {                                                              \
+    (Field).Header.Tag  = (TagId);                                  \
+    (Field).Header.Size = sizeof (Field) - sizeof (VIDEOCORE_TAG);  \
+    (Field).Header.Code = VIDEOCORE_MBOX_REQUEST;                   \
+    *(UINT32 *)(&(Field).Header + 1) = (Value0);                    \
+  } while (FALSE)
+
+//
+// The answer to a tag, if the firmware gave one.
+//
+#define VIDEOCORE_TAG_ANSWERED(Field)  (((Field).Header.Code & VIDEOCORE_MBOX_TAG_RESPONSE) != 0)
+
+/**
+  Ask the VideoCore firmware for the board properties in one mailbox
+  call and publish them in a RPI5D_VIDEOCORE_PROPERTIES_GUID HOB.
+
+  The framebuffer the firmware set up is claimed at its current geometry,
+  so DisplayDxe takes it over unchanged. Runs with the MMU off.
+**/
+STATIC
+VOID
+MemoryInitVideoCoreProperties (
+  VOID
+  )
+{
+  VIDEOCORE_PROPERTY_REQUEST  *Request;
+  VIDEOCORE_PROPERTIES        Properties;
+  RETURN_STATUS               Status;
+
+  //
+  // Pages come from the UEFI region low in DRAM, inside the gigabyte the
+  // VideoCore reaches; VideoCoreMailboxProperty checks.
+  //
+  Request = AllocatePages (EFI_SIZE_TO_PAGES (sizeof (*Request)));
+  if (Request == NULL) {
+    return;
+  }
+
+  ZeroMem (Request, sizeof (*Request));
+  Request->BufferSize = sizeof (*Request);
+  Request->Code       = VIDEOCORE_MBOX_REQUEST;
+  VIDEOCORE_TAG_INIT (Request->FirmwareRevision, VIDEOCORE_TAG_GET_FIRMWARE_REVISION, 0);
+  VIDEOCORE_TAG_INIT (Request->BoardRevision, VIDEOCORE_TAG_GET_BOARD_REVISION, 0);
+  VIDEOCORE_TAG_INIT (Request->BoardSerial, VIDEOCORE_TAG_GET_BOARD_SERIAL, 0);
+  VIDEOCORE_TAG_INIT (Request->MacAddress, VIDEOCORE_TAG_GET_MAC_ADDRESS, 0);
+  VIDEOCORE_TAG_INIT (Request->ArmMemory, VIDEOCORE_TAG_GET_ARM_MEMORY, 0);
+  VIDEOCORE_TAG_INIT (Request->VcMemory, VIDEOCORE_TAG_GET_VC_MEMORY, 0);
+  VIDEOCORE_TAG_INIT (Request->ArmClock, VIDEOCORE_TAG_GET_CLOCK_RATE, VIDEOCORE_CLOCK_ARM);
+  VIDEOCORE_TAG_INIT (Request->CoreClock, VIDEOCORE_TAG_GET_CLOCK_RATE, VIDEOCORE_CLOCK_CORE);
+  VIDEOCORE_TAG_INIT (Request->UartClock, VIDEOCORE_TAG_GET_CLOCK_RATE, VIDEOCORE_CLOCK_UART);
+  VIDEOCORE_TAG_INIT (Request->EmmcClock, VIDEOCORE_TAG_GET_CLOCK_RATE, VIDEOCORE_CLOCK_EMMC2);
+  VIDEOCORE_TAG_INIT (Request->PhysicalSize, VIDEOCORE_TAG_GET_PHYSICAL_SIZE, 0);
+  VIDEOCORE_TAG_INIT (Request->Depth, VIDEOCORE_TAG_GET_DEPTH, 0);
+  VIDEOCORE_TAG_INIT (Request->Framebuffer, VIDEOCORE_TAG_ALLOCATE_BUFFER, SIZE_4KB);
+  VIDEOCORE_TAG_INIT (Request->Pitch, VIDEOCORE_TAG_GET_PITCH, 0);
+  Request->EndTag = VIDEOCORE_MBOX_END_TAG;
+
+  Status = VideoCoreMailboxProperty ((UINT32 *)Request);
+  if (RETURN_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "RPi5D: VideoCore properties unavailable: %r\n", Status));
+    FreePages (Request, EFI_SIZE_TO_PAGES (sizeof (*Request)));
+    return;
+  }
+
+  ZeroMem (&Properties, sizeof (Properties));
+  if (VIDEOCORE_TAG_ANSWERED (Request->FirmwareRevision)) {
+    Properties.FirmwareRevision = Request->FirmwareRevision.Value;
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->BoardRevision)) {
+    Properties.BoardRevision = Request->BoardRevision.Value;
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->BoardSerial)) {
+    Properties.BoardSerial = LShiftU64 (Request->BoardSerial.Value[1], 32) | Request->BoardSerial.Value[0];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->MacAddress)) {
+    CopyMem (Properties.MacAddress, Request->MacAddress.Value, sizeof (Properties.MacAddress));
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->ArmMemory)) {
+    Properties.ArmMemoryBase = Request->ArmMemory.Value[0];
+    Properties.ArmMemorySize = Request->ArmMemory.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->VcMemory)) {
+    Properties.VcMemoryBase = Request->VcMemory.Value[0];
+    Properties.VcMemorySize = Request->VcMemory.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->ArmClock)) {
+    Properties.ArmClockRate = Request->ArmClock.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->CoreClock)) {
+    Properties.CoreClockRate = Request->CoreClock.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->UartClock)) {
+    Properties.UartClockRate = Request->UartClock.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->EmmcClock)) {
+    Properties.EmmcClockRate = Request->EmmcClock.Value[1];
+  }
+
+  if (VIDEOCORE_TAG_ANSWERED (Request->Framebuffer) && (Request->Framebuffer.Value[0] != 0) &&
+      VIDEOCORE_TAG_ANSWERED (Request->PhysicalSize) && VIDEOCORE_TAG_ANSWERED (Request->Depth) &&
+      VIDEOCORE_TAG_ANSWERED (Request->Pitch))
+  {
+    Properties.FramebufferBase   = VIDEOCORE_BUS_TO_PHYS (Request->Framebuffer.Value[0]);
+    Properties.FramebufferSize   = Request->Framebuffer.Value[1];
+    Properties.FramebufferWidth  = Request->PhysicalSize.Value[0];
+    Properties.FramebufferHeight = Request->PhysicalSize.Value[1];
+    Properties.FramebufferDepth  = Request->Depth.Value;
+    Properties.FramebufferPitch  = Request->Pitch.Value;
+  }
+
+  FreePages (Request, EFI_SIZE_TO_PAGES (sizeof (*Request)));
+
+  DEBUG ((
+    DEBUG_INFO,
+    "RPi5D: VideoCore firmware 0x%08x, board 0x%08x, ARM %u MHz\n",
+    Properties.FirmwareRevision,
+    Properties.BoardRevision,
+    Properties.ArmClockRate / 1000000
+    ));
+
+  BuildGuidDataHob (&mVideoCorePropertiesGuid, &Properties, sizeof (Properties));
+}
+
+/**
+  Describe DRAM to DXE and turn on the MMU.
+
+  Basic regions become system memory. Reserved regions are system memory
+  allocated as EfiReservedMemoryType, so neither UEFI nor the OS uses the
+  VideoCore carve-outs or the framebuffer. Device regions are only mapped.
+
+  The VideoCore firmware properties are queried first: the memory map
+  falls back on them when there is no device tree.
+
+  @param  UefiMemoryBase  Base of the memory PrePi runs DXE in.
+  @param  UefiMemorySize  Size of that memory.
+
+  @retval EFI_SUCCESS     Memory described and the MMU enabled.
+**/
+EFI_STATUS
+EFIAPI
+MemoryPeim (
+  IN EFI_PHYSICAL_ADDRESS  UefiMemoryBase,
+  IN UINT64                UefiMemorySize
+  )
+{
+  ARM_MEMORY_REGION_DESCRIPTOR  *MemoryTable;
+  EFI_STATUS                    Status;
+  UINTN                         Index;
+
+  MemoryInitVideoCoreProperties ();
+
+  ArmPlatformGetVirtualMemoryMap (&MemoryTable);
+  ASSERT (MemoryTable != NULL);
+
+  for (Index = 0; MemoryTable[Index].Length != 0; Index++) {
+    if (mRPi5DMemoryTypes[Index] == RPI5D_MEM_DEVICE_REGION) {
+      continue;
+    }
+
+    BuildResourceDescriptorHob (
+      EFI_RESOURCE_SYSTEM_MEMORY,
+      RPI5D_DRAM_RESOURCE_ATTRIBUTES,
+      MemoryTable[Index].PhysicalBase,
+      MemoryTable[Index].Length
+      );
+
+    if (mRPi5DMemoryTypes[Index] == RPI5D_MEM_RESERVED_REGION) {
+      BuildMemoryAllocationHob (
+        MemoryTable[Index].PhysicalBase,
+        MemoryTable[Index].Length,
+        EfiReservedMemoryType
+        );
+    }
+  }
+
+  Status = ArmConfigureMmu (MemoryTable, NULL, NULL);
+  ASSERT_EFI_ERROR (Status);
+
+  return EFI_SUCCESS;
+}
@@ -5,18 +5,367 @@
 *
 **/
 
-#include <Uefi/UefiBaseType.h>
+#include <PiPei.h>
 #include <Library/ArmPlatformLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
 #include <Library/IoLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <libfdt.h>
+#include "../../Include/Guid/VideoCoreProperties.h"
+#include "../../Include/Library/VideoCoreMailboxLib.h"
 #include "../../Include/Platform/RPi5D.h"
+#include "../../Include/Platform/RPi5DMemoryMap.h"
+
+//
+// Carve-outs are rounded out to this, so DRAM keeps 2MB block mappings.
+//
+#define RPI5D_CARVE_ALIGNMENT  SIZE_2MB
+
+STATIC_ASSERT (
+  FixedPcdGet64 (PcdSystemMemorySize) == RPI5D_SYSTEM_MEMORY_SIZE,
+  "PcdSystemMemorySize must match RPI5D_SYSTEM_MEMORY_SIZE"
+  );
+
+typedef struct {
+  UINT64                          Base;
+  UINT64                          Length;
+  ARM_MEMORY_REGION_ATTRIBUTES    Attributes;
+  RPI5D_MEMORY_TYPE               Type;
+} RPI5D_MEMORY_REGION;
+
+//
+// Device tree the firmware passes in x0, saved by ArmPlatformPeiBootAction
+//
+UINT64  mRPi5DFdtBase;
+
+RPI5D_MEMORY_TYPE  mRPi5DMemoryTypes[RPI5D_MEMORY_REGIONS_MAX];
+
+STATIC CONST EFI_GUID  mVideoCorePropertiesGuid = RPI5D_VIDEOCORE_PROPERTIES_GUID;
+
+//
+// Device windows. ARM_MEMORY_REGION_ATTRIBUTE_DEVICE is Device-nGnRE:
+// accesses stay in program order and are never merged or speculated,
+// while posted writes keep the RP1 and XHCI register paths fast.
+//
+STATIC CONST RPI5D_MEMORY_REGION  mRPi5DDeviceRegions[] = {
+  // PCIe root complex registers and SoC peripherals
+  { RPI5D_SOC_DEVICE_BASE,  RPI5D_SOC_DEVICE_SIZE,  ARM_MEMORY_REGION_ATTRIBUTE_DEVICE, RPI5D_MEM_DEVICE_REGION },
+  // PCIe outbound windows: RP1 peripherals, XHCI and GMAC included
+  { RPI5D_PCIE_WINDOW_BASE, RPI5D_PCIE_WINDOW_SIZE, ARM_MEMORY_REGION_ATTRIBUTE_DEVICE, RPI5D_MEM_DEVICE_REGION }
+};
+
+/**
+  Read a cell-encoded number from a device tree property.
+
+  @param  Cells         First cell.
+  @param  Count         Number of 32-bit cells, 1 or 2.
+
+  @return Value of the cells.
+**/
+STATIC
+UINT64
+RPi5DReadCells (
+  IN CONST UINT32  *Cells,
+  IN INT32         Count
+  )
+{
+  UINT64  Value;
+
+  Value = 0;
+  while (Count-- > 0) {
+    Value = LShiftU64 (Value, 32) | fdt32_to_cpu (ReadUnaligned32 (Cells++));
+  }
+
+  return Value;
+}
+
+/**
+  Give [Base, Base + Length) new attributes and type, splitting the DRAM
+  regions it overlaps. Regions stay sorted and disjoint.
+
+  @param  Regions       DRAM regions.
+  @param  Count         Number of regions; updated.
+  @param  Base          Start of the carve-out.
+  @param  Length        Size of the carve-out.
+  @param  Attributes    Mapping of the carve-out.
+  @param  Type          Type of the carve-out.
+**/
+STATIC
+VOID
+RPi5DCarve (
+  IN OUT RPI5D_MEMORY_REGION           *Regions,
+  IN OUT UINTN                         *Count,
+  IN     UINT64                        Base,
+  IN     UINT64                        Length,
+  IN     ARM_MEMORY_REGION_ATTRIBUTES  Attributes,
+  IN     RPI5D_MEMORY_TYPE             Type
+  )
+{
+  RPI5D_MEMORY_REGION  Split[RPI5D_MEMORY_REGIONS_MAX];
+  UINTN                Index;
+  UINTN                Used;
+  UINT64               End;
+  UINT64               RegionEnd;
+
+  End  = Base + Length;
+  Used = 0;
+  for (Index = 0; Index < *Count; Index++) {
+    RegionEnd = Regions[Index].Base + Regions[Index].Length;
+    if ((End <= Regions[Index].Base) || (Base >= RegionEnd)) {
+      if (Used < RPI5D_MEMORY_REGIONS_MAX) {
+        Split[Used++] = Regions[Index];
+      }
+
+      continue;
+    }
+
+    if ((Regions[Index].Attributes == Attributes) && (Regions[Index].Type == Type)) {
+      Split[Used++] = Regions[Index];
+      continue;
+    }
+
+    if (Used + 3 > RPI5D_MEMORY_REGIONS_MAX) {
+      ASSERT (Used + 3 <= RPI5D_MEMORY_REGIONS_MAX);
+      if (Used < RPI5D_MEMORY_REGIONS_MAX) {
+        Split[Used++] = Regions[Index];
+      }
+
+      continue;
+    }
+
+    if (Regions[Index].Base < Base) {
+      Split[Used]        = Regions[Index];
+      Split[Used].Length = Base - Regions[Index].Base;
+      Used++;
+    }
+
+    Split[Used].Base       = MAX (Base, Regions[Index].Base);
+    Split[Used].Length     = MIN (End, RegionEnd) - Split[Used].Base;
+    Split[Used].Attributes = Attributes;
+    Split[Used].Type       = Type;
+    Used++;
+
+    if (RegionEnd > End) {
+      Split[Used]        = Regions[Index];
+      Split[Used].Base   = End;
+      Split[Used].Length = RegionEnd - End;
+      Used++;
+    }
+  }
+
+  CopyMem (Regions, Split, Used * sizeof (Split[0]));
+  *Count = Used;
+}
+
+/**
+  Lay out DRAM from the VideoCore memory split when there is no device
+  tree: the board revision gives the DRAM fitted, the ARM part of the low
+  gigabyte and everything above it are system memory, and the rest is
+  reserved for the VideoCore.
+
+  @param  Regions       DRAM regions; Regions[0] is replaced.
+  @param  Count         Number of regions; updated.
+  @param  Properties    VideoCore firmware properties.
+
+  @retval TRUE          DRAM laid out.
+  @retval FALSE         The properties do not describe DRAM.
+**/
+STATIC
+BOOLEAN
+RPi5DDramFromVideoCore (
+  IN OUT RPI5D_MEMORY_REGION         *Regions,
+  IN OUT UINTN                       *Count,
+  IN     CONST VIDEOCORE_PROPERTIES  *Properties
+  )
+{
+  UINT64  DramSize;
+  UINT64  Base;
+  UINT64  End;
+
+  if (((Properties->BoardRevision & VIDEOCORE_BOARD_NEW_STYLE) == 0) || (Properties->ArmMemorySize == 0)) {
+    return FALSE;
+  }
+
+  DramSize              = VIDEOCORE_BOARD_MEMORY_SIZE (Properties->BoardRevision);
+  Regions[0].Base       = RPI5D_SYSTEM_MEMORY_BASE;
+  Regions[0].Length     = ALIGN_VALUE (DramSize, SIZE_1GB);
+  Regions[0].Attributes = ARM_MEMORY_REGION_ATTRIBUTE_UNCACHED_UNBUFFERED;
+  Regions[0].Type       = RPI5D_MEM_RESERVED_REGION;
+  *Count                = 1;
+
+  Base = ALIGN_VALUE (Properties->ArmMemoryBase, RPI5D_CARVE_ALIGNMENT);
+  End  = (Properties->ArmMemoryBase + Properties->ArmMemorySize) & ~(UINT64)(RPI5D_CARVE_ALIGNMENT - 1);
+  if (End > Base) {
+    RPi5DCarve (Regions, Count, Base, End - Base, ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK, RPI5D_MEM_BASIC_REGION);
+  }
+
+  if (DramSize > SIZE_1GB) {
+    RPi5DCarve (Regions, Count, SIZE_1GB, DramSize - SIZE_1GB, ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK, RPI5D_MEM_BASIC_REGION);
+  }
+
+  return TRUE;
+}
+
+/**
+  Lay out DRAM from the firmware device tree.
+
+  The memory nodes list the DRAM given to the OS; the holes between them
+  belong to the firmware and the VideoCore and are reserved, mapped
+  uncached. Without a device tree the VideoCore memory split is used.
+  The framebuffer the VideoCore reported, the simple-framebuffer node or
+  the fixed RPI5D_FRAMEBUFFER_* default, in that order, is reserved and
+  mapped normal non-cacheable, which the core write-combines. The end of
+  DRAM is rounded up to a whole 1GB.
+
+  @param  Regions       DRAM regions, at most RPI5D_MEMORY_REGIONS_MAX.
+
+  @return Number of regions.
+**/
+STATIC
+UINTN
+RPi5DDramRegions (
+  OUT RPI5D_MEMORY_REGION  *Regions
+  )
+{
+  CONST VOID                  *Fdt;
+  CONST UINT32                *Reg;
+  INT32                       Node;
+  INT32                       AddressCells;
+  INT32                       SizeCells;
+  INT32                       Length;
+  UINTN                       Count;
+  UINT64                      Base;
+  UINT64                      Size;
+  UINT64                      End;
+  UINT64                      FramebufferBase;
+  UINT64                      FramebufferSize;
+  CONST VIDEOCORE_PROPERTIES  *Properties;
+  VOID                        *Hob;
+
+  Properties = NULL;
+  Hob        = GetFirstGuidHob (&mVideoCorePropertiesGuid);
+  if (Hob != NULL) {
+    Properties = GET_GUID_HOB_DATA (Hob);
+  }
+
+  Regions[0].Base       = RPI5D_SYSTEM_MEMORY_BASE;
+  Regions[0].Length     = RPI5D_SYSTEM_MEMORY_SIZE;
+  Regions[0].Attributes = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
+  Regions[0].Type       = RPI5D_MEM_BASIC_REGION;
+  Count                 = 1;
+
+  FramebufferBase = RPI5D_FRAMEBUFFER_BASE;
+  FramebufferSize = RPI5D_FRAMEBUFFER_SIZE;
+  if ((Properties != NULL) && (Properties->FramebufferSize != 0)) {
+    FramebufferBase = Properties->FramebufferBase;
+    FramebufferSize = Properties->FramebufferSize;
+  }
+
+  Fdt = (CONST VOID *)(UINTN)mRPi5DFdtBase;
+  if ((Fdt == NULL) || (fdt_check_header (Fdt) != 0)) {
+    goto NoDeviceTree;
+  }
+
+  AddressCells = fdt_address_cells (Fdt, 0);
+  SizeCells    = fdt_size_cells (Fdt, 0);
+  if ((AddressCells < 1) || (AddressCells > 2) || (SizeCells < 1) || (SizeCells > 2)) {
+    goto NoDeviceTree;
+  }
+
+  End = 0;
+  for (Node = fdt_node_offset_by_prop_value (Fdt, -1, "device_type", "memory", sizeof ("memory"));
+       Node >= 0;
+       Node = fdt_node_offset_by_prop_value (Fdt, Node, "device_type", "memory", sizeof ("memory")))
+  {
+    Reg = fdt_getprop (Fdt, Node, "reg", &Length);
+    if (Reg == NULL) {
+      continue;
+    }
+
+    for ( ; Length >= (AddressCells + SizeCells) * (INT32)sizeof (UINT32);
+         Length -= (AddressCells + SizeCells) * (INT32)sizeof (UINT32))
+    {
+      End  = MAX (End, RPi5DReadCells (Reg, AddressCells) + RPi5DReadCells (Reg + AddressCells, SizeCells));
+      Reg += AddressCells + SizeCells;
+    }
+  }
+
+  if (End <= RPI5D_SYSTEM_MEMORY_BASE) {
+    goto NoDeviceTree;
+  }
+
+  //
+  // Reserve all of DRAM, then hand back each range the firmware lists,
+  // shrunk to whole carve-out blocks.
+  //
+  Regions[0].Length     = ALIGN_VALUE (End, SIZE_1GB) - RPI5D_SYSTEM_MEMORY_BASE;
+  Regions[0].Attributes = ARM_MEMORY_REGION_ATTRIBUTE_UNCACHED_UNBUFFERED;
+  Regions[0].Type       = RPI5D_MEM_RESERVED_REGION;
+
+  for (Node = fdt_node_offset_by_prop_value (Fdt, -1, "device_type", "memory", sizeof ("memory"));
+       Node >= 0;
+       Node = fdt_node_offset_by_prop_value (Fdt, Node, "device_type", "memory", sizeof ("memory")))
+  {
+    Reg = fdt_getprop (Fdt, Node, "reg", &Length);
+    if (Reg == NULL) {
+      continue;
+    }
+
+    for ( ; Length >= (AddressCells + SizeCells) * (INT32)sizeof (UINT32);
+         Length -= (AddressCells + SizeCells) * (INT32)sizeof (UINT32))
+    {
+      Base = ALIGN_VALUE (RPi5DReadCells (Reg, AddressCells), RPI5D_CARVE_ALIGNMENT);
+      Size = RPi5DReadCells (Reg + AddressCells, SizeCells);
+      End  = (RPi5DReadCells (Reg, AddressCells) + Size) & ~(UINT64)(RPI5D_CARVE_ALIGNMENT - 1);
+      Reg += AddressCells + SizeCells;
+      if (End > Base) {
+        RPi5DCarve (Regions, &Count, Base, End - Base, ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK, RPI5D_MEM_BASIC_REGION);
+      }
+    }
+  }
+
+  Node = fdt_node_offset_by_compatible (Fdt, -1, "simple-framebuffer");
+  if ((Node >= 0) && ((Properties == NULL) || (Properties->FramebufferSize == 0))) {
+    AddressCells = fdt_address_cells (Fdt, fdt_parent_offset (Fdt, Node));
+    SizeCells    = fdt_size_cells (Fdt, fdt_parent_offset (Fdt, Node));
+    Reg          = fdt_getprop (Fdt, Node, "reg", &Length);
+    if ((Reg != NULL) && (AddressCells >= 1) && (AddressCells <= 2) && (SizeCells >= 1) && (SizeCells <= 2) &&
+        (Length >= (AddressCells + SizeCells) * (INT32)sizeof (UINT32)))
+    {
+      FramebufferBase = RPi5DReadCells (Reg, AddressCells);
+      FramebufferSize = RPi5DReadCells (Reg + AddressCells, SizeCells);
+    }
+  }
+
+  goto Framebuffer;
+
+NoDeviceTree:
+  if (Properties != NULL) {
+    RPi5DDramFromVideoCore (Regions, &Count, Properties);
+  }
+
+Framebuffer:
+  Base = FramebufferBase & ~(UINT64)(RPI5D_CARVE_ALIGNMENT - 1);
+  End  = ALIGN_VALUE (FramebufferBase + FramebufferSize, RPI5D_CARVE_ALIGNMENT);
+  RPi5DCarve (Regions, &Count, Base, End - Base, ARM_MEMORY_REGION_ATTRIBUTE_UNCACHED_UNBUFFERED, RPI5D_MEM_RESERVED_REGION);
+
+  return Count;
+}
 
 /**
   Return the Virtual Memory Map of your platform
 
   This Virtual Memory Map is used by MemoryInitPei Module to initialize the MMU on your platform.
 
+  DRAM is write-back apart from the reserved carve-outs found by
+  RPi5DDramRegions; mRPi5DMemoryTypes gives the type of each entry. Every
+  region starts and ends on a 2MB boundary, and the device windows on a
+  1GB one, so the page tables are built from block descriptors alone.
+
   @param[out]   VirtualMemoryMap    Array of ARM_MEMORY_REGION_DESCRIPTOR describing a Physical-to-
                                     Virtual Memory mapping. This array must be ended by a zero-filled
                                     entry
@@ -28,40 +377,51 @@ ArmPlatformGetVirtualMemoryMap (
   )
 {
   ARM_MEMORY_REGION_DESCRIPTOR  *Descriptor;
+  RPI5D_MEMORY_REGION           Regions[RPI5D_MEMORY_REGIONS_MAX];
+  UINTN                         Count;
+  UINTN                         Index;
 
-  Descriptor = (ARM_MEMORY_REGION_DESCRIPTOR *)AllocatePool (
-                 sizeof (ARM_MEMORY_REGION_DESCRIPTOR) * 4
+  Descriptor = (ARM_MEMORY_REGION_DESCRIPTOR *)AllocateZeroPool (
+                 sizeof (ARM_MEMORY_REGION_DESCRIPTOR) * RPI5D_MEMORY_REGIONS_MAX
                  );
 
   if (Descriptor == NULL) {
     return;
   }
 
-  // System DRAM
-  Descriptor[0].PhysicalBase = RPI5D_SYSTEM_MEMORY_BASE;
-  Descriptor[0].VirtualBase  = RPI5D_SYSTEM_MEMORY_BASE;
-  Descriptor[0].Length       = RPI5D_SYSTEM_MEMORY_SIZE;
-  Descriptor[0].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
+  Count = RPi5DDramRegions (Regions);
+  ASSERT (Count + ARRAY_SIZE (mRPi5DDeviceRegions) < RPI5D_MEMORY_REGIONS_MAX);
+  CopyMem (&Regions[Count], mRPi5DDeviceRegions, sizeof (mRPi5DDeviceRegions));
+  Count += ARRAY_SIZE (mRPi5DDeviceRegions);
 
-  // Peripheral MMIO
-  Descriptor[1].PhysicalBase = RPI5D_PERIPHERAL_BASE;
-  Descriptor[1].VirtualBase  = RPI5D_PERIPHERAL_BASE;
-  Descriptor[1].Length       = 0x01000000;
-  Descriptor[1].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_DEVICE;
+  for (Index = 0; Index < Count; Index++) {
+    Descriptor[Index].PhysicalBase = Regions[Index].Base;
+    Descriptor[Index].VirtualBase  = Regions[Index].Base;
+    Descriptor[Index].Length       = Regions[Index].Length;
+    Descriptor[Index].Attributes   = Regions[Index].Attributes;
+    mRPi5DMemoryTypes[Index]       = Regions[Index].Type;
 
-  // End of Table
-  Descriptor[2].PhysicalBase = 0;
-  Descriptor[2].VirtualBase  = 0;
-  Descriptor[2].Length       = 0;
-  Descriptor[2].Attributes   = 0;
+    DEBUG ((
+      DEBUG_INFO,
+      "RPi5D: Map 0x%011lx-0x%011lx attributes %d type %d\n",
+      Regions[Index].Base,
+      Regions[Index].Base + Regions[Index].Length - 1,
+      Regions[Index].Attributes,
+      Regions[Index].Type
+      ));
+  }
+
+  // End of Table, already zero
 
   *VirtualMemoryMap = Descriptor;
 }
 
 /**
-  Return the current Boot Mode
+  Check if this core is the primary core
+
+  @param[in]   MpId             Processor ID
 
-  @return   Boot mode
+  @return      TRUE if it's the primary core
 
 **/
 BOOLEAN
@@ -69,7 +429,7 @@ ArmPlatformIsPrimaryCore (
   IN UINTN  MpId
   )
 {
-  return TRUE;
+  return (BOOLEAN)((MpId & FixedPcdGet32 (PcdArmPrimaryCoreMask)) == FixedPcdGet32 (PcdArmPrimaryCore));
 }
 
 /**
@@ -93,7 +453,7 @@ ArmPlatformInitialize (
 
   @param[in]   MpId             Processor ID
 
-  @return      Core position
+  @return      Core position, 0 to RPI5D_CORE_COUNT - 1
 
 **/
 UINTN
@@ -101,16 +461,10 @@ ArmPlatformGetCorePosition (
   IN UINTN  MpId
   )
 {
-  return 1;
+  return RPI5D_CORE_POSITION (MpId);
 }
 
 /**
-  Check if this core is the primary core
-
-  @param[in]   MpId             Processor ID
-
-  @return      TRUE if it's the primary core
-
   Get the primary core stack base address
 
   @param[in]   MpId             Processor ID
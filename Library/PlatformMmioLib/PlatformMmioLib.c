@@ -0,0 +1,203 @@
+/** @file
+  Register access of RPi5D drivers with few barriers.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/BaseLib.h>
+#include <Library/TimerLib.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+
+#ifdef PLATFORM_MMIO_TRACE
+
+//
+// Entries in the trace ring; a power of two.
+//
+#define PLATFORM_MMIO_TRACE_SIZE  4096
+
+STATIC PLATFORM_MMIO_TRACE_ENTRY  mTrace[PLATFORM_MMIO_TRACE_SIZE];
+STATIC UINT64                     mTraceTotal;
+
+/**
+  Log one access.
+
+  @param  Address       Register address.
+  @param  Value         Value read or written.
+  @param  Access        PLATFORM_MMIO_TRACE_READ/WRITE | width in bytes.
+**/
+STATIC
+VOID
+PlatformMmioLog (
+  IN UINTN   Address,
+  IN UINT64  Value,
+  IN UINT8   Access
+  )
+{
+  PLATFORM_MMIO_TRACE_ENTRY  *Entry;
+
+  Entry            = &mTrace[mTraceTotal++ & (PLATFORM_MMIO_TRACE_SIZE - 1)];
+  Entry->Timestamp = GetPerformanceCounter ();
+  Entry->Address   = Address;
+  Entry->Value     = Value;
+  Entry->Access    = Access;
+}
+
+#define MMIO_LOG(Address, Value, Access)  PlatformMmioLog ((Address), (Value), (Access))
+
+#else
+
+#define MMIO_LOG(Address, Value, Access)
+
+#endif
+
+#define MMIO32(Address)  (*(volatile UINT32 *)(Address))
+#define MMIO64(Address)  (*(volatile UINT64 *)(Address))
+
+UINT32
+EFIAPI
+PlatformMmioRead32 (
+  IN UINTN  Address
+  )
+{
+  UINT32  Value;
+
+  Value = MMIO32 (Address);
+  MemoryFence ();
+  MMIO_LOG (Address, Value, PLATFORM_MMIO_TRACE_READ | 4);
+  return Value;
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  MMIO_LOG (Address, Value, PLATFORM_MMIO_TRACE_WRITE | 4);
+  MemoryFence ();
+  MMIO32 (Address) = Value;
+}
+
+UINT64
+EFIAPI
+PlatformMmioRead64 (
+  IN UINTN  Address
+  )
+{
+  UINT64  Value;
+
+  Value = MMIO64 (Address);
+  MemoryFence ();
+  MMIO_LOG (Address, Value, PLATFORM_MMIO_TRACE_READ | 8);
+  return Value;
+}
+
+VOID
+EFIAPI
+PlatformMmioWrite64 (
+  IN UINTN   Address,
+  IN UINT64  Value
+  )
+{
+  MMIO_LOG (Address, Value, PLATFORM_MMIO_TRACE_WRITE | 8);
+  MemoryFence ();
+  MMIO64 (Address) = Value;
+}
+
+VOID
+EFIAPI
+PlatformMmioReadBlock32 (
+  IN  UINTN   Address,
+  IN  UINTN   Count,
+  OUT UINT32  *Buffer
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    Buffer[Index] = MMIO32 (Address + Index * sizeof (UINT32));
+  }
+
+  MemoryFence ();
+
+  for (Index = 0; Index < Count; Index++) {
+    MMIO_LOG (Address + Index * sizeof (UINT32), Buffer[Index], PLATFORM_MMIO_TRACE_READ | 4);
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioWriteBlock32 (
+  IN UINTN         Address,
+  IN UINTN         Count,
+  IN CONST UINT32  *Buffer
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    MMIO_LOG (Address + Index * sizeof (UINT32), Buffer[Index], PLATFORM_MMIO_TRACE_WRITE | 4);
+  }
+
+  MemoryFence ();
+
+  for (Index = 0; Index < Count; Index++) {
+    MMIO32 (Address + Index * sizeof (UINT32)) = Buffer[Index];
+  }
+}
+
+VOID
+EFIAPI
+PlatformMmioUpdate32 (
+  IN CONST PLATFORM_MMIO_UPDATE  *Updates,
+  IN UINTN                       Count
+  )
+{
+  UINTN   Index;
+  UINT32  Value;
+
+  for (Index = 0; Index < Count; Index++) {
+    Value = 0;
+    if (Updates[Index].AndMask != 0) {
+      Value = MMIO32 (Updates[Index].Address);
+      MMIO_LOG (Updates[Index].Address, Value, PLATFORM_MMIO_TRACE_READ | 4);
+    }
+
+    Value = (Value & Updates[Index].AndMask) | Updates[Index].OrMask;
+    MMIO_LOG (Updates[Index].Address, Value, PLATFORM_MMIO_TRACE_WRITE | 4);
+    MMIO32 (Updates[Index].Address) = Value;
+  }
+
+  MemoryFence ();
+}
+
+VOID
+EFIAPI
+PlatformMmioBarrier (
+  VOID
+  )
+{
+  MemoryFence ();
+}
+
+UINT64
+EFIAPI
+PlatformMmioTrace (
+  OUT CONST PLATFORM_MMIO_TRACE_ENTRY  **Entries,
+  OUT UINTN                            *Size
+  )
+{
+#ifdef PLATFORM_MMIO_TRACE
+  *Entries = mTrace;
+  *Size    = PLATFORM_MMIO_TRACE_SIZE;
+  return mTraceTotal;
+#else
+  *Entries = NULL;
+  *Size    = 0;
+  return 0;
+#endif
+}
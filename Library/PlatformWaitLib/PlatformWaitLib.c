@@ -0,0 +1,388 @@
+/** @file
+  Bounded waits on hardware conditions.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/IoLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include "../../Include/Library/PlatformWaitLib.h"
+
+/**
+  Time elapsed since a performance counter value.
+
+  @param  Start         Performance counter value at the start.
+
+  @return Microseconds elapsed.
+**/
+STATIC
+UINT64
+WaitElapsed (
+  IN UINT64  Start
+  )
+{
+  UINT64  Now;
+  UINT64  StartValue;
+  UINT64  EndValue;
+  UINT64  Ticks;
+
+  Now = GetPerformanceCounter ();
+  GetPerformanceCounterProperties (&StartValue, &EndValue);
+  if (EndValue >= StartValue) {
+    Ticks = Now - Start;
+  } else {
+    Ticks = Start - Now;
+  }
+
+  return DivU64x32 (GetTimeInNanoSecond (Ticks), 1000);
+}
+
+/**
+  Condition of the MMIO waits: the masked register bits equal Value.
+
+  @param  Context       PLATFORM_WAIT holding the register and bits.
+**/
+STATIC
+BOOLEAN
+EFIAPI
+WaitMmio32Condition (
+  IN VOID  *Context
+  )
+{
+  PLATFORM_WAIT  *Wait;
+
+  Wait = Context;
+  return (BOOLEAN)((MmioRead32 (Wait->Address) & Wait->Mask) == Wait->Value);
+}
+
+/**
+  Poll a condition against a deadline, doubling the interval between
+  polls from MinInterval up to MaxInterval.
+
+  @param  Condition     Condition to poll.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds.
+  @param  MinInterval   First poll interval in microseconds.
+  @param  MaxInterval   Longest poll interval in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+STATIC
+EFI_STATUS
+WaitCondition (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  UINT64                   MinInterval,
+  IN  UINT64                   MaxInterval,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Start;
+  UINT64      Waited;
+  UINT64      Interval;
+
+  Start    = GetPerformanceCounter ();
+  Interval = MinInterval;
+
+  //
+  // The condition is tested once more after the last delay, so a wait
+  // never times out on a condition met just before its deadline.
+  //
+  for ( ; ; ) {
+    if (Condition (Context)) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+
+    Waited = WaitElapsed (Start);
+    if (Waited >= Timeout) {
+      Status = EFI_TIMEOUT;
+      break;
+    }
+
+    MicroSecondDelay ((UINTN)MIN (Interval, Timeout - Waited));
+    Interval = MIN (Interval * 2, MaxInterval);
+  }
+
+  if (Elapsed != NULL) {
+    *Elapsed = WaitElapsed (Start);
+  }
+
+  return Status;
+}
+
+/**
+  Wait for a condition to be met.
+
+  @param  Condition     Condition to poll.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitCondition (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  return WaitCondition (
+           Condition,
+           Context,
+           Timeout,
+           PLATFORM_WAIT_MIN_INTERVAL,
+           PLATFORM_WAIT_MAX_INTERVAL,
+           Elapsed
+           );
+}
+
+/**
+  Wait for a condition to be met, polling it at a fixed interval.
+
+  @param  Condition     Condition to poll.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds, MAX_UINT64 to wait forever.
+  @param  Interval      Poll interval in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitConditionInterval (
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  UINT64                   Interval,
+  OUT UINT64                   *Elapsed OPTIONAL
+  )
+{
+  return WaitCondition (Condition, Context, Timeout, Interval, Interval, Elapsed);
+}
+
+/**
+  Wait for the masked bits of a 32-bit MMIO register to equal Value.
+
+  @param  Address       Register address.
+  @param  Mask          Bits to test.
+  @param  Value         Expected value of the masked bits.
+  @param  Timeout       Timeout in microseconds.
+  @param  Elapsed       Time waited in microseconds.
+
+  @retval EFI_SUCCESS   Condition met.
+  @retval EFI_TIMEOUT   Condition not met before the timeout.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitMmio32 (
+  IN  UINTN   Address,
+  IN  UINT32  Mask,
+  IN  UINT32  Value,
+  IN  UINT64  Timeout,
+  OUT UINT64  *Elapsed OPTIONAL
+  )
+{
+  PLATFORM_WAIT  Wait;
+
+  Wait.Address = Address;
+  Wait.Mask    = Mask;
+  Wait.Value   = Value;
+
+  return PlatformWaitCondition (WaitMmio32Condition, &Wait, Timeout, Elapsed);
+}
+
+/**
+  End a background wait and tell its owner.
+
+  @param  Wait          Wait state.
+  @param  Status        Outcome of the wait.
+**/
+STATIC
+VOID
+WaitComplete (
+  IN OUT PLATFORM_WAIT  *Wait,
+  IN     EFI_STATUS     Status
+  )
+{
+  if (Wait->Timer != NULL) {
+    gBS->CloseEvent (Wait->Timer);
+    Wait->Timer = NULL;
+  }
+
+  Wait->Elapsed = WaitElapsed (Wait->Start);
+  Wait->Status  = Status;
+  if (Wait->Event != NULL) {
+    gBS->SignalEvent (Wait->Event);
+  }
+}
+
+/**
+  Timer handler of a background wait. The next poll is scheduled twice as
+  far out as the last one, up to PLATFORM_WAIT_ASYNC_MAX_INTERVAL.
+
+  @param  Event         Timer event.
+  @param  Context       Wait state.
+**/
+STATIC
+VOID
+EFIAPI
+WaitPoll (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  PLATFORM_WAIT  *Wait;
+  UINT64         Waited;
+
+  Wait = Context;
+
+  if (Wait->Condition (Wait->Context)) {
+    WaitComplete (Wait, EFI_SUCCESS);
+    return;
+  }
+
+  Waited = WaitElapsed (Wait->Start);
+  if (Waited >= Wait->Timeout) {
+    WaitComplete (Wait, EFI_TIMEOUT);
+    return;
+  }
+
+  Wait->Interval = MIN (Wait->Interval * 2, PLATFORM_WAIT_ASYNC_MAX_INTERVAL);
+  gBS->SetTimer (
+         Wait->Timer,
+         TimerRelative,
+         EFI_TIMER_PERIOD_MICROSECONDS (MIN (Wait->Interval, Wait->Timeout - Waited))
+         );
+}
+
+/**
+  Start waiting for a condition in the background. Wait->Status reads
+  EFI_NOT_READY until the condition is met (EFI_SUCCESS) or the timeout
+  expires (EFI_TIMEOUT); Event is signalled at that point.
+
+  @param  Wait          Wait state, kept valid until the wait is over.
+  @param  Condition     Condition to poll, called at TPL_CALLBACK.
+  @param  Context       Passed to Condition.
+  @param  Timeout       Timeout in microseconds.
+  @param  Event         Event to signal when the wait is over, or NULL.
+
+  @retval EFI_SUCCESS   Wait started, or already over.
+  @retval others        Timer event could not be created.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitConditionAsync (
+  OUT PLATFORM_WAIT            *Wait,
+  IN  PLATFORM_WAIT_CONDITION  Condition,
+  IN  VOID                     *Context,
+  IN  UINT64                   Timeout,
+  IN  EFI_EVENT                Event OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+
+  Wait->Condition = Condition;
+  Wait->Context   = Context;
+  Wait->Start     = GetPerformanceCounter ();
+  Wait->Timeout   = Timeout;
+  Wait->Interval  = PLATFORM_WAIT_ASYNC_MIN_INTERVAL;
+  Wait->Timer     = NULL;
+  Wait->Event     = Event;
+  Wait->Status    = EFI_NOT_READY;
+  Wait->Elapsed   = 0;
+
+  if (Condition (Context)) {
+    WaitComplete (Wait, EFI_SUCCESS);
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK, WaitPoll, Wait, &Wait->Timer);
+  if (EFI_ERROR (Status)) {
+    Wait->Timer = NULL;
+    return Status;
+  }
+
+  Status = gBS->SetTimer (
+                  Wait->Timer,
+                  TimerRelative,
+                  EFI_TIMER_PERIOD_MICROSECONDS (MIN (Wait->Interval, Timeout))
+                  );
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (Wait->Timer);
+    Wait->Timer = NULL;
+  }
+
+  return Status;
+}
+
+/**
+  Start waiting in the background for the masked bits of a 32-bit MMIO
+  register to equal Value. See PlatformWaitConditionAsync().
+
+  @param  Wait          Wait state, kept valid until the wait is over.
+  @param  Address       Register address.
+  @param  Mask          Bits to test.
+  @param  Value         Expected value of the masked bits.
+  @param  Timeout       Timeout in microseconds.
+  @param  Event         Event to signal when the wait is over, or NULL.
+
+  @retval EFI_SUCCESS   Wait started, or already over.
+  @retval others        Timer event could not be created.
+**/
+EFI_STATUS
+EFIAPI
+PlatformWaitMmio32Async (
+  OUT PLATFORM_WAIT  *Wait,
+  IN  UINTN          Address,
+  IN  UINT32         Mask,
+  IN  UINT32         Value,
+  IN  UINT64         Timeout,
+  IN  EFI_EVENT      Event OPTIONAL
+  )
+{
+  Wait->Address = Address;
+  Wait->Mask    = Mask;
+  Wait->Value   = Value;
+
+  return PlatformWaitConditionAsync (Wait, WaitMmio32Condition, Wait, Timeout, Event);
+}
+
+/**
+  Stop a background wait that is still running. Its event is not
+  signalled.
+
+  @param  Wait          Wait state.
+**/
+VOID
+EFIAPI
+PlatformWaitCancel (
+  IN OUT PLATFORM_WAIT  *Wait
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (Wait->Timer != NULL) {
+    gBS->CloseEvent (Wait->Timer);
+    Wait->Timer   = NULL;
+    Wait->Elapsed = WaitElapsed (Wait->Start);
+    Wait->Status  = EFI_ABORTED;
+  }
+  gBS->RestoreTPL (OldTpl);
+}
@@ -0,0 +1,487 @@
+/** @file
+  DebugLib that appends DEBUG output to a RAM ring.
+
+  Messages are formatted as BaseDebugLibSerialPort formats them, stamped
+  with the generic timer at the start of each line, and copied into the
+  DEBUG_LOG_RING shared by every driver through a configuration table.
+  Each append only pushes what the PL011 FIFO takes without waiting;
+  DebugLogDxe drains the rest from a timer and at ExitBootServices. The
+  caller waits on the UART only when the ring is full.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugPrintErrorLevelLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include "../../Include/Guid/DebugLogRing.h"
+#include "../../Include/Library/PlatformDebugLogLib.h"
+#include "../../Include/Library/PlatformSerialPortLib.h"
+
+//
+// Define the maximum debug and assert message length that this library supports
+//
+#define MAX_DEBUG_MESSAGE_LENGTH  0x100
+
+//
+// "[sssss.uuuuuu] " in front of each line
+//
+#define DEBUG_LOG_STAMP_LENGTH  32
+
+//
+// VA_LIST can not initialize to NULL for all compiler, so we use this to
+// indicate a null VA_LIST
+//
+VA_LIST  mVaListNull;
+
+STATIC EFI_GUID        mDebugLogRingGuid = RPI5D_DEBUG_LOG_RING_GUID;
+STATIC DEBUG_LOG_RING  *mRing;
+
+/**
+  Write ring text to the UART. The caller holds TPL_HIGH_LEVEL.
+
+  @param  Blocking      Wait for the UART instead of stopping at a full FIFO.
+  @param  Limit         Most bytes to write.
+
+  @return Number of bytes written.
+**/
+STATIC
+UINTN
+DebugLogWriteOut (
+  IN BOOLEAN  Blocking,
+  IN UINT64   Limit
+  )
+{
+  UINTN  Offset;
+  UINTN  Chunk;
+  UINTN  Written;
+  UINTN  Total;
+
+  Total = 0;
+  while ((mRing->Tail < mRing->Head) && (Total < Limit)) {
+    Offset = (UINTN)(mRing->Tail & (mRing->Size - 1));
+    Chunk  = (UINTN)MIN (mRing->Head - mRing->Tail, mRing->Size - Offset);
+    Chunk  = (UINTN)MIN (Chunk, Limit - Total);
+    if (Blocking) {
+      Written = SerialPortWrite (&mRing->Data[Offset], Chunk);
+    } else {
+      Written = SerialPortWriteNonBlocking (&mRing->Data[Offset], Chunk);
+    }
+
+    mRing->Tail += Written;
+    Total       += Written;
+    if (Written < Chunk) {
+      break;
+    }
+  }
+
+  return Total;
+}
+
+/**
+  Copy text into the ring, first writing out as much older text as it
+  takes to make room. The caller holds TPL_HIGH_LEVEL.
+
+  @param  Text          Text to append.
+  @param  Length        Bytes of Text, at most the ring size.
+**/
+STATIC
+VOID
+DebugLogAppend (
+  IN CONST CHAR8  *Text,
+  IN UINTN        Length
+  )
+{
+  UINTN  Offset;
+  UINTN  Chunk;
+
+  if (mRing->Head + Length - mRing->Tail > mRing->Size) {
+    DebugLogWriteOut (TRUE, mRing->Head + Length - mRing->Tail - mRing->Size);
+  }
+
+  while (Length > 0) {
+    Offset = (UINTN)(mRing->Head & (mRing->Size - 1));
+    Chunk  = MIN (Length, mRing->Size - Offset);
+    CopyMem (&mRing->Data[Offset], Text, Chunk);
+    mRing->Head += Chunk;
+    Text        += Chunk;
+    Length      -= Chunk;
+  }
+}
+
+/**
+  Log a formatted message.
+
+  @param  Message       Null-terminated message.
+**/
+STATIC
+VOID
+DebugLogWrite (
+  IN CONST CHAR8  *Message
+  )
+{
+  CHAR8    Stamp[DEBUG_LOG_STAMP_LENGTH];
+  UINTN    Length;
+  UINT64   Seconds;
+  UINT32   Microseconds;
+  EFI_TPL  OldTpl;
+
+  Length = AsciiStrLen (Message);
+  if (mRing == NULL) {
+    SerialPortWrite ((UINT8 *)Message, Length);
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  if (mRing->LineStart) {
+    Seconds = DivU64x32Remainder (
+                DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()), 1000),
+                1000000,
+                &Microseconds
+                );
+    DebugLogAppend (Stamp, AsciiSPrint (Stamp, sizeof (Stamp), "[%5Lu.%06u] ", Seconds, Microseconds));
+  }
+
+  DebugLogAppend (Message, Length);
+  if (Length > 0) {
+    mRing->LineStart = (BOOLEAN)(Message[Length - 1] == '\n');
+  }
+
+  DebugLogWriteOut (mRing->Synchronous, MAX_UINT64);
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Write pending ring text to the console UART.
+
+  @param  Blocking      TRUE to wait until everything is written; FALSE to
+                        write only what the transmit FIFO accepts now.
+
+  @return Number of bytes written.
+**/
+UINTN
+EFIAPI
+DebugLogDrain (
+  IN BOOLEAN  Blocking
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Written;
+
+  if (mRing == NULL) {
+    return 0;
+  }
+
+  OldTpl  = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  Written = DebugLogWriteOut (Blocking, MAX_UINT64);
+  gBS->RestoreTPL (OldTpl);
+
+  return Written;
+}
+
+/**
+  Drain the ring and write every later DEBUG message straight through,
+  for ExitBootServices when no timer will drain it again.
+**/
+VOID
+EFIAPI
+DebugLogSynchronous (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if (mRing == NULL) {
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  DebugLogWriteOut (TRUE, MAX_UINT64);
+  mRing->Synchronous = TRUE;
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Attach to the platform log ring, creating and publishing it when this
+  is the first driver to log.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   Always; without a ring messages go to the UART.
+**/
+RETURN_STATUS
+EFIAPI
+RamDebugLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS      Status;
+  DEBUG_LOG_RING  *Ring;
+  UINTN           Pages;
+
+  SerialPortInitialize ();
+
+  Status = EfiGetSystemConfigurationTable (&mDebugLogRingGuid, (VOID **)&Ring);
+  if (!EFI_ERROR (Status) && (Ring->Signature == DEBUG_LOG_RING_SIGNATURE)) {
+    mRing = Ring;
+    return EFI_SUCCESS;
+  }
+
+  Pages = EFI_SIZE_TO_PAGES (sizeof (*Ring) + DEBUG_LOG_RING_SIZE);
+  Ring  = AllocateRuntimePages (Pages);
+  if (Ring == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  ZeroMem (Ring, sizeof (*Ring));
+  Ring->Signature = DEBUG_LOG_RING_SIGNATURE;
+  Ring->Size      = DEBUG_LOG_RING_SIZE;
+  Ring->LineStart = TRUE;
+
+  Status = gBS->InstallConfigurationTable (&mDebugLogRingGuid, Ring);
+  if (EFI_ERROR (Status)) {
+    FreePages (Ring, Pages);
+    return EFI_SUCCESS;
+  }
+
+  mRing = Ring;
+  return EFI_SUCCESS;
+}
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled, formatting with either a VA_LIST or a BASE_LIST.
+
+  @param  ErrorLevel      The error level of the debug message.
+  @param  Format          Format string for the debug message to print.
+  @param  VaListMarker    VA_LIST marker for the variable argument list.
+  @param  BaseListMarker  BASE_LIST marker for the variable argument list.
+**/
+STATIC
+VOID
+DebugPrintMarker (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  IN  VA_LIST      VaListMarker,
+  IN  BASE_LIST    BaseListMarker
+  )
+{
+  CHAR8  Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+
+  ASSERT (Format != NULL);
+
+  if ((ErrorLevel & GetDebugPrintErrorLevel ()) == 0) {
+    return;
+  }
+
+  if (BaseListMarker == NULL) {
+    AsciiVSPrint (Buffer, sizeof (Buffer), Format, VaListMarker);
+  } else {
+    AsciiBSPrint (Buffer, sizeof (Buffer), Format, BaseListMarker);
+  }
+
+  DebugLogWrite (Buffer);
+}
+
+/**
+  Prints a debug message to the debug output device if the specified error level is enabled.
+
+  @param  ErrorLevel  The error level of the debug message.
+  @param  Format      Format string for the debug message to print.
+  @param  ...         Variable argument list whose contents are accessed
+                      based on the format string specified by Format.
+**/
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+  VA_LIST  Marker;
+
+  VA_START (Marker, Format);
+  DebugVPrint (ErrorLevel, Format, Marker);
+  VA_END (Marker);
+}
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled.
+
+  @param  ErrorLevel    The error level of the debug message.
+  @param  Format        Format string for the debug message to print.
+  @param  VaListMarker  VA_LIST marker for the variable argument list.
+**/
+VOID
+EFIAPI
+DebugVPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  IN  VA_LIST      VaListMarker
+  )
+{
+  DebugPrintMarker (ErrorLevel, Format, VaListMarker, NULL);
+}
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled.
+
+  @param  ErrorLevel      The error level of the debug message.
+  @param  Format          Format string for the debug message to print.
+  @param  BaseListMarker  BASE_LIST marker for the variable argument list.
+**/
+VOID
+EFIAPI
+DebugBPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  IN  BASE_LIST    BaseListMarker
+  )
+{
+  DebugPrintMarker (ErrorLevel, Format, mVaListNull, BaseListMarker);
+}
+
+/**
+  Prints an assert message containing a filename, line number, and description.
+  This may be followed by a breakpoint or a dead loop.
+
+  Everything still in the ring is written out first, so the assert is the
+  last thing on the UART.
+
+  @param  FileName     The pointer to the name of the source file that generated the assert condition.
+  @param  LineNumber   The line number in the source file that generated the assert condition
+  @param  Description  The pointer to the description of the assert condition.
+**/
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  CHAR8  Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+
+  AsciiSPrint (Buffer, sizeof (Buffer), "ASSERT [%a] %a(%Lu): %a\n", gEfiCallerBaseName, FileName, (UINT64)LineNumber, Description);
+  DebugLogWrite (Buffer);
+  DebugLogDrain (TRUE);
+
+  if ((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_ASSERT_BREAKPOINT_ENABLED) != 0) {
+    CpuBreakpoint ();
+  } else if ((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_ASSERT_DEADLOOP_ENABLED) != 0) {
+    CpuDeadLoop ();
+  }
+}
+
+/**
+  Fills a target buffer with PcdDebugClearMemoryValue, and returns the target buffer.
+
+  @param   Buffer  The pointer to the target buffer to be filled with PcdDebugClearMemoryValue.
+  @param   Length  The number of bytes in Buffer to fill with zeros PcdDebugClearMemoryValue.
+
+  @return  Buffer  The pointer to the target buffer filled with PcdDebugClearMemoryValue.
+**/
+VOID *
+EFIAPI
+DebugClearMemory (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  ASSERT (Buffer != NULL);
+
+  return SetMem (Buffer, Length, PcdGet8 (PcdDebugClearMemoryValue));
+}
+
+/**
+  Returns TRUE if ASSERT() macros are enabled.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED bit of PcdDebugProperyMask is clear.
+**/
+BOOLEAN
+EFIAPI
+DebugAssertEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN)((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED) != 0);
+}
+
+/**
+  Returns TRUE if DEBUG() macros are enabled.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_PRINT_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_PRINT_ENABLED bit of PcdDebugProperyMask is clear.
+**/
+BOOLEAN
+EFIAPI
+DebugPrintEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN)((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_PRINT_ENABLED) != 0);
+}
+
+/**
+  Returns TRUE if DEBUG_CODE() macros are enabled.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_CODE_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_CODE_ENABLED bit of PcdDebugProperyMask is clear.
+**/
+BOOLEAN
+EFIAPI
+DebugCodeEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN)((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_CODE_ENABLED) != 0);
+}
+
+/**
+  Returns TRUE if DEBUG_CLEAR_MEMORY() macro is enabled.
+
+  @retval  TRUE    The DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED bit of PcdDebugProperyMask is clear.
+**/
+BOOLEAN
+EFIAPI
+DebugClearMemoryEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN)((PcdGet8 (PcdDebugPropertyMask) & DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED) != 0);
+}
+
+/**
+  Returns TRUE if any one of the bit is set both in ErrorLevel and PcdFixedDebugPrintErrorLevel.
+
+  @param  ErrorLevel  The error level of the debug message.
+
+  @retval  TRUE    Current ErrorLevel is supported.
+  @retval  FALSE   Current ErrorLevel is not supported.
+**/
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN  ErrorLevel
+  )
+{
+  return (BOOLEAN)((ErrorLevel & PcdGet32 (PcdFixedDebugPrintErrorLevel)) != 0);
+}
@@ -0,0 +1,251 @@
+/** @file
+  Interrupt driven receive path of the RPi5D console UART.
+
+  Once the GIC driver publishes the hardware interrupt protocol, the
+  receive and receive timeout interrupts empty the PL011 FIFO into a
+  software ring, so input keeps arriving while nobody is reading.
+  SerialPortRead copies whole runs out of the ring. Until then, and
+  whenever it is asked, the FIFO is also emptied from the caller.
+
+  Only the module that reads the console links this instance (SerialDxe
+  in RPi5D.dsc); the interrupt has a single owner.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/IoLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/HardwareInterrupt.h>
+#include "../../Include/Library/PlatformSerialPortLib.h"
+#include "../../Include/Platform/RPi5D.h"
+#include "Pl011Uart.h"
+
+//
+// Over 20 ms of input at 3 Mbaud; a power of two.
+//
+#define SERIAL_RX_RING_SIZE  SIZE_8KB
+
+STATIC UINT8                             mRxRing[SERIAL_RX_RING_SIZE];
+STATIC UINT32                            mRxHead;
+STATIC UINT32                            mRxTail;
+STATIC EFI_HARDWARE_INTERRUPT_PROTOCOL   *mInterrupt;
+STATIC VOID                              *mInterruptRegistration;
+STATIC EFI_EVENT                         mExitBootServicesEvent;
+
+/**
+  Move bytes from the receive FIFO into the ring. When the ring is full
+  the receive interrupts are masked, leaving the rest in the FIFO, until
+  a read makes room. The caller holds TPL_HIGH_LEVEL.
+**/
+STATIC
+VOID
+SerialPortRxFill (
+  VOID
+  )
+{
+  while ((MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_RXFE) == 0) {
+    if (mRxHead - mRxTail == SERIAL_RX_RING_SIZE) {
+      MmioAnd32 (RPI5D_UART_BASE + UART_IMSC, ~(UINT32)(INT_RX | INT_RT));
+      return;
+    }
+
+    mRxRing[mRxHead++ & (SERIAL_RX_RING_SIZE - 1)] =
+      (UINT8)(MmioRead32 (RPI5D_UART_BASE + UART_DR) & DR_DATA);
+  }
+}
+
+/**
+  Receive interrupt handler.
+
+  @param  Source        Interrupt source of the UART.
+  @param  SystemContext Not used.
+**/
+STATIC
+VOID
+EFIAPI
+SerialPortRxInterrupt (
+  IN HARDWARE_INTERRUPT_SOURCE  Source,
+  IN EFI_SYSTEM_CONTEXT         SystemContext
+  )
+{
+  SerialPortRxFill ();
+  mInterrupt->EndOfInterrupt (mInterrupt, Source);
+}
+
+/**
+  Give the UART interrupt back before the OS takes the GIC.
+
+  @param  Event         ExitBootServices event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+SerialPortRxExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  MmioAnd32 (RPI5D_UART_BASE + UART_IMSC, ~(UINT32)(INT_RX | INT_RT));
+  mInterrupt->DisableInterruptSource (mInterrupt, RPI5D_UART_INTERRUPT);
+  mInterrupt->RegisterInterruptSource (mInterrupt, RPI5D_UART_INTERRUPT, NULL);
+  mInterrupt = NULL;
+}
+
+/**
+  Switch to interrupt driven receive when the GIC driver arrives.
+
+  @param  Event         Protocol notification event.
+  @param  Context       Not used.
+**/
+STATIC
+VOID
+EFIAPI
+SerialPortRxInterruptReady (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_HARDWARE_INTERRUPT_PROTOCOL  *Interrupt;
+  EFI_TPL                          OldTpl;
+
+  Status = gBS->LocateProtocol (&gHardwareInterruptProtocolGuid, NULL, (VOID **)&Interrupt);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  gBS->CloseEvent (Event);
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_NOTIFY,
+                  SerialPortRxExitBootServices,
+                  NULL,
+                  &mExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = Interrupt->RegisterInterruptSource (Interrupt, RPI5D_UART_INTERRUPT, SerialPortRxInterrupt);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (mExitBootServicesEvent);
+    return;
+  }
+
+  OldTpl     = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  mInterrupt = Interrupt;
+  SerialPortRxFill ();
+  MmioWrite32 (RPI5D_UART_BASE + UART_ICR, INT_RX | INT_RT);
+  MmioOr32 (RPI5D_UART_BASE + UART_IMSC, INT_RX | INT_RT);
+  Interrupt->EnableInterruptSource (Interrupt, RPI5D_UART_INTERRUPT);
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Read data from serial device and save the data in buffer.
+
+  Waits for the first byte, then copies out everything received so far,
+  up to NumberOfBytes.
+
+  @param  Buffer           Point of data buffer which need to be written.
+  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+
+  @retval 0                Read data failed.
+  @retval >0               Actual number of bytes read from serial device.
+**/
+UINTN
+EFIAPI
+SerialPortRead (
+  OUT UINT8  *Buffer,
+  IN  UINTN  NumberOfBytes
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Count;
+  UINTN    Offset;
+  UINTN    Chunk;
+
+  if (NumberOfBytes == 0) {
+    return 0;
+  }
+
+  do {
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    SerialPortRxFill ();
+
+    Count = 0;
+    while ((mRxTail != mRxHead) && (Count < NumberOfBytes)) {
+      Offset = mRxTail & (SERIAL_RX_RING_SIZE - 1);
+      Chunk  = MIN (mRxHead - mRxTail, SERIAL_RX_RING_SIZE - Offset);
+      Chunk  = MIN (Chunk, NumberOfBytes - Count);
+      CopyMem (Buffer + Count, &mRxRing[Offset], Chunk);
+      mRxTail += (UINT32)Chunk;
+      Count   += Chunk;
+    }
+
+    if ((Count > 0) && (mInterrupt != NULL)) {
+      MmioOr32 (RPI5D_UART_BASE + UART_IMSC, INT_RX | INT_RT);
+    }
+
+    gBS->RestoreTPL (OldTpl);
+  } while (Count == 0);
+
+  return Count;
+}
+
+/**
+  Polls serial device to see if there is any data waiting to be read.
+
+  @retval TRUE             Data is waiting to be read from the serial device.
+  @retval FALSE            There is no data waiting to be read from the serial device.
+**/
+BOOLEAN
+EFIAPI
+SerialPortPoll (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+  BOOLEAN  Pending;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  SerialPortRxFill ();
+  Pending = (BOOLEAN)(mRxHead != mRxTail);
+  gBS->RestoreTPL (OldTpl);
+
+  return Pending;
+}
+
+/**
+  Take the UART receive interrupt as soon as the hardware interrupt
+  protocol is installed.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   Always; without the interrupt the FIFO is polled.
+**/
+RETURN_STATUS
+EFIAPI
+DxeSerialPortLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EfiCreateProtocolNotifyEvent (
+    &gHardwareInterruptProtocolGuid,
+    TPL_CALLBACK,
+    SerialPortRxInterruptReady,
+    NULL,
+    &mInterruptRegistration
+    );
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/** @file
+  Host stand-in for MdePkg Base.h, enough to build SerialPortLib.c into
+  SerialPortBench and SerialPortDivisorTest.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_BASE_H_
+#define HOST_BASE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t    UINT8;
+typedef uint16_t   UINT16;
+typedef uint32_t   UINT32;
+typedef uint64_t   UINT64;
+typedef int32_t    INT32;
+typedef size_t     UINTN;
+typedef intptr_t   INTN;
+typedef UINT8      BOOLEAN;
+typedef UINTN      RETURN_STATUS;
+
+#define VOID      void
+#define CONST     const
+#define STATIC    static
+#define EFIAPI
+#define IN
+#define OUT
+#define OPTIONAL
+#define TRUE      ((BOOLEAN)1)
+#define FALSE     ((BOOLEAN)0)
+#define MIN(a, b)  (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)  (((a) > (b)) ? (a) : (b))
+
+#define ENCODE_ERROR(a)              ((RETURN_STATUS)1 << (sizeof (UINTN) * 8 - 1) | (a))
+#define RETURN_SUCCESS               0
+#define RETURN_INVALID_PARAMETER     ENCODE_ERROR (2)
+#define RETURN_UNSUPPORTED           ENCODE_ERROR (3)
+#define RETURN_DEVICE_ERROR          ENCODE_ERROR (7)
+#define RETURN_ERROR(StatusCode)     (((INTN)(RETURN_STATUS)(StatusCode)) < 0)
+
+#endif
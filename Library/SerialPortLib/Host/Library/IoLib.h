@@ -0,0 +1,23 @@
+/** @file
+  Host stand-in for IoLib: MMIO goes to the UART model of SerialPortBench.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_IO_LIB_H_
+#define HOST_IO_LIB_H_
+
+UINT32
+MmioRead32 (
+  IN UINTN  Address
+  );
+
+UINT32
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  );
+
+#endif
@@ -0,0 +1,22 @@
+/** @file
+  Host stand-in for PcdLib, with the fixed PCDs of RPi5D.dsc.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOST_PCD_LIB_H_
+#define HOST_PCD_LIB_H_
+
+#define FixedPcdGet8(TokenName)   ((UINT8)_PCD_VALUE_##TokenName)
+#define FixedPcdGet32(TokenName)  ((UINT32)_PCD_VALUE_##TokenName)
+#define FixedPcdGet64(TokenName)  ((UINT64)_PCD_VALUE_##TokenName)
+
+#define _PCD_VALUE_PL011UartClkInHz         48000000
+#define _PCD_VALUE_PcdUartDefaultBaudRate   115200
+#define _PCD_VALUE_PcdUartDefaultDataBits   8
+#define _PCD_VALUE_PcdUartDefaultParity     1
+#define _PCD_VALUE_PcdUartDefaultStopBits   1
+
+#endif
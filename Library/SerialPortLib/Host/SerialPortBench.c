@@ -0,0 +1,240 @@
+/** @file
+  Host benchmark of the PL011 transmit path against a UART model.
+
+  SerialPortLib.c is built unchanged on top of a model of the PL011
+  transmit side: a 32-byte FIFO and a shift register that empty at the
+  line rate, with fixed CPU costs for a register read (a round trip to
+  the device) and a posted write. Each scenario runs against the
+  library and against the old one-flag-read-per-byte loop.
+
+    cd Library/SerialPortLib
+    cc -O2 -IHost -o SerialPortBench SerialPortLib.c Host/SerialPortBench.c
+    ./SerialPortBench
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Base.h>
+#include <Library/IoLib.h>
+#include "../../../Include/Library/PlatformSerialPortLib.h"
+#include "../../../Include/Platform/RPi5D.h"
+
+#define UART_DR   0x000
+#define UART_FR   0x018
+#define FR_TXFE   (1 << 7)
+#define FR_TXFF   (1 << 5)
+
+#define READ_NS   150.0
+#define WRITE_NS  20.0
+
+typedef struct {
+  UINT64    Reads;
+  UINT64    Writes;
+  UINT64    Bytes;
+  double    CpuNs;
+} BENCH_RESULT;
+
+STATIC double  mNow;
+STATIC double  mByteNs;
+STATIC double  mLineFree;
+STATIC UINT32  mFifo;
+STATIC UINT64  mReads;
+STATIC UINT64  mWrites;
+STATIC UINT64  mOverruns;
+
+/**
+  Move bytes from the FIFO into the shift register up to the current time.
+**/
+STATIC
+VOID
+UartDrain (
+  VOID
+  )
+{
+  while ((mFifo > 0) && (mLineFree <= mNow)) {
+    mLineFree += mByteNs;
+    mFifo--;
+  }
+}
+
+UINT32
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  mNow += READ_NS;
+  mReads++;
+  UartDrain ();
+
+  if (Address != RPI5D_UART_BASE + UART_FR) {
+    return 0;
+  }
+
+  return (mFifo == 0 ? FR_TXFE : 0) | (mFifo == PL011_TX_FIFO_DEPTH ? FR_TXFF : 0);
+}
+
+UINT32
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  mNow += WRITE_NS;
+  mWrites++;
+  UartDrain ();
+
+  if (Address == RPI5D_UART_BASE + UART_DR) {
+    if ((mFifo == 0) && (mLineFree < mNow)) {
+      mLineFree = mNow;
+    }
+
+    if (mFifo == PL011_TX_FIFO_DEPTH) {
+      mOverruns++;
+    } else {
+      mFifo++;
+    }
+
+    UartDrain ();
+  }
+
+  return Value;
+}
+
+/**
+  The transmit loop SerialPortWrite used before FIFO batching.
+**/
+STATIC
+UINTN
+EFIAPI
+LegacySerialPortWrite (
+  IN UINT8  *Buffer,
+  IN UINTN  NumberOfBytes
+  )
+{
+  UINTN  Count;
+
+  for (Count = 0; Count < NumberOfBytes; Count++, Buffer++) {
+    while (MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_TXFF);
+    MmioWrite32 (RPI5D_UART_BASE + UART_DR, *Buffer);
+  }
+
+  return Count;
+}
+
+typedef UINTN (EFIAPI *WRITE_FUNCTION)(UINT8 *, UINTN);
+
+/**
+  Write Lines messages of Length bytes, with Gap ns of other work in
+  between, and account the time spent inside the write function.
+
+  A blocking caller retries until the whole line is out. A non-blocking
+  caller makes one call per line and keeps the rest queued for the next
+  one, as a log ring would.
+**/
+STATIC
+BENCH_RESULT
+BenchRun (
+  IN WRITE_FUNCTION  Write,
+  IN BOOLEAN         Blocking,
+  IN UINT32          Baud,
+  IN UINTN           Lines,
+  IN UINTN           Length,
+  IN double          Gap
+  )
+{
+  BENCH_RESULT  Result;
+  UINT8         Line[4096];
+  UINTN         Index;
+  UINTN         Queued;
+  UINTN         Done;
+  double        Start;
+
+  memset (Line, 'x', sizeof (Line));
+  memset (&Result, 0, sizeof (Result));
+  mNow      = 0;
+  mLineFree = 0;
+  mFifo     = 0;
+  mReads    = 0;
+  mWrites   = 0;
+  mOverruns = 0;
+  mByteNs   = 10 * 1e9 / Baud;
+
+  Queued = 0;
+  for (Index = 0; Index < Lines; Index++) {
+    Start   = mNow;
+    Queued += Length;
+    do {
+      Done          = Write (Line, MIN (Queued, sizeof (Line)));
+      Queued       -= Done;
+      Result.Bytes += Done;
+    } while (Blocking && (Queued > 0));
+
+    Result.CpuNs += mNow - Start;
+    mNow         += Gap;
+  }
+
+  Result.Reads  = mReads;
+  Result.Writes = mWrites;
+  return Result;
+}
+
+STATIC
+VOID
+BenchReport (
+  IN CONST char      *Name,
+  IN WRITE_FUNCTION  Write,
+  IN BOOLEAN         Blocking,
+  IN UINT32          Baud,
+  IN UINTN           Lines,
+  IN UINTN           Length,
+  IN double          Gap
+  )
+{
+  BENCH_RESULT  Result;
+
+  Result = BenchRun (Write, Blocking, Baud, Lines, Length, Gap);
+  printf (
+    "  %-11s %8.3f reads/byte %6.3f writes/byte %10.1f ns/byte of CPU %5.1f%% accepted%s\n",
+    Name,
+    (double)Result.Reads / Result.Bytes,
+    (double)Result.Writes / Result.Bytes,
+    Result.CpuNs / Result.Bytes,
+    100.0 * Result.Bytes / (Lines * Length),
+    mOverruns != 0 ? "  FIFO OVERRUN" : ""
+    );
+}
+
+STATIC
+VOID
+BenchScenario (
+  IN CONST char  *Title,
+  IN UINT32      Baud,
+  IN UINTN       Lines,
+  IN UINTN       Length,
+  IN double      Gap
+  )
+{
+  printf ("%s\n", Title);
+  BenchReport ("per-byte", LegacySerialPortWrite, TRUE, Baud, Lines, Length, Gap);
+  BenchReport ("blocking", SerialPortWrite, TRUE, Baud, Lines, Length, Gap);
+  BenchReport ("nonblocking", SerialPortWriteNonBlocking, FALSE, Baud, Lines, Length, Gap);
+}
+
+int
+main (
+  VOID
+  )
+{
+  printf ("PL011 model: %.0f ns per flag read, %.0f ns per data write\n\n", READ_NS, WRITE_NS);
+
+  BenchScenario ("24-byte DEBUG lines, 5 ms apart, 115200 baud", 115200, 1000, 24, 5e6);
+  BenchScenario ("80-byte DEBUG lines, 10 ms apart, 115200 baud", 115200, 1000, 80, 10e6);
+  BenchScenario ("4 KiB back to back, 115200 baud", 115200, 16, 4096, 0);
+  BenchScenario ("80-byte DEBUG lines, 1 ms apart, 3 Mbaud", 3000000, 1000, 80, 1e6);
+  return 0;
+}
@@ -0,0 +1,190 @@
+/** @file
+  Host check of the PL011 baud divisors of SerialPortLib.
+
+  Every standard rate up to UARTCLK / 16 must come out within
+  MAX_ERROR_PERCENT of the request, faster rates must be refused, and
+  SerialPortSetAttributes must program what SerialPortBaudDivisor
+  computed. The error of the old integer-only divisor is shown alongside.
+
+    cd Library/SerialPortLib
+    cc -O2 -IHost -o SerialPortDivisorTest SerialPortLib.c Host/SerialPortDivisorTest.c
+    ./SerialPortDivisorTest
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+
+#include <Base.h>
+#include <Library/IoLib.h>
+#include <Library/PcdLib.h>
+#include "../../../Include/Library/PlatformSerialPortLib.h"
+#include "../../../Include/Platform/RPi5D.h"
+
+#define UART_FR     0x018
+#define UART_IBRD   0x024
+#define UART_FBRD   0x028
+#define UART_LCRH   0x02C
+#define UART_CR     0x030
+#define FR_TXFE     (1 << 7)
+
+#define UART_CLOCK         FixedPcdGet32 (PL011UartClkInHz)
+#define MAX_ERROR_PERCENT  0.5
+
+STATIC UINT32  mRegisters[0x50 / 4];
+STATIC UINT32  mWrites;
+
+STATIC CONST UINT64  mStandardRates[] = {
+  110,     300,     600,     1200,    2400,    4800,    9600,    14400,
+  19200,   38400,   57600,   115200,  230400,  460800,  500000,  576000,
+  921600,  1000000, 1152000, 1500000, 2000000, 2500000, 3000000
+};
+
+STATIC CONST UINT64  mTooFastRates[] = {
+  3500000, 4000000
+};
+
+UINT32
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  if (Address == RPI5D_UART_BASE + UART_FR) {
+    return FR_TXFE;
+  }
+
+  return mRegisters[(Address - RPI5D_UART_BASE) / 4];
+}
+
+UINT32
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  mWrites++;
+  mRegisters[(Address - RPI5D_UART_BASE) / 4] = Value;
+  return Value;
+}
+
+/**
+  Baud rate percentage error of a divisor in 1/64ths.
+**/
+STATIC
+double
+DivisorError (
+  IN UINT64  BaudRate,
+  IN UINT32  Divisor
+  )
+{
+  double  Actual;
+
+  Actual = 4.0 * UART_CLOCK / Divisor;
+  return 100.0 * (Actual - BaudRate) / BaudRate;
+}
+
+int
+main (
+  VOID
+  )
+{
+  RETURN_STATUS       Status;
+  UINTN               Index;
+  UINT32              Divisor;
+  UINT32              Legacy;
+  double              Error;
+  UINTN               Failures;
+  UINT64              BaudRate;
+  UINT32              FifoDepth;
+  UINT32              Timeout;
+  EFI_PARITY_TYPE     Parity;
+  UINT8               DataBits;
+  EFI_STOP_BITS_TYPE  StopBits;
+
+  Failures = 0;
+  printf ("UARTCLK %u Hz, limit %.2f%%\n", UART_CLOCK, MAX_ERROR_PERCENT);
+  printf ("%10s %6s %5s %10s %14s\n", "baud", "IBRD", "FBRD", "error", "integer-only");
+
+  for (Index = 0; Index < sizeof (mStandardRates) / sizeof (mStandardRates[0]); Index++) {
+    BaudRate = mStandardRates[Index];
+    Status   = SerialPortBaudDivisor (BaudRate, &Divisor);
+    if (RETURN_ERROR (Status)) {
+      printf ("%10llu refused  FAIL\n", (unsigned long long)BaudRate);
+      Failures++;
+      continue;
+    }
+
+    Error  = DivisorError (BaudRate, Divisor);
+    Legacy = (UINT32)(UART_CLOCK / (16 * BaudRate)) << 6;
+    printf (
+      "%10llu %6u %5u %+9.3f%% %+13.3f%%%s\n",
+      (unsigned long long)BaudRate,
+      Divisor >> 6,
+      Divisor & 0x3F,
+      Error,
+      DivisorError (BaudRate, Legacy),
+      (Error > MAX_ERROR_PERCENT || Error < -MAX_ERROR_PERCENT) ? "  FAIL" : ""
+      );
+    if ((Error > MAX_ERROR_PERCENT) || (Error < -MAX_ERROR_PERCENT)) {
+      Failures++;
+    }
+
+    FifoDepth = 0;
+    Timeout   = 0;
+    Parity    = DefaultParity;
+    DataBits  = 0;
+    StopBits  = DefaultStopBits;
+    Status    = SerialPortSetAttributes (&BaudRate, &FifoDepth, &Timeout, &Parity, &DataBits, &StopBits);
+    if (RETURN_ERROR (Status) ||
+        (mRegisters[UART_IBRD / 4] != Divisor >> 6) ||
+        (mRegisters[UART_FBRD / 4] != (Divisor & 0x3F)) ||
+        (mRegisters[UART_LCRH / 4] != 0x70) ||
+        (FifoDepth != PL011_RX_FIFO_DEPTH))
+    {
+      printf ("%10llu SerialPortSetAttributes programmed the wrong registers  FAIL\n", (unsigned long long)BaudRate);
+      Failures++;
+    }
+  }
+
+  for (Index = 0; Index < sizeof (mTooFastRates) / sizeof (mTooFastRates[0]); Index++) {
+    if (!RETURN_ERROR (SerialPortBaudDivisor (mTooFastRates[Index], &Divisor))) {
+      printf ("%10llu accepted above UARTCLK / 16  FAIL\n", (unsigned long long)mTooFastRates[Index]);
+      Failures++;
+    }
+  }
+
+  BaudRate = 3000000;
+  Parity   = EvenParity;
+  DataBits = 7;
+  StopBits = TwoStopBits;
+  SerialPortSetAttributes (&BaudRate, &FifoDepth, &Timeout, &Parity, &DataBits, &StopBits);
+  if (mRegisters[UART_LCRH / 4] != 0x5E) {
+    printf ("7E2 gave UART_LCRH %#x  FAIL\n", mRegisters[UART_LCRH / 4]);
+    Failures++;
+  }
+
+  StopBits = OneFiveStopBits;
+  if (SerialPortSetAttributes (&BaudRate, &FifoDepth, &Timeout, &Parity, &DataBits, &StopBits) != RETURN_INVALID_PARAMETER) {
+    printf ("1.5 stop bits accepted  FAIL\n");
+    Failures++;
+  }
+
+  mWrites = 0;
+  SerialPortInitialize ();
+  if (mWrites != 0) {
+    printf ("SerialPortInitialize reprogrammed a running UART  FAIL\n");
+    Failures++;
+  }
+
+  mRegisters[UART_CR / 4] = 0;
+  SerialPortInitialize ();
+  if ((mRegisters[UART_IBRD / 4] != 26) || (mRegisters[UART_FBRD / 4] != 3)) {
+    printf ("SerialPortInitialize did not program 115200  FAIL\n");
+    Failures++;
+  }
+
+  printf ("%s\n", Failures == 0 ? "PASS" : "FAIL");
+  return Failures == 0 ? 0 : 1;
+}
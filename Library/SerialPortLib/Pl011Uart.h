@@ -0,0 +1,45 @@
+/** @file
+  PL011 registers of the RPi5D console UART.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PL011_UART_H_
+#define PL011_UART_H_
+
+#define UART_DR     0x000
+#define UART_FR     0x018
+#define UART_IBRD   0x024
+#define UART_FBRD   0x028
+#define UART_LCRH   0x02C
+#define UART_CR     0x030
+#define UART_IMSC   0x038
+#define UART_ICR    0x044
+
+#define DR_DATA     0xFF
+
+#define FR_TXFE     (1 << 7)
+#define FR_TXFF     (1 << 5)
+#define FR_RXFE     (1 << 4)
+#define FR_BUSY     (1 << 3)
+
+#define LCRH_PEN    (1 << 1)
+#define LCRH_EPS    (1 << 2)
+#define LCRH_STP2   (1 << 3)
+#define LCRH_FEN    (1 << 4)
+#define LCRH_WLEN(DataBits)  (((UINT32)(DataBits) - 5) << 5)
+#define LCRH_SPS    (1 << 7)
+
+#define CR_UARTEN   (1 << 0)
+#define CR_TXE      (1 << 8)
+#define CR_RXE      (1 << 9)
+
+//
+// UART_IMSC and UART_ICR: receive and receive timeout interrupts.
+//
+#define INT_RX      (1 << 4)
+#define INT_RT      (1 << 6)
+
+#endif
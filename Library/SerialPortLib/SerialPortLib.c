@@ -1,26 +1,150 @@
 #include <Base.h>
 #include <Library/IoLib.h>
 #include <Library/PcdLib.h>
-#include <Library/SerialPortLib.h>
+#include "../../Include/Library/PlatformSerialPortLib.h"
 #include "../../Include/Platform/RPi5D.h"
+#include "Pl011Uart.h"
 
-#define UART_DR     0x000
-#define UART_FR     0x018
-#define UART_IBRD   0x024
-#define UART_FBRD   0x028
-#define UART_LCRH   0x02C
-#define UART_CR     0x030
-#define UART_IMSC   0x038
-#define UART_ICR    0x044
+#define UART_CLOCK  FixedPcdGet32 (PL011UartClkInHz)
 
-#define FR_TXFF     (1 << 5)
-#define FR_RXFE     (1 << 4)
-#define FR_BUSY     (1 << 3)
+//
+// Largest divisor in 1/64ths: IBRD 0xFFFF with FBRD 0.
+//
+#define UART_DIVISOR_MAX  (0xFFFF << 6)
+
+/**
+  Compute the PL011 divisor of a baud rate from the UART clock.
+
+  The divisor is UARTCLK / (16 * BaudRate) in 1/64ths, rounded to the
+  nearest: the top bits go to UART_IBRD and the low six to UART_FBRD.
+
+  @param  BaudRate      Requested baud rate.
+  @param  Divisor       The divisor in 1/64ths.
+
+  @retval RETURN_SUCCESS        Divisor computed.
+  @retval RETURN_UNSUPPORTED    The rate is above UARTCLK / 16 or too low
+                                for a 16-bit integer divisor.
+**/
+RETURN_STATUS
+EFIAPI
+SerialPortBaudDivisor (
+  IN  UINT64  BaudRate,
+  OUT UINT32  *Divisor
+  )
+{
+  UINT64  Sixtyfourths;
+
+  if ((BaudRate == 0) || (BaudRate > UART_CLOCK / 16)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  Sixtyfourths = (4 * (UINT64)UART_CLOCK + BaudRate / 2) / BaudRate;
+  if (Sixtyfourths > UART_DIVISOR_MAX) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  *Divisor = (UINT32)Sixtyfourths;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Build the UART_LCRH value of a frame format. The FIFOs are always on,
+  since the transmit path relies on them.
+
+  @param  Parity        Parity, not DefaultParity.
+  @param  DataBits      Data bits, 5 to 8.
+  @param  StopBits      Stop bits, not DefaultStopBits.
+  @param  LineControl   The UART_LCRH value.
+
+  @retval RETURN_SUCCESS            LineControl set.
+  @retval RETURN_INVALID_PARAMETER  The PL011 has no such frame format.
+**/
+STATIC
+RETURN_STATUS
+SerialPortLineControl (
+  IN  EFI_PARITY_TYPE     Parity,
+  IN  UINT8               DataBits,
+  IN  EFI_STOP_BITS_TYPE  StopBits,
+  OUT UINT32              *LineControl
+  )
+{
+  UINT32  Value;
+
+  if ((DataBits < 5) || (DataBits > 8)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Value = LCRH_FEN | LCRH_WLEN (DataBits);
+
+  switch (Parity) {
+    case NoParity:
+      break;
+    case EvenParity:
+      Value |= LCRH_PEN | LCRH_EPS;
+      break;
+    case OddParity:
+      Value |= LCRH_PEN;
+      break;
+    case MarkParity:
+      Value |= LCRH_PEN | LCRH_SPS;
+      break;
+    case SpaceParity:
+      Value |= LCRH_PEN | LCRH_EPS | LCRH_SPS;
+      break;
+    default:
+      return RETURN_INVALID_PARAMETER;
+  }
+
+  switch (StopBits) {
+    case OneStopBit:
+      break;
+    case TwoStopBits:
+      Value |= LCRH_STP2;
+      break;
+    default:
+      return RETURN_INVALID_PARAMETER;
+  }
+
+  *LineControl = Value;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Reprogram the UART once the last byte has left at the old rate.
+  Writing UART_LCRH latches the new divisor.
+
+  @param  Divisor       Divisor in 1/64ths from SerialPortBaudDivisor.
+  @param  LineControl   UART_LCRH value.
+**/
+STATIC
+VOID
+SerialPortProgram (
+  IN UINT32  Divisor,
+  IN UINT32  LineControl
+  )
+{
+  while ((MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_BUSY) != 0) {
+  }
+
+  MmioWrite32 (RPI5D_UART_BASE + UART_CR, 0x00000000);
+  MmioWrite32 (RPI5D_UART_BASE + UART_IBRD, Divisor >> 6);
+  MmioWrite32 (RPI5D_UART_BASE + UART_FBRD, Divisor & 0x3F);
+  MmioWrite32 (RPI5D_UART_BASE + UART_LCRH, LineControl);
+  MmioWrite32 (RPI5D_UART_BASE + UART_ICR, 0x7FF);
+  MmioWrite32 (RPI5D_UART_BASE + UART_CR, CR_UARTEN | CR_TXE | CR_RXE);
+}
 
 /**
   Initialize the serial device hardware.
-  
+
+  Every module linking a serial DebugLib calls this, so a UART that is
+  already running is left alone: it keeps the rate chosen through
+  SerialPortSetAttributes and no byte in flight is cut off. Otherwise
+  it is set up with the PcdUartDefault* frame format.
+
   @retval RETURN_SUCCESS        The serial device was initialized.
+  @retval RETURN_UNSUPPORTED    The default attributes are not possible
+                                with the UART clock.
 **/
 RETURN_STATUS
 EFIAPI
@@ -28,24 +152,39 @@ SerialPortInitialize (
   VOID
   )
 {
-  UINT32  Divisor;
+  RETURN_STATUS  Status;
+  UINT32         Divisor;
+  UINT32         LineControl;
 
-  MmioWrite32 (RPI5D_UART_BASE + UART_CR, 0x00000000);
-  
-  Divisor = 48000000 / (16 * 115200);
-  MmioWrite32 (RPI5D_UART_BASE + UART_IBRD, Divisor);
-  MmioWrite32 (RPI5D_UART_BASE + UART_FBRD, 0);
-  
-  MmioWrite32 (RPI5D_UART_BASE + UART_LCRH, 0x70);
-  MmioWrite32 (RPI5D_UART_BASE + UART_CR, 0x301);
-  MmioWrite32 (RPI5D_UART_BASE + UART_ICR, 0x7FF);
-  
+  if ((MmioRead32 (RPI5D_UART_BASE + UART_CR) & (CR_UARTEN | CR_TXE)) == (CR_UARTEN | CR_TXE)) {
+    return RETURN_SUCCESS;
+  }
+
+  Status = SerialPortBaudDivisor (FixedPcdGet64 (PcdUartDefaultBaudRate), &Divisor);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SerialPortLineControl (
+             (EFI_PARITY_TYPE)FixedPcdGet8 (PcdUartDefaultParity),
+             FixedPcdGet8 (PcdUartDefaultDataBits),
+             (EFI_STOP_BITS_TYPE)FixedPcdGet8 (PcdUartDefaultStopBits),
+             &LineControl
+             );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  SerialPortProgram (Divisor, LineControl);
   return RETURN_SUCCESS;
 }
 
 /**
   Write data to serial device.
 
+  Spins in SerialPortWriteNonBlocking until everything is queued, so a
+  message that fits in an empty FIFO costs a single flag read.
+
   @param  Buffer           Point of data buffer which need to be written.
   @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
 
@@ -61,46 +200,52 @@ SerialPortWrite (
 {
   UINTN  Count;
 
-  for (Count = 0; Count < NumberOfBytes; Count++, Buffer++) {
-    while (MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_TXFF);
-    MmioWrite32 (RPI5D_UART_BASE + UART_DR, *Buffer);
+  for (Count = 0; Count < NumberOfBytes; ) {
+    Count += SerialPortWriteNonBlocking (Buffer + Count, NumberOfBytes - Count);
   }
 
   return Count;
 }
 
 /**
-  Read data from serial device and save the data in buffer.
+  Write as much of a buffer as the transmit FIFO accepts right now,
+  without waiting for it to drain. One flag read covers a whole FIFO of
+  bytes when it is empty; otherwise bytes go one at a time for as long
+  as it is not full.
 
-  @param  Buffer           Point of data buffer which need to be written.
-  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+  @param  Buffer           Data to write.
+  @param  NumberOfBytes    Number of bytes in Buffer.
 
-  @retval 0                Read data failed.
-  @retval >0               Actual number of bytes read from serial device.
+  @return Number of bytes queued, possibly 0 when the FIFO is full.
 **/
 UINTN
 EFIAPI
-SerialPortRead (
-  OUT UINT8  *Buffer,
-  IN  UINTN  NumberOfBytes
+SerialPortWriteNonBlocking (
+  IN UINT8  *Buffer,
+  IN UINTN  NumberOfBytes
   )
 {
-  return 0;
-}
+  UINTN   Count;
+  UINTN   Burst;
+  UINT32  Flags;
 
-/**
-  Polls serial device to see if there is any data waiting to be read.
+  Count = 0;
+  while (Count < NumberOfBytes) {
+    Flags = MmioRead32 (RPI5D_UART_BASE + UART_FR);
+    if ((Flags & FR_TXFE) != 0) {
+      Burst = MIN (NumberOfBytes - Count, PL011_TX_FIFO_DEPTH);
+    } else if ((Flags & FR_TXFF) == 0) {
+      Burst = 1;
+    } else {
+      break;
+    }
 
-  @retval TRUE             Data is waiting to be read from the serial device.
-  @retval FALSE            There is no data waiting to be read from the serial device.
-**/
-BOOLEAN
-EFIAPI
-SerialPortPoll (
-  VOID
-  )
-{
-  return !(MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_RXFE);
+    for ( ; Burst > 0; Burst--) {
+      MmioWrite32 (RPI5D_UART_BASE + UART_DR, Buffer[Count++]);
+    }
+  }
+
+  return Count;
 }
 
 /**
@@ -160,10 +305,12 @@ SerialPortGetControl (
                             value of DefaultStopBits will use the device's default number of
                             stop bits.
 
+  The receive FIFO is always PL011_RX_FIFO_DEPTH deep and the timeout is
+  not programmable; both are returned as they are.
+
   @retval RETURN_SUCCESS            The new attributes were set on the serial device.
-  @retval RETURN_UNSUPPORTED        The serial device does not support this operation.
+  @retval RETURN_UNSUPPORTED        The baud rate is not possible with the UART clock.
   @retval RETURN_INVALID_PARAMETER  One or more of the attributes has an unsupported value.
-  @retval RETURN_DEVICE_ERROR       The serial device is not functioning correctly.
 **/
 RETURN_STATUS
 EFIAPI
@@ -176,5 +323,37 @@ SerialPortSetAttributes (
   IN OUT EFI_STOP_BITS_TYPE  *StopBits
   )
 {
-  return RETURN_UNSUPPORTED;
+  RETURN_STATUS  Status;
+  UINT32         Divisor;
+  UINT32         LineControl;
+
+  if (*BaudRate == 0) {
+    *BaudRate = FixedPcdGet64 (PcdUartDefaultBaudRate);
+  }
+
+  if (*Parity == DefaultParity) {
+    *Parity = (EFI_PARITY_TYPE)FixedPcdGet8 (PcdUartDefaultParity);
+  }
+
+  if (*DataBits == 0) {
+    *DataBits = FixedPcdGet8 (PcdUartDefaultDataBits);
+  }
+
+  if (*StopBits == DefaultStopBits) {
+    *StopBits = (EFI_STOP_BITS_TYPE)FixedPcdGet8 (PcdUartDefaultStopBits);
+  }
+
+  Status = SerialPortBaudDivisor (*BaudRate, &Divisor);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SerialPortLineControl (*Parity, *DataBits, *StopBits, &LineControl);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  *ReceiveFifoDepth = PL011_RX_FIFO_DEPTH;
+  SerialPortProgram (Divisor, LineControl);
+  return RETURN_SUCCESS;
 }
@@ -0,0 +1,65 @@
+/** @file
+  Polled receive path of the RPi5D console UART, for SEC and PrePi.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/IoLib.h>
+#include "../../Include/Library/PlatformSerialPortLib.h"
+#include "../../Include/Platform/RPi5D.h"
+#include "Pl011Uart.h"
+
+/**
+  Read data from serial device and save the data in buffer.
+
+  Waits for the first byte, then takes whatever else the receive FIFO
+  holds, up to NumberOfBytes.
+
+  @param  Buffer           Point of data buffer which need to be written.
+  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+
+  @retval 0                Read data failed.
+  @retval >0               Actual number of bytes read from serial device.
+**/
+UINTN
+EFIAPI
+SerialPortRead (
+  OUT UINT8  *Buffer,
+  IN  UINTN  NumberOfBytes
+  )
+{
+  UINTN  Count;
+
+  Count = 0;
+  while (Count < NumberOfBytes) {
+    if ((MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_RXFE) != 0) {
+      if (Count > 0) {
+        break;
+      }
+
+      continue;
+    }
+
+    Buffer[Count++] = (UINT8)(MmioRead32 (RPI5D_UART_BASE + UART_DR) & DR_DATA);
+  }
+
+  return Count;
+}
+
+/**
+  Polls serial device to see if there is any data waiting to be read.
+
+  @retval TRUE             Data is waiting to be read from the serial device.
+  @retval FALSE            There is no data waiting to be read from the serial device.
+**/
+BOOLEAN
+EFIAPI
+SerialPortPoll (
+  VOID
+  )
+{
+  return !(MmioRead32 (RPI5D_UART_BASE + UART_FR) & FR_RXFE);
+}
@@ -0,0 +1,110 @@
+/** @file
+  VideoCore firmware mailbox of RPi5D.
+
+  Copyright (c) 2026, Your Name Here
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
+#include "../../Include/Library/PlatformMmioLib.h"
+#include "../../Include/Library/VideoCoreMailboxLib.h"
+#include "../../Include/Platform/RPi5D.h"
+
+//
+// Mailbox 0 carries answers to the ARM, mailbox 1 requests to the VideoCore.
+//
+#define MBOX0_READ      (RPI5D_MAILBOX_BASE + 0x00)
+#define MBOX0_STATUS    (RPI5D_MAILBOX_BASE + 0x18)
+#define MBOX1_WRITE     (RPI5D_MAILBOX_BASE + 0x20)
+#define MBOX1_STATUS    (RPI5D_MAILBOX_BASE + 0x38)
+#define MBOX_FULL       BIT31
+#define MBOX_EMPTY      BIT30
+
+#define MBOX_CHANNEL_PROPERTY  8
+#define MBOX_CHANNEL_MASK      0xF
+
+//
+// Longest wait for the firmware, in microseconds, and the poll interval
+//
+#define MBOX_TIMEOUT    100000
+#define MBOX_POLL       10
+
+/**
+  Wait until a mailbox status register has Bit clear.
+
+  @param  Status        Status register.
+  @param  Bit           MBOX_FULL or MBOX_EMPTY.
+
+  @retval TRUE          The bit cleared.
+  @retval FALSE         Timed out.
+**/
+STATIC
+BOOLEAN
+MailboxWait (
+  IN UINTN   Status,
+  IN UINT32  Bit
+  )
+{
+  UINTN  Waited;
+
+  for (Waited = 0; (PlatformMmioRead32 (Status) & Bit) != 0; Waited += MBOX_POLL) {
+    if (Waited >= MBOX_TIMEOUT) {
+      return FALSE;
+    }
+
+    MicroSecondDelay (MBOX_POLL);
+  }
+
+  return TRUE;
+}
+
+RETURN_STATUS
+EFIAPI
+VideoCoreMailboxProperty (
+  IN OUT UINT32  *Buffer
+  )
+{
+  UINTN   Address;
+  UINT32  Message;
+
+  Address = (UINTN)Buffer;
+  if (((Address & (16 - 1)) != 0) || (Address + Buffer[0] > SIZE_1GB)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // Drain stale answers, then hand the buffer over through the uncached
+  // alias; the VideoCore does not snoop the ARM caches.
+  //
+  while ((PlatformMmioRead32 (MBOX0_STATUS) & MBOX_EMPTY) == 0) {
+    PlatformMmioRead32 (MBOX0_READ);
+  }
+
+  WriteBackDataCacheRange (Buffer, Buffer[0]);
+
+  if (!MailboxWait (MBOX1_STATUS, MBOX_FULL)) {
+    return RETURN_TIMEOUT;
+  }
+
+  Message = (UINT32)Address | VIDEOCORE_BUS_ALIAS | MBOX_CHANNEL_PROPERTY;
+  PlatformMmioWrite32 (MBOX1_WRITE, Message);
+
+  do {
+    if (!MailboxWait (MBOX0_STATUS, MBOX_EMPTY)) {
+      return RETURN_TIMEOUT;
+    }
+  } while (PlatformMmioRead32 (MBOX0_READ) != Message);
+
+  InvalidateDataCacheRange (Buffer, Buffer[0]);
+
+  if (Buffer[1] != VIDEOCORE_MBOX_SUCCESS) {
+    DEBUG ((DEBUG_ERROR, "RPi5D: VideoCore mailbox answered 0x%08x\n", Buffer[1]));
+    return RETURN_DEVICE_ERROR;
+  }
+
+  return RETURN_SUCCESS;
+}